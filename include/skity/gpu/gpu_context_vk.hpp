@@ -7,6 +7,7 @@
 
 #include <vulkan/vulkan.h>
 
+#include <cstddef>
 #include <skity/gpu/gpu_context.hpp>
 #include <skity/gpu/gpu_semaphore.hpp>
 #include <skity/gpu/gpu_surface.hpp>
@@ -19,6 +20,13 @@ extern "C" struct AHardwareBuffer;
 
 namespace skity {
 
+/**
+ * Callback receiving the serialized Vulkan pipeline cache. `data` is only
+ * valid for the duration of the call.
+ */
+typedef void (*GPUPipelineCacheCallbackVK)(const void* data, size_t size,
+                                           void* userdata);
+
 /**
  * Info struct to pass Vulkan info to create GPUContext.
  */
@@ -188,6 +196,39 @@ struct GPUContextInfoVK {
    * layers and extensions must already be chosen during instance creation.
    */
   bool enable_debug_runtime = false;
+
+  /**
+   * Serialized pipeline cache from a previous run, as produced by
+   * `vkGetPipelineCacheData`. It seeds the pipeline cache so pipelines do not
+   * have to be compiled again. Data produced by another driver or device is
+   * ignored.
+   *
+   * @note The data is only read while the context is created.
+   */
+  const void* pipeline_cache_data = nullptr;
+
+  /**
+   * Size in bytes of `pipeline_cache_data`.
+   */
+  size_t pipeline_cache_data_size = 0;
+
+  /**
+   * Optional file to persist the pipeline cache in. It is read when the
+   * context is created and `pipeline_cache_data` is null, and written when
+   * the context is destroyed.
+   */
+  const char* pipeline_cache_path = nullptr;
+
+  /**
+   * Optional callback receiving the pipeline cache when the context is
+   * destroyed, for hosts which store it themselves.
+   */
+  GPUPipelineCacheCallbackVK pipeline_cache_callback = nullptr;
+
+  /**
+   * User data passed to `pipeline_cache_callback`.
+   */
+  void* pipeline_cache_userdata = nullptr;
 };
 
 /**
@@ -10,6 +10,7 @@
 #include <skity/gpu/gpu_semaphore.hpp>
 #include <skity/macros.hpp>
 #include <skity/render/canvas.hpp>
+#include <skity/render/frame_stats.hpp>
 
 namespace skity {
 
@@ -127,6 +128,16 @@ class SKITY_API GPUSurface {
    */
   virtual void AddExternalWaitSemaphore(
       std::shared_ptr<GPUSemaphore> semaphore) {}
+
+  /**
+   * Statistics of the last frame, from LockCanvas() to Flush(). Counters for
+   * draws, merging, pipelines, tessellation, uploads and caches are collected
+   * by the canvas and reset every time the canvas is locked.
+   *
+   * @return the statistics of the last flushed frame, or empty statistics if
+   *         no frame has been flushed yet.
+   */
+  virtual FrameStats GetLastFrameStats() const { return FrameStats{}; }
 };
 
 }  // namespace skity
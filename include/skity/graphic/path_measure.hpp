@@ -11,11 +11,14 @@
 namespace skity {
 
 class ContourMeasure;
-class ContourMeasureIter;
+class PathMeasurement;
 
 /**
  * @class PathMeasure
  *	Util class to measure path length
+ *
+ * Measurements are shared through a process wide cache keyed by the path
+ * geometry, so measuring the same path again does not flatten it again.
  */
 class SKITY_API PathMeasure final {
  public:
@@ -59,6 +62,21 @@ class SKITY_API PathMeasure final {
    */
   bool GetPosTan(float distance, Point* position, Vector* tangent);
 
+  /**
+   * @brief Batched GetPosTan, mapping `count` distances on the current
+   *        contour at once. Sorting the distances in ascending order lets
+   *        them be resolved in a single sweep over the contour.
+   *
+   * @param distances       distances to map, each pinned like GetPosTan.
+   * @param count           number of distances.
+   * @param [out] positions `count` positions, may be nullptr.
+   * @param [out] tangents  `count` tangents, may be nullptr.
+   * @return                return false if there is no path, or any of the
+   *                        distances could not be mapped.
+   */
+  bool GetPosTan(const float distances[], int32_t count, Point positions[],
+                 Vector tangents[]);
+
   /**
    * @brief Given a start and stop distance. return the sub-path.
    *  If the segment is zero-length, return false.
@@ -87,7 +105,8 @@ class SKITY_API PathMeasure final {
   bool NextContour();
 
  private:
-  std::unique_ptr<ContourMeasureIter> iter_;
+  std::shared_ptr<const PathMeasurement> measurement_;
+  size_t contour_index_ = 0;
   std::shared_ptr<ContourMeasure> contour_;
 };
 
@@ -7,6 +7,7 @@
 
 #include <skity/graphic/path.hpp>
 #include <skity/macros.hpp>
+#include <vector>
 
 namespace skity {
 
@@ -44,6 +45,19 @@ class SKITY_API PathOp final {
    * @return true   The operation succeeded
    */
   static bool Execute(Path const& one, Path const& two, Op op, Path* result);
+
+  /**
+   * Union all paths at once, and set to the result.
+   *
+   * Much faster than folding Execute over the paths when there are many of
+   * them: paths whose bounds do not overlap are never clipped against each
+   * other, and the remaining work is spread over worker threads.
+   *
+   * @param paths   The operands, empty paths are ignored
+   * @param result  The union of the operands.
+   * @return true   The operation succeeded
+   */
+  static bool Union(std::vector<Path> const& paths, Path* result);
 };
 
 }  // namespace skity
@@ -7,6 +7,7 @@
 
 #include <cstdlib>
 #include <memory>
+#include <skity/io/data.hpp>
 #include <skity/macros.hpp>
 #include <skity/render/canvas.hpp>
 #include <vector>
@@ -32,6 +33,7 @@ class RecordedOpOffset {
 struct RecordedOp;
 struct DisplayListBuilder;
 class DisplayListRTree;
+class RasterCache;
 
 // Manages a buffer allocated with malloc.
 class DisplayListStorage {
@@ -56,6 +58,8 @@ class DisplayListStorage {
 class SKITY_API DisplayList {
   friend class RecordingCanvas;
   friend struct DisplayListBuilder;
+  friend class DisplayListSerializer;
+  friend class RasterCache;
 
  public:
   enum class Property : uint32_t {
@@ -75,9 +79,20 @@ class SKITY_API DisplayList {
   bool Empty() const { return byte_count_ == 0; }
   void Draw(Canvas* canvas) const;
   void Draw(Canvas* canvas, const Rect& cull_rect) const;
+
+  /**
+   * Same as Draw(canvas), but the display list and its SaveLayer scopes may be
+   * composited from snapshots held by `cache`.
+   */
+  void Draw(Canvas* canvas, RasterCache* cache) const;
   void DisposeOps(uint8_t* ptr, uint8_t* end);
   uint32_t OpCount() const { return op_count_; }
 
+  /**
+   * Identifier that is unique among all display lists created by the process.
+   */
+  uint64_t UniqueID() const { return unique_id_; }
+
   const Rect& GetBounds() const { return bounds_; }
 
   bool HasSaveLayer() const {
@@ -104,15 +119,47 @@ class SKITY_API DisplayList {
   std::vector<RecordedOpOffset> Search(const Rect& rect) const;
   std::vector<Rect> SearchNonOverlappingDrawnRects(const Rect& rect) const;
 
+  /**
+   * Serializes the display list into a binary blob that can be loaded back
+   * with MakeFromData or MakeFromFile by the same build of skity.
+   *
+   * @return nullptr if the display list contains something that cannot be
+   *         serialized, such as a texture backed image.
+   */
+  std::shared_ptr<Data> Serialize() const;
+
+  /**
+   * Loads a display list written by Serialize. Image pixels and font data
+   * reference `data` instead of being copied.
+   *
+   * @return nullptr if the data is malformed or written by another build.
+   */
+  static std::unique_ptr<DisplayList> MakeFromData(std::shared_ptr<Data> data);
+
+  /**
+   * Same as MakeFromData, with the file mapped into memory.
+   */
+  static std::unique_ptr<DisplayList> MakeFromFile(const char* path);
+
  private:
   void SetRTree(std::unique_ptr<DisplayListRTree> rtree);
 
+  void DrawOps(Canvas* canvas, uint32_t begin, uint32_t end,
+               RasterCache* cache) const;
+
+  // Estimates the replay cost of ops [begin, end). Returns false if the range
+  // cannot be rendered in isolation, e.g. it replaces the total matrix, blends
+  // with the canvas below it other than src-over or has a layer image filter.
+  bool ComputeComplexity(uint32_t begin, uint32_t end,
+                         uint32_t* complexity) const;
+
   const DisplayListStorage storage_;
   size_t byte_count_ = 0;
   uint32_t op_count_ = 0u;
   Rect bounds_;
   uint32_t properties_ = 0;
   std::unique_ptr<DisplayListRTree> rtree_;
+  const uint64_t unique_id_;
 };
 
 }  // namespace skity
@@ -0,0 +1,105 @@
+// Copyright 2021 The Lynx Authors. All rights reserved.
+// Licensed under the Apache License Version 2.0 that can be found in the
+// LICENSE file in the root directory of this source tree.
+
+#ifndef INCLUDE_SKITY_RECORDER_RASTER_CACHE_HPP
+#define INCLUDE_SKITY_RECORDER_RASTER_CACHE_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <skity/geometry/rect.hpp>
+#include <skity/macros.hpp>
+
+namespace skity {
+
+class Canvas;
+class DisplayList;
+class GPUContext;
+
+struct SKITY_API RasterCacheOptions {
+  /**
+   * Upper bound of the pixel memory held by snapshots. Least recently used
+   * snapshots are evicted first once it is exceeded.
+   */
+  size_t max_bytes = 64 * 1024 * 1024;
+
+  /**
+   * Number of draws with the same content and transform scale before a
+   * snapshot is taken. Content drawn fewer times is always replayed.
+   */
+  uint32_t access_threshold = 3;
+
+  /**
+   * Minimum complexity score of the replayed ops. Cheap content is faster to
+   * replay than to composite from a texture.
+   */
+  uint32_t min_complexity = 16;
+
+  /**
+   * Largest width or height in device pixels of a single snapshot.
+   */
+  uint32_t max_dimension = 2048;
+
+  /**
+   * Entries not drawn during this many frames are dropped by EndFrame().
+   */
+  uint32_t max_unused_frames = 3;
+};
+
+/**
+ * Caches rasterized snapshots of display lists and of their SaveLayer scopes.
+ *
+ * Snapshots are rendered in device space and keyed by display list, op range
+ * and the non translation part of the total matrix, so content that only
+ * moves between draws is composited from the snapshot instead of replayed.
+ * Translations are snapped to whole pixels when a snapshot is reused.
+ *
+ * Snapshots are GPU textures when a GPUContext is given, and CPU bitmaps
+ * otherwise. A RasterCache is not thread safe and must only be used with
+ * canvases of the same backend.
+ */
+class SKITY_API RasterCache {
+  friend class DisplayList;
+
+ public:
+  explicit RasterCache(GPUContext* context = nullptr,
+                       const RasterCacheOptions& options = RasterCacheOptions{});
+  ~RasterCache();
+
+  RasterCache(const RasterCache&) = delete;
+  RasterCache& operator=(const RasterCache&) = delete;
+
+  /**
+   * Marks the end of a frame and drops entries that were not used recently.
+   */
+  void EndFrame();
+
+  /**
+   * Drops all snapshots and access statistics.
+   */
+  void Clear();
+
+  size_t GetCachedBytes() const;
+
+  size_t GetSnapshotCount() const;
+
+  uint64_t GetHitCount() const;
+
+ private:
+  /**
+   * Draws ops [begin, end) of `display_list` from a snapshot covering
+   * `bounds`, taking the snapshot first if the range is admitted.
+   *
+   * @return false if the caller has to replay the ops itself
+   */
+  bool Draw(const DisplayList& display_list, uint32_t begin, uint32_t end,
+            const Rect& bounds, Canvas* canvas);
+
+  class Impl;
+  std::unique_ptr<Impl> impl_;
+};
+
+}  // namespace skity
+
+#endif  // INCLUDE_SKITY_RECORDER_RASTER_CACHE_HPP
@@ -25,6 +25,20 @@ class SKITY_API RecordingCanvas : public Canvas {
 
   RecordedOpOffset GetLastOpOffset() const;
 
+  /**
+   * Records `display_list` as a single nested op. The child is replayed under
+   * the current matrix and clip, inside its own save/restore pair. Its bounds
+   * and properties are merged into the display list being recorded, and with
+   * an RTree enabled the child's bounds are indexed as one entry.
+   *
+   * Child lists are immutable once recorded, so independent subtrees can be
+   * recorded on several threads, each with its own PictureRecorder, and then
+   * embedded here.
+   *
+   * @param display_list  the child display list, nullptr or empty is ignored
+   */
+  void DrawDisplayList(std::shared_ptr<const DisplayList> display_list);
+
  private:
   template <typename T, typename... Args>
   void Push(Args&&... args);
@@ -12,6 +12,7 @@
 #include <skity/graphic/path.hpp>
 #include <skity/graphic/sampling_options.hpp>
 #include <skity/macros.hpp>
+#include <skity/render/frame_stats.hpp>
 #include <skity/text/glyph.hpp>
 #include <skity/text/typeface.hpp>
 
@@ -358,6 +359,15 @@ class SKITY_API Canvas {
 
   static std::unique_ptr<Canvas> MakeSoftwareCanvas(Bitmap* bitmap);
 
+  /**
+   * @return counters and histograms of the work done since the last call to
+   *         ResetFrameStats(). A canvas locked from a GPUSurface is reset at
+   *         the start of every frame.
+   */
+  const FrameStats& GetFrameStats() const { return frame_stats_; }
+
+  void ResetFrameStats() { frame_stats_.Reset(); }
+
   bool QuickReject(const Rect& rect) const;
 
  protected:
@@ -429,6 +439,8 @@ class SKITY_API Canvas {
     tracing_canvas_state_ = tracing_canvas_state;
   }
 
+  FrameStats* GetMutableFrameStats() { return &frame_stats_; }
+
  private:
   void InternalSave();
   void InternalRestore();
@@ -438,6 +450,8 @@ class SKITY_API Canvas {
   std::vector<Rect> global_clip_bounds_stack_;
   bool tracing_canvas_state_ = true;
   std::unique_ptr<CanvasState> canvas_state_;
+  FrameStats frame_stats_ = {};
+  uint32_t draw_call_depth_ = 0;
 };
 
 }  // namespace skity
@@ -0,0 +1,180 @@
+// Copyright 2021 The Lynx Authors. All rights reserved.
+// Licensed under the Apache License Version 2.0 that can be found in the
+// LICENSE file in the root directory of this source tree.
+
+#ifndef INCLUDE_SKITY_RENDER_FRAME_STATS_HPP
+#define INCLUDE_SKITY_RENDER_FRAME_STATS_HPP
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <skity/macros.hpp>
+
+namespace skity {
+
+/**
+ * @enum FrameCounter names the per frame counters collected by a Canvas.
+ *
+ * Counters of a subsystem a renderer does not have stay zero, for example the
+ * software renderer never compiles a pipeline.
+ */
+enum class FrameCounter : uint32_t {
+  /**
+   * Draw calls made on the Canvas, one per DrawXXX call that reaches the
+   * renderer.
+   */
+  kDrawCalls,
+  /**
+   * GPU draws folded into an earlier draw instead of issuing their own.
+   */
+  kMergedDraws,
+  /**
+   * Pipeline lookups served by an already compiled pipeline.
+   */
+  kPipelineCacheHits,
+  /**
+   * Pipelines compiled during the frame.
+   */
+  kPipelineCompiles,
+  /**
+   * Pipelines that failed to compile during the frame.
+   */
+  kPipelineCompileFailures,
+  /**
+   * Paths tessellated into triangles on the CPU.
+   */
+  kTessellatedPaths,
+  /**
+   * Triangles produced by CPU path tessellation.
+   */
+  kTessellatedTriangles,
+  /**
+   * Vertex and uniform bytes written to the stage buffer and uploaded.
+   */
+  kStageBufferBytes,
+  /**
+   * Index bytes written to the stage buffer and uploaded.
+   */
+  kStageIndexBytes,
+  /**
+   * Glyphs found in the glyph atlas.
+   */
+  kGlyphCacheHits,
+  /**
+   * Glyphs that had to be rasterized and added to the glyph atlas.
+   */
+  kGlyphCacheMisses,
+  /**
+   * Bytes uploaded from the glyph atlas to GPU textures.
+   */
+  kAtlasUploadBytes,
+  /**
+   * Stroke outlines reused from the stroke cache.
+   */
+  kStrokeCacheHits,
+  /**
+   * Stroke outlines computed because the stroke cache missed.
+   */
+  kStrokeCacheMisses,
+  kCount,
+};
+
+/**
+ * @enum FrameHistogram names the per frame value distributions collected by a
+ * Canvas.
+ */
+enum class FrameHistogram : uint32_t {
+  /**
+   * Wall time of each pipeline compile, in microseconds.
+   */
+  kPipelineCompileMicros,
+  /**
+   * Triangles produced by each CPU path tessellation.
+   */
+  kTrianglesPerPath,
+  /**
+   * Glyphs in each glyph draw.
+   */
+  kGlyphsPerDraw,
+  kCount,
+};
+
+/**
+ * A histogram of non-negative integers with power of two buckets. Bucket 0
+ * holds 0, bucket i holds values in [2^(i-1), 2^i), and the last bucket holds
+ * everything above. Recording a value never allocates.
+ */
+struct SKITY_API FrameHistogramData {
+  static constexpr size_t kBucketCount = 32;
+
+  uint64_t count = 0;
+  uint64_t sum = 0;
+  uint64_t min = 0;
+  uint64_t max = 0;
+  std::array<uint64_t, kBucketCount> buckets = {};
+
+  void Record(uint64_t value);
+
+  void Merge(const FrameHistogramData& other);
+
+  /**
+   * Returns the upper bound of the bucket holding the `percentile` (0 to 100)
+   * of the recorded values, clamped to `max`, or 0 if nothing was recorded.
+   */
+  uint64_t ApproximatePercentile(float percentile) const;
+
+  static size_t BucketIndex(uint64_t value);
+};
+
+/**
+ * @class FrameStats
+ * Counters and histograms of the work done by a Canvas, collected while
+ * drawing. A GPU surface resets them when a frame starts and keeps a copy of
+ * the last flushed frame, see GPUSurface::GetLastFrameStats.
+ */
+class SKITY_API FrameStats {
+ public:
+  static constexpr size_t kCounterCount =
+      static_cast<size_t>(FrameCounter::kCount);
+  static constexpr size_t kHistogramCount =
+      static_cast<size_t>(FrameHistogram::kCount);
+
+  void Increment(FrameCounter counter, uint64_t value = 1) {
+    counters_[static_cast<size_t>(counter)] += value;
+  }
+
+  void Record(FrameHistogram histogram, uint64_t value) {
+    histograms_[static_cast<size_t>(histogram)].Record(value);
+  }
+
+  uint64_t GetCounter(FrameCounter counter) const {
+    return counters_[static_cast<size_t>(counter)];
+  }
+
+  const FrameHistogramData& GetHistogram(FrameHistogram histogram) const {
+    return histograms_[static_cast<size_t>(histogram)];
+  }
+
+  /**
+   * Adds the counters and histograms of `other` to this one, for aggregating
+   * several frames or surfaces.
+   */
+  void Merge(const FrameStats& other);
+
+  void Reset();
+
+  /**
+   * Stable snake_case names, suitable as keys when exporting the statistics.
+   */
+  static const char* GetCounterName(FrameCounter counter);
+
+  static const char* GetHistogramName(FrameHistogram histogram);
+
+ private:
+  std::array<uint64_t, kCounterCount> counters_ = {};
+  std::array<FrameHistogramData, kHistogramCount> histograms_ = {};
+};
+
+}  // namespace skity
+
+#endif  // INCLUDE_SKITY_RENDER_FRAME_STATS_HPP
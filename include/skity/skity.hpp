@@ -39,9 +39,11 @@
 #include <skity/graphic/tile_mode.hpp>
 // render
 #include <skity/render/canvas.hpp>
+#include <skity/render/frame_stats.hpp>
 // recorder
 #include <skity/recorder/display_list.hpp>
 #include <skity/recorder/picture_recorder.hpp>
+#include <skity/recorder/raster_cache.hpp>
 #include <skity/recorder/recording_canvas.hpp>
 // text
 #include <skity/text/font.hpp>
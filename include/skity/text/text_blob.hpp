@@ -5,10 +5,12 @@
 #ifndef INCLUDE_SKITY_TEXT_TEXT_BLOB_HPP
 #define INCLUDE_SKITY_TEXT_TEXT_BLOB_HPP
 
+#include <memory>
 #include <skity/graphic/paint.hpp>
 #include <skity/macros.hpp>
 #include <skity/text/text_run.hpp>
 #include <string>
+#include <unordered_map>
 #include <vector>
 
 namespace skity {
@@ -43,10 +45,16 @@ class SKITY_API TextBlob final {
 class SKITY_API TypefaceDelegate {
  public:
   virtual ~TypefaceDelegate() = default;
-  TypefaceDelegate() = default;
+  TypefaceDelegate();
   TypefaceDelegate(const TypefaceDelegate&) = delete;
   TypefaceDelegate& operator=(const TypefaceDelegate&) = delete;
 
+  /**
+   * Unique for every delegate created in the process and never reused, so a
+   * new delegate allocated where a destroyed one lived is still told apart.
+   */
+  uint32_t GetID() const { return id_; }
+
   virtual std::shared_ptr<Typeface> Fallback(Unichar code_point,
                                              Paint const& text_paint) = 0;
 
@@ -54,6 +62,9 @@ class SKITY_API TypefaceDelegate {
 
   static std::unique_ptr<TypefaceDelegate> CreateSimpleFallbackDelegate(
       const std::vector<std::shared_ptr<Typeface>>& typefaces);
+
+ private:
+  uint32_t id_;
 };
 
 class SKITY_API TextBlobBuilder final {
@@ -68,7 +79,27 @@ class SKITY_API TextBlobBuilder final {
   std::shared_ptr<TextBlob> BuildTextBlob(std::string const& text,
                                           Paint const& paint);
 
+  /**
+   * The builder remembers which typeface the delegate picked for each code
+   * point and paint style missing from the paint typeface, and only asks the
+   * delegate again when the delegate or the paint typeface changes. Call this
+   * when the delegate would now answer differently for the same code point
+   * and paint for other reasons, e.g. its font list changed.
+   */
+  void ClearFallbackCache();
+
  private:
+  struct FallbackEntry {
+    std::shared_ptr<Typeface> typeface = {};
+    GlyphID glyph_id = 0;
+  };
+
+  // Code point in the low 32 bits, paint style above.
+  static uint64_t FallbackKey(Unichar code_point, Paint const& paint);
+
+  FallbackEntry const& FindFallback(Unichar code_point, Paint const& paint,
+                                    TypefaceDelegate* delegate);
+
   std::shared_ptr<TextBlob> GenerateBlobWithoutDelegate(const char* text,
                                                         Paint const& paint);
 
@@ -87,6 +118,10 @@ class SKITY_API TextBlobBuilder final {
   TextRun GenerateTextRun(std::vector<Unichar> const& code_points,
                           std::shared_ptr<Typeface> typeface, float font_size,
                           bool need_path);
+
+  std::unordered_map<uint64_t, FallbackEntry> fallback_cache_ = {};
+  uint32_t fallback_delegate_id_ = 0;
+  std::weak_ptr<Typeface> fallback_base_ = {};
 };
 }  // namespace skity
 
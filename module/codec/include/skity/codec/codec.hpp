@@ -5,6 +5,8 @@
 #ifndef MODULE_CODEC_INCLUDE_SKITY_CODEC_CODEC_HPP
 #define MODULE_CODEC_INCLUDE_SKITY_CODEC_CODEC_HPP
 
+#include <cstddef>
+#include <cstdint>
 #include <memory>
 #include <optional>
 #include <skity/graphic/alpha_type.hpp>
@@ -16,6 +18,7 @@ namespace skity {
 
 class Data;
 class Pixmap;
+struct DecodeOptions;
 
 /**
  * The rectangle of a frame in the image.
@@ -320,8 +323,37 @@ class SKITY_EXPERIMENTAL_API MultiFrameDecoder {
   virtual std::shared_ptr<Pixmap> DecodeFrame(
       const CodecFrame* frame, std::shared_ptr<Pixmap> prev_pixmap) = 0;
 
+  /**
+   * Decode the specified frame, composited over the frames it depends on, at
+   * the subset and target size of the options.
+   *
+   * Frames are composited at intrinsic size into a canvas kept by the decoder,
+   * so decoding the frames in order decodes each of them once and allocates
+   * the canvas once. The canvas is then scaled into the output.
+   *
+   * @param frame   The frame to decode.
+   * @param options The subset and target size of the output.
+   * @param output  Pixmap to write into, e.g. the one returned for the
+   *                previous frame. It is reused when it has the output size,
+   *                a new pixmap is returned otherwise.
+   *
+   * @return The decoded pixmap. nullptr if decode failed.
+   */
+  std::shared_ptr<Pixmap> DecodeFrame(const CodecFrame* frame,
+                                      const DecodeOptions& options,
+                                      std::shared_ptr<Pixmap> output);
+
  protected:
   void SetAlphaAndRequiredFrame(CodecFrame* frame);
+
+ private:
+  bool ComposeCanvas(const CodecFrame* frame);
+
+  bool CanComposeOnCanvas(const CodecFrame* frame) const;
+
+ private:
+  std::shared_ptr<Pixmap> canvas_ = {};
+  int32_t canvas_frame_id_ = CodecFrameInfo::kNoFrameRequired;
 };
 
 /**
@@ -342,6 +374,16 @@ struct DecodeOptions {
   int32_t target_width = 0;
   int32_t target_height = 0;
 
+  /**
+   * Region of the image to decode, in intrinsic pixels. Empty (default)
+   * decodes the whole image. The subset is clipped to the image bounds, the
+   * decode fails if it does not intersect the image.
+   *
+   * The target size applies to the subset: the clipped subset is scaled to fit
+   * within (target_width x target_height).
+   */
+  CodecRect subset = {};
+
   /**
    * Quality hint for decode-time scaling. Off by default; reserved for
    * tuning, may be removed before the API stabilizes.
@@ -349,6 +391,179 @@ struct DecodeOptions {
   bool prefer_quality = false;
 };
 
+/**
+ * Options for MultiFrameCache.
+ */
+struct MultiFrameCacheOptions {
+  /**
+   * Upper bound of the pixel memory held by decoded frames. Least recently
+   * used frames are evicted first, the most recent frame is always kept.
+   */
+  size_t max_bytes = 0;
+
+  /**
+   * Decode the frame following the requested one on a worker thread, so it
+   * is ready when the animation advances.
+   */
+  bool look_ahead = false;
+};
+
+/**
+ * Plays back the frames of a MultiFrameDecoder at fixed decode options.
+ *
+ * Decoded frames are kept up to a byte budget, so a short animation shown at
+ * a small size is decoded once and then replayed from memory. Returned
+ * pixmaps are never written again and may be shared with the renderer.
+ *
+ * The decoder must not be used directly while the cache is alive, the look
+ * ahead thread may be decoding with it.
+ *
+ * @note This is an experimental API. The API is unstable and may change in the
+ * future.
+ */
+class SKITY_EXPERIMENTAL_API MultiFrameCache {
+ public:
+  MultiFrameCache(std::shared_ptr<MultiFrameDecoder> decoder,
+                  const DecodeOptions& options,
+                  const MultiFrameCacheOptions& cache_options = {});
+  ~MultiFrameCache();
+
+  MultiFrameCache(const MultiFrameCache&) = delete;
+  MultiFrameCache& operator=(const MultiFrameCache&) = delete;
+
+  /**
+   * Get the frame with the given 0 based index, decoding it if it is not
+   * cached.
+   *
+   * @return The decoded pixmap. nullptr if frame_id is invalid or decode
+   *         failed.
+   */
+  std::shared_ptr<Pixmap> GetFrame(int32_t frame_id);
+
+  size_t GetCachedBytes() const;
+
+  /**
+   * Number of GetFrame() calls served without decoding on the calling thread.
+   */
+  uint64_t GetHitCount() const;
+
+ private:
+  class Impl;
+  std::unique_ptr<Impl> impl_;
+};
+
+/**
+ * Scanline filter applied before compression by codecs which support it, see
+ * the filter types of the PNG specification.
+ */
+enum class EncodeFilter {
+  /**
+   * Let the codec choose.
+   */
+  kDefault,
+  kNone,
+  kSub,
+  kUp,
+  kAverage,
+  kPaeth,
+  /**
+   * Pick the filter per row which is expected to compress best.
+   */
+  kAdaptive,
+};
+
+/**
+ * Options for Codec::Encode(const Pixmap*, const EncodeOptions&). Codecs
+ * ignore the options they do not support.
+ */
+struct EncodeOptions {
+  /**
+   * zlib style compression level in [0, 9]. -1 uses the codec default.
+   */
+  int32_t compression_level = -1;
+
+  EncodeFilter filter = EncodeFilter::kDefault;
+
+  /**
+   * Number of threads compressing independent bands of rows. The output is a
+   * single valid image either way, it is slightly larger when split since
+   * bands do not share history. Values <= 1 encode on the calling thread.
+   */
+  int32_t thread_count = 1;
+};
+
+/**
+ * Decoder which is fed the encoded data as it arrives, e.g. from the network,
+ * and exposes the rows decoded so far. Created by
+ * Codec::MakeIncrementalDecoder().
+ *
+ * The output pixmap is allocated as soon as the header is parsed and filled in
+ * place, it has the same format as the output of Codec::Decode(). Rows which
+ * are not decoded yet are transparent, or opaque black for opaque formats.
+ *
+ * @note This is an experimental API. The API is unstable and may change in the
+ * future.
+ */
+class SKITY_EXPERIMENTAL_API IncrementalDecoder {
+ public:
+  enum class Result {
+    /**
+     * All data appended so far has been consumed, more is needed to finish
+     * the image.
+     */
+    kNeedMoreData,
+    /**
+     * The image is fully decoded.
+     */
+    kComplete,
+    /**
+     * The data is broken. Rows decoded before the error stay available.
+     */
+    kError,
+  };
+
+  virtual ~IncrementalDecoder() = default;
+
+  /**
+   * Append the next chunk of encoded data and decode as far as possible.
+   * The data is copied if the decoder needs to keep it.
+   */
+  virtual Result Append(const void* data, size_t size) = 0;
+
+  /**
+   * Signal that no more data will arrive.
+   *
+   * @return kComplete if the image was complete, kError otherwise.
+   */
+  virtual Result Finish() = 0;
+
+  /**
+   * The output pixmap, nullptr until the image header has been decoded.
+   * Its pixels change with every call to Append(), the pixmap is notified
+   * through Pixmap::NotifyPixelsChanged().
+   */
+  std::shared_ptr<Pixmap> GetPixmap() const { return pixmap_; }
+
+  /**
+   * Number of rows from the top of the image which have been decoded. For
+   * progressive JPEG images every pass covers the whole image, so all rows
+   * count as decoded after the first pass and later passes refine them.
+   */
+  int32_t GetDecodedRows() const { return decoded_rows_; }
+
+  /**
+   * Number of completed passes over the whole image. Progressive JPEG and
+   * interlaced PNG images produce several passes of increasing quality, other
+   * images produce a single pass when they are complete.
+   */
+  int32_t GetCompletedPasses() const { return completed_passes_; }
+
+ protected:
+  std::shared_ptr<Pixmap> pixmap_;
+  int32_t decoded_rows_ = 0;
+  int32_t completed_passes_ = 0;
+};
+
 /**
  * Codec interface for encoding and decoding image data.
  *
@@ -370,6 +585,19 @@ class SKITY_EXPERIMENTAL_API Codec {
    */
   virtual std::shared_ptr<Data> Encode(const Pixmap* pixmap) = 0;
 
+  /**
+   * Encode the raw pixmap with the given options.
+   *
+   * @param pixmap  The raw pixmap to encode. Must not be null.
+   * @param options Encoder tuning, the default implementation ignores it.
+   *
+   * @return The encoded data. nullptr if encode failed.
+   */
+  virtual std::shared_ptr<Data> Encode(const Pixmap* pixmap,
+                                       const EncodeOptions& options) {
+    return Encode(pixmap);
+  }
+
   /**
    * Recognize the file type from header.
    *
@@ -426,6 +654,15 @@ class SKITY_EXPERIMENTAL_API Codec {
    */
   virtual std::shared_ptr<MultiFrameDecoder> DecodeMultiFrame() = 0;
 
+  /**
+   * Create a decoder which accepts the encoded data in chunks. Codecs without
+   * native incremental decoding collect the data and decode it when it is
+   * complete. Multi-frame images only decode their first frame.
+   *
+   * @return The incremental decoder. The data set by SetData() is ignored.
+   */
+  virtual std::unique_ptr<IncrementalDecoder> MakeIncrementalDecoder();
+
   /**
    * Create a codec from data. Will try to recognize the file type and create
    * the corresponding codec.
@@ -14,6 +14,7 @@
 #import <algorithm>
 
 #import "src/codec/codec_priv.hpp"
+#import "src/codec/incremental_decoder.hpp"
 
 namespace skity {
 
@@ -64,6 +65,32 @@ bool ResolveThumbnailSize(CGImageSourceRef source, const DecodeOptions& options,
  * and never upscales, matching DecodeOptions semantics. EXIF orientation is
  * applied via the transform option.
  */
+/**
+ * ImageIO has no region decoding: crops the lazily decoded frame 0 to the
+ * subset, so only the subset is drawn. Resolves the aspect-fit target of the
+ * subset into out_width / out_height, both 0 when no scaling is requested.
+ */
+CGImageRef CreateSubsetImageAtIndex(CGImageSourceRef source, const DecodeOptions& options,
+                                    int32_t* out_width, int32_t* out_height) {
+  CGImageRef image = CGImageSourceCreateImageAtIndex(source, 0, NULL);
+  if (image == nil) {
+    return nil;
+  }
+
+  CodecRect subset;
+  CGImageRef subset_image = nil;
+  if (codec_priv::ResolveSubset(static_cast<int32_t>(CGImageGetWidth(image)),
+                                static_cast<int32_t>(CGImageGetHeight(image)), options, &subset)) {
+    subset_image = CGImageCreateWithImageInRect(
+        image, CGRectMake(subset.X(), subset.Y(), subset.Width(), subset.Height()));
+    codec_priv::ResolveTargetSize(subset.Width(), subset.Height(), options, out_width, out_height);
+  }
+
+  CGImageRelease(image);
+
+  return subset_image;
+}
+
 CGImageRef CreateScaledImageAtIndex(CGImageSourceRef source, int32_t target_width,
                                     int32_t target_height) {
   int32_t max_pixel_size = std::max(target_width, target_height);
@@ -90,9 +117,14 @@ CGImageRef CreateScaledImageAtIndex(CGImageSourceRef source, int32_t target_widt
   return image;
 }
 
-std::shared_ptr<Pixmap> CGImageToPixmap(CGImageRef cg_image) {
-  size_t width = CGImageGetWidth(cg_image);
-  size_t height = CGImageGetHeight(cg_image);
+/**
+ * Draws the image into an unpremul RGBA pixmap. A non-zero output size scales
+ * the image to it.
+ */
+std::shared_ptr<Pixmap> CGImageToPixmap(CGImageRef cg_image, size_t out_width = 0,
+                                        size_t out_height = 0) {
+  size_t width = out_width > 0 ? out_width : CGImageGetWidth(cg_image);
+  size_t height = out_height > 0 ? out_height : CGImageGetHeight(cg_image);
 
   size_t bytesPerRow = width * 4;
 
@@ -126,6 +158,10 @@ std::shared_ptr<Pixmap> CGImageToPixmap(CGImageRef cg_image) {
   CGContextTranslateCTM(ctx, 0, height);
   CGContextScaleCTM(ctx, 1.0, -1.0);
 
+  if (out_width > 0 || out_height > 0) {
+    CGContextSetInterpolationQuality(ctx, kCGInterpolationHigh);
+  }
+
   CGContextDrawImage(ctx, CGRectMake(0, 0, width, height), cg_image);
 
   CGContextRelease(ctx);
@@ -317,7 +353,12 @@ std::shared_ptr<Pixmap> CodecApple::Decode(const DecodeOptions& options) {
   CGImageRef cg_image = nil;
   int32_t target_width = 0;
   int32_t target_height = 0;
-  if (ResolveThumbnailSize(source, options, &target_width, &target_height)) {
+  // Size the subset is drawn at, the thumbnail is already scaled by ImageIO.
+  int32_t draw_width = 0;
+  int32_t draw_height = 0;
+  if (!options.subset.IsEmpty()) {
+    cg_image = CreateSubsetImageAtIndex(source, options, &draw_width, &draw_height);
+  } else if (ResolveThumbnailSize(source, options, &target_width, &target_height)) {
     cg_image = CreateScaledImageAtIndex(source, target_width, target_height);
   } else {
     cg_image = CGImageSourceCreateImageAtIndex(source, 0, NULL);
@@ -329,7 +370,7 @@ std::shared_ptr<Pixmap> CodecApple::Decode(const DecodeOptions& options) {
     return {};
   }
 
-  auto pixmap = CGImageToPixmap(cg_image);
+  auto pixmap = CGImageToPixmap(cg_image, draw_width, draw_height);
 
   CGImageRelease(cg_image);
 
@@ -438,6 +479,12 @@ std::shared_ptr<Codec> Codec::MakeFromData(const std::shared_ptr<Data>& data) {
   return std::make_shared<CodecApple>(TargetImageType::kUnknown);
 }
 
+std::unique_ptr<IncrementalDecoder> Codec::MakeIncrementalDecoder() {
+  // ImageIO has incremental sources, but the buffered fallback keeps the
+  // results identical to Decode().
+  return std::make_unique<BufferedIncrementalDecoder>(Fork());
+}
+
 std::shared_ptr<Codec> Codec::MakeGIFCodec() {
   return std::make_shared<CodecApple>(TargetImageType::kGIF);
 }
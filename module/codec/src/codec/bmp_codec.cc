@@ -87,11 +87,12 @@ bool BMPCodec::RecognizeFileType(const char* header, size_t size) {
 std::shared_ptr<MultiFrameDecoder> BMPCodec::DecodeMultiFrame() { return {}; }
 
 std::shared_ptr<Pixmap> BMPCodec::Decode(const DecodeOptions& options) {
-  // BMP is uncompressed and has no scaled decoding; resample after decode.
-  return codec_priv::ResamplePixmapToTarget(DecodeIntrinsic(), options);
+  // BMP is uncompressed: only the rows and columns of the subset are read, the
+  // result is resampled to the target size after decode.
+  return codec_priv::ResamplePixmapToTarget(DecodeSubset(options), options);
 }
 
-std::shared_ptr<Pixmap> BMPCodec::DecodeIntrinsic() {
+std::shared_ptr<Pixmap> BMPCodec::DecodeSubset(const DecodeOptions& options) {
   if (!data_) {
     return nullptr;
   }
@@ -129,6 +130,15 @@ std::shared_ptr<Pixmap> BMPCodec::DecodeIntrinsic() {
     return nullptr;
   }
 
+  CodecRect subset;
+  if (!codec_priv::ResolveSubset(static_cast<int32_t>(width),
+                                 static_cast<int32_t>(height), options,
+                                 &subset)) {
+    return nullptr;
+  }
+  uint32_t out_width = static_cast<uint32_t>(subset.Width());
+  uint32_t out_height = static_cast<uint32_t>(subset.Height());
+
   if (compression != BI_RGB && compression != BI_BITFIELDS) {
     return nullptr;
   }
@@ -175,7 +185,8 @@ std::shared_ptr<Pixmap> BMPCodec::DecodeIntrinsic() {
 
   uint32_t row_size = ((width * bpp + 31) / 32) * 4;
 
-  auto* output = static_cast<uint8_t*>(std::malloc(width * height * 4));
+  size_t output_size = static_cast<size_t>(out_width) * out_height * 4;
+  auto* output = static_cast<uint8_t*>(std::malloc(output_size));
   if (!output) {
     return nullptr;
   }
@@ -196,38 +207,42 @@ std::shared_ptr<Pixmap> BMPCodec::DecodeIntrinsic() {
     }
   }
 
-  for (uint32_t y = 0; y < height; y++) {
-    uint32_t src_y = top_down ? y : (height - 1 - y);
+  // Only rows and columns inside the subset are converted, x and y are
+  // relative to its top left corner.
+  uint32_t left = static_cast<uint32_t>(subset.X());
+  for (uint32_t y = 0; y < out_height; y++) {
+    uint32_t image_y = static_cast<uint32_t>(subset.Y()) + y;
+    uint32_t src_y = top_down ? image_y : (height - 1 - image_y);
     const uint8_t* src_row = pixel_data + src_y * row_size;
-    uint8_t* dst_row = output + y * width * 4;
+    uint8_t* dst_row = output + static_cast<size_t>(y) * out_width * 4;
 
     if (bpp == 8) {
-      for (uint32_t x = 0; x < width; x++) {
-        uint8_t idx = src_row[x] * 4;
+      for (uint32_t x = 0; x < out_width; x++) {
+        uint8_t idx = src_row[left + x] * 4;
         dst_row[x * 4 + 0] = palette[idx + 0];
         dst_row[x * 4 + 1] = palette[idx + 1];
         dst_row[x * 4 + 2] = palette[idx + 2];
         dst_row[x * 4 + 3] = palette[idx + 3];
       }
     } else if (bpp == 24) {
-      for (uint32_t x = 0; x < width; x++) {
-        dst_row[x * 4 + 0] = src_row[x * 3 + 2];
-        dst_row[x * 4 + 1] = src_row[x * 3 + 1];
-        dst_row[x * 4 + 2] = src_row[x * 3 + 0];
+      for (uint32_t x = 0; x < out_width; x++) {
+        dst_row[x * 4 + 0] = src_row[(left + x) * 3 + 2];
+        dst_row[x * 4 + 1] = src_row[(left + x) * 3 + 1];
+        dst_row[x * 4 + 2] = src_row[(left + x) * 3 + 0];
         dst_row[x * 4 + 3] = 0xFF;
       }
     } else {
       if (compression == BI_RGB) {
-        for (uint32_t x = 0; x < width; x++) {
-          dst_row[x * 4 + 0] = src_row[x * 4 + 2];
-          dst_row[x * 4 + 1] = src_row[x * 4 + 1];
-          dst_row[x * 4 + 2] = src_row[x * 4 + 0];
-          uint8_t alpha = src_row[x * 4 + 3];
+        for (uint32_t x = 0; x < out_width; x++) {
+          dst_row[x * 4 + 0] = src_row[(left + x) * 4 + 2];
+          dst_row[x * 4 + 1] = src_row[(left + x) * 4 + 1];
+          dst_row[x * 4 + 2] = src_row[(left + x) * 4 + 0];
+          uint8_t alpha = src_row[(left + x) * 4 + 3];
           dst_row[x * 4 + 3] = all_alpha_zero ? 0xFF : alpha;
         }
       } else {
-        for (uint32_t x = 0; x < width; x++) {
-          uint32_t pixel = ReadU32(src_row + x * 4);
+        for (uint32_t x = 0; x < out_width; x++) {
+          uint32_t pixel = ReadU32(src_row + (left + x) * 4);
           dst_row[x * 4 + 0] = ExtractComponent(pixel, r_mask);
           dst_row[x * 4 + 1] = ExtractComponent(pixel, g_mask);
           dst_row[x * 4 + 2] = ExtractComponent(pixel, b_mask);
@@ -237,8 +252,9 @@ std::shared_ptr<Pixmap> BMPCodec::DecodeIntrinsic() {
     }
   }
 
-  auto raw_data = Data::MakeFromMalloc(output, width * height * 4);
-  return std::make_shared<Pixmap>(raw_data, width * 4, width, height);
+  auto raw_data = Data::MakeFromMalloc(output, output_size);
+  return std::make_shared<Pixmap>(raw_data, out_width * 4, out_width,
+                                  out_height);
 }
 
 std::shared_ptr<Data> BMPCodec::Encode(const Pixmap* pixmap) {
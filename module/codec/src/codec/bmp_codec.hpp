@@ -16,6 +16,7 @@ class BMPCodec : public Codec {
 
   std::shared_ptr<Pixmap> Decode(const DecodeOptions& options) override;
   std::shared_ptr<MultiFrameDecoder> DecodeMultiFrame() override;
+  using Codec::Encode;
   std::shared_ptr<Data> Encode(const Pixmap* pixmap) override;
   bool RecognizeFileType(const char* header, size_t size) override;
 
@@ -25,7 +26,8 @@ class BMPCodec : public Codec {
   }
 
  private:
-  std::shared_ptr<Pixmap> DecodeIntrinsic();
+  // Decodes the subset of the options at intrinsic size.
+  std::shared_ptr<Pixmap> DecodeSubset(const DecodeOptions& options);
 };
 
 }  // namespace skity
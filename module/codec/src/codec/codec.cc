@@ -11,6 +11,7 @@
 #include "src/codec/gif_codec.hpp"
 #endif
 #include "src/codec/bmp_codec.hpp"
+#include "src/codec/incremental_decoder.hpp"
 #include "src/codec/jpeg_codec.hpp"
 #include "src/codec/png_codec.hpp"
 
@@ -59,6 +60,10 @@ std::shared_ptr<Codec> Codec::MakeFromData(const std::shared_ptr<Data>& data) {
   return nullptr;
 }
 
+std::unique_ptr<IncrementalDecoder> Codec::MakeIncrementalDecoder() {
+  return std::make_unique<BufferedIncrementalDecoder>(Fork());
+}
+
 std::shared_ptr<Codec> Codec::MakePngCodec() {
   return std::make_shared<PNGCodec>();
 }
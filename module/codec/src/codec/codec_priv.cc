@@ -7,8 +7,18 @@
 #include <algorithm>
 #include <cstdlib>
 #include <limits>
+#include <skity/macros.hpp>
+#include <utility>
 #include <vector>
 
+#if defined(SKITY_ARM_NEON)
+#include <arm_neon.h>
+#elif defined(__SSE2__) || defined(_M_X64) || \
+    (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define SKITY_CODEC_SSE2
+#endif
+
 namespace skity {
 namespace codec_priv {
 
@@ -17,11 +27,281 @@ namespace {
 // Fixed-point scale for resampling weights: 1 << 16 == one source pixel.
 constexpr int32_t kFixedOne = 1 << 16;
 
-struct Contribution {
-  int32_t index;
-  int32_t weight;
+inline uint8_t PremulChannel(uint8_t c, uint8_t a) {
+  return static_cast<uint8_t>((static_cast<uint32_t>(c) * a + 127) / 255);
+}
+
+inline uint8_t UnpremulChannel(uint8_t c, uint8_t a) {
+  if (a == 0) {
+    return 0;
+  }
+  return static_cast<uint8_t>(
+      std::min<uint32_t>(255, (static_cast<uint32_t>(c) * 255 + a / 2) / a));
+}
+
+inline uint8_t DivRound(int64_t value, int64_t weight) {
+  return static_cast<uint8_t>((value + weight / 2) / weight);
+}
+
+// Computes a * b into *out in size_t; returns false on overflow. Buffer sizes
+// derived from image dimensions must go through this — decoding a pixmap with
+// pathological dimensions (width > 2^29) would otherwise overflow the int
+// expressions and under-allocate.
+inline bool CheckedMul(size_t a, size_t b, size_t* out) {
+  if (b != 0 && a > std::numeric_limits<size_t>::max() / b) {
+    return false;
+  }
+  *out = a * b;
+  return true;
+}
+
+// Reciprocal of each alpha in 8.24 fixed point, rounded. The same table as
+// PMColorToColor() uses, so the kernels match it exactly.
+struct UnpremulTable {
+  constexpr UnpremulTable() : scale() {
+    for (uint32_t a = 1; a < 256; a++) {
+      scale[a] = ((255u << 24) + a / 2) / a;
+    }
+  }
+
+  uint32_t scale[256];
 };
 
+constexpr UnpremulTable kUnpremulTable = {};
+
+// Pixels are read as little-endian uint32, alpha is the top byte for both
+// RGBA and BGRA.
+constexpr uint32_t kAlphaMask = 0xFF000000;
+
+inline uint32_t UnpremulScale(uint32_t scale, uint32_t c) {
+  // Wraps like UnPreMultiply::ApplyScale() on invalid premul input.
+  return (scale * c + (1u << 23)) >> 24;
+}
+
+struct PremulOp {
+  static uint32_t Pixel(uint32_t c) {
+    const uint32_t a = c >> 24;
+    return (c & kAlphaMask) | PremulChannel(c & 0xFF, a) |
+           (PremulChannel((c >> 8) & 0xFF, a) << 8) |
+           (PremulChannel((c >> 16) & 0xFF, a) << 16);
+  }
+
+#if defined(SKITY_ARM_NEON)
+  static uint8x8_t MulDiv255(uint8x8_t x, uint8x8_t y) {
+    uint16x8_t prod = vmull_u8(x, y);
+    return vraddhn_u16(prod, vrshrq_n_u16(prod, 8));
+  }
+
+  static void Neon(uint8x8x4_t* px) {
+    for (int i = 0; i < 3; i++) {
+      px->val[i] = MulDiv255(px->val[i], px->val[3]);
+    }
+  }
+#elif defined(SKITY_CODEC_SSE2)
+  // Rounded c * a / 255 on 16 bit lanes, two pixels at a time.
+  static __m128i MulDiv255(__m128i c) {
+    const __m128i alpha_lanes = _mm_set_epi16(255, 0, 0, 0, 255, 0, 0, 0);
+    const __m128i color_lanes = _mm_set_epi16(0, -1, -1, -1, 0, -1, -1, -1);
+    __m128i a = _mm_shufflehi_epi16(
+        _mm_shufflelo_epi16(c, _MM_SHUFFLE(3, 3, 3, 3)),
+        _MM_SHUFFLE(3, 3, 3, 3));
+    a = _mm_or_si128(_mm_and_si128(a, color_lanes), alpha_lanes);
+    __m128i prod = _mm_add_epi16(_mm_mullo_epi16(c, a), _mm_set1_epi16(128));
+    return _mm_srli_epi16(_mm_add_epi16(prod, _mm_srli_epi16(prod, 8)), 8);
+  }
+
+  static __m128i SSE2(__m128i px) {
+    const __m128i zero = _mm_setzero_si128();
+    return _mm_packus_epi16(MulDiv255(_mm_unpacklo_epi8(px, zero)),
+                            MulDiv255(_mm_unpackhi_epi8(px, zero)));
+  }
+#endif
+};
+
+struct UnpremulOp {
+  static uint32_t Pixel(uint32_t c) {
+    const uint32_t scale = kUnpremulTable.scale[c >> 24];
+    return (c & kAlphaMask) | UnpremulScale(scale, c & 0xFF) |
+           (UnpremulScale(scale, (c >> 8) & 0xFF) << 8) |
+           (UnpremulScale(scale, (c >> 16) & 0xFF) << 16);
+  }
+
+#if defined(SKITY_ARM_NEON)
+  static uint8x8_t ApplyScale(uint32x4_t scale_lo, uint32x4_t scale_hi,
+                              uint8x8_t c) {
+    const uint32x4_t round = vdupq_n_u32(1u << 23);
+    uint16x8_t c16 = vmovl_u8(c);
+    uint32x4_t lo = vmlaq_u32(round, scale_lo, vmovl_u16(vget_low_u16(c16)));
+    uint32x4_t hi = vmlaq_u32(round, scale_hi, vmovl_u16(vget_high_u16(c16)));
+    return vmovn_u16(vcombine_u16(vmovn_u32(vshrq_n_u32(lo, 24)),
+                                  vmovn_u32(vshrq_n_u32(hi, 24))));
+  }
+
+  static void Neon(uint8x8x4_t* px) {
+    uint8x8_t opaque = vceq_u8(px->val[3], vdup_n_u8(255));
+    if (vget_lane_u64(vreinterpret_u64_u8(opaque), 0) == ~uint64_t{0}) {
+      return;
+    }
+
+    uint8_t alpha[8];
+    uint32_t scale[8];
+    vst1_u8(alpha, px->val[3]);
+    for (int i = 0; i < 8; i++) {
+      scale[i] = kUnpremulTable.scale[alpha[i]];
+    }
+    uint32x4_t scale_lo = vld1q_u32(scale);
+    uint32x4_t scale_hi = vld1q_u32(scale + 4);
+    for (int i = 0; i < 3; i++) {
+      px->val[i] = ApplyScale(scale_lo, scale_hi, px->val[i]);
+    }
+  }
+#elif defined(SKITY_CODEC_SSE2)
+  // SSE2 has no 32 bit mullo, multiply the even and odd lanes apart.
+  static __m128i MulLo32(__m128i a, __m128i b) {
+    __m128i even = _mm_mul_epu32(a, b);
+    __m128i odd = _mm_mul_epu32(_mm_srli_epi64(a, 32), _mm_srli_epi64(b, 32));
+    return _mm_unpacklo_epi32(_mm_shuffle_epi32(even, _MM_SHUFFLE(0, 0, 2, 0)),
+                              _mm_shuffle_epi32(odd, _MM_SHUFFLE(0, 0, 2, 0)));
+  }
+
+  static __m128i SSE2(__m128i px) {
+    const __m128i alpha_mask = _mm_set1_epi32(static_cast<int>(kAlphaMask));
+    __m128i alpha = _mm_and_si128(px, alpha_mask);
+    if (_mm_movemask_epi8(_mm_cmpeq_epi32(alpha, alpha_mask)) == 0xFFFF) {
+      return px;
+    }
+
+    alignas(16) uint32_t a[4];
+    _mm_store_si128(reinterpret_cast<__m128i*>(a), _mm_srli_epi32(px, 24));
+    const __m128i scale = _mm_set_epi32(
+        static_cast<int>(kUnpremulTable.scale[a[3]]),
+        static_cast<int>(kUnpremulTable.scale[a[2]]),
+        static_cast<int>(kUnpremulTable.scale[a[1]]),
+        static_cast<int>(kUnpremulTable.scale[a[0]]));
+    const __m128i channel_mask = _mm_set1_epi32(0xFF);
+    const __m128i round = _mm_set1_epi32(1 << 23);
+
+    __m128i result = alpha;
+    for (int shift = 0; shift < 24; shift += 8) {
+      __m128i c = _mm_and_si128(_mm_srl_epi32(px, _mm_cvtsi32_si128(shift)),
+                                channel_mask);
+      c = _mm_srli_epi32(_mm_add_epi32(MulLo32(scale, c), round), 24);
+      result = _mm_or_si128(result, _mm_sll_epi32(c, _mm_cvtsi32_si128(shift)));
+    }
+    return result;
+  }
+#endif
+};
+
+struct SwizzleRBOp {
+  static uint32_t Pixel(uint32_t c) {
+    return (c & 0xFF00FF00) | ((c & 0xFF) << 16) | ((c >> 16) & 0xFF);
+  }
+
+#if defined(SKITY_ARM_NEON)
+  static void Neon(uint8x8x4_t* px) { std::swap(px->val[0], px->val[2]); }
+#elif defined(SKITY_CODEC_SSE2)
+  static __m128i SSE2(__m128i px) {
+    __m128i rb = _mm_and_si128(px, _mm_set1_epi32(0x00FF00FF));
+    __m128i ga = _mm_andnot_si128(_mm_set1_epi32(0x00FF00FF), px);
+    return _mm_or_si128(ga, _mm_or_si128(_mm_slli_epi32(rb, 16),
+                                         _mm_srli_epi32(rb, 16)));
+  }
+#endif
+};
+
+template <typename First, typename Second>
+struct ComposeOp {
+  static uint32_t Pixel(uint32_t c) {
+    return Second::Pixel(First::Pixel(c));
+  }
+
+#if defined(SKITY_ARM_NEON)
+  static void Neon(uint8x8x4_t* px) {
+    First::Neon(px);
+    Second::Neon(px);
+  }
+#elif defined(SKITY_CODEC_SSE2)
+  static __m128i SSE2(__m128i px) {
+    return Second::SSE2(First::SSE2(px));
+  }
+#endif
+};
+
+// Runs the vector kernel of Op over whole blocks and the scalar one over the
+// tail. Blocks are loaded before they are stored, so dst may alias src.
+template <typename Op>
+void TransformLine(uint8_t* dst, const uint8_t* src, int width,
+                   int bytes_per_pixel) {
+  // currently we only support RGBA or BGRA
+  if (bytes_per_pixel != 4) {
+    return;
+  }
+
+  int x = 0;
+#if defined(SKITY_ARM_NEON)
+  for (; x + 8 <= width; x += 8) {
+    uint8x8x4_t px = vld4_u8(src + x * 4);
+    Op::Neon(&px);
+    vst4_u8(dst + x * 4, px);
+  }
+#elif defined(SKITY_CODEC_SSE2)
+  for (; x + 4 <= width; x += 4) {
+    __m128i px = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + x * 4));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + x * 4), Op::SSE2(px));
+  }
+#endif
+
+  for (; x < width; x++) {
+    uint32_t c;
+    std::memcpy(&c, src + x * 4, 4);
+    c = Op::Pixel(c);
+    std::memcpy(dst + x * 4, &c, 4);
+  }
+}
+
+}  // namespace
+
+void CodecTransformLinePremul(uint8_t* dst, uint8_t* src, int width,
+                              int bytes_per_pixel) {
+  TransformLine<PremulOp>(dst, src, width, bytes_per_pixel);
+}
+
+void CodecTransformLineUnpremul(uint8_t* dst, uint8_t* src, int width,
+                                int bytes_per_pixel) {
+  TransformLine<UnpremulOp>(dst, src, width, bytes_per_pixel);
+}
+
+void CodecTransformLineSwizzelRB(uint8_t* dst, uint8_t* src, int width,
+                                 int bytes_per_pixel) {
+  TransformLine<SwizzleRBOp>(dst, src, width, bytes_per_pixel);
+}
+
+void CodecTransformLineUnpremulSwizzelRB(uint8_t* dst, uint8_t* src, int width,
+                                         int bytes_per_pixel) {
+  TransformLine<ComposeOp<UnpremulOp, SwizzleRBOp>>(dst, src, width,
+                                                    bytes_per_pixel);
+}
+
+TransformLineFunc ChooseLineTransformFunc(ColorType color_type,
+                                          AlphaType alpha_type) {
+  if (color_type == ColorType::kRGBA) {
+    if (alpha_type == AlphaType::kPremul_AlphaType) {
+      return CodecTransformLineUnpremul;
+    }
+    return CodecTransformLineByPass;
+  }
+
+  if (color_type == ColorType::kBGRA) {
+    if (alpha_type == AlphaType::kUnpremul_AlphaType) {
+      return CodecTransformLineSwizzelRB;
+    }
+    return CodecTransformLineUnpremulSwizzelRB;
+  }
+
+  return CodecTransformLineByPass;
+}
+
 /**
  * Builds the per-output-pixel list of (source index, weight) contributions
  * along one axis. Weights are fixed-point overlaps of the output pixel's
@@ -33,9 +313,9 @@ struct Contribution {
  * an output pixel without contributions and a zero accumulated weight; such
  * pixels fall back to the nearest source pixel at full weight.
  */
-void BuildContributions(int32_t src_dim, int32_t dst_dim,
-                        std::vector<Contribution>* contributions,
-                        std::vector<int32_t>* offsets) {
+void RowResampler::BuildContributions(int32_t src_dim, int32_t dst_dim,
+                                      std::vector<Contribution>* contributions,
+                                      std::vector<int32_t>* offsets) {
   offsets->assign(dst_dim + 1, 0);
   contributions->clear();
 
@@ -67,116 +347,168 @@ void BuildContributions(int32_t src_dim, int32_t dst_dim,
   (*offsets)[dst_dim] = static_cast<int32_t>(contributions->size());
 }
 
-inline uint8_t PremulChannel(uint8_t c, uint8_t a) {
-  return static_cast<uint8_t>((static_cast<uint32_t>(c) * a + 127) / 255);
-}
-
-inline uint8_t UnpremulChannel(uint8_t c, uint8_t a) {
-  if (a == 0) {
-    return 0;
+RowResampler::RowResampler(int32_t src_width, int32_t src_height,
+                           int32_t dst_width, int32_t dst_height,
+                           std::shared_ptr<Pixmap> dst)
+    : src_width_(src_width),
+      src_height_(src_height),
+      dst_width_(dst_width),
+      dst_height_(dst_height) {
+  if (src_width <= 0 || src_height <= 0 || dst_width <= 0 || dst_height <= 0) {
+    return;
   }
-  return static_cast<uint8_t>(
-      std::min<uint32_t>(255, (static_cast<uint32_t>(c) * 255 + a / 2) / a));
-}
 
-inline uint8_t DivRound(int64_t value, int64_t weight) {
-  return static_cast<uint8_t>((value + weight / 2) / weight);
-}
-
-// Computes a * b into *out in size_t; returns false on overflow. Buffer sizes
-// derived from image dimensions must go through this — decoding a pixmap with
-// pathological dimensions (width > 2^29) would otherwise overflow the int
-// expressions and under-allocate.
-inline bool CheckedMul(size_t a, size_t b, size_t* out) {
-  if (b != 0 && a > std::numeric_limits<size_t>::max() / b) {
-    return false;
+  // All byte sizes and pixel offsets are computed in size_t — at int32
+  // dimensions the plain int expressions overflow first.
+  size_t src_row_bytes = 0;
+  size_t mid_row_bytes = 0;
+  if (!CheckedMul(static_cast<size_t>(src_width), 4, &src_row_bytes) ||
+      !CheckedMul(static_cast<size_t>(dst_width), 4, &mid_row_bytes)) {
+    return;
   }
-  *out = a * b;
-  return true;
-}
 
-}  // namespace
+  BuildContributions(src_width, dst_width, &x_contrib_, &x_offsets_);
+  BuildContributions(src_height, dst_height, &y_contrib_, &y_offsets_);
+
+  // An output row is open from its first to its last source row. Rows open
+  // in order, so the most rows open at once is the widest run of rows whose
+  // first source row is not past the last source row of the run's head.
+  for (int32_t y = 0, tail = 0; y < dst_height; y++) {
+    const int32_t last = y_contrib_[y_offsets_[y + 1] - 1].index;
+    tail = std::max(tail, y);
+    while (tail + 1 < dst_height &&
+           y_contrib_[y_offsets_[tail + 1]].index <= last) {
+      tail++;
+    }
+    window_rows_ = std::max(window_rows_, tail - y + 1);
+  }
 
-void CodecTransformLinePremul(uint8_t* dst, uint8_t* src, int width,
-                              int bytes_per_pixel) {
-  // currently we only support RGBA or BGRA
-  if (bytes_per_pixel != 4) {
+  size_t acc_size = 0;
+  if (!CheckedMul(mid_row_bytes, static_cast<size_t>(window_rows_),
+                  &acc_size)) {
     return;
   }
 
-  auto dst32 = reinterpret_cast<uint32_t*>(dst);
-  auto src32 = reinterpret_cast<uint32_t*>(src);
-  for (int x = 0; x < width; x++) {
-    auto pm_color = *src32;
-    *dst32 = ColorToPMColor(pm_color);
-
-    dst32++;
-    src32++;
+  premul_row_.resize(src_row_bytes);
+  mid_row_.resize(mid_row_bytes);
+  acc_.assign(acc_size, 0);
+
+  if (dst && dst->Width() == static_cast<uint32_t>(dst_width) &&
+      dst->Height() == static_cast<uint32_t>(dst_height) &&
+      dst->GetColorType() == ColorType::kRGBA &&
+      dst->GetAlphaType() == AlphaType::kUnpremul_AlphaType) {
+    dst_ = std::move(dst);
+  } else {
+    dst_ = std::make_shared<Pixmap>(
+        static_cast<uint32_t>(dst_width), static_cast<uint32_t>(dst_height),
+        AlphaType::kUnpremul_AlphaType, ColorType::kRGBA);
+  }
+  if (dst_->WritableAddr() == nullptr) {
+    dst_ = nullptr;
   }
 }
 
-void CodecTransformLineUnpremul(uint8_t* dst, uint8_t* src, int width,
-                                int bytes_per_pixel) {
-  // currently we only support RGBA or BGRA
-  if (bytes_per_pixel != 4) {
+RowResampler::~RowResampler() = default;
+
+void RowResampler::PushRow(const uint8_t* row) {
+  if (!dst_ || src_row_ >= src_height_) {
     return;
   }
 
-  auto dst32 = reinterpret_cast<uint32_t*>(dst);
-  auto src32 = reinterpret_cast<uint32_t*>(src);
-  for (int x = 0; x < width; x++) {
-    auto pm_color = *src32;
-    *dst32 = PMColorToColor(pm_color);
-
-    dst32++;
-    src32++;
+  // Horizontal box filter of the premultiplied row.
+  for (int32_t x = 0; x < src_width_; x++) {
+    size_t idx = static_cast<size_t>(x) * 4;
+    uint8_t a = row[idx + 3];
+    premul_row_[idx + 0] = PremulChannel(row[idx + 0], a);
+    premul_row_[idx + 1] = PremulChannel(row[idx + 1], a);
+    premul_row_[idx + 2] = PremulChannel(row[idx + 2], a);
+    premul_row_[idx + 3] = a;
   }
-}
 
-void CodecTransformLineSwizzelRB(uint8_t* dst, uint8_t* src, int width,
-                                 int bytes_per_pixel) {
-  // currently we only support RGBA or BGRA
-  if (bytes_per_pixel != 4) {
-    return;
+  for (int32_t x = 0; x < dst_width_; x++) {
+    int64_t r = 0, g = 0, b = 0, a = 0, weight = 0;
+    for (int32_t c = x_offsets_[x]; c < x_offsets_[x + 1]; c++) {
+      const Contribution& contrib = x_contrib_[c];
+      const uint8_t* p =
+          premul_row_.data() + static_cast<size_t>(contrib.index) * 4;
+      r += static_cast<int64_t>(p[0]) * contrib.weight;
+      g += static_cast<int64_t>(p[1]) * contrib.weight;
+      b += static_cast<int64_t>(p[2]) * contrib.weight;
+      a += static_cast<int64_t>(p[3]) * contrib.weight;
+      weight += contrib.weight;
+    }
+
+    uint8_t* out = mid_row_.data() + static_cast<size_t>(x) * 4;
+    out[0] = DivRound(r, weight);
+    out[1] = DivRound(g, weight);
+    out[2] = DivRound(b, weight);
+    out[3] = DivRound(a, weight);
   }
 
-  auto dst32 = reinterpret_cast<uint32_t*>(dst);
-  auto src32 = reinterpret_cast<uint32_t*>(src);
-  for (int x = 0; x < width; x++) {
-    auto pm_color = *src32;
-    *dst32 = ColorSwizzleRB(pm_color);
+  // Vertical pass: add the row to every open output row it covers, and emit
+  // the rows it is the last contribution of.
+  const size_t mid_row_bytes = mid_row_.size();
+  for (int32_t y = dst_row_;
+       y < dst_height_ && y_contrib_[y_offsets_[y]].index <= src_row_; y++) {
+    // The source rows of an output row are consecutive.
+    const int32_t first = y_contrib_[y_offsets_[y]].index;
+    const int32_t c = y_offsets_[y] + (src_row_ - first);
+    if (c >= y_offsets_[y + 1]) {
+      continue;
+    }
 
-    dst32++;
-    src32++;
+    const int32_t row_weight = y_contrib_[c].weight;
+    int64_t* acc =
+        acc_.data() + static_cast<size_t>(y % window_rows_) * mid_row_bytes;
+    for (size_t x = 0; x < mid_row_bytes; x++) {
+      acc[x] += static_cast<int64_t>(mid_row_[x]) * row_weight;
+    }
   }
+
+  while (dst_row_ < dst_height_ &&
+         y_contrib_[y_offsets_[dst_row_ + 1] - 1].index == src_row_) {
+    EmitRow(dst_row_++);
+  }
+
+  src_row_++;
 }
 
-std::function<void(uint8_t* dst, uint8_t* src, int width, int bytes_per_pixel)>
-ChooseLineTransformFunc(ColorType color_type, AlphaType alpha_type) {
-  if (color_type != ColorType::kRGBA && color_type != ColorType::kBGRA) {
-    return CodecTransformLineByPass;
+void RowResampler::EmitRow(int32_t y) {
+  int64_t weight = 0;
+  for (int32_t c = y_offsets_[y]; c < y_offsets_[y + 1]; c++) {
+    weight += y_contrib_[c].weight;
   }
 
-  if (color_type == ColorType::kRGBA) {
-    if (alpha_type == AlphaType::kPremul_AlphaType) {
-      return CodecTransformLineUnpremul;
-    } else {
-      return CodecTransformLineByPass;
-    }
+  // Convert back to unpremul on output and clear the slot for the row which
+  // reuses it.
+  int64_t* acc =
+      acc_.data() + static_cast<size_t>(y % window_rows_) * mid_row_.size();
+  uint8_t* out_row = dst_->WritableAddr8(0, y);
+  for (int32_t x = 0; x < dst_width_; x++) {
+    size_t idx = static_cast<size_t>(x) * 4;
+    uint8_t a = DivRound(acc[idx + 3], weight);
+    out_row[idx + 0] = UnpremulChannel(DivRound(acc[idx + 0], weight), a);
+    out_row[idx + 1] = UnpremulChannel(DivRound(acc[idx + 1], weight), a);
+    out_row[idx + 2] = UnpremulChannel(DivRound(acc[idx + 2], weight), a);
+    out_row[idx + 3] = a;
   }
+  std::fill(acc, acc + mid_row_.size(), 0);
+}
 
-  if (color_type == ColorType::kBGRA) {
-    if (alpha_type == AlphaType::kUnpremul_AlphaType) {
-      return CodecTransformLineSwizzelRB;
-    } else {
-      return [](uint8_t* dst, uint8_t* src, int width, int bytes_per_pixel) {
-        CodecTransformLineUnpremul(dst, src, width, bytes_per_pixel);
-        CodecTransformLineSwizzelRB(dst, src, width, bytes_per_pixel);
-      };
-    }
+std::shared_ptr<Pixmap> RowResampler::Finish() {
+  if (!dst_ || src_row_ < src_height_) {
+    return nullptr;
   }
 
-  return CodecTransformLineByPass;
+  return dst_;
+}
+
+size_t RowResampler::GetWorkingBytes() const {
+  return premul_row_.capacity() + mid_row_.capacity() +
+         acc_.capacity() * sizeof(int64_t) +
+         (x_contrib_.capacity() + y_contrib_.capacity()) *
+             sizeof(Contribution) +
+         (x_offsets_.capacity() + y_offsets_.capacity()) * sizeof(int32_t);
 }
 
 std::shared_ptr<Pixmap> ResamplePixmap(const std::shared_ptr<Pixmap>& src,
@@ -203,94 +535,16 @@ std::shared_ptr<Pixmap> ResamplePixmap(const std::shared_ptr<Pixmap>& src,
     return src;
   }
 
-  std::vector<Contribution> x_contrib;
-  std::vector<int32_t> x_offsets;
-  BuildContributions(src_width, dst_width, &x_contrib, &x_offsets);
-
-  std::vector<Contribution> y_contrib;
-  std::vector<int32_t> y_offsets;
-  BuildContributions(src_height, dst_height, &y_contrib, &y_offsets);
-
-  // Pass 1: horizontal box filter into a premul intermediate of
-  // src_height x dst_width. All byte sizes and pixel offsets are computed in
-  // size_t — at int32 dimensions the plain int expressions overflow first.
-  size_t src_row_bytes = 0;
-  size_t mid_row_bytes = 0;
-  size_t mid_bytes = 0;
-  if (!CheckedMul(static_cast<size_t>(src_width), 4, &src_row_bytes) ||
-      !CheckedMul(static_cast<size_t>(dst_width), 4, &mid_row_bytes) ||
-      !CheckedMul(static_cast<size_t>(src_height), mid_row_bytes, &mid_bytes)) {
+  RowResampler resampler(src_width, src_height, dst_width, dst_height);
+  if (!resampler.IsValid()) {
     return nullptr;
   }
 
-  std::vector<uint8_t> premul_row(src_row_bytes);
-  std::vector<uint8_t> mid(mid_bytes);
-
   for (int32_t y = 0; y < src_height; y++) {
-    const uint8_t* row = src->Addr8(0, y);
-    for (int32_t x = 0; x < src_width; x++) {
-      size_t idx = static_cast<size_t>(x) * 4;
-      uint8_t a = row[idx + 3];
-      premul_row[idx + 0] = PremulChannel(row[idx + 0], a);
-      premul_row[idx + 1] = PremulChannel(row[idx + 1], a);
-      premul_row[idx + 2] = PremulChannel(row[idx + 2], a);
-      premul_row[idx + 3] = a;
-    }
-
-    uint8_t* mid_row = mid.data() + static_cast<size_t>(y) * mid_row_bytes;
-    for (int32_t x = 0; x < dst_width; x++) {
-      int64_t r = 0, g = 0, b = 0, a = 0, weight = 0;
-      for (int32_t c = x_offsets[x]; c < x_offsets[x + 1]; c++) {
-        const Contribution& contrib = x_contrib[c];
-        const uint8_t* p =
-            premul_row.data() + static_cast<size_t>(contrib.index) * 4;
-        r += static_cast<int64_t>(p[0]) * contrib.weight;
-        g += static_cast<int64_t>(p[1]) * contrib.weight;
-        b += static_cast<int64_t>(p[2]) * contrib.weight;
-        a += static_cast<int64_t>(p[3]) * contrib.weight;
-        weight += contrib.weight;
-      }
-
-      uint8_t* out = mid_row + static_cast<size_t>(x) * 4;
-      out[0] = DivRound(r, weight);
-      out[1] = DivRound(g, weight);
-      out[2] = DivRound(b, weight);
-      out[3] = DivRound(a, weight);
-    }
+    resampler.PushRow(src->Addr8(0, y));
   }
 
-  // Pass 2: vertical box filter, converting back to unpremul on output.
-  auto dst = std::make_shared<Pixmap>(
-      static_cast<uint32_t>(dst_width), static_cast<uint32_t>(dst_height),
-      AlphaType::kUnpremul_AlphaType, ColorType::kRGBA);
-
-  std::vector<int64_t> acc(mid_row_bytes);
-  for (int32_t y = 0; y < dst_height; y++) {
-    std::fill(acc.begin(), acc.end(), 0);
-
-    int64_t weight = 0;
-    for (int32_t c = y_offsets[y]; c < y_offsets[y + 1]; c++) {
-      const uint8_t* mid_row =
-          mid.data() + static_cast<size_t>(y_contrib[c].index) * mid_row_bytes;
-      int32_t row_weight = y_contrib[c].weight;
-      weight += row_weight;
-      for (size_t x = 0; x < mid_row_bytes; x++) {
-        acc[x] += static_cast<int64_t>(mid_row[x]) * row_weight;
-      }
-    }
-
-    uint8_t* out_row = dst->WritableAddr8(0, y);
-    for (int32_t x = 0; x < dst_width; x++) {
-      size_t idx = static_cast<size_t>(x) * 4;
-      uint8_t a = DivRound(acc[idx + 3], weight);
-      out_row[idx + 0] = UnpremulChannel(DivRound(acc[idx + 0], weight), a);
-      out_row[idx + 1] = UnpremulChannel(DivRound(acc[idx + 1], weight), a);
-      out_row[idx + 2] = UnpremulChannel(DivRound(acc[idx + 2], weight), a);
-      out_row[idx + 3] = a;
-    }
-  }
-
-  return dst;
+  return resampler.Finish();
 }
 
 std::shared_ptr<Pixmap> ResamplePixmapToSize(const std::shared_ptr<Pixmap>& src,
@@ -317,5 +571,47 @@ std::shared_ptr<Pixmap> ResamplePixmapToTarget(
   return ResamplePixmapToSize(src, target_width, target_height);
 }
 
+std::shared_ptr<Pixmap> ExtractSubset(const std::shared_ptr<Pixmap>& src,
+                                      const CodecRect& subset) {
+  if (!src || subset.IsEmpty()) {
+    return nullptr;
+  }
+
+  CodecRect bounds{0, 0, static_cast<int32_t>(src->Width()),
+                   static_cast<int32_t>(src->Height())};
+  if (subset == bounds) {
+    return src;
+  }
+  if (!bounds.Contains(subset)) {
+    return nullptr;
+  }
+
+  auto dst = std::make_shared<Pixmap>(subset.Width(), subset.Height(),
+                                      src->GetAlphaType(), src->GetColorType());
+  if (dst->WritableAddr() == nullptr) {
+    return nullptr;
+  }
+
+  size_t row_size = static_cast<size_t>(subset.Width()) * 4;
+  for (int32_t y = 0; y < subset.Height(); y++) {
+    std::memcpy(dst->WritableAddr8(0, y),
+                src->Addr8(subset.X(), subset.Y() + y), row_size);
+  }
+
+  return dst;
+}
+
+std::shared_ptr<Pixmap> ApplyDecodeOptions(const std::shared_ptr<Pixmap>& src,
+                                           const DecodeOptions& options) {
+  CodecRect subset;
+  if (!src || !ResolveSubset(static_cast<int32_t>(src->Width()),
+                             static_cast<int32_t>(src->Height()), options,
+                             &subset)) {
+    return nullptr;
+  }
+
+  return ResamplePixmapToTarget(ExtractSubset(src, subset), options);
+}
+
 }  // namespace codec_priv
 }  // namespace skity
@@ -7,37 +7,48 @@
 
 #include <algorithm>
 #include <cstring>
-#include <functional>
 #include <memory>
 #include <skity/codec/codec.hpp>
 #include <skity/graphic/alpha_type.hpp>
 #include <skity/graphic/color.hpp>
 #include <skity/graphic/color_type.hpp>
 #include <skity/io/pixmap.hpp>
+#include <vector>
 
 namespace skity {
 namespace codec_priv {
 
+/**
+ * Line transforms convert width pixels of a row from src to dst, which may be
+ * the same buffer. Only 4 bytes per pixel are supported, the other transforms
+ * leave dst untouched for other sizes.
+ */
 static void CodecTransformLineByPass(uint8_t* dst, uint8_t* src, int width,
                                      int bytes_per_pixel) {
-  for (int x = 0; x < width; x++) {
-    memcpy(dst, src, bytes_per_pixel);
-    dst += bytes_per_pixel;
-    src += bytes_per_pixel;
+  if (dst != src && width > 0) {
+    memmove(dst, src, static_cast<size_t>(width) * bytes_per_pixel);
   }
 }
 
 void CodecTransformLinePremul(uint8_t* dst, uint8_t* src, int width,
                               int bytes_per_pixel);
 
+// Unpremultiplies with a reciprocal table, bit-identical to PMColorToColor().
 void CodecTransformLineUnpremul(uint8_t* dst, uint8_t* src, int width,
                                 int bytes_per_pixel);
 
 void CodecTransformLineSwizzelRB(uint8_t* dst, uint8_t* src, int width,
                                  int bytes_per_pixel);
 
-using TransformLineFunc = std::function<void(uint8_t* dst, uint8_t* src,
-                                             int width, int bytes_per_pixel)>;
+void CodecTransformLineUnpremulSwizzelRB(uint8_t* dst, uint8_t* src, int width,
+                                         int bytes_per_pixel);
+
+/**
+ * Plain function pointer, so choosing the transform once per image leaves a
+ * direct call per row. The kernels use SSE2 or NEON when the target has it.
+ */
+using TransformLineFunc = void (*)(uint8_t* dst, uint8_t* src, int width,
+                                   int bytes_per_pixel);
 
 TransformLineFunc ChooseLineTransformFunc(ColorType color_type,
                                           AlphaType alpha_type);
@@ -51,8 +62,7 @@ TransformLineFunc ChooseLineTransformFunc(ColorType color_type,
  * size that preserves the source aspect ratio and fits within
  * target_width x target_height.
  *
- * Header-inline: the darwin framework build compiles only the ImageIO codec
- * (codec_apple.mm) without codec_priv.cc, and needs this size negotiation.
+ * Header-inline, shared with the ImageIO codec (codec_apple.mm).
  */
 inline bool ResolveTargetSize(int32_t src_width, int32_t src_height,
                               const DecodeOptions& options, int32_t* out_width,
@@ -105,6 +115,30 @@ inline bool ResolveTargetSize(int32_t src_width, int32_t src_height,
   return true;
 }
 
+/**
+ * Resolves the region to decode: the subset of the options clipped to the
+ * image bounds, or the whole image when no subset is requested.
+ *
+ * Returns false when the source size is invalid or the subset does not
+ * intersect the image.
+ *
+ * Header-inline for the ImageIO codec, like ResolveTargetSize().
+ */
+inline bool ResolveSubset(int32_t src_width, int32_t src_height,
+                          const DecodeOptions& options, CodecRect* out_subset) {
+  if (out_subset == nullptr || src_width <= 0 || src_height <= 0) {
+    return false;
+  }
+
+  CodecRect bounds{0, 0, src_width, src_height};
+  if (options.subset.IsEmpty()) {
+    *out_subset = bounds;
+    return true;
+  }
+
+  return out_subset->Intersect(bounds, options.subset);
+}
+
 /**
  * Area-average (box) resample of an unpremul RGBA8888 pixmap to the given
  * size, separable horizontal + vertical passes with fixed-point weights.
@@ -119,6 +153,78 @@ inline bool ResolveTargetSize(int32_t src_width, int32_t src_height,
 std::shared_ptr<Pixmap> ResamplePixmap(const std::shared_ptr<Pixmap>& src,
                                        int32_t dst_width, int32_t dst_height);
 
+/**
+ * Streaming form of ResamplePixmap() for decoders producing rows top to
+ * bottom. Each pushed row is filtered horizontally at once and accumulated
+ * into the output rows it covers, so only the output pixmap and a window of
+ * output-width accumulators are held instead of the whole source image.
+ *
+ * The output is bit-identical to ResamplePixmap() on the same rows.
+ */
+class RowResampler {
+ public:
+  /**
+   * Writes into dst when it is an unpremul RGBA8888 pixmap of the output size,
+   * and into a new pixmap otherwise.
+   */
+  RowResampler(int32_t src_width, int32_t src_height, int32_t dst_width,
+               int32_t dst_height, std::shared_ptr<Pixmap> dst = nullptr);
+
+  ~RowResampler();
+
+  RowResampler(const RowResampler&) = delete;
+  RowResampler& operator=(const RowResampler&) = delete;
+
+  // False when the sizes are invalid or the output can not be allocated.
+  bool IsValid() const { return dst_ != nullptr; }
+
+  /**
+   * Takes the next source row of src_width unpremul RGBA8888 pixels.
+   */
+  void PushRow(const uint8_t* row);
+
+  /**
+   * Returns the output once every source row has been pushed, nullptr before.
+   */
+  std::shared_ptr<Pixmap> Finish();
+
+  /**
+   * Bytes of scratch memory held besides the output pixmap.
+   */
+  size_t GetWorkingBytes() const;
+
+ private:
+  struct Contribution {
+    int32_t index;
+    int32_t weight;
+  };
+
+  static void BuildContributions(int32_t src_dim, int32_t dst_dim,
+                                 std::vector<Contribution>* contributions,
+                                 std::vector<int32_t>* offsets);
+
+  void EmitRow(int32_t y);
+
+ private:
+  int32_t src_width_;
+  int32_t src_height_;
+  int32_t dst_width_;
+  int32_t dst_height_;
+  std::vector<Contribution> x_contrib_;
+  std::vector<int32_t> x_offsets_;
+  std::vector<Contribution> y_contrib_;
+  std::vector<int32_t> y_offsets_;
+  std::vector<uint8_t> premul_row_;
+  std::vector<uint8_t> mid_row_;
+  // Ring of accumulators for the output rows still open, indexed by output
+  // row modulo window_rows_.
+  std::vector<int64_t> acc_;
+  int32_t window_rows_ = 0;
+  int32_t src_row_ = 0;
+  int32_t dst_row_ = 0;
+  std::shared_ptr<Pixmap> dst_;
+};
+
 /**
  * Resamples src to an explicit size. Returns src unchanged when
  * dst_width/dst_height are non-positive (no resample requested) or when
@@ -137,6 +243,22 @@ std::shared_ptr<Pixmap> ResamplePixmapToSize(const std::shared_ptr<Pixmap>& src,
 std::shared_ptr<Pixmap> ResamplePixmapToTarget(
     const std::shared_ptr<Pixmap>& src, const DecodeOptions& options);
 
+/**
+ * Copies the subset out of an unpremul RGBA8888 pixmap. Returns src unchanged
+ * when the subset covers it, nullptr when the subset is empty or not inside
+ * src.
+ */
+std::shared_ptr<Pixmap> ExtractSubset(const std::shared_ptr<Pixmap>& src,
+                                      const CodecRect& subset);
+
+/**
+ * Decoded-pixmap helper for codecs without native subset or scaled decoding:
+ * extracts the option's subset from the intrinsic size pixmap, then resamples
+ * it to the target size. Returns nullptr when the subset misses the image.
+ */
+std::shared_ptr<Pixmap> ApplyDecodeOptions(const std::shared_ptr<Pixmap>& src,
+                                           const DecodeOptions& options);
+
 }  // namespace codec_priv
 }  // namespace skity
 
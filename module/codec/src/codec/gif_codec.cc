@@ -45,8 +45,9 @@ class GIFDecoder : public WuffsDecoder {
 GIFCodec::~GIFCodec() = default;
 
 std::shared_ptr<Pixmap> GIFCodec::Decode(const DecodeOptions& options) {
-  // wuffs has no scaled decoding; resample the first frame after decode.
-  return codec_priv::ResamplePixmapToTarget(DecodeIntrinsic(), options);
+  // wuffs has no subset or scaled decoding; crop and resample the first frame
+  // after decode.
+  return codec_priv::ApplyDecodeOptions(DecodeIntrinsic(), options);
 }
 
 std::shared_ptr<Pixmap> GIFCodec::DecodeIntrinsic() {
@@ -20,6 +20,7 @@ class GIFCodec : public Codec {
 
   std::shared_ptr<MultiFrameDecoder> DecodeMultiFrame() override;
 
+  using Codec::Encode;
   std::shared_ptr<Data> Encode(const Pixmap* pixmap) override;
 
   bool RecognizeFileType(const char* header, size_t size) override;
@@ -0,0 +1,53 @@
+// Copyright 2021 The Lynx Authors. All rights reserved.
+// Licensed under the Apache License Version 2.0 that can be found in the
+// LICENSE file in the root directory of this source tree.
+
+#include "src/codec/incremental_decoder.hpp"
+
+#include <skity/io/data.hpp>
+#include <skity/io/pixmap.hpp>
+
+namespace skity {
+
+namespace {
+
+void release_vector(const void*, void* context) {
+  delete static_cast<std::vector<uint8_t>*>(context);
+}
+
+}  // namespace
+
+IncrementalDecoder::Result BufferedIncrementalDecoder::Append(
+    const void* data, size_t size) {
+  if (finished_ || codec_ == nullptr) {
+    return pixmap_ ? Result::kComplete : Result::kError;
+  }
+
+  auto bytes = static_cast<const uint8_t*>(data);
+  data_.insert(data_.end(), bytes, bytes + size);
+
+  return Result::kNeedMoreData;
+}
+
+IncrementalDecoder::Result BufferedIncrementalDecoder::Finish() {
+  if (!finished_ && codec_ != nullptr && !data_.empty()) {
+    finished_ = true;
+
+    // Hand the collected bytes to the codec without copying them.
+    auto owner = new std::vector<uint8_t>(std::move(data_));
+    codec_->SetData(Data::MakeWithProc(owner->data(), owner->size(),
+                                       release_vector, owner));
+
+    pixmap_ = codec_->Decode();
+    if (pixmap_) {
+      decoded_rows_ = static_cast<int32_t>(pixmap_->Height());
+      completed_passes_ = 1;
+    }
+  }
+
+  finished_ = true;
+
+  return pixmap_ ? Result::kComplete : Result::kError;
+}
+
+}  // namespace skity
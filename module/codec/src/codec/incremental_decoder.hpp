@@ -0,0 +1,36 @@
+// Copyright 2021 The Lynx Authors. All rights reserved.
+// Licensed under the Apache License Version 2.0 that can be found in the
+// LICENSE file in the root directory of this source tree.
+
+#ifndef MODULE_CODEC_SRC_CODEC_INCREMENTAL_DECODER_HPP
+#define MODULE_CODEC_SRC_CODEC_INCREMENTAL_DECODER_HPP
+
+#include <skity/codec/codec.hpp>
+#include <vector>
+
+namespace skity {
+
+/**
+ * Fallback for codecs without native incremental decoding. Collects the data
+ * and decodes it with the codec once Finish() is called.
+ */
+class BufferedIncrementalDecoder : public IncrementalDecoder {
+ public:
+  explicit BufferedIncrementalDecoder(std::shared_ptr<Codec> codec)
+      : codec_(std::move(codec)) {}
+
+  ~BufferedIncrementalDecoder() override = default;
+
+  Result Append(const void* data, size_t size) override;
+
+  Result Finish() override;
+
+ private:
+  std::shared_ptr<Codec> codec_;
+  std::vector<uint8_t> data_ = {};
+  bool finished_ = false;
+};
+
+}  // namespace skity
+
+#endif  // MODULE_CODEC_SRC_CODEC_INCREMENTAL_DECODER_HPP
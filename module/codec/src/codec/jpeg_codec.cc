@@ -17,6 +17,7 @@ extern "C" {
 #include <cmath>
 #include <csetjmp>
 #include <cstring>
+#include <memory>
 #include <skity/io/data.hpp>
 #include <skity/io/pixmap.hpp>
 
@@ -166,6 +167,282 @@ void skip_jpeg_input_data(j_decompress_ptr cinfo,
 
 void term_jpeg_source(j_decompress_ptr cinfo) { (void)cinfo; }
 
+// Source manager of the incremental decoder. It owns the data which libjpeg
+// has not consumed yet and suspends the decoder when it runs dry, until more
+// data is appended.
+struct skity_jpeg_stream_source : jpeg_source_mgr {
+  skity_jpeg_stream_source() {
+    init_source = init_jpeg_stream_source;
+    fill_input_buffer = fill_jpeg_stream_buffer;
+    skip_input_data = skip_jpeg_stream_data;
+    resync_to_restart = jpeg_resync_to_restart;
+    term_source = term_jpeg_source;
+    next_input_byte = nullptr;
+    bytes_in_buffer = 0;
+  }
+
+  void Append(const uint8_t* bytes, size_t size) {
+    // Drop what libjpeg consumed, the rest is still referenced by it.
+    if (next_input_byte != nullptr) {
+      data.erase(data.begin(), data.begin() + (next_input_byte - data.data()));
+    }
+
+    size_t skip = std::min(skip_bytes, size);
+    skip_bytes -= skip;
+    data.insert(data.end(), bytes + skip, bytes + size);
+
+    next_input_byte = data.data();
+    bytes_in_buffer = data.size();
+  }
+
+  static void init_jpeg_stream_source(j_decompress_ptr cinfo) { (void)cinfo; }
+
+  static boolean fill_jpeg_stream_buffer(j_decompress_ptr cinfo) {
+    auto* src = reinterpret_cast<skity_jpeg_stream_source*>(cinfo->src);
+    if (!src->finished) {
+      // Suspend, libjpeg resumes from next_input_byte on the next call.
+      return FALSE;
+    }
+
+    // No more data will arrive, end the image like a truncated file.
+    src->eoi_inserted = true;
+    src->next_input_byte = src->eoi_;
+    src->bytes_in_buffer = sizeof(src->eoi_);
+    return TRUE;
+  }
+
+  static void skip_jpeg_stream_data(j_decompress_ptr cinfo,
+                                    long num_bytes) {  // NOLINT(runtime/int)
+    auto* src = reinterpret_cast<skity_jpeg_stream_source*>(cinfo->src);
+    if (num_bytes <= 0) {
+      return;
+    }
+
+    size_t skip = static_cast<size_t>(num_bytes);
+    if (skip > src->bytes_in_buffer) {
+      // Skip the rest as soon as it arrives.
+      src->skip_bytes += skip - src->bytes_in_buffer;
+      skip = src->bytes_in_buffer;
+    }
+    src->next_input_byte += skip;
+    src->bytes_in_buffer -= skip;
+  }
+
+  std::vector<uint8_t> data = {};
+  size_t skip_bytes = 0;
+  bool finished = false;
+  bool eoi_inserted = false;
+  const unsigned char eoi_[2] = {0xFF, 0xD9};
+};
+
+/**
+ * Incremental decoder driving libjpeg with a suspending source manager.
+ * Progressive images are decoded in buffered image mode, every completed scan
+ * is written to the output pixmap as a new pass.
+ */
+class JPEGIncrementalDecoder : public IncrementalDecoder {
+  enum class State {
+    kReadHeader,
+    kStartDecompress,
+    kStartOutput,
+    kReadRows,
+    kFinishOutput,
+    kFinishDecompress,
+    kDone,
+  };
+
+ public:
+  JPEGIncrementalDecoder() {
+    cinfo_.err = jpeg_std_error(&jerr_.base);
+    jerr_.base.error_exit = JpegErrorExit;
+    jerr_.base.output_message = JpegOutputMessage;
+
+    if (setjmp(jerr_.setjmp_buffer)) {
+      result_ = Result::kError;
+      return;
+    }
+
+    jpeg_create_decompress(&cinfo_);
+    cinfo_.src = &source_;
+  }
+
+  ~JPEGIncrementalDecoder() override { jpeg_destroy_decompress(&cinfo_); }
+
+  Result Append(const void* data, size_t size) override {
+    if (result_ != Result::kNeedMoreData) {
+      return result_;
+    }
+
+    source_.Append(static_cast<const uint8_t*>(data), size);
+    Decode();
+
+    return result_;
+  }
+
+  Result Finish() override {
+    if (result_ != Result::kNeedMoreData) {
+      return result_;
+    }
+
+    // Flush the rows which can be decoded from the data received so far.
+    source_.finished = true;
+    Decode();
+
+    if (source_.eoi_inserted || result_ == Result::kNeedMoreData) {
+      result_ = Result::kError;
+    }
+
+    return result_;
+  }
+
+ private:
+  // No object with a destructor may live in this frame, libjpeg reports
+  // errors with longjmp.
+  void Decode() {
+    if (setjmp(jerr_.setjmp_buffer)) {
+      result_ = Result::kError;
+    } else {
+      while (Step()) {
+      }
+    }
+
+    if (pixmap_) {
+      pixmap_->NotifyPixelsChanged();
+    }
+  }
+
+  // Advances the state machine, returns false when libjpeg suspends or the
+  // image is done.
+  bool Step() {
+    switch (state_) {
+      case State::kReadHeader: {
+        int ret = jpeg_read_header(&cinfo_, TRUE);
+        if (ret == JPEG_SUSPENDED) {
+          return false;
+        }
+        if (ret != JPEG_HEADER_OK) {
+          result_ = Result::kError;
+          return false;
+        }
+
+        cinfo_.out_color_space = JCS_EXT_RGBA;
+        cinfo_.buffered_image = jpeg_has_multiple_scans(&cinfo_);
+        state_ = State::kStartDecompress;
+        return true;
+      }
+      case State::kStartDecompress: {
+        if (!jpeg_start_decompress(&cinfo_)) {
+          return false;
+        }
+        if (cinfo_.output_width == 0 || cinfo_.output_height == 0 ||
+            !AllocatePixmap()) {
+          result_ = Result::kError;
+          return false;
+        }
+
+        state_ =
+            cinfo_.buffered_image ? State::kStartOutput : State::kReadRows;
+        return true;
+      }
+      case State::kStartOutput: {
+        int ret;
+        do {
+          ret = jpeg_consume_input(&cinfo_);
+        } while (ret != JPEG_SUSPENDED && ret != JPEG_REACHED_EOI);
+
+        // Only output a scan once all of its data is present, a partial scan
+        // would just repeat the previous pass.
+        int scan = cinfo_.input_scan_number;
+        if (!jpeg_input_complete(&cinfo_) &&
+            cinfo_.input_iMCU_row < cinfo_.total_iMCU_rows) {
+          scan--;
+        }
+        if (scan <= cinfo_.output_scan_number) {
+          if (jpeg_input_complete(&cinfo_)) {
+            state_ = State::kFinishDecompress;
+            return true;
+          }
+          return false;
+        }
+
+        if (!jpeg_start_output(&cinfo_, scan)) {
+          return false;
+        }
+        state_ = State::kReadRows;
+        return true;
+      }
+      case State::kReadRows: {
+        const size_t row_bytes = pixmap_->RowBytes();
+        auto pixels = static_cast<uint8_t*>(pixmap_->WritableAddr());
+        while (cinfo_.output_scanline < cinfo_.output_height) {
+          uint8_t* row = pixels + cinfo_.output_scanline * row_bytes;
+          if (jpeg_read_scanlines(&cinfo_, &row, 1) == 0) {
+            return false;
+          }
+          decoded_rows_ = std::max(
+              decoded_rows_, static_cast<int32_t>(cinfo_.output_scanline));
+        }
+
+        state_ = cinfo_.buffered_image ? State::kFinishOutput
+                                       : State::kFinishDecompress;
+        return true;
+      }
+      case State::kFinishOutput: {
+        if (!jpeg_finish_output(&cinfo_)) {
+          return false;
+        }
+        completed_passes_++;
+
+        if (jpeg_input_complete(&cinfo_) &&
+            cinfo_.output_scan_number >= cinfo_.input_scan_number) {
+          state_ = State::kFinishDecompress;
+        } else {
+          state_ = State::kStartOutput;
+        }
+        return true;
+      }
+      case State::kFinishDecompress: {
+        if (!jpeg_finish_decompress(&cinfo_)) {
+          return false;
+        }
+        if (!cinfo_.buffered_image) {
+          completed_passes_ = 1;
+        }
+
+        state_ = State::kDone;
+        result_ = Result::kComplete;
+        return false;
+      }
+      case State::kDone:
+        return false;
+    }
+
+    return false;
+  }
+
+  bool AllocatePixmap() {
+    pixmap_ = std::make_shared<Pixmap>(cinfo_.output_width,
+                                       cinfo_.output_height);
+    auto pixels = static_cast<uint8_t*>(pixmap_->WritableAddr());
+    if (pixels == nullptr) {
+      return false;
+    }
+
+    // Opaque black until decoded, like the partial result of Decode().
+    size_t pixel_size = pixmap_->RowBytes() * pixmap_->Height();
+    for (size_t i = 3; i < pixel_size; i += 4) {
+      pixels[i] = 0xFF;
+    }
+    return true;
+  }
+
+  jpeg_decompress_struct cinfo_ = {};
+  JpegErrorMgr jerr_ = {};
+  skity_jpeg_stream_source source_ = {};
+  State state_ = State::kReadHeader;
+  Result result_ = Result::kNeedMoreData;
+};
+
 }  // namespace
 
 bool JPEGCodec::RecognizeFileType(const char* header, size_t size) {
@@ -209,6 +486,9 @@ std::shared_ptr<Pixmap> JPEGCodec::Decode(const DecodeOptions& options) {
   // the requested size. Read on the longjmp path, hence volatile as well.
   int32_t volatile resample_width = 0;
   int32_t volatile resample_height = 0;
+  // Scanline for rows which are not decoded straight into the output: rows
+  // above the subset, or rows wider than it.
+  uint8_t* volatile scanline = nullptr;
 
   if (setjmp(jerr.setjmp_buffer)) {
     // A fatal libjpeg error occurred (e.g. corrupt/truncated scan data). Tear
@@ -216,6 +496,9 @@ std::shared_ptr<Pixmap> JPEGCodec::Decode(const DecodeOptions& options) {
     // return what was decoded so far instead of failing — matching the
     // partial-decode behavior of Skia/browsers on broken JPEGs.
     jpeg_destroy_decompress(&cinfo);
+    if (scanline) {
+      tjFree(scanline);
+    }
 
     uint8_t* buf = pixels;
     if (buf && width > 0 && height > 0) {
@@ -248,8 +531,23 @@ std::shared_ptr<Pixmap> JPEGCodec::Decode(const DecodeOptions& options) {
     return nullptr;
   }
 
+  // Region to decode in intrinsic pixels, the target size applies to it.
+  CodecRect subset;
+  if (!codec_priv::ResolveSubset(static_cast<int32_t>(cinfo.image_width),
+                                 static_cast<int32_t>(cinfo.image_height),
+                                 options, &subset)) {
+    jpeg_destroy_decompress(&cinfo);
+    return nullptr;
+  }
+
   cinfo.out_color_space = JCS_EXT_RGBA;
 
+  // The subset in output pixels, rounded outwards when scaled.
+  JDIMENSION out_left = 0;
+  JDIMENSION out_top = 0;
+  JDIMENSION out_right = 0;
+  JDIMENSION out_bottom = 0;
+
   // Decode-time downscaling via libjpeg's IDCT scaling: pick the smallest
   // supported n/8 ratio that still covers the aspect-fit target in both
   // axes. The scaled dimensions come out of jpeg_calc_output_dimensions(),
@@ -257,12 +555,13 @@ std::shared_ptr<Pixmap> JPEGCodec::Decode(const DecodeOptions& options) {
   {
     int32_t target_width = 0;
     int32_t target_height = 0;
-    if (codec_priv::ResolveTargetSize(static_cast<int32_t>(cinfo.image_width),
-                                      static_cast<int32_t>(cinfo.image_height),
-                                      options, &target_width, &target_height)) {
+    bool need_scale =
+        codec_priv::ResolveTargetSize(subset.Width(), subset.Height(), options,
+                                      &target_width, &target_height);
+    if (need_scale) {
       double scale =
-          std::min(static_cast<double>(target_width) / cinfo.image_width,
-                   static_cast<double>(target_height) / cinfo.image_height);
+          std::min(static_cast<double>(target_width) / subset.Width(),
+                   static_cast<double>(target_height) / subset.Height());
 
       // Smallest num with num/8 >= scale, so the native output is >= the
       // target in both axes and any remainder pass only ever downsamples.
@@ -276,21 +575,40 @@ std::shared_ptr<Pixmap> JPEGCodec::Decode(const DecodeOptions& options) {
         cinfo.scale_num = scale_num;
         cinfo.scale_denom = 8;
       }
+    }
+
+    // Always let libjpeg compute the output dims — with the default 8/8
+    // (targets within 1/8 of the intrinsic size) that is the intrinsic
+    // size, which then flows into the same remainder pass below.
+    jpeg_calc_output_dimensions(&cinfo);
 
-      // Always let libjpeg compute the output dims — with the default 8/8
-      // (targets within 1/8 of the intrinsic size) that is the intrinsic
-      // size, which then flows into the same remainder pass below.
-      jpeg_calc_output_dimensions(&cinfo);
-
-      // With the covering rule the native n/8 output may exceed the target
-      // by up to ~1/7. Resample to the exact target whenever it misses, so
-      // output sizes stay predictable; requests that land on the n/8 grid
-      // still take the pure native path with no second pass.
-      if (cinfo.output_width != static_cast<JDIMENSION>(target_width) ||
-          cinfo.output_height != static_cast<JDIMENSION>(target_height)) {
-        resample_width = target_width;
-        resample_height = target_height;
+    auto to_output = [](int32_t value, JDIMENSION output, JDIMENSION image,
+                        bool round_up) {
+      uint64_t scaled = static_cast<uint64_t>(value) * output;
+      if (round_up) {
+        scaled += image - 1;
       }
+      return static_cast<JDIMENSION>(
+          std::min<uint64_t>(scaled / image, output));
+    };
+    out_left = to_output(subset.left, cinfo.output_width, cinfo.image_width,
+                         false);
+    out_top = to_output(subset.top, cinfo.output_height, cinfo.image_height,
+                        false);
+    out_right = to_output(subset.right, cinfo.output_width, cinfo.image_width,
+                          true);
+    out_bottom = to_output(subset.bottom, cinfo.output_height,
+                           cinfo.image_height, true);
+
+    // With the covering rule the native n/8 output may exceed the target
+    // by up to ~1/7. Resample to the exact target whenever it misses, so
+    // output sizes stay predictable; requests that land on the n/8 grid
+    // still take the pure native path with no second pass.
+    if (need_scale &&
+        (out_right - out_left != static_cast<JDIMENSION>(target_width) ||
+         out_bottom - out_top != static_cast<JDIMENSION>(target_height))) {
+      resample_width = target_width;
+      resample_height = target_height;
     }
   }
 
@@ -299,14 +617,29 @@ std::shared_ptr<Pixmap> JPEGCodec::Decode(const DecodeOptions& options) {
     return nullptr;
   }
 
-  width = cinfo.output_width;
-  height = cinfo.output_height;
+  width = out_right - out_left;
+  height = out_bottom - out_top;
 
   if (width == 0 || height == 0) {
     jpeg_destroy_decompress(&cinfo);
     return nullptr;
   }
 
+  // Columns of the decoded scanlines. libjpeg-turbo narrows them to the iMCU
+  // columns covering the subset and skips the rows above it without running
+  // the IDCT; plain libjpeg decodes them in full.
+  JDIMENSION crop_x = 0;
+#if defined(LIBJPEG_TURBO_VERSION)
+  if (width < cinfo.output_width) {
+    crop_x = out_left;
+    JDIMENSION crop_width = width;
+    jpeg_crop_scanline(&cinfo, &crop_x, &crop_width);
+  }
+  if (out_top > 0) {
+    jpeg_skip_scanlines(&cinfo, out_top);
+  }
+#endif
+
   size_t row_bytes = static_cast<size_t>(width) * tjPixelSize[TJPF_RGBA];
   size_t pixel_size = row_bytes * height;
 
@@ -325,17 +658,47 @@ std::shared_ptr<Pixmap> JPEGCodec::Decode(const DecodeOptions& options) {
     buf[i + 3] = 0xFF;
   }
 
+  const size_t column_offset =
+      static_cast<size_t>(out_left - crop_x) * tjPixelSize[TJPF_RGBA];
+  const bool direct = column_offset == 0 && cinfo.output_width == width;
+  if (!direct || cinfo.output_scanline < out_top) {
+    scanline = reinterpret_cast<uint8_t*>(tjAlloc(
+        static_cast<int>(cinfo.output_width * tjPixelSize[TJPF_RGBA])));
+    if (!scanline) {
+      jpeg_destroy_decompress(&cinfo);
+      tjFree(buf);
+      return nullptr;
+    }
+  }
+  uint8_t* line = scanline;
+
   // Decode scanline by scanline. On corrupt data libjpeg resyncs within the
   // decoded region (producing mosaic artifacts); on truncation it inserts a
   // fake EOI via a warning and yields the buffered rows. A truly fatal error
   // mid-stream longjmps to the block above, returning the partial result.
-  while (cinfo.output_scanline < height) {
-    uint8_t* row = buf + static_cast<size_t>(cinfo.output_scanline) * row_bytes;
+  while (cinfo.output_scanline < out_bottom) {
+    JDIMENSION y = cinfo.output_scanline;
+    uint8_t* dst = nullptr;
+    if (y >= out_top) {
+      dst = buf + static_cast<size_t>(y - out_top) * row_bytes;
+    }
+    uint8_t* row = direct && dst ? dst : line;
     jpeg_read_scanlines(&cinfo, &row, 1);
+    if (dst && row == line) {
+      std::memcpy(dst, line + column_offset, row_bytes);
+    }
   }
 
-  jpeg_finish_decompress(&cinfo);
+  // Rows below the subset are never decoded.
+  if (cinfo.output_scanline < cinfo.output_height) {
+    jpeg_abort_decompress(&cinfo);
+  } else {
+    jpeg_finish_decompress(&cinfo);
+  }
   jpeg_destroy_decompress(&cinfo);
+  if (scanline) {
+    tjFree(scanline);
+  }
 
   auto image_data = skity::Data::MakeWithCopy(buf, pixel_size);
   tjFree(buf);
@@ -347,6 +710,10 @@ std::shared_ptr<Pixmap> JPEGCodec::Decode(const DecodeOptions& options) {
 
 std::shared_ptr<MultiFrameDecoder> JPEGCodec::DecodeMultiFrame() { return {}; }
 
+std::unique_ptr<IncrementalDecoder> JPEGCodec::MakeIncrementalDecoder() {
+  return std::make_unique<JPEGIncrementalDecoder>();
+}
+
 std::shared_ptr<Data> JPEGCodec::Encode(const Pixmap* pixmap) {
   if (!pixmap || pixmap->Width() == 0 || pixmap->Height() == 0) {
     return nullptr;
@@ -18,6 +18,9 @@ class JPEGCodec : public Codec {
 
   std::shared_ptr<MultiFrameDecoder> DecodeMultiFrame() override;
 
+  std::unique_ptr<IncrementalDecoder> MakeIncrementalDecoder() override;
+
+  using Codec::Encode;
   std::shared_ptr<Data> Encode(const Pixmap* pixmap) override;
 
   bool RecognizeFileType(const char* header, size_t size) override;
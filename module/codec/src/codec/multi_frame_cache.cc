@@ -0,0 +1,194 @@
+// Copyright 2021 The Lynx Authors. All rights reserved.
+// Licensed under the Apache License Version 2.0 that can be found in the
+// LICENSE file in the root directory of this source tree.
+
+#include <condition_variable>
+#include <list>
+#include <mutex>
+#include <skity/codec/codec.hpp>
+#include <skity/io/pixmap.hpp>
+#include <thread>
+#include <unordered_map>
+#include <utility>
+
+namespace skity {
+
+namespace {
+
+constexpr int32_t kNoPendingFrame = -1;
+
+}  // namespace
+
+class MultiFrameCache::Impl {
+ public:
+  Impl(std::shared_ptr<MultiFrameDecoder> decoder,
+       const DecodeOptions& options,
+       const MultiFrameCacheOptions& cache_options)
+      : decoder_(std::move(decoder)),
+        options_(options),
+        cache_options_(cache_options) {
+    if (decoder_ && cache_options_.look_ahead &&
+        decoder_->GetFrameCount() > 1) {
+      worker_ = std::thread([this] { RunWorker(); });
+    }
+  }
+
+  ~Impl() {
+    {
+      std::lock_guard<std::mutex> lock(pending_mutex_);
+      stop_ = true;
+    }
+    pending_cv_.notify_one();
+    if (worker_.joinable()) {
+      worker_.join();
+    }
+  }
+
+  std::shared_ptr<Pixmap> GetFrame(int32_t frame_id) {
+    if (!decoder_ || frame_id < 0 || frame_id >= decoder_->GetFrameCount()) {
+      return nullptr;
+    }
+
+    bool cached = false;
+    auto pixmap = Find(frame_id);
+    if (pixmap) {
+      cached = true;
+    } else {
+      pixmap = Decode(frame_id, &cached);
+    }
+
+    if (cached) {
+      std::lock_guard<std::mutex> lock(cache_mutex_);
+      hit_count_++;
+    }
+
+    if (pixmap && worker_.joinable()) {
+      {
+        std::lock_guard<std::mutex> lock(pending_mutex_);
+        pending_ = (frame_id + 1) % decoder_->GetFrameCount();
+      }
+      pending_cv_.notify_one();
+    }
+
+    return pixmap;
+  }
+
+  size_t GetCachedBytes() const {
+    std::lock_guard<std::mutex> lock(cache_mutex_);
+    return cached_bytes_;
+  }
+
+  uint64_t GetHitCount() const {
+    std::lock_guard<std::mutex> lock(cache_mutex_);
+    return hit_count_;
+  }
+
+ private:
+  struct Entry {
+    int32_t frame_id;
+    std::shared_ptr<Pixmap> pixmap;
+    size_t bytes;
+  };
+
+  std::shared_ptr<Pixmap> Find(int32_t frame_id) {
+    std::lock_guard<std::mutex> lock(cache_mutex_);
+    auto it = entries_.find(frame_id);
+    if (it == entries_.end()) {
+      return nullptr;
+    }
+
+    lru_.splice(lru_.begin(), lru_, it->second);
+    return it->second->pixmap;
+  }
+
+  // Decodes are serialized, the decoder keeps the composited canvas between
+  // frames. cached is set when the frame was decoded while waiting.
+  std::shared_ptr<Pixmap> Decode(int32_t frame_id, bool* cached) {
+    std::lock_guard<std::mutex> lock(decode_mutex_);
+    if (auto pixmap = Find(frame_id)) {
+      *cached = true;
+      return pixmap;
+    }
+
+    // Cached frames may be shared with the renderer, so every frame gets its
+    // own output pixmap.
+    auto pixmap = decoder_->DecodeFrame(decoder_->GetFrameInfo(frame_id),
+                                        options_, nullptr);
+    if (pixmap) {
+      Insert(frame_id, pixmap);
+    }
+
+    return pixmap;
+  }
+
+  void Insert(int32_t frame_id, std::shared_ptr<Pixmap> pixmap) {
+    std::lock_guard<std::mutex> lock(cache_mutex_);
+    const size_t bytes = pixmap->RowBytes() * pixmap->Height();
+    lru_.push_front(Entry{frame_id, std::move(pixmap), bytes});
+    entries_[frame_id] = lru_.begin();
+    cached_bytes_ += bytes;
+
+    while (cached_bytes_ > cache_options_.max_bytes && lru_.size() > 1) {
+      cached_bytes_ -= lru_.back().bytes;
+      entries_.erase(lru_.back().frame_id);
+      lru_.pop_back();
+    }
+  }
+
+  void RunWorker() {
+    while (true) {
+      int32_t frame_id = kNoPendingFrame;
+      {
+        std::unique_lock<std::mutex> lock(pending_mutex_);
+        pending_cv_.wait(
+            lock, [this] { return stop_ || pending_ != kNoPendingFrame; });
+        if (stop_) {
+          return;
+        }
+        std::swap(frame_id, pending_);
+      }
+
+      bool cached = false;
+      Decode(frame_id, &cached);
+    }
+  }
+
+ private:
+  std::shared_ptr<MultiFrameDecoder> decoder_;
+  DecodeOptions options_;
+  MultiFrameCacheOptions cache_options_;
+
+  std::mutex decode_mutex_ = {};
+
+  mutable std::mutex cache_mutex_ = {};
+  std::list<Entry> lru_ = {};
+  std::unordered_map<int32_t, std::list<Entry>::iterator> entries_ = {};
+  size_t cached_bytes_ = 0;
+  uint64_t hit_count_ = 0;
+
+  std::mutex pending_mutex_ = {};
+  std::condition_variable pending_cv_ = {};
+  int32_t pending_ = kNoPendingFrame;
+  bool stop_ = false;
+  std::thread worker_ = {};
+};
+
+MultiFrameCache::MultiFrameCache(std::shared_ptr<MultiFrameDecoder> decoder,
+                                 const DecodeOptions& options,
+                                 const MultiFrameCacheOptions& cache_options)
+    : impl_(std::make_unique<Impl>(std::move(decoder), options,
+                                   cache_options)) {}
+
+MultiFrameCache::~MultiFrameCache() = default;
+
+std::shared_ptr<Pixmap> MultiFrameCache::GetFrame(int32_t frame_id) {
+  return impl_->GetFrame(frame_id);
+}
+
+size_t MultiFrameCache::GetCachedBytes() const {
+  return impl_->GetCachedBytes();
+}
+
+uint64_t MultiFrameCache::GetHitCount() const { return impl_->GetHitCount(); }
+
+}  // namespace skity
@@ -2,7 +2,12 @@
 // Licensed under the Apache License Version 2.0 that can be found in the
 // LICENSE file in the root directory of this source tree.
 
+#include <cstring>
 #include <skity/codec/codec.hpp>
+#include <skity/io/pixmap.hpp>
+#include <vector>
+
+#include "src/codec/codec_priv.hpp"
 
 namespace skity {
 
@@ -107,4 +112,132 @@ void MultiFrameDecoder::SetAlphaAndRequiredFrame(CodecFrame* frame) {
                      (reports_alpha && !blend_with_prev));
 }
 
+std::shared_ptr<Pixmap> MultiFrameDecoder::DecodeFrame(
+    const CodecFrame* frame, const DecodeOptions& options,
+    std::shared_ptr<Pixmap> output) {
+  if (frame == nullptr || !ComposeCanvas(frame)) {
+    return nullptr;
+  }
+
+  const int32_t width = static_cast<int32_t>(canvas_->Width());
+  const int32_t height = static_cast<int32_t>(canvas_->Height());
+  CodecRect subset;
+  if (!codec_priv::ResolveSubset(width, height, options, &subset)) {
+    return nullptr;
+  }
+
+  int32_t target_width = subset.Width();
+  int32_t target_height = subset.Height();
+  codec_priv::ResolveTargetSize(subset.Width(), subset.Height(), options,
+                                &target_width, &target_height);
+  if (target_width <= 0 || target_height <= 0) {
+    target_width = subset.Width();
+    target_height = subset.Height();
+  }
+
+  // The canvas stays with the decoder for the next frame, the output always
+  // gets a copy.
+  if (target_width == subset.Width() && target_height == subset.Height()) {
+    if (!output || output->Width() != static_cast<uint32_t>(target_width) ||
+        output->Height() != static_cast<uint32_t>(target_height) ||
+        output->GetColorType() != ColorType::kRGBA ||
+        output->GetAlphaType() != AlphaType::kUnpremul_AlphaType) {
+      output = std::make_shared<Pixmap>(target_width, target_height);
+    }
+
+    for (int32_t y = 0; y < target_height; y++) {
+      std::memcpy(output->WritableAddr8(0, y),
+                  canvas_->Addr8(subset.X(), subset.Y() + y),
+                  static_cast<size_t>(target_width) * 4);
+    }
+    output->NotifyPixelsChanged();
+    return output;
+  }
+
+  codec_priv::RowResampler resampler(subset.Width(), subset.Height(),
+                                     target_width, target_height,
+                                     std::move(output));
+  if (!resampler.IsValid()) {
+    return nullptr;
+  }
+
+  for (int32_t y = subset.Y(); y < subset.Bottom(); y++) {
+    resampler.PushRow(canvas_->Addr8(subset.X(), y));
+  }
+
+  output = resampler.Finish();
+  if (output) {
+    output->NotifyPixelsChanged();
+  }
+
+  return output;
+}
+
+bool MultiFrameDecoder::ComposeCanvas(const CodecFrame* frame) {
+  // Walk back the required frames until one which is already in the canvas,
+  // can be drawn over it, or is independent.
+  std::vector<const CodecFrame*> chain;
+  for (const CodecFrame* current = frame;;) {
+    if (canvas_ && current->GetFrameID() == canvas_frame_id_) {
+      break;
+    }
+
+    chain.push_back(current);
+    if (current->ReachedStart() || CanComposeOnCanvas(current)) {
+      break;
+    }
+
+    current = GetFrameInfo(current->GetRequiredFrame());
+    if (current == nullptr) {
+      return false;
+    }
+  }
+
+  for (auto it = chain.rbegin(); it != chain.rend(); ++it) {
+    const CodecFrame* current = *it;
+
+    if (!current->ReachedStart()) {
+      // Dispose the frame in the canvas before drawing the next one over it.
+      auto prev = GetFrameInfo(canvas_frame_id_);
+      CodecRect rect;
+      if (prev != nullptr &&
+          prev->GetDisposalMethod() == CodecDisposalMethod::RestoreBGColor &&
+          rect.Intersect(prev->GetRect(),
+                         CodecRect{0, 0, static_cast<int32_t>(canvas_->Width()),
+                                   static_cast<int32_t>(canvas_->Height())})) {
+        for (int32_t y = rect.Y(); y < rect.Bottom(); y++) {
+          std::memset(canvas_->WritableAddr8(rect.X(), y), 0,
+                      static_cast<size_t>(rect.Width()) * 4);
+        }
+      }
+    }
+
+    // Independent frames clear the canvas themselves.
+    canvas_frame_id_ = CodecFrameInfo::kNoFrameRequired;
+    auto canvas = DecodeFrame(current, canvas_);
+    if (!canvas) {
+      canvas_ = nullptr;
+      return false;
+    }
+
+    canvas_ = std::move(canvas);
+    canvas_frame_id_ = current->GetFrameID();
+  }
+
+  return true;
+}
+
+bool MultiFrameDecoder::CanComposeOnCanvas(const CodecFrame* frame) const {
+  // Any frame in [required_frame, frame) can be drawn over, unless it is
+  // restored to the previous frame once disposed.
+  if (!canvas_ || canvas_frame_id_ < frame->GetRequiredFrame() ||
+      canvas_frame_id_ >= frame->GetFrameID()) {
+    return false;
+  }
+
+  auto prev = GetFrameInfo(canvas_frame_id_);
+  return prev != nullptr &&
+         prev->GetDisposalMethod() != CodecDisposalMethod::RestorePrevious;
+}
+
 }  // namespace skity
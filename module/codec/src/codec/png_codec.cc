@@ -4,10 +4,19 @@
 
 #include "src/codec/png_codec.hpp"
 
+#include <png.h>
+#include <zlib.h>
+
+#include <algorithm>
+#include <csetjmp>
+#include <cstddef>
 #include <cstdlib>
 #include <cstring>
+#include <functional>
+#include <limits>
 #include <skity/io/data.hpp>
 #include <skity/io/pixmap.hpp>
+#include <thread>
 #include <vector>
 
 #include "src/codec/codec_priv.hpp"
@@ -16,16 +25,6 @@ namespace skity {
 
 #define PNG_BYTES_TO_CHECK 4
 
-static void png_write_callback(png_structp png_ptr, png_bytep data,
-                               png_size_t length) {
-  auto encoded_data =
-      reinterpret_cast<std::vector<uint8_t>*>(png_get_io_ptr(png_ptr));
-
-  for (size_t i = 0; i < length; i++) {
-    encoded_data->emplace_back(data[i]);
-  }
-}
-
 struct PNGImage {
   png_image image = {};
 
@@ -34,13 +33,243 @@ struct PNGImage {
   ~PNGImage() { png_image_free(&image); }
 };
 
+namespace {
+
+// libpng reports errors with longjmp, the decoders report them through their
+// results. Keep the library silent.
+void OnPNGError(png_structp png_ptr, png_const_charp) {
+  png_longjmp(png_ptr, 1);
+}
+
+void OnPNGWarning(png_structp, png_const_charp) {}
+
+/**
+ * Sets up the same RGBA 8888 unpremul output as the simplified API used by
+ * DecodeIntrinsic(), after the info has been read. Returns the number of
+ * interlace passes.
+ */
+int SetupRGBAOutput(png_structp png_ptr, png_infop info_ptr) {
+  png_uint_32 width = 0;
+  png_uint_32 height = 0;
+  int bit_depth = 0;
+  int color_type = 0;
+  png_get_IHDR(png_ptr, info_ptr, &width, &height, &bit_depth, &color_type,
+               nullptr, nullptr, nullptr);
+
+  png_set_alpha_mode(png_ptr, PNG_ALPHA_PNG, PNG_DEFAULT_sRGB);
+  png_set_expand(png_ptr);
+  png_set_strip_16(png_ptr);
+  if (!(color_type & PNG_COLOR_MASK_COLOR)) {
+    png_set_gray_to_rgb(png_ptr);
+  }
+  if (!(color_type & PNG_COLOR_MASK_ALPHA) &&
+      !png_get_valid(png_ptr, info_ptr, PNG_INFO_tRNS)) {
+    png_set_filler(png_ptr, 0xFF, PNG_FILLER_AFTER);
+  }
+
+  int pass_count = png_set_interlace_handling(png_ptr);
+  png_read_update_info(png_ptr, info_ptr);
+
+  if (png_get_rowbytes(png_ptr, info_ptr) != width * 4) {
+    png_error(png_ptr, "unexpected row format");
+  }
+
+  return pass_count;
+}
+
+/**
+ * Reads the rows of an in-memory PNG one by one through the low level libpng
+ * API, for decodes which only keep some of the rows. The memory libpng
+ * allocates is tracked, so callers can report their working set.
+ */
+class PNGRowReader {
+ public:
+  explicit PNGRowReader(const std::shared_ptr<Data>& data)
+      : data_(data->Bytes()), size_(data->Size()) {
+    png_ptr_ =
+        png_create_read_struct_2(PNG_LIBPNG_VER_STRING, nullptr, OnPNGError,
+                                 OnPNGWarning, this, Allocate, Free);
+    if (png_ptr_) {
+      info_ptr_ = png_create_info_struct(png_ptr_);
+    }
+    if (info_ptr_) {
+      png_set_read_fn(png_ptr_, this, ReadData);
+    }
+  }
+
+  ~PNGRowReader() {
+    if (png_ptr_) {
+      png_destroy_read_struct(&png_ptr_, info_ptr_ ? &info_ptr_ : nullptr,
+                              nullptr);
+    }
+  }
+
+  // Reads the header and sets up RGBA 8888 output.
+  bool ReadInfo() {
+    if (!info_ptr_ || setjmp(png_jmpbuf(png_ptr_))) {
+      return false;
+    }
+
+    png_read_info(png_ptr_, info_ptr_);
+    pass_count_ = SetupRGBAOutput(png_ptr_, info_ptr_);
+    width_ = png_get_image_width(png_ptr_, info_ptr_);
+    height_ = png_get_image_height(png_ptr_, info_ptr_);
+    return true;
+  }
+
+  // Reads the next row into row, which holds Width() pixels.
+  bool ReadRow(uint8_t* row) {
+    if (setjmp(png_jmpbuf(png_ptr_))) {
+      return false;
+    }
+
+    png_read_row(png_ptr_, row, nullptr);
+    return true;
+  }
+
+  uint32_t Width() const { return width_; }
+
+  uint32_t Height() const { return height_; }
+
+  bool IsInterlaced() const { return pass_count_ > 1; }
+
+  size_t GetPeakAllocatedBytes() const { return peak_allocated_bytes_; }
+
+ private:
+  static void ReadData(png_structp png_ptr, png_bytep out, png_size_t length) {
+    auto self = static_cast<PNGRowReader*>(png_get_io_ptr(png_ptr));
+    if (length > self->size_ - self->offset_) {
+      png_error(png_ptr, "read past end of data");
+    }
+
+    std::memcpy(out, self->data_ + self->offset_, length);
+    self->offset_ += length;
+  }
+
+  // Blocks carry their size in front, so Free can account for them.
+  static png_voidp Allocate(png_structp png_ptr, png_alloc_size_t size) {
+    auto self = static_cast<PNGRowReader*>(png_get_mem_ptr(png_ptr));
+    if (size > std::numeric_limits<size_t>::max() - sizeof(std::max_align_t)) {
+      return nullptr;
+    }
+
+    auto block = static_cast<std::max_align_t*>(
+        std::malloc(sizeof(std::max_align_t) + size));
+    if (block == nullptr) {
+      return nullptr;
+    }
+
+    *reinterpret_cast<size_t*>(block) = size;
+    self->allocated_bytes_ += size;
+    self->peak_allocated_bytes_ =
+        std::max(self->peak_allocated_bytes_, self->allocated_bytes_);
+    return block + 1;
+  }
+
+  static void Free(png_structp png_ptr, png_voidp ptr) {
+    if (ptr == nullptr) {
+      return;
+    }
+
+    auto self = static_cast<PNGRowReader*>(png_get_mem_ptr(png_ptr));
+    auto block = static_cast<std::max_align_t*>(ptr) - 1;
+    self->allocated_bytes_ -= *reinterpret_cast<size_t*>(block);
+    std::free(block);
+  }
+
+ private:
+  const uint8_t* data_;
+  size_t size_;
+  size_t offset_ = 0;
+  size_t allocated_bytes_ = 0;
+  size_t peak_allocated_bytes_ = 0;
+  png_structp png_ptr_ = nullptr;
+  png_infop info_ptr_ = nullptr;
+  uint32_t width_ = 0;
+  uint32_t height_ = 0;
+  int pass_count_ = 1;
+};
+
+}  // namespace
+
 PNGCodec::PNGCodec() = default;
 
 PNGCodec::~PNGCodec() {}
 
 std::shared_ptr<Pixmap> skity::PNGCodec::Decode(const DecodeOptions& options) {
-  // libpng has no scaled decoding; decode at intrinsic size and resample.
-  return codec_priv::ResamplePixmapToTarget(DecodeIntrinsic(), options);
+  last_working_bytes_ = 0;
+  if (options.subset.IsEmpty() && options.target_width <= 0 &&
+      options.target_height <= 0) {
+    return DecodeIntrinsic();
+  }
+
+  // libpng has no scaled decoding. Stream the rows through the resampler so
+  // the intrinsic size image is never held.
+  return DecodeRows(options);
+}
+
+std::shared_ptr<Pixmap> PNGCodec::DecodeRows(const DecodeOptions& options) {
+  if (!data_) {
+    return nullptr;
+  }
+
+  PNGRowReader reader(data_);
+  CodecRect subset;
+  if (!reader.ReadInfo() ||
+      !codec_priv::ResolveSubset(static_cast<int32_t>(reader.Width()),
+                                 static_cast<int32_t>(reader.Height()), options,
+                                 &subset)) {
+    return nullptr;
+  }
+
+  if (reader.IsInterlaced()) {
+    // Every pass spans the whole image, no row is final before the last one.
+    return codec_priv::ApplyDecodeOptions(DecodeIntrinsic(), options);
+  }
+
+  int32_t target_width = 0;
+  int32_t target_height = 0;
+  std::unique_ptr<codec_priv::RowResampler> resampler;
+  std::shared_ptr<Pixmap> pixmap;
+  if (codec_priv::ResolveTargetSize(subset.Width(), subset.Height(), options,
+                                    &target_width, &target_height)) {
+    resampler = std::make_unique<codec_priv::RowResampler>(
+        subset.Width(), subset.Height(), target_width, target_height);
+    if (!resampler->IsValid()) {
+      return nullptr;
+    }
+  } else {
+    pixmap = std::make_shared<Pixmap>(subset.Width(), subset.Height());
+    if (pixmap->WritableAddr() == nullptr) {
+      return nullptr;
+    }
+  }
+
+  // Rows above the subset still need to be inflated, but are never stored.
+  // Decoding stops after the last row of the subset.
+  std::vector<uint8_t> row(static_cast<size_t>(reader.Width()) * 4);
+  const size_t offset = static_cast<size_t>(subset.X()) * 4;
+  const size_t size = static_cast<size_t>(subset.Width()) * 4;
+  for (int32_t y = 0; y < subset.Bottom(); y++) {
+    if (!reader.ReadRow(row.data())) {
+      return nullptr;
+    }
+    if (y < subset.Y()) {
+      continue;
+    }
+
+    if (resampler) {
+      resampler->PushRow(row.data() + offset);
+    } else {
+      std::memcpy(pixmap->WritableAddr8(0, y - subset.Y()),
+                  row.data() + offset, size);
+    }
+  }
+
+  last_working_bytes_ = reader.GetPeakAllocatedBytes() + row.capacity() +
+                        (resampler ? resampler->GetWorkingBytes() : 0);
+
+  return resampler ? resampler->Finish() : pixmap;
 }
 
 std::shared_ptr<Pixmap> skity::PNGCodec::DecodeIntrinsic() {
@@ -77,62 +306,641 @@ std::shared_ptr<Pixmap> skity::PNGCodec::DecodeIntrinsic() {
 
 std::shared_ptr<MultiFrameDecoder> PNGCodec::DecodeMultiFrame() { return {}; }
 
+namespace {
+
+/**
+ * Incremental decoder on top of the libpng progressive reader. Rows are
+ * written straight into the output pixmap, interlaced images are combined
+ * pass by pass.
+ */
+class PNGIncrementalDecoder : public IncrementalDecoder {
+ public:
+  PNGIncrementalDecoder() {
+    png_ptr_ = png_create_read_struct(PNG_LIBPNG_VER_STRING, nullptr,
+                                      OnPNGError, OnPNGWarning);
+    if (png_ptr_) {
+      info_ptr_ = png_create_info_struct(png_ptr_);
+    }
+
+    if (info_ptr_) {
+      png_set_progressive_read_fn(png_ptr_, this, OnInfo, OnRow, OnEnd);
+    } else {
+      result_ = Result::kError;
+    }
+  }
+
+  ~PNGIncrementalDecoder() override {
+    if (png_ptr_) {
+      png_destroy_read_struct(&png_ptr_, info_ptr_ ? &info_ptr_ : nullptr,
+                              nullptr);
+    }
+  }
+
+  Result Append(const void* data, size_t size) override {
+    if (result_ != Result::kNeedMoreData) {
+      return result_;
+    }
+
+    // No object with a destructor may live in this frame, libpng reports
+    // errors with longjmp.
+    if (setjmp(png_jmpbuf(png_ptr_))) {
+      result_ = Result::kError;
+    } else {
+      png_process_data(png_ptr_, info_ptr_,
+                       static_cast<png_bytep>(const_cast<void*>(data)), size);
+    }
+
+    if (pixmap_) {
+      pixmap_->NotifyPixelsChanged();
+    }
+
+    return result_;
+  }
+
+  Result Finish() override {
+    if (result_ == Result::kNeedMoreData) {
+      result_ = Result::kError;
+    }
+
+    return result_;
+  }
+
+ private:
+  static PNGIncrementalDecoder* From(png_structp png_ptr) {
+    return static_cast<PNGIncrementalDecoder*>(
+        png_get_progressive_ptr(png_ptr));
+  }
+
+  static void OnInfo(png_structp png_ptr, png_infop info_ptr) {
+    auto self = From(png_ptr);
+
+    self->pass_count_ = SetupRGBAOutput(png_ptr, info_ptr);
+    self->pixmap_ = std::make_shared<Pixmap>(
+        png_get_image_width(png_ptr, info_ptr),
+        png_get_image_height(png_ptr, info_ptr));
+    if (self->pixmap_->WritableAddr() == nullptr) {
+      png_error(png_ptr, "out of memory");
+    }
+  }
+
+  static void OnRow(png_structp png_ptr, png_bytep new_row,
+                    png_uint_32 row_num, int pass) {
+    auto self = From(png_ptr);
+    auto& pixmap = self->pixmap_;
+
+    if (row_num >= pixmap->Height()) {
+      return;
+    }
+
+    if (new_row) {
+      auto dst = static_cast<uint8_t*>(pixmap->WritableAddr()) +
+                 pixmap->RowBytes() * row_num;
+      png_progressive_combine_row(png_ptr, dst, new_row);
+    }
+
+    if (pass + 1 == self->pass_count_) {
+      self->decoded_rows_ = static_cast<int32_t>(row_num) + 1;
+    }
+
+    if (row_num + 1 == pixmap->Height()) {
+      self->completed_passes_ = pass + 1;
+    }
+  }
+
+  static void OnEnd(png_structp png_ptr, png_infop) {
+    auto self = From(png_ptr);
+
+    self->decoded_rows_ = static_cast<int32_t>(self->pixmap_->Height());
+    self->completed_passes_ = self->pass_count_;
+    self->result_ = Result::kComplete;
+  }
+
+ private:
+  png_structp png_ptr_ = nullptr;
+  png_infop info_ptr_ = nullptr;
+  int pass_count_ = 1;
+  Result result_ = Result::kNeedMoreData;
+};
+
+}  // namespace
+
+std::unique_ptr<IncrementalDecoder> PNGCodec::MakeIncrementalDecoder() {
+  return std::make_unique<PNGIncrementalDecoder>();
+}
+
+namespace {
+
+constexpr uint8_t kPNGSignature[] = {0x89, 0x50, 0x4E, 0x47,
+                                     0x0D, 0x0A, 0x1A, 0x0A};
+
+// Bands smaller than this cost more in thread startup and flush overhead than
+// they gain.
+constexpr uint32_t kMinRowsPerBand = 32;
+
 struct PNGDestructor {
   png_structp p;
-  explicit PNGDestructor(png_structp p) : p(p) {}
+  png_infop info;
+  explicit PNGDestructor(png_structp p) : p(p), info(nullptr) {}
   ~PNGDestructor() {
     if (p) {
-      png_destroy_write_struct(&p, nullptr);
+      png_destroy_write_struct(&p, info ? &info : nullptr);
     }
   }
 };
 
-std::shared_ptr<Data> skity::PNGCodec::Encode(const Pixmap* pixmap) {
-  if (!pixmap) {
-    return nullptr;
+/**
+ * Growable output of an encode. The memory is handed to the returned Data
+ * instead of being copied.
+ */
+class EncodeBuffer {
+ public:
+  EncodeBuffer() = default;
+
+  ~EncodeBuffer() { std::free(data_); }
+
+  EncodeBuffer(const EncodeBuffer&) = delete;
+  EncodeBuffer& operator=(const EncodeBuffer&) = delete;
+
+  bool Append(const void* src, size_t size) {
+    if (!Reserve(size_ + size)) {
+      return false;
+    }
+
+    std::memcpy(data_ + size_, src, size);
+    size_ += size;
+    return true;
   }
 
-  png_structp png_ptr;
-  png_infop info_ptr;
+  bool AppendU32(uint32_t value) {
+    uint8_t bytes[4] = {
+        static_cast<uint8_t>(value >> 24), static_cast<uint8_t>(value >> 16),
+        static_cast<uint8_t>(value >> 8), static_cast<uint8_t>(value)};
+    return Append(bytes, sizeof(bytes));
+  }
 
-  png_ptr =
-      png_create_write_struct(PNG_LIBPNG_VER_STRING, nullptr, nullptr, nullptr);
-  if (!png_ptr) {
-    return nullptr;
+  bool Reserve(size_t capacity) {
+    if (failed_) {
+      return false;
+    }
+
+    if (capacity <= capacity_) {
+      return true;
+    }
+
+    capacity = std::max(capacity, capacity_ * 2);
+    auto data = static_cast<uint8_t*>(std::realloc(data_, capacity));
+    if (data == nullptr) {
+      failed_ = true;
+      return false;
+    }
+
+    data_ = data;
+    capacity_ = capacity;
+    return true;
   }
 
-  PNGDestructor png_destructor{png_ptr};
+  size_t Size() const { return size_; }
+
+  std::shared_ptr<skity::Data> Release() {
+    if (failed_ || data_ == nullptr) {
+      return nullptr;
+    }
+
+    auto data = skity::Data::MakeFromMalloc(data_, size_);
+    data_ = nullptr;
+    size_ = capacity_ = 0;
+    return data;
+  }
+
+ private:
+  uint8_t* data_ = nullptr;
+  size_t size_ = 0;
+  size_t capacity_ = 0;
+  bool failed_ = false;
+};
+
+void png_write_callback(png_structp png_ptr, png_bytep data,
+                        png_size_t length) {
+  auto buffer = reinterpret_cast<EncodeBuffer*>(png_get_io_ptr(png_ptr));
+
+  if (!buffer->Append(data, length)) {
+    png_error(png_ptr, "out of memory");
+  }
+}
+
+void png_flush_callback(png_structp) {}
+
+int to_png_filter_mask(EncodeFilter filter) {
+  switch (filter) {
+    case EncodeFilter::kNone:
+      return PNG_FILTER_NONE;
+    case EncodeFilter::kSub:
+      return PNG_FILTER_SUB;
+    case EncodeFilter::kUp:
+      return PNG_FILTER_UP;
+    case EncodeFilter::kAverage:
+      return PNG_FILTER_AVG;
+    case EncodeFilter::kPaeth:
+      return PNG_FILTER_PAETH;
+    default:
+      return PNG_ALL_FILTERS;
+  }
+}
+
+int clamp_level(int32_t level) {
+  return level < 0 ? Z_DEFAULT_COMPRESSION : std::min(level, 9);
+}
+
+uint8_t paeth_predictor(int a, int b, int c) {
+  int p = a + b - c;
+  int pa = std::abs(p - a);
+  int pb = std::abs(p - b);
+  int pc = std::abs(p - c);
+  if (pa <= pb && pa <= pc) {
+    return static_cast<uint8_t>(a);
+  }
+  return static_cast<uint8_t>(pb <= pc ? b : c);
+}
+
+// Writes the filter type byte followed by the filtered row to dst. prev is
+// nullptr for the first row of the image.
+void filter_row(EncodeFilter filter, const uint8_t* row, const uint8_t* prev,
+                size_t row_size, uint8_t* dst) {
+  constexpr size_t kBpp = 4;
+  uint8_t* out = dst + 1;
+
+  switch (filter) {
+    case EncodeFilter::kSub:
+      dst[0] = PNG_FILTER_VALUE_SUB;
+      for (size_t i = 0; i < row_size; i++) {
+        out[i] = row[i] - (i >= kBpp ? row[i - kBpp] : 0);
+      }
+      break;
+    case EncodeFilter::kUp:
+      dst[0] = PNG_FILTER_VALUE_UP;
+      for (size_t i = 0; i < row_size; i++) {
+        out[i] = row[i] - (prev ? prev[i] : 0);
+      }
+      break;
+    case EncodeFilter::kAverage:
+      dst[0] = PNG_FILTER_VALUE_AVG;
+      for (size_t i = 0; i < row_size; i++) {
+        int left = i >= kBpp ? row[i - kBpp] : 0;
+        int up = prev ? prev[i] : 0;
+        out[i] = row[i] - static_cast<uint8_t>((left + up) >> 1);
+      }
+      break;
+    case EncodeFilter::kPaeth:
+      dst[0] = PNG_FILTER_VALUE_PAETH;
+      for (size_t i = 0; i < row_size; i++) {
+        int left = i >= kBpp ? row[i - kBpp] : 0;
+        int up = prev ? prev[i] : 0;
+        int up_left = (prev && i >= kBpp) ? prev[i - kBpp] : 0;
+        out[i] = row[i] - paeth_predictor(left, up, up_left);
+      }
+      break;
+    default:
+      dst[0] = PNG_FILTER_VALUE_NONE;
+      std::memcpy(out, row, row_size);
+      break;
+  }
+}
+
+// Same heuristic as libpng: the filter with the smallest sum of absolute
+// signed residuals usually compresses best.
+void filter_row_adaptive(const uint8_t* row, const uint8_t* prev,
+                         size_t row_size, uint8_t* dst, uint8_t* scratch) {
+  constexpr EncodeFilter kFilters[] = {
+      EncodeFilter::kNone, EncodeFilter::kSub, EncodeFilter::kUp,
+      EncodeFilter::kAverage, EncodeFilter::kPaeth};
+
+  uint64_t best_sum = std::numeric_limits<uint64_t>::max();
+  for (auto filter : kFilters) {
+    filter_row(filter, row, prev, row_size, scratch);
+
+    uint64_t sum = 0;
+    for (size_t i = 1; i <= row_size; i++) {
+      sum += std::abs(static_cast<int8_t>(scratch[i]));
+    }
+
+    if (sum < best_sum) {
+      best_sum = sum;
+      std::memcpy(dst, scratch, row_size + 1);
+    }
+  }
+}
+
+struct EncodeBand {
+  uint32_t first_row = 0;
+  uint32_t last_row = 0;
+  std::vector<uint8_t> deflated = {};
+  uLong adler = 0;
+  uLong raw_size = 0;
+  bool ok = false;
+};
+
+// Runs deflate until all input is consumed and, for a flush, all output is
+// written, growing `out` whenever it fills up. With Z_FINISH only
+// Z_STREAM_END means done, Z_OK just asks for more output space.
+bool deflate_all(z_stream* stream, int flush, std::vector<uint8_t>* out) {
+  for (;;) {
+    if (stream->avail_out == 0) {
+      const size_t used = stream->total_out;
+      out->resize(std::max<size_t>(out->size() * 2, 64));
+      stream->next_out = out->data() + used;
+      stream->avail_out = static_cast<uInt>(out->size() - used);
+    }
+
+    int ret = deflate(stream, flush);
+    if (flush == Z_FINISH) {
+      if (ret == Z_STREAM_END) {
+        return true;
+      }
+      // Anything but a full output buffer means deflate can not finish.
+      if ((ret != Z_OK && ret != Z_BUF_ERROR) || stream->avail_out != 0) {
+        return false;
+      }
+      continue;
+    }
+
+    if (ret != Z_OK && ret != Z_BUF_ERROR) {
+      return false;
+    }
+    // Space left in the output buffer means the input and the pending flush
+    // have been written out.
+    if (stream->avail_out != 0) {
+      return stream->avail_in == 0;
+    }
+  }
+}
+
+// Filters and deflates rows [first_row, last_row) into a raw deflate stream.
+// Every band but the last ends with a sync flush, so the bands concatenate to
+// one valid stream.
+void encode_band(const Pixmap* pixmap, const EncodeOptions& options,
+                 bool is_last, EncodeBand* band) {
+  const size_t row_size = static_cast<size_t>(pixmap->Width()) * 4;
+  const auto bytes_per_pixel = pixmap->RowBytes() / pixmap->Width();
+  auto transform_line = codec_priv::ChooseLineTransformFunc(
+      pixmap->GetColorType(), pixmap->GetAlphaType());
+  auto src_row = [pixmap](uint32_t y) {
+    return const_cast<uint8_t*>(static_cast<const uint8_t*>(pixmap->Addr())) +
+           pixmap->RowBytes() * y;
+  };
+
+  std::vector<uint8_t> rows(row_size * 2);
+  uint8_t* prev = nullptr;
+  uint8_t* curr = rows.data();
+  if (band->first_row > 0) {
+    prev = rows.data() + row_size;
+    transform_line(prev, src_row(band->first_row - 1), pixmap->Width(),
+                   bytes_per_pixel);
+  }
+
+  std::vector<uint8_t> filtered(row_size + 1);
+  std::vector<uint8_t> scratch(row_size + 1);
+
+  z_stream stream = {};
+  if (deflateInit2(&stream, clamp_level(options.compression_level),
+                   Z_DEFLATED, -MAX_WBITS, 8, Z_DEFAULT_STRATEGY) != Z_OK) {
+    return;
+  }
+
+  const uLong raw_size =
+      static_cast<uLong>(band->last_row - band->first_row) * (row_size + 1);
+  band->deflated.resize(deflateBound(&stream, raw_size) + 16);
+  band->adler = adler32(0L, Z_NULL, 0);
+  band->raw_size = raw_size;
+
+  stream.next_out = band->deflated.data();
+  stream.avail_out = static_cast<uInt>(band->deflated.size());
+
+  auto filter = options.filter == EncodeFilter::kDefault
+                    ? EncodeFilter::kAdaptive
+                    : options.filter;
+
+  bool ok = true;
+  for (uint32_t y = band->first_row; y < band->last_row && ok; y++) {
+    transform_line(curr, src_row(y), pixmap->Width(), bytes_per_pixel);
+
+    if (filter == EncodeFilter::kAdaptive) {
+      filter_row_adaptive(curr, prev, row_size, filtered.data(),
+                          scratch.data());
+    } else {
+      filter_row(filter, curr, prev, row_size, filtered.data());
+    }
+
+    band->adler = adler32(band->adler, filtered.data(),
+                          static_cast<uInt>(filtered.size()));
+
+    const bool is_last_row = y + 1 == band->last_row;
+    stream.next_in = filtered.data();
+    stream.avail_in = static_cast<uInt>(filtered.size());
+    int flush = Z_NO_FLUSH;
+    if (is_last_row) {
+      flush = is_last ? Z_FINISH : Z_SYNC_FLUSH;
+    }
+
+    ok = deflate_all(&stream, flush, &band->deflated);
+
+    if (prev == nullptr) {
+      prev = rows.data() + row_size;
+    }
+    std::swap(prev, curr);
+  }
+
+  band->deflated.resize(stream.total_out);
+  deflateEnd(&stream);
+  band->ok = ok;
+}
+
+// Writes the header and all rows of `pixmap`. No object with a destructor may
+// live in this frame, libpng reports errors, e.g. running out of memory in
+// png_write_callback, with longjmp.
+bool write_png_rows(png_structp png_ptr, png_infop info_ptr,
+                    const Pixmap* pixmap, const EncodeOptions& options,
+                    uint8_t* row) {
+  if (setjmp(png_jmpbuf(png_ptr))) {
+    return false;
+  }
 
-  info_ptr = png_create_info_struct(png_ptr);
   png_set_IHDR(png_ptr, info_ptr, pixmap->Width(), pixmap->Height(), 8,
                PNG_COLOR_TYPE_RGBA, PNG_INTERLACE_NONE,
                PNG_COMPRESSION_TYPE_DEFAULT, PNG_FILTER_TYPE_DEFAULT);
 
-  std::vector<uint8_t*> bytepp(pixmap->Height());
-  for (size_t i = 0; i < bytepp.size(); i++) {
-    bytepp[i] = ((uint8_t*)pixmap->Addr()) + pixmap->Width() * i * 4;  // NOLINT
+  if (options.compression_level >= 0) {
+    png_set_compression_level(png_ptr, clamp_level(options.compression_level));
   }
 
-  std::vector<uint8_t> encode_data{};
-  png_set_write_fn(png_ptr, &encode_data, png_write_callback, nullptr);
+  if (options.filter != EncodeFilter::kDefault) {
+    png_set_filter(png_ptr, PNG_FILTER_TYPE_BASE,
+                   to_png_filter_mask(options.filter));
+  }
 
   png_write_info(png_ptr, info_ptr);
 
+  auto transform_line = codec_priv::ChooseLineTransformFunc(
+      pixmap->GetColorType(), pixmap->GetAlphaType());
   auto bytes_per_pixel = pixmap->RowBytes() / pixmap->Width();
-  for (int y = 0; y < pixmap->Height(); y++) {
-    std::vector<uint8_t> row(pixmap->RowBytes());
+  auto src = const_cast<uint8_t*>(static_cast<const uint8_t*>(pixmap->Addr()));
 
-    auto transform_line = codec_priv::ChooseLineTransformFunc(
-        pixmap->GetColorType(), pixmap->GetAlphaType());
+  for (uint32_t y = 0; y < pixmap->Height(); y++) {
+    transform_line(row, src + pixmap->RowBytes() * y, pixmap->Width(),
+                   bytes_per_pixel);
 
-    transform_line(row.data(), bytepp[y], pixmap->Width(), bytes_per_pixel);
-
-    png_write_row(png_ptr, row.data());
+    png_write_row(png_ptr, row);
   }
 
   png_write_end(png_ptr, info_ptr);
 
-  return Data::MakeWithCopy(encode_data.data(), encode_data.size());
+  return true;
+}
+
+bool write_chunk(EncodeBuffer& buffer, const char type[4], const uint8_t* data,
+                 size_t size) {
+  uLong crc = crc32(0L, reinterpret_cast<const Bytef*>(type), 4);
+  if (size > 0) {
+    crc = crc32(crc, data, static_cast<uInt>(size));
+  }
+
+  return buffer.AppendU32(static_cast<uint32_t>(size)) &&
+         buffer.Append(type, 4) && (size == 0 || buffer.Append(data, size)) &&
+         buffer.AppendU32(static_cast<uint32_t>(crc));
+}
+
+}  // namespace
+
+std::shared_ptr<Data> PNGCodec::Encode(const Pixmap* pixmap) {
+  return Encode(pixmap, EncodeOptions{});
+}
+
+std::shared_ptr<Data> PNGCodec::Encode(const Pixmap* pixmap,
+                                       const EncodeOptions& options) {
+  if (!pixmap || pixmap->Width() == 0 || pixmap->Height() == 0) {
+    return nullptr;
+  }
+
+  if (options.thread_count > 1 && pixmap->Height() >= kMinRowsPerBand * 2) {
+    return EncodeParallel(pixmap, options);
+  }
+
+  return EncodeSerial(pixmap, options);
+}
+
+std::shared_ptr<Data> PNGCodec::EncodeSerial(const Pixmap* pixmap,
+                                             const EncodeOptions& options) {
+  png_structp png_ptr =
+      png_create_write_struct(PNG_LIBPNG_VER_STRING, nullptr, nullptr, nullptr);
+  if (!png_ptr) {
+    return nullptr;
+  }
+
+  PNGDestructor png_destructor{png_ptr};
+
+  png_infop info_ptr = png_create_info_struct(png_ptr);
+  png_destructor.info = info_ptr;
+  if (!info_ptr) {
+    return nullptr;
+  }
+
+  EncodeBuffer encode_data;
+  // Half the raw size covers most images without regrowing.
+  const size_t raw_size = static_cast<size_t>(pixmap->Width()) * 4 *
+                          pixmap->Height();
+  encode_data.Reserve(raw_size / 2 + 1024);
+  png_set_write_fn(png_ptr, &encode_data, png_write_callback,
+                   png_flush_callback);
+
+  std::vector<uint8_t> row(static_cast<size_t>(pixmap->Width()) * 4);
+  if (!write_png_rows(png_ptr, info_ptr, pixmap, options, row.data())) {
+    return nullptr;
+  }
+
+  return encode_data.Release();
+}
+
+std::shared_ptr<Data> PNGCodec::EncodeParallel(const Pixmap* pixmap,
+                                               const EncodeOptions& options) {
+  const uint32_t height = pixmap->Height();
+  const uint32_t band_count =
+      std::min<uint32_t>(options.thread_count, height / kMinRowsPerBand);
+
+  std::vector<EncodeBand> bands(band_count);
+  for (uint32_t i = 0; i < band_count; i++) {
+    bands[i].first_row = static_cast<uint64_t>(height) * i / band_count;
+    bands[i].last_row = static_cast<uint64_t>(height) * (i + 1) / band_count;
+  }
+
+  std::vector<std::thread> threads;
+  threads.reserve(band_count - 1);
+  for (uint32_t i = 1; i < band_count; i++) {
+    threads.emplace_back(encode_band, pixmap, std::cref(options),
+                         i + 1 == band_count, &bands[i]);
+  }
+  encode_band(pixmap, options, band_count == 1, &bands[0]);
+  for (auto& thread : threads) {
+    thread.join();
+  }
+
+  uLong adler = adler32(0L, Z_NULL, 0);
+  size_t deflated_size = 0;
+  for (const auto& band : bands) {
+    if (!band.ok) {
+      return nullptr;
+    }
+    adler = adler32_combine(adler, band.adler, band.raw_size);
+    deflated_size += band.deflated.size();
+  }
+
+  EncodeBuffer encode_data;
+  if (!encode_data.Reserve(sizeof(kPNGSignature) + 25 + deflated_size +
+                           band_count * 12 + 6 + 12)) {
+    return nullptr;
+  }
+
+  encode_data.Append(kPNGSignature, sizeof(kPNGSignature));
+
+  uint8_t ihdr[13] = {};
+  for (int i = 0; i < 4; i++) {
+    ihdr[i] = static_cast<uint8_t>(pixmap->Width() >> (24 - i * 8));
+    ihdr[4 + i] = static_cast<uint8_t>(height >> (24 - i * 8));
+  }
+  ihdr[8] = 8;                    // bit depth
+  ihdr[9] = PNG_COLOR_TYPE_RGBA;  // color type
+  write_chunk(encode_data, "IHDR", ihdr, sizeof(ihdr));
+
+  // zlib header, FLEVEL only informs decoders about the level used.
+  const int level = clamp_level(options.compression_level);
+  uint8_t flevel = 2;
+  if (level >= 0 && level < 2) {
+    flevel = 0;
+  } else if (level >= 2 && level < 6) {
+    flevel = 1;
+  } else if (level > 6) {
+    flevel = 3;
+  }
+  uint8_t cmf = 0x78;
+  uint8_t flg = static_cast<uint8_t>(flevel << 6);
+  flg += 31 - ((cmf << 8) + flg) % 31;
+
+  // One IDAT per band, the zlib header and adler32 trailer wrap the
+  // concatenated deflate stream.
+  for (uint32_t i = 0; i < band_count; i++) {
+    auto& deflated = bands[i].deflated;
+    if (i == 0) {
+      deflated.insert(deflated.begin(), {cmf, flg});
+    }
+    if (i + 1 == band_count) {
+      for (int shift = 24; shift >= 0; shift -= 8) {
+        deflated.push_back(static_cast<uint8_t>(adler >> shift));
+      }
+    }
+    write_chunk(encode_data, "IDAT", deflated.data(), deflated.size());
+  }
+
+  write_chunk(encode_data, "IEND", nullptr, 0);
+
+  return encode_data.Release();
 }
 
 bool skity::PNGCodec::RecognizeFileType(const char* header, size_t size) {
@@ -5,8 +5,6 @@
 #ifndef MODULE_CODEC_SRC_CODEC_PNG_CODEC_HPP
 #define MODULE_CODEC_SRC_CODEC_PNG_CODEC_HPP
 
-#include <png.h>
-
 #include <skity/codec/codec.hpp>
 
 namespace skity {
@@ -17,9 +15,19 @@ class PNGCodec : public Codec {
   ~PNGCodec() override;
   std::shared_ptr<Pixmap> Decode(const DecodeOptions& options) override;
   std::shared_ptr<MultiFrameDecoder> DecodeMultiFrame() override;
+  std::unique_ptr<IncrementalDecoder> MakeIncrementalDecoder() override;
   std::shared_ptr<Data> Encode(const Pixmap* pixmap) override;
+  std::shared_ptr<Data> Encode(const Pixmap* pixmap,
+                               const EncodeOptions& options) override;
   bool RecognizeFileType(const char* header, size_t size) override;
 
+  /**
+   * Peak bytes the last row by row decode held besides its output: libpng
+   * state, the row buffer and the resampler window. Zero when the last decode
+   * went through the simplified API.
+   */
+  size_t GetLastDecodeWorkingBytes() const { return last_working_bytes_; }
+
  protected:
   std::shared_ptr<Codec> Fork() override {
     return std::make_shared<PNGCodec>();
@@ -27,6 +35,22 @@ class PNGCodec : public Codec {
 
  private:
   std::shared_ptr<Pixmap> DecodeIntrinsic();
+
+  // Decodes row by row, keeping only the rows of the subset and resampling
+  // them to the target size as they arrive. Interlaced images fall back to a
+  // full decode.
+  std::shared_ptr<Pixmap> DecodeRows(const DecodeOptions& options);
+
+  std::shared_ptr<Data> EncodeSerial(const Pixmap* pixmap,
+                                     const EncodeOptions& options);
+
+  // Deflates bands of rows on separate threads and stitches them into one
+  // zlib stream.
+  std::shared_ptr<Data> EncodeParallel(const Pixmap* pixmap,
+                                       const EncodeOptions& options);
+
+ private:
+  size_t last_working_bytes_ = 0;
 };
 
 }  // namespace skity
@@ -11,23 +11,20 @@ namespace skity {
 
 namespace {
 
-using WebPAnimDecoderPTR =
-    std::unique_ptr<WebPAnimDecoder, decltype(&WebPAnimDecoderDelete)>;
-
 WebPAnimDecoderPTR CreateAnimDecoder(const Data* data) {
   if (data == nullptr) {
-    return {nullptr, WebPAnimDecoderDelete};
+    return nullptr;
   }
 
   WebPAnimDecoderOptions options;
   if (!WebPAnimDecoderOptionsInit(&options)) {
-    return {nullptr, WebPAnimDecoderDelete};
+    return nullptr;
   }
 
   options.color_mode = MODE_RGBA;
 
   WebPData webp_data{data->Bytes(), data->Size()};
-  return {WebPAnimDecoderNew(&webp_data, &options), WebPAnimDecoderDelete};
+  return WebPAnimDecoderNew(&webp_data, &options);
 }
 
 std::shared_ptr<Pixmap> PrepareOutputPixmap(std::shared_ptr<Pixmap> pixmap,
@@ -102,39 +99,50 @@ std::shared_ptr<Pixmap> WebpDecoder::DecodeFrame(
     return nullptr;
   }
 
-  auto anim_decoder = CreateAnimDecoder(data_.get());
-  if (!anim_decoder) {
-    return nullptr;
+  if (!anim_decoder_) {
+    anim_decoder_ = CreateAnimDecoder(data_.get());
+    anim_frame_index_ = -1;
+    if (!anim_decoder_) {
+      return nullptr;
+    }
   }
 
   // WebP animation frame dependencies can skip over adjacent frames once
   // blend/dispose rules are considered. Replaying through libwebp's animator
-  // keeps the reconstructed canvas correct for the target frame.
-  uint8_t* decoded_frame = nullptr;
-  int timestamp = 0;
-  for (int32_t i = 0; i <= index; ++i) {
-    if (!WebPAnimDecoderGetNext(anim_decoder.get(), &decoded_frame,
+  // keeps the reconstructed canvas correct for the target frame. The animator
+  // only runs forward, so an earlier frame replays from the start.
+  if (index < anim_frame_index_) {
+    WebPAnimDecoderReset(anim_decoder_.get());
+    anim_frame_index_ = -1;
+  }
+
+  while (anim_frame_index_ < index) {
+    int timestamp = 0;
+    if (!WebPAnimDecoderGetNext(anim_decoder_.get(), &anim_canvas_,
                                 &timestamp)) {
+      WebPAnimDecoderReset(anim_decoder_.get());
+      anim_frame_index_ = -1;
       return nullptr;
     }
+    anim_frame_index_++;
   }
 
   auto pixmap =
       PrepareOutputPixmap(std::move(prev_pixmap), frame_width_, frame_height_);
-  std::memcpy(pixmap->WritableAddr8(0, 0), decoded_frame,
+  std::memcpy(pixmap->WritableAddr8(0, 0), anim_canvas_,
               pixmap->RowBytes() * pixmap->Height());
 
   return pixmap;
 }
 
-std::shared_ptr<Pixmap> WebpDecoder::DecodeFirstFrameScaled(
-    int32_t target_width, int32_t target_height) {
+std::shared_ptr<Pixmap> WebpDecoder::DecodeFirstFrame(const CodecRect& subset,
+                                                      int32_t target_width,
+                                                      int32_t target_height) {
   // Animated files — including single-frame ones — must not take this path:
   // the fragment covers the frame rect only, so decoding it scaled to the
   // canvas-derived target would drop the offset, background and blend
   // semantics. Fall back to the anim-decoder canvas path.
-  if (frame_count_ != 1 || is_animation_ || target_width <= 0 ||
-      target_height <= 0) {
+  if (frame_count_ != 1 || is_animation_ || subset.IsEmpty()) {
     return nullptr;
   }
 
@@ -154,9 +162,20 @@ std::shared_ptr<Pixmap> WebpDecoder::DecodeFirstFrameScaled(
   }
 
   config.output.colorspace = MODE_RGBA;
-  config.options.use_scaling = 1;
-  config.options.scaled_width = target_width;
-  config.options.scaled_height = target_height;
+  if (subset != CodecRect{0, 0, frame_width_, frame_height_}) {
+    // RGBA output is cropped at any offset, only YUV output snaps to even
+    // coordinates.
+    config.options.use_cropping = 1;
+    config.options.crop_left = subset.X();
+    config.options.crop_top = subset.Y();
+    config.options.crop_width = subset.Width();
+    config.options.crop_height = subset.Height();
+  }
+  if (target_width > 0 && target_height > 0) {
+    config.options.use_scaling = 1;
+    config.options.scaled_width = target_width;
+    config.options.scaled_height = target_height;
+  }
 
   if (WebPDecode(iter.fragment.bytes, iter.fragment.size, &config) !=
       VP8_STATUS_OK) {
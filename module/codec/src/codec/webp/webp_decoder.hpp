@@ -50,6 +50,15 @@ class WebPIDecoderPTR
                                                               WebPIDelete) {}
 };
 
+class WebPAnimDecoderPTR
+    : public std::unique_ptr<WebPAnimDecoder,
+                             decltype(&WebPAnimDecoderDelete)> {
+ public:
+  WebPAnimDecoderPTR(WebPAnimDecoder* decoder)
+      : std::unique_ptr<WebPAnimDecoder, decltype(&WebPAnimDecoderDelete)>(
+            decoder, WebPAnimDecoderDelete) {}
+};
+
 class WebpDecoder : public MultiFrameDecoder {
  public:
   WebpDecoder(WebPDemuxerPTR demuxer, std::shared_ptr<Data> data);
@@ -67,17 +76,20 @@ class WebpDecoder : public MultiFrameDecoder {
       const CodecFrame* frame, std::shared_ptr<Pixmap> prev_pixmap) override;
 
   /**
-   * Decode the (only) frame at an exact scaled size, using libwebp's built-in
-   * rescaler (WebPDecoderConfig use_scaling). Only valid for single-frame
+   * Decode a subset of the (only) frame at an exact scaled size, using
+   * libwebp's built-in cropping and rescaler (WebPDecoderConfig use_cropping
+   * and use_scaling). Cropping happens before scaling; a non-positive target
+   * size decodes the subset at intrinsic size. Only valid for single-frame
    * *static* images; animated images must go through DecodeFrame() for canvas
    * compositing (an animation may legally have a single ANMF frame whose
    * fragment covers only part of the canvas).
    *
    * Returns nullptr on failure; the caller is expected to fall back to
-   * DecodeFrame() + resample.
+   * DecodeFrame() + crop and resample.
    */
-  std::shared_ptr<Pixmap> DecodeFirstFrameScaled(int32_t target_width,
-                                                 int32_t target_height);
+  std::shared_ptr<Pixmap> DecodeFirstFrame(const CodecRect& subset,
+                                           int32_t target_width,
+                                           int32_t target_height);
 
   const std::shared_ptr<Data>& GetData() const { return data_; }
 
@@ -94,6 +106,13 @@ class WebpDecoder : public MultiFrameDecoder {
   bool is_animation_ = false;
 
   std::vector<WebpFrame> frames_ = {};
+
+  // The animator is kept between DecodeFrame() calls, so playing in order
+  // advances it one frame per call. It is only rewound when an earlier frame
+  // is requested.
+  WebPAnimDecoderPTR anim_decoder_ = nullptr;
+  int32_t anim_frame_index_ = -1;
+  uint8_t* anim_canvas_ = nullptr;
 };
 
 }  // namespace skity
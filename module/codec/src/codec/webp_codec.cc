@@ -4,9 +4,13 @@
 
 #include "src/codec/webp_codec.hpp"
 
+#include <algorithm>
 #include <cstring>
+#include <skity/io/pixmap.hpp>
+#include <vector>
 
 #include "src/codec/codec_priv.hpp"
+#include "src/codec/incremental_decoder.hpp"
 #include "src/codec/webp/webp_decoder.hpp"
 
 namespace skity {
@@ -30,6 +34,130 @@ std::shared_ptr<WebpDecoder> CreateWebpDecoder(std::shared_ptr<Data> data) {
   return std::make_shared<WebpDecoder>(std::move(demuxer), std::move(data));
 }
 
+/**
+ * Incremental decoder for still images on top of the libwebp incremental
+ * decoder, which writes the rows straight into the output pixmap. Animated
+ * images are collected and decoded once complete.
+ */
+class WEBPIncrementalDecoder : public IncrementalDecoder {
+ public:
+  WEBPIncrementalDecoder() = default;
+  ~WEBPIncrementalDecoder() override = default;
+
+  Result Append(const void* data, size_t size) override {
+    if (result_ != Result::kNeedMoreData) {
+      return result_;
+    }
+
+    if (fallback_) {
+      return Forward(fallback_->Append(data, size));
+    }
+
+    if (!decoder_) {
+      // The output can only be set up once the features are known.
+      auto bytes = static_cast<const uint8_t*>(data);
+      header_.insert(header_.end(), bytes, bytes + size);
+      if (!CreateDecoder()) {
+        return result_;
+      }
+
+      data = header_.data();
+      size = header_.size();
+    }
+
+    auto status =
+        WebPIAppend(decoder_.get(), static_cast<const uint8_t*>(data), size);
+    header_.clear();
+
+    int last_y = 0;
+    if (WebPIDecGetRGB(decoder_.get(), &last_y, nullptr, nullptr, nullptr)) {
+      decoded_rows_ = std::max(decoded_rows_, last_y);
+    }
+
+    if (status == VP8_STATUS_OK) {
+      decoded_rows_ = static_cast<int32_t>(pixmap_->Height());
+      completed_passes_ = 1;
+      result_ = Result::kComplete;
+    } else if (status != VP8_STATUS_SUSPENDED) {
+      result_ = Result::kError;
+    }
+
+    pixmap_->NotifyPixelsChanged();
+
+    return result_;
+  }
+
+  Result Finish() override {
+    if (fallback_) {
+      return Forward(fallback_->Finish());
+    }
+
+    if (result_ == Result::kNeedMoreData) {
+      result_ = Result::kError;
+    }
+
+    return result_;
+  }
+
+ private:
+  bool CreateDecoder() {
+    WebPBitstreamFeatures features;
+    auto status = WebPGetFeatures(header_.data(), header_.size(), &features);
+    if (status == VP8_STATUS_NOT_ENOUGH_DATA) {
+      return false;
+    }
+
+    if (status != VP8_STATUS_OK || features.width <= 0 ||
+        features.height <= 0) {
+      result_ = Result::kError;
+      return false;
+    }
+
+    if (features.has_animation) {
+      // Frames need the demuxer and canvas compositing of DecodeFrame().
+      fallback_ =
+          std::make_unique<BufferedIncrementalDecoder>(Codec::MakeWebpCodec());
+      Forward(fallback_->Append(header_.data(), header_.size()));
+      header_.clear();
+      return false;
+    }
+
+    pixmap_ = std::make_shared<Pixmap>(features.width, features.height,
+                                       AlphaType::kUnpremul_AlphaType,
+                                       ColorType::kRGBA);
+    auto pixels = static_cast<uint8_t*>(pixmap_->WritableAddr());
+    if (pixels != nullptr) {
+      decoder_.reset(WebPINewRGB(MODE_RGBA, pixels,
+                                 pixmap_->RowBytes() * pixmap_->Height(),
+                                 static_cast<int>(pixmap_->RowBytes())));
+    }
+
+    if (!decoder_) {
+      pixmap_ = nullptr;
+      result_ = Result::kError;
+      return false;
+    }
+
+    return true;
+  }
+
+  Result Forward(Result result) {
+    pixmap_ = fallback_->GetPixmap();
+    decoded_rows_ = fallback_->GetDecodedRows();
+    completed_passes_ = fallback_->GetCompletedPasses();
+    result_ = result;
+
+    return result_;
+  }
+
+ private:
+  // Writes into the pixels of pixmap_, which is destroyed after it.
+  WebPIDecoderPTR decoder_{nullptr};
+  std::unique_ptr<IncrementalDecoder> fallback_;
+  std::vector<uint8_t> header_ = {};
+  Result result_ = Result::kNeedMoreData;
+};
+
 }  // namespace
 
 WEBPCodec::WEBPCodec() = default;
@@ -49,25 +177,34 @@ std::shared_ptr<Pixmap> WEBPCodec::Decode(const DecodeOptions& options) {
     return {};
   }
 
+  CodecRect subset;
+  if (!codec_priv::ResolveSubset(decoder_->GetWidth(), decoder_->GetHeight(),
+                                 options, &subset)) {
+    return {};
+  }
+
   int32_t target_width = 0;
   int32_t target_height = 0;
+  bool need_scale =
+      codec_priv::ResolveTargetSize(subset.Width(), subset.Height(), options,
+                                    &target_width, &target_height);
   if (decoder_->GetFrameCount() == 1 &&
-      codec_priv::ResolveTargetSize(decoder_->GetWidth(), decoder_->GetHeight(),
-                                    options, &target_width, &target_height)) {
-    // Single-frame WebP: let libwebp's rescaler hit the exact target size.
-    // On failure fall through to the anim-decoder path below, which also
-    // handles single-frame files.
-    auto scaled = decoder_->DecodeFirstFrameScaled(target_width, target_height);
+      (need_scale || !options.subset.IsEmpty())) {
+    // Single-frame WebP: let libwebp crop the subset and its rescaler hit the
+    // exact target size. On failure fall through to the anim-decoder path
+    // below, which also handles single-frame files.
+    auto scaled =
+        decoder_->DecodeFirstFrame(subset, target_width, target_height);
     if (scaled) {
       return scaled;
     }
   }
 
   // Animated WebP keeps the canvas path at intrinsic size in v1 (the anim
-  // decoder has no scaling); resample afterwards like the other fallback
-  // formats.
-  return codec_priv::ResamplePixmapToTarget(
-      decoder_->DecodeFrame(frame, nullptr), options);
+  // decoder has no cropping or scaling); crop and resample afterwards like
+  // the other fallback formats.
+  return codec_priv::ApplyDecodeOptions(decoder_->DecodeFrame(frame, nullptr),
+                                        options);
 }
 
 std::shared_ptr<MultiFrameDecoder> WEBPCodec::DecodeMultiFrame() {
@@ -76,6 +213,10 @@ std::shared_ptr<MultiFrameDecoder> WEBPCodec::DecodeMultiFrame() {
   return decoder_;
 }
 
+std::unique_ptr<IncrementalDecoder> WEBPCodec::MakeIncrementalDecoder() {
+  return std::make_unique<WEBPIncrementalDecoder>();
+}
+
 bool WEBPCodec::RecognizeFileType(const char* header, size_t size) {
   return size >= 14 && std::memcmp(header, "RIFF", 4) == 0 &&
          std::memcmp(header + 8, "WEBPVP", 6) == 0;
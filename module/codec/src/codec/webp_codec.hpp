@@ -16,6 +16,7 @@ class WEBPCodec : public Codec {
   WEBPCodec();
   ~WEBPCodec() override;
 
+  using Codec::Encode;
   std::shared_ptr<Data> Encode(const Pixmap *pixmap) override {
     // WebP does not support encoding.
     return nullptr;
@@ -27,6 +28,8 @@ class WEBPCodec : public Codec {
 
   std::shared_ptr<MultiFrameDecoder> DecodeMultiFrame() override;
 
+  std::unique_ptr<IncrementalDecoder> MakeIncrementalDecoder() override;
+
  protected:
   std::shared_ptr<Codec> Fork() override {
     return std::make_shared<WEBPCodec>();
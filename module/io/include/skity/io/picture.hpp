@@ -13,6 +13,8 @@
 #include <skity/recorder/display_list.hpp>
 #include <skity/text/typeface.hpp>
 #include <string>
+#include <unordered_map>
+#include <vector>
 
 namespace skity {
 
@@ -22,9 +24,16 @@ class RecordPlayback;
 class ReadBuffer;
 
 struct SKITY_API TypefaceSet {
-  std::vector<std::shared_ptr<Typeface>> typefaces;
-
   int32_t AddTypeface(const std::shared_ptr<Typeface>& typeface);
+
+  std::shared_ptr<Typeface> GetTypeface(int32_t index) const;
+
+  size_t GetTypefaceCount() const;
+
+ private:
+  std::vector<std::shared_ptr<Typeface>> typefaces_;
+  // 1 based index of `typefaces_`, only AddTypeface changes either of them.
+  std::unordered_map<const Typeface*, int32_t> indices_;
 };
 
 /**
@@ -32,13 +41,16 @@ struct SKITY_API TypefaceSet {
  * For ourself only needs to register the factory name.
  */
 struct SKITY_API FactorySet {
-  std::vector<std::string> factories;
-
   int32_t AddFactory(const std::string& factory);
 
   std::string GetFactoryName(int32_t index) const;
 
   size_t GetFactoryCount() const;
+
+ private:
+  std::vector<std::string> factories_;
+  // 1 based index of `factories_`, only AddFactory changes either of them.
+  std::unordered_map<std::string, int32_t> indices_;
 };
 
 struct SKITY_API SerialProc {
@@ -86,7 +98,7 @@ class SKITY_API Picture final {
 
  private:
   std::unique_ptr<RecordPlayback> playback_;
-  std::unique_ptr<MemoryWriter32> writer_ = {};
+  std::unique_ptr<MemoryWriter32> writer_;
 
   Rect cull_rect_;
 };
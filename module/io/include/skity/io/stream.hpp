@@ -13,6 +13,8 @@
 
 namespace skity {
 
+class Data;
+
 class SKITY_API WriteStream {
  public:
   WriteStream() = default;
@@ -73,6 +75,16 @@ class SKITY_API ReadStream {
 
   virtual bool IsAtEnd() const = 0;
 
+  /**
+   * Read size of `size` bytes from stream as a Data object.
+   * Streams backed by memory return a slice sharing the backing storage
+   * instead of copying it.
+   *
+   * @return the data read, empty if `size` is 0, or nullptr if less than
+   *         `size` bytes are left.
+   */
+  virtual std::shared_ptr<Data> ReadData(size_t size);
+
   bool ReadI8(int8_t* value);
   bool ReadI16(int16_t* value);
   bool ReadI32(int32_t* value);
@@ -109,6 +121,16 @@ class SKITY_API ReadStream {
   virtual bool Rewind() { return false; }
 
   static std::unique_ptr<ReadStream> CreateFromFile(const std::string& path);
+
+  /**
+   * Create a stream reading from the memory mapping of the file at `path`.
+   * Data read with `ReadData` points into the mapping, so large sections of
+   * the file are only paged in when they are accessed.
+   */
+  static std::unique_ptr<ReadStream> CreateFromFileMapping(
+      const std::string& path);
+
+  static std::unique_ptr<ReadStream> CreateFromData(std::shared_ptr<Data> data);
 };
 
 }  // namespace skity
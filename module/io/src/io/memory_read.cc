@@ -416,6 +416,21 @@ std::shared_ptr<Image> ReadBuffer::ReadImage() {
   return image;
 }
 
+void ReadBuffer::SkipImage() {
+  auto flags = ReadU32();
+
+  size_t size = 0;
+  (void)SkipByteArray(size);
+
+  if (flags & WriteBufferImageFlags::kHasSubsetRect) {
+    (void)Skip(sizeof(Rect));
+  }
+
+  if (flags & WriteBufferImageFlags::kHasMipmap) {
+    (void)SkipByteArray(size);
+  }
+}
+
 std::shared_ptr<Shader> ReadBuffer::ReadShader() {
   return ReadFlattenable<Shader>();
 }
@@ -446,11 +461,11 @@ std::shared_ptr<Typeface> ReadBuffer::ReadTypeface() {
   if (index == 0) {  // empty
     return {};
   } else if (index > 0) {
-    if (!Validate(index <= typeface_set_->typefaces.size())) {
+    if (!Validate(index <= typeface_set_->GetTypefaceCount())) {
       return {};
     }
 
-    return typeface_set_->typefaces[index - 1];
+    return typeface_set_->GetTypeface(index - 1);
   } else {  // custom
     // we do not support custom typeface
     // so just try to use our font engine parse the following data
@@ -107,6 +107,11 @@ class ReadBuffer {
 
   std::shared_ptr<Image> ReadImage();
 
+  /**
+   * Skip the next image without decoding its encoded data.
+   */
+  void SkipImage();
+
   std::shared_ptr<Shader> ReadShader();
   std::shared_ptr<MaskFilter> ReadMaskFilter();
   std::shared_ptr<PathEffect> ReadPathEffect();
@@ -21,9 +21,9 @@ std::shared_ptr<Typeface> TypefaceMakeFromStream(ReadStream& stream) {
     return {};
   }
 
-  auto data = Data::MakeFromMalloc(std::malloc(length), length);
+  auto data = stream.ReadData(length);
 
-  if (stream.Read(const_cast<void*>(data->RawData()), length) != length) {
+  if (!data) {
     return {};
   }
 
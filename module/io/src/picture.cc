@@ -73,6 +73,17 @@ bool parse_header(ReadStream& stream, PictureInfo& info) {
   return is_valid_picture(info);
 }
 
+// Image draws outside the clip are dropped before their image is decoded.
+// Filters may draw outside of dst, those draws are always kept.
+bool can_reject_image(Canvas* canvas, const Rect& dst, const Paint* paint) {
+  if (paint != nullptr && (paint->GetImageFilter() != nullptr ||
+                           paint->GetMaskFilter() != nullptr)) {
+    return false;
+  }
+
+  return canvas->QuickReject(dst);
+}
+
 float sigma_to_radius(float sigma) {
   return sigma > 0.5f ? (sigma - 0.5f) / 0.57735f : 0.0f;
 }
@@ -138,38 +149,48 @@ bool get_spot_shadow_transform(const Vec3& light_pos, float light_radius,
 }  // namespace
 
 int32_t TypefaceSet::AddTypeface(const std::shared_ptr<Typeface>& typeface) {
-  for (size_t i = 0; i < typefaces.size(); i++) {
-    if (typefaces[i] == typeface) {
-      return static_cast<int32_t>(i + 1);
-    }
+  auto it = indices_.find(typeface.get());
+  if (it != indices_.end()) {
+    return it->second;
   }
 
-  typefaces.emplace_back(typeface);
+  typefaces_.emplace_back(typeface);
+  indices_.emplace(typeface.get(), static_cast<int32_t>(typefaces_.size()));
 
-  return static_cast<int32_t>(typefaces.size());
+  return static_cast<int32_t>(typefaces_.size());
 }
 
+std::shared_ptr<Typeface> TypefaceSet::GetTypeface(int32_t index) const {
+  if (index < 0 || index >= typefaces_.size()) {
+    return {};
+  }
+
+  return typefaces_[index];
+}
+
+size_t TypefaceSet::GetTypefaceCount() const { return typefaces_.size(); }
+
 int32_t FactorySet::AddFactory(const std::string& factory) {
-  for (size_t i = 0; i < factories.size(); i++) {
-    if (factories[i] == factory) {
-      return static_cast<int32_t>(i + 1);
-    }
+  auto it = indices_.find(factory);
+  if (it != indices_.end()) {
+    return it->second;
   }
 
-  factories.emplace_back(factory);
+  factories_.emplace_back(factory);
+  indices_.emplace(factory, static_cast<int32_t>(factories_.size()));
 
-  return static_cast<int32_t>(factories.size());
+  return static_cast<int32_t>(factories_.size());
 }
 
 std::string FactorySet::GetFactoryName(int32_t index) const {
-  if (index < 0 || index >= factories.size()) {
+  if (index < 0 || index >= factories_.size()) {
     return {};
   }
 
-  return factories[index];
+  return factories_[index];
 }
 
-size_t FactorySet::GetFactoryCount() const { return factories.size(); }
+size_t FactorySet::GetFactoryCount() const { return factories_.size(); }
 
 Picture::Picture(std::unique_ptr<RecordPlayback> playback)
     : playback_(std::move(playback)), writer_(new MemoryWriter32) {}
@@ -492,7 +513,8 @@ void Picture::HandleOp(ReadBuffer& buffer, uint32_t type, size_t size,
 
     case DrawType::DRAW_ATLAS: {
       const auto* paint = playback_->OptionalPaint(buffer);
-      const std::shared_ptr<Image>& image = playback_->GetImage(buffer);
+      // atlas is not drawn, leave the image encoded
+      (void)playback_->ReadImageIndex(buffer);
 
       auto flags = buffer.ReadU32();
 
@@ -605,6 +627,10 @@ void Picture::HandleOp(ReadBuffer& buffer, uint32_t type, size_t size,
 
       BREAK_IF_ERROR(buffer);
 
+      if (!image) {
+        break;
+      }
+
       canvas->DrawImage(image, loc.x, loc.y, sampling, paint);
     } break;
 
@@ -626,7 +652,7 @@ void Picture::HandleOp(ReadBuffer& buffer, uint32_t type, size_t size,
 
       const auto* paint = playback_->OptionalPaint(buffer);
 
-      auto image = playback_->GetImage(buffer);
+      auto image_index = playback_->ReadImageIndex(buffer);
 
       auto center = buffer.ReadRect();
       auto dst = buffer.ReadRect();
@@ -634,6 +660,16 @@ void Picture::HandleOp(ReadBuffer& buffer, uint32_t type, size_t size,
       buffer.Validate(center.has_value() && dst.has_value());
       BREAK_IF_ERROR(buffer);
 
+      if (can_reject_image(canvas, dst.value(), paint)) {
+        break;
+      }
+
+      const auto& image = playback_->GetImage(image_index);
+
+      if (!image) {
+        break;
+      }
+
       canvas->DrawImageRect(image, center.value(), dst.value(),
                             SamplingOptions{}, paint);
     } break;
@@ -641,7 +677,7 @@ void Picture::HandleOp(ReadBuffer& buffer, uint32_t type, size_t size,
     case DrawType::DRAW_IMAGE_RECT: {
       const auto* paint = playback_->OptionalPaint(buffer);
 
-      auto image = playback_->GetImage(buffer);
+      auto image_index = playback_->ReadImageIndex(buffer);
 
       Rect storage;
 
@@ -668,6 +704,16 @@ void Picture::HandleOp(ReadBuffer& buffer, uint32_t type, size_t size,
 
       BREAK_IF_ERROR(buffer);
 
+      if (can_reject_image(canvas, dst.value(), paint)) {
+        break;
+      }
+
+      const auto& image = playback_->GetImage(image_index);
+
+      if (!image) {
+        break;
+      }
+
       canvas->DrawImageRect(
           image,
           src != nullptr ? *src : Rect::MakeWH(image->Width(), image->Height()),
@@ -677,7 +723,7 @@ void Picture::HandleOp(ReadBuffer& buffer, uint32_t type, size_t size,
     case DrawType::DRAW_IMAGE_RECT2: {
       const auto* paint = playback_->OptionalPaint(buffer);
 
-      auto image = playback_->GetImage(buffer);
+      auto image_index = playback_->ReadImageIndex(buffer);
 
       auto src = buffer.ReadRect();
       auto dst = buffer.ReadRect();
@@ -692,6 +738,16 @@ void Picture::HandleOp(ReadBuffer& buffer, uint32_t type, size_t size,
       // skip the constraint
       (void)buffer.ReadU32();
 
+      if (can_reject_image(canvas, dst.value(), paint)) {
+        break;
+      }
+
+      const auto& image = playback_->GetImage(image_index);
+
+      if (!image) {
+        break;
+      }
+
       canvas->DrawImageRect(image, src.value(), dst.value(), sampling, paint);
     } break;
 
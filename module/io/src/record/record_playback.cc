@@ -4,8 +4,10 @@
 
 #include "src/record/record_playback.hpp"
 
+#include <algorithm>
 #include <cstdlib>
 #include <iostream>
+#include <limits>
 #include <skity/io/picture.hpp>
 
 #include "src/io/flat/font_desc_flat.hpp"
@@ -19,6 +21,8 @@ namespace {
 
 static constexpr int32_t kUInt32Size = 4;
 
+static constexpr size_t kImageDecoded = std::numeric_limits<size_t>::max();
+
 void write_tag_size(WriteStream& stream, uint32_t tag, size_t size) {
   stream.WriteU32(tag);
   stream.WriteU32(static_cast<uint32_t>(size));
@@ -32,8 +36,8 @@ void write_tag_size(BinaryWriteBuffer& buffer, uint32_t tag, size_t size) {
 size_t compute_chunk_size(const FactorySet& factory_set) {
   size_t size = 4;
 
-  for (size_t i = 0; i < factory_set.factories.size(); i++) {
-    const auto& factory = factory_set.factories[i];
+  for (size_t i = 0; i < factory_set.GetFactoryCount(); i++) {
+    auto factory = factory_set.GetFactoryName(static_cast<int32_t>(i));
 
     if (factory.empty()) {
       size += WriteStream::PackedUintSize(0);
@@ -47,17 +51,116 @@ size_t compute_chunk_size(const FactorySet& factory_set) {
   return size;
 }
 
+// FNV-1a, only used to bucket resources. Equality is always checked on the
+// resource itself.
+size_t hash_bytes(const void* data, size_t size, size_t hash) {
+  auto bytes = static_cast<const uint8_t*>(data);
+  for (size_t i = 0; i < size; i++) {
+    hash = (hash ^ bytes[i]) * 1099511628211ull;
+  }
+
+  return hash;
+}
+
 template <typename T>
-int32_t find_or_append(std::vector<T>& array, const T& value) {
-  for (size_t i = 0; i < array.size(); i++) {
-    if (array[i] == value) {
-      return static_cast<int32_t>(i);
-    }
+size_t hash_value(const T& value, size_t hash) {
+  return hash_bytes(&value, sizeof(T), hash);
+}
+
+constexpr size_t kHashSeed = 14695981039346656037ull;
+
+// Covers the fields written by FlatIntoMemory<Paint>, all of them are compared
+// by Paint::operator== as well.
+size_t hash_paint(const Paint& paint) {
+  size_t hash = kHashSeed;
+  hash = hash_value(paint.GetStrokeWidth(), hash);
+  hash = hash_value(paint.GetStrokeMiter(), hash);
+  hash = hash_value(paint.GetColor4f(), hash);
+  hash = hash_value(paint.IsAntiAlias(), hash);
+  hash = hash_value(paint.GetBlendMode(), hash);
+  hash = hash_value(paint.GetStrokeCap(), hash);
+  hash = hash_value(paint.GetStrokeJoin(), hash);
+  hash = hash_value(paint.GetStyle(), hash);
+  hash = hash_value(paint.GetPathEffect().get(), hash);
+  hash = hash_value(paint.GetShader().get(), hash);
+  hash = hash_value(paint.GetMaskFilter().get(), hash);
+  hash = hash_value(paint.GetColorFilter().get(), hash);
+  hash = hash_value(paint.GetImageFilter().get(), hash);
+  return hash;
+}
+
+size_t count_conic_weights(const Path& path) {
+  return std::count(path.VerbsBegin(), path.VerbsEnd(), Path::Verb::kConic);
+}
+
+size_t hash_path(const Path& path) {
+  size_t hash = kHashSeed;
+  hash = hash_value(path.GetFillType(), hash);
+  hash = hash_bytes(path.VerbsBegin(), sizeof(Path::Verb) * path.CountVerbs(),
+                    hash);
+  hash = hash_bytes(path.Points(), sizeof(Point) * path.CountPoints(), hash);
+  return hash;
+}
+
+bool same_path(const Path& a, const Path& b) {
+  if (a.GetFillType() != b.GetFillType() ||
+      a.GetIsAType() != b.GetIsAType() ||
+      a.GetFirstDirection() != b.GetFirstDirection() ||
+      a.CountVerbs() != b.CountVerbs() || a.CountPoints() != b.CountPoints()) {
+    return false;
   }
 
-  array.emplace_back(value);
+  if (!std::equal(a.VerbsBegin(), a.VerbsEnd(), b.VerbsBegin()) ||
+      !std::equal(a.Points(), a.Points() + a.CountPoints(), b.Points())) {
+    return false;
+  }
 
-  return static_cast<int32_t>(array.size() - 1);
+  auto weight_count = count_conic_weights(a);
+  return std::equal(a.ConicWeights(), a.ConicWeights() + weight_count,
+                    b.ConicWeights());
+}
+
+size_t hash_text_blob(const TextBlob& blob) {
+  size_t hash = kHashSeed;
+  for (const auto& run : blob.GetTextRun()) {
+    const auto& glyphs = run.GetGlyphInfo();
+    hash = hash_value(run.GetFont().GetTypeface().get(), hash);
+    hash = hash_value(run.GetFontSize(), hash);
+    hash = hash_bytes(glyphs.data(), sizeof(GlyphID) * glyphs.size(), hash);
+    hash = hash_bytes(run.GetPosX().data(),
+                      sizeof(float) * run.GetPosX().size(), hash);
+    hash = hash_bytes(run.GetPosY().data(),
+                      sizeof(float) * run.GetPosY().size(), hash);
+  }
+
+  return hash;
+}
+
+// Compares everything FlatIntoMemory<TextBlob> writes, the bounds are derived
+// from the runs.
+bool same_text_blob(const TextBlob& a, const TextBlob& b) {
+  const auto& runs_a = a.GetTextRun();
+  const auto& runs_b = b.GetTextRun();
+  if (runs_a.size() != runs_b.size()) {
+    return false;
+  }
+
+  for (size_t i = 0; i < runs_a.size(); i++) {
+    const auto& font_a = runs_a[i].GetFont();
+    const auto& font_b = runs_b[i].GetFont();
+    if (font_a.GetTypeface() != font_b.GetTypeface() ||
+        font_a.GetSize() != font_b.GetSize() ||
+        font_a.GetScaleX() != font_b.GetScaleX() ||
+        font_a.GetSkewX() != font_b.GetSkewX() ||
+        font_a.GetHinting() != font_b.GetHinting() ||
+        runs_a[i].GetGlyphInfo() != runs_b[i].GetGlyphInfo() ||
+        runs_a[i].GetPosX() != runs_b[i].GetPosX() ||
+        runs_a[i].GetPosY() != runs_b[i].GetPosY()) {
+      return false;
+    }
+  }
+
+  return true;
 }
 
 template <typename T, typename Proc>
@@ -264,10 +367,8 @@ void RecordPlayback::OnDrawBlob(const TextBlob* blob, float x, float y,
 
   auto offset = AddDraw(DrawType::DRAW_TEXT_BLOB, size);
 
-  auto copyed_blob = std::make_shared<TextBlob>(blob->GetTextRun());
-
   AddPaint(paint);
-  AddTextBlob(copyed_blob);
+  AddTextBlob(blob);
   AddFloat(x);
   AddFloat(y);
 
@@ -483,7 +584,7 @@ void RecordPlayback::FlattenToBuffer(BinaryWriteBuffer& buffer) {
 
 void RecordPlayback::WriteFactories(WriteStream& stream,
                                     const FactorySet& factory_set) {
-  int32_t count = static_cast<int32_t>(factory_set.factories.size());
+  int32_t count = static_cast<int32_t>(factory_set.GetFactoryCount());
 
   auto size = compute_chunk_size(factory_set);
 
@@ -494,7 +595,7 @@ void RecordPlayback::WriteFactories(WriteStream& stream,
   stream.WriteU32(count);
 
   for (int32_t i = 0; i < count; i++) {
-    const auto& name = factory_set.factories[i];
+    auto name = factory_set.GetFactoryName(i);
 
     if (name.empty()) {
       stream.WritePackedUint(0);
@@ -515,12 +616,12 @@ void RecordPlayback::WriteFactories(WriteStream& stream,
 
 void RecordPlayback::WriteTypefaces(WriteStream& stream,
                                     const TypefaceSet& typeface_set) {
-  auto count = static_cast<int32_t>(typeface_set.typefaces.size());
+  auto count = static_cast<int32_t>(typeface_set.GetTypefaceCount());
 
   write_tag_size(stream, SK_PICT_TYPEFACE_TAG, count);
 
   for (int32_t i = 0; i < count; i++) {
-    const auto& typeface = typeface_set.typefaces[i];
+    auto typeface = typeface_set.GetTypeface(i);
 
     auto desc = typeface->GetFontDescriptor();
 
@@ -591,35 +692,68 @@ void RecordPlayback::AddMatrix(const Matrix& matrix) {
 void RecordPlayback::AddRect(const Rect& rect) { writer32_.WriteRect(rect); }
 
 void RecordPlayback::AddPaintPtr(const Paint* paint) {
-  if (paint) {
-    paints_.push_back(*paint);
-    AddInt(paints_.size());
-  } else {
+  if (paint == nullptr) {
     AddInt(0);
+    return;
   }
+
+  // 1 based paint index
+  auto hash = hash_paint(*paint);
+  auto index = paint_index_.Find(
+      hash, [&](int32_t i) { return paints_[i] == *paint; });
+
+  if (index < 0) {
+    index = static_cast<int32_t>(paints_.size());
+    paints_.push_back(*paint);
+    paint_index_.Insert(hash, index);
+  }
+
+  AddInt(index + 1);
 }
 
 int32_t RecordPlayback::AddPath(const Path& path) {
-  // we do not try to find existing path
-
-  int32_t n = paths_.size() + 1;
+  // 1 based path index
+  auto hash = hash_path(path);
+  auto index = path_index_.Find(
+      hash, [&](int32_t i) { return same_path(paths_[i], path); });
+
+  if (index < 0) {
+    index = static_cast<int32_t>(paths_.size());
+    paths_.emplace_back(path);
+    path_index_.Insert(hash, index);
+  }
 
-  paths_.emplace_back(path);
-  return n;
+  return index + 1;
 }
 
 void RecordPlayback::AddImage(const std::shared_ptr<Image>& image) {
-  // 1 based image index
-  auto index = find_or_append(images_, image);
+  // 0 based image index, images are shared so the pointer identifies them
+  auto it = image_index_.find(image.get());
+
+  if (it == image_index_.end()) {
+    it = image_index_
+             .emplace(image.get(), static_cast<int32_t>(images_.size()))
+             .first;
+    images_.emplace_back(image);
+  }
 
-  AddInt(index);
+  AddInt(it->second);
 }
 
-void RecordPlayback::AddTextBlob(const std::shared_ptr<TextBlob>& blob) {
+void RecordPlayback::AddTextBlob(const TextBlob* blob) {
   // 1 based blob index
-  auto index = find_or_append(text_blobs_, blob) + 1;
+  auto hash = hash_text_blob(*blob);
+  auto index = text_blob_index_.Find(
+      hash, [&](int32_t i) { return same_text_blob(*text_blobs_[i], *blob); });
+
+  if (index < 0) {
+    // The recorded blob is not owned by us, keep a copy of its runs.
+    index = static_cast<int32_t>(text_blobs_.size());
+    text_blobs_.emplace_back(std::make_shared<TextBlob>(blob->GetTextRun()));
+    text_blob_index_.Insert(hash, index);
+  }
 
-  AddInt(index);
+  AddInt(index + 1);
 }
 
 void RecordPlayback::Validate(size_t offset, size_t size) const {
@@ -642,12 +776,9 @@ bool RecordPlayback::ParseStreamTag(ReadStream& stream, uint32_t tag,
         return false;
       }
 
-      op_data_ = Data::MakeFromMalloc(std::malloc(size), size);
+      op_data_ = stream.ReadData(size);
 
-      auto ptr = op_data_->RawData();
-
-      if (!stream.Read(const_cast<void*>(ptr), size)) {
-        op_data_ = nullptr;
+      if (!op_data_) {
         return false;
       }
     } break;
@@ -708,14 +839,13 @@ bool RecordPlayback::ParseStreamTag(ReadStream& stream, uint32_t tag,
     } break;
 
     case SK_PICT_BUFFER_SIZE_TAG: {
-      auto buffer_data = Data::MakeFromMalloc(std::malloc(size), size);
+      buffer_data_ = stream.ReadData(size);
 
-      if (stream.Read(const_cast<void*>(buffer_data->RawData()), size) !=
-          size) {
+      if (!buffer_data_) {
         return false;
       }
 
-      ReadBuffer read_buffer(buffer_data->RawData(), size);
+      ReadBuffer read_buffer(buffer_data_->RawData(), size);
 
       read_buffer.SetVersion(target_version_);
 
@@ -786,9 +916,26 @@ bool RecordPlayback::ParseBufferTag(ReadBuffer& read_buffer, uint32_t tag,
       skip_array_from_buffer<Vertices>(read_buffer, size);
     } break;
     case SK_PICT_IMAGE_BUFFER_TAG: {
-      parse_array_from_buffer(
-          read_buffer, size, images_,
-          [](ReadBuffer& buffer) { return buffer.ReadImage(); });
+      if (!buffer_data_) {
+        parse_array_from_buffer(
+            read_buffer, size, images_,
+            [](ReadBuffer& buffer) { return buffer.ReadImage(); });
+        break;
+      }
+
+      // Only remember where the encoded images are, they are decoded the
+      // first time a draw which is not rejected uses them.
+      for (uint32_t i = 0; i < size; i++) {
+        image_offsets_.emplace_back(read_buffer.GetOffset());
+        read_buffer.SkipImage();
+
+        if (!read_buffer.IsValid()) {
+          image_offsets_.clear();
+          return false;
+        }
+      }
+
+      images_.resize(image_offsets_.size());
     } break;
     case SK_PICT_READER_TAG: {
       if (!read_buffer.ValidateCanReadN<uint8_t>(size)) {
@@ -875,14 +1022,32 @@ const Paint* RecordPlayback::OptionalPaint(ReadBuffer& buffer) const {
              : nullptr;
 }
 
-const std::shared_ptr<Image>& RecordPlayback::GetImage(
-    ReadBuffer& buffer) const {
+int32_t RecordPlayback::ReadImageIndex(ReadBuffer& buffer) const {
+  auto index = buffer.ReadInt();
+
+  return buffer.Validate(index >= 0 && index < images_.size()) ? index : -1;
+}
+
+const std::shared_ptr<Image>& RecordPlayback::GetImage(int32_t index) const {
   static std::shared_ptr<Image> kEmptyImage = {};
 
-  auto index = buffer.ReadInt();
+  if (index < 0 || index >= images_.size()) {
+    return kEmptyImage;
+  }
+
+  if (index < image_offsets_.size() && image_offsets_[index] != kImageDecoded) {
+    auto offset = image_offsets_[index];
+
+    ReadBuffer buffer(buffer_data_->Bytes() + offset,
+                      buffer_data_->Size() - offset);
+    buffer.SetVersion(target_version_);
+
+    // A broken image only drops the draws using it.
+    images_[index] = buffer.ReadImage();
+    image_offsets_[index] = kImageDecoded;
+  }
 
-  return buffer.Validate(index >= 0 && index < images_.size()) ? images_[index]
-                                                               : kEmptyImage;
+  return images_[index];
 }
 
 const std::shared_ptr<TextBlob>& RecordPlayback::GetTextBlob(
@@ -9,6 +9,7 @@
 #include <skity/io/picture.hpp>
 #include <skity/io/stream.hpp>
 #include <skity/render/canvas.hpp>
+#include <unordered_map>
 #include <vector>
 
 #include "src/io/memory_writer.hpp"
@@ -27,6 +28,31 @@ struct Vertices;
 
 class ReadBuffer;
 
+/**
+ * Hash index over one resource array of a recording. Entries map the content
+ * hash of a resource to its position in the array, so a resource which is
+ * recorded again is found without scanning the whole array.
+ */
+class ResourceIndex {
+ public:
+  template <typename Equal>
+  int32_t Find(size_t hash, Equal&& equal) const {
+    auto range = indices_.equal_range(hash);
+    for (auto it = range.first; it != range.second; ++it) {
+      if (equal(it->second)) {
+        return it->second;
+      }
+    }
+
+    return -1;
+  }
+
+  void Insert(size_t hash, int32_t index) { indices_.emplace(hash, index); }
+
+ private:
+  std::unordered_multimap<size_t, int32_t> indices_;
+};
+
 class RecordPlayback : public Canvas {
  public:
   RecordPlayback(uint32_t width, uint32_t height);
@@ -54,7 +80,21 @@ class RecordPlayback : public Canvas {
   const Paint& RequiredPaint(ReadBuffer& buffer) const;
   const Paint* OptionalPaint(ReadBuffer& buffer) const;
 
-  const std::shared_ptr<Image>& GetImage(ReadBuffer& buffer) const;
+  const std::shared_ptr<Image>& GetImage(ReadBuffer& buffer) const {
+    return GetImage(ReadImageIndex(buffer));
+  }
+
+  /**
+   * Reads an image index from the op buffer without decoding the image, so
+   * draws which end up outside the clip never decode it.
+   */
+  int32_t ReadImageIndex(ReadBuffer& buffer) const;
+
+  /**
+   * Returns the image at `index`, decoding it from the picture buffer on first
+   * access. Not thread safe, like the rest of the playback.
+   */
+  const std::shared_ptr<Image>& GetImage(int32_t index) const;
   const std::shared_ptr<TextBlob>& GetTextBlob(ReadBuffer& buffer) const;
 
  protected:
@@ -113,7 +153,7 @@ class RecordPlayback : public Canvas {
 
   void AddImage(const std::shared_ptr<Image>& image);
 
-  void AddTextBlob(const std::shared_ptr<TextBlob>& blob);
+  void AddTextBlob(const TextBlob* blob);
 
   void Validate(size_t offset, size_t size) const;
 
@@ -133,14 +173,28 @@ class RecordPlayback : public Canvas {
 
   std::vector<Paint> paints_ = {};
   std::vector<Path> paths_ = {};
-  std::vector<std::shared_ptr<Image>> images_;
+  // Images parsed from a stream stay encoded until they are drawn, the empty
+  // slots are filled by GetImage.
+  mutable std::vector<std::shared_ptr<Image>> images_;
   std::vector<std::shared_ptr<TextBlob>> text_blobs_;
 
+  // Recording side indices, resources with the same content are written once.
+  ResourceIndex paint_index_ = {};
+  ResourceIndex path_index_ = {};
+  ResourceIndex text_blob_index_ = {};
+  std::unordered_map<const Image*, int32_t> image_index_ = {};
+
   // deserialize data
   int32_t target_version_ = 0;
   TypefaceSet playback_typeface_set_ = {};
   FactorySet playback_factory_set_ = {};
   std::shared_ptr<Data> op_data_ = nullptr;
+  // Buffer section of the stream, kept for decoding images lazily. For mapped
+  // files this is a slice of the mapping.
+  std::shared_ptr<Data> buffer_data_ = nullptr;
+  // Offset of every encoded image in buffer_data_, kImageDecoded once the
+  // image has been decoded.
+  mutable std::vector<size_t> image_offsets_ = {};
 
   std::vector<std::unique_ptr<Picture>> sub_pictures_ = {};
 };
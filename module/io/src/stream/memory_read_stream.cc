@@ -0,0 +1,69 @@
+// Copyright 2021 The Lynx Authors. All rights reserved.
+// Licensed under the Apache License Version 2.0 that can be found in the
+// LICENSE file in the root directory of this source tree.
+
+#include "src/stream/memory_read_stream.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+namespace skity {
+
+namespace {
+
+void release_slice(const void*, void* context) {
+  delete static_cast<std::shared_ptr<Data>*>(context);
+}
+
+}  // namespace
+
+MemoryReadStream::MemoryReadStream(std::shared_ptr<Data> data)
+    : data_(std::move(data)) {}
+
+size_t MemoryReadStream::Read(void* buffer, size_t size) {
+  size = Peek(buffer, size);
+
+  offset_ += size;
+
+  return size;
+}
+
+size_t MemoryReadStream::Peek(void* buffer, size_t size) {
+  size = std::min(size, data_->Size() - offset_);
+
+  if (buffer != nullptr && size > 0) {
+    std::memcpy(buffer, data_->Bytes() + offset_, size);
+  }
+
+  return size;
+}
+
+bool MemoryReadStream::IsAtEnd() const { return offset_ >= data_->Size(); }
+
+std::shared_ptr<Data> MemoryReadStream::ReadData(size_t size) {
+  if (data_->Size() - offset_ < size) {
+    return {};
+  }
+
+  // An empty section, e.g. the buffer of a picture without flattenables.
+  if (size == 0) {
+    return Data::MakeEmpty();
+  }
+
+  // The slice owns a reference to the whole mapping.
+  auto slice = Data::MakeWithProc(data_->Bytes() + offset_, size,
+                                  release_slice,
+                                  new std::shared_ptr<Data>(data_));
+
+  offset_ += size;
+
+  return slice;
+}
+
+bool MemoryReadStream::Rewind() {
+  offset_ = 0;
+
+  return true;
+}
+
+}  // namespace skity
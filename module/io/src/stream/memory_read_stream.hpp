@@ -0,0 +1,39 @@
+// Copyright 2021 The Lynx Authors. All rights reserved.
+// Licensed under the Apache License Version 2.0 that can be found in the
+// LICENSE file in the root directory of this source tree.
+
+#ifndef MODULE_IO_SRC_STREAM_MEMORY_READ_STREAM_HPP
+#define MODULE_IO_SRC_STREAM_MEMORY_READ_STREAM_HPP
+
+#include <skity/io/data.hpp>
+#include <skity/io/stream.hpp>
+
+namespace skity {
+
+/**
+ * Read stream over a Data object, usually a memory mapped file. `ReadData`
+ * returns slices which keep the backing Data alive instead of copies.
+ */
+class MemoryReadStream : public ReadStream {
+ public:
+  explicit MemoryReadStream(std::shared_ptr<Data> data);
+
+  ~MemoryReadStream() override = default;
+
+  size_t Read(void* buffer, size_t size) override;
+  size_t Peek(void* buffer, size_t size) override;
+
+  bool IsAtEnd() const override;
+
+  std::shared_ptr<Data> ReadData(size_t size) override;
+
+  bool Rewind() override;
+
+ private:
+  std::shared_ptr<Data> data_;
+  size_t offset_ = 0;
+};
+
+}  // namespace skity
+
+#endif  // MODULE_IO_SRC_STREAM_MEMORY_READ_STREAM_HPP
@@ -3,11 +3,14 @@
 // LICENSE file in the root directory of this source tree.
 
 #include <array>
+#include <cstdlib>
 #include <cstring>
+#include <skity/io/data.hpp>
 #include <skity/io/stream.hpp>
 
 #include "src/stream/file_read_stream.hpp"
 #include "src/stream/file_write_stream.hpp"
+#include "src/stream/memory_read_stream.hpp"
 
 namespace skity {
 
@@ -87,6 +90,20 @@ std::unique_ptr<WriteStream> WriteStream::CreateFileStream(
   return std::make_unique<FileWriteStream>(fs_path, std::move(file_stream));
 }
 
+std::shared_ptr<Data> ReadStream::ReadData(size_t size) {
+  if (size == 0) {
+    return Data::MakeEmpty();
+  }
+
+  auto data = Data::MakeFromMalloc(std::malloc(size), size);
+
+  if (Read(const_cast<void*>(data->RawData()), size) != size) {
+    return {};
+  }
+
+  return data;
+}
+
 bool ReadStream::ReadI8(int8_t* value) {
   return this->Read(value, sizeof(int8_t)) == sizeof(int8_t);
 }
@@ -151,4 +168,24 @@ std::unique_ptr<ReadStream> ReadStream::CreateFromFile(
                                           std::move(file_stream));
 }
 
+std::unique_ptr<ReadStream> ReadStream::CreateFromFileMapping(
+    const std::string& path) {
+  auto data = Data::MakeFromFileMapping(path.c_str());
+
+  if (!data) {
+    return {};
+  }
+
+  return CreateFromData(std::move(data));
+}
+
+std::unique_ptr<ReadStream> ReadStream::CreateFromData(
+    std::shared_ptr<Data> data) {
+  if (!data) {
+    return {};
+  }
+
+  return std::make_unique<MemoryReadStream>(std::move(data));
+}
+
 }  // namespace skity
@@ -13,6 +13,7 @@
 
 #include <cstddef>
 #include <cstdint>
+#include <functional>
 #include <string>
 #include <type_traits>
 
@@ -27,6 +28,15 @@ namespace skity {
  */
 uint32_t Hash32(const void* data, size_t bytes, uint32_t seed = 0);
 
+/**
+ * Mixes the std::hash of `value` into `seed`, for hashing keys made of several
+ * fields.
+ */
+template <typename T>
+void HashCombine(size_t* seed, const T& value) {
+  *seed ^= std::hash<T>{}(value) + 0x9e3779b9 + (*seed << 6) + (*seed >> 2);
+}
+
 }  // namespace skity
 
 #endif  // SRC_BASE_HASH_HPP
@@ -6,8 +6,12 @@
 #define SRC_BASE_LRU_CACHE_HPP
 
 #include <cstddef>
+#include <functional>
 #include <list>
+#include <mutex>
 #include <unordered_map>
+#include <utility>
+#include <vector>
 
 #include "src/logging.hpp"
 
@@ -99,6 +103,176 @@ class LRUCache {
   LRUCache& operator=(const LRUCache&) = delete;
 };
 
+/**
+ * Lock for a SizedLRUCache used from a single thread.
+ */
+struct NullMutex {
+  void lock() {}
+  void unlock() {}
+};
+
+/**
+ * LRU cache bounded by the total size of its values instead of their count.
+ * `size_of` reports the size of a value in the unit of the budget, bytes for
+ * most caches, 1 to bound the entry count. Inserting evicts the least recently
+ * used entries until the total fits the budget again, but the most recent
+ * entry is kept even if it alone is over budget, since the caller is about to
+ * use it.
+ *
+ * Every method holds `Mutex`, std::mutex makes the cache safe to share between
+ * threads. Evicted values are released after the lock is dropped, so their
+ * destructors may call back into the cache.
+ *
+ * `V` is returned by value and must be cheap to copy and testable as bool,
+ * e.g. a std::shared_ptr. An empty value means "not cached".
+ */
+template <typename K, typename V, typename Hash = std::hash<K>,
+          typename Mutex = std::mutex>
+class SizedLRUCache {
+ public:
+  using SizeFunc = std::function<size_t(const V&)>;
+
+  SizedLRUCache(size_t max_size, SizeFunc size_of)
+      : max_size_(max_size), size_of_(std::move(size_of)) {}
+
+  /**
+   * Returns the value of `key` and marks it most recently used, or an empty
+   * value on a miss.
+   */
+  V Find(const K& key) {
+    std::lock_guard<Mutex> lock(mutex_);
+    return FindLocked(key);
+  }
+
+  /**
+   * Returns the value of `key`, calling `create()` on a miss. `create` runs
+   * outside the lock so slow builds do not block other keys. Threads racing on
+   * the same key may both create a value, the one inserted first is returned
+   * to both. Empty values are returned but not cached. `hit`, if not null,
+   * tells whether the value was already cached.
+   */
+  template <typename Create>
+  V FindOrCreate(const K& key, Create&& create, bool* hit = nullptr) {
+    {
+      std::lock_guard<Mutex> lock(mutex_);
+      if (V value = FindLocked(key)) {
+        if (hit) {
+          *hit = true;
+        }
+        return value;
+      }
+    }
+
+    if (hit) {
+      *hit = false;
+    }
+
+    V value = create();
+    if (!value) {
+      return value;
+    }
+    return Insert(key, std::move(value));
+  }
+
+  /**
+   * Caches `value` for `key` unless `key` is already cached. Returns the
+   * cached value either way.
+   */
+  V Insert(const K& key, V value) {
+    std::vector<V> evicted;
+    std::lock_guard<Mutex> lock(mutex_);
+    if (V cached = FindLocked(key)) {
+      return cached;
+    }
+
+    size_t size = size_of_(value);
+    lru_.push_front(Entry{key, std::move(value), size});
+    entries_.emplace(key, lru_.begin());
+    total_size_ += size;
+    PurgeLocked(&evicted);
+    return lru_.front().value;
+  }
+
+  void Remove(const K& key) {
+    V removed;
+    std::lock_guard<Mutex> lock(mutex_);
+    auto it = entries_.find(key);
+    if (it == entries_.end()) {
+      return;
+    }
+
+    removed = std::move(it->second->value);
+    total_size_ -= it->second->size;
+    lru_.erase(it->second);
+    entries_.erase(it);
+  }
+
+  /**
+   * Total size of the cached values, in the unit of the budget.
+   */
+  size_t GetTotalSize() const {
+    std::lock_guard<Mutex> lock(mutex_);
+    return total_size_;
+  }
+
+  size_t GetEntryCount() const {
+    std::lock_guard<Mutex> lock(mutex_);
+    return lru_.size();
+  }
+
+  void SetMaxSize(size_t max_size) {
+    std::vector<V> evicted;
+    std::lock_guard<Mutex> lock(mutex_);
+    max_size_ = max_size;
+    PurgeLocked(&evicted);
+  }
+
+  void Clear() {
+    std::list<Entry> cleared;
+    std::lock_guard<Mutex> lock(mutex_);
+    entries_.clear();
+    cleared.swap(lru_);
+    total_size_ = 0;
+  }
+
+ private:
+  struct Entry {
+    K key;
+    V value;
+    size_t size;
+  };
+
+  V FindLocked(const K& key) {
+    auto it = entries_.find(key);
+    if (it == entries_.end()) {
+      return V{};
+    }
+    lru_.splice(lru_.begin(), lru_, it->second);
+    return it->second->value;
+  }
+
+  void PurgeLocked(std::vector<V>* evicted) {
+    while (total_size_ > max_size_ && lru_.size() > 1) {
+      auto& entry = lru_.back();
+      total_size_ -= entry.size;
+      evicted->emplace_back(std::move(entry.value));
+      entries_.erase(entry.key);
+      lru_.pop_back();
+    }
+  }
+
+  mutable Mutex mutex_ = {};
+  std::list<Entry> lru_ = {};
+  std::unordered_map<K, typename std::list<Entry>::iterator, Hash> entries_ =
+      {};
+  size_t total_size_ = 0;
+  size_t max_size_;
+  SizeFunc size_of_;
+
+  SizedLRUCache(const SizedLRUCache&) = delete;
+  SizedLRUCache& operator=(const SizedLRUCache&) = delete;
+};
+
 }  // namespace skity
 
 #endif  // SRC_BASE_LRU_CACHE_HPP
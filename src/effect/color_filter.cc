@@ -165,11 +165,14 @@ static constexpr uint8_t srgb_to_linear_table[256] = {
     222, 224, 226, 228, 230, 232, 235, 237, 239, 241, 243, 245, 248, 250, 252,
     255};
 
+const uint8_t* GetSRGBGammaTable(ColorFilterType type) {
+  return type == ColorFilterType::kLinearToSRGBGamma ? linear_to_srgb_table
+                                                     : srgb_to_linear_table;
+}
+
 PMColor SRGBGammaColorFilter::OnFilterColor(PMColor src_pm) const {
   Color src = PMColorToColor(src_pm);
-  auto* table = type_ == ColorFilterType::kLinearToSRGBGamma
-                    ? linear_to_srgb_table
-                    : srgb_to_linear_table;
+  auto* table = GetSRGBGammaTable(type_);
   return ColorToPMColor(ColorSetARGB(ColorGetA(src), table[ColorGetR(src)],
                                      table[ColorGetG(src)],
                                      table[ColorGetB(src)]));
@@ -180,7 +183,9 @@ PMColor BlendColorFilter::OnFilterColor(PMColor src) const {
 }
 
 PMColor ComposeColorFilter::OnFilterColor(PMColor src) const {
-  // TODO(zhangzhijian): Fix it.
+  for (const auto* filter : filters_) {
+    src = As_CFB(filter)->OnFilterColor(src);
+  }
   return src;
 }
 
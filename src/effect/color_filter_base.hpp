@@ -52,6 +52,14 @@ static inline const ColorFilterBase* As_CFB(const ColorFilter* filter) {
 
 bool operator==(const ColorFilterBase& a, const ColorFilterBase& b);
 
+#ifdef SKITY_CPU
+/**
+ * 8-bit lookup table of the sRGB transfer function for kLinearToSRGBGamma or
+ * kSRGBToLinearGamma.
+ */
+const uint8_t* GetSRGBGammaTable(ColorFilterType type);
+#endif
+
 class BlendColorFilter : public ColorFilterBase {
  public:
 #ifdef SKITY_CPU
@@ -109,6 +117,8 @@ class MatrixColorFilter : public ColorFilterBase {
     return std::make_tuple(matrix_mul, matrix_add);
   }
 
+  const float* GetRowMajor() const { return matrix_; }
+
   ColorFilterType GetType() const override { return ColorFilterType::kMatrix; }
 
   bool IsAlphaUnchanged() const override {
@@ -0,0 +1,236 @@
+// Copyright 2021 The Lynx Authors. All rights reserved.
+// Licensed under the Apache License Version 2.0 that can be found in the
+// LICENSE file in the root directory of this source tree.
+
+#include "src/effect/color_filter_program.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+#include "src/effect/color_filter_base.hpp"
+
+#ifdef SKITY_CPU
+#include "src/graphic/blend_mode_priv.hpp"
+#include "src/graphic/color_priv.hpp"
+#endif
+
+namespace skity {
+
+namespace {
+
+constexpr float kIdentityMatrix[20] = {
+    1.f, 0.f, 0.f, 0.f, 0.f,  //
+    0.f, 1.f, 0.f, 0.f, 0.f,  //
+    0.f, 0.f, 1.f, 0.f, 0.f,  //
+    0.f, 0.f, 0.f, 1.f, 0.f,  //
+};
+
+// Whether every channel `matrix` produces from inputs in [0, 1] stays in
+// [0, 1], so clamping between it and a following matrix is a no-op.
+bool IsOutputInUnitRange(const float matrix[20]) {
+  for (int32_t row = 0; row < 4; row++) {
+    const float* m = matrix + row * 5;
+    float lo = m[4];
+    float hi = m[4];
+    for (int32_t col = 0; col < 4; col++) {
+      lo += std::min(m[col], 0.f);
+      hi += std::max(m[col], 0.f);
+    }
+
+    if (lo < 0.f || hi > 1.f) {
+      return false;
+    }
+  }
+
+  return true;
+}
+
+// outer * inner, both row major 4x5 with an implicit last row of identity.
+void ConcatMatrix(const float outer[20], const float inner[20],
+                  float result[20]) {
+  for (int32_t row = 0; row < 4; row++) {
+    for (int32_t col = 0; col < 5; col++) {
+      float value = col == 4 ? outer[row * 5 + 4] : 0.f;
+      for (int32_t k = 0; k < 4; k++) {
+        value += outer[row * 5 + k] * inner[k * 5 + col];
+      }
+      result[row * 5 + col] = value;
+    }
+  }
+}
+
+#ifdef SKITY_CPU
+
+void ConvertSpan(PMColor colors[], int32_t count, bool to_unpremul) {
+  if (to_unpremul) {
+    for (int32_t i = 0; i < count; i++) {
+      colors[i] = PMColorToColor(colors[i]);
+    }
+  } else {
+    for (int32_t i = 0; i < count; i++) {
+      colors[i] = ColorToPMColor(colors[i]);
+    }
+  }
+}
+
+void RunGamma(const uint8_t table[256], Color colors[], int32_t count) {
+  for (int32_t i = 0; i < count; i++) {
+    Color c = colors[i];
+    colors[i] = ColorSetARGB(ColorGetA(c), table[ColorGetR(c)],
+                             table[ColorGetG(c)], table[ColorGetB(c)]);
+  }
+}
+
+void RunBlend(Color color, BlendMode mode, PMColor colors[], int32_t count) {
+  const PMColor pm_color = ColorToPMColor(color);
+  if (mode == BlendMode::kClear || mode == BlendMode::kSrc) {
+    std::fill(colors, colors + count,
+              mode == BlendMode::kClear ? 0u : pm_color);
+    return;
+  }
+
+  for (int32_t i = 0; i < count; i++) {
+    colors[i] = PorterDuffBlend(pm_color, colors[i], mode);
+  }
+}
+
+#endif
+
+}  // namespace
+
+ColorFilterProgram::ColorFilterProgram(const ColorFilter* filter) {
+  Append(filter);
+
+#ifdef SKITY_CPU
+  for (const auto& op : ops_) {
+    if (op.type != OpType::kMatrix) {
+      continue;
+    }
+
+    // Same fixed point form as MatrixColorFilter, so programs with a single
+    // matrix match the unfused filter.
+    MatrixI16 matrix_i16 = {};
+    auto p = reinterpret_cast<int16_t*>(matrix_i16.m);
+    for (int32_t i = 0; i < 20; i++) {
+      p[i] = static_cast<int16_t>(op.matrix[i] * 255);
+    }
+    matrices_i16_.emplace_back(matrix_i16);
+  }
+#endif
+}
+
+void ColorFilterProgram::Append(const ColorFilter* filter) {
+  if (filter == nullptr) {
+    return;
+  }
+
+  const auto* filter_base = As_CFB(filter);
+  switch (filter_base->GetType()) {
+    case ColorFilterType::kCompose: {
+      // Already flattened, innermost filter first.
+      auto compose = static_cast<const ComposeColorFilter*>(filter_base);
+      for (const auto* child : compose->GetFilters()) {
+        Append(child);
+      }
+      break;
+    }
+    case ColorFilterType::kMatrix:
+      AppendMatrix(
+          static_cast<const MatrixColorFilter*>(filter_base)->GetRowMajor());
+      break;
+    case ColorFilterType::kLinearToSRGBGamma:
+      ops_.emplace_back(Op{OpType::kLinearToSRGBGamma});
+      break;
+    case ColorFilterType::kSRGBToLinearGamma:
+      ops_.emplace_back(Op{OpType::kSRGBToLinearGamma});
+      break;
+    case ColorFilterType::kBlend: {
+      auto blend = static_cast<const BlendColorFilter*>(filter_base);
+      BlendMode mode = blend->GetBlendMode();
+      if (mode == BlendMode::kDst) {
+        break;
+      }
+
+      // The result no longer depends on what came before.
+      if (mode == BlendMode::kClear || mode == BlendMode::kSrc) {
+        ops_.clear();
+      }
+
+      Op op{OpType::kBlend};
+      op.color = blend->GetColor();
+      op.mode = mode;
+      ops_.emplace_back(op);
+      break;
+    }
+  }
+}
+
+void ColorFilterProgram::AppendMatrix(const float matrix[20]) {
+  if (!ops_.empty() && ops_.back().type == OpType::kMatrix &&
+      IsOutputInUnitRange(ops_.back().matrix)) {
+    Op& back = ops_.back();
+    float folded[20];
+    ConcatMatrix(matrix, back.matrix, folded);
+    std::memcpy(back.matrix, folded, sizeof(folded));
+
+    if (std::memcmp(back.matrix, kIdentityMatrix, sizeof(folded)) == 0) {
+      ops_.pop_back();
+    }
+    return;
+  }
+
+  Op op{OpType::kMatrix};
+  std::memcpy(op.matrix, matrix, sizeof(op.matrix));
+  ops_.emplace_back(op);
+}
+
+#ifdef SKITY_CPU
+
+void ColorFilterProgram::Run(PMColor colors[], int32_t count) const {
+  bool unpremul = false;
+  size_t matrix_index = 0;
+
+  for (const auto& op : ops_) {
+    if (op.IsUnpremul() != unpremul) {
+      ConvertSpan(colors, count, op.IsUnpremul());
+      unpremul = op.IsUnpremul();
+    }
+
+    switch (op.type) {
+      case OpType::kMatrix: {
+        const auto& m = matrices_i16_[matrix_index++].m;
+        for (int32_t i = 0; i < count; i++) {
+          Color c = colors[i];
+          int32_t src[4] = {int32_t(ColorGetR(c)), int32_t(ColorGetG(c)),
+                            int32_t(ColorGetB(c)), int32_t(ColorGetA(c))};
+          int32_t dst[4];
+          for (int32_t row = 0; row < 4; row++) {
+            int32_t mul = src[0] * m[row][0] + src[1] * m[row][1] +
+                          src[2] * m[row][2] + src[3] * m[row][3];
+            dst[row] = std::clamp(mul / 255 + m[row][4], 0, 255);
+          }
+          colors[i] = ColorSetARGB(dst[3], dst[0], dst[1], dst[2]);
+        }
+        break;
+      }
+      case OpType::kLinearToSRGBGamma:
+      case OpType::kSRGBToLinearGamma:
+        RunGamma(GetSRGBGammaTable(op.type == OpType::kLinearToSRGBGamma
+                                       ? ColorFilterType::kLinearToSRGBGamma
+                                       : ColorFilterType::kSRGBToLinearGamma),
+                 colors, count);
+        break;
+      case OpType::kBlend:
+        RunBlend(op.color, op.mode, colors, count);
+        break;
+    }
+  }
+
+  if (unpremul) {
+    ConvertSpan(colors, count, false);
+  }
+}
+
+#endif
+
+}  // namespace skity
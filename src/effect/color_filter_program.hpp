@@ -0,0 +1,88 @@
+// Copyright 2021 The Lynx Authors. All rights reserved.
+// Licensed under the Apache License Version 2.0 that can be found in the
+// LICENSE file in the root directory of this source tree.
+
+#ifndef SRC_EFFECT_COLOR_FILTER_PROGRAM_HPP
+#define SRC_EFFECT_COLOR_FILTER_PROGRAM_HPP
+
+#include <cstdint>
+#include <skity/effect/color_filter.hpp>
+#include <skity/graphic/blend_mode.hpp>
+#include <skity/graphic/color.hpp>
+#include <vector>
+
+namespace skity {
+
+/**
+ * A color filter, compose chains included, flattened into a list of steps
+ * which run over whole spans instead of one virtual call per filter and
+ * pixel.
+ *
+ * Compiling folds what can be decided up front: consecutive matrices whose
+ * intermediate result can not leave [0, 1] are multiplied into one, blends
+ * which ignore their input drop every step before them, and kDst blends are
+ * dropped. Steps working on unpremultiplied colors share one unpremultiply
+ * instead of converting back and forth between them.
+ */
+class ColorFilterProgram {
+ public:
+  enum class OpType {
+    kMatrix,
+    kLinearToSRGBGamma,
+    kSRGBToLinearGamma,
+    kBlend,
+  };
+
+  struct Op {
+    OpType type = OpType::kMatrix;
+    // kMatrix, row major 4x5 as in ColorFilters::Matrix.
+    float matrix[20] = {};
+    // kBlend, the unpremultiplied constant color and the mode blending it
+    // over the filtered color.
+    Color color = 0;
+    BlendMode mode = BlendMode::kSrcOver;
+
+    // Whether the step expects and produces unpremultiplied colors.
+    bool IsUnpremul() const { return type != OpType::kBlend; }
+  };
+
+  ColorFilterProgram() = default;
+
+  explicit ColorFilterProgram(const ColorFilter* filter);
+
+  bool IsEmpty() const { return ops_.empty(); }
+
+  const std::vector<Op>& GetOps() const { return ops_; }
+
+#ifdef SKITY_CPU
+  /**
+   * Filters `count` premultiplied colors in place.
+   */
+  void Run(PMColor colors[], int32_t count) const;
+
+  PMColor Run(PMColor color) const {
+    Run(&color, 1);
+    return color;
+  }
+#endif
+
+ private:
+  void Append(const ColorFilter* filter);
+
+  void AppendMatrix(const float matrix[20]);
+
+#ifdef SKITY_CPU
+  struct MatrixI16 {
+    int16_t m[4][5];
+  };
+
+  // Fixed point copies of the kMatrix steps, in step order.
+  std::vector<MatrixI16> matrices_i16_ = {};
+#endif
+
+  std::vector<Op> ops_ = {};
+};
+
+}  // namespace skity
+
+#endif  // SRC_EFFECT_COLOR_FILTER_PROGRAM_HPP
@@ -0,0 +1,136 @@
+// Copyright 2021 The Lynx Authors. All rights reserved.
+// Licensed under the Apache License Version 2.0 that can be found in the
+// LICENSE file in the root directory of this source tree.
+
+#include "src/effect/gradient_lut.hpp"
+
+#include <algorithm>
+#include <atomic>
+
+#include "src/base/hash.hpp"
+#include "src/utils/no_destructor.hpp"
+
+namespace skity {
+
+namespace {
+
+Color4f Premul(const Color4f& color) {
+  return Color4f{color.r * color.a, color.g * color.a, color.b * color.a,
+                 color.a};
+}
+
+uint32_t NextID() {
+  static std::atomic<uint32_t> next_id{1};
+  return next_id.fetch_add(1, std::memory_order_relaxed);
+}
+
+}  // namespace
+
+Color4f InterpolateGradientColor(const Shader::GradientInfo& info, float t) {
+  int32_t color_count = static_cast<int32_t>(info.colors.size());
+  int32_t stop_count = static_cast<int32_t>(info.color_offsets.size());
+  bool premul = info.gradientFlags > 0;
+
+  if (color_count == 0) {
+    return Color4f{};
+  }
+
+  if (color_count == 1 || (stop_count > 0 && t <= info.color_offsets[0])) {
+    return Premul(info.colors[0]);
+  }
+
+  float step = 1.f / (color_count - 1);
+
+  int32_t i = 0;
+  float start = 0.f;
+  float end = 0.f;
+  for (; i < color_count - 1; i++) {
+    if (stop_count > 0) {
+      start = info.color_offsets[i];
+      end = info.color_offsets[i + 1];
+    } else {
+      start = step * i;
+      end = step * (i + 1);
+    }
+
+    if (t >= start && t <= end) {
+      break;
+    }
+  }
+
+  if (i == color_count - 1) {
+    return Premul(info.colors[color_count - 1]);
+  }
+
+  float total = end - start;
+  float mix_value = total > 0 ? (t - start) / total : 0.5f;
+
+  Color4f c0 = info.colors[i];
+  Color4f c1 = info.colors[i + 1];
+  if (premul) {
+    return Premul(c0) * (1 - mix_value) + Premul(c1) * mix_value;
+  }
+
+  return Premul(c0 * (1 - mix_value) + c1 * mix_value);
+}
+
+GradientLUT::GradientLUT(const Shader::GradientInfo& info, uint32_t size)
+    : colors_(std::max(size, 2u)), scale_(colors_.size() - 1), id_(NextID()) {
+  for (size_t i = 0; i < colors_.size(); i++) {
+    // The premultiplied color has the same channel layout as PMColor.
+    colors_[i] = Color4fToColor(
+        InterpolateGradientColor(info, static_cast<float>(i) / scale_));
+  }
+}
+
+uint32_t GradientLUT::SizeFor(const Shader::GradientInfo& info) {
+  return info.color_offsets.empty() ? kSmallSize : kLargeSize;
+}
+
+GradientLUTCache& GradientLUTCache::GetInstance() {
+  static NoDestructor<GradientLUTCache> instance;
+  return *instance;
+}
+
+GradientLUTCache::GradientLUTCache()
+    : cache_(kMaxEntryCount,
+             [](const std::shared_ptr<const GradientLUT>&) { return 1; }) {}
+
+std::shared_ptr<const GradientLUT> GradientLUTCache::FindOrCreate(
+    const Shader::GradientInfo& info) {
+  Key key{info.colors, info.color_offsets, info.gradientFlags > 0,
+          GradientLUT::SizeFor(info)};
+
+  return cache_.FindOrCreate(key, [&]() {
+    return std::make_shared<const GradientLUT>(info, key.size);
+  });
+}
+
+size_t GradientLUTCache::GetEntryCount() const {
+  return cache_.GetEntryCount();
+}
+
+void GradientLUTCache::Clear() { cache_.Clear(); }
+
+bool GradientLUTCache::Key::operator==(const Key& other) const {
+  return premul == other.premul && size == other.size &&
+         colors == other.colors && offsets == other.offsets;
+}
+
+size_t GradientLUTCache::KeyHash::operator()(const Key& key) const {
+  size_t seed = 0;
+  HashCombine(&seed, key.premul);
+  HashCombine(&seed, key.size);
+  for (const auto& color : key.colors) {
+    HashCombine(&seed, color.x);
+    HashCombine(&seed, color.y);
+    HashCombine(&seed, color.z);
+    HashCombine(&seed, color.w);
+  }
+  for (float offset : key.offsets) {
+    HashCombine(&seed, offset);
+  }
+  return seed;
+}
+
+}  // namespace skity
@@ -0,0 +1,107 @@
+// Copyright 2021 The Lynx Authors. All rights reserved.
+// Licensed under the Apache License Version 2.0 that can be found in the
+// LICENSE file in the root directory of this source tree.
+
+#ifndef SRC_EFFECT_GRADIENT_LUT_HPP
+#define SRC_EFFECT_GRADIENT_LUT_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <skity/effect/shader.hpp>
+#include <skity/graphic/color.hpp>
+#include <vector>
+
+#include "src/base/lru_cache.hpp"
+
+namespace skity {
+
+/**
+ * Interpolates the color stops of `info` at `t`, which must already be tiled
+ * into [0, 1], honoring the premul flag of the gradient. The result is
+ * premultiplied.
+ */
+Color4f InterpolateGradientColor(const Shader::GradientInfo& info, float t);
+
+/**
+ * Premultiplied color table of a gradient, with entry i holding the color at
+ * t = i / (size - 1). Tiling is left to the caller, so gradients which only
+ * differ in geometry or tile mode share one table.
+ */
+class GradientLUT {
+ public:
+  static constexpr uint32_t kSmallSize = 256;
+  static constexpr uint32_t kLargeSize = 1024;
+
+  GradientLUT(const Shader::GradientInfo& info, uint32_t size);
+
+  /**
+   * Table size used for `info`. Evenly spaced stops are smooth enough for 256
+   * entries, explicit offsets may place hard stops anywhere and get 1024.
+   */
+  static uint32_t SizeFor(const Shader::GradientInfo& info);
+
+  uint32_t Size() const { return static_cast<uint32_t>(colors_.size()); }
+
+  const PMColor* Colors() const { return colors_.data(); }
+
+  /**
+   * `t` must be in [0, 1].
+   */
+  PMColor Lookup(float t) const {
+    return colors_[static_cast<uint32_t>(t * scale_ + 0.5f)];
+  }
+
+  float Scale() const { return scale_; }
+
+  /**
+   * Never reused within the process, so GPU backends can key their uploads of
+   * the table by it.
+   */
+  uint32_t GetID() const { return id_; }
+
+ private:
+  std::vector<PMColor> colors_;
+  float scale_;
+  uint32_t id_;
+};
+
+/**
+ * Process wide cache of gradient tables keyed by colors, stops, interpolation
+ * mode and table size, so a gradient drawn every frame builds its table once.
+ */
+class GradientLUTCache {
+ public:
+  static constexpr size_t kMaxEntryCount = 64;
+
+  static GradientLUTCache& GetInstance();
+
+  GradientLUTCache();
+
+  std::shared_ptr<const GradientLUT> FindOrCreate(
+      const Shader::GradientInfo& info);
+
+  size_t GetEntryCount() const;
+
+  void Clear();
+
+ private:
+  struct Key {
+    std::vector<Vec4> colors;
+    std::vector<float> offsets;
+    bool premul;
+    uint32_t size;
+
+    bool operator==(const Key& other) const;
+  };
+
+  struct KeyHash {
+    size_t operator()(const Key& key) const;
+  };
+
+  SizedLRUCache<Key, std::shared_ptr<const GradientLUT>, KeyHash> cache_;
+};
+
+}  // namespace skity
+
+#endif  // SRC_EFFECT_GRADIENT_LUT_HPP
@@ -440,10 +440,8 @@ class PathStroker {
                         Vector* unitNormalBC);
   bool QuadStroke(const Point quad[3], QuadConstruct*);
   ResultType CompareQuadQuad(const Point quad[3], QuadConstruct*);
-  void QuadPerpRay(const Point quad[3], float t, Point* tPt, Point* onPt,
-                   Point* tangent) const;
-  void SetRayPts(const Point& tPt, Vector* dxy, Point* onPt,
-                 Point* tangent) const;
+  void QuadPerpRays(const Point quad[3], const float t[], int count,
+                    Point tPts[], Point onPts[], Point tangents[]) const;
   ResultType IntersectRay(QuadConstruct*, int) const;
   ResultType StrokeCloseEnough(const Point stroke[3], const Point ray[2],
                                QuadConstruct*, int depth) const;
@@ -567,17 +565,37 @@ bool PathStroker::QuadStroke(const Point quad[3], QuadConstruct* quadPts) {
 
 PathStroker::ResultType PathStroker::CompareQuadQuad(const Point quad[3],
                                                      QuadConstruct* quadPts) {
-  // get the quadratic approximation of the stroke
+  // The stroke ends which are not shared with the parent, and the ray from the
+  // middle which is needed whenever IntersectRay finds a quad, all projected
+  // in one batch.
+  float t[3];
+  Point tPts[3];
+  Point onPts[3];
+  Point tangents[3];
+  int count = 0;
+  int startIndex = -1;
+  int endIndex = -1;
   if (!quadPts->fStartSet) {
-    Point quadStartPt;
-    this->QuadPerpRay(quad, quadPts->fStartT, &quadStartPt, &quadPts->fQuad[0],
-                      &quadPts->fTangentStart);
-    quadPts->fStartSet = true;
+    startIndex = count;
+    t[count++] = quadPts->fStartT;
   }
   if (!quadPts->fEndSet) {
-    Point quadEndPt;
-    this->QuadPerpRay(quad, quadPts->fEndT, &quadEndPt, &quadPts->fQuad[2],
-                      &quadPts->fTangentEnd);
+    endIndex = count;
+    t[count++] = quadPts->fEndT;
+  }
+  const int midIndex = count;
+  t[count++] = quadPts->fMidT;
+
+  this->QuadPerpRays(quad, t, count, tPts, onPts, tangents);
+
+  if (startIndex >= 0) {
+    quadPts->fQuad[0] = onPts[startIndex];
+    quadPts->fTangentStart = tangents[startIndex];
+    quadPts->fStartSet = true;
+  }
+  if (endIndex >= 0) {
+    quadPts->fQuad[2] = onPts[endIndex];
+    quadPts->fTangentEnd = tangents[endIndex];
     quadPts->fEndSet = true;
   }
   ResultType resultType = this->IntersectRay(quadPts, fRecursionDepth);
@@ -586,36 +604,74 @@ PathStroker::ResultType PathStroker::CompareQuadQuad(const Point quad[3],
   }
   // project a ray from the curve to the stroke
   Point ray[2];
-  this->QuadPerpRay(quad, quadPts->fMidT, &ray[1], &ray[0], nullptr);
+  ray[0] = onPts[midIndex];
+  ray[1] = tPts[midIndex];
   return this->StrokeCloseEnough(quadPts->fQuad, ray, quadPts, fRecursionDepth);
 }
 
-// Given a quad and t, return the point on curve, its perpendicular, and the
-// perpendicular tangent.
-void PathStroker::QuadPerpRay(const Point quad[3], float t, Point* tPt,
-                              Point* onPt, Point* tangent) const {
-  Vector dxy;
-  QuadCoeff::EvalQuadAt(std::array<Point, 3>{quad[0], quad[1], quad[2]}, t, tPt,
-                        &dxy);
-  if (dxy.x == 0 && dxy.y == 0) {
-    dxy = quad[2] - quad[0];
-  }
-  SetRayPts(*tPt, &dxy, onPt, tangent);
-}
-
-void PathStroker::SetRayPts(const Point& tPt, Vector* dxy, Point* onPt,
-                            Point* tangent) const {
-  if (!PointSetLength<false>(*dxy, dxy->x, dxy->y, radius_)) {
-    dxy->x = radius_;
-    dxy->y = 0;
-  }
-  float axisFlip =
-      static_cast<float>(fStrokeType);  // go opposite ways for outer, inner
-  onPt->x = tPt.x + axisFlip * dxy->y;
-  onPt->y = tPt.y - axisFlip * dxy->x;
-  if (tangent) {
-    tangent->x = onPt->x + dxy->x;
-    tangent->y = onPt->y + dxy->y;
+// Given a quad and `count` (at most 3) values of t, return the points on the
+// curve, their perpendiculars and the perpendicular tangents. Each step runs
+// over all t values at once so the loops vectorize.
+void PathStroker::QuadPerpRays(const Point quad[3], const float t[], int count,
+                               Point tPts[], Point onPts[],
+                               Point tangents[]) const {
+  const float p0x = quad[0].x, p0y = quad[0].y;
+  const float p1x = quad[1].x, p1y = quad[1].y;
+  const float p2x = quad[2].x, p2y = quad[2].y;
+
+  // Same coefficients as QuadCoeff and QuadCoeff::EvalQuadTangentAt.
+  const float ax = p2x - 2.f * p1x + p0x, ay = p2y - 2.f * p1y + p0y;
+  const float bx = 2.f * (p1x - p0x), by = 2.f * (p1y - p0y);
+  const float tbx = p1x - p0x, tby = p1y - p0y;
+  const float tax = p2x - p1x - tbx, tay = p2y - p1y - tby;
+
+  float tt[3], px[3], py[3], dx[3], dy[3];
+  for (int i = 0; i < count; i++) {
+    tt[i] = std::min(std::max(t[i], 0.f), Float1);
+    px[i] = (ax * tt[i] + bx) * tt[i] + p0x;
+    py[i] = (ay * tt[i] + by) * tt[i] + p0y;
+    float vx = tax * tt[i] + tbx;
+    float vy = tay * tt[i] + tby;
+    dx[i] = vx + vx;
+    dy[i] = vy + vy;
+  }
+
+  for (int i = 0; i < count; i++) {
+    // The tangent is undefined at an end which coincides with the control
+    // point, use the chord instead.
+    if ((tt[i] == 0 && quad[0] == quad[1]) ||
+        (tt[i] == 1 && quad[1] == quad[2]) || (dx[i] == 0 && dy[i] == 0)) {
+      dx[i] = p2x - p0x;
+      dy[i] = p2y - p0y;
+    }
+  }
+
+  for (int i = 0; i < count; i++) {
+    // Scaled to the radius in double precision, as PointSetLength does.
+    double mag = std::sqrt(static_cast<double>(dx[i]) * dx[i] +
+                           static_cast<double>(dy[i]) * dy[i]);
+    double scale = radius_ / mag;
+    dx[i] = static_cast<float>(dx[i] * scale);
+    dy[i] = static_cast<float>(dy[i] * scale);
+  }
+
+  // go opposite ways for outer, inner
+  const float axisFlip = static_cast<float>(fStrokeType);
+  for (int i = 0; i < count; i++) {
+    if (!std::isfinite(dx[i]) || !std::isfinite(dy[i]) ||
+        (dx[i] == 0 && dy[i] == 0)) {
+      dx[i] = radius_;
+      dy[i] = 0;
+    }
+    tPts[i] = Point{px[i], py[i], 0, 1};
+    onPts[i].x = px[i] + axisFlip * dy[i];
+    onPts[i].y = py[i] - axisFlip * dx[i];
+    onPts[i].z = 0;
+    onPts[i].w = 1;
+    tangents[i].x = onPts[i].x + dx[i];
+    tangents[i].y = onPts[i].y + dy[i];
+    tangents[i].z = 0;
+    tangents[i].w = 1;
   }
 }
 
@@ -0,0 +1,80 @@
+// Copyright 2021 The Lynx Authors. All rights reserved.
+// Licensed under the Apache License Version 2.0 that can be found in the
+// LICENSE file in the root directory of this source tree.
+
+#include "src/geometry/stroke_cache.hpp"
+
+#include <skity/geometry/stroke.hpp>
+
+#include "src/base/hash.hpp"
+#include "src/utils/no_destructor.hpp"
+
+namespace skity {
+
+StrokeCache& StrokeCache::GetInstance() {
+  static NoDestructor<StrokeCache> instance;
+  return *instance;
+}
+
+StrokeCache::StrokeCache()
+    : cache_(kDefaultMaxBytes,
+             [](const std::shared_ptr<const Outline>& outline) {
+               return outline->byte_size;
+             }) {}
+
+std::shared_ptr<const Path> StrokeCache::FindOrCreate(
+    const Path& path, const Paint& paint, FrameStats* frame_stats) {
+  Key key{PathGeometryKey::From(path), paint.GetStrokeWidth(),
+          paint.GetStrokeMiter(), paint.GetStrokeCap(), paint.GetStrokeJoin()};
+
+  // Stroked outside the cache lock, other threads stroking different paths
+  // should not wait for this one.
+  bool hit = false;
+  auto outline = cache_.FindOrCreate(
+      key,
+      [&]() {
+        Stroke stroke(paint);
+        Path quad;
+        auto outline = std::make_shared<Outline>();
+        stroke.QuadPath(path, &quad);
+        stroke.StrokePath(quad, &outline->path);
+
+        outline->byte_size =
+            key.path.GetByteSize() +
+            outline->path.CountVerbs() * sizeof(Path::Verb) +
+            outline->path.CountPoints() * sizeof(Point);
+        return std::shared_ptr<const Outline>(std::move(outline));
+      },
+      &hit);
+
+  if (frame_stats) {
+    frame_stats->Increment(hit ? FrameCounter::kStrokeCacheHits
+                               : FrameCounter::kStrokeCacheMisses);
+  }
+
+  return std::shared_ptr<const Path>(outline, &outline->path);
+}
+
+size_t StrokeCache::GetCachedBytes() const { return cache_.GetTotalSize(); }
+
+void StrokeCache::SetMaxBytes(size_t max_bytes) {
+  cache_.SetMaxSize(max_bytes);
+}
+
+void StrokeCache::Clear() { cache_.Clear(); }
+
+bool StrokeCache::Key::operator==(const Key& other) const {
+  return width == other.width && miter_limit == other.miter_limit &&
+         cap == other.cap && join == other.join && path == other.path;
+}
+
+size_t StrokeCache::KeyHash::operator()(const Key& key) const {
+  size_t seed = key.path.Hash();
+  HashCombine(&seed, key.width);
+  HashCombine(&seed, key.miter_limit);
+  HashCombine(&seed, static_cast<int32_t>(key.cap));
+  HashCombine(&seed, static_cast<int32_t>(key.join));
+  return seed;
+}
+
+}  // namespace skity
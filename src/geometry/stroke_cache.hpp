@@ -0,0 +1,77 @@
+// Copyright 2021 The Lynx Authors. All rights reserved.
+// Licensed under the Apache License Version 2.0 that can be found in the
+// LICENSE file in the root directory of this source tree.
+
+#ifndef SRC_GEOMETRY_STROKE_CACHE_HPP
+#define SRC_GEOMETRY_STROKE_CACHE_HPP
+
+#include <cstddef>
+#include <memory>
+#include <skity/graphic/paint.hpp>
+#include <skity/graphic/path.hpp>
+#include <skity/render/frame_stats.hpp>
+
+#include "src/base/lru_cache.hpp"
+#include "src/graphic/path_geometry_key.hpp"
+
+namespace skity {
+
+/**
+ * Process wide cache of stroke outlines keyed by the path geometry and the
+ * stroke width, cap, join and miter limit, so a thick stroke of the same path
+ * or glyph drawn every frame is offset once.
+ */
+class StrokeCache {
+ public:
+  static constexpr size_t kDefaultMaxBytes = 8 * 1024 * 1024;
+
+  static StrokeCache& GetInstance();
+
+  StrokeCache();
+
+  /**
+   * Returns the outline of `path` stroked with the stroke settings of
+   * `paint`, which is what Stroke::QuadPath followed by Stroke::StrokePath
+   * produce. Hits and misses are counted into `frame_stats` if it is not
+   * null.
+   */
+  std::shared_ptr<const Path> FindOrCreate(const Path& path,
+                                           const Paint& paint,
+                                           FrameStats* frame_stats = nullptr);
+
+  size_t GetCachedBytes() const;
+
+  void SetMaxBytes(size_t max_bytes);
+
+  void Clear();
+
+ private:
+  struct Key {
+    PathGeometryKey path;
+    float width;
+    float miter_limit;
+    Paint::Cap cap;
+    Paint::Join join;
+
+    bool operator==(const Key& other) const;
+  };
+
+  struct KeyHash {
+    size_t operator()(const Key& key) const;
+  };
+
+  /**
+   * The stroked path and the bytes charged for it, which include the copy of
+   * the source geometry held by the key.
+   */
+  struct Outline {
+    Path path;
+    size_t byte_size;
+  };
+
+  SizedLRUCache<Key, std::shared_ptr<const Outline>, KeyHash> cache_;
+};
+
+}  // namespace skity
+
+#endif  // SRC_GEOMETRY_STROKE_CACHE_HPP
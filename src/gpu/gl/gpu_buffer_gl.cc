@@ -19,7 +19,13 @@ GPUBufferGL::GPUBufferGL(const GPUBufferDescriptor& desc) : GPUBuffer(desc) {
   }
 }
 
-GPUBufferGL::~GPUBufferGL() { GL_CALL(DeleteBuffers, 1, &gl_buffer_); }
+GPUBufferGL::~GPUBufferGL() {
+  for (auto& [layouts, state] : vertex_arrays_) {
+    GL_CALL(DeleteVertexArrays, 1, &state.vao);
+  }
+
+  GL_CALL(DeleteBuffers, 1, &gl_buffer_);
+}
 
 void GPUBufferGL::UploadData(void* data, size_t size) {
   SKITY_TRACE_EVENT(GPUBufferGL_UploadData);
@@ -46,4 +52,20 @@ void GPUBufferGL::UploadData(void* data, size_t size) {
   GL_CALL(BindBuffer, target_, 0);
 }
 
+GLVertexArrayState* GPUBufferGL::FindOrCreateVertexArray(
+    const std::vector<GPUVertexBufferLayout>* layouts) {
+  auto it = vertex_arrays_.find(layouts);
+  if (it != vertex_arrays_.end()) {
+    return &it->second;
+  }
+
+  GLVertexArrayState state{};
+  GL_CALL(GenVertexArrays, 1, &state.vao);
+  if (state.vao == 0) {
+    return nullptr;
+  }
+
+  return &vertex_arrays_.emplace(layouts, state).first->second;
+}
+
 }  // namespace skity
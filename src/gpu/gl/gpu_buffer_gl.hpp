@@ -1,4 +1,3 @@
-
 // Copyright 2021 The Lynx Authors. All rights reserved.
 // Licensed under the Apache License Version 2.0 that can be found in the
 // LICENSE file in the root directory of this source tree.
@@ -6,11 +5,36 @@
 #ifndef SRC_GPU_GL_GPU_BUFFER_GL_HPP
 #define SRC_GPU_GL_GPU_BUFFER_GL_HPP
 
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
 #include "src/gpu/gl/gl_interface.hpp"
 #include "src/gpu/gpu_buffer.hpp"
 
 namespace skity {
 
+struct GPUVertexBufferLayout;
+
+/**
+ * Attribute setup recorded in a vertex array object. The render pass compares
+ * it with the next draw, so only the attribute calls which differ are issued.
+ */
+struct GLVertexArrayState {
+  GLuint vao = 0;
+  const std::vector<GPUVertexBufferLayout>* layouts = nullptr;
+  GLuint vertex_buffer = 0;
+  size_t vertex_offset = 0;
+  GLuint instance_buffer = 0;
+  size_t instance_offset = 0;
+  GLuint element_buffer = 0;
+  // Bit masks indexed by shader location.
+  uint32_t enabled_attribs = 0;
+  uint32_t instanced_attribs = 0;
+  uint32_t known_divisors = 0;
+};
+
 class GPUBufferGL : public GPUBuffer {
  public:
   explicit GPUBufferGL(const GPUBufferDescriptor& desc);
@@ -21,9 +45,21 @@ class GPUBufferGL : public GPUBuffer {
 
   GLuint GetBufferId() const { return gl_buffer_; }
 
+  /**
+   * Returns the vertex array object which sources the given pipeline layouts
+   * from this buffer. It is created on first use and lives as long as the
+   * buffer, so draws from the same stage buffer keep their attribute setup
+   * across frames.
+   */
+  GLVertexArrayState* FindOrCreateVertexArray(
+      const std::vector<GPUVertexBufferLayout>* layouts);
+
  private:
   GLenum target_;
   GLuint gl_buffer_;
+  std::unordered_map<const std::vector<GPUVertexBufferLayout>*,
+                     GLVertexArrayState>
+      vertex_arrays_;
 };
 
 }  // namespace skity
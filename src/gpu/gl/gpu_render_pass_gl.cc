@@ -21,18 +21,20 @@ void GPURenderPassGL::EncodeCommands(std::optional<GPUViewport> viewport,
   SKITY_TRACE_EVENT(GPURenderPassGL_EncodeCommands);
   GL_CALL(BindFramebuffer, GL_FRAMEBUFFER, target_fbo_);
 
-  // Skity does not use more than 8 texture units in a render pass, so a
-  // uint8_t bitmask is enough to track the units touched by this pass.
+  // A uint8_t bitmask is enough to track the units touched by this pass.
+  static_assert(kMaxTextureUnits <= 8);
   uint8_t touched_texture_units = 0;
   auto track_texture_unit = [&touched_texture_units](uint32_t unit) {
-    DEBUG_CHECK(unit < 8);
-    if (unit >= 8) {
+    DEBUG_CHECK(unit < kMaxTextureUnits);
+    if (unit >= kMaxTextureUnits) {
       return;
     }
 
     touched_texture_units |= static_cast<uint8_t>(1u << unit);
   };
 
+  vertex_array_ = &default_vertex_array_;
+
   auto target_width = GetDescriptor().GetTargetWidth();
   auto target_height = GetDescriptor().GetTargetHeight();
 
@@ -107,70 +109,32 @@ void GPURenderPassGL::EncodeCommands(std::optional<GPUViewport> viewport,
                   depth_stencil.depth_state.compare);
 
     // Set program
-    GL_CALL(UseProgram, pipeline->GetProgramId());
-
-    BindBuffer(GL_ARRAY_BUFFER,
-               static_cast<GPUBufferGL*>(command->vertex_buffer.buffer)
-                   ->GetBufferId());
-
-    // Set vertex
-    auto const& buffer_layouts = *pipeline->GetDescriptor().buffers;
-    for (auto& buffer_layout : buffer_layouts) {
-      bool is_instance =
-          buffer_layout.step_mode == GPUVertexStepMode::kInstance;
-      const auto& buffer =
-          is_instance ? command->instance_buffer : command->vertex_buffer;
-      BindBuffer(GL_ARRAY_BUFFER,
-                 static_cast<GPUBufferGL*>(buffer.buffer)->GetBufferId());
-
-      for (auto& attribute : buffer_layout.attributes) {
-        GL_CALL(EnableVertexAttribArray, attribute.shader_location);
-        auto format = ToGLVertexFormatInfo(attribute.format);
-        auto offset = reinterpret_cast<void*>(buffer.offset + attribute.offset);
-        if (format.integer) {
-          GL_CALL(VertexAttribIPointer, attribute.shader_location,
-                  format.component_count, format.component_type,
-                  buffer_layout.array_stride, offset);
-        } else {
-          GL_CALL(VertexAttribPointer, attribute.shader_location,
-                  format.component_count, format.component_type, GL_FALSE,
-                  buffer_layout.array_stride, offset);
-        }
-        GL_CALL(VertexAttribDivisor, attribute.shader_location,
-                is_instance ? 1 : 0);
-      }
-    }
+    UseProgram(pipeline->GetProgramId());
+
+    SetupVertexAttributes(pipeline, command);
 
     // Bind uniforms
     for (auto& binding : command->uniform_bindings) {
       if (!pipeline->SupportBindingSlotInShader()) {
-        GL_CALL(UniformBlockBinding, pipeline->GetProgramId(),
-                pipeline->GetProgram()->GetUniformBlockIndex(binding.name),
-                binding.index);
+        pipeline->GetProgram()->SetUniformBlockBinding(binding.name,
+                                                       binding.index);
       }
 
-      BindBuffer(
-          GL_UNIFORM_BUFFER,
-          static_cast<GPUBufferGL*>(binding.buffer.buffer)->GetBufferId());
-
-      GL_CALL(BindBufferRange, GL_UNIFORM_BUFFER, binding.index,
-              static_cast<GPUBufferGL*>(binding.buffer.buffer)->GetBufferId(),
-              binding.buffer.offset, binding.buffer.range);
+      BindUniformBuffer(
+          binding.index,
+          static_cast<GPUBufferGL*>(binding.buffer.buffer)->GetBufferId(),
+          binding.buffer.offset, binding.buffer.range);
     }
 
     // Bind textures and samplers separately
     for (auto& binding : command->texture_bindings) {
-      auto texture = static_cast<GPUTextureGL*>(binding.texture.get());
-
-      GL_CALL(ActiveTexture, GL_TEXTURE0 + binding.index);
       track_texture_unit(binding.index);
-      texture->Bind();
+      BindTexture(binding.index,
+                  static_cast<GPUTextureGL*>(binding.texture.get()));
 
       if (!pipeline->SupportBindingSlotInShader()) {
         // only query uniform location if ubo slot binding is not supported
-        GL_CALL(Uniform1i,
-                pipeline->GetProgram()->GetUniformLocation(binding.name),
-                binding.index);
+        pipeline->GetProgram()->SetSamplerUnit(binding.name, binding.index);
       }
     }
 
@@ -182,18 +146,14 @@ void GPURenderPassGL::EncodeCommands(std::optional<GPUViewport> viewport,
 
         for (auto unit : units) {
           track_texture_unit(unit);
-          GL_CALL(BindSampler, unit, sampler->GetSamplerID());
+          BindSampler(unit, sampler->GetSamplerID());
         }
       } else {
         track_texture_unit(binding.index);
-        GL_CALL(BindSampler, binding.index, sampler->GetSamplerID());
+        BindSampler(binding.index, sampler->GetSamplerID());
       }
     }
 
-    BindBuffer(
-        GL_ELEMENT_ARRAY_BUFFER,
-        static_cast<GPUBufferGL*>(command->index_buffer.buffer)->GetBufferId());
-
     // Non-coherent advanced blend needs a barrier so the next draw/blit reads
     // the blended result. Coherent mode issues no barrier.
     auto const& target = pipeline->GetDescriptor().target;
@@ -248,16 +208,22 @@ void GPURenderPassGL::EncodeCommands(std::optional<GPUViewport> viewport,
 #endif
   }
 
-  for (uint32_t unit = 0; unit < 8; ++unit) {
+  for (uint32_t unit = 0; unit < kMaxTextureUnits; ++unit) {
     if ((touched_texture_units & static_cast<uint8_t>(1u << unit)) == 0) {
       continue;
     }
 
-    GL_CALL(ActiveTexture, GL_TEXTURE0 + unit);
-    GL_CALL(BindSampler, unit, 0);
+    SetActiveTexture(unit);
+    BindSampler(unit, 0);
     GL_CALL(BindTexture, GL_TEXTURE_2D, 0);
+    bound_textures_[unit] = nullptr;
   }
-  GL_CALL(ActiveTexture, GL_TEXTURE0);
+  SetActiveTexture(0);
+
+  // Hand the vertex array of the context owner back, the cached ones are only
+  // bound inside of a render pass.
+  BindVertexArray(&default_vertex_array_);
+
   GL_CALL(BindFramebuffer, GL_FRAMEBUFFER, 0);
 }
 
@@ -423,15 +389,183 @@ void GPURenderPassGL::BindBuffer(uint32_t target, uint32_t buffer) {
 void GPURenderPassGL::SetDepthState(bool enable, bool writable,
                                     GPUCompareFunction func) {
   if (!enable) {
-    GL_CALL(Disable, GL_DEPTH_TEST);
+    if (!depth_state_valid_ || enable_depth_test_) {
+      GL_CALL(Disable, GL_DEPTH_TEST);
+    }
+    enable_depth_test_ = false;
     return;
   }
 
-  GL_CALL(Enable, GL_DEPTH_TEST);
+  if (!depth_state_valid_ || !enable_depth_test_) {
+    GL_CALL(Enable, GL_DEPTH_TEST);
+  }
 
-  GL_CALL(DepthMask, writable);
+  if (!depth_state_valid_ || writable != depth_writable_) {
+    GL_CALL(DepthMask, writable);
+  }
+
+  if (!depth_state_valid_ || func != depth_compare_) {
+    GL_CALL(DepthFunc, ToCompareFunction(func));
+  }
+
+  depth_state_valid_ = true;
+  enable_depth_test_ = true;
+  depth_writable_ = writable;
+  depth_compare_ = func;
+}
 
-  GL_CALL(DepthFunc, ToCompareFunction(func));
+void GPURenderPassGL::BindVertexArray(GLVertexArrayState* state) {
+  if (state == vertex_array_) {
+    return;
+  }
+
+  if (!default_vertex_array_queried_) {
+    GLint vao = 0;
+    GL_CALL(GetIntegerv, GL_VERTEX_ARRAY_BINDING, &vao);
+    default_vertex_array_.vao = static_cast<GLuint>(vao);
+    default_vertex_array_queried_ = true;
+  }
+
+  GL_CALL(BindVertexArray, state->vao);
+  vertex_array_ = state;
+}
+
+void GPURenderPassGL::SetupVertexAttributes(GPURenderPipelineGL* pipeline,
+                                            Command* command) {
+  auto layouts = pipeline->GetDescriptor().buffers;
+  auto vertex_buffer = static_cast<GPUBufferGL*>(command->vertex_buffer.buffer);
+  auto instance_buffer =
+      static_cast<GPUBufferGL*>(command->instance_buffer.buffer);
+
+  // A vertex array is cached per layout in the buffer which sources it. Draws
+  // which read instances from another buffer use the default one.
+  GLVertexArrayState* state = nullptr;
+  if (instance_buffer == nullptr || instance_buffer == vertex_buffer) {
+    state = vertex_buffer->FindOrCreateVertexArray(layouts);
+  }
+  if (state == nullptr) {
+    state = &default_vertex_array_;
+  }
+  BindVertexArray(state);
+
+  GLuint vertex_id = vertex_buffer->GetBufferId();
+  GLuint instance_id =
+      instance_buffer != nullptr ? instance_buffer->GetBufferId() : 0;
+  bool same_layouts = state->layouts == layouts;
+  bool same_vertex = same_layouts && state->vertex_buffer == vertex_id &&
+                     state->vertex_offset == command->vertex_buffer.offset;
+  bool same_instance =
+      same_layouts && state->instance_buffer == instance_id &&
+      state->instance_offset == command->instance_buffer.offset;
+
+  for (auto& buffer_layout : *layouts) {
+    bool is_instance = buffer_layout.step_mode == GPUVertexStepMode::kInstance;
+    if (is_instance ? same_instance : same_vertex) {
+      continue;
+    }
+
+    const auto& buffer =
+        is_instance ? command->instance_buffer : command->vertex_buffer;
+    BindBuffer(GL_ARRAY_BUFFER, is_instance ? instance_id : vertex_id);
+
+    for (auto& attribute : buffer_layout.attributes) {
+      uint32_t location = attribute.shader_location;
+      uint32_t mask = location < 32 ? 1u << location : 0;
+      if ((state->enabled_attribs & mask) == 0) {
+        GL_CALL(EnableVertexAttribArray, location);
+        state->enabled_attribs |= mask;
+      }
+
+      auto format = ToGLVertexFormatInfo(attribute.format);
+      auto offset = reinterpret_cast<void*>(buffer.offset + attribute.offset);
+      if (format.integer) {
+        GL_CALL(VertexAttribIPointer, location, format.component_count,
+                format.component_type, buffer_layout.array_stride, offset);
+      } else {
+        GL_CALL(VertexAttribPointer, location, format.component_count,
+                format.component_type, GL_FALSE, buffer_layout.array_stride,
+                offset);
+      }
+
+      bool instanced = (state->instanced_attribs & mask) != 0;
+      if ((state->known_divisors & mask) == 0 || instanced != is_instance) {
+        GL_CALL(VertexAttribDivisor, location, is_instance ? 1 : 0);
+        state->known_divisors |= mask;
+        if (is_instance) {
+          state->instanced_attribs |= mask;
+        } else {
+          state->instanced_attribs &= ~mask;
+        }
+      }
+    }
+  }
+
+  state->layouts = layouts;
+  state->vertex_buffer = vertex_id;
+  state->vertex_offset = command->vertex_buffer.offset;
+  state->instance_buffer = instance_id;
+  state->instance_offset = command->instance_buffer.offset;
+
+  // The element array binding is part of the vertex array state.
+  GLuint index_id =
+      static_cast<GPUBufferGL*>(command->index_buffer.buffer)->GetBufferId();
+  if (state->element_buffer != index_id) {
+    GL_CALL(BindBuffer, GL_ELEMENT_ARRAY_BUFFER, index_id);
+    state->element_buffer = index_id;
+  }
+}
+
+void GPURenderPassGL::BindUniformBuffer(uint32_t index, uint32_t buffer,
+                                        size_t offset, size_t range) {
+  auto it = uniform_buffers_.find(index);
+  if (it != uniform_buffers_.end() && it->second.buffer == buffer &&
+      it->second.offset == offset && it->second.range == range) {
+    return;
+  }
+
+  // glBindBufferRange also binds the buffer to the generic binding point.
+  GL_CALL(BindBufferRange, GL_UNIFORM_BUFFER, index, buffer, offset, range);
+
+  bound_buffer_.insert_or_assign(GL_UNIFORM_BUFFER, buffer);
+  uniform_buffers_.insert_or_assign(index,
+                                    UniformBufferState{buffer, offset, range});
+}
+
+void GPURenderPassGL::SetActiveTexture(uint32_t unit) {
+  if (unit == active_texture_unit_) {
+    return;
+  }
+
+  GL_CALL(ActiveTexture, GL_TEXTURE0 + unit);
+
+  active_texture_unit_ = unit;
+}
+
+void GPURenderPassGL::BindTexture(uint32_t unit, GPUTextureGL* texture) {
+  if (unit < kMaxTextureUnits && bound_textures_[unit] == texture) {
+    return;
+  }
+
+  SetActiveTexture(unit);
+  texture->Bind();
+
+  if (unit < kMaxTextureUnits) {
+    bound_textures_[unit] = texture;
+  }
+}
+
+void GPURenderPassGL::BindSampler(uint32_t unit, uint32_t sampler) {
+  if (unit < kMaxTextureUnits && (known_samplers_ & (1u << unit)) != 0 &&
+      bound_samplers_[unit] == sampler) {
+    return;
+  }
+
+  GL_CALL(BindSampler, unit, sampler);
+
+  if (unit < kMaxTextureUnits) {
+    bound_samplers_[unit] = sampler;
+    known_samplers_ |= static_cast<uint8_t>(1u << unit);
+  }
 }
 
 void GPURenderPassGL::BlitFramebuffer(uint32_t src_fbo, uint32_t dst_fbo,
@@ -5,13 +5,18 @@
 #ifndef SRC_GPU_GL_GPU_RENDER_PASS_GL_HPP
 #define SRC_GPU_GL_GPU_RENDER_PASS_GL_HPP
 
+#include <array>
 #include <functional>
 #include <unordered_map>
 
+#include "src/gpu/gl/gpu_buffer_gl.hpp"
 #include "src/gpu/gpu_render_pass.hpp"
 
 namespace skity {
 
+class GPURenderPipelineGL;
+class GPUTextureGL;
+
 class GPURenderPassGL : public GPURenderPass {
  public:
   GPURenderPassGL(const GPURenderPassDescriptor& desc, uint32_t target_fbo)
@@ -32,7 +37,16 @@ class GPURenderPassGL : public GPURenderPass {
 
   uint32_t GetTargetFBO() const { return target_fbo_; }
 
+  // Skity does not use more than 8 texture units in a render pass.
+  static constexpr uint32_t kMaxTextureUnits = 8;
+
  private:
+  struct UniformBufferState {
+    uint32_t buffer = 0;
+    size_t offset = 0;
+    size_t range = 0;
+  };
+
   void Clear();
 
   void SetScissorBox(uint32_t x, uint32_t y, uint32_t width, uint32_t height);
@@ -51,6 +65,19 @@ class GPURenderPassGL : public GPURenderPass {
 
   void SetDepthState(bool enable, bool writable, GPUCompareFunction func);
 
+  void BindVertexArray(GLVertexArrayState* state);
+
+  void SetupVertexAttributes(GPURenderPipelineGL* pipeline, Command* command);
+
+  void BindUniformBuffer(uint32_t index, uint32_t buffer, size_t offset,
+                         size_t range);
+
+  void SetActiveTexture(uint32_t unit);
+
+  void BindTexture(uint32_t unit, GPUTextureGL* texture);
+
+  void BindSampler(uint32_t unit, uint32_t sampler);
+
  protected:
   uint32_t target_fbo_;
   bool need_free_fbo_ = true;
@@ -65,6 +92,20 @@ class GPURenderPassGL : public GPURenderPass {
   GPUStencilState stencil_state_ = {};
   GPUScissorRect scissor_box_ = {};
   std::unordered_map<uint32_t, uint32_t> bound_buffer_ = {};
+  bool depth_state_valid_ = false;
+  bool enable_depth_test_ = false;
+  bool depth_writable_ = false;
+  GPUCompareFunction depth_compare_ = GPUCompareFunction::kAlways;
+  // The vertex array bound by the owner of the GL context. It is used for
+  // draws which can not use a cached vertex array and restored at the end.
+  GLVertexArrayState default_vertex_array_ = {};
+  bool default_vertex_array_queried_ = false;
+  GLVertexArrayState* vertex_array_ = nullptr;
+  std::unordered_map<uint32_t, UniformBufferState> uniform_buffers_ = {};
+  uint32_t active_texture_unit_ = kMaxTextureUnits;
+  std::array<GPUTextureGL*, kMaxTextureUnits> bound_textures_ = {};
+  std::array<uint32_t, kMaxTextureUnits> bound_samplers_ = {};
+  uint8_t known_samplers_ = 0;
   std::function<void()> after_cleanup_action_ = nullptr;
 };
 
@@ -14,7 +14,7 @@ GLProgram::~GLProgram() {
   }
 }
 
-GLuint GLProgram::GetUniformLocation(const std::string name) {
+GLuint GLProgram::GetUniformLocation(const std::string& name) {
   auto it = uniform_locations_.find(name);
   if (it != uniform_locations_.end()) {
     return it->second;
@@ -24,7 +24,7 @@ GLuint GLProgram::GetUniformLocation(const std::string name) {
   return location;
 }
 
-GLuint GLProgram::GetUniformBlockIndex(const std::string name) {
+GLuint GLProgram::GetUniformBlockIndex(const std::string& name) {
   auto it = uniform_block_indices_.find(name);
   if (it != uniform_block_indices_.end()) {
     return it->second;
@@ -34,6 +34,29 @@ GLuint GLProgram::GetUniformBlockIndex(const std::string name) {
   return index;
 }
 
+void GLProgram::SetUniformBlockBinding(const std::string& name,
+                                       GLuint binding) {
+  GLuint index = GetUniformBlockIndex(name);
+  auto it = uniform_block_bindings_.find(index);
+  if (it != uniform_block_bindings_.end() && it->second == binding) {
+    return;
+  }
+
+  GL_CALL(UniformBlockBinding, program_, index, binding);
+  uniform_block_bindings_[index] = binding;
+}
+
+void GLProgram::SetSamplerUnit(const std::string& name, GLint unit) {
+  GLuint location = GetUniformLocation(name);
+  auto it = sampler_units_.find(location);
+  if (it != sampler_units_.end() && it->second == unit) {
+    return;
+  }
+
+  GL_CALL(Uniform1i, location, unit);
+  sampler_units_[location] = unit;
+}
+
 GPURenderPipelineGL::GPURenderPipelineGL(
     const GPURenderPipelineDescriptor& desc)
     : GPURenderPipeline(desc) {
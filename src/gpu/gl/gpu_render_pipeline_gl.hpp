@@ -22,15 +22,29 @@ class GLProgram {
 
   GLuint GetProgram() const { return program_; }
 
-  GLuint GetUniformLocation(const std::string name);
+  GLuint GetUniformLocation(const std::string& name);
 
-  GLuint GetUniformBlockIndex(const std::string name);
+  GLuint GetUniformBlockIndex(const std::string& name);
+
+  /**
+   * Assigns the uniform block to a binding point. The assignment is part of
+   * the program object, so it is only issued when it changes.
+   */
+  void SetUniformBlockBinding(const std::string& name, GLuint binding);
+
+  /**
+   * Assigns the sampler uniform to a texture unit, only issued when it
+   * changes. The program must be in use.
+   */
+  void SetSamplerUnit(const std::string& name, GLint unit);
 
   bool SupportBindingSlotInShader() const { return support_slot_in_shader_; }
 
  private:
   std::unordered_map<std::string, GLuint> uniform_block_indices_;
   std::unordered_map<std::string, GLint> uniform_locations_;
+  std::unordered_map<GLuint, GLuint> uniform_block_bindings_;
+  std::unordered_map<GLuint, GLint> sampler_units_;
   GLuint program_;
   bool support_slot_in_shader_ = false;
 };
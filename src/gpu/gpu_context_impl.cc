@@ -19,6 +19,8 @@ bool GPUContextImpl::Init() {
   texture_manager_ = std::make_shared<TextureManager>(gpu_device_.get());
   atlas_manager_ = std::make_unique<AtlasManager>(gpu_device_.get(), this);
   render_target_cache_ = HWRenderTargetCache::Create(gpu_device_.get());
+  gradient_lut_texture_cache_ =
+      std::make_unique<HWGradientLUTTextureCache>(gpu_device_.get());
 
   pipeline_lib_ = std::make_unique<HWPipelineLib>(this, GetBackendType(),
                                                   gpu_device_.get());
@@ -137,6 +139,7 @@ void GPUContextImpl::ResetOwnedResources() {
   pipeline_lib_.reset();
   render_target_cache_.reset();
   atlas_manager_.reset();
+  gradient_lut_texture_cache_.reset();
   texture_manager_.reset();
   gpu_device_.reset();
 }
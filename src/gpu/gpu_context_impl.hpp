@@ -8,6 +8,7 @@
 #include <skity/gpu/gpu_context.hpp>
 
 #include "src/gpu/texture_manager.hpp"
+#include "src/render/hw/hw_gradient_lut_texture_cache.hpp"
 #include "src/render/hw/hw_pipeline_lib.hpp"
 #include "src/render/hw/hw_render_target_cache.hpp"
 #include "src/render/text/atlas/atlas_manager.hpp"
@@ -56,6 +57,10 @@ class GPUContextImpl : public GPUContext {
 
   TextureManager* GetTextureManager() const { return texture_manager_.get(); }
 
+  HWGradientLUTTextureCache* GetGradientLUTTextureCache() const {
+    return gradient_lut_texture_cache_.get();
+  }
+
   std::unique_ptr<GPURenderTarget> CreateRenderTarget(
       const GPURenderTargetDescriptor& desc) override;
 
@@ -103,6 +108,7 @@ class GPUContextImpl : public GPUContext {
   std::unique_ptr<HWRenderTargetCache> render_target_cache_ = {};
   std::unique_ptr<HWPipelineLib> pipeline_lib_ = {};
   std::unique_ptr<AtlasManager> atlas_manager_ = {};
+  std::unique_ptr<HWGradientLUTTextureCache> gradient_lut_texture_cache_ = {};
   bool force_depth_stencil_pipeline_state_ = false;
 };
 
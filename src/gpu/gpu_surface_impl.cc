@@ -78,6 +78,8 @@ Canvas* GPUSurfaceImpl::LockCanvas(bool clear) {
     canvas_ = std::make_unique<HWCanvas>(this);
   }
 
+  canvas_->ResetFrameStats();
+
   auto root_layer = OnBeginNextFrame(clear);
 
   root_layer->SetEnableMergingDrawCall(ctx_->IsEnableMergingDrawCall());
@@ -90,6 +92,10 @@ Canvas* GPUSurfaceImpl::LockCanvas(bool clear) {
 void GPUSurfaceImpl::Flush() {
   OnFlush();
 
+  if (canvas_ != nullptr) {
+    last_frame_stats_ = canvas_->GetFrameStats();
+  }
+
   ctx_->GetRenderTargetCache()->PurgeAsNeeded();
   ctx_->GetTextureManager()->ClearGPUTextures();
   ctx_->GetAtlasManager()->ClearExtraRes();
@@ -48,6 +48,8 @@ class GPUSurfaceImpl : public GPUSurface {
 
   void Flush() override;
 
+  FrameStats GetLastFrameStats() const override { return last_frame_stats_; }
+
   GPUContextImpl* GetGPUContext() const { return ctx_; }
 
   HWStageBuffer* GetStageBuffer() const { return stage_buffer_.get(); }
@@ -78,6 +80,7 @@ class GPUSurfaceImpl : public GPUSurface {
   std::unique_ptr<HWCanvas> canvas_;
   std::shared_ptr<BlockCacheAllocator> block_cache_allocator_;
   std::unique_ptr<ArenaAllocator> arena_allocator_;
+  FrameStats last_frame_stats_ = {};
 };
 
 }  // namespace skity
@@ -560,6 +560,8 @@ bool LoadVulkanDeviceFns(PFN_vkGetDeviceProcAddr get_device_proc_addr,
       get_device_proc_addr(device, "vkCreateDescriptorPool"));
   fns->vkDestroyDescriptorPool = reinterpret_cast<PFN_vkDestroyDescriptorPool>(
       get_device_proc_addr(device, "vkDestroyDescriptorPool"));
+  fns->vkResetDescriptorPool = reinterpret_cast<PFN_vkResetDescriptorPool>(
+      get_device_proc_addr(device, "vkResetDescriptorPool"));
   fns->vkAllocateDescriptorSets =
       reinterpret_cast<PFN_vkAllocateDescriptorSets>(
           get_device_proc_addr(device, "vkAllocateDescriptorSets"));
@@ -579,6 +581,8 @@ bool LoadVulkanDeviceFns(PFN_vkGetDeviceProcAddr get_device_proc_addr,
       get_device_proc_addr(device, "vkCreatePipelineCache"));
   fns->vkDestroyPipelineCache = reinterpret_cast<PFN_vkDestroyPipelineCache>(
       get_device_proc_addr(device, "vkDestroyPipelineCache"));
+  fns->vkGetPipelineCacheData = reinterpret_cast<PFN_vkGetPipelineCacheData>(
+      get_device_proc_addr(device, "vkGetPipelineCacheData"));
   fns->vkCreateGraphicsPipelines =
       reinterpret_cast<PFN_vkCreateGraphicsPipelines>(
           get_device_proc_addr(device, "vkCreateGraphicsPipelines"));
@@ -663,6 +667,7 @@ bool LoadVulkanDeviceFns(PFN_vkGetDeviceProcAddr get_device_proc_addr,
       fns->vkCreateSampler == nullptr || fns->vkDestroySampler == nullptr ||
       fns->vkCreateDescriptorPool == nullptr ||
       fns->vkDestroyDescriptorPool == nullptr ||
+      fns->vkResetDescriptorPool == nullptr ||
       fns->vkAllocateDescriptorSets == nullptr ||
       fns->vkUpdateDescriptorSets == nullptr ||
       fns->vkCreateDescriptorSetLayout == nullptr ||
@@ -671,6 +676,7 @@ bool LoadVulkanDeviceFns(PFN_vkGetDeviceProcAddr get_device_proc_addr,
       fns->vkDestroyPipelineLayout == nullptr ||
       fns->vkCreatePipelineCache == nullptr ||
       fns->vkDestroyPipelineCache == nullptr ||
+      fns->vkGetPipelineCacheData == nullptr ||
       fns->vkCreateGraphicsPipelines == nullptr ||
       fns->vkDestroyPipeline == nullptr || fns->vkCmdBindPipeline == nullptr ||
       fns->vkCmdBindDescriptorSets == nullptr ||
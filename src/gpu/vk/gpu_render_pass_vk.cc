@@ -5,8 +5,13 @@
 #include "src/gpu/vk/gpu_render_pass_vk.hpp"
 
 #include <array>
+#include <functional>
+#include <unordered_map>
 #include <unordered_set>
+#include <utility>
+#include <vector>
 
+#include "src/base/hash.hpp"
 #include "src/gpu/vk/gpu_buffer_vk.hpp"
 #include "src/gpu/vk/gpu_command_buffer_vk.hpp"
 #include "src/gpu/vk/gpu_render_pipeline_vk.hpp"
@@ -289,16 +294,9 @@ VkImageLayout GetSampledImageLayout(const GPUTextureVK& texture) {
   return VK_IMAGE_LAYOUT_GENERAL;
 }
 
-struct DescriptorPoolRequirements {
-  uint32_t max_sets = 0;
-  uint32_t uniform_buffer_count = 0;
-  uint32_t sampled_image_count = 0;
-  uint32_t sampler_count = 0;
-};
-
-void AccumulateDescriptorPoolRequirements(const Command& command,
-                                          const GPURenderPipelineVK& pipeline,
-                                          DescriptorPoolRequirements* req) {
+void AccumulateDescriptorPoolRequirements(
+    const Command& command, const GPURenderPipelineVK& pipeline,
+    VulkanContextState::DescriptorPoolRequirements* req) {
   if (req == nullptr) {
     return;
   }
@@ -312,14 +310,16 @@ void AccumulateDescriptorPoolRequirements(const Command& command,
   req->sampler_count += static_cast<uint32_t>(command.sampler_bindings.size());
 }
 
-VkDescriptorPool CreateDescriptorPoolForPass(
+// Takes a recycled descriptor pool large enough for every command in the pass.
+// The pool goes back to the state once the submission has completed.
+VkDescriptorPool AcquireDescriptorPoolForPass(
     const std::shared_ptr<const VulkanContextState>& state,
     const GPURenderPass& pass) {
   if (state == nullptr || state->GetLogicalDevice() == VK_NULL_HANDLE) {
     return VK_NULL_HANDLE;
   }
 
-  DescriptorPoolRequirements requirements = {};
+  VulkanContextState::DescriptorPoolRequirements requirements = {};
   for (const auto* command : pass.GetCommands()) {
     if (command == nullptr || !command->IsValid()) {
       continue;
@@ -337,36 +337,7 @@ VkDescriptorPool CreateDescriptorPoolForPass(
     return VK_NULL_HANDLE;
   }
 
-  std::vector<VkDescriptorPoolSize> pool_sizes;
-  if (requirements.uniform_buffer_count > 0) {
-    pool_sizes.push_back(
-        {VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, requirements.uniform_buffer_count});
-  }
-  if (requirements.sampled_image_count > 0) {
-    pool_sizes.push_back(
-        {VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE, requirements.sampled_image_count});
-  }
-  if (requirements.sampler_count > 0) {
-    pool_sizes.push_back(
-        {VK_DESCRIPTOR_TYPE_SAMPLER, requirements.sampler_count});
-  }
-
-  VkDescriptorPoolCreateInfo pool_info = {};
-  pool_info.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
-  pool_info.maxSets = requirements.max_sets;
-  pool_info.poolSizeCount = static_cast<uint32_t>(pool_sizes.size());
-  pool_info.pPoolSizes = pool_sizes.empty() ? nullptr : pool_sizes.data();
-
-  VkDescriptorPool descriptor_pool = VK_NULL_HANDLE;
-  const VkResult result = state->DeviceFns().vkCreateDescriptorPool(
-      state->GetLogicalDevice(), &pool_info, nullptr, &descriptor_pool);
-  if (result != VK_SUCCESS || descriptor_pool == VK_NULL_HANDLE) {
-    LOGE("Failed to create Vulkan descriptor pool: {}",
-         static_cast<int32_t>(result));
-    return VK_NULL_HANDLE;
-  }
-
-  return descriptor_pool;
+  return state->AcquireDescriptorPool(requirements);
 }
 
 bool PrepareSampledTextures(const VulkanContextState& state,
@@ -425,50 +396,140 @@ void RecordBoundResourceCleanup(GPUCommandBufferVK& command_buffer,
       [textures = std::move(textures), samplers = std::move(samplers)]() {});
 }
 
-bool SetupDescriptorSets(const VulkanContextState& state,
-                         VkCommandBuffer command_buffer,
-                         VkDescriptorPool descriptor_pool,
-                         const Command& command,
-                         const GPURenderPipelineVK& pipeline) {
+// One resource written to a descriptor set. Unused handles stay null.
+struct DescriptorWriteKey {
+  uint32_t binding = 0;
+  VkDescriptorType type = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+  VkBuffer buffer = VK_NULL_HANDLE;
+  VkDeviceSize offset = 0;
+  VkDeviceSize range = 0;
+  VkImageView image_view = VK_NULL_HANDLE;
+  VkImageLayout image_layout = VK_IMAGE_LAYOUT_UNDEFINED;
+  VkSampler sampler = VK_NULL_HANDLE;
+
+  bool operator==(const DescriptorWriteKey& other) const {
+    return binding == other.binding && type == other.type &&
+           buffer == other.buffer && offset == other.offset &&
+           range == other.range && image_view == other.image_view &&
+           image_layout == other.image_layout && sampler == other.sampler;
+  }
+};
+
+// A descriptor set is identified by its layout and the resources written to
+// it, two draws with equal keys can share the same set.
+struct DescriptorSetKey {
+  VkDescriptorSetLayout layout = VK_NULL_HANDLE;
+  std::vector<DescriptorWriteKey> writes = {};
+
+  bool operator==(const DescriptorSetKey& other) const {
+    return layout == other.layout && writes == other.writes;
+  }
+};
+
+struct DescriptorSetKeyHash {
+  size_t operator()(const DescriptorSetKey& key) const {
+    size_t seed = 0;
+    HashCombine(&seed, key.layout);
+    for (const auto& write : key.writes) {
+      HashCombine(&seed, write.binding);
+      HashCombine(&seed, write.buffer);
+      HashCombine(&seed, write.offset);
+      HashCombine(&seed, write.image_view);
+      HashCombine(&seed, write.sampler);
+    }
+    return seed;
+  }
+};
+
+/**
+ * Binds the descriptor sets of the draws in one render pass.
+ *
+ * Sets are allocated from the pass descriptor pool and looked up by their
+ * content first, so draws which bind the same resources share one set and
+ * skip vkUpdateDescriptorSets. Binding the sets which are already bound is
+ * skipped as well.
+ */
+class DescriptorSetBinder {
+ public:
+  DescriptorSetBinder(const VulkanContextState& state,
+                      VkCommandBuffer command_buffer,
+                      VkDescriptorPool descriptor_pool)
+      : state_(state),
+        command_buffer_(command_buffer),
+        descriptor_pool_(descriptor_pool) {}
+
+  bool Bind(const Command& command, const GPURenderPipelineVK& pipeline);
+
+ private:
+  bool BuildKeys(const Command& command, std::vector<DescriptorSetKey>* keys);
+
+  bool AllocateAndWrite(std::vector<DescriptorSetKey>* keys,
+                        const std::vector<size_t>& missing,
+                        std::vector<VkDescriptorSet>* descriptor_sets);
+
+  const VulkanContextState& state_;
+  VkCommandBuffer command_buffer_ = VK_NULL_HANDLE;
+  VkDescriptorPool descriptor_pool_ = VK_NULL_HANDLE;
+  std::unordered_map<DescriptorSetKey, VkDescriptorSet, DescriptorSetKeyHash>
+      sets_ = {};
+  VkPipelineLayout bound_layout_ = VK_NULL_HANDLE;
+  std::vector<VkDescriptorSet> bound_sets_ = {};
+};
+
+bool DescriptorSetBinder::Bind(const Command& command,
+                               const GPURenderPipelineVK& pipeline) {
   const auto& set_layouts = pipeline.GetDescriptorSetLayouts();
   if (set_layouts.empty()) {
     return true;
   }
 
-  if (descriptor_pool == VK_NULL_HANDLE) {
+  if (descriptor_pool_ == VK_NULL_HANDLE) {
     LOGE("Failed to bind Vulkan descriptor sets: descriptor pool is null");
     return false;
   }
 
-  std::vector<VkDescriptorSet> descriptor_sets(set_layouts.size(),
-                                               VK_NULL_HANDLE);
-  VkDescriptorSetAllocateInfo alloc_info = {};
-  alloc_info.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
-  alloc_info.descriptorPool = descriptor_pool;
-  alloc_info.descriptorSetCount = static_cast<uint32_t>(set_layouts.size());
-  alloc_info.pSetLayouts = set_layouts.data();
+  std::vector<DescriptorSetKey> keys(set_layouts.size());
+  for (size_t i = 0; i < set_layouts.size(); ++i) {
+    keys[i].layout = set_layouts[i];
+  }
+  if (!BuildKeys(command, &keys)) {
+    return false;
+  }
 
-  const VkResult alloc_result = state.DeviceFns().vkAllocateDescriptorSets(
-      state.GetLogicalDevice(), &alloc_info, descriptor_sets.data());
-  if (alloc_result != VK_SUCCESS) {
-    LOGE("Failed to allocate Vulkan descriptor sets: {}",
-         static_cast<int32_t>(alloc_result));
+  std::vector<VkDescriptorSet> descriptor_sets(keys.size(), VK_NULL_HANDLE);
+  std::vector<size_t> missing;
+  for (size_t i = 0; i < keys.size(); ++i) {
+    auto it = sets_.find(keys[i]);
+    if (it != sets_.end()) {
+      descriptor_sets[i] = it->second;
+    } else {
+      missing.push_back(i);
+    }
+  }
+
+  if (!missing.empty() && !AllocateAndWrite(&keys, missing, &descriptor_sets)) {
     return false;
   }
 
-  const size_t total_write_count = command.uniform_bindings.size() +
-                                   command.texture_bindings.size() +
-                                   command.sampler_bindings.size();
-  std::vector<VkWriteDescriptorSet> writes;
-  writes.reserve(total_write_count);
-  std::vector<VkDescriptorBufferInfo> buffer_infos;
-  buffer_infos.reserve(command.uniform_bindings.size());
-  std::vector<VkDescriptorImageInfo> image_infos;
-  image_infos.reserve(command.texture_bindings.size() +
-                      command.sampler_bindings.size());
+  if (bound_layout_ == pipeline.GetPipelineLayout() &&
+      bound_sets_ == descriptor_sets) {
+    return true;
+  }
+
+  state_.DeviceFns().vkCmdBindDescriptorSets(
+      command_buffer_, VK_PIPELINE_BIND_POINT_GRAPHICS,
+      pipeline.GetPipelineLayout(), 0,
+      static_cast<uint32_t>(descriptor_sets.size()), descriptor_sets.data(), 0,
+      nullptr);
+  bound_layout_ = pipeline.GetPipelineLayout();
+  bound_sets_ = std::move(descriptor_sets);
+  return true;
+}
 
+bool DescriptorSetBinder::BuildKeys(const Command& command,
+                                    std::vector<DescriptorSetKey>* keys) {
   for (const auto& binding : command.uniform_bindings) {
-    if (binding.group >= descriptor_sets.size()) {
+    if (binding.group >= keys->size()) {
       LOGE("Invalid Vulkan uniform binding group {}", binding.group);
       return false;
     }
@@ -479,24 +540,17 @@ bool SetupDescriptorSets(const VulkanContextState& state,
       return false;
     }
 
-    buffer_infos.push_back(VkDescriptorBufferInfo{
-        buffer->GetBuffer(),
-        binding.buffer.offset,
-        binding.buffer.range,
-    });
-
-    VkWriteDescriptorSet write = {};
-    write.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
-    write.dstSet = descriptor_sets[binding.group];
-    write.dstBinding = binding.binding;
-    write.descriptorCount = 1;
-    write.descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
-    write.pBufferInfo = &buffer_infos.back();
-    writes.push_back(write);
+    DescriptorWriteKey write = {};
+    write.binding = binding.binding;
+    write.type = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+    write.buffer = buffer->GetBuffer();
+    write.offset = binding.buffer.offset;
+    write.range = binding.buffer.range;
+    (*keys)[binding.group].writes.push_back(write);
   }
 
   for (const auto& binding : command.texture_bindings) {
-    if (binding.group >= descriptor_sets.size()) {
+    if (binding.group >= keys->size()) {
       LOGE("Invalid Vulkan texture binding group {}", binding.group);
       return false;
     }
@@ -507,24 +561,16 @@ bool SetupDescriptorSets(const VulkanContextState& state,
       return false;
     }
 
-    image_infos.push_back(VkDescriptorImageInfo{
-        VK_NULL_HANDLE,
-        texture->GetImageView(),
-        GetSampledImageLayout(*texture),
-    });
-
-    VkWriteDescriptorSet write = {};
-    write.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
-    write.dstSet = descriptor_sets[binding.group];
-    write.dstBinding = binding.binding;
-    write.descriptorCount = 1;
-    write.descriptorType = VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE;
-    write.pImageInfo = &image_infos.back();
-    writes.push_back(write);
+    DescriptorWriteKey write = {};
+    write.binding = binding.binding;
+    write.type = VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE;
+    write.image_view = texture->GetImageView();
+    write.image_layout = GetSampledImageLayout(*texture);
+    (*keys)[binding.group].writes.push_back(write);
   }
 
   for (const auto& binding : command.sampler_bindings) {
-    if (binding.group >= descriptor_sets.size()) {
+    if (binding.group >= keys->size()) {
       LOGE("Invalid Vulkan sampler binding group {}", binding.group);
       return false;
     }
@@ -535,33 +581,83 @@ bool SetupDescriptorSets(const VulkanContextState& state,
       return false;
     }
 
-    image_infos.push_back(VkDescriptorImageInfo{
-        sampler->GetSampler(),
-        VK_NULL_HANDLE,
-        VK_IMAGE_LAYOUT_UNDEFINED,
-    });
+    DescriptorWriteKey write = {};
+    write.binding = binding.binding;
+    write.type = VK_DESCRIPTOR_TYPE_SAMPLER;
+    write.sampler = sampler->GetSampler();
+    (*keys)[binding.group].writes.push_back(write);
+  }
 
-    VkWriteDescriptorSet write = {};
-    write.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
-    write.dstSet = descriptor_sets[binding.group];
-    write.dstBinding = binding.binding;
-    write.descriptorCount = 1;
-    write.descriptorType = VK_DESCRIPTOR_TYPE_SAMPLER;
-    write.pImageInfo = &image_infos.back();
-    writes.push_back(write);
+  return true;
+}
+
+bool DescriptorSetBinder::AllocateAndWrite(
+    std::vector<DescriptorSetKey>* keys, const std::vector<size_t>& missing,
+    std::vector<VkDescriptorSet>* descriptor_sets) {
+  std::vector<VkDescriptorSetLayout> layouts;
+  layouts.reserve(missing.size());
+  size_t write_count = 0;
+  for (size_t index : missing) {
+    layouts.push_back((*keys)[index].layout);
+    write_count += (*keys)[index].writes.size();
+  }
+
+  std::vector<VkDescriptorSet> allocated(missing.size(), VK_NULL_HANDLE);
+  VkDescriptorSetAllocateInfo alloc_info = {};
+  alloc_info.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+  alloc_info.descriptorPool = descriptor_pool_;
+  alloc_info.descriptorSetCount = static_cast<uint32_t>(layouts.size());
+  alloc_info.pSetLayouts = layouts.data();
+
+  const VkResult alloc_result = state_.DeviceFns().vkAllocateDescriptorSets(
+      state_.GetLogicalDevice(), &alloc_info, allocated.data());
+  if (alloc_result != VK_SUCCESS) {
+    LOGE("Failed to allocate Vulkan descriptor sets: {}",
+         static_cast<int32_t>(alloc_result));
+    return false;
+  }
+
+  // Reserved up front, the writes keep pointers into both vectors.
+  std::vector<VkWriteDescriptorSet> writes;
+  writes.reserve(write_count);
+  std::vector<VkDescriptorBufferInfo> buffer_infos;
+  buffer_infos.reserve(write_count);
+  std::vector<VkDescriptorImageInfo> image_infos;
+  image_infos.reserve(write_count);
+
+  for (size_t i = 0; i < missing.size(); ++i) {
+    const size_t index = missing[i];
+    (*descriptor_sets)[index] = allocated[i];
+
+    for (const auto& key : (*keys)[index].writes) {
+      VkWriteDescriptorSet write = {};
+      write.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+      write.dstSet = allocated[i];
+      write.dstBinding = key.binding;
+      write.descriptorCount = 1;
+      write.descriptorType = key.type;
+      if (key.type == VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER) {
+        buffer_infos.push_back(
+            VkDescriptorBufferInfo{key.buffer, key.offset, key.range});
+        write.pBufferInfo = &buffer_infos.back();
+      } else {
+        image_infos.push_back(
+            VkDescriptorImageInfo{key.sampler, key.image_view,
+                                  key.image_layout});
+        write.pImageInfo = &image_infos.back();
+      }
+      writes.push_back(write);
+    }
+
+    sets_.emplace(std::move((*keys)[index]), allocated[i]);
   }
 
   if (!writes.empty()) {
-    state.DeviceFns().vkUpdateDescriptorSets(
-        state.GetLogicalDevice(), static_cast<uint32_t>(writes.size()),
+    state_.DeviceFns().vkUpdateDescriptorSets(
+        state_.GetLogicalDevice(), static_cast<uint32_t>(writes.size()),
         writes.data(), 0, nullptr);
   }
 
-  state.DeviceFns().vkCmdBindDescriptorSets(
-      command_buffer, VK_PIPELINE_BIND_POINT_GRAPHICS,
-      pipeline.GetPipelineLayout(), 0,
-      static_cast<uint32_t>(descriptor_sets.size()), descriptor_sets.data(), 0,
-      nullptr);
   return true;
 }
 
@@ -605,19 +701,19 @@ bool RecordDrawCommands(const std::shared_ptr<const VulkanContextState>& state,
   state->DeviceFns().vkCmdSetScissor(command_buffer.GetCommandBuffer(), 0, 1,
                                      &vk_scissor);
 
-  VkDescriptorPool descriptor_pool = CreateDescriptorPoolForPass(state, pass);
+  VkDescriptorPool descriptor_pool = AcquireDescriptorPoolForPass(state, pass);
   if (descriptor_pool != VK_NULL_HANDLE) {
+    // Pools still owned by a pass when the state goes away are destroyed by
+    // the state itself.
     std::weak_ptr<const VulkanContextState> weak_state = state;
     command_buffer.RecordCleanupAction([weak_state, descriptor_pool]() {
-      auto state = weak_state.lock();
-      if (state == nullptr || state->GetLogicalDevice() == VK_NULL_HANDLE ||
-          state->DeviceFns().vkDestroyDescriptorPool == nullptr) {
-        return;
+      if (auto state = weak_state.lock()) {
+        state->RecycleDescriptorPool(descriptor_pool);
       }
-      state->DeviceFns().vkDestroyDescriptorPool(state->GetLogicalDevice(),
-                                                 descriptor_pool, nullptr);
     });
   }
+  DescriptorSetBinder descriptor_set_binder(
+      *state, command_buffer.GetCommandBuffer(), descriptor_pool);
 
   for (const auto* command : pass.GetCommands()) {
     if (command == nullptr || !command->IsValid()) {
@@ -678,8 +774,7 @@ bool RecordDrawCommands(const std::shared_ptr<const VulkanContextState>& state,
         command_buffer.GetCommandBuffer(), index_buffer->GetBuffer(),
         command->index_buffer.offset, VK_INDEX_TYPE_UINT32);
 
-    if (!SetupDescriptorSets(*state, command_buffer.GetCommandBuffer(),
-                             descriptor_pool, *command, *pipeline)) {
+    if (!descriptor_set_binder.Bind(*command, *pipeline)) {
       return false;
     }
 
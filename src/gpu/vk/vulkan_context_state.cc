@@ -6,8 +6,12 @@
 
 #include <vk_mem_alloc.h>
 
+#include <cerrno>
+#include <cstdio>
 #include <cstdlib>
+#include <cstring>
 #include <set>
+#include <skity/io/data.hpp>
 #include <string_view>
 #include <vector>
 
@@ -19,6 +23,13 @@
 #include <dlfcn.h>
 #endif
 
+#if defined(SKITY_WIN)
+// clang-format off
+#include "src/base/platform/win/lean_windows.hpp"
+#include "src/base/platform/win/str_conversion.hpp"
+// clang-format on
+#endif
+
 #if defined(__clang__)
 #pragma clang diagnostic push
 #pragma clang diagnostic ignored "-Wunused-function"
@@ -30,6 +41,34 @@ namespace {
 
 constexpr char kPortabilitySubsetExtensionName[] = "VK_KHR_portability_subset";
 
+// Moves `from` over `to`, replacing `to` if it exists. std::rename does that
+// on POSIX but fails on Windows when the destination exists.
+bool MoveFileReplacing(const std::string& from, const std::string& to) {
+#if defined(SKITY_WIN)
+  std::wstring w_from;
+  std::wstring w_to;
+  if (FAILED(StrConversion::StringToWideString(from, &w_from)) ||
+      FAILED(StrConversion::StringToWideString(to, &w_to))) {
+    LOGW("Failed to convert Vulkan pipeline cache path {}", to);
+    return false;
+  }
+  if (::MoveFileExW(w_from.c_str(), w_to.c_str(),
+                    MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH) == 0) {
+    LOGW("Failed to replace Vulkan pipeline cache {}: error {}", to,
+         static_cast<uint32_t>(::GetLastError()));
+    return false;
+  }
+  return true;
+#else
+  if (std::rename(from.c_str(), to.c_str()) != 0) {
+    LOGW("Failed to replace Vulkan pipeline cache {}: {}", to,
+         std::strerror(errno));
+    return false;
+  }
+  return true;
+#endif
+}
+
 uint32_t ResolveInstanceApiVersion(const VulkanGlobalFns& global_fns) {
   if (global_fns.vkEnumerateInstanceVersion == nullptr) {
     return VK_API_VERSION_1_0;
@@ -626,6 +665,14 @@ bool VulkanContextState::Initialize(const GPUContextInfoVK& info) {
     return false;
   }
 
+  // Only a fully initialized context writes its pipeline cache back, a failed
+  // initialization must not replace a good cache file.
+  if (info.pipeline_cache_path != nullptr) {
+    pipeline_cache_path_ = info.pipeline_cache_path;
+  }
+  pipeline_cache_callback_ = info.pipeline_cache_callback;
+  pipeline_cache_userdata_ = info.pipeline_cache_userdata;
+
   LOGD("Initialized VulkanContextState successfully");
   return true;
 }
@@ -714,6 +761,58 @@ VkRenderPass VulkanContextState::GetOrCreateLegacyRenderPass(
   return render_pass_cache_.GetOrCreate(*this, key);
 }
 
+VkDescriptorPool VulkanContextState::AcquireDescriptorPool(
+    const DescriptorPoolRequirements& requirements) const {
+  return descriptor_pool_cache_.Acquire(*this, requirements);
+}
+
+void VulkanContextState::RecycleDescriptorPool(VkDescriptorPool pool) const {
+  descriptor_pool_cache_.Recycle(*this, pool);
+}
+
+void VulkanContextState::SavePipelineCache() const {
+  if (pipeline_cache_ == VK_NULL_HANDLE ||
+      (pipeline_cache_path_.empty() && pipeline_cache_callback_ == nullptr)) {
+    return;
+  }
+
+  size_t size = 0;
+  VkResult result = functions_.device.vkGetPipelineCacheData(
+      logical_device_, pipeline_cache_, &size, nullptr);
+  if (result != VK_SUCCESS || size == 0) {
+    LOGW("Failed to query Vulkan pipeline cache size: {}",
+         static_cast<int32_t>(result));
+    return;
+  }
+
+  std::vector<uint8_t> data(size);
+  result = functions_.device.vkGetPipelineCacheData(
+      logical_device_, pipeline_cache_, &size, data.data());
+  if (result != VK_SUCCESS) {
+    LOGW("Failed to read Vulkan pipeline cache: {}",
+         static_cast<int32_t>(result));
+    return;
+  }
+
+  if (!pipeline_cache_path_.empty()) {
+    // Written next to the target first, so an interrupted write never leaves
+    // a truncated cache behind.
+    const std::string temp_path = pipeline_cache_path_ + ".tmp";
+    auto cache_data = Data::MakeWithProc(data.data(), size, nullptr, nullptr);
+    if (cache_data == nullptr || !cache_data->WriteToFile(temp_path.c_str())) {
+      LOGW("Failed to write Vulkan pipeline cache to {}", temp_path);
+      std::remove(temp_path.c_str());
+    } else if (!MoveFileReplacing(temp_path, pipeline_cache_path_)) {
+      // The previous cache, if any, is left as it was.
+      std::remove(temp_path.c_str());
+    }
+  }
+
+  if (pipeline_cache_callback_ != nullptr) {
+    pipeline_cache_callback_(data.data(), size, pipeline_cache_userdata_);
+  }
+}
+
 bool VulkanContextState::HasAvailableInstanceExtension(
     const char* extension_name) const {
   return ContainsExtension(available_instance_extensions_, extension_name);
@@ -1161,22 +1260,10 @@ bool VulkanContextState::InitializeDevice(const GPUContextInfoVK& info) {
     return false;
   }
 
-  VkPipelineCacheCreateInfo pipeline_cache_info = {};
-  pipeline_cache_info.sType = VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO;
-  const VkResult pipeline_cache_result =
-      functions_.device.vkCreatePipelineCache(
-          logical_device_, &pipeline_cache_info, nullptr, &pipeline_cache_);
-  if (pipeline_cache_result != VK_SUCCESS ||
-      pipeline_cache_ == VK_NULL_HANDLE) {
-    LOGE("Failed to create Vulkan pipeline cache: result={}",
-         static_cast<int32_t>(pipeline_cache_result));
-    pipeline_cache_ = VK_NULL_HANDLE;
+  if (!InitializePipelineCache(info)) {
     return false;
   }
 
-  LOGD("Created Vulkan pipeline cache: {:p}",
-       reinterpret_cast<void*>(pipeline_cache_));
-
   if (!InitializeAllocator()) {
     return false;
   }
@@ -1523,6 +1610,71 @@ bool VulkanContextState::InitializeAllocator() {
   return true;
 }
 
+bool VulkanContextState::InitializePipelineCache(
+    const GPUContextInfoVK& info) {
+  const void* initial_data = info.pipeline_cache_data;
+  size_t initial_data_size = info.pipeline_cache_data_size;
+
+  std::shared_ptr<Data> file_data;
+  if (initial_data == nullptr && info.pipeline_cache_path != nullptr) {
+    // A missing file is expected on the first run and reads as empty data.
+    file_data = Data::MakeFromFileName(info.pipeline_cache_path);
+    if (file_data != nullptr && !file_data->IsEmpty()) {
+      initial_data = file_data->RawData();
+      initial_data_size = file_data->Size();
+    }
+  }
+
+  if (initial_data != nullptr &&
+      !IsPipelineCacheDataCompatible(initial_data, initial_data_size)) {
+    LOGW("Ignoring Vulkan pipeline cache data of another device or driver");
+    initial_data = nullptr;
+    initial_data_size = 0;
+  }
+
+  VkPipelineCacheCreateInfo pipeline_cache_info = {};
+  pipeline_cache_info.sType = VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO;
+  pipeline_cache_info.initialDataSize = initial_data_size;
+  pipeline_cache_info.pInitialData = initial_data;
+  const VkResult pipeline_cache_result =
+      functions_.device.vkCreatePipelineCache(
+          logical_device_, &pipeline_cache_info, nullptr, &pipeline_cache_);
+  if (pipeline_cache_result != VK_SUCCESS ||
+      pipeline_cache_ == VK_NULL_HANDLE) {
+    LOGE("Failed to create Vulkan pipeline cache: result={}",
+         static_cast<int32_t>(pipeline_cache_result));
+    pipeline_cache_ = VK_NULL_HANDLE;
+    return false;
+  }
+
+  LOGD("Created Vulkan pipeline cache: {:p} with {} bytes of initial data",
+       reinterpret_cast<void*>(pipeline_cache_), initial_data_size);
+  return true;
+}
+
+bool VulkanContextState::IsPipelineCacheDataCompatible(const void* data,
+                                                       size_t size) const {
+  // Drivers are required to reject foreign data themselves, but some crash on
+  // it, so check the header against the device first.
+  VkPipelineCacheHeaderVersionOne header = {};
+  if (size < sizeof(header) ||
+      functions_.instance.vkGetPhysicalDeviceProperties == nullptr) {
+    return false;
+  }
+  std::memcpy(&header, data, sizeof(header));
+
+  VkPhysicalDeviceProperties properties = {};
+  functions_.instance.vkGetPhysicalDeviceProperties(physical_device_,
+                                                    &properties);
+
+  return header.headerSize >= sizeof(header) &&
+         header.headerVersion == VK_PIPELINE_CACHE_HEADER_VERSION_ONE &&
+         header.vendorID == properties.vendorID &&
+         header.deviceID == properties.deviceID &&
+         std::memcmp(header.pipelineCacheUUID, properties.pipelineCacheUUID,
+                     VK_UUID_SIZE) == 0;
+}
+
 void VulkanContextState::Reset() {
 #if defined(SKITY_VK_DEBUG_RUNTIME)
   if (debug_runtime_.debug_utils_messenger != VK_NULL_HANDLE &&
@@ -1539,6 +1691,12 @@ void VulkanContextState::Reset() {
   CollectPendingSubmissions(true);
 
   render_pass_cache_.Reset(*this);
+  descriptor_pool_cache_.Reset(*this);
+
+  SavePipelineCache();
+  pipeline_cache_path_.clear();
+  pipeline_cache_callback_ = nullptr;
+  pipeline_cache_userdata_ = nullptr;
 
   if (pipeline_cache_ != VK_NULL_HANDLE && logical_device_ != VK_NULL_HANDLE &&
       functions_.device.vkDestroyPipelineCache != nullptr) {
@@ -8,6 +8,7 @@
 #include <vk_mem_alloc.h>
 
 #include <skity/gpu/gpu_context_vk.hpp>
+#include <string>
 #include <vector>
 
 #if defined(SKITY_ANDROID)
@@ -15,6 +16,7 @@
 #endif
 
 #include "src/gpu/vk/vulkan_debug_runtime_state.hpp"
+#include "src/gpu/vk/vulkan_descriptor_pool_cache.hpp"
 #include "src/gpu/vk/vulkan_pending_submission.hpp"
 #include "src/gpu/vk/vulkan_proc_table.hpp"
 #include "src/gpu/vk/vulkan_render_pass_cache.hpp"
@@ -24,6 +26,7 @@ namespace skity {
 class VulkanContextState {
  public:
   using LegacyRenderPassKey = VulkanRenderPassCache::Key;
+  using DescriptorPoolRequirements = VulkanDescriptorPoolCache::Requirements;
 
   VulkanContextState() = default;
 
@@ -137,12 +140,30 @@ class VulkanContextState {
   VkRenderPass GetOrCreateLegacyRenderPass(
       const LegacyRenderPassKey& key) const;
 
+  VkDescriptorPool AcquireDescriptorPool(
+      const DescriptorPoolRequirements& requirements) const;
+
+  void RecycleDescriptorPool(VkDescriptorPool pool) const;
+
+  const VulkanDescriptorPoolCache& GetDescriptorPoolCache() const {
+    return descriptor_pool_cache_;
+  }
+
+  /**
+   * Hands the current pipeline cache content to the path and callback from
+   * GPUContextInfoVK. Called when the context is destroyed, may be called
+   * earlier by hosts which are not shut down cleanly.
+   */
+  void SavePipelineCache() const;
+
  private:
   int32_t FindQueueFamilyIndex(VkQueueFlags flags, bool prefer_dedicated) const;
   bool InitializeInstance(const GPUContextInfoVK& info);
   bool InitializePhysicalDevice(const GPUContextInfoVK& info);
   bool InitializeQueues(const GPUContextInfoVK& info);
   bool InitializeDevice(const GPUContextInfoVK& info);
+  bool InitializePipelineCache(const GPUContextInfoVK& info);
+  bool IsPipelineCacheDataCompatible(const void* data, size_t size) const;
   bool InitializeOwnedDevice();
   bool ResolveQueues(const GPUContextInfoVK& info);
   bool InitializeAllocator();
@@ -188,6 +209,10 @@ class VulkanContextState {
 #endif
   mutable std::vector<VulkanPendingSubmission> pending_submissions_ = {};
   mutable VulkanRenderPassCache render_pass_cache_ = {};
+  mutable VulkanDescriptorPoolCache descriptor_pool_cache_ = {};
+  std::string pipeline_cache_path_ = {};
+  GPUPipelineCacheCallbackVK pipeline_cache_callback_ = nullptr;
+  void* pipeline_cache_userdata_ = nullptr;
 };
 
 }  // namespace skity
@@ -0,0 +1,145 @@
+// Copyright 2021 The Lynx Authors. All rights reserved.
+// Licensed under the Apache License Version 2.0 that can be found in the
+// LICENSE file in the root directory of this source tree.
+
+#include "src/gpu/vk/vulkan_descriptor_pool_cache.hpp"
+
+#include <algorithm>
+#include <iterator>
+
+#include "src/gpu/vk/vulkan_context_state.hpp"
+#include "src/logging.hpp"
+
+namespace skity {
+
+namespace {
+
+// Pools are created with power of two capacities of at least this size, so a
+// recycled pool also fits passes which draw a little more than the last one.
+constexpr uint32_t kMinDescriptorPoolCapacity = 64;
+
+// Free pools kept around for reuse, enough for a few passes per frame with
+// three frames in flight. Pools recycled beyond this are destroyed.
+constexpr size_t kMaxFreeDescriptorPools = 16;
+
+uint32_t RoundUpCapacity(uint32_t count) {
+  uint32_t capacity = kMinDescriptorPoolCapacity;
+  while (capacity < count && capacity < (1u << 31)) {
+    capacity <<= 1;
+  }
+  return std::max(capacity, count);
+}
+
+}  // namespace
+
+bool VulkanDescriptorPoolCache::Requirements::FitsIn(
+    const Requirements& capacity) const {
+  return max_sets <= capacity.max_sets &&
+         uniform_buffer_count <= capacity.uniform_buffer_count &&
+         sampled_image_count <= capacity.sampled_image_count &&
+         sampler_count <= capacity.sampler_count;
+}
+
+VkDescriptorPool VulkanDescriptorPoolCache::Acquire(
+    const VulkanContextState& state, const Requirements& requirements) {
+  if (state.GetLogicalDevice() == VK_NULL_HANDLE ||
+      state.DeviceFns().vkCreateDescriptorPool == nullptr) {
+    return VK_NULL_HANDLE;
+  }
+
+  Entry* best = nullptr;
+  for (auto& entry : pools_) {
+    if (entry.in_use || !requirements.FitsIn(entry.capacity)) {
+      continue;
+    }
+
+    if (best == nullptr || entry.capacity.max_sets < best->capacity.max_sets) {
+      best = &entry;
+    }
+  }
+
+  if (best != nullptr) {
+    best->in_use = true;
+    return best->pool;
+  }
+
+  Requirements capacity = {};
+  capacity.max_sets = RoundUpCapacity(requirements.max_sets);
+  capacity.uniform_buffer_count =
+      RoundUpCapacity(requirements.uniform_buffer_count);
+  capacity.sampled_image_count =
+      RoundUpCapacity(requirements.sampled_image_count);
+  capacity.sampler_count = RoundUpCapacity(requirements.sampler_count);
+
+  const VkDescriptorPoolSize pool_sizes[] = {
+      {VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, capacity.uniform_buffer_count},
+      {VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE, capacity.sampled_image_count},
+      {VK_DESCRIPTOR_TYPE_SAMPLER, capacity.sampler_count},
+  };
+
+  VkDescriptorPoolCreateInfo pool_info = {};
+  pool_info.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+  pool_info.maxSets = capacity.max_sets;
+  pool_info.poolSizeCount = static_cast<uint32_t>(std::size(pool_sizes));
+  pool_info.pPoolSizes = pool_sizes;
+
+  VkDescriptorPool pool = VK_NULL_HANDLE;
+  const VkResult result = state.DeviceFns().vkCreateDescriptorPool(
+      state.GetLogicalDevice(), &pool_info, nullptr, &pool);
+  if (result != VK_SUCCESS || pool == VK_NULL_HANDLE) {
+    LOGE("Failed to create Vulkan descriptor pool: {}",
+         static_cast<int32_t>(result));
+    return VK_NULL_HANDLE;
+  }
+
+  pools_.push_back({pool, capacity, true});
+  return pool;
+}
+
+void VulkanDescriptorPoolCache::Recycle(const VulkanContextState& state,
+                                        VkDescriptorPool pool) {
+  auto it = std::find_if(pools_.begin(), pools_.end(),
+                         [pool](const Entry& entry) {
+                           return entry.pool == pool && entry.in_use;
+                         });
+  if (it == pools_.end()) {
+    return;
+  }
+
+  if (GetFreePoolCount() >= kMaxFreeDescriptorPools ||
+      state.DeviceFns().vkResetDescriptorPool(state.GetLogicalDevice(), pool,
+                                              0) != VK_SUCCESS) {
+    pools_.erase(it);
+    Destroy(state, pool);
+    return;
+  }
+
+  it->in_use = false;
+}
+
+void VulkanDescriptorPoolCache::Reset(const VulkanContextState& state) {
+  for (const auto& entry : pools_) {
+    Destroy(state, entry.pool);
+  }
+
+  pools_.clear();
+}
+
+size_t VulkanDescriptorPoolCache::GetFreePoolCount() const {
+  return static_cast<size_t>(
+      std::count_if(pools_.begin(), pools_.end(),
+                    [](const Entry& entry) { return !entry.in_use; }));
+}
+
+void VulkanDescriptorPoolCache::Destroy(const VulkanContextState& state,
+                                        VkDescriptorPool pool) {
+  if (pool == VK_NULL_HANDLE || state.GetLogicalDevice() == VK_NULL_HANDLE ||
+      state.DeviceFns().vkDestroyDescriptorPool == nullptr) {
+    return;
+  }
+
+  state.DeviceFns().vkDestroyDescriptorPool(state.GetLogicalDevice(), pool,
+                                            nullptr);
+}
+
+}  // namespace skity
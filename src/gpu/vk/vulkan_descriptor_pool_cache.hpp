@@ -0,0 +1,73 @@
+// Copyright 2021 The Lynx Authors. All rights reserved.
+// Licensed under the Apache License Version 2.0 that can be found in the
+// LICENSE file in the root directory of this source tree.
+
+#ifndef SRC_GPU_VK_VULKAN_DESCRIPTOR_POOL_CACHE_HPP
+#define SRC_GPU_VK_VULKAN_DESCRIPTOR_POOL_CACHE_HPP
+
+#include <vulkan/vulkan.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace skity {
+
+class VulkanContextState;
+
+/**
+ * Recycles the descriptor pools used by render passes.
+ *
+ * A pool is handed out for one render pass and given back once the submission
+ * which recorded it has completed. Recycled pools are reset instead of being
+ * destroyed, so with N frames in flight the cache settles on about N pools per
+ * pass and stops creating new ones.
+ */
+class VulkanDescriptorPoolCache {
+ public:
+  struct Requirements {
+    uint32_t max_sets = 0;
+    uint32_t uniform_buffer_count = 0;
+    uint32_t sampled_image_count = 0;
+    uint32_t sampler_count = 0;
+
+    bool FitsIn(const Requirements& capacity) const;
+  };
+
+  VulkanDescriptorPoolCache() = default;
+  ~VulkanDescriptorPoolCache() = default;
+
+  /**
+   * Returns a pool with room for at least `requirements`, reusing a recycled
+   * pool when one is large enough.
+   */
+  VkDescriptorPool Acquire(const VulkanContextState& state,
+                           const Requirements& requirements);
+
+  /**
+   * Resets `pool` and makes it available to the next Acquire call. The GPU
+   * must be done with all sets allocated from it.
+   */
+  void Recycle(const VulkanContextState& state, VkDescriptorPool pool);
+
+  void Reset(const VulkanContextState& state);
+
+  size_t GetPoolCount() const { return pools_.size(); }
+
+  size_t GetFreePoolCount() const;
+
+ private:
+  struct Entry {
+    VkDescriptorPool pool = VK_NULL_HANDLE;
+    Requirements capacity = {};
+    bool in_use = false;
+  };
+
+  void Destroy(const VulkanContextState& state, VkDescriptorPool pool);
+
+  std::vector<Entry> pools_ = {};
+};
+
+}  // namespace skity
+
+#endif  // SRC_GPU_VK_VULKAN_DESCRIPTOR_POOL_CACHE_HPP
@@ -114,6 +114,7 @@ struct VulkanDeviceFns {
   PFN_vkDestroySampler vkDestroySampler = nullptr;
   PFN_vkCreateDescriptorPool vkCreateDescriptorPool = nullptr;
   PFN_vkDestroyDescriptorPool vkDestroyDescriptorPool = nullptr;
+  PFN_vkResetDescriptorPool vkResetDescriptorPool = nullptr;
   PFN_vkAllocateDescriptorSets vkAllocateDescriptorSets = nullptr;
   PFN_vkUpdateDescriptorSets vkUpdateDescriptorSets = nullptr;
   PFN_vkCreateDescriptorSetLayout vkCreateDescriptorSetLayout = nullptr;
@@ -122,6 +123,7 @@ struct VulkanDeviceFns {
   PFN_vkDestroyPipelineLayout vkDestroyPipelineLayout = nullptr;
   PFN_vkCreatePipelineCache vkCreatePipelineCache = nullptr;
   PFN_vkDestroyPipelineCache vkDestroyPipelineCache = nullptr;
+  PFN_vkGetPipelineCacheData vkGetPipelineCacheData = nullptr;
   PFN_vkCreateGraphicsPipelines vkCreateGraphicsPipelines = nullptr;
   PFN_vkDestroyPipeline vkDestroyPipeline = nullptr;
   PFN_vkCmdBindPipeline vkCmdBindPipeline = nullptr;
@@ -6,6 +6,7 @@
 
 #include "src/graphic/contour_measure.hpp"
 
+#include <algorithm>
 #include <array>
 #include <cassert>
 #include <tuple>
@@ -578,6 +579,51 @@ bool ContourMeasure::getPosTan(float distance, Point* position,
   return true;
 }
 
+bool ContourMeasure::getPosTan(const float distances[], int32_t count,
+                               Point positions[], Vector tangents[]) const {
+  float length = this->length();
+  assert(length > 0 && !segments_.empty());
+
+  const int32_t seg_count = static_cast<int32_t>(segments_.size());
+  bool result = true;
+  int32_t index = -1;
+  float prev_distance = 0.f;
+
+  for (int32_t i = 0; i < count; i++) {
+    float distance = distances[i];
+    if (FloatIsNan(distance)) {
+      result = false;
+      continue;
+    }
+
+    distance = std::clamp(distance, 0.f, length);
+
+    if (index < 0 || distance < prev_distance) {
+      index = TKSearch<Segment, float>(segments_.data(), seg_count, distance);
+      index ^= (index >> 31);
+    } else {
+      // Same lower bound TKSearch finds, reached by walking forward.
+      while (index + 1 < seg_count && segments_[index].distance < distance) {
+        index++;
+      }
+    }
+    prev_distance = distance;
+
+    float t;
+    const Segment* seg = this->segmentAt(index, distance, &t);
+    if (FloatIsNan(t)) {
+      result = false;
+      continue;
+    }
+
+    compute_pos_tan(&pts_[seg->pt_index], seg->type, t,
+                    positions ? &positions[i] : nullptr,
+                    tangents ? &tangents[i] : nullptr);
+  }
+
+  return result;
+}
+
 bool ContourMeasure::getSegment(float startD, float stopD, Path* dst,
                                 bool startWithMoveTo) const {
   assert(dst);
@@ -646,7 +692,14 @@ const ContourMeasure::Segment* ContourMeasure::distanceToSegment(
 
   int index = TKSearch<Segment, float>(seg, count, distance);
   index ^= (index >> 31);
-  seg = &seg[index];
+
+  return this->segmentAt(index, distance, t);
+}
+
+const ContourMeasure::Segment* ContourMeasure::segmentAt(int32_t index,
+                                                         float distance,
+                                                         float* t) const {
+  const Segment* seg = &segments_[index];
 
   // now interpolate t-values with prev segment (if possible)
   float startT = 0, startD = 0;
@@ -28,11 +28,29 @@ class ContourMeasure {
 
   bool getPosTan(float distance, Point* position, Vector* tangent) const;
 
+  /**
+   * Maps `count` distances to positions and tangents in one sweep. Ascending
+   * runs of distances walk the segment table forward from the previous hit
+   * instead of searching it again for every distance. Either output array may
+   * be nullptr.
+   *
+   * @return false if any distance is NaN, its outputs are left untouched.
+   */
+  bool getPosTan(const float distances[], int32_t count, Point positions[],
+                 Vector tangents[]) const;
+
   bool getSegment(float startD, float stopD, Path* dst,
                   bool startWithMoveTo) const;
 
   bool isClosed() const { return is_closed_; }
 
+  /**
+   * Bytes held by the segment and point tables of this contour.
+   */
+  size_t byteSize() const {
+    return segments_.size() * sizeof(Segment) + pts_.size() * sizeof(Point);
+  }
+
   struct Segment {
     // total distance up to this point
     float distance;
@@ -58,6 +76,9 @@ class ContourMeasure {
  private:
   const Segment* distanceToSegment(float distance, float* t) const;
 
+  // Interpolates the t-value of `distance` inside the segment at `index`.
+  const Segment* segmentAt(int32_t index, float distance, float* t) const;
+
   friend class ContourMeasureiter;
 
  private:
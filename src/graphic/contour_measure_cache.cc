@@ -0,0 +1,86 @@
+// Copyright 2021 The Lynx Authors. All rights reserved.
+// Licensed under the Apache License Version 2.0 that can be found in the
+// LICENSE file in the root directory of this source tree.
+
+#include "src/graphic/contour_measure_cache.hpp"
+
+#include "src/base/hash.hpp"
+#include "src/utils/no_destructor.hpp"
+
+namespace skity {
+
+std::shared_ptr<PathMeasurement> PathMeasurement::Measure(const Path& path,
+                                                          bool force_closed,
+                                                          float res_scale) {
+  auto measurement = std::make_shared<PathMeasurement>();
+
+  ContourMeasureIter iter(path, force_closed, res_scale);
+  while (auto contour = iter.next()) {
+    measurement->contours_.emplace_back(std::move(contour));
+  }
+
+  return measurement;
+}
+
+size_t PathMeasurement::GetByteSize() const {
+  size_t byte_size = 0;
+  for (const auto& contour : contours_) {
+    byte_size += sizeof(ContourMeasure) + contour->byteSize();
+  }
+  return byte_size;
+}
+
+ContourMeasureCache& ContourMeasureCache::GetInstance() {
+  static NoDestructor<ContourMeasureCache> instance;
+  return *instance;
+}
+
+ContourMeasureCache::ContourMeasureCache()
+    : cache_(kDefaultMaxBytes, [](const std::shared_ptr<const Entry>& entry) {
+        return entry->byte_size;
+      }) {}
+
+std::shared_ptr<const PathMeasurement> ContourMeasureCache::FindOrCreate(
+    const Path& path, bool force_closed, float res_scale) {
+  Key key{PathGeometryKey::From(path), force_closed, res_scale};
+
+  // Measured outside the cache lock, long curvy paths take a while to flatten.
+  auto entry = cache_.FindOrCreate(key, [&]() {
+    auto entry = std::make_shared<Entry>();
+    entry->measurement =
+        PathMeasurement::Measure(path, force_closed, res_scale);
+    entry->byte_size =
+        key.path.GetByteSize() + entry->measurement->GetByteSize();
+    return std::shared_ptr<const Entry>(std::move(entry));
+  });
+
+  return entry->measurement;
+}
+
+size_t ContourMeasureCache::GetEntryCount() const {
+  return cache_.GetEntryCount();
+}
+
+size_t ContourMeasureCache::GetCachedBytes() const {
+  return cache_.GetTotalSize();
+}
+
+void ContourMeasureCache::SetMaxBytes(size_t max_bytes) {
+  cache_.SetMaxSize(max_bytes);
+}
+
+void ContourMeasureCache::Clear() { cache_.Clear(); }
+
+bool ContourMeasureCache::Key::operator==(const Key& other) const {
+  return force_closed == other.force_closed &&
+         res_scale == other.res_scale && path == other.path;
+}
+
+size_t ContourMeasureCache::KeyHash::operator()(const Key& key) const {
+  size_t seed = key.path.Hash();
+  HashCombine(&seed, key.force_closed);
+  HashCombine(&seed, key.res_scale);
+  return seed;
+}
+
+}  // namespace skity
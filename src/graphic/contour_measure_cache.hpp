@@ -0,0 +1,99 @@
+// Copyright 2021 The Lynx Authors. All rights reserved.
+// Licensed under the Apache License Version 2.0 that can be found in the
+// LICENSE file in the root directory of this source tree.
+
+#ifndef SRC_GRAPHIC_CONTOUR_MEASURE_CACHE_HPP
+#define SRC_GRAPHIC_CONTOUR_MEASURE_CACHE_HPP
+
+#include <cstddef>
+#include <memory>
+#include <skity/graphic/path.hpp>
+#include <vector>
+
+#include "src/base/lru_cache.hpp"
+#include "src/graphic/contour_measure.hpp"
+#include "src/graphic/path_geometry_key.hpp"
+
+namespace skity {
+
+/**
+ * The measured contours of a path, in path order. Contours of zero length are
+ * skipped, the same as ContourMeasureIter does.
+ */
+class PathMeasurement {
+ public:
+  static std::shared_ptr<PathMeasurement> Measure(const Path& path,
+                                                  bool force_closed,
+                                                  float res_scale);
+
+  size_t GetContourCount() const { return contours_.size(); }
+
+  /**
+   * Returns the contour at `index`, or nullptr if `index` is out of range.
+   */
+  std::shared_ptr<ContourMeasure> GetContour(size_t index) const {
+    return index < contours_.size() ? contours_[index] : nullptr;
+  }
+
+  /**
+   * Bytes held by the segment and point tables of all contours.
+   */
+  size_t GetByteSize() const;
+
+ private:
+  std::vector<std::shared_ptr<ContourMeasure>> contours_ = {};
+};
+
+/**
+ * Process wide cache of path measurements keyed by the path geometry,
+ * forceClosed and resScale, so dashing or laying out along the same path every
+ * frame flattens its curves once.
+ */
+class ContourMeasureCache {
+ public:
+  static constexpr size_t kDefaultMaxBytes = 2 * 1024 * 1024;
+
+  static ContourMeasureCache& GetInstance();
+
+  ContourMeasureCache();
+
+  std::shared_ptr<const PathMeasurement> FindOrCreate(const Path& path,
+                                                      bool force_closed,
+                                                      float res_scale);
+
+  size_t GetEntryCount() const;
+
+  size_t GetCachedBytes() const;
+
+  void SetMaxBytes(size_t max_bytes);
+
+  void Clear();
+
+ private:
+  struct Key {
+    PathGeometryKey path;
+    bool force_closed;
+    float res_scale;
+
+    bool operator==(const Key& other) const;
+  };
+
+  struct KeyHash {
+    size_t operator()(const Key& key) const;
+  };
+
+  /**
+   * The measurement and the bytes charged for it, which include the copy of
+   * the source geometry held by the key.
+   */
+  struct Entry {
+    std::shared_ptr<const PathMeasurement> measurement;
+    size_t byte_size;
+  };
+
+  SizedLRUCache<Key, std::shared_ptr<const Entry>, KeyHash> cache_;
+};
+
+}  // namespace skity
+
+#endif  // SRC_GRAPHIC_CONTOUR_MEASURE_CACHE_HPP
@@ -0,0 +1,145 @@
+// Copyright 2021 The Lynx Authors. All rights reserved.
+// Licensed under the Apache License Version 2.0 that can be found in the
+// LICENSE file in the root directory of this source tree.
+
+#include "src/graphic/mipmap_cache.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+#include "src/utils/no_destructor.hpp"
+
+namespace skity {
+
+namespace {
+
+// Spreads the four 8-bit channels of a pixel into 16-bit lanes, so four
+// pixels can be summed without overflow in one 64-bit add per pixel.
+inline uint64_t Expand(uint32_t pixel) {
+  uint64_t v = pixel;
+  return (v | (v << 24)) & 0x00FF00FF00FF00FFull;
+}
+
+inline uint32_t Compact(uint64_t v) {
+  return static_cast<uint32_t>(v | (v >> 24));
+}
+
+inline uint32_t Average4(uint32_t a, uint32_t b, uint32_t c, uint32_t d) {
+  uint64_t sum = Expand(a) + Expand(b) + Expand(c) + Expand(d);
+  sum = ((sum + 0x0002000200020002ull) >> 2) & 0x00FF00FF00FF00FFull;
+  return Compact(sum);
+}
+
+inline uint32_t LoadPixel(const uint8_t* row, uint32_t x) {
+  uint32_t pixel;
+  std::memcpy(&pixel, row + x * 4, sizeof(pixel));
+  return pixel;
+}
+
+void Downsample(const Pixmap& src, Pixmap* dst) {
+  const uint32_t src_w = src.Width();
+  const uint32_t src_h = src.Height();
+  const auto* src_pixels = static_cast<const uint8_t*>(src.Addr());
+
+  for (uint32_t y = 0; y < dst->Height(); y++) {
+    const uint8_t* row0 = src_pixels + std::min(y * 2, src_h - 1) *
+                                           src.RowBytes();
+    const uint8_t* row1 = src_pixels + std::min(y * 2 + 1, src_h - 1) *
+                                           src.RowBytes();
+    auto* out = reinterpret_cast<uint32_t*>(dst->WritableAddr8(0, y));
+
+    for (uint32_t x = 0; x < dst->Width(); x++) {
+      uint32_t x0 = std::min(x * 2, src_w - 1);
+      uint32_t x1 = std::min(x * 2 + 1, src_w - 1);
+      out[x] = Average4(LoadPixel(row0, x0), LoadPixel(row0, x1),
+                        LoadPixel(row1, x0), LoadPixel(row1, x1));
+    }
+  }
+}
+
+}  // namespace
+
+std::shared_ptr<Mipmap> Mipmap::Build(const Pixmap& base) {
+  if (base.GetColorType() != ColorType::kRGBA &&
+      base.GetColorType() != ColorType::kBGRA) {
+    return nullptr;
+  }
+
+  if (base.Addr() == nullptr || (base.Width() <= 1 && base.Height() <= 1)) {
+    return nullptr;
+  }
+
+  auto mipmap = std::make_shared<Mipmap>();
+  const Pixmap* prev = &base;
+  while (prev->Width() > 1 || prev->Height() > 1) {
+    auto level = std::make_shared<Pixmap>(
+        std::max(prev->Width() / 2, 1u), std::max(prev->Height() / 2, 1u),
+        base.GetAlphaType(), base.GetColorType());
+    Downsample(*prev, level.get());
+
+    mipmap->byte_size_ += level->RowBytes() * level->Height();
+    mipmap->levels_.emplace_back(std::move(level));
+    prev = mipmap->levels_.back().get();
+  }
+
+  return mipmap;
+}
+
+float ComputeMipmapLevel(const Matrix& device_to_unit, uint32_t width,
+                         uint32_t height) {
+  // Texels covered by one device pixel step along x and along y.
+  float dx = std::hypot(device_to_unit.GetScaleX() * width,
+                        device_to_unit.GetSkewY() * height);
+  float dy = std::hypot(device_to_unit.GetSkewX() * width,
+                        device_to_unit.GetScaleY() * height);
+  float footprint = std::max(dx, dy);
+
+  if (!(footprint > 1.f) || !std::isfinite(footprint)) {
+    return 0.f;
+  }
+
+  return std::log2(footprint);
+}
+
+MipmapCache& MipmapCache::GetInstance() {
+  static NoDestructor<MipmapCache> instance;
+  return *instance;
+}
+
+MipmapCache::MipmapCache()
+    : cache_(kDefaultMaxBytes, [](const std::shared_ptr<const Mipmap>& mipmap) {
+        return mipmap->GetByteSize();
+      }),
+      listener_(std::make_shared<PixelsListener>(this)) {}
+
+std::shared_ptr<const Mipmap> MipmapCache::FindOrCreate(Pixmap& pixmap) {
+  // Built outside the cache lock, big images take a while and other draws
+  // should not wait for them.
+  bool hit = false;
+  auto mipmap = cache_.FindOrCreate(
+      pixmap.GetID(),
+      [&]() { return std::shared_ptr<const Mipmap>(Mipmap::Build(pixmap)); },
+      &hit);
+
+  if (mipmap && !hit) {
+    std::lock_guard<std::mutex> lock(listener_->mutex);
+    pixmap.AddPixelsChangeListener(listener_);
+  }
+
+  return mipmap;
+}
+
+size_t MipmapCache::GetCachedBytes() const { return cache_.GetTotalSize(); }
+
+void MipmapCache::SetMaxBytes(size_t max_bytes) {
+  cache_.SetMaxSize(max_bytes);
+}
+
+void MipmapCache::Clear() { cache_.Clear(); }
+
+void MipmapCache::PixelsListener::OnPixelsChange(uint32_t id) {
+  cache->cache_.Remove(id);
+}
+
+}  // namespace skity
@@ -0,0 +1,105 @@
+// Copyright 2021 The Lynx Authors. All rights reserved.
+// Licensed under the Apache License Version 2.0 that can be found in the
+// LICENSE file in the root directory of this source tree.
+
+#ifndef SRC_GRAPHIC_MIPMAP_CACHE_HPP
+#define SRC_GRAPHIC_MIPMAP_CACHE_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <skity/geometry/matrix.hpp>
+#include <skity/io/pixmap.hpp>
+#include <vector>
+
+#include "src/base/lru_cache.hpp"
+
+namespace skity {
+
+/**
+ * Downscaled copies of a pixmap, each level half the size of the previous one
+ * down to 1x1. Level 0 is the pixmap itself and is not stored.
+ */
+class Mipmap {
+ public:
+  /**
+   * Builds all levels of `base` with a 2x2 box filter. Returns nullptr for
+   * pixmaps which are not 32-bit RGBA or BGRA or are already 1x1.
+   */
+  static std::shared_ptr<Mipmap> Build(const Pixmap& base);
+
+  /**
+   * Number of levels including the base level.
+   */
+  uint32_t GetLevelCount() const {
+    return static_cast<uint32_t>(levels_.size()) + 1;
+  }
+
+  /**
+   * Returns the pixmap of `level`, which must be in [1, GetLevelCount()).
+   */
+  const std::shared_ptr<Pixmap>& GetLevel(uint32_t level) const {
+    return levels_[level - 1];
+  }
+
+  size_t GetByteSize() const { return byte_size_; }
+
+ private:
+  std::vector<std::shared_ptr<Pixmap>> levels_ = {};
+  size_t byte_size_ = 0;
+};
+
+/**
+ * Level of detail when sampling a `width` x `height` image through
+ * `device_to_unit`, which maps device pixels to normalized texture
+ * coordinates. Values at or below 0 mean the image is not minified.
+ */
+float ComputeMipmapLevel(const Matrix& device_to_unit, uint32_t width,
+                         uint32_t height);
+
+/**
+ * Process wide cache of mip pyramids keyed by the generation id of the source
+ * pixmap, so an image drawn downscaled every frame builds its levels once.
+ * The cache listens to every pixmap it holds a pyramid for and drops the
+ * pyramid as soon as the pixels change or the pixmap is freed.
+ */
+class MipmapCache {
+ public:
+  static constexpr size_t kDefaultMaxBytes = 32 * 1024 * 1024;
+
+  static MipmapCache& GetInstance();
+
+  MipmapCache();
+
+  /**
+   * Returns the pyramid of `pixmap`, building it on first use. Returns
+   * nullptr if the pixmap can not be mipmapped.
+   */
+  std::shared_ptr<const Mipmap> FindOrCreate(Pixmap& pixmap);
+
+  size_t GetCachedBytes() const;
+
+  void SetMaxBytes(size_t max_bytes);
+
+  void Clear();
+
+ private:
+  struct PixelsListener : public Pixmap::PixelsChangeListener {
+    explicit PixelsListener(MipmapCache* cache) : cache(cache) {}
+
+    void OnPixelsChange(uint32_t id) override;
+
+    MipmapCache* cache;
+    // Pixmap listener lists are not thread safe, raster threads sharing an
+    // image register through this lock.
+    std::mutex mutex = {};
+  };
+
+  SizedLRUCache<uint32_t, std::shared_ptr<const Mipmap>> cache_;
+  std::shared_ptr<PixelsListener> listener_;
+};
+
+}  // namespace skity
+
+#endif  // SRC_GRAPHIC_MIPMAP_CACHE_HPP
@@ -0,0 +1,40 @@
+// Copyright 2021 The Lynx Authors. All rights reserved.
+// Licensed under the Apache License Version 2.0 that can be found in the
+// LICENSE file in the root directory of this source tree.
+
+#include "src/graphic/path_geometry_key.hpp"
+
+#include <algorithm>
+
+#include "src/base/hash.hpp"
+
+namespace skity {
+
+PathGeometryKey PathGeometryKey::From(const Path& path) {
+  size_t conic_count =
+      std::count(path.VerbsBegin(), path.VerbsEnd(), Path::Verb::kConic);
+
+  PathGeometryKey key;
+  key.verbs.assign(path.VerbsBegin(), path.VerbsEnd());
+  key.points.assign(path.Points(), path.Points() + path.CountPoints());
+  key.conic_weights.assign(path.ConicWeights(),
+                           path.ConicWeights() + conic_count);
+  return key;
+}
+
+size_t PathGeometryKey::Hash() const {
+  // The arrays are hashed bitwise, so geometry which only differs in the sign
+  // of a zero hashes apart and misses instead of sharing an entry.
+  uint32_t hash = Hash32(verbs.data(), verbs.size() * sizeof(Path::Verb));
+  hash = Hash32(points.data(), points.size() * sizeof(Point), hash);
+  hash = Hash32(conic_weights.data(), conic_weights.size() * sizeof(float),
+                hash);
+  return hash;
+}
+
+size_t PathGeometryKey::GetByteSize() const {
+  return verbs.size() * sizeof(Path::Verb) + points.size() * sizeof(Point) +
+         conic_weights.size() * sizeof(float);
+}
+
+}  // namespace skity
@@ -0,0 +1,39 @@
+// Copyright 2021 The Lynx Authors. All rights reserved.
+// Licensed under the Apache License Version 2.0 that can be found in the
+// LICENSE file in the root directory of this source tree.
+
+#ifndef SRC_GRAPHIC_PATH_GEOMETRY_KEY_HPP
+#define SRC_GRAPHIC_PATH_GEOMETRY_KEY_HPP
+
+#include <cstddef>
+#include <skity/graphic/path.hpp>
+#include <vector>
+
+namespace skity {
+
+/**
+ * A copy of the verbs, points and conic weights of a path, for caches of
+ * results derived from path geometry. Paths carry no generation id and
+ * Path::operator== compares storage identity, so equal geometry is the
+ * identity these caches key on.
+ */
+struct PathGeometryKey {
+  std::vector<Path::Verb> verbs = {};
+  std::vector<Point> points = {};
+  std::vector<float> conic_weights = {};
+
+  static PathGeometryKey From(const Path& path);
+
+  size_t Hash() const;
+
+  size_t GetByteSize() const;
+
+  bool operator==(const PathGeometryKey& other) const {
+    return verbs == other.verbs && points == other.points &&
+           conic_weights == other.conic_weights;
+  }
+};
+
+}  // namespace skity
+
+#endif  // SRC_GRAPHIC_PATH_GEOMETRY_KEY_HPP
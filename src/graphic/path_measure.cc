@@ -5,26 +5,24 @@
 #include <skity/graphic/path_measure.hpp>
 
 #include "src/graphic/contour_measure.hpp"
+#include "src/graphic/contour_measure_cache.hpp"
 
 namespace skity {
 PathMeasure::PathMeasure() = default;
 
 PathMeasure::PathMeasure(Path const& path, bool forceClosed, float resScale)
-    : iter_(new ContourMeasureIter(path, forceClosed, resScale)) {
-  contour_ = iter_->next();
+    : measurement_(ContourMeasureCache::GetInstance().FindOrCreate(
+          path, forceClosed, resScale)) {
+  contour_ = measurement_->GetContour(contour_index_);
 }
 
 PathMeasure::~PathMeasure() = default;
 
 void PathMeasure::SetPath(const Path* path, bool forceClosed) {
-  if (!iter_) {
-    skity::Path tmp{};
-    iter_ = std::make_unique<ContourMeasureIter>(path != nullptr ? *path : tmp,
-                                                 forceClosed, 1.f);
-  }
-
-  iter_->reset(path ? *path : Path{}, forceClosed);
-  contour_ = iter_->next();
+  measurement_ = ContourMeasureCache::GetInstance().FindOrCreate(
+      path ? *path : Path{}, forceClosed, 1.f);
+  contour_index_ = 0;
+  contour_ = measurement_->GetContour(contour_index_);
 }
 
 float PathMeasure::GetLength() {
@@ -39,6 +37,12 @@ bool PathMeasure::GetPosTan(float distance, Point* position, Vector* tangent) {
   return contour_ && contour_->getPosTan(distance, position, tangent);
 }
 
+bool PathMeasure::GetPosTan(const float distances[], int32_t count,
+                            Point positions[], Vector tangents[]) {
+  return contour_ &&
+         contour_->getPosTan(distances, count, positions, tangents);
+}
+
 bool PathMeasure::GetSegment(float startD, float stopD, Path* dst,
                              bool startWithMoveTo) {
   return contour_ && contour_->getSegment(startD, stopD, dst, startWithMoveTo);
@@ -47,7 +51,11 @@ bool PathMeasure::GetSegment(float startD, float stopD, Path* dst,
 bool PathMeasure::IsClosed() { return contour_ && contour_->isClosed(); }
 
 bool PathMeasure::NextContour() {
-  contour_ = iter_->next();
+  if (!measurement_) {
+    return false;
+  }
+
+  contour_ = measurement_->GetContour(++contour_index_);
   return !!contour_;
 }
 
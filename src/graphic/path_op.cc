@@ -28,4 +28,14 @@ bool PathOp::Execute(const Path &one, const Path &two, Op op, Path *result) {
   return false;
 }
 
+bool PathOp::Union(const std::vector<Path> &paths, Path *result) {
+  if (result == nullptr) {
+    return false;
+  }
+
+  PathOpEngine engine{};
+
+  return engine.UnionAll(paths, result);
+}
+
 }  // namespace skity
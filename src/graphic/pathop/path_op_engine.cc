@@ -4,6 +4,11 @@
 
 #include "src/graphic/pathop/path_op_engine.hpp"
 
+#include <algorithm>
+#include <atomic>
+#include <numeric>
+#include <thread>
+
 #include "src/graphic/path_visitor.hpp"
 #include "src/graphic/pathop/clipper2/core.h"
 #include "src/graphic/pathop/clipper2/engine.h"
@@ -175,6 +180,307 @@ bool PathOpEngine::ExecuteInternal(Path const &one, Path const &two,
   return true;
 }
 
+namespace {
+
+constexpr size_t kMaxUnionThreadCount = 8;
+
+// Inputs unioned by a single Clipper2 pass before partial results are reduced
+// pairwise. Small enough to give every worker something to do, large enough
+// that the pairwise rounds stay few.
+constexpr size_t kUnionChunkSize = 32;
+
+// Runs fn(0) ... fn(count - 1) on the threads chosen by
+// PathOpEngine::GetUnionThreadCount for `point_count` points of work, the
+// calling thread included.
+template <typename Fn>
+void ParallelFor(size_t count, size_t point_count, Fn const &fn) {
+  size_t thread_count = PathOpEngine::GetUnionThreadCount(count, point_count);
+  if (thread_count <= 1) {
+    for (size_t i = 0; i < count; i++) {
+      fn(i);
+    }
+    return;
+  }
+
+  std::atomic<size_t> next{0};
+  auto worker = [&]() {
+    for (size_t i = next++; i < count; i = next++) {
+      fn(i);
+    }
+  };
+
+  std::vector<std::thread> threads;
+  threads.reserve(thread_count - 1);
+  for (size_t i = 1; i < thread_count; i++) {
+    threads.emplace_back(worker);
+  }
+  worker();
+  for (auto &thread : threads) {
+    thread.join();
+  }
+}
+
+size_t CountPoints(Clipper2Lib::PathsD const &paths) {
+  size_t count = 0;
+  for (auto const &path : paths) {
+    count += path.size();
+  }
+  return count;
+}
+
+// Touching bounds count as overlapping, adjacent shapes need to be merged.
+bool BoundsOverlap(Rect const &a, Rect const &b) {
+  return a.Left() <= b.Right() && b.Left() <= a.Right() &&
+         a.Top() <= b.Bottom() && b.Top() <= a.Bottom();
+}
+
+Rect JoinBounds(Rect const &a, Rect const &b) {
+  return Rect::MakeLTRB(std::min(a.Left(), b.Left()),
+                        std::min(a.Top(), b.Top()),
+                        std::max(a.Right(), b.Right()),
+                        std::max(a.Bottom(), b.Bottom()));
+}
+
+size_t FindRoot(std::vector<size_t> *parents, size_t i) {
+  auto &p = *parents;
+  while (p[i] != i) {
+    p[i] = p[p[i]];
+    i = p[i];
+  }
+  return i;
+}
+
+// Groups indices of `bounds` which overlap, directly or through others, with
+// a sweep along x.
+std::vector<std::vector<size_t>> PartitionByBounds(
+    std::vector<Rect> const &bounds) {
+  std::vector<size_t> order(bounds.size());
+  std::iota(order.begin(), order.end(), 0);
+  std::sort(order.begin(), order.end(), [&](size_t a, size_t b) {
+    return bounds[a].Left() < bounds[b].Left();
+  });
+
+  std::vector<size_t> parents(bounds.size());
+  std::iota(parents.begin(), parents.end(), 0);
+
+  std::vector<size_t> active;
+  for (size_t index : order) {
+    const Rect &rect = bounds[index];
+
+    active.erase(std::remove_if(active.begin(), active.end(),
+                                [&](size_t other) {
+                                  return bounds[other].Right() < rect.Left();
+                                }),
+                 active.end());
+
+    for (size_t other : active) {
+      if (BoundsOverlap(bounds[other], rect)) {
+        parents[FindRoot(&parents, index)] = FindRoot(&parents, other);
+      }
+    }
+
+    active.push_back(index);
+  }
+
+  std::vector<std::vector<size_t>> groups;
+  std::vector<size_t> group_of_root(bounds.size(), bounds.size());
+  for (size_t index : order) {
+    size_t root = FindRoot(&parents, index);
+    if (group_of_root[root] == bounds.size()) {
+      group_of_root[root] = groups.size();
+      groups.emplace_back();
+    }
+    groups[group_of_root[root]].push_back(index);
+  }
+
+  return groups;
+}
+
+struct PartialUnion {
+  Clipper2Lib::PathsD paths = {};
+  Rect bounds = {};
+};
+
+bool UnionPaths(Clipper2Lib::PathsD const *const inputs[], size_t count,
+                Clipper2Lib::PathsD *solution) {
+  Clipper2Lib::ClipperD clipper;
+  for (size_t i = 0; i < count; i++) {
+    clipper.AddSubject(*inputs[i]);
+  }
+
+  return clipper.Execute(Clipper2Lib::ClipType::Union,
+                         Clipper2Lib::FillRule::NonZero, *solution);
+}
+
+}  // namespace
+
+size_t PathOpEngine::GetUnionThreadCount(size_t task_count,
+                                         size_t point_count) {
+  size_t hardware_count =
+      std::max<size_t>(std::thread::hardware_concurrency(), 1);
+  size_t work_count = point_count / kMinPointsPerUnionThread;
+  return std::max<size_t>(
+      std::min({task_count, hardware_count, kMaxUnionThreadCount, work_count}),
+      1);
+}
+
+bool PathOpEngine::UnionAll(std::vector<Path> const &paths, Path *result) {
+  if (result == nullptr) {
+    return false;
+  }
+
+  std::vector<const Path *> inputs;
+  std::vector<Rect> bounds;
+  size_t point_count = 0;
+  for (auto const &path : paths) {
+    if (!path.IsEmpty()) {
+      inputs.push_back(&path);
+      point_count += path.CountPoints();
+      // Computed here, the bounds cache of a path is not thread safe.
+      bounds.push_back(path.GetBounds());
+    }
+  }
+
+  if (inputs.empty()) {
+    return false;
+  }
+
+  op_type_ = PathOp::Op::kUnion;
+
+  // Each input resolved with its own fill rule first. Clipper2 outputs
+  // outlines with positive winding and holes with negative winding, so the
+  // windings of resolved inputs can be summed without cancelling out.
+  std::vector<Clipper2Lib::PathsD> resolved(inputs.size());
+  std::atomic<bool> success{true};
+  ParallelFor(inputs.size(), point_count, [&](size_t i) {
+    Clipper2Lib::ClipperD clipper;
+    clipper.AddSubject(ConvertPath(*inputs[i]));
+    if (!clipper.Execute(Clipper2Lib::ClipType::Union,
+                         FillTypeToClipper2(inputs[i]->GetFillType()),
+                         resolved[i])) {
+      success = false;
+    }
+  });
+
+  if (!success) {
+    return false;
+  }
+
+  auto groups = PartitionByBounds(bounds);
+
+  // Every group is split into chunks, each chunk becomes one partial result.
+  struct ChunkTask {
+    size_t group;
+    size_t chunk;
+  };
+  std::vector<ChunkTask> chunk_tasks;
+  std::vector<std::vector<PartialUnion>> partials(groups.size());
+  for (size_t g = 0; g < groups.size(); g++) {
+    size_t chunk_count = (groups[g].size() + kUnionChunkSize - 1) /
+                         kUnionChunkSize;
+    partials[g].resize(chunk_count);
+    for (size_t c = 0; c < chunk_count; c++) {
+      chunk_tasks.push_back(ChunkTask{g, c});
+    }
+  }
+
+  size_t resolved_point_count = 0;
+  for (auto const &paths_d : resolved) {
+    resolved_point_count += CountPoints(paths_d);
+  }
+
+  ParallelFor(chunk_tasks.size(), resolved_point_count, [&](size_t i) {
+    auto const &group = groups[chunk_tasks[i].group];
+    auto &partial = partials[chunk_tasks[i].group][chunk_tasks[i].chunk];
+    size_t begin = chunk_tasks[i].chunk * kUnionChunkSize;
+    size_t end = std::min(group.size(), begin + kUnionChunkSize);
+
+    partial.bounds = bounds[group[begin]];
+    if (end - begin == 1) {
+      partial.paths = std::move(resolved[group[begin]]);
+      return;
+    }
+
+    std::vector<const Clipper2Lib::PathsD *> chunk;
+    chunk.reserve(end - begin);
+    for (size_t k = begin; k < end; k++) {
+      chunk.push_back(&resolved[group[k]]);
+      partial.bounds = JoinBounds(partial.bounds, bounds[group[k]]);
+    }
+
+    if (!UnionPaths(chunk.data(), chunk.size(), &partial.paths)) {
+      success = false;
+    }
+  });
+
+  // Pairwise reduction, one round halves the partial results of every group.
+  struct PairTask {
+    size_t group;
+    size_t first;
+  };
+  std::vector<PairTask> pair_tasks;
+  while (success) {
+    pair_tasks.clear();
+    size_t pair_point_count = 0;
+    for (size_t g = 0; g < partials.size(); g++) {
+      for (size_t k = 0; k + 1 < partials[g].size(); k += 2) {
+        pair_tasks.push_back(PairTask{g, k});
+        pair_point_count += CountPoints(partials[g][k].paths) +
+                            CountPoints(partials[g][k + 1].paths);
+      }
+    }
+
+    if (pair_tasks.empty()) {
+      break;
+    }
+
+    ParallelFor(pair_tasks.size(), pair_point_count, [&](size_t i) {
+      auto &first = partials[pair_tasks[i].group][pair_tasks[i].first];
+      auto &second = partials[pair_tasks[i].group][pair_tasks[i].first + 1];
+
+      if (!BoundsOverlap(first.bounds, second.bounds)) {
+        first.paths.insert(first.paths.end(), second.paths.begin(),
+                           second.paths.end());
+      } else {
+        const Clipper2Lib::PathsD *pair[2] = {&first.paths, &second.paths};
+        Clipper2Lib::PathsD solution;
+        if (!UnionPaths(pair, 2, &solution)) {
+          success = false;
+        }
+        first.paths = std::move(solution);
+      }
+      first.bounds = JoinBounds(first.bounds, second.bounds);
+      second.paths.clear();
+    });
+
+    for (auto &group_partials : partials) {
+      size_t kept = 0;
+      for (size_t k = 0; k < group_partials.size(); k += 2, kept++) {
+        if (kept != k) {
+          group_partials[kept] = std::move(group_partials[k]);
+        }
+      }
+      group_partials.resize(kept);
+    }
+  }
+
+  if (!success) {
+    return false;
+  }
+
+  // Groups do not overlap, their results together are the union.
+  Clipper2Lib::PathsD solution;
+  for (auto &group_partials : partials) {
+    for (auto &path : group_partials.front().paths) {
+      solution.emplace_back(std::move(path));
+    }
+  }
+
+  *result = ConvertClipper2Path(solution);
+
+  return true;
+}
+
 Path ConvertClipper2Path(const Clipper2Lib::PathsD &paths) {
   Path result;
 
@@ -5,8 +5,10 @@
 #ifndef SRC_GRAPHIC_PATHOP_PATH_OP_ENGINE_HPP
 #define SRC_GRAPHIC_PATHOP_PATH_OP_ENGINE_HPP
 
+#include <cstddef>
 #include <skity/graphic/path.hpp>
 #include <skity/graphic/path_op.hpp>
+#include <vector>
 
 namespace skity {
 
@@ -23,6 +25,27 @@ class PathOpEngine final {
 
   bool Difference(Path const& one, Path const& two, Path* result);
 
+  /**
+   * Unions all non-empty `paths` into `result`.
+   *
+   * Inputs are grouped by overlapping bounds first. Groups which can not
+   * touch each other are never clipped against each other, their results are
+   * simply concatenated. Inside a group, chunks of inputs are unioned in
+   * parallel and the partial results reduced pairwise, also in parallel,
+   * until one is left. Stages with too few points to outweigh starting a
+   * thread run on the calling thread.
+   */
+  bool UnionAll(std::vector<Path> const& paths, Path* result);
+
+  /**
+   * Threads, the calling thread included, used by a UnionAll stage of
+   * `task_count` independent tasks touching `point_count` points in total.
+   * Every thread gets at least kMinPointsPerUnionThread points of work.
+   */
+  static size_t GetUnionThreadCount(size_t task_count, size_t point_count);
+
+  static constexpr size_t kMinPointsPerUnionThread = 2048;
+
  private:
   PathOp::Op op_type_ = PathOp::Op::kIntersect;
 
@@ -2,13 +2,16 @@
 // Licensed under the Apache License Version 2.0 that can be found in the
 // LICENSE file in the root directory of this source tree.
 
+#include <atomic>
 #include <limits>
 #include <skity/recorder/display_list.hpp>
+#include <skity/recorder/raster_cache.hpp>
 #include <type_traits>
 #include <vector>
 
 #include "src/logging.hpp"
 #include "src/recorder/display_list_rtree.hpp"
+#include "src/recorder/display_list_serializer.hpp"
 #include "src/recorder/recorded_op.hpp"
 
 namespace skity {
@@ -49,6 +52,7 @@ bool IsReplayDrawOp(RecordedOpType type) {
     case RecordedOpType::kDrawTextBlob:
     case RecordedOpType::kDrawImage:
     case RecordedOpType::kDrawGlyphs:
+    case RecordedOpType::kDrawDisplayList:
       return true;
     default:
       return false;
@@ -190,95 +194,88 @@ void ReplayRecordedOp(Canvas *canvas, const RecordedOp *op) {
                          draw_glyphs_op->m_positions_y.data(),
                          draw_glyphs_op->font, draw_glyphs_op->paint);
     } break;
+    case RecordedOpType::kDrawDisplayList: {
+      auto *draw_display_list_op = static_cast<const DrawDisplayListOp *>(op);
+      // Keep the child's matrix and clip changes out of the parent.
+      canvas->Save();
+      draw_display_list_op->display_list->Draw(canvas);
+      canvas->Restore();
+    } break;
   }
 }
 
-}  // namespace
-
-DisplayList::DisplayList() {}
-
-DisplayList::DisplayList(DisplayListStorage &&storage, size_t byte_count,
-                         uint32_t op_count, const Rect &bounds,
-                         uint32_t properties)
-    : storage_(std::move(storage)),
-      byte_count_(byte_count),
-      op_count_(op_count),
-      bounds_(bounds),
-      properties_(properties) {}
-
-DisplayList::~DisplayList() {
-  uint8_t *ptr = const_cast<DisplayListStorage &>(storage_).get();
-  DisposeOps(ptr, ptr + byte_count_);
+uint64_t NextDisplayListID() {
+  static std::atomic<uint64_t> next_id{1};
+  return next_id.fetch_add(1, std::memory_order_relaxed);
 }
 
-Paint *DisplayList::GetOpPaintByOffset(RecordedOpOffset offset) {
-  if (!offset.IsValid()) {
-    return nullptr;
-  }
-
-  uint8_t *start = const_cast<DisplayListStorage &>(storage_).get();
-  uint8_t *end = start + byte_count_;
-  uint8_t *ptr = start + offset.GetValue();
-  if (ptr < start || ptr >= end) {
-    return nullptr;
+// Rough relative replay cost of an op, used for raster cache admission.
+uint32_t GetOpComplexity(RecordedOpType type) {
+  switch (type) {
+    case RecordedOpType::kClipPath:
+    case RecordedOpType::kDrawPath:
+    case RecordedOpType::kDrawTextBlob:
+    case RecordedOpType::kDrawGlyphs:
+      return 4;
+    case RecordedOpType::kSaveLayer:
+      return 8;
+    default:
+      return IsReplayDrawOp(type) ? 1 : 0;
   }
+}
 
-  auto op = reinterpret_cast<RecordedOp *>(ptr);
+const Paint *GetOpPaint(const RecordedOp *op) {
   switch (op->type) {
     case RecordedOpType::kDrawLine: {
-      struct DrawLineOp *drawLineOp = static_cast<struct DrawLineOp *>(op);
+      const auto *drawLineOp = static_cast<const DrawLineOp *>(op);
       return &drawLineOp->paint;
     } break;
     case RecordedOpType::kDrawCircle: {
-      struct DrawCircleOp *drawCircleOp =
-          static_cast<struct DrawCircleOp *>(op);
+      const auto *drawCircleOp = static_cast<const DrawCircleOp *>(op);
       return &drawCircleOp->paint;
     } break;
     case RecordedOpType::kDrawArc: {
-      struct DrawArcOp *drawArcOp = static_cast<struct DrawArcOp *>(op);
+      const auto *drawArcOp = static_cast<const DrawArcOp *>(op);
       return &drawArcOp->paint;
     } break;
     case RecordedOpType::kDrawOval: {
-      struct DrawOvalOp *drawOvalOp = static_cast<struct DrawOvalOp *>(op);
+      const auto *drawOvalOp = static_cast<const DrawOvalOp *>(op);
       return &drawOvalOp->paint;
     } break;
     case RecordedOpType::kDrawRect: {
-      struct DrawRectOp *drawRectOp = static_cast<struct DrawRectOp *>(op);
+      const auto *drawRectOp = static_cast<const DrawRectOp *>(op);
       return &drawRectOp->paint;
     } break;
     case RecordedOpType::kDrawRRect: {
-      struct DrawRRectOp *drawRRectOp = static_cast<struct DrawRRectOp *>(op);
+      const auto *drawRRectOp = static_cast<const DrawRRectOp *>(op);
       return &drawRRectOp->paint;
     } break;
     case RecordedOpType::kDrawRoundRect: {
-      struct DrawRoundRectOp *drawRoundRectOp =
-          static_cast<struct DrawRoundRectOp *>(op);
+      const auto *drawRoundRectOp = static_cast<const DrawRoundRectOp *>(op);
       return &drawRoundRectOp->paint;
     } break;
     case RecordedOpType::kDrawPath: {
-      struct DrawPathOp *drawPathOp = static_cast<struct DrawPathOp *>(op);
+      const auto *drawPathOp = static_cast<const DrawPathOp *>(op);
       return &drawPathOp->paint;
     } break;
     case RecordedOpType::kDrawPaint: {
-      struct DrawPaintOp *drawPaintOp = static_cast<struct DrawPaintOp *>(op);
+      const auto *drawPaintOp = static_cast<const DrawPaintOp *>(op);
       return &drawPaintOp->paint;
     } break;
     case RecordedOpType::kSaveLayer: {
-      struct SaveLayerOp *saveLayerOp = static_cast<struct SaveLayerOp *>(op);
+      const auto *saveLayerOp = static_cast<const SaveLayerOp *>(op);
       return &saveLayerOp->paint;
     } break;
     case RecordedOpType::kDrawTextBlob: {
-      struct DrawTextBlobOp *drawTextBlobOp =
-          static_cast<struct DrawTextBlobOp *>(op);
+      const auto *drawTextBlobOp = static_cast<const DrawTextBlobOp *>(op);
       return &drawTextBlobOp->paint;
     } break;
     case RecordedOpType::kDrawImage: {
-      struct DrawImageOp *drawImageOp = static_cast<struct DrawImageOp *>(op);
+      const auto *drawImageOp = static_cast<const DrawImageOp *>(op);
       return &drawImageOp->paint;
     } break;
     case RecordedOpType::kDrawGlyphs: {
-      struct DrawGlyphsOp *drawGlyphsOp =
-          static_cast<struct DrawGlyphsOp *>(op);
+      const auto *drawGlyphsOp = static_cast<const DrawGlyphsOp *>(op);
       return &drawGlyphsOp->paint;
     } break;
     default:
@@ -286,6 +283,61 @@ Paint *DisplayList::GetOpPaintByOffset(RecordedOpOffset offset) {
   }
 }
 
+// A raster cache snapshot starts out transparent and is blended over the
+// canvas with src-over, which matches direct playback only for content that is
+// blended with src-over itself.
+bool IsSrcOverPaint(const Paint &paint) {
+  return paint.GetBlendMode() == BlendMode::kSrcOver;
+}
+
+}  // namespace
+
+DisplayList::DisplayList() : unique_id_(NextDisplayListID()) {}
+
+DisplayList::DisplayList(DisplayListStorage &&storage, size_t byte_count,
+                         uint32_t op_count, const Rect &bounds,
+                         uint32_t properties)
+    : storage_(std::move(storage)),
+      byte_count_(byte_count),
+      op_count_(op_count),
+      bounds_(bounds),
+      properties_(properties),
+      unique_id_(NextDisplayListID()) {}
+
+DisplayList::~DisplayList() {
+  uint8_t *ptr = const_cast<DisplayListStorage &>(storage_).get();
+  DisposeOps(ptr, ptr + byte_count_);
+}
+
+Paint *DisplayList::GetOpPaintByOffset(RecordedOpOffset offset) {
+  if (!offset.IsValid()) {
+    return nullptr;
+  }
+
+  uint8_t *start = const_cast<DisplayListStorage &>(storage_).get();
+  uint8_t *end = start + byte_count_;
+  uint8_t *ptr = start + offset.GetValue();
+  if (ptr < start || ptr >= end) {
+    return nullptr;
+  }
+
+  return const_cast<Paint *>(
+      GetOpPaint(reinterpret_cast<const RecordedOp *>(ptr)));
+}
+
+std::shared_ptr<Data> DisplayList::Serialize() const {
+  return DisplayListSerializer::Serialize(*this);
+}
+
+std::unique_ptr<DisplayList> DisplayList::MakeFromData(
+    std::shared_ptr<Data> data) {
+  return DisplayListSerializer::Deserialize(std::move(data));
+}
+
+std::unique_ptr<DisplayList> DisplayList::MakeFromFile(const char *path) {
+  return DisplayListSerializer::Deserialize(Data::MakeFromFileMapping(path));
+}
+
 void DisplayList::SetRTree(std::unique_ptr<DisplayListRTree> rtree) {
   rtree_ = std::move(rtree);
 }
@@ -342,6 +394,135 @@ void DisplayList::Draw(Canvas *canvas) const {
   }
 }
 
+void DisplayList::Draw(Canvas *canvas, RasterCache *cache) const {
+  if (canvas == nullptr) {
+    return;
+  }
+  const uint32_t end = static_cast<uint32_t>(byte_count_);
+  if (cache != nullptr && cache->Draw(*this, 0, end, bounds_, canvas)) {
+    return;
+  }
+  DrawOps(canvas, 0, end, cache);
+}
+
+void DisplayList::DrawOps(Canvas *canvas, uint32_t begin, uint32_t end,
+                          RasterCache *cache) const {
+  const uint8_t *start = storage_.get();
+  uint32_t offset = begin;
+  while (offset < end) {
+    auto op = reinterpret_cast<const RecordedOp *>(start + offset);
+    offset += op->size;
+    if (cache == nullptr) {
+      ReplayRecordedOp(canvas, op);
+      continue;
+    }
+
+    if (op->type == RecordedOpType::kSaveLayer) {
+      // A layer scope covers the SaveLayer op up to and including its Restore.
+      auto *save_layer_op = static_cast<const SaveLayerOp *>(op);
+      const int32_t restore_offset = save_layer_op->restore_offset;
+      if (restore_offset >= static_cast<int32_t>(offset) &&
+          static_cast<uint32_t>(restore_offset) < end) {
+        auto restore_op =
+            reinterpret_cast<const RecordedOp *>(start + restore_offset);
+        const uint32_t scope_begin = offset - op->size;
+        const uint32_t scope_end = restore_offset + restore_op->size;
+        const Paint &layer_paint = save_layer_op->paint;
+        if (restore_op->type == RecordedOpType::kRestore &&
+            IsSrcOverPaint(layer_paint) &&
+            layer_paint.GetImageFilter() == nullptr) {
+          if (cache->Draw(*this, scope_begin, scope_end, save_layer_op->bounds,
+                          canvas)) {
+            offset = scope_end;
+            continue;
+          }
+        } else if (restore_op->type == RecordedOpType::kRestore) {
+          // The layer reads the backdrop or draws outside its bounds, so it
+          // is composited by the canvas every time. Only its content, which
+          // starts from a transparent layer too, comes from the cache. The
+          // layer is as large as the filtered bounds.
+          ReplayRecordedOp(canvas, op);
+          Paint fill_paint = layer_paint;
+          fill_paint.SetStyle(Paint::kFill_Style);
+          if (cache->Draw(*this, offset, restore_offset,
+                          fill_paint.ComputeFastBounds(save_layer_op->bounds),
+                          canvas)) {
+            ReplayRecordedOp(canvas, restore_op);
+            offset = scope_end;
+          }
+          continue;
+        }
+      }
+    } else if (op->type == RecordedOpType::kDrawDisplayList) {
+      auto *draw_display_list_op = static_cast<const DrawDisplayListOp *>(op);
+      canvas->Save();
+      draw_display_list_op->display_list->Draw(canvas, cache);
+      canvas->Restore();
+      continue;
+    }
+    ReplayRecordedOp(canvas, op);
+  }
+}
+
+bool DisplayList::ComputeComplexity(uint32_t begin, uint32_t end,
+                                    uint32_t *complexity) const {
+  *complexity = 0;
+  const uint8_t *start = storage_.get();
+  uint32_t offset = begin;
+  // Whether each open save is a layer, and how many of them are layers. Ops
+  // outside any layer of the range are blended straight onto the canvas.
+  std::vector<bool> saves;
+  uint32_t layer_depth = 0;
+  while (offset < end) {
+    auto op = reinterpret_cast<const RecordedOp *>(start + offset);
+    offset += op->size;
+
+    const Paint *paint = GetOpPaint(op);
+    if (paint != nullptr && layer_depth == 0 && !IsSrcOverPaint(*paint)) {
+      return false;
+    }
+
+    switch (op->type) {
+      case RecordedOpType::kSetMatrix:
+      case RecordedOpType::kResetMatrix:
+        return false;
+      case RecordedOpType::kSave:
+        saves.push_back(false);
+        break;
+      case RecordedOpType::kSaveLayer:
+        // Filter output is not part of the recorded bounds.
+        if (paint->GetImageFilter() != nullptr) {
+          return false;
+        }
+        saves.push_back(true);
+        layer_depth++;
+        *complexity += GetOpComplexity(op->type);
+        break;
+      case RecordedOpType::kRestore:
+        if (!saves.empty()) {
+          layer_depth -= saves.back() ? 1 : 0;
+          saves.pop_back();
+        }
+        break;
+      case RecordedOpType::kDrawDisplayList: {
+        auto *draw_display_list_op = static_cast<const DrawDisplayListOp *>(op);
+        const DisplayList *child = draw_display_list_op->display_list.get();
+        uint32_t child_complexity = 0;
+        if (!child->ComputeComplexity(
+                0, static_cast<uint32_t>(child->byte_count_),
+                &child_complexity)) {
+          return false;
+        }
+        *complexity += child_complexity;
+      } break;
+      default:
+        *complexity += GetOpComplexity(op->type);
+        break;
+    }
+  }
+  return true;
+}
+
 void DisplayList::Draw(Canvas *canvas, const Rect &cull_rect) const {
   if (canvas == nullptr) {
     return;
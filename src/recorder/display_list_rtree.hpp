@@ -21,6 +21,11 @@ class DisplayListRTree {
   std::vector<Rect> SearchNonOverlappingDrawnRects(const Rect& rect) const;
 
  private:
+  friend class DisplayListSerializer;
+
+  // Used by DisplayListSerializer, which restores the tree tables directly.
+  DisplayListRTree() = default;
+
   struct RTreeNode {
     Rect bounds = Rect::MakeEmpty();
     uint32_t first_child = 0;
@@ -0,0 +1,1593 @@
+// Copyright 2021 The Lynx Authors. All rights reserved.
+// Licensed under the Apache License Version 2.0 that can be found in the
+// LICENSE file in the root directory of this source tree.
+
+#include "src/recorder/display_list_serializer.hpp"
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+#include <new>
+#include <skity/effect/shader.hpp>
+#include <skity/graphic/image.hpp>
+#include <skity/io/pixmap.hpp>
+#include <skity/text/typeface.hpp>
+#include <type_traits>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "src/base/hash.hpp"
+#include "src/effect/gradient_shader.hpp"
+#include "src/effect/pixmap_shader.hpp"
+#include "src/logging.hpp"
+#include "src/recorder/display_list_rtree.hpp"
+#include "src/recorder/recorded_op.hpp"
+
+namespace skity {
+
+namespace {
+
+// "SKDL" read as a little endian uint32_t. A file written on a machine with
+// a different byte order fails the magic check.
+constexpr uint32_t kDisplayListMagic = 0x4C444B53;
+constexpr uint32_t kNoIndex = std::numeric_limits<uint32_t>::max();
+constexpr size_t kSectionAlignment = 8;
+
+enum class Section : uint32_t {
+  kOps,
+  kFixups,
+  kTypefaces,
+  kImages,
+  kShaders,
+  kPaints,
+  kPaths,
+  kGlyphRuns,
+  kTextBlobs,
+  kDisplayLists,
+  kRTree,
+  kCount,
+};
+
+constexpr size_t kSectionCount = static_cast<size_t>(Section::kCount);
+
+struct SectionEntry {
+  uint64_t offset = 0;
+  uint64_t size = 0;
+};
+
+struct FileHeader {
+  uint32_t magic = kDisplayListMagic;
+  uint32_t version = DisplayListSerializer::kVersion;
+  uint32_t layout_hash = 0;
+  uint32_t op_count = 0;
+  uint64_t byte_count = 0;
+  float bounds[4] = {};
+  uint32_t properties = 0;
+  uint32_t has_rtree = 0;
+  SectionEntry sections[kSectionCount] = {};
+};
+
+// One entry per op that owns heap resources. Entries are sorted by offset.
+struct OpFixup {
+  uint32_t offset = 0;
+  uint32_t paint = kNoIndex;
+  uint32_t resource = kNoIndex;
+  uint32_t reserved = 0;
+};
+
+struct FlatPaint {
+  uint8_t style = 0;
+  uint8_t cap = 0;
+  uint8_t join = 0;
+  uint8_t flags = 0;
+  uint32_t blend_mode = 0;
+  float stroke_width = 0.f;
+  float miter_limit = 0.f;
+  float text_size = 0.f;
+  float font_threshold = 0.f;
+  float fill_color[4] = {};
+  float stroke_color[4] = {};
+  uint32_t shader = kNoIndex;
+  uint32_t typeface = kNoIndex;
+};
+
+enum FlatPaintFlags : uint8_t {
+  kAntiAlias_FlatPaintFlag = 1 << 0,
+  kSDFForSmallText_FlatPaintFlag = 1 << 1,
+  kAdjustStroke_FlatPaintFlag = 1 << 2,
+};
+
+struct FlatFont {
+  uint32_t typeface = kNoIndex;
+  float size = 0.f;
+  float scale_x = 0.f;
+  float skew_x = 0.f;
+  uint8_t flags = 0;
+  uint8_t edging = 0;
+  uint8_t hinting = 0;
+  uint8_t reserved = 0;
+};
+
+enum FlatFontFlags : uint8_t {
+  kForceAutoHinting_FlatFontFlag = 1 << 0,
+  kEmbeddedBitmaps_FlatFontFlag = 1 << 1,
+  kSubpixel_FlatFontFlag = 1 << 2,
+  kLinearMetrics_FlatFontFlag = 1 << 3,
+  kEmbolden_FlatFontFlag = 1 << 4,
+  kBaselineSnap_FlatFontFlag = 1 << 5,
+};
+
+// Shader kinds share the numbering of Shader::GradientType, image shaders are
+// stored after the gradient types.
+constexpr uint32_t kImageShaderKind = Shader::kConical + 1;
+
+struct FlatTextBlob {
+  uint32_t first_run = 0;
+  uint32_t run_count = 0;
+};
+
+struct FlatImage {
+  uint32_t width = 0;
+  uint32_t height = 0;
+  uint32_t alpha_type = 0;
+  uint32_t color_type = 0;
+  uint64_t row_bytes = 0;
+};
+
+// Returns 0 for kUnknown and for values no ColorType has, which a loaded
+// image must not use.
+size_t FlatBytesPerPixel(uint32_t color_type) {
+  switch (color_type) {
+    case static_cast<uint32_t>(ColorType::kRGBA):
+    case static_cast<uint32_t>(ColorType::kBGRA):
+      return 4;
+    case static_cast<uint32_t>(ColorType::kRGB565):
+      return 2;
+    case static_cast<uint32_t>(ColorType::kA8):
+      return 1;
+    default:
+      return 0;
+  }
+}
+
+struct FlatRTreeNode {
+  float bounds[4] = {};
+  uint32_t first_child = 0;
+  uint32_t child_count = 0;
+  uint32_t leaf = 0;
+};
+
+struct FlatSpatialOp {
+  float bounds[4] = {};
+  int32_t offset = 0;
+};
+
+constexpr uint32_t MixLayout(uint32_t hash, uint32_t value) {
+  return (hash ^ value) * 16777619u;
+}
+
+// Fingerprint of everything the raw op buffer depends on. A file is only
+// accepted by a build whose op structs have the same layout.
+constexpr uint32_t ComputeOpLayoutHash() {
+  uint32_t hash = 2166136261u;
+#define MIX_OP_LAYOUT(name)                                         \
+  hash = MixLayout(hash, static_cast<uint32_t>(sizeof(name##Op))); \
+  hash = MixLayout(hash, static_cast<uint32_t>(alignof(name##Op)));
+  FOR_EACH_RECORDED_OP(MIX_OP_LAYOUT)
+#undef MIX_OP_LAYOUT
+  hash = MixLayout(hash, static_cast<uint32_t>(sizeof(void *)));
+  hash = MixLayout(hash, static_cast<uint32_t>(sizeof(FileHeader)));
+  return hash;
+}
+
+constexpr uint32_t kOpLayoutHash = ComputeOpLayoutHash();
+
+constexpr size_t AlignUp(size_t value, size_t alignment) {
+  return (value + alignment - 1) / alignment * alignment;
+}
+
+void WriteRect(const Rect &rect, float out[4]) {
+  out[0] = rect.Left();
+  out[1] = rect.Top();
+  out[2] = rect.Right();
+  out[3] = rect.Bottom();
+}
+
+Rect ReadRect(const float in[4]) {
+  return Rect::MakeLTRB(in[0], in[1], in[2], in[3]);
+}
+
+}  // namespace
+
+// Growable malloc buffer. Detach() hands the allocation to a Data without
+// copying it.
+class FlatWriter {
+ public:
+  FlatWriter() = default;
+  ~FlatWriter() { std::free(data_); }
+
+  FlatWriter(const FlatWriter &) = delete;
+  FlatWriter &operator=(const FlatWriter &) = delete;
+
+  size_t Size() const { return size_; }
+  uint8_t *At(size_t offset) { return data_ + offset; }
+  const uint8_t *At(size_t offset) const { return data_ + offset; }
+
+  // Appends `bytes` zero initialized bytes and returns their offset.
+  size_t Reserve(size_t bytes) {
+    Grow(size_ + bytes);
+    size_t offset = size_;
+    if (bytes > 0) {
+      std::memset(data_ + offset, 0, bytes);
+    }
+    size_ += bytes;
+    return offset;
+  }
+
+  void Write(const void *src, size_t bytes) {
+    if (bytes == 0) {
+      return;
+    }
+    size_t offset = Reserve(bytes);
+    std::memcpy(data_ + offset, src, bytes);
+  }
+
+  template <typename T>
+  void Write(const T &value) {
+    static_assert(std::is_trivially_copyable<T>::value,
+                  "Only trivially copyable values can be written directly.");
+    Write(&value, sizeof(T));
+  }
+
+  template <typename T>
+  void WriteArray(const T *values, size_t count) {
+    Write(static_cast<uint32_t>(count));
+    Write(values, sizeof(T) * count);
+  }
+
+  void Append(const FlatWriter &other) { Write(other.data_, other.size_); }
+
+  void Align(size_t alignment = kSectionAlignment) {
+    Reserve(AlignUp(size_, alignment) - size_);
+  }
+
+  std::shared_ptr<Data> Detach() {
+    auto data = Data::MakeFromMalloc(data_, size_);
+    data_ = nullptr;
+    size_ = 0;
+    capacity_ = 0;
+    return data;
+  }
+
+ private:
+  void Grow(size_t required) {
+    if (required <= capacity_) {
+      return;
+    }
+    capacity_ = std::max({required, capacity_ * 2, static_cast<size_t>(4096)});
+    data_ = static_cast<uint8_t *>(std::realloc(data_, capacity_));
+  }
+
+  uint8_t *data_ = nullptr;
+  size_t size_ = 0;
+  size_t capacity_ = 0;
+};
+
+// Bounds checked cursor over one section of a serialized display list.
+class FlatReader {
+ public:
+  FlatReader(const uint8_t *begin, size_t size)
+      : begin_(begin), ptr_(begin), end_(begin + size) {}
+
+  size_t Remaining() const { return static_cast<size_t>(end_ - ptr_); }
+  size_t Position() const { return static_cast<size_t>(ptr_ - begin_); }
+
+  template <typename T>
+  bool Read(T *value) {
+    static_assert(std::is_trivially_copyable<T>::value,
+                  "Only trivially copyable values can be read directly.");
+    if (Remaining() < sizeof(T)) {
+      return false;
+    }
+    std::memcpy(value, ptr_, sizeof(T));
+    ptr_ += sizeof(T);
+    return true;
+  }
+
+  // Returns a pointer into the underlying buffer without copying.
+  const uint8_t *Skip(size_t bytes) {
+    if (Remaining() < bytes) {
+      return nullptr;
+    }
+    const uint8_t *result = ptr_;
+    ptr_ += bytes;
+    return result;
+  }
+
+  template <typename T>
+  bool ReadArray(std::vector<T> *values) {
+    static_assert(std::is_trivially_copyable<T>::value,
+                  "Only trivially copyable values can be read directly.");
+    uint32_t count = 0;
+    if (!Read(&count) || Remaining() / sizeof(T) < count) {
+      return false;
+    }
+    values->resize(count);
+    if (count > 0) {
+      std::memcpy(values->data(), Skip(sizeof(T) * count), sizeof(T) * count);
+    }
+    return true;
+  }
+
+  bool Align(size_t alignment = kSectionAlignment) {
+    return Skip(AlignUp(Position(), alignment) - Position()) != nullptr;
+  }
+
+ private:
+  const uint8_t *begin_;
+  const uint8_t *ptr_;
+  const uint8_t *end_;
+};
+
+namespace {
+
+void ReleaseParentData(const void *, void *context) {
+  delete static_cast<std::shared_ptr<Data> *>(context);
+}
+
+// Creates a Data viewing a range of `parent` that keeps `parent` alive.
+std::shared_ptr<Data> MakeSubData(const std::shared_ptr<Data> &parent,
+                                  const uint8_t *ptr, size_t size) {
+  if (size == 0) {
+    return Data::MakeEmpty();
+  }
+  return Data::MakeWithProc(ptr, size, ReleaseParentData,
+                            new std::shared_ptr<Data>(parent));
+}
+
+template <typename M>
+void ClearMember(uint8_t *dst_op, const RecordedOp *op, const M *member) {
+  size_t offset = reinterpret_cast<const uint8_t *>(member) -
+                  reinterpret_cast<const uint8_t *>(op);
+  std::memset(dst_op + offset, 0, sizeof(M));
+}
+
+class DisplayListWriter {
+ public:
+  bool WriteOps(const uint8_t *ops, size_t byte_count, FlatWriter *out) {
+    size_t base = out->Reserve(byte_count);
+    if (byte_count > 0) {
+      std::memcpy(out->At(base), ops, byte_count);
+    }
+
+    const uint8_t *ptr = ops;
+    const uint8_t *end = ops + byte_count;
+    while (ptr < end) {
+      auto op = reinterpret_cast<const RecordedOp *>(ptr);
+      uint32_t offset = static_cast<uint32_t>(ptr - ops);
+      if (!WriteOp(op, offset, out->At(base + offset))) {
+        return false;
+      }
+      ptr += op->size;
+    }
+    return true;
+  }
+
+  void WriteTables(FlatWriter *out, FileHeader *header) {
+    auto begin_section = [&](Section section) {
+      out->Align();
+      header->sections[static_cast<size_t>(section)].offset = out->Size();
+    };
+    auto end_section = [&](Section section) {
+      auto &entry = header->sections[static_cast<size_t>(section)];
+      entry.size = out->Size() - entry.offset;
+    };
+
+    begin_section(Section::kFixups);
+    out->WriteArray(fixups_.data(), fixups_.size());
+    end_section(Section::kFixups);
+
+    begin_section(Section::kTypefaces);
+    WriteTypefaces(out);
+    end_section(Section::kTypefaces);
+
+    begin_section(Section::kImages);
+    WriteImages(out);
+    end_section(Section::kImages);
+
+    begin_section(Section::kShaders);
+    out->Write(shader_count_);
+    out->Append(shader_table_);
+    end_section(Section::kShaders);
+
+    begin_section(Section::kPaints);
+    out->WriteArray(paints_.data(), paints_.size());
+    end_section(Section::kPaints);
+
+    begin_section(Section::kPaths);
+    out->Write(static_cast<uint32_t>(path_offsets_.size()));
+    out->Append(path_table_);
+    end_section(Section::kPaths);
+
+    begin_section(Section::kGlyphRuns);
+    out->Write(run_count_);
+    out->Append(run_table_);
+    end_section(Section::kGlyphRuns);
+
+    begin_section(Section::kTextBlobs);
+    out->WriteArray(text_blobs_.data(), text_blobs_.size());
+    end_section(Section::kTextBlobs);
+
+    begin_section(Section::kDisplayLists);
+    WriteDisplayLists(out);
+    end_section(Section::kDisplayLists);
+  }
+
+ private:
+  bool WriteOp(const RecordedOp *op, uint32_t offset, uint8_t *dst) {
+    OpFixup fixup;
+    fixup.offset = offset;
+
+    auto add_paint = [&](const auto *typed_op) {
+      fixup.paint = AddPaint(typed_op->paint);
+      ClearMember(dst, op, &typed_op->paint);
+      return fixup.paint != kNoIndex;
+    };
+
+    bool ok = true;
+    switch (op->type) {
+      case RecordedOpType::kClipPath: {
+        auto *clip_path_op = static_cast<const ClipPathOp *>(op);
+        fixup.resource = AddPath(clip_path_op->path);
+        ClearMember(dst, op, &clip_path_op->path);
+      } break;
+      case RecordedOpType::kDrawLine:
+        ok = add_paint(static_cast<const DrawLineOp *>(op));
+        break;
+      case RecordedOpType::kDrawCircle:
+        ok = add_paint(static_cast<const DrawCircleOp *>(op));
+        break;
+      case RecordedOpType::kDrawArc:
+        ok = add_paint(static_cast<const DrawArcOp *>(op));
+        break;
+      case RecordedOpType::kDrawOval:
+        ok = add_paint(static_cast<const DrawOvalOp *>(op));
+        break;
+      case RecordedOpType::kDrawRect:
+        ok = add_paint(static_cast<const DrawRectOp *>(op));
+        break;
+      case RecordedOpType::kDrawRRect:
+        ok = add_paint(static_cast<const DrawRRectOp *>(op));
+        break;
+      case RecordedOpType::kDrawRoundRect:
+        ok = add_paint(static_cast<const DrawRoundRectOp *>(op));
+        break;
+      case RecordedOpType::kDrawDRRect:
+        ok = add_paint(static_cast<const DrawDRRectOp *>(op));
+        break;
+      case RecordedOpType::kDrawPaint:
+        ok = add_paint(static_cast<const DrawPaintOp *>(op));
+        break;
+      case RecordedOpType::kSaveLayer:
+        ok = add_paint(static_cast<const SaveLayerOp *>(op));
+        break;
+      case RecordedOpType::kDrawPath: {
+        auto *draw_path_op = static_cast<const DrawPathOp *>(op);
+        fixup.resource = AddPath(draw_path_op->path);
+        ClearMember(dst, op, &draw_path_op->path);
+        ok = add_paint(draw_path_op);
+      } break;
+      case RecordedOpType::kDrawTextBlob: {
+        auto *draw_text_blob_op = static_cast<const DrawTextBlobOp *>(op);
+        fixup.resource = AddTextBlob(*draw_text_blob_op->blob_ptr);
+        ClearMember(dst, op, &draw_text_blob_op->blob_ptr);
+        ok = fixup.resource != kNoIndex && add_paint(draw_text_blob_op);
+      } break;
+      case RecordedOpType::kDrawImage: {
+        auto *draw_image_op = static_cast<const DrawImageOp *>(op);
+        fixup.resource = AddImage(draw_image_op->image.get());
+        ClearMember(dst, op, &draw_image_op->image);
+        ok = fixup.resource != kNoIndex && add_paint(draw_image_op);
+      } break;
+      case RecordedOpType::kDrawGlyphs: {
+        auto *draw_glyphs_op = static_cast<const DrawGlyphsOp *>(op);
+        fixup.resource = AddGlyphRun(
+            draw_glyphs_op->font, draw_glyphs_op->m_glyphs,
+            draw_glyphs_op->m_positions_x, draw_glyphs_op->m_positions_y);
+        ClearMember(dst, op, &draw_glyphs_op->m_glyphs);
+        ClearMember(dst, op, &draw_glyphs_op->m_positions_x);
+        ClearMember(dst, op, &draw_glyphs_op->m_positions_y);
+        ClearMember(dst, op, &draw_glyphs_op->font);
+        ok = fixup.resource != kNoIndex && add_paint(draw_glyphs_op);
+      } break;
+      case RecordedOpType::kDrawDisplayList: {
+        auto *draw_display_list_op = static_cast<const DrawDisplayListOp *>(op);
+        fixup.resource =
+            AddDisplayList(draw_display_list_op->display_list.get());
+        ClearMember(dst, op, &draw_display_list_op->display_list);
+        ok = fixup.resource != kNoIndex;
+      } break;
+      default:
+        // Trivially copyable op, stored as is.
+        return true;
+    }
+
+    if (!ok) {
+      return false;
+    }
+    fixups_.push_back(fixup);
+    return true;
+  }
+
+  uint32_t AddTypeface(const std::shared_ptr<Typeface> &typeface) {
+    if (typeface == nullptr) {
+      return kNoIndex;
+    }
+    auto it = typeface_indices_.find(typeface.get());
+    if (it != typeface_indices_.end()) {
+      return it->second;
+    }
+    uint32_t index = static_cast<uint32_t>(typefaces_.size());
+    typefaces_.push_back(typeface);
+    typeface_indices_[typeface.get()] = index;
+    return index;
+  }
+
+  uint32_t AddImage(const Image *image) {
+    if (image == nullptr) {
+      return kNoIndex;
+    }
+    auto it = image_indices_.find(image);
+    if (it != image_indices_.end()) {
+      return it->second;
+    }
+    const std::shared_ptr<Pixmap> *pixmap = image->GetPixmap();
+    if (pixmap == nullptr || *pixmap == nullptr) {
+      LOGE("DisplayList serialization does not support texture images");
+      return kNoIndex;
+    }
+    uint32_t index = static_cast<uint32_t>(images_.size());
+    images_.push_back(*pixmap);
+    image_indices_[image] = index;
+    return index;
+  }
+
+  uint32_t AddShader(const Shader *shader) {
+    auto it = shader_indices_.find(shader);
+    if (it != shader_indices_.end()) {
+      return it->second;
+    }
+
+    FlatWriter record;
+    Shader::GradientInfo info;
+    Shader::GradientType type = shader->AsGradient(&info);
+    if (type == Shader::kLinear || type == Shader::kRadial ||
+        type == Shader::kConical || type == Shader::kSweep) {
+      record.Write(static_cast<uint32_t>(type));
+      record.Write(info.point[0].x);
+      record.Write(info.point[0].y);
+      record.Write(info.point[1].x);
+      record.Write(info.point[1].y);
+      record.Write(info.radius[0]);
+      record.Write(info.radius[1]);
+      record.Write(static_cast<uint32_t>(info.tile_mode));
+      record.Write(info.gradientFlags);
+      record.WriteArray(info.colors.data(), info.colors.size());
+      record.WriteArray(info.color_offsets.data(), info.color_offsets.size());
+    } else if (shader->AsImage() != nullptr) {
+      auto *pixmap_shader = static_cast<const PixmapShader *>(shader);
+      uint32_t image = AddImage(shader->AsImage()->get());
+      if (image == kNoIndex) {
+        return kNoIndex;
+      }
+      record.Write(kImageShaderKind);
+      record.Write(image);
+      record.Write(*shader->GetSamplingOptions());
+      record.Write(static_cast<uint32_t>(pixmap_shader->GetXTileMode()));
+      record.Write(static_cast<uint32_t>(pixmap_shader->GetYTileMode()));
+    } else {
+      LOGE("DisplayList serialization does not support this shader type");
+      return kNoIndex;
+    }
+    record.Write(shader->GetLocalMatrix());
+
+    uint32_t index = shader_count_++;
+    shader_table_.Write(static_cast<uint32_t>(record.Size()));
+    shader_table_.Append(record);
+    shader_table_.Align(4);
+    shader_indices_[shader] = index;
+    return index;
+  }
+
+  uint32_t AddPaint(const Paint &paint) {
+    if (paint.GetPathEffect() || paint.GetColorFilter() ||
+        paint.GetMaskFilter() || paint.GetImageFilter()) {
+      LOGE("DisplayList serialization does not support paint effects yet");
+      return kNoIndex;
+    }
+
+    FlatPaint flat;
+    flat.style = paint.GetStyle();
+    flat.cap = paint.GetStrokeCap();
+    flat.join = paint.GetStrokeJoin();
+    flat.flags =
+        (paint.IsAntiAlias() ? kAntiAlias_FlatPaintFlag : 0) |
+        (paint.IsSDFForSmallText() ? kSDFForSmallText_FlatPaintFlag : 0) |
+        (paint.IsAdjustStroke() ? kAdjustStroke_FlatPaintFlag : 0);
+    flat.blend_mode = static_cast<uint32_t>(paint.GetBlendMode());
+    flat.stroke_width = paint.GetStrokeWidth();
+    flat.miter_limit = paint.GetStrokeMiter();
+    flat.text_size = paint.GetTextSize();
+    flat.font_threshold = paint.GetFontThreshold();
+    Vector fill_color = paint.GetFillColor();
+    Vector stroke_color = paint.GetStrokeColor();
+    for (int i = 0; i < 4; i++) {
+      flat.fill_color[i] = fill_color[i];
+      flat.stroke_color[i] = stroke_color[i];
+    }
+    if (paint.GetShader()) {
+      flat.shader = AddShader(paint.GetShader().get());
+      if (flat.shader == kNoIndex) {
+        return kNoIndex;
+      }
+    }
+    flat.typeface = AddTypeface(paint.GetTypeface());
+
+    // Paints are deduplicated on their flattened form, which compares shaders
+    // and typefaces by identity.
+    uint32_t hash = Hash32(&flat, sizeof(FlatPaint));
+    auto range = paint_indices_.equal_range(hash);
+    for (auto it = range.first; it != range.second; ++it) {
+      if (std::memcmp(&paints_[it->second], &flat, sizeof(FlatPaint)) == 0) {
+        return it->second;
+      }
+    }
+    uint32_t index = static_cast<uint32_t>(paints_.size());
+    paints_.push_back(flat);
+    paint_indices_.emplace(hash, index);
+    return index;
+  }
+
+  uint32_t AddPath(const Path &path) {
+    FlatWriter record;
+    record.Write(static_cast<uint32_t>(path.GetFillType()));
+    record.Write(static_cast<uint32_t>(path.CountVerbs()));
+    for (const Path::Verb *verb = path.VerbsBegin(); verb != path.VerbsEnd();
+         ++verb) {
+      record.Write(static_cast<uint8_t>(*verb));
+    }
+    record.Align(4);
+    record.Write(static_cast<uint32_t>(path.CountPoints()));
+    for (size_t i = 0; i < path.CountPoints(); i++) {
+      record.Write(path.Points()[i].x);
+      record.Write(path.Points()[i].y);
+    }
+    size_t conic_count = std::count(path.VerbsBegin(), path.VerbsEnd(),
+                                    Path::Verb::kConic);
+    record.WriteArray(path.ConicWeights(), conic_count);
+
+    uint32_t hash = Hash32(record.At(0), record.Size());
+    auto range = path_indices_.equal_range(hash);
+    for (auto it = range.first; it != range.second; ++it) {
+      const auto &entry = path_offsets_[it->second];
+      if (entry.second == record.Size() &&
+          std::memcmp(path_table_.At(entry.first), record.At(0),
+                      record.Size()) == 0) {
+        return it->second;
+      }
+    }
+
+    uint32_t index = static_cast<uint32_t>(path_offsets_.size());
+    path_offsets_.emplace_back(path_table_.Size(), record.Size());
+    path_table_.Append(record);
+    path_indices_.emplace(hash, index);
+    return index;
+  }
+
+  uint32_t AddGlyphRun(const Font &font, const std::vector<GlyphID> &glyphs,
+                       const std::vector<float> &pos_x,
+                       const std::vector<float> &pos_y) {
+    FlatFont flat;
+    flat.typeface = AddTypeface(font.GetTypeface());
+    flat.size = font.GetSize();
+    flat.scale_x = font.GetScaleX();
+    flat.skew_x = font.GetSkewX();
+    flat.flags =
+        (font.IsForceAutoHinting() ? kForceAutoHinting_FlatFontFlag : 0) |
+        (font.IsEmbeddedBitmaps() ? kEmbeddedBitmaps_FlatFontFlag : 0) |
+        (font.IsSubpixel() ? kSubpixel_FlatFontFlag : 0) |
+        (font.IsLinearMetrics() ? kLinearMetrics_FlatFontFlag : 0) |
+        (font.IsEmbolden() ? kEmbolden_FlatFontFlag : 0) |
+        (font.IsBaselineSnap() ? kBaselineSnap_FlatFontFlag : 0);
+    flat.edging = static_cast<uint8_t>(font.GetEdging());
+    flat.hinting = static_cast<uint8_t>(font.GetHinting());
+
+    run_table_.Write(flat);
+    run_table_.WriteArray(glyphs.data(), glyphs.size());
+    run_table_.Align(4);
+    run_table_.WriteArray(pos_x.data(), pos_x.size());
+    run_table_.WriteArray(pos_y.data(), pos_y.size());
+    return run_count_++;
+  }
+
+  uint32_t AddTextBlob(const TextBlob &blob) {
+    uint32_t first_run = run_count_;
+    for (const auto &run : blob.GetTextRun()) {
+      AddGlyphRun(run.GetFont(), run.GetGlyphInfo(), run.GetPosX(),
+                  run.GetPosY());
+    }
+    uint32_t index = static_cast<uint32_t>(text_blobs_.size());
+    text_blobs_.push_back({first_run, run_count_ - first_run});
+    return index;
+  }
+
+  // Nested display lists are stored as complete serialized blobs.
+  uint32_t AddDisplayList(const DisplayList *display_list) {
+    auto it = display_list_indices_.find(display_list);
+    if (it != display_list_indices_.end()) {
+      return it->second;
+    }
+    auto data = DisplayListSerializer::Serialize(*display_list);
+    if (data == nullptr) {
+      return kNoIndex;
+    }
+    uint32_t index = static_cast<uint32_t>(display_lists_.size());
+    display_lists_.push_back(std::move(data));
+    display_list_indices_[display_list] = index;
+    return index;
+  }
+
+  void WriteTypefaces(FlatWriter *out) {
+    out->Write(static_cast<uint32_t>(typefaces_.size()));
+    for (auto &typeface : typefaces_) {
+      // A typeface without backing data is restored as the default typeface.
+      std::shared_ptr<Data> data = typeface->GetData();
+      size_t size = data ? data->Size() : 0;
+      out->Write(static_cast<uint64_t>(size));
+      if (size > 0) {
+        out->Write(data->RawData(), size);
+      }
+      out->Align();
+    }
+  }
+
+  void WriteDisplayLists(FlatWriter *out) {
+    out->Write(static_cast<uint32_t>(display_lists_.size()));
+    out->Align();
+    for (auto &data : display_lists_) {
+      out->Write(static_cast<uint64_t>(data->Size()));
+      out->Write(data->RawData(), data->Size());
+      out->Align();
+    }
+  }
+
+  void WriteImages(FlatWriter *out) {
+    out->Write(static_cast<uint32_t>(images_.size()));
+    out->Align();
+    for (auto &pixmap : images_) {
+      FlatImage flat;
+      flat.width = pixmap->Width();
+      flat.height = pixmap->Height();
+      flat.alpha_type = static_cast<uint32_t>(pixmap->GetAlphaType());
+      flat.color_type = static_cast<uint32_t>(pixmap->GetColorType());
+      flat.row_bytes = pixmap->RowBytes();
+      out->Write(flat);
+      out->Align();
+      out->Write(pixmap->Addr(), pixmap->RowBytes() * pixmap->Height());
+      out->Align();
+    }
+  }
+
+  std::vector<OpFixup> fixups_;
+
+  std::vector<std::shared_ptr<Typeface>> typefaces_;
+  std::unordered_map<const Typeface *, uint32_t> typeface_indices_;
+
+  std::vector<std::shared_ptr<Pixmap>> images_;
+  std::unordered_map<const Image *, uint32_t> image_indices_;
+
+  FlatWriter shader_table_;
+  uint32_t shader_count_ = 0;
+  std::unordered_map<const Shader *, uint32_t> shader_indices_;
+
+  std::vector<FlatPaint> paints_;
+  std::unordered_multimap<uint32_t, uint32_t> paint_indices_;
+
+  FlatWriter path_table_;
+  std::vector<std::pair<size_t, size_t>> path_offsets_;
+  std::unordered_multimap<uint32_t, uint32_t> path_indices_;
+
+  FlatWriter run_table_;
+  uint32_t run_count_ = 0;
+
+  std::vector<FlatTextBlob> text_blobs_;
+
+  std::vector<std::shared_ptr<Data>> display_lists_;
+  std::unordered_map<const DisplayList *, uint32_t> display_list_indices_;
+};
+
+struct GlyphRunData {
+  Font font;
+  std::vector<GlyphID> glyphs;
+  std::vector<float> pos_x;
+  std::vector<float> pos_y;
+};
+
+class DisplayListReader {
+ public:
+  DisplayListReader(std::shared_ptr<Data> data, const FileHeader &header)
+      : data_(std::move(data)), header_(header) {}
+
+  bool ReadTables() {
+    return ReadTypefaces() && ReadImages() && ReadShaders() && ReadPaints() &&
+           ReadPaths() && ReadGlyphRuns() && ReadTextBlobs() &&
+           ReadDisplayLists();
+  }
+
+  bool ReadFixups() {
+    FlatReader reader = SectionReader(Section::kFixups);
+    return reader.ReadArray(&fixups_);
+  }
+
+  // Checks the op buffer and the fixup table describe each other, so that
+  // every op owning resources is constructed exactly once and the buffer can
+  // be walked and disposed safely.
+  bool ValidateOps(const uint8_t *ops, size_t byte_count) const {
+    size_t fixup_index = 0;
+    size_t offset = 0;
+    while (offset < byte_count) {
+      if (byte_count - offset < sizeof(RecordedOp)) {
+        return false;
+      }
+      auto op = reinterpret_cast<const RecordedOp *>(ops + offset);
+      if (op->size < sizeof(RecordedOp) || op->size % sizeof(void *) != 0 ||
+          op->size > byte_count - offset ||
+          static_cast<uint32_t>(op->type) >
+              static_cast<uint32_t>(RecordedOpType::kDrawDisplayList) ||
+          op->size != ExpectedOpSize(op->type)) {
+        return false;
+      }
+
+      bool needs_paint = false;
+      bool needs_resource = false;
+      ResourceNeeds(op->type, &needs_paint, &needs_resource);
+      if (needs_paint || needs_resource) {
+        if (fixup_index >= fixups_.size() ||
+            fixups_[fixup_index].offset != offset ||
+            !ValidateFixup(op->type, fixups_[fixup_index], needs_paint,
+                           needs_resource)) {
+          return false;
+        }
+        fixup_index++;
+      }
+      offset += op->size;
+    }
+    return fixup_index == fixups_.size();
+  }
+
+  void ApplyFixups(uint8_t *ops) const {
+    for (const auto &fixup : fixups_) {
+      auto op = reinterpret_cast<RecordedOp *>(ops + fixup.offset);
+      ApplyFixup(op, fixup);
+    }
+  }
+
+  FlatReader SectionReader(Section section) const {
+    const auto &entry = header_.sections[static_cast<size_t>(section)];
+    return FlatReader(data_->Bytes() + entry.offset, entry.size);
+  }
+
+ private:
+
+  static size_t ExpectedOpSize(RecordedOpType type) {
+    switch (type) {
+#define RECORDED_OP_SIZE(name) \
+  case RecordedOpType::k##name: \
+    return AlignUp(sizeof(name##Op), sizeof(void *));
+      FOR_EACH_RECORDED_OP(RECORDED_OP_SIZE)
+#undef RECORDED_OP_SIZE
+    }
+    return 0;
+  }
+
+  static void ResourceNeeds(RecordedOpType type, bool *paint, bool *resource) {
+    switch (type) {
+      case RecordedOpType::kClipPath:
+        *resource = true;
+        break;
+      case RecordedOpType::kDrawLine:
+      case RecordedOpType::kDrawCircle:
+      case RecordedOpType::kDrawArc:
+      case RecordedOpType::kDrawOval:
+      case RecordedOpType::kDrawRect:
+      case RecordedOpType::kDrawRRect:
+      case RecordedOpType::kDrawRoundRect:
+      case RecordedOpType::kDrawDRRect:
+      case RecordedOpType::kDrawPaint:
+      case RecordedOpType::kSaveLayer:
+        *paint = true;
+        break;
+      case RecordedOpType::kDrawPath:
+      case RecordedOpType::kDrawTextBlob:
+      case RecordedOpType::kDrawImage:
+      case RecordedOpType::kDrawGlyphs:
+        *paint = true;
+        *resource = true;
+        break;
+      case RecordedOpType::kDrawDisplayList:
+        *resource = true;
+        break;
+      default:
+        break;
+    }
+  }
+
+  bool ValidateFixup(RecordedOpType type, const OpFixup &fixup,
+                     bool needs_paint, bool needs_resource) const {
+    if (needs_paint && fixup.paint >= paints_.size()) {
+      return false;
+    }
+    if (!needs_resource) {
+      return true;
+    }
+    switch (type) {
+      case RecordedOpType::kClipPath:
+      case RecordedOpType::kDrawPath:
+        return fixup.resource < paths_.size();
+      case RecordedOpType::kDrawTextBlob:
+        return fixup.resource < text_blobs_.size();
+      case RecordedOpType::kDrawImage:
+        return fixup.resource < images_.size();
+      case RecordedOpType::kDrawGlyphs:
+        return fixup.resource < glyph_runs_.size();
+      case RecordedOpType::kDrawDisplayList:
+        return fixup.resource < display_lists_.size();
+      default:
+        return false;
+    }
+  }
+
+  void ApplyFixup(RecordedOp *op, const OpFixup &fixup) const {
+    // The members constructed here were zeroed by the writer, so there is
+    // nothing to destroy first.
+    switch (op->type) {
+      case RecordedOpType::kClipPath: {
+        auto *clip_path_op = static_cast<ClipPathOp *>(op);
+        new (&clip_path_op->path) Path(paths_[fixup.resource]);
+      } break;
+      case RecordedOpType::kDrawLine:
+        ConstructPaint(static_cast<DrawLineOp *>(op), fixup);
+        break;
+      case RecordedOpType::kDrawCircle:
+        ConstructPaint(static_cast<DrawCircleOp *>(op), fixup);
+        break;
+      case RecordedOpType::kDrawArc:
+        ConstructPaint(static_cast<DrawArcOp *>(op), fixup);
+        break;
+      case RecordedOpType::kDrawOval:
+        ConstructPaint(static_cast<DrawOvalOp *>(op), fixup);
+        break;
+      case RecordedOpType::kDrawRect:
+        ConstructPaint(static_cast<DrawRectOp *>(op), fixup);
+        break;
+      case RecordedOpType::kDrawRRect:
+        ConstructPaint(static_cast<DrawRRectOp *>(op), fixup);
+        break;
+      case RecordedOpType::kDrawRoundRect:
+        ConstructPaint(static_cast<DrawRoundRectOp *>(op), fixup);
+        break;
+      case RecordedOpType::kDrawDRRect:
+        ConstructPaint(static_cast<DrawDRRectOp *>(op), fixup);
+        break;
+      case RecordedOpType::kDrawPaint:
+        ConstructPaint(static_cast<DrawPaintOp *>(op), fixup);
+        break;
+      case RecordedOpType::kSaveLayer:
+        ConstructPaint(static_cast<SaveLayerOp *>(op), fixup);
+        break;
+      case RecordedOpType::kDrawPath: {
+        auto *draw_path_op = static_cast<DrawPathOp *>(op);
+        new (&draw_path_op->path) Path(paths_[fixup.resource]);
+        ConstructPaint(draw_path_op, fixup);
+      } break;
+      case RecordedOpType::kDrawTextBlob: {
+        auto *draw_text_blob_op = static_cast<DrawTextBlobOp *>(op);
+        const auto &blob = text_blobs_[fixup.resource];
+        std::vector<TextRun> runs;
+        runs.reserve(blob.run_count);
+        for (uint32_t i = 0; i < blob.run_count; i++) {
+          const auto &run = glyph_runs_[blob.first_run + i];
+          runs.emplace_back(run.font, run.glyphs, run.pos_x, run.pos_y);
+        }
+        new (&draw_text_blob_op->blob_ptr) std::unique_ptr<TextBlob>(
+            std::make_unique<TextBlob>(std::move(runs)));
+        ConstructPaint(draw_text_blob_op, fixup);
+      } break;
+      case RecordedOpType::kDrawImage: {
+        auto *draw_image_op = static_cast<DrawImageOp *>(op);
+        new (&draw_image_op->image)
+            std::shared_ptr<Image>(images_[fixup.resource]);
+        ConstructPaint(draw_image_op, fixup);
+      } break;
+      case RecordedOpType::kDrawGlyphs: {
+        auto *draw_glyphs_op = static_cast<DrawGlyphsOp *>(op);
+        const auto &run = glyph_runs_[fixup.resource];
+        new (&draw_glyphs_op->m_glyphs) std::vector<GlyphID>(run.glyphs);
+        new (&draw_glyphs_op->m_positions_x) std::vector<float>(run.pos_x);
+        new (&draw_glyphs_op->m_positions_y) std::vector<float>(run.pos_y);
+        new (const_cast<Font *>(&draw_glyphs_op->font)) Font(run.font);
+        ConstructPaint(draw_glyphs_op, fixup);
+      } break;
+      case RecordedOpType::kDrawDisplayList: {
+        auto *draw_display_list_op = static_cast<DrawDisplayListOp *>(op);
+        new (&draw_display_list_op->display_list)
+            std::shared_ptr<const DisplayList>(display_lists_[fixup.resource]);
+      } break;
+      default:
+        break;
+    }
+  }
+
+  template <typename T>
+  void ConstructPaint(T *op, const OpFixup &fixup) const {
+    new (&op->paint) Paint(paints_[fixup.paint]);
+  }
+
+  bool ReadTypefaces() {
+    FlatReader reader = SectionReader(Section::kTypefaces);
+    uint32_t count = 0;
+    if (!reader.Read(&count)) {
+      return false;
+    }
+    typefaces_.reserve(count);
+    for (uint32_t i = 0; i < count; i++) {
+      uint64_t size = 0;
+      if (!reader.Read(&size) || size > reader.Remaining()) {
+        return false;
+      }
+      const uint8_t *bytes = reader.Skip(size);
+      std::shared_ptr<Typeface> typeface;
+      if (size > 0) {
+        typeface = Typeface::MakeFromData(MakeSubData(data_, bytes, size));
+      }
+      typefaces_.push_back(typeface ? typeface
+                                    : Typeface::GetDefaultTypeface());
+      if (!reader.Align()) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  bool ReadDisplayLists() {
+    FlatReader reader = SectionReader(Section::kDisplayLists);
+    uint32_t count = 0;
+    if (!reader.Read(&count) || !reader.Align()) {
+      return false;
+    }
+    display_lists_.reserve(count);
+    for (uint32_t i = 0; i < count; i++) {
+      uint64_t size = 0;
+      if (!reader.Read(&size) || size > reader.Remaining()) {
+        return false;
+      }
+      // A nested blob is always smaller than its parent, which bounds the
+      // recursion depth by the input size.
+      const uint8_t *bytes = reader.Skip(size);
+      std::shared_ptr<const DisplayList> display_list =
+          DisplayListSerializer::Deserialize(MakeSubData(data_, bytes, size));
+      if (display_list == nullptr || !reader.Align()) {
+        return false;
+      }
+      display_lists_.push_back(std::move(display_list));
+    }
+    return true;
+  }
+
+  bool ReadImages() {
+    FlatReader reader = SectionReader(Section::kImages);
+    uint32_t count = 0;
+    // Every image stores at least its FlatImage, which bounds the count
+    // before anything is reserved for it.
+    if (!reader.Read(&count) || !reader.Align() ||
+        reader.Remaining() / sizeof(FlatImage) < count) {
+      return false;
+    }
+    images_.reserve(count);
+    for (uint32_t i = 0; i < count; i++) {
+      FlatImage flat;
+      if (!reader.Read(&flat) || !reader.Align()) {
+        return false;
+      }
+      size_t bytes_per_pixel = FlatBytesPerPixel(flat.color_type);
+      if (bytes_per_pixel == 0 ||
+          flat.alpha_type > static_cast<uint32_t>(kLastEnum_AlphaType) ||
+          flat.row_bytes / bytes_per_pixel < flat.width) {
+        return false;
+      }
+      if (flat.height > 0 &&
+          flat.row_bytes > reader.Remaining() / flat.height) {
+        return false;
+      }
+      size_t size = static_cast<size_t>(flat.row_bytes) * flat.height;
+      const uint8_t *pixels = reader.Skip(size);
+      if (pixels == nullptr || !reader.Align()) {
+        return false;
+      }
+      // Pixels alias the source data, which for a mapped file means they are
+      // paged in on first use rather than copied at load time.
+      auto pixmap = std::make_shared<Pixmap>(
+          MakeSubData(data_, pixels, size), flat.row_bytes, flat.width,
+          flat.height, static_cast<AlphaType>(flat.alpha_type),
+          static_cast<ColorType>(flat.color_type));
+      images_.push_back(Image::MakeImage(std::move(pixmap)));
+    }
+    return true;
+  }
+
+  bool ReadShaders() {
+    FlatReader reader = SectionReader(Section::kShaders);
+    uint32_t count = 0;
+    if (!reader.Read(&count)) {
+      return false;
+    }
+    shaders_.reserve(count);
+    for (uint32_t i = 0; i < count; i++) {
+      uint32_t size = 0;
+      if (!reader.Read(&size)) {
+        return false;
+      }
+      const uint8_t *bytes = reader.Skip(size);
+      if (bytes == nullptr || !reader.Align(4)) {
+        return false;
+      }
+      FlatReader record(bytes, size);
+      auto shader = ReadShader(record);
+      if (shader == nullptr) {
+        return false;
+      }
+      shaders_.push_back(std::move(shader));
+    }
+    return true;
+  }
+
+  std::shared_ptr<Shader> ReadShader(FlatReader &record) const {
+    uint32_t kind = 0;
+    if (!record.Read(&kind)) {
+      return nullptr;
+    }
+
+    std::shared_ptr<Shader> shader;
+    if (kind == kImageShaderKind) {
+      uint32_t image = 0;
+      SamplingOptions sampling;
+      uint32_t x_tile_mode = 0;
+      uint32_t y_tile_mode = 0;
+      if (!record.Read(&image) || image >= images_.size() ||
+          !record.Read(&sampling) || !record.Read(&x_tile_mode) ||
+          !record.Read(&y_tile_mode)) {
+        return nullptr;
+      }
+      shader = std::make_shared<PixmapShader>(
+          images_[image], sampling, static_cast<TileMode>(x_tile_mode),
+          static_cast<TileMode>(y_tile_mode), Matrix());
+    } else {
+      float points[4];
+      float radius[2];
+      uint32_t tile_mode = 0;
+      int32_t flags = 0;
+      std::vector<Vec4> colors;
+      std::vector<float> offsets;
+      if (!record.Read(&points) || !record.Read(&radius) ||
+          !record.Read(&tile_mode) || !record.Read(&flags) ||
+          !record.ReadArray(&colors) || !record.ReadArray(&offsets) ||
+          colors.size() < 2 ||
+          (!offsets.empty() && offsets.size() != colors.size())) {
+        return nullptr;
+      }
+      const float *pos = offsets.empty() ? nullptr : offsets.data();
+      int32_t color_count = static_cast<int32_t>(colors.size());
+      TileMode tile = static_cast<TileMode>(tile_mode);
+      Point p0{points[0], points[1], 0.f, 1.f};
+      Point p1{points[2], points[3], 0.f, 1.f};
+      switch (kind) {
+        case Shader::kLinear: {
+          Point pts[2] = {p0, p1};
+          shader = std::make_shared<LinearGradientShader>(
+              pts, colors.data(), pos, color_count, tile, flags);
+        } break;
+        case Shader::kRadial:
+          shader = std::make_shared<RadialGradientShader>(
+              p0, radius[0], colors.data(), pos, color_count, tile, flags);
+          break;
+        case Shader::kConical:
+          shader = std::make_shared<TwoPointConicalGradientShader>(
+              p0, radius[0], p1, radius[1], colors.data(), pos, color_count,
+              tile, flags);
+          break;
+        case Shader::kSweep:
+          shader = std::make_shared<SweepGradientShader>(
+              points[0], points[1], radius[0], radius[1], colors.data(), pos,
+              color_count, tile, flags);
+          break;
+        default:
+          return nullptr;
+      }
+    }
+
+    Matrix local_matrix;
+    if (!record.Read(&local_matrix)) {
+      return nullptr;
+    }
+    shader->SetLocalMatrix(local_matrix);
+    return shader;
+  }
+
+  bool ReadPaints() {
+    FlatReader reader = SectionReader(Section::kPaints);
+    std::vector<FlatPaint> flat_paints;
+    if (!reader.ReadArray(&flat_paints)) {
+      return false;
+    }
+    paints_.reserve(flat_paints.size());
+    for (const auto &flat : flat_paints) {
+      if (flat.style >= Paint::StyleCount || flat.cap >= Paint::kCapCount ||
+          flat.join >= Paint::kJoinCount ||
+          (flat.shader != kNoIndex && flat.shader >= shaders_.size()) ||
+          (flat.typeface != kNoIndex && flat.typeface >= typefaces_.size())) {
+        return false;
+      }
+      Paint paint;
+      paint.SetStyle(static_cast<Paint::Style>(flat.style));
+      paint.SetStrokeCap(static_cast<Paint::Cap>(flat.cap));
+      paint.SetStrokeJoin(static_cast<Paint::Join>(flat.join));
+      paint.SetAntiAlias(flat.flags & kAntiAlias_FlatPaintFlag);
+      paint.SetSDFForSmallText(flat.flags & kSDFForSmallText_FlatPaintFlag);
+      paint.SetAdjustStroke(flat.flags & kAdjustStroke_FlatPaintFlag);
+      paint.SetBlendMode(static_cast<BlendMode>(flat.blend_mode));
+      paint.SetStrokeWidth(flat.stroke_width);
+      paint.SetStrokeMiter(flat.miter_limit);
+      paint.SetTextSize(flat.text_size);
+      paint.SetFontThreshold(flat.font_threshold);
+      paint.SetFillColor(flat.fill_color[0], flat.fill_color[1],
+                         flat.fill_color[2], flat.fill_color[3]);
+      paint.SetStrokeColor(flat.stroke_color[0], flat.stroke_color[1],
+                           flat.stroke_color[2], flat.stroke_color[3]);
+      if (flat.shader != kNoIndex) {
+        paint.SetShader(shaders_[flat.shader]);
+      }
+      if (flat.typeface != kNoIndex) {
+        paint.SetTypeface(typefaces_[flat.typeface]);
+      }
+      paints_.push_back(std::move(paint));
+    }
+    return true;
+  }
+
+  bool ReadPaths() {
+    FlatReader reader = SectionReader(Section::kPaths);
+    uint32_t count = 0;
+    if (!reader.Read(&count)) {
+      return false;
+    }
+    paths_.resize(count);
+    for (uint32_t i = 0; i < count; i++) {
+      if (!ReadPath(reader, &paths_[i])) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  static bool ReadPath(FlatReader &reader, Path *path) {
+    uint32_t fill_type = 0;
+    uint32_t verb_count = 0;
+    if (!reader.Read(&fill_type) || !reader.Read(&verb_count)) {
+      return false;
+    }
+    const uint8_t *verbs = reader.Skip(verb_count);
+    std::vector<float> points;
+    uint32_t point_count = 0;
+    std::vector<float> weights;
+    if ((verbs == nullptr && verb_count > 0) || !reader.Align(4) ||
+        !reader.Read(&point_count) ||
+        reader.Remaining() / (2 * sizeof(float)) < point_count) {
+      return false;
+    }
+    points.resize(point_count * 2);
+    if (point_count > 0) {
+      std::memcpy(points.data(), reader.Skip(points.size() * sizeof(float)),
+                  points.size() * sizeof(float));
+    }
+    if (!reader.ReadArray(&weights)) {
+      return false;
+    }
+
+    path->SetFillType(static_cast<Path::PathFillType>(fill_type));
+    size_t pt = 0;
+    size_t weight = 0;
+    auto has_points = [&](size_t n) { return pt + n <= point_count; };
+    auto x = [&](size_t i) { return points[2 * (pt + i)]; };
+    auto y = [&](size_t i) { return points[2 * (pt + i) + 1]; };
+    for (uint32_t i = 0; i < verb_count; i++) {
+      switch (static_cast<Path::Verb>(verbs[i])) {
+        case Path::Verb::kMove:
+          if (!has_points(1)) {
+            return false;
+          }
+          path->MoveTo(x(0), y(0));
+          pt += 1;
+          break;
+        case Path::Verb::kLine:
+          if (!has_points(1)) {
+            return false;
+          }
+          path->LineTo(x(0), y(0));
+          pt += 1;
+          break;
+        case Path::Verb::kQuad:
+          if (!has_points(2)) {
+            return false;
+          }
+          path->QuadTo(x(0), y(0), x(1), y(1));
+          pt += 2;
+          break;
+        case Path::Verb::kConic:
+          if (!has_points(2) || weight >= weights.size()) {
+            return false;
+          }
+          path->ConicTo(x(0), y(0), x(1), y(1), weights[weight++]);
+          pt += 2;
+          break;
+        case Path::Verb::kCubic:
+          if (!has_points(3)) {
+            return false;
+          }
+          path->CubicTo(x(0), y(0), x(1), y(1), x(2), y(2));
+          pt += 3;
+          break;
+        case Path::Verb::kClose:
+          path->Close();
+          break;
+        default:
+          return false;
+      }
+    }
+    return true;
+  }
+
+  bool ReadGlyphRuns() {
+    FlatReader reader = SectionReader(Section::kGlyphRuns);
+    uint32_t count = 0;
+    if (!reader.Read(&count)) {
+      return false;
+    }
+    glyph_runs_.resize(count);
+    for (uint32_t i = 0; i < count; i++) {
+      auto &run = glyph_runs_[i];
+      FlatFont flat;
+      if (!reader.Read(&flat) || !reader.ReadArray(&run.glyphs) ||
+          !reader.Align(4) || !reader.ReadArray(&run.pos_x) ||
+          !reader.ReadArray(&run.pos_y) ||
+          (flat.typeface != kNoIndex && flat.typeface >= typefaces_.size())) {
+        return false;
+      }
+      Font font(flat.typeface != kNoIndex ? typefaces_[flat.typeface] : nullptr,
+                flat.size, flat.scale_x, flat.skew_x);
+      font.SetForceAutoHinting(flat.flags & kForceAutoHinting_FlatFontFlag);
+      font.SetEmbeddedBitmaps(flat.flags & kEmbeddedBitmaps_FlatFontFlag);
+      font.SetSubpixel(flat.flags & kSubpixel_FlatFontFlag);
+      font.SetLinearMetrics(flat.flags & kLinearMetrics_FlatFontFlag);
+      font.SetEmbolden(flat.flags & kEmbolden_FlatFontFlag);
+      font.SetBaselineSnap(flat.flags & kBaselineSnap_FlatFontFlag);
+      font.SetEdging(static_cast<Font::Edging>(flat.edging));
+      font.SetHinting(static_cast<Font::FontHinting>(flat.hinting));
+      run.font = std::move(font);
+    }
+    return true;
+  }
+
+  bool ReadTextBlobs() {
+    FlatReader reader = SectionReader(Section::kTextBlobs);
+    if (!reader.ReadArray(&text_blobs_)) {
+      return false;
+    }
+    for (const auto &blob : text_blobs_) {
+      if (blob.first_run > glyph_runs_.size() ||
+          blob.run_count > glyph_runs_.size() - blob.first_run) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  std::shared_ptr<Data> data_;
+  FileHeader header_;
+
+  std::vector<OpFixup> fixups_;
+  std::vector<std::shared_ptr<Typeface>> typefaces_;
+  std::vector<std::shared_ptr<Image>> images_;
+  std::vector<std::shared_ptr<Shader>> shaders_;
+  std::vector<Paint> paints_;
+  std::vector<Path> paths_;
+  std::vector<GlyphRunData> glyph_runs_;
+  std::vector<FlatTextBlob> text_blobs_;
+  std::vector<std::shared_ptr<const DisplayList>> display_lists_;
+};
+
+}  // namespace
+
+std::shared_ptr<Data> DisplayListSerializer::Serialize(
+    const DisplayList &display_list) {
+  FileHeader header;
+  header.layout_hash = kOpLayoutHash;
+  header.op_count = display_list.op_count_;
+  header.byte_count = display_list.byte_count_;
+  WriteRect(display_list.bounds_, header.bounds);
+  header.properties = display_list.properties_;
+  header.has_rtree = display_list.rtree_ != nullptr;
+
+  FlatWriter out;
+  out.Reserve(sizeof(FileHeader));
+
+  DisplayListWriter writer;
+  out.Align();
+  header.sections[static_cast<size_t>(Section::kOps)].offset = out.Size();
+  if (!writer.WriteOps(display_list.storage_.get(), display_list.byte_count_,
+                       &out)) {
+    return nullptr;
+  }
+  header.sections[static_cast<size_t>(Section::kOps)].size =
+      display_list.byte_count_;
+
+  writer.WriteTables(&out, &header);
+
+  if (display_list.rtree_) {
+    out.Align();
+    auto &entry = header.sections[static_cast<size_t>(Section::kRTree)];
+    entry.offset = out.Size();
+    WriteRTree(*display_list.rtree_, &out);
+    entry.size = out.Size() - entry.offset;
+  }
+
+  std::memcpy(out.At(0), &header, sizeof(FileHeader));
+  return out.Detach();
+}
+
+void DisplayListSerializer::WriteRTree(const DisplayListRTree &rtree,
+                                       FlatWriter *out) {
+  std::vector<FlatSpatialOp> spatial_ops(rtree.spatial_ops_.size());
+  for (size_t i = 0; i < spatial_ops.size(); i++) {
+    WriteRect(rtree.spatial_ops_[i].first, spatial_ops[i].bounds);
+    spatial_ops[i].offset = rtree.spatial_ops_[i].second;
+  }
+  std::vector<FlatRTreeNode> nodes(rtree.rtree_nodes_.size());
+  for (size_t i = 0; i < nodes.size(); i++) {
+    WriteRect(rtree.rtree_nodes_[i].bounds, nodes[i].bounds);
+    nodes[i].first_child = rtree.rtree_nodes_[i].first_child;
+    nodes[i].child_count = rtree.rtree_nodes_[i].child_count;
+    nodes[i].leaf = rtree.rtree_nodes_[i].leaf;
+  }
+  out->WriteArray(spatial_ops.data(), spatial_ops.size());
+  out->WriteArray(nodes.data(), nodes.size());
+  out->WriteArray(rtree.rtree_children_.data(), rtree.rtree_children_.size());
+  out->Write(rtree.rtree_root_);
+}
+
+std::unique_ptr<DisplayListRTree> DisplayListSerializer::ReadRTree(
+    FlatReader reader, size_t byte_count) {
+  std::vector<FlatSpatialOp> spatial_ops;
+  std::vector<FlatRTreeNode> nodes;
+  std::unique_ptr<DisplayListRTree> rtree(new DisplayListRTree());
+  if (!reader.ReadArray(&spatial_ops) || !reader.ReadArray(&nodes) ||
+      !reader.ReadArray(&rtree->rtree_children_) ||
+      !reader.Read(&rtree->rtree_root_)) {
+    return nullptr;
+  }
+
+  rtree->spatial_ops_.reserve(spatial_ops.size());
+  for (const auto &op : spatial_ops) {
+    if (op.offset < 0 || static_cast<size_t>(op.offset) >= byte_count) {
+      return nullptr;
+    }
+    rtree->spatial_ops_.emplace_back(ReadRect(op.bounds), op.offset);
+  }
+
+  // Node links are checked up front so searches never leave the tables.
+  const size_t child_count = rtree->rtree_children_.size();
+  rtree->rtree_nodes_.reserve(nodes.size());
+  for (const auto &node : nodes) {
+    const size_t limit = node.leaf ? spatial_ops.size() : nodes.size();
+    if (node.first_child > child_count ||
+        node.child_count > child_count - node.first_child) {
+      return nullptr;
+    }
+    for (uint32_t i = 0; i < node.child_count; i++) {
+      if (rtree->rtree_children_[node.first_child + i] >= limit) {
+        return nullptr;
+      }
+    }
+    DisplayListRTree::RTreeNode rtree_node;
+    rtree_node.bounds = ReadRect(node.bounds);
+    rtree_node.first_child = node.first_child;
+    rtree_node.child_count = node.child_count;
+    rtree_node.leaf = node.leaf != 0;
+    rtree->rtree_nodes_.push_back(rtree_node);
+  }
+  if (!nodes.empty() && rtree->rtree_root_ >= nodes.size()) {
+    return nullptr;
+  }
+  return rtree;
+}
+
+std::unique_ptr<DisplayList> DisplayListSerializer::Deserialize(
+    std::shared_ptr<Data> data) {
+  if (data == nullptr || data->Size() < sizeof(FileHeader)) {
+    return nullptr;
+  }
+
+  FileHeader header;
+  std::memcpy(&header, data->RawData(), sizeof(FileHeader));
+  if (header.magic != kDisplayListMagic || header.version != kVersion) {
+    LOGE("Invalid DisplayList data header");
+    return nullptr;
+  }
+  if (header.layout_hash != kOpLayoutHash) {
+    LOGE("DisplayList data was written by an incompatible build");
+    return nullptr;
+  }
+
+  for (const auto &section : header.sections) {
+    if (section.offset > data->Size() ||
+        section.size > data->Size() - section.offset) {
+      return nullptr;
+    }
+  }
+  const auto &ops_section =
+      header.sections[static_cast<size_t>(Section::kOps)];
+  if (ops_section.size != header.byte_count ||
+      header.byte_count > std::numeric_limits<int32_t>::max()) {
+    return nullptr;
+  }
+
+  DisplayListReader reader(data, header);
+  if (!reader.ReadFixups() || !reader.ReadTables()) {
+    return nullptr;
+  }
+
+  const uint8_t *ops = data->Bytes() + ops_section.offset;
+  const size_t byte_count = static_cast<size_t>(header.byte_count);
+  if (!reader.ValidateOps(ops, byte_count)) {
+    LOGE("DisplayList data has an inconsistent op buffer");
+    return nullptr;
+  }
+
+  std::unique_ptr<DisplayListRTree> rtree;
+  if (header.has_rtree) {
+    rtree = ReadRTree(reader.SectionReader(Section::kRTree), byte_count);
+    if (rtree == nullptr) {
+      return nullptr;
+    }
+  }
+
+  // The op buffer is copied in one go; only ops owning resources are touched
+  // afterwards.
+  DisplayListStorage storage;
+  if (byte_count > 0) {
+    storage.realloc(byte_count);
+    std::memcpy(storage.get(), ops, byte_count);
+    reader.ApplyFixups(storage.get());
+  }
+
+  auto display_list = std::make_unique<DisplayList>(
+      std::move(storage), byte_count, header.op_count,
+      ReadRect(header.bounds), header.properties);
+  if (rtree) {
+    display_list->SetRTree(std::move(rtree));
+  }
+  return display_list;
+}
+
+}  // namespace skity
@@ -0,0 +1,56 @@
+// Copyright 2021 The Lynx Authors. All rights reserved.
+// Licensed under the Apache License Version 2.0 that can be found in the
+// LICENSE file in the root directory of this source tree.
+
+#ifndef SRC_RECORDER_DISPLAY_LIST_SERIALIZER_HPP
+#define SRC_RECORDER_DISPLAY_LIST_SERIALIZER_HPP
+
+#include <memory>
+#include <skity/io/data.hpp>
+#include <skity/recorder/display_list.hpp>
+
+namespace skity {
+
+class DisplayListRTree;
+class FlatReader;
+class FlatWriter;
+
+/**
+ * Native binary format of a DisplayList.
+ *
+ * Unlike the SKP path in the io module, the op buffer is written almost
+ * verbatim: trivially copyable ops are stored byte for byte, while members
+ * that own heap resources (paints, paths, text blobs, images, glyph runs) are
+ * zeroed in the file and described by a fixup table pointing into side
+ * tables. Loading is a single copy of the op buffer followed by placement
+ * construction of those members, and pixel and font data alias the source
+ * Data, so a memory mapped file is never copied.
+ *
+ * The op buffer layout is tied to the build that produced it, which is
+ * checked through a layout hash stored in the header. The format is meant to
+ * move recorded scenes between processes of the same build, not as an
+ * archival format.
+ */
+class DisplayListSerializer {
+ public:
+  static constexpr uint32_t kVersion = 1;
+
+  /**
+   * Nested display lists are serialized recursively. Returns nullptr if the
+   * display list references something the format cannot represent yet:
+   * texture backed images, or paints carrying a path effect, color filter,
+   * mask filter or image filter.
+   */
+  static std::shared_ptr<Data> Serialize(const DisplayList& display_list);
+
+  static std::unique_ptr<DisplayList> Deserialize(std::shared_ptr<Data> data);
+
+ private:
+  static void WriteRTree(const DisplayListRTree& rtree, FlatWriter* out);
+  static std::unique_ptr<DisplayListRTree> ReadRTree(FlatReader reader,
+                                                     size_t byte_count);
+};
+
+}  // namespace skity
+
+#endif  // SRC_RECORDER_DISPLAY_LIST_SERIALIZER_HPP
@@ -0,0 +1,278 @@
+// Copyright 2021 The Lynx Authors. All rights reserved.
+// Licensed under the Apache License Version 2.0 that can be found in the
+// LICENSE file in the root directory of this source tree.
+
+#include <cmath>
+#include <cstring>
+#include <list>
+#include <skity/gpu/gpu_context.hpp>
+#include <skity/gpu/gpu_render_target.hpp>
+#include <skity/graphic/bitmap.hpp>
+#include <skity/graphic/color.hpp>
+#include <skity/graphic/image.hpp>
+#include <skity/recorder/display_list.hpp>
+#include <skity/recorder/raster_cache.hpp>
+#include <skity/render/canvas.hpp>
+#include <unordered_map>
+#include <utility>
+
+#include "src/base/hash.hpp"
+
+namespace skity {
+
+namespace {
+
+// Matrix entries except the x and y translation.
+constexpr size_t kMatrixKeySize = 14;
+
+struct RasterCacheKey {
+  uint64_t display_list_id = 0;
+  uint32_t begin = 0;
+  uint32_t end = 0;
+  float matrix[kMatrixKeySize] = {};
+
+  bool operator==(const RasterCacheKey& other) const {
+    return std::memcmp(this, &other, sizeof(RasterCacheKey)) == 0;
+  }
+};
+
+struct RasterCacheKeyHash {
+  size_t operator()(const RasterCacheKey& key) const {
+    return Hash32(&key, sizeof(RasterCacheKey));
+  }
+};
+
+RasterCacheKey MakeKey(const DisplayList& display_list, uint32_t begin,
+                       uint32_t end, const Matrix& matrix) {
+  RasterCacheKey key;
+  key.display_list_id = display_list.UniqueID();
+  key.begin = begin;
+  key.end = end;
+  size_t index = 0;
+  for (int col = 0; col < 4; col++) {
+    for (int row = 0; row < 4; row++) {
+      if (col == 3 && (row == 0 || row == 1)) {
+        continue;
+      }
+      // Normalize -0.f so equal matrices always produce equal keys.
+      key.matrix[index++] = matrix[col][row] + 0.f;
+    }
+  }
+  return key;
+}
+
+}  // namespace
+
+class RasterCache::Impl {
+ public:
+  Impl(GPUContext* context, const RasterCacheOptions& options)
+      : context_(context), options_(options) {}
+
+  bool Draw(const DisplayList& display_list, uint32_t begin, uint32_t end,
+            const Rect& bounds, Canvas* canvas) {
+    const Matrix matrix = canvas->GetTotalMatrix();
+    Matrix inverse;
+    if (matrix.HasPersp() || bounds.IsEmpty() || !matrix.Invert(&inverse)) {
+      return false;
+    }
+
+    const Rect device_bounds = matrix.MapRect(bounds);
+    const float left = std::floor(device_bounds.Left());
+    const float top = std::floor(device_bounds.Top());
+    const float width = std::ceil(device_bounds.Right()) - left;
+    const float height = std::ceil(device_bounds.Bottom()) - top;
+    if (!(width > 0.f && height > 0.f) ||
+        width > static_cast<float>(options_.max_dimension) ||
+        height > static_cast<float>(options_.max_dimension)) {
+      return false;
+    }
+
+    RasterCacheKey key = MakeKey(display_list, begin, end, matrix);
+    auto it = entries_.find(key);
+    if (it == entries_.end()) {
+      lru_.emplace_front();
+      lru_.front().key = key;
+      it = entries_.emplace(key, lru_.begin()).first;
+    } else {
+      lru_.splice(lru_.begin(), lru_, it->second);
+    }
+    Entry& entry = *it->second;
+    entry.last_used_frame = frame_;
+
+    if (entry.image == nullptr) {
+      if (!Admit(display_list, begin, end, &entry) ||
+          !TakeSnapshot(display_list, begin, end, matrix, left, top,
+                        static_cast<uint32_t>(width),
+                        static_cast<uint32_t>(height), &entry)) {
+        return false;
+      }
+    } else {
+      hit_count_++;
+    }
+
+    // Device bounds move with the translation only, so the snapshot is drawn
+    // at the snapped origin of the current bounds. ResetMatrix only resets the
+    // matrix of the current layer, so undo the total matrix instead.
+    canvas->Save();
+    canvas->Concat(inverse);
+    canvas->DrawImage(entry.image, left, top);
+    canvas->Restore();
+    return true;
+  }
+
+  void EndFrame() {
+    for (auto it = lru_.begin(); it != lru_.end();) {
+      if (frame_ - it->last_used_frame >= options_.max_unused_frames) {
+        cached_bytes_ -= it->bytes;
+        entries_.erase(it->key);
+        it = lru_.erase(it);
+      } else {
+        ++it;
+      }
+    }
+    frame_++;
+  }
+
+  void Clear() {
+    entries_.clear();
+    lru_.clear();
+    cached_bytes_ = 0;
+  }
+
+  size_t GetCachedBytes() const { return cached_bytes_; }
+
+  size_t GetSnapshotCount() const {
+    size_t count = 0;
+    for (const auto& entry : lru_) {
+      count += entry.image != nullptr;
+    }
+    return count;
+  }
+
+  uint64_t GetHitCount() const { return hit_count_; }
+
+ private:
+  struct Entry {
+    RasterCacheKey key;
+    uint32_t access_count = 0;
+    uint64_t last_used_frame = 0;
+    // Complexity is computed once, when the access threshold is first met.
+    bool complexity_known = false;
+    bool cacheable = false;
+    std::shared_ptr<Image> image;
+    size_t bytes = 0;
+  };
+
+  bool Admit(const DisplayList& display_list, uint32_t begin, uint32_t end,
+             Entry* entry) {
+    entry->access_count++;
+    if (entry->access_count < options_.access_threshold) {
+      return false;
+    }
+    if (!entry->complexity_known) {
+      uint32_t complexity = 0;
+      entry->complexity_known = true;
+      entry->cacheable =
+          display_list.ComputeComplexity(begin, end, &complexity) &&
+          complexity >= options_.min_complexity;
+    }
+    return entry->cacheable;
+  }
+
+  bool TakeSnapshot(const DisplayList& display_list, uint32_t begin,
+                    uint32_t end, const Matrix& matrix, float left, float top,
+                    uint32_t width, uint32_t height, Entry* entry) {
+    const size_t bytes = static_cast<size_t>(width) * height * 4;
+    if (bytes > options_.max_bytes) {
+      return false;
+    }
+
+    auto draw = [&](Canvas* canvas) {
+      canvas->Translate(-left, -top);
+      canvas->Concat(matrix);
+      display_list.DrawOps(canvas, begin, end, nullptr);
+    };
+
+    std::shared_ptr<Image> image;
+    if (context_ != nullptr) {
+      GPURenderTargetDescriptor desc;
+      desc.width = width;
+      desc.height = height;
+      desc.sample_count = 1;
+      auto render_target = context_->CreateRenderTarget(desc);
+      if (render_target == nullptr) {
+        return false;
+      }
+      draw(render_target->GetCanvas());
+      image = context_->MakeSnapshot(std::move(render_target));
+    } else {
+      Bitmap bitmap(width, height, AlphaType::kPremul_AlphaType);
+      auto canvas = Canvas::MakeSoftwareCanvas(&bitmap);
+      if (canvas == nullptr) {
+        return false;
+      }
+      canvas->Clear(Color_TRANSPARENT);
+      draw(canvas.get());
+      canvas->Flush();
+      image = Image::MakeImage(bitmap.GetPixmap());
+    }
+    if (image == nullptr) {
+      return false;
+    }
+
+    entry->image = std::move(image);
+    entry->bytes = bytes;
+    cached_bytes_ += bytes;
+    Evict(entry);
+    return true;
+  }
+
+  // Drops least recently used snapshots until the budget is met. Access
+  // statistics are kept so evicted content can be admitted again quickly.
+  void Evict(const Entry* keep) {
+    for (auto it = lru_.rbegin();
+         it != lru_.rend() && cached_bytes_ > options_.max_bytes; ++it) {
+      if (&*it == keep || it->image == nullptr) {
+        continue;
+      }
+      cached_bytes_ -= it->bytes;
+      it->image.reset();
+      it->bytes = 0;
+    }
+  }
+
+  GPUContext* context_;
+  RasterCacheOptions options_;
+  uint64_t frame_ = 0;
+  uint64_t hit_count_ = 0;
+  size_t cached_bytes_ = 0;
+  // Most recently used entries first.
+  std::list<Entry> lru_;
+  std::unordered_map<RasterCacheKey, std::list<Entry>::iterator,
+                     RasterCacheKeyHash>
+      entries_;
+};
+
+RasterCache::RasterCache(GPUContext* context, const RasterCacheOptions& options)
+    : impl_(std::make_unique<Impl>(context, options)) {}
+
+RasterCache::~RasterCache() = default;
+
+void RasterCache::EndFrame() { impl_->EndFrame(); }
+
+void RasterCache::Clear() { impl_->Clear(); }
+
+size_t RasterCache::GetCachedBytes() const { return impl_->GetCachedBytes(); }
+
+size_t RasterCache::GetSnapshotCount() const {
+  return impl_->GetSnapshotCount();
+}
+
+uint64_t RasterCache::GetHitCount() const { return impl_->GetHitCount(); }
+
+bool RasterCache::Draw(const DisplayList& display_list, uint32_t begin,
+                       uint32_t end, const Rect& bounds, Canvas* canvas) {
+  return impl_->Draw(display_list, begin, end, bounds, canvas);
+}
+
+}  // namespace skity
@@ -9,6 +9,7 @@
 #include <skity/geometry/matrix.hpp>
 #include <skity/geometry/rect.hpp>
 #include <skity/graphic/paint.hpp>
+#include <skity/recorder/display_list.hpp>
 #include <skity/render/canvas.hpp>
 #include <skity/text/font.hpp>
 #include <skity/text/glyph.hpp>
@@ -43,7 +44,8 @@ namespace skity {
   V(SaveLayer)                  \
   V(DrawTextBlob)               \
   V(DrawImage)                  \
-  V(DrawGlyphs)
+  V(DrawGlyphs)                 \
+  V(DrawDisplayList)
 
 #define OP_TO_ENUM_VALUE(name) k##name,
 enum class RecordedOpType { FOR_EACH_RECORDED_OP(OP_TO_ENUM_VALUE) };
@@ -310,6 +312,13 @@ struct DrawGlyphsOp : RecordedOp {
   Paint paint;
 };
 
+struct DrawDisplayListOp : RecordedOp {
+  explicit DrawDisplayListOp(std::shared_ptr<const DisplayList> display_list)
+      : RecordedOp(RecordedOpType::kDrawDisplayList),
+        display_list(std::move(display_list)) {}
+  std::shared_ptr<const DisplayList> display_list;
+};
+
 }  // namespace skity
 
 #endif  // SRC_RECORDER_RECORDED_OP_HPP
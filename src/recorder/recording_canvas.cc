@@ -72,6 +72,18 @@ void RecordingCanvas::BindDisplayListBuilder(DisplayListBuilder* dp_builder) {
   CalculateGlobalClipBounds(dp_builder_->cull_rect_, ClipOp::kIntersect);
 }
 
+void RecordingCanvas::DrawDisplayList(
+    std::shared_ptr<const DisplayList> display_list) {
+  if (dp_builder_ == nullptr || display_list == nullptr ||
+      display_list->Empty()) {
+    return;
+  }
+  const Rect bounds = display_list->GetBounds();
+  dp_builder_->properties_ |= display_list->properties_;
+  Push<DrawDisplayListOp>(std::move(display_list));
+  AccumulateOpBounds(bounds, nullptr);
+}
+
 void RecordingCanvas::OnClipRect(Rect const& rect, ClipOp op) {
   Push<ClipRectOp>(rect, op);
 }
@@ -16,6 +16,26 @@
 
 namespace skity {
 
+namespace {
+
+// Counts one draw call for the outermost DrawXXX only. The default OnDrawXXX
+// implementations, and some renderers, route through other DrawXXX calls.
+class AutoDrawCall {
+ public:
+  AutoDrawCall(FrameStats* stats, uint32_t* depth) : depth_(depth) {
+    if ((*depth_)++ == 0) {
+      stats->Increment(FrameCounter::kDrawCalls);
+    }
+  }
+
+  ~AutoDrawCall() { (*depth_)--; }
+
+ private:
+  uint32_t* depth_;
+};
+
+}  // namespace
+
 Canvas::Canvas(Rect cull_rect) {
   canvas_state_ = std::make_unique<CanvasState>();
   global_clip_bounds_stack_.push_back(cull_rect);
@@ -172,10 +192,12 @@ void Canvas::DrawLine(float x0, float y0, float x1, float y1,
     wp.SetStyle(Paint::kStroke_Style);
   }
 
+  AutoDrawCall draw_call(&frame_stats_, &draw_call_depth_);
   this->OnDrawLine(x0, y0, x1, y1, wp);
 }
 
 void Canvas::DrawCircle(float cx, float cy, float radius, Paint const &paint) {
+  AutoDrawCall draw_call(&frame_stats_, &draw_call_depth_);
   this->OnDrawCircle(cx, cy, radius, paint);
 }
 
@@ -196,23 +218,28 @@ void Canvas::DrawArc(Rect const &oval, float startAngle, float sweepAngle,
   PathPriv::CreateDrawArcPath(&path, oval, startAngle, sweepAngle, useCenter,
                               isFillNoPathEffect);
 
+  AutoDrawCall draw_call(&frame_stats_, &draw_call_depth_);
   this->OnDrawPath(path, paint);
 }
 
 void Canvas::DrawOval(Rect const &oval, Paint const &paint) {
+  AutoDrawCall draw_call(&frame_stats_, &draw_call_depth_);
   this->OnDrawOval(oval, paint);
 }
 
 void Canvas::DrawRect(Rect const &rect, Paint const &paint) {
+  AutoDrawCall draw_call(&frame_stats_, &draw_call_depth_);
   this->OnDrawRect(rect, paint);
 }
 
 void Canvas::DrawRRect(RRect const &rrect, Paint const &paint) {
+  AutoDrawCall draw_call(&frame_stats_, &draw_call_depth_);
   this->OnDrawRRect(rrect, paint);
 }
 
 void Canvas::DrawRoundRect(Rect const &rect, float rx, float ry,
                            Paint const &paint) {
+  AutoDrawCall draw_call(&frame_stats_, &draw_call_depth_);
   this->OnDrawRoundRect(rect, rx, ry, paint);
 }
 
@@ -231,10 +258,12 @@ void Canvas::DrawDRRect(RRect const &outer, RRect const &inner,
     return;
   }
 
+  AutoDrawCall draw_call(&frame_stats_, &draw_call_depth_);
   this->OnDrawDRRect(outer, inner, paint);
 }
 
 void Canvas::DrawPath(const Path &path, const Paint &paint) {
+  AutoDrawCall draw_call(&frame_stats_, &draw_call_depth_);
   this->OnDrawPath(path, paint);
 }
 
@@ -250,7 +279,10 @@ void Canvas::DrawColor(Color4f color, BlendMode mode) {
   this->DrawPaint(paint);
 }
 
-void Canvas::DrawPaint(const Paint &paint) { this->OnDrawPaint(paint); }
+void Canvas::DrawPaint(const Paint &paint) {
+  AutoDrawCall draw_call(&frame_stats_, &draw_call_depth_);
+  this->OnDrawPaint(paint);
+}
 
 int Canvas::SaveLayer(const Rect &bounds, const Paint &paint) {
   if (bounds.IsEmpty() || QuickReject(bounds)) {
@@ -341,6 +373,7 @@ void Canvas::DrawTextBlob(const TextBlob *blob, float x, float y,
     return;
   }
 
+  AutoDrawCall draw_call(&frame_stats_, &draw_call_depth_);
   this->OnDrawBlob(blob, x, y, paint);
 }
 
@@ -369,6 +402,7 @@ void Canvas::DrawImage(const std::shared_ptr<Image> &image, const Rect &rect,
     return;
   }
   auto src = Rect::MakeWH(image->Width(), image->Height());
+  AutoDrawCall draw_call(&frame_stats_, &draw_call_depth_);
   this->OnDrawImageRect(image, src, rect, sampling, paint);
 }
 
@@ -378,12 +412,14 @@ void Canvas::DrawImageRect(const std::shared_ptr<Image> &image, const Rect &src,
   if (!image) {
     return;
   }
+  AutoDrawCall draw_call(&frame_stats_, &draw_call_depth_);
   this->OnDrawImageRect(image, src, dst, sampling, paint);
 }
 
 void Canvas::DrawGlyphs(int count, const GlyphID *glyphs,
                         const float *position_x, const float *position_y,
                         const Font &font, const Paint &paint) {
+  AutoDrawCall draw_call(&frame_stats_, &draw_call_depth_);
   this->OnDrawGlyphs(count, glyphs, position_x, position_y, font, paint);
 }
 
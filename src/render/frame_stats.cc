@@ -0,0 +1,141 @@
+// Copyright 2021 The Lynx Authors. All rights reserved.
+// Licensed under the Apache License Version 2.0 that can be found in the
+// LICENSE file in the root directory of this source tree.
+
+#include <algorithm>
+#include <cmath>
+#include <skity/render/frame_stats.hpp>
+
+namespace skity {
+
+size_t FrameHistogramData::BucketIndex(uint64_t value) {
+  size_t index = 0;
+  while (value != 0 && index + 1 < kBucketCount) {
+    value >>= 1;
+    index++;
+  }
+  return index;
+}
+
+void FrameHistogramData::Record(uint64_t value) {
+  if (count == 0) {
+    min = value;
+    max = value;
+  } else {
+    min = std::min(min, value);
+    max = std::max(max, value);
+  }
+
+  count++;
+  sum += value;
+  buckets[BucketIndex(value)]++;
+}
+
+void FrameHistogramData::Merge(const FrameHistogramData& other) {
+  if (other.count == 0) {
+    return;
+  }
+
+  if (count == 0) {
+    min = other.min;
+    max = other.max;
+  } else {
+    min = std::min(min, other.min);
+    max = std::max(max, other.max);
+  }
+
+  count += other.count;
+  sum += other.sum;
+  for (size_t i = 0; i < kBucketCount; i++) {
+    buckets[i] += other.buckets[i];
+  }
+}
+
+uint64_t FrameHistogramData::ApproximatePercentile(float percentile) const {
+  if (count == 0) {
+    return 0;
+  }
+
+  float clamped = std::min(std::max(percentile, 0.f), 100.f);
+  uint64_t rank = static_cast<uint64_t>(
+      std::ceil(static_cast<double>(count) * clamped / 100.0));
+  rank = std::max<uint64_t>(rank, 1);
+
+  uint64_t seen = 0;
+  for (size_t i = 0; i < kBucketCount; i++) {
+    seen += buckets[i];
+    if (seen >= rank) {
+      uint64_t upper = i == 0 ? 0 : (uint64_t{1} << i) - 1;
+      return std::min(std::max(upper, min), max);
+    }
+  }
+
+  return max;
+}
+
+void FrameStats::Merge(const FrameStats& other) {
+  for (size_t i = 0; i < kCounterCount; i++) {
+    counters_[i] += other.counters_[i];
+  }
+
+  for (size_t i = 0; i < kHistogramCount; i++) {
+    histograms_[i].Merge(other.histograms_[i]);
+  }
+}
+
+void FrameStats::Reset() {
+  counters_.fill(0);
+  histograms_.fill(FrameHistogramData{});
+}
+
+const char* FrameStats::GetCounterName(FrameCounter counter) {
+  switch (counter) {
+    case FrameCounter::kDrawCalls:
+      return "draw_calls";
+    case FrameCounter::kMergedDraws:
+      return "merged_draws";
+    case FrameCounter::kPipelineCacheHits:
+      return "pipeline_cache_hits";
+    case FrameCounter::kPipelineCompiles:
+      return "pipeline_compiles";
+    case FrameCounter::kPipelineCompileFailures:
+      return "pipeline_compile_failures";
+    case FrameCounter::kTessellatedPaths:
+      return "tessellated_paths";
+    case FrameCounter::kTessellatedTriangles:
+      return "tessellated_triangles";
+    case FrameCounter::kStageBufferBytes:
+      return "stage_buffer_bytes";
+    case FrameCounter::kStageIndexBytes:
+      return "stage_index_bytes";
+    case FrameCounter::kGlyphCacheHits:
+      return "glyph_cache_hits";
+    case FrameCounter::kGlyphCacheMisses:
+      return "glyph_cache_misses";
+    case FrameCounter::kAtlasUploadBytes:
+      return "atlas_upload_bytes";
+    case FrameCounter::kStrokeCacheHits:
+      return "stroke_cache_hits";
+    case FrameCounter::kStrokeCacheMisses:
+      return "stroke_cache_misses";
+    case FrameCounter::kCount:
+      break;
+  }
+  return "unknown";
+}
+
+const char* FrameStats::GetHistogramName(FrameHistogram histogram) {
+  switch (histogram) {
+    case FrameHistogram::kPipelineCompileMicros:
+      return "pipeline_compile_micros";
+    case FrameHistogram::kTrianglesPerPath:
+      return "triangles_per_path";
+    case FrameHistogram::kGlyphsPerDraw:
+      return "glyphs_per_draw";
+    case FrameHistogram::kCount:
+      break;
+  }
+  return "unknown";
+}
+
+}  // namespace skity
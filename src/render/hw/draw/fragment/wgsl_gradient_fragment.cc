@@ -157,7 +157,9 @@ HWFunctionBaseKey WGSLGradientFragment::GetMainKey() const {
                      gradient_fragment_.GetCustomKey());
 }
 
-uint32_t WGSLGradientFragment::NextBindingIndex() const { return 2; }
+uint32_t WGSLGradientFragment::NextBindingIndex() const {
+  return gradient_fragment_.GetBindingCount();
+}
 
 void WGSLGradientFragment::PrepareCMD(Command* cmd, HWDrawContext* context) {
   SKITY_TRACE_EVENT(WGSLGradientFragment_PrepareCMD);
@@ -196,6 +198,11 @@ void WGSLGradientFragment::PrepareCMD(Command* cmd, HWDrawContext* context) {
 
   UploadBindGroup(group->group, gradient_type_entry, cmd, context);
 
+  if (!gradient_fragment_.SetupLUT(group->group, group->GetEntry(2),
+                                   group->GetEntry(3), cmd, context)) {
+    return;
+  }
+
   if (filter_ != nullptr) {
     filter_->SetupBindGroup(cmd, context);
   }
@@ -241,7 +241,9 @@ std::string WGSLColorEmojiFragment::GenSourceWGSL() const {
   return wgsl_code;
 }
 
-uint32_t WGSLGradientTextFragment::NextBindingIndex() const { return 7; }
+uint32_t WGSLGradientTextFragment::NextBindingIndex() const {
+  return 5 + gradient_fragment_.GetBindingCount();
+}
 
 HWFunctionBaseKey WGSLGradientTextFragment::GetMainKey() const {
   HWFunctionBaseKey main = MakeMainKey(HWFragmentKeyType::kGradientText,
@@ -397,6 +399,11 @@ void WGSLGradientTextFragment::PrepareCMD(Command* cmd,
 
   UploadBindGroup(group->group, entry, cmd, context);
 
+  if (!gradient_fragment_.SetupLUT(group->group, group->GetEntry(7),
+                                   group->GetEntry(8), cmd, context)) {
+    return;
+  }
+
   if (filter_ != nullptr) {
     filter_->SetupBindGroup(cmd, context);
   }
@@ -4,6 +4,8 @@
 
 #include "src/render/hw/draw/geometry/wgsl_path_geometry.hpp"
 
+#include <skity/render/frame_stats.hpp>
+
 #include "src/render/hw/draw/wgx_utils.hpp"
 #include "src/render/hw/hw_draw.hpp"
 #include "src/render/hw/hw_path_aa_outline.hpp"
@@ -58,6 +60,18 @@ void UploadData(Command* cmd, HWDrawContext* context,
   cmd->index_count = index.size();
 }
 
+void RecordTessellation(HWDrawContext* context, size_t index_count) {
+  if (context->frame_stats == nullptr) {
+    return;
+  }
+
+  uint64_t triangles = index_count / 3;
+  context->frame_stats->Increment(FrameCounter::kTessellatedPaths);
+  context->frame_stats->Increment(FrameCounter::kTessellatedTriangles,
+                                  triangles);
+  context->frame_stats->Record(FrameHistogram::kTrianglesPerPath, triangles);
+}
+
 }  // namespace
 
 WGSLPathGeometry::WGSLPathGeometry(const Path& path, const Paint& paint,
@@ -123,6 +137,7 @@ void WGSLPathGeometry::PrepareCMD(Command* cmd, HWDrawContext* context,
 
     raster.StrokePath(path_);
 
+    RecordTessellation(context, raster.GetRawIndexBuffer().size());
     UploadData(cmd, context, raster.GetRawVertexBuffer(),
                raster.GetRawIndexBuffer());
   } else {
@@ -131,6 +146,8 @@ void WGSLPathGeometry::PrepareCMD(Command* cmd, HWDrawContext* context,
                             context->index_vector_cache};
 
     raster.FillPath(path_);
+
+    RecordTessellation(context, raster.GetRawIndexBuffer().size());
     UploadData(cmd, context, raster.GetRawVertexBuffer(),
                raster.GetRawIndexBuffer());
   }
@@ -202,6 +219,7 @@ void WGSLPathAAGeometry::PrepareCMD(Command* cmd, HWDrawContext* context,
                          context->vertex_vector_cache,
                          context->index_vector_cache, context->ctx_scale};
   raster.StrokeAAOutline(path_);
+  RecordTessellation(context, raster.GetRawIndexBuffer().size());
   UploadData(cmd, context, raster.GetRawVertexBuffer(),
              raster.GetRawIndexBuffer());
 
@@ -53,6 +53,10 @@ void HWDrawStep::GenerateCommand(const HWDrawStepContext& ctx, Command* cmd,
   if (fragment_->GetProgrammableBlending()) {
     fragment_->GetProgrammableBlending()->SetupBindGroup(cmd, ctx.context);
   }
+
+  if (fragment_->GetAnalyticClip()) {
+    fragment_->GetAnalyticClip()->SetupBindGroup(cmd, ctx.context);
+  }
 }
 
 bool HWDrawStep::PrecompilePipeline(HWDrawContext* context, HWDrawState state,
@@ -111,7 +115,8 @@ GPURenderPipeline* HWDrawStep::GetPipeline(HWDrawContext* context,
   pipeline.shader_generator = this;
 
   HWPipelineKey key = GetPipelineKey();
-  return context->pipelineLib->GetPipeline(key, pipeline);
+  return context->pipelineLib->GetPipeline(key, pipeline,
+                                           context->frame_stats);
 }
 
 }  // namespace skity
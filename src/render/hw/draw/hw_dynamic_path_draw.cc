@@ -34,7 +34,8 @@ void HWDynamicPathDraw::OnGenerateDrawStep(ArrayList<HWDrawStep*, 2>& steps,
   auto geom = GenGeometry(context, false);
 
   auto frag = GenShadingFragment(context, paint_, is_stroke_);
-  ConfigureShadingFragment(context, paint_, GetBlendPlan(), frag);
+  ConfigureShadingFragment(context, paint_, GetBlendPlan(), frag,
+                           GetAnalyticClips());
 
   CoverageType coverage = CoverageType::kNone;
 
@@ -60,7 +61,8 @@ void HWDynamicPathDraw::OnGenerateDrawStep(ArrayList<HWDrawStep*, 2>& steps,
     auto geometry = GenGeometry(context, true);
 
     auto fragment = GenShadingFragment(context, paint_, is_stroke_);
-    ConfigureShadingFragment(context, paint_, GetBlendPlan(), fragment);
+    ConfigureShadingFragment(context, paint_, GetBlendPlan(), fragment,
+                             GetAnalyticClips());
 
     steps.emplace_back(context->arena_allocator->Make<ColorAAStep>(
         std::move(geometry), std::move(fragment), coverage));
@@ -22,6 +22,10 @@ class HWDynamicPathDraw : public HWDynamicDraw {
 
   ~HWDynamicPathDraw() override = default;
 
+  bool SupportsAnalyticClip() const override {
+    return BlendsCoverageAsSourceScale(GetBlendPlan());
+  }
+
  protected:
   void OnGenerateDrawStep(ArrayList<HWDrawStep *, 2> &steps,
                           HWDrawContext *context) override;
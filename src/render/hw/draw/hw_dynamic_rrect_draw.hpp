@@ -23,6 +23,10 @@ class HWDynamicRRectDraw : public HWDynamicDraw {
 
   HWDrawType GetDrawType() const override { return HWDrawType::kRRect; }
 
+  bool SupportsAnalyticClip() const override {
+    return BlendsCoverageAsSourceScale(GetBlendPlan());
+  }
+
   bool OnMergeIfPossible(HWDraw* draw) override;
 
  protected:
@@ -9,6 +9,7 @@
 #include <sstream>
 
 #include "src/gpu/gpu_render_pass.hpp"
+#include "src/render/hw/draw/wgx_analytic_clip.hpp"
 #include "src/render/hw/draw/wgx_filter.hpp"
 #include "src/render/hw/draw/wgx_programmable_blending.hpp"
 #include "src/render/hw/hw_pipeline_key.hpp"
@@ -182,6 +183,12 @@ class HWWGSLFragment {
     return blending_ ? blending_.get() : nullptr;
   }
 
+  void SetAnalyticClip(std::unique_ptr<WGXAnalyticClip> analytic_clip) {
+    analytic_clip_ = std::move(analytic_clip);
+  }
+
+  WGXAnalyticClip* GetAnalyticClip() const { return analytic_clip_.get(); }
+
   // Marks that this draw blends via the hardware-native advanced-blend path.
   // No programmable-blending object is attached in that case, so this flag is
   // what lets the pipeline key/encoder know the fragment shader must be built
@@ -203,6 +210,7 @@ class HWWGSLFragment {
  protected:
   std::unique_ptr<WGXFilterFragment> filter_ = {};
   std::unique_ptr<WGXProgrammableBlending> blending_ = {};
+  std::unique_ptr<WGXAnalyticClip> analytic_clip_ = {};
 
  private:
   uint32_t flags_;
@@ -5,6 +5,7 @@
 #include "src/render/hw/draw/hw_wgsl_shader_writer.hpp"
 
 #include <sstream>
+#include <string>
 #include <string_view>
 
 #include "src/logging.hpp"
@@ -101,6 +102,9 @@ void HWWGSLShaderWriter::WriteFSFunctionsAndStructs(
   if (fragment_->GetProgrammableBlending()) {
     ss << fragment_->GetProgrammableBlending()->GenSourceWGSL();
   }
+  if (fragment_->GetAnalyticClip()) {
+    ss << fragment_->GetAnalyticClip()->GenSourceWGSL();
+  }
 }
 
 void HWWGSLShaderWriter::WriteFSUniforms(std::stringstream& ss) const {
@@ -113,13 +117,13 @@ void HWWGSLShaderWriter::WriteFSUniforms(std::stringstream& ss) const {
 
 void HWWGSLShaderWriter::WriteFSInput(std::stringstream& ss) const {
   DEBUG_CHECK(fragment_);
-  if (!HasVarings() && !NeedsTextureCopy()) {
+  if (!HasVarings() && !NeedsFragPosition()) {
     return;
   }
   ss << R"(
 struct FSInput {
 )";
-  if (NeedsTextureCopy()) {
+  if (NeedsFragPosition()) {
     ss << R"(
   @builtin(position) frag_pos: vec4<f32>,
 )";
@@ -135,7 +139,7 @@ void HWWGSLShaderWriter::WriteFSMain(std::stringstream& ss) const {
   ss << "@fragment\n";
   ss << "fn fs_main(";
   std::vector<std::string> fs_params;
-  if (HasVarings() || NeedsTextureCopy()) {
+  if (HasVarings() || NeedsFragPosition()) {
     fs_params.push_back("input: FSInput");
   }
   if (NeedsFramebufferFetch()) {
@@ -167,6 +171,12 @@ void HWWGSLShaderWriter::WriteFSMain(std::stringstream& ss) const {
 )";
   }
 
+  if (NeedsAnalyticClip()) {
+    ss << R"(
+  color = color * analytic_clip_coverage(input.frag_pos.xy);
+)";
+  }
+
   if (NeedsFramebufferFetch()) {
     ss << R"(
   color = blending(color, dst_color);
@@ -249,6 +259,10 @@ std::string HWWGSLShaderWriter::GetFSShaderName() const {
   auto fs_key = GetFSKey();
   std::string name =
       "FS_" + FragmentKeyToShaderName(fs_key, GetComposeKeys(fs_key));
+  if (NeedsAnalyticClip()) {
+    name += "_AnalyticClip" +
+            std::to_string(fragment_->GetAnalyticClip()->GetAnalyticClipKey());
+  }
 
   return name;
 }
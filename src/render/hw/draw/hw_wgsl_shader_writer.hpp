@@ -39,6 +39,9 @@ class HWWGSLShaderWriter {
             ? fragment_->GetProgrammableBlending()->GetProgrammableBlendingKey()
         : fragment_->UsesNativeAdvancedBlend() ? kNativeAdvancedBlendKey
                                                : 0;
+    key.analytic_clip = fragment_->GetAnalyticClip()
+                            ? fragment_->GetAnalyticClip()->GetAnalyticClipKey()
+                            : 0;
     return key;
   }
 
@@ -77,6 +80,14 @@ class HWWGSLShaderWriter {
            fragment_->GetProgrammableBlending()->UsesFramebufferFetch();
   }
 
+  bool NeedsAnalyticClip() const {
+    return fragment_ != nullptr && fragment_->GetAnalyticClip() != nullptr;
+  }
+
+  bool NeedsFragPosition() const {
+    return NeedsTextureCopy() || NeedsAnalyticClip();
+  }
+
   bool NeedsTextureCopy() const {
     return fragment_ != nullptr &&
            fragment_->GetProgrammableBlending() != nullptr &&
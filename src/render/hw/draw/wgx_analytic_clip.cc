@@ -0,0 +1,119 @@
+// Copyright 2021 The Lynx Authors. All rights reserved.
+// Licensed under the Apache License Version 2.0 that can be found in the
+// LICENSE file in the root directory of this source tree.
+
+#include "src/render/hw/draw/wgx_analytic_clip.hpp"
+
+#include <wgsl_cross.h>
+
+#include <sstream>
+
+#include "src/gpu/gpu_render_pass.hpp"
+#include "src/logging.hpp"
+#include "src/render/hw/draw/wgx_utils.hpp"
+#include "src/render/hw/hw_draw.hpp"
+
+namespace skity {
+
+namespace {
+// Group 0 and 1 are used by geometry and fragment, group 2 by dst read.
+constexpr uint32_t kAnalyticClipGroup = 3;
+constexpr uint32_t kAnalyticClipBinding = 0;
+constexpr char kAnalyticClipInfoType[] = "AnalyticClipInfo";
+}  // namespace
+
+std::string WGXAnalyticClip::GenSourceWGSL() const {
+  DEBUG_CHECK(clips_ != nullptr && clips_->count > 0);
+  const uint32_t count = clips_->count;
+
+  std::stringstream ss;
+  ss << "\nstruct " << kAnalyticClipInfoType << " {\n";
+  ss << "  rects   : array<vec4<f32>, " << count << ">,\n";
+  ss << "  radii_x : array<vec4<f32>, " << count << ">,\n";
+  ss << "  radii_y : array<vec4<f32>, " << count << ">,\n";
+  ss << "};\n";
+  ss << "@group(" << kAnalyticClipGroup << ") @binding("
+     << kAnalyticClipBinding << ") var<uniform> uAnalyticClip : "
+     << kAnalyticClipInfoType << ";\n";
+
+  // Corners of the radii vectors are in RRect::Corner order: upper left, upper
+  // right, lower right, lower left. Elliptical corners use the implicit
+  // function divided by its gradient as distance estimate.
+  ss << R"(
+fn analytic_rrect_coverage(p: vec2<f32>, rect: vec4<f32>,
+                           radii_x: vec4<f32>, radii_y: vec4<f32>) -> f32 {
+  let center: vec2<f32> = (rect.xy + rect.zw) * 0.5;
+  let half_size: vec2<f32> = (rect.zw - rect.xy) * 0.5;
+  var r: vec2<f32>;
+  if (p.y < center.y) {
+    r = select(vec2<f32>(radii_x.y, radii_y.y), vec2<f32>(radii_x.x, radii_y.x),
+               p.x < center.x);
+  } else {
+    r = select(vec2<f32>(radii_x.z, radii_y.z), vec2<f32>(radii_x.w, radii_y.w),
+               p.x < center.x);
+  }
+  let q: vec2<f32> = abs(p - center) - half_size + r;
+  var dist: f32 = max(q.x - r.x, q.y - r.y);
+  if (q.x > 0.0 && q.y > 0.0 && r.x > 0.0 && r.y > 0.0) {
+    let v: vec2<f32> = q / r;
+    let grad: vec2<f32> = 2.0 * v / r;
+    dist = (dot(v, v) - 1.0) / max(length(grad), 0.0001);
+  }
+  return clamp(0.5 - dist, 0.0, 1.0);
+}
+
+fn analytic_clip_coverage(frag_pos: vec2<f32>) -> f32 {
+  var coverage: f32 = 1.0;
+)";
+  for (uint32_t i = 0; i < count; i++) {
+    ss << "  coverage = coverage * analytic_rrect_coverage(frag_pos, "
+       << "uAnalyticClip.rects[" << i << "], uAnalyticClip.radii_x[" << i
+       << "], uAnalyticClip.radii_y[" << i << "]);\n";
+  }
+  ss << R"(  return coverage;
+}
+)";
+  return ss.str();
+}
+
+void WGXAnalyticClip::SetupBindGroup(Command* cmd, HWDrawContext* context) {
+  if (cmd->pipeline == nullptr) {
+    return;
+  }
+
+  auto group = cmd->pipeline->GetBindingGroup(kAnalyticClipGroup);
+  if (group == nullptr) {
+    return;
+  }
+
+  auto entry = group->GetEntry(kAnalyticClipBinding);
+  if (entry == nullptr || entry->type_definition == nullptr ||
+      entry->type_definition->name != kAnalyticClipInfoType) {
+    return;
+  }
+
+  auto info = static_cast<wgx::StructDefinition*>(entry->type_definition.get());
+  auto rects =
+      static_cast<wgx::ArrayDefinition*>(info->GetMember("rects")->type);
+  auto radii_x =
+      static_cast<wgx::ArrayDefinition*>(info->GetMember("radii_x")->type);
+  auto radii_y =
+      static_cast<wgx::ArrayDefinition*>(info->GetMember("radii_y")->type);
+
+  for (uint32_t i = 0; i < clips_->count; i++) {
+    const auto& clip = clips_->clips[i];
+    std::array<float, 4> rect{clip.rect.Left(), clip.rect.Top(),
+                              clip.rect.Right(), clip.rect.Bottom()};
+    std::array<float, 4> rx{clip.radii[0].x, clip.radii[1].x, clip.radii[2].x,
+                            clip.radii[3].x};
+    std::array<float, 4> ry{clip.radii[0].y, clip.radii[1].y, clip.radii[2].y,
+                            clip.radii[3].y};
+    rects->SetDataAt(i, rect.data(), sizeof(float) * 4);
+    radii_x->SetDataAt(i, rx.data(), sizeof(float) * 4);
+    radii_y->SetDataAt(i, ry.data(), sizeof(float) * 4);
+  }
+
+  UploadBindGroup(group->group, entry, cmd, context);
+}
+
+}  // namespace skity
@@ -0,0 +1,90 @@
+// Copyright 2021 The Lynx Authors. All rights reserved.
+// Licensed under the Apache License Version 2.0 that can be found in the
+// LICENSE file in the root directory of this source tree.
+
+#ifndef SRC_RENDER_HW_DRAW_WGX_ANALYTIC_CLIP_HPP
+#define SRC_RENDER_HW_DRAW_WGX_ANALYTIC_CLIP_HPP
+
+#include <array>
+#include <memory>
+#include <skity/geometry/matrix.hpp>
+#include <skity/geometry/rrect.hpp>
+#include <string>
+
+namespace skity {
+
+struct Command;
+struct HWDrawContext;
+
+// Number of analytic clips a single draw can evaluate. Deeper clip stacks fall
+// back to stencil clipping for the extra clips.
+constexpr uint32_t kMaxAnalyticClipCount = 4;
+
+/**
+ * An intersect rounded rect clip evaluated in the fragment stage.
+ */
+struct HWAnalyticClip {
+  // Clip rect and corner radii in fragment coordinates of the layer render
+  // target, radii in RRect::Corner order.
+  Rect rect = {};
+  std::array<Vec2, 4> radii = {};
+  // Source of the clip, used to build a stencil clip for draws which can not
+  // evaluate analytic clips.
+  RRect local_rrect = {};
+  Matrix transform = {};
+  uint32_t sample_count = 1;
+  bool use_gpu_tessellation = false;
+};
+
+/**
+ * Immutable snapshot of the analytic clips active in a layer. A new snapshot
+ * is allocated for every change, so draws can compare them by pointer.
+ */
+struct HWAnalyticClipSet {
+  uint32_t count = 0;
+  std::array<HWAnalyticClip, kMaxAnalyticClipCount> clips = {};
+};
+
+/**
+ * Code generator for the analytic clip coverage of a fragment shader.
+ *
+ * It contains the clip uniform:
+ * ```
+ *  struct AnalyticClipInfo {
+ *    rects   : array<vec4<f32>, N>,
+ *    radii_x : array<vec4<f32>, N>,
+ *    radii_y : array<vec4<f32>, N>,
+ *  };
+ * ```
+ *
+ * and the function returning the coverage of all clips:
+ *
+ * fn analytic_clip_coverage(frag_pos: vec2<f32>) -> f32;
+ */
+class WGXAnalyticClip {
+ public:
+  explicit WGXAnalyticClip(const HWAnalyticClipSet* clips) : clips_(clips) {}
+
+  ~WGXAnalyticClip() = default;
+
+  std::string GenSourceWGSL() const;
+
+  uint32_t GetAnalyticClipKey() const { return clips_->count; }
+
+  void SetupBindGroup(Command* cmd, HWDrawContext* context);
+
+  static std::unique_ptr<WGXAnalyticClip> Make(
+      const HWAnalyticClipSet* clips) {
+    if (clips == nullptr || clips->count == 0) {
+      return nullptr;
+    }
+    return std::make_unique<WGXAnalyticClip>(clips);
+  }
+
+ private:
+  const HWAnalyticClipSet* clips_;
+};
+
+}  // namespace skity
+
+#endif  // SRC_RENDER_HW_DRAW_WGX_ANALYTIC_CLIP_HPP
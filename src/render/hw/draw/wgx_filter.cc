@@ -7,6 +7,7 @@
 #include <vector>
 
 #include "src/effect/color_filter_base.hpp"
+#include "src/effect/color_filter_program.hpp"
 #include "src/gpu/gpu_render_pass.hpp"
 #include "src/render/hw/draw/wgx_utils.hpp"
 #include "src/render/hw/hw_draw.hpp"
@@ -27,6 +28,145 @@ std::string WGXFilterFragment::GenFunctionSignature() const {
   return signature;
 }
 
+namespace {
+
+HWColorFilterKeyType::Value BlendModeToFilterKey(BlendMode mode) {
+  switch (mode) {
+    case BlendMode::kClear:
+      return HWColorFilterKeyType::kClear;
+    case BlendMode::kSrc:
+      return HWColorFilterKeyType::kSrc;
+    case BlendMode::kDst:
+      return HWColorFilterKeyType::kDst;
+    case BlendMode::kSrcOver:
+      return HWColorFilterKeyType::kSrcOver;
+    case BlendMode::kDstOver:
+      return HWColorFilterKeyType::kDstOver;
+    case BlendMode::kSrcIn:
+      return HWColorFilterKeyType::kSrcIn;
+    case BlendMode::kDstIn:
+      return HWColorFilterKeyType::kDstIn;
+    case BlendMode::kSrcOut:
+      return HWColorFilterKeyType::kSrcOut;
+    case BlendMode::kDstOut:
+      return HWColorFilterKeyType::kDstOut;
+    case BlendMode::kSrcATop:
+      return HWColorFilterKeyType::kSrcATop;
+    case BlendMode::kDstATop:
+      return HWColorFilterKeyType::kDstATop;
+    case BlendMode::kXor:
+      return HWColorFilterKeyType::kXor;
+    case BlendMode::kPlus:
+      return HWColorFilterKeyType::kPlus;
+    case BlendMode::kModulate:
+      return HWColorFilterKeyType::kModulate;
+    case BlendMode::kScreen:
+      return HWColorFilterKeyType::kScreen;
+    default:
+      return HWColorFilterKeyType::kUnknown;
+  }
+}
+
+// WGSL expression blending the premultiplied constant `src` with the
+// premultiplied filter input `dst`.
+std::string BlendFilterExpression(BlendMode mode, const std::string& src,
+                                  const std::string& dst) {
+  switch (mode) {
+    case BlendMode::kClear:
+      return "vec4<f32>(0.0, 0.0, 0.0, 0.0)";
+    case BlendMode::kSrc:
+      return src;
+    case BlendMode::kDst:
+      return dst;
+    case BlendMode::kSrcOver:
+      return src + " + " + dst + " * (1.0 - " + src + ".a)";
+    case BlendMode::kDstOver:
+      return dst + " + " + src + " * (1.0 - " + dst + ".a)";
+    case BlendMode::kSrcIn:
+      return src + " * " + dst + ".a";
+    case BlendMode::kDstIn:
+      return dst + " * " + src + ".a";
+    case BlendMode::kSrcOut:
+      return src + " * (1.0 - " + dst + ".a)";
+    case BlendMode::kDstOut:
+      return dst + " * (1.0 - " + src + ".a)";
+    case BlendMode::kSrcATop:
+      return src + " * " + dst + ".a + " + dst + " * (1.0 - " + src + ".a)";
+    case BlendMode::kDstATop:
+      return src + ".a * " + dst + " + " + src + " * (1.0 - " + dst + ".a)";
+    case BlendMode::kXor:
+      return src + " * (1.0 - " + dst + ".a) + " + dst + " * (1.0 - " + src +
+             ".a)";
+    case BlendMode::kPlus:
+      return "min(" + src + " + " + dst + ", vec4<f32>(1.0))";
+    case BlendMode::kModulate:
+      return src + " * " + dst;
+    case BlendMode::kScreen:
+      return src + " + " + dst + " - " + src + " * " + dst;
+    default:
+      return "vec4<f32>(0.0, 0.0, 0.0, 0.0)";
+  }
+}
+
+bool BlendFilterNeedsColor(BlendMode mode) {
+  return mode != BlendMode::kClear && mode != BlendMode::kDst;
+}
+
+Color4f PremulColor(Color color) {
+  auto color4f = Color4fFromColor(color);
+  color4f[0] *= color4f[3];
+  color4f[1] *= color4f[3];
+  color4f[2] *= color4f[3];
+  return color4f;
+}
+
+// Column major multiply part and additive part of a row major 4x5 matrix.
+std::tuple<Matrix, Vec4> SplitColorMatrix(const float m[20]) {
+  auto matrix_mul = Matrix{
+      m[0], m[5], m[10], m[15],  //
+      m[1], m[6], m[11], m[16],  //
+      m[2], m[7], m[12], m[17],  //
+      m[3], m[8], m[13], m[18],  //
+  };
+
+  auto matrix_add = Vec4{m[4], m[9], m[14], m[19]};
+  return std::make_tuple(matrix_mul, matrix_add);
+}
+
+constexpr const char* kLinearToSRGBGammaWGSL = R"(
+            for (var i: i32 = 0; i < 3; i++) {
+                if input_color[i] <= 0.0031308 {
+                    input_color[i] *= 12.92;
+                } else {
+                    input_color[i] = 1.055 * pow(input_color[i], 1.0 / 2.4) - 0.055;
+                }
+            }
+)";
+
+constexpr const char* kSRGBToLinearGammaWGSL = R"(
+            for (var i: i32 = 0; i < 3; i++) {
+                if input_color[i] <= 0.04045 {
+                    input_color[i] /= 12.92;
+                } else {
+                    input_color[i] = pow((input_color[i] + 0.055) / 1.055, 2.4);
+                }
+            }
+)";
+
+// The gamma and matrix steps work on unpremultiplied colors, the filter input
+// and output are premultiplied.
+constexpr const char* kUnpremulInputWGSL = R"(
+            if input_color.a > 0.0 {
+               input_color = vec4<f32>(input_color.rgb / input_color.a, input_color.a);
+            }
+)";
+
+constexpr const char* kPremulInputWGSL =
+    "input_color = vec4<f32>(input_color.rgb * input_color.a, "
+    "input_color.a);\n";
+
+}  // namespace
+
 class WGXBlendFilter : public WGXFilterFragment {
  public:
   WGXBlendFilter(Color color, BlendMode mode)
@@ -43,46 +183,13 @@ class WGXBlendFilter : public WGXFilterFragment {
   }
 
   HWColorFilterKeyType::Value GetType() const override {
-    switch (mode_) {
-      case BlendMode::kClear:
-        return HWColorFilterKeyType::kClear;
-      case BlendMode::kSrc:
-        return HWColorFilterKeyType::kSrc;
-      case BlendMode::kDst:
-        return HWColorFilterKeyType::kDst;
-      case BlendMode::kSrcOver:
-        return HWColorFilterKeyType::kSrcOver;
-      case BlendMode::kDstOver:
-        return HWColorFilterKeyType::kDstOver;
-      case BlendMode::kSrcIn:
-        return HWColorFilterKeyType::kSrcIn;
-      case BlendMode::kDstIn:
-        return HWColorFilterKeyType::kDstIn;
-      case BlendMode::kSrcOut:
-        return HWColorFilterKeyType::kSrcOut;
-      case BlendMode::kDstOut:
-        return HWColorFilterKeyType::kDstOut;
-      case BlendMode::kSrcATop:
-        return HWColorFilterKeyType::kSrcATop;
-      case BlendMode::kDstATop:
-        return HWColorFilterKeyType::kDstATop;
-      case BlendMode::kXor:
-        return HWColorFilterKeyType::kXor;
-      case BlendMode::kPlus:
-        return HWColorFilterKeyType::kPlus;
-      case BlendMode::kModulate:
-        return HWColorFilterKeyType::kModulate;
-      case BlendMode::kScreen:
-        return HWColorFilterKeyType::kScreen;
-      default:
-        return HWColorFilterKeyType::kUnknown;
-    }
+    return BlendModeToFilterKey(mode_);
   }
 
   std::string GenSourceWGSL() const override {
     std::string wgsl_source = "";
 
-    if (mode_ != BlendMode::kClear && mode_ != BlendMode::kDst) {
+    if (BlendFilterNeedsColor(mode_)) {
       wgsl_source += "@group(1) @binding(" + std::to_string(binding_) +
                      ") var<uniform> uBlendSrcColor";
 
@@ -101,95 +208,17 @@ class WGXBlendFilter : public WGXFilterFragment {
           "var uBlendSrcColor : vec4<f32> = uBlendSrcColor_" + suffix_ + ";\n";
     }
 
-    switch (mode_) {
-      case BlendMode::kClear:
-        wgsl_source += R"(
-            return vec4<f32>(0.0, 0.0, 0.0, 0.0);
-        )";
-        break;
-      case BlendMode::kSrc:
-        wgsl_source += R"(
-            return uBlendSrcColor;
-        )";
-        break;
-      case BlendMode::kDst:
-        wgsl_source += R"(
-            return input_color;
-        )";
-        break;
-      case BlendMode::kSrcOver:
-        wgsl_source += R"(
-            return uBlendSrcColor + input_color * (1.0 - uBlendSrcColor.a);
-        )";
-        break;
-      case BlendMode::kDstOver:
-        wgsl_source += R"(
-            return input_color + uBlendSrcColor * (1.0 - input_color.a);
-        )";
-        break;
-      case BlendMode::kSrcIn:
-        wgsl_source += R"(
-            return uBlendSrcColor * input_color.a;
-        )";
-        break;
-      case BlendMode::kDstIn:
-        wgsl_source += R"(
-            return input_color * uBlendSrcColor.a;
-        )";
-        break;
-      case BlendMode::kSrcOut:
-        wgsl_source += R"(
-            return uBlendSrcColor * (1.0 - input_color.a);
-        )";
-        break;
-      case BlendMode::kDstOut:
-        wgsl_source += R"(
-            return input_color * (1.0 - uBlendSrcColor.a);
-        )";
-        break;
-      case BlendMode::kSrcATop:
-        wgsl_source += R"(
-            return uBlendSrcColor * input_color.a + input_color * (1.0 - uBlendSrcColor.a);
-        )";
-        break;
-      case BlendMode::kDstATop:
-        wgsl_source += R"(
-            return uBlendSrcColor.a * input_color + uBlendSrcColor * (1.0 - input_color.a);
-        )";
-        break;
-      case BlendMode::kXor:
-        wgsl_source += R"(
-            return uBlendSrcColor * (1.0 - input_color.a) + input_color * (1.0 - uBlendSrcColor.a);
-        )";
-        break;
-      case BlendMode::kPlus:
-        wgsl_source += R"(
-            return min(uBlendSrcColor + input_color, vec4<f32>(1.0));
-        )";
-        break;
-      case BlendMode::kModulate:
-        wgsl_source += R"(
-            return uBlendSrcColor * input_color;
-        )";
-        break;
-      case BlendMode::kScreen:
-        wgsl_source += R"(
-            return uBlendSrcColor + input_color - uBlendSrcColor * input_color;
-        )";
-        break;
-      default:
-        wgsl_source += R"(
-            return vec4<f32>(0.0, 0.0, 0.0, 0.0);
-        )";
-        break;
-    }
+    wgsl_source += "return " +
+                   BlendFilterExpression(mode_, "uBlendSrcColor",
+                                         "input_color") +
+                   ";\n";
     wgsl_source += "}\n";
 
     return wgsl_source;
   }
 
   void SetupBindGroup(Command* cmd, HWDrawContext* context) override {
-    if (mode_ == BlendMode::kClear || mode_ == BlendMode::kDst) {
+    if (!BlendFilterNeedsColor(mode_)) {
       return;
     }
 
@@ -209,10 +238,7 @@ class WGXBlendFilter : public WGXFilterFragment {
       return;
     }
 
-    auto color4f = Color4fFromColor(color_);
-    color4f[0] *= color4f[3];
-    color4f[1] *= color4f[3];
-    color4f[2] *= color4f[3];
+    auto color4f = PremulColor(color_);
     entry->type_definition->SetData(&color4f, sizeof(float) * 4);
 
     UploadBindGroup(group->group, entry, cmd, context);
@@ -359,34 +385,15 @@ class WGXGammaFilter : public WGXFilterFragment {
   std::string GenSourceWGSL() const override {
     std::string wgsl_source = GenFunctionSignature();
 
+    wgsl_source += "{\n";
+    wgsl_source += kUnpremulInputWGSL;
     if (type_ == ColorFilterType::kLinearToSRGBGamma) {
-      wgsl_source += R"(
-        {
-            for (var i: i32 = 0; i < 3; i++) {
-                if input_color[i] <= 0.0031308 {
-                    input_color[i] *= 12.92;
-                } else {
-                    input_color[i] = 1.055 * pow(input_color[i], 1.0 / 2.4) - 0.055;
-                }
-            }
-
-            return input_color;
-        }
-      )";
+      wgsl_source += kLinearToSRGBGammaWGSL;
     } else if (type_ == ColorFilterType::kSRGBToLinearGamma) {
-      wgsl_source += R"(
-        {
-            for (var i: i32 = 0; i < 3; i++) {
-                if input_color[i] <= 0.04045 {
-                    input_color[i] /= 12.92;
-                } else {
-                    input_color[i] = pow((input_color[i] + 0.055) / 1.055, 2.4);
-                }
-            }
-            return input_color;
-        }
-      )";
+      wgsl_source += kSRGBToLinearGammaWGSL;
     }
+    wgsl_source += kPremulInputWGSL;
+    wgsl_source += "return input_color;\n}\n";
 
     return wgsl_source;
   }
@@ -397,30 +404,25 @@ class WGXGammaFilter : public WGXFilterFragment {
   ColorFilterType type_ = ColorFilterType::kLinearToSRGBGamma;
 };
 
-class WGXComposeFilter : public WGXFilterFragment {
+/**
+ * A ColorFilterProgram with more than one step, generated as one function
+ * with all its uniforms in one struct instead of one nested function and
+ * binding per filter.
+ */
+class WGXColorFilterProgram : public WGXFilterFragment {
  public:
-  explicit WGXComposeFilter(const std::vector<ColorFilter*>& filters)
-      : WGXFilterFragment("") {
-    size_t index = 0;
-    for (auto& filter : filters) {
-      if (filter == nullptr) {
-        continue;
-      }
-
-      filters_.emplace_back(
-          WGXFilterFragment::Make(filter, std::to_string(index)));
-
-      index += 1;
-    }
-  }
+  WGXColorFilterProgram(std::string suffix, ColorFilterProgram program)
+      : WGXFilterFragment(std::move(suffix)), program_(std::move(program)) {}
 
-  ~WGXComposeFilter() override = default;
+  ~WGXColorFilterProgram() override = default;
 
   uint32_t InitBinding(uint32_t binding) override {
-    for (auto& filter : filters_) {
-      binding = filter->InitBinding(binding);
+    if (!HasUniforms()) {
+      return binding;
     }
-    return binding;
+
+    binding_ = binding;
+    return binding + 1;
   }
 
   HWColorFilterKeyType::Value GetType() const override {
@@ -429,26 +431,77 @@ class WGXComposeFilter : public WGXFilterFragment {
 
   std::optional<std::vector<uint32_t>> GetComposeKeys() const override {
     std::vector<uint32_t> keys;
-    keys.reserve(filters_.size());
-    for (auto& filter : filters_) {
-      keys.push_back(filter->GetType());
+    keys.reserve(program_.GetOps().size());
+    for (const auto& op : program_.GetOps()) {
+      keys.push_back(OpKey(op));
     }
     return keys;
   }
 
   std::string GenSourceWGSL() const override {
+    const auto& ops = program_.GetOps();
+    const std::string info_name = "uColorFilterProgramInfo" + NameSuffix();
+
     std::string wgsl_source = "";
-    for (auto& filter : filters_) {
-      wgsl_source += filter->GenSourceWGSL();
+    if (HasUniforms()) {
+      wgsl_source += "struct " + InfoStructName() + " {\n";
+      for (size_t i = 0; i < ops.size(); i++) {
+        const std::string index = std::to_string(i);
+        if (ops[i].type == ColorFilterProgram::OpType::kMatrix) {
+          wgsl_source += "matrix_mul_" + index + " : mat4x4<f32>,\n";
+          wgsl_source += "matrix_add_" + index + " : vec4<f32>,\n";
+        } else if (ops[i].type == ColorFilterProgram::OpType::kBlend &&
+                   BlendFilterNeedsColor(ops[i].mode)) {
+          wgsl_source += "blend_color_" + index + " : vec4<f32>,\n";
+        }
+      }
+      wgsl_source += "};\n";
+
+      wgsl_source += "@group(1) @binding(" + std::to_string(binding_) +
+                     ") var<uniform> " + info_name + " : " + InfoStructName() +
+                     ";\n";
     }
 
     wgsl_source += GenFunctionSignature();
-
     wgsl_source += "{\n";
 
-    for (size_t i = 0; i < filters_.size(); i++) {
-      wgsl_source += "input_color = filter_color_" + std::to_string(i) +
-                     "(input_color);\n";
+    bool unpremul = false;
+    for (size_t i = 0; i < ops.size(); i++) {
+      const auto& op = ops[i];
+      const std::string index = std::to_string(i);
+
+      if (op.IsUnpremul() && !unpremul) {
+        wgsl_source += kUnpremulInputWGSL;
+      } else if (!op.IsUnpremul() && unpremul) {
+        wgsl_source += kPremulInputWGSL;
+      }
+      unpremul = op.IsUnpremul();
+
+      switch (op.type) {
+        case ColorFilterProgram::OpType::kMatrix:
+          wgsl_source += "input_color = clamp(" + info_name + ".matrix_mul_" +
+                         index + " * input_color + " + info_name +
+                         ".matrix_add_" + index +
+                         ", vec4<f32>(0.0), vec4<f32>(1.0));\n";
+          break;
+        case ColorFilterProgram::OpType::kLinearToSRGBGamma:
+          wgsl_source += kLinearToSRGBGammaWGSL;
+          break;
+        case ColorFilterProgram::OpType::kSRGBToLinearGamma:
+          wgsl_source += kSRGBToLinearGammaWGSL;
+          break;
+        case ColorFilterProgram::OpType::kBlend:
+          wgsl_source += "input_color = " +
+                         BlendFilterExpression(
+                             op.mode, info_name + ".blend_color_" + index,
+                             "input_color") +
+                         ";\n";
+          break;
+      }
+    }
+
+    if (unpremul) {
+      wgsl_source += kPremulInputWGSL;
     }
 
     wgsl_source += "return input_color;\n";
@@ -458,17 +511,130 @@ class WGXComposeFilter : public WGXFilterFragment {
   }
 
   void SetupBindGroup(Command* cmd, HWDrawContext* context) override {
-    for (auto& filter : filters_) {
-      filter->SetupBindGroup(cmd, context);
+    if (!HasUniforms() || cmd->pipeline == nullptr) {
+      return;
+    }
+
+    auto group = cmd->pipeline->GetBindingGroup(1);
+    if (group == nullptr) {
+      return;
+    }
+
+    auto entry = group->GetEntry(binding_);
+    if (entry == nullptr || entry->type != wgx::BindingType::kUniformBuffer ||
+        entry->type_definition->name != InfoStructName()) {
+      return;
+    }
+
+    auto info_struct =
+        static_cast<wgx::StructDefinition*>(entry->type_definition.get());
+
+    const auto& ops = program_.GetOps();
+    for (size_t i = 0; i < ops.size(); i++) {
+      const std::string index = std::to_string(i);
+      if (ops[i].type == ColorFilterProgram::OpType::kMatrix) {
+        Matrix matrix_mul;
+        Vec4 matrix_add;
+        std::tie(matrix_mul, matrix_add) = SplitColorMatrix(ops[i].matrix);
+        info_struct->GetMember("matrix_mul_" + index)
+            ->type->SetData(&matrix_mul, sizeof(float) * 16);
+        info_struct->GetMember("matrix_add_" + index)
+            ->type->SetData(&matrix_add, sizeof(float) * 4);
+      } else if (ops[i].type == ColorFilterProgram::OpType::kBlend &&
+                 BlendFilterNeedsColor(ops[i].mode)) {
+        auto color4f = PremulColor(ops[i].color);
+        info_struct->GetMember("blend_color_" + index)
+            ->type->SetData(&color4f, sizeof(float) * 4);
+      }
     }
+
+    UploadBindGroup(group->group, entry, cmd, context);
   }
 
  private:
-  std::vector<std::unique_ptr<WGXFilterFragment>> filters_;
+  static uint32_t OpKey(const ColorFilterProgram::Op& op) {
+    switch (op.type) {
+      case ColorFilterProgram::OpType::kMatrix:
+        return HWColorFilterKeyType::kMatrix;
+      case ColorFilterProgram::OpType::kLinearToSRGBGamma:
+        return HWColorFilterKeyType::kLinearToSRGBGamma;
+      case ColorFilterProgram::OpType::kSRGBToLinearGamma:
+        return HWColorFilterKeyType::kSRGBToLinearGamma;
+      case ColorFilterProgram::OpType::kBlend:
+        return BlendModeToFilterKey(op.mode);
+    }
+    return HWColorFilterKeyType::kUnknown;
+  }
+
+  bool HasUniforms() const {
+    for (const auto& op : program_.GetOps()) {
+      if (op.type == ColorFilterProgram::OpType::kMatrix ||
+          (op.type == ColorFilterProgram::OpType::kBlend &&
+           BlendFilterNeedsColor(op.mode))) {
+        return true;
+      }
+    }
+    return false;
+  }
+
+  std::string NameSuffix() const {
+    return suffix_.empty() ? "" : "_" + suffix_;
+  }
+
+  std::string InfoStructName() const {
+    return "ColorFilterProgramInfo" + NameSuffix();
+  }
+
+  ColorFilterProgram program_;
+  uint32_t binding_ = 0;
 };
 
+namespace {
+
+std::unique_ptr<WGXFilterFragment> MakeProgramFragment(
+    ColorFilterProgram program, std::string suffix) {
+  const auto& ops = program.GetOps();
+  if (ops.empty()) {
+    return {};
+  }
+
+  if (ops.size() > 1) {
+    return std::make_unique<WGXColorFilterProgram>(std::move(suffix),
+                                                   std::move(program));
+  }
+
+  // A single step keeps the shader of the plain filter.
+  const auto& op = ops.front();
+  switch (op.type) {
+    case ColorFilterProgram::OpType::kMatrix: {
+      Matrix matrix_mul;
+      Vec4 matrix_add;
+      std::tie(matrix_mul, matrix_add) = SplitColorMatrix(op.matrix);
+      return std::make_unique<WGXMatrixFilter>(std::move(suffix), matrix_add,
+                                               matrix_mul);
+    }
+    case ColorFilterProgram::OpType::kLinearToSRGBGamma:
+      return std::make_unique<WGXGammaFilter>(
+          std::move(suffix), ColorFilterType::kLinearToSRGBGamma);
+    case ColorFilterProgram::OpType::kSRGBToLinearGamma:
+      return std::make_unique<WGXGammaFilter>(
+          std::move(suffix), ColorFilterType::kSRGBToLinearGamma);
+    case ColorFilterProgram::OpType::kBlend:
+      return std::make_unique<WGXBlendFilter>(std::move(suffix), op.color,
+                                              op.mode);
+  }
+
+  return {};
+}
+
+}  // namespace
+
 std::unique_ptr<WGXFilterFragment> WGXFilterFragment::Make(ColorFilter* filter,
                                                            std::string suffix) {
+  if (filter == nullptr) {
+    return {};
+  }
+
   auto filter_base = As_CFB(filter);
 
   if (filter_base->GetType() == ColorFilterType::kBlend) {
@@ -488,9 +654,7 @@ std::unique_ptr<WGXFilterFragment> WGXFilterFragment::Make(ColorFilter* filter,
 
     return std::make_unique<WGXMatrixFilter>(suffix, matrix_add, matrix_mul);
   } else if (filter_base->GetType() == ColorFilterType::kCompose) {
-    auto compose_filter = static_cast<ComposeColorFilter*>(filter_base);
-
-    return std::make_unique<WGXComposeFilter>(compose_filter->GetFilters());
+    return MakeProgramFragment(ColorFilterProgram(filter), std::move(suffix));
   }
 
   return {};
@@ -6,6 +6,7 @@
 
 #include "src/effect/color_filter_base.hpp"
 #include "src/effect/gradient_fallback.hpp"
+#include "src/effect/gradient_lut.hpp"
 #include "src/effect/pixmap_shader.hpp"
 #include "src/gpu/gpu_context_impl.hpp"
 #include "src/gpu/gpu_render_pass.hpp"
@@ -16,6 +17,7 @@
 #include "src/render/hw/draw/fragment/wgsl_solid_vertex_color.hpp"
 #include "src/render/hw/draw/fragment/wgsl_stencil_fragment.hpp"
 #include "src/render/hw/draw/fragment/wgsl_texture_fragment.hpp"
+#include "src/render/hw/draw/wgx_analytic_clip.hpp"
 #include "src/render/hw/draw/wgx_filter.hpp"
 #include "src/render/hw/draw/wgx_programmable_blending.hpp"
 #include "src/render/hw/hw_draw.hpp"
@@ -206,10 +208,27 @@ bool IsPaintSourceOpaque(const Paint& paint) {
   return true;
 }
 
+namespace {
+
+// Size of the color and stop arrays in the generated shader.
+constexpr uint32_t kMaxGradientColorCount = 64;
+
+std::shared_ptr<const GradientLUT> FindLUTIfNeeded(
+    const Shader::GradientInfo& info) {
+  if (info.colors.size() <= kMaxGradientColorCount) {
+    return nullptr;
+  }
+
+  return GradientLUTCache::GetInstance().FindOrCreate(info);
+}
+
+}  // namespace
+
 WGXGradientFragment::WGXGradientFragment(const Shader::GradientInfo& info,
                                          Shader::GradientType type)
     : info_(info),
       type_(type),
+      lut_(FindLUTIfNeeded(info)),
       max_color_count_shift_(RoundGradientColorCountShift()) {}
 
 std::string WGXGradientFragment::GenSourceWGSL(size_t index) const {
@@ -404,6 +423,11 @@ HWFunctionBaseKey WGXGradientFragment::GetCustomKey() const {
       break;
   }
 
+  if (lut_) {
+    return gradient_type << kGradientTypeShift |
+           kGradientLUTColorCountShift << kMaxColorCountShift;
+  }
+
   return gradient_type << kGradientTypeShift |
          max_color_count_shift_ << kMaxColorCountShift |
          (info_.color_offsets.empty() ? 1 : 0) << kOffsetFastShift |
@@ -427,6 +451,24 @@ bool WGXGradientFragment::SetupCommonInfo(const wgx::BindGroupEntry* info_entry,
   auto gradient_info_struct =
       static_cast<wgx::StructDefinition*>(info_entry->type_definition.get());
 
+  if (lut_) {
+    std::array<int32_t, 4> infos{
+        static_cast<int32_t>(info_.color_count),
+        0,
+        static_cast<int32_t>(info_.tile_mode),
+        static_cast<int32_t>(lut_->Size()),
+    };
+
+    gradient_info_struct->GetMember("infos")->type->SetData(
+        infos.data(), infos.size() * sizeof(int32_t));
+    gradient_info_struct->GetMember("global_alpha")
+        ->type->SetData(global_alpha);
+    // The table is already premultiplied.
+    gradient_info_struct->GetMember("flags")->type->SetData(int32_t{1});
+
+    return true;
+  }
+
   std::array<int32_t, 4> infos{
       static_cast<int32_t>(info_.color_count),
       static_cast<int32_t>(info_.color_offsets.size()),
@@ -490,6 +532,30 @@ bool WGXGradientFragment::SetupGradientInfo(
   return false;
 }
 
+bool WGXGradientFragment::SetupLUT(uint32_t group,
+                                   const wgx::BindGroupEntry* sampler_entry,
+                                   const wgx::BindGroupEntry* texture_entry,
+                                   Command* cmd,
+                                   HWDrawContext* context) const {
+  if (!lut_) {
+    return true;
+  }
+
+  if (sampler_entry == nullptr || texture_entry == nullptr) {
+    return false;
+  }
+
+  auto cache = context->gpuContext->GetGradientLUTTextureCache();
+  auto texture = cache->FindOrCreate(*lut_);
+  if (texture == nullptr) {
+    return false;
+  }
+
+  UploadBindGroup(group, sampler_entry, cmd, cache->GetSampler());
+  UploadBindGroup(group, texture_entry, cmd, texture);
+  return true;
+}
+
 const char* WGXGradientFragment::GradientTypeName() const {
   switch (type_) {
     case Shader::kLinear:
@@ -510,6 +576,10 @@ uint32_t WGXGradientFragment::GetOffsetCount() const {
 }
 
 uint32_t WGXGradientFragment::RoundGradientColorCountShift() const {
+  if (lut_) {
+    return kGradientLUTColorCountShift;
+  }
+
   uint32_t count = static_cast<uint32_t>(info_.colors.size());
 
   uint32_t shift = 0;
@@ -527,6 +597,10 @@ uint32_t WGXGradientFragment::RoundGradientColorCountShift() const {
 
 std::string WGXGradientFragment::GenerateGradientCommonWGSL(
     size_t index) const {
+  if (lut_) {
+    return GenerateGradientLUTWGSL(index);
+  }
+
   std::string wgsl = R"(
     struct GradientInfo {
       infos : vec4<i32>,
@@ -636,7 +710,48 @@ std::string WGXGradientFragment::GenerateGradientCommonWGSL(
     )";
   }
 
+  wgsl += GradientColorWGSL();
+
+  return wgsl;
+}
+
+std::string WGXGradientFragment::GenerateGradientLUTWGSL(size_t index) const {
+  std::string wgsl = R"(
+    struct GradientInfo {
+      infos: vec4<i32>,
+      global_alpha: f32,
+      flags: i32,
+    };
+  )";
+
+  wgsl += RemapTileFunction();
+
+  wgsl += "\n @group(1) @binding(";
+  wgsl += std::to_string(index);
+  wgsl += ") var<uniform> gradient_info    : GradientInfo;\n";
+  wgsl += "@group(1) @binding(";
+  wgsl += std::to_string(index + 2);
+  wgsl += ") var gradient_lut_sampler : sampler;\n";
+  wgsl += "@group(1) @binding(";
+  wgsl += std::to_string(index + 3);
+  wgsl += ") var gradient_lut : texture_2d<f32>;\n";
+
+  // Sample the texel centers, entry i holds the color at i / (size - 1).
   wgsl += R"(
+    fn lerp_color(current: f32) -> vec4<f32> {
+        var size: f32 = f32(gradient_info.infos.w);
+        var u: f32 = (clamp(current, 0.0, 1.0) * (size - 1.0) + 0.5) / size;
+        return textureSample(gradient_lut, gradient_lut_sampler, vec2<f32>(u, 0.5));
+    }
+  )";
+
+  wgsl += GradientColorWGSL();
+
+  return wgsl;
+}
+
+const char* WGXGradientFragment::GradientColorWGSL() {
+  return R"(
     fn calculate_gradient_color(t: f32) -> vec4<f32> {
         if gradient_info.infos.z == 3 && (t < 0.0 || t >= 1.0) {
             return vec4<f32>(0.0, 0.0, 0.0, 0.0);
@@ -647,8 +762,6 @@ std::string WGXGradientFragment::GenerateGradientCommonWGSL(
         return lerp_color(t1);
     }
   )";
-
-  return wgsl;
 }
 
 bool WGXGradientFragment::SetupLinearInfo(
@@ -835,11 +948,16 @@ HWWGSLFragment* GenShadingFragment(HWDrawContext* context, const Paint& paint,
 
 void ConfigureShadingFragment(HWDrawContext* context, const Paint& paint,
                               const HWBlendPlan& blend_plan,
-                              HWWGSLFragment* fragment) {
+                              HWWGSLFragment* fragment,
+                              const HWAnalyticClipSet* analytic_clips) {
   if (fragment == nullptr) {
     return;
   }
 
+  if (analytic_clips != nullptr) {
+    fragment->SetAnalyticClip(WGXAnalyticClip::Make(analytic_clips));
+  }
+
   if (paint.GetColorFilter()) {
     fragment->SetFilter(WGXFilterFragment::Make(paint.GetColorFilter().get()));
   }
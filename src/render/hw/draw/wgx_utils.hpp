@@ -7,8 +7,10 @@
 
 #include <wgsl_cross.h>
 
+#include <memory>
 #include <skity/effect/shader.hpp>
 
+#include "src/effect/gradient_lut.hpp"
 #include "src/gpu/gpu_sampler.hpp"
 #include "src/gpu/gpu_shader_function.hpp"
 #include "src/gpu/gpu_texture.hpp"
@@ -20,6 +22,7 @@ struct Command;
 struct HWDrawContext;
 struct HWBlendPlan;
 class HWWGSLFragment;
+struct HWAnalyticClipSet;
 class Paint;
 
 void UploadBindGroup(uint32_t group, const wgx::BindGroupEntry* entry,
@@ -71,9 +74,10 @@ bool IsPaintSourceOpaque(const Paint& paint);
 HWWGSLFragment* GenShadingFragment(HWDrawContext* context, const Paint& paint,
                                    bool is_stroke, bool has_color = true);
 
-void ConfigureShadingFragment(HWDrawContext* context, const Paint& paint,
-                              const HWBlendPlan& blend_plan,
-                              HWWGSLFragment* fragment);
+void ConfigureShadingFragment(
+    HWDrawContext* context, const Paint& paint, const HWBlendPlan& blend_plan,
+    HWWGSLFragment* fragment,
+    const HWAnalyticClipSet* analytic_clips = nullptr);
 /**
  * Common code generator for Gradient Shader.
  * It contains the struct for common gradient info:
@@ -86,6 +90,10 @@ void ConfigureShadingFragment(HWDrawContext* context, const Paint& paint,
  *  };
  * ```
  *
+ * Gradients with more colors than the arrays take drop `colors` and `stops`
+ * and sample their GradientLUT as a texture row bound after the gradient type
+ * info instead.
+ *
  * ConicalInfo if gradient type is conical:
  * ```
  *  struct ConicalInfo {
@@ -124,6 +132,20 @@ class WGXGradientFragment {
 
   bool SetupGradientInfo(const wgx::BindGroupEntry* info_entry) const;
 
+  /**
+   * Binds the color table sampler and texture, if the gradient samples one.
+   * The entries are the two bindings following the gradient type info.
+   */
+  bool SetupLUT(uint32_t group, const wgx::BindGroupEntry* sampler_entry,
+                const wgx::BindGroupEntry* texture_entry, Command* cmd,
+                HWDrawContext* context) const;
+
+  /**
+   * Number of bindings used from the index passed to GenSourceWGSL, including
+   * the gradient type info declared by the caller.
+   */
+  uint32_t GetBindingCount() const { return lut_ ? 4 : 2; }
+
  private:
   const char* GradientTypeName() const;
 
@@ -133,6 +155,10 @@ class WGXGradientFragment {
 
   std::string GenerateGradientCommonWGSL(size_t index) const;
 
+  std::string GenerateGradientLUTWGSL(size_t index) const;
+
+  static const char* GradientColorWGSL();
+
   bool SetupLinearInfo(const wgx::BindGroupEntry* info_entry) const;
 
   bool SetupRadialInfo(const wgx::BindGroupEntry* info_entry) const;
@@ -150,6 +176,8 @@ class WGXGradientFragment {
  private:
   const Shader::GradientInfo& info_;
   Shader::GradientType type_;
+  // Set when the gradient has more colors than the shader arrays take.
+  std::shared_ptr<const GradientLUT> lut_;
   uint32_t max_color_count_shift_ = 0;
 };
 
@@ -68,4 +68,26 @@ HWBlendFormula ResolveHWBlendFormula(const HWBlendPlan& blend_plan,
   return ResolveLegacyFormula(blend_plan.blend_mode);
 }
 
+bool BlendsCoverageAsSourceScale(const HWBlendPlan& blend_plan) {
+  if (blend_plan.dst_read_strategy != DstReadStrategy::kNonRequired) {
+    return false;
+  }
+
+  // These formulas have a source factor that does not depend on the source
+  // color and a destination factor that is either one or one minus source
+  // alpha, so they are linear in the scaled source.
+  switch (blend_plan.blend_mode) {
+    case BlendMode::kDst:
+    case BlendMode::kSrcOver:
+    case BlendMode::kDstOver:
+    case BlendMode::kDstOut:
+    case BlendMode::kSrcATop:
+    case BlendMode::kXor:
+    case BlendMode::kPlus:
+      return true;
+    default:
+      return false;
+  }
+}
+
 }  // namespace skity
@@ -44,6 +44,12 @@ HWBlendFormula ResolveHWBlendFormula(const HWBlendPlan& blend_plan,
                                      const GPUCaps& caps,
                                      bool shader_side_blending);
 
+// Whether scaling the source color by a coverage value before the blend gives
+// the same result as mixing the destination with the blended color by that
+// coverage. Only then can a draw apply clip coverage in its fragment shader,
+// every other plan would overwrite the pixels outside of the clip.
+bool BlendsCoverageAsSourceScale(const HWBlendPlan& blend_plan);
+
 }  // namespace skity
 
 #endif  // SRC_RENDER_HW_HW_BLEND_PLAN_HPP
@@ -8,11 +8,11 @@
 #include <skity/effect/path_effect.hpp>
 #include <skity/effect/shader.hpp>
 #include <skity/geometry/matrix.hpp>
-#include <skity/geometry/stroke.hpp>
 #include <skity/text/font.hpp>
 #include <skity/text/text_blob.hpp>
 
 #include "src/effect/image_filter_base.hpp"
+#include "src/geometry/stroke_cache.hpp"
 #include "src/gpu/gpu_surface_impl.hpp"
 #include "src/logging.hpp"
 #include "src/render/canvas_state.hpp"
@@ -26,6 +26,7 @@
 #include "src/render/hw/layer/hw_filter_layer.hpp"
 #include "src/render/paint_order.hpp"
 #include "src/render/shape.hpp"
+#include "src/render/text/atlas/atlas_manager.hpp"
 #include "src/render/text/glyph_run.hpp"
 #include "src/tracing.hpp"
 #include "src/utils/arena_allocator.hpp"
@@ -65,6 +66,8 @@ void HWCanvas::BeginNewFrame(HWRootLayer* root_layer) {
 
   layer_stack_.clear();
 
+  root_layer_->SetFrameStats(GetMutableFrameStats());
+
   layer_stack_.emplace_back(root_layer_);
 
   if (coverage_aa_renderer_) {
@@ -105,6 +108,30 @@ void HWCanvas::OnClipRect(const Rect& rect, ClipOp op) {
   CurrentLayer()->AddRectClip(rect, CurrentMatrix());
 }
 
+void HWCanvas::OnClipRRect(const RRect& rrect, ClipOp op) {
+  SKITY_TRACE_EVENT(HWCanvas_OnClipRRect);
+
+  if (CurrentLayer() == nullptr) {
+    return;
+  }
+
+  if (rrect.IsRect()) {
+    OnClipRect(rrect.GetRect(), op);
+    return;
+  }
+
+  // Intersect rrect and oval clips are evaluated in the fragment stage of the
+  // following draws, the stencil clip is only generated when a draw can not
+  // evaluate them.
+  if (op == ClipOp::kDifference || rrect.IsEmpty() ||
+      !CurrentMatrix().OnlyScaleAndTranslate() ||
+      !CurrentLayer()->AddAnalyticRRectClip(
+          rrect, CurrentMatrix(), GetCanvasSampleCount(),
+          surface_->GetGPUContext()->IsEnableGPUTessellation())) {
+    Canvas::OnClipRRect(rrect, op);
+  }
+}
+
 void HWCanvas::OnClipPath(const Path& path, ClipOp op) {
   SKITY_TRACE_EVENT(HWCanvas_OnClipPath);
 
@@ -377,9 +404,12 @@ void HWCanvas::DrawGlyphsInternal(uint32_t count, const GlyphID* glyphs,
                                   const Paint& paint, const Matrix& transform) {
   SKITY_TRACE_EVENT(HWCanvas_DrawGlyphsInternal);
 
+  auto atlas_manager = surface_->GetGPUContext()->GetAtlasManager();
+  AtlasStats atlas_stats_before = atlas_manager->GetStats();
+
   GlyphRunList glyph_runs = GlyphRun::Make(
       count, glyphs, origin, position_x, position_y, font, paint, ctx_scale_,
-      transform, surface_->GetGPUContext()->GetAtlasManager(), arena_allocator_,
+      transform, atlas_manager, arena_allocator_,
       [this, transform](const Path& path, const Paint& paint) {
         this->DrawPathInternal(path, paint, transform);
       });
@@ -398,6 +428,19 @@ void HWCanvas::DrawGlyphsInternal(uint32_t count, const GlyphID* glyphs,
       CurrentLayer()->AddDraw(draw);
     }
   }
+
+  AtlasStats atlas_stats = atlas_manager->GetStats();
+  FrameStats* frame_stats = GetMutableFrameStats();
+  frame_stats->Increment(
+      FrameCounter::kGlyphCacheHits,
+      atlas_stats.glyph_hits - atlas_stats_before.glyph_hits);
+  frame_stats->Increment(
+      FrameCounter::kGlyphCacheMisses,
+      atlas_stats.glyph_misses - atlas_stats_before.glyph_misses);
+  frame_stats->Increment(
+      FrameCounter::kAtlasUploadBytes,
+      atlas_stats.upload_bytes - atlas_stats_before.upload_bytes);
+  frame_stats->Record(FrameHistogram::kGlyphsPerDraw, count);
 }
 
 void HWCanvas::DrawPathInternal(const Path& path, const Paint& paint,
@@ -465,7 +508,7 @@ void HWCanvas::DrawPathInternal(const Path& path, const Paint& paint,
     work_paint.SetStyle(Paint::kStroke_Style);
     work_paint.SetAntiAlias(analytical_aa != AnalyticalAAMode::kNone);
     Path effect_path;
-    Path outline;
+    std::shared_ptr<const Path> outline;
     const Path* dst = &path;
 
     if (paint.GetPathEffect() && paint.GetPathEffect()->FilterPath(
@@ -475,11 +518,9 @@ void HWCanvas::DrawPathInternal(const Path& path, const Paint& paint,
 
     if (needs_stroke_outline) {
       work_paint.SetFillColor(work_paint.GetStrokeColor());
-      Stroke stroke(work_paint);
-      Path quad;
-      stroke.QuadPath(*dst, &quad);
-      stroke.StrokePath(quad, &outline);
-      dst = &outline;
+      outline = StrokeCache::GetInstance().FindOrCreate(
+          *dst, work_paint, GetMutableFrameStats());
+      dst = outline.get();
       work_paint.SetStyle(Paint::kFill_Style);
       add_draw(*dst, work_paint, false);
     } else {
@@ -697,6 +738,7 @@ void HWCanvas::OnFlush() {
     draw_context.index_vector_cache = index_vector_cache_.get();
     draw_context.total_clip_depth = root_layer_->GetState()->GetDrawDepth() + 1;
     draw_context.arena_allocator = arena_allocator_;
+    draw_context.frame_stats = GetMutableFrameStats();
     root_layer_->SetScale(Vec2{ctx_scale_, ctx_scale_});
     draw_context.scale = root_layer_->GetScale();
 
@@ -736,6 +778,10 @@ uint32_t HWCanvas::GetCanvasSampleCount() {
 
 void HWCanvas::UploadMesh(GPUCommandBuffer* command_buffer) {
   SKITY_TRACE_EVENT(HWCanvas_UploadMesh);
+  GetMutableFrameStats()->Increment(FrameCounter::kStageBufferBytes,
+                                    gpu_buffer_->GetStagedBytes());
+  GetMutableFrameStats()->Increment(FrameCounter::kStageIndexBytes,
+                                    gpu_buffer_->GetStagedIndexBytes());
   gpu_buffer_->Flush(command_buffer);
   static_buffer_->Flush(command_buffer);
 }
@@ -864,6 +910,7 @@ HWLayer* HWCanvas::GenLayer(const Paint& paint, Rect layer_bounds,
   layer->SetLayerSpaceBounds(transformed_bounds);
   layer->SetEnableMergingDrawCall(
       surface_->GetGPUContext()->IsEnableMergingDrawCall());
+  layer->SetFrameStats(GetMutableFrameStats());
   SetupBlendPlanForDraw(layer, paint.GetBlendMode());
   layer->SetRTOrigin(
       ResolveLayerRTOrigin(surface_->GetGPUContext()->GetBackendType()));
@@ -49,6 +49,8 @@ class HWCanvas : public Canvas {
 
   void OnClipRect(const Rect& rect, ClipOp op) override;
 
+  void OnClipRRect(const RRect& rrect, ClipOp op) override;
+
   void OnClipPath(const Path& path, ClipOp op) override;
 
   void OnDrawPath(const Path& path, const Paint& paint) override;
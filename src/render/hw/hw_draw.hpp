@@ -12,6 +12,7 @@
 #include <vector>
 
 #include "skity/graphic/image.hpp"
+#include "src/render/hw/draw/wgx_analytic_clip.hpp"
 #include "src/render/hw/draw/wgx_programmable_blending.hpp"
 #include "src/render/hw/hw_blend_plan.hpp"
 #include "src/render/hw/hw_draw_pass.hpp"
@@ -22,6 +23,7 @@
 
 namespace skity {
 
+class FrameStats;
 class HWStageBuffer;
 class GPURenderPass;
 class HWPipelineLib;
@@ -52,6 +54,7 @@ struct HWDrawContext {
   Vec2 scale = {1.f, 1.f};
   HWStaticBuffer* static_buffer = nullptr;
   const DstTextureCopyInfo* dst_read_texture_copy_info = nullptr;
+  FrameStats* frame_stats = nullptr;
 };
 
 enum HWDrawState : uint32_t {
@@ -111,6 +114,19 @@ class HWDraw {
 
   const HWDraw* GetClipDraw() const { return clip_draw_; }
 
+  /**
+   * Whether the draw can evaluate analytic clips in its shading fragment.
+   * Active analytic clips are turned into stencil clips before any draw that
+   * can not. The blend plan has to be set before the draw is added to a layer.
+   */
+  virtual bool SupportsAnalyticClip() const { return false; }
+
+  void SetAnalyticClips(const HWAnalyticClipSet* analytic_clips) {
+    analytic_clips_ = analytic_clips;
+  }
+
+  const HWAnalyticClipSet* GetAnalyticClips() const { return analytic_clips_; }
+
   uint32_t GetClipDepth() const { return clip_depth_; }
 
   float GetClipValue() const { return clip_value_; }
@@ -128,7 +144,8 @@ class HWDraw {
     }
 
     if (GetClipDraw() != draw->GetClipDraw() ||
-        GetScissorBox() != draw->GetScissorBox()) {
+        GetScissorBox() != draw->GetScissorBox() ||
+        GetAnalyticClips() != draw->GetAnalyticClips()) {
       return false;
     }
 
@@ -177,6 +194,7 @@ class HWDraw {
   Rect scissor_rect_ = {};
   Rect layer_space_bounds_ = Rect::MakeLTRB(-1E9F, -1E9F, 1E9F, 1E9F);
   HWDraw* clip_draw_ = nullptr;
+  const HWAnalyticClipSet* analytic_clips_ = nullptr;
   HWBlendPlan blend_plan_ = {};
 };
 
@@ -0,0 +1,52 @@
+// Copyright 2021 The Lynx Authors. All rights reserved.
+// Licensed under the Apache License Version 2.0 that can be found in the
+// LICENSE file in the root directory of this source tree.
+
+#include "src/render/hw/hw_gradient_lut_texture_cache.hpp"
+
+#include <vector>
+
+namespace skity {
+
+HWGradientLUTTextureCache::HWGradientLUTTextureCache(GPUDevice* device)
+    : device_(device),
+      cache_(kMaxBytes, [](const std::shared_ptr<GPUTexture>& texture) {
+        return texture->GetBytes();
+      }) {
+  GPUSamplerDescriptor descriptor;
+  descriptor.mag_filter = GPUFilterMode::kLinear;
+  descriptor.min_filter = GPUFilterMode::kLinear;
+  sampler_ = device_->CreateSampler(descriptor);
+}
+
+std::shared_ptr<GPUTexture> HWGradientLUTTextureCache::FindOrCreate(
+    const GradientLUT& lut) {
+  return cache_.FindOrCreate(lut.GetID(), [&]() {
+    GPUTextureDescriptor descriptor;
+    descriptor.width = lut.Size();
+    descriptor.height = 1;
+    descriptor.format = GPUTextureFormat::kRGBA8Unorm;
+    descriptor.usage =
+        static_cast<GPUTextureUsageMask>(GPUTextureUsage::kTextureBinding) |
+        static_cast<GPUTextureUsageMask>(GPUTextureUsage::kCopyDst);
+    descriptor.storage_mode = GPUTextureStorageMode::kHostVisible;
+    auto texture = device_->CreateTexture(descriptor);
+    if (!texture) {
+      return texture;
+    }
+
+    // PMColor packs ARGB into a word, the texture takes RGBA bytes.
+    std::vector<uint8_t> pixels(lut.Size() * 4);
+    for (uint32_t i = 0; i < lut.Size(); i++) {
+      PMColor color = lut.Colors()[i];
+      pixels[i * 4 + 0] = ColorGetR(color);
+      pixels[i * 4 + 1] = ColorGetG(color);
+      pixels[i * 4 + 2] = ColorGetB(color);
+      pixels[i * 4 + 3] = ColorGetA(color);
+    }
+    texture->UploadData(0, 0, lut.Size(), 1, pixels.data());
+    return texture;
+  });
+}
+
+}  // namespace skity
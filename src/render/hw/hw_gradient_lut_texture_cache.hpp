@@ -0,0 +1,47 @@
+// Copyright 2021 The Lynx Authors. All rights reserved.
+// Licensed under the Apache License Version 2.0 that can be found in the
+// LICENSE file in the root directory of this source tree.
+
+#ifndef SRC_RENDER_HW_HW_GRADIENT_LUT_TEXTURE_CACHE_HPP
+#define SRC_RENDER_HW_HW_GRADIENT_LUT_TEXTURE_CACHE_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+#include "src/base/lru_cache.hpp"
+#include "src/effect/gradient_lut.hpp"
+#include "src/gpu/gpu_device.hpp"
+#include "src/gpu/gpu_sampler.hpp"
+#include "src/gpu/gpu_texture.hpp"
+
+namespace skity {
+
+/**
+ * Uploads of gradient color tables for one GPU device, each a 1 pixel high
+ * RGBA texture. Entries are keyed by GradientLUT::GetID(), which is never
+ * reused, so a table evicted from the GradientLUTCache can not alias a newer
+ * one and its upload simply ages out.
+ */
+class HWGradientLUTTextureCache {
+ public:
+  static constexpr size_t kMaxBytes = 1024 * 1024;
+
+  explicit HWGradientLUTTextureCache(GPUDevice* device);
+
+  std::shared_ptr<GPUTexture> FindOrCreate(const GradientLUT& lut);
+
+  /**
+   * Linear sampler clamped to the table, shared by every gradient.
+   */
+  const std::shared_ptr<GPUSampler>& GetSampler() const { return sampler_; }
+
+ private:
+  GPUDevice* device_;
+  std::shared_ptr<GPUSampler> sampler_;
+  SizedLRUCache<uint32_t, std::shared_ptr<GPUTexture>> cache_;
+};
+
+}  // namespace skity
+
+#endif  // SRC_RENDER_HW_HW_GRADIENT_LUT_TEXTURE_CACHE_HPP
@@ -5,7 +5,9 @@
 #include "src/render/hw/hw_layer.hpp"
 
 #include <algorithm>
+#include <array>
 #include <cassert>
+#include <cmath>
 #include <glm/gtc/matrix_transform.hpp>
 #include <memory>
 #include <skity/effect/shader.hpp>
@@ -19,6 +21,7 @@
 #include "src/gpu/gpu_texture.hpp"
 #include "src/gpu/texture_impl.hpp"
 #include "src/logging.hpp"
+#include "src/render/hw/draw/hw_dynamic_path_clip.hpp"
 #include "src/render/hw/draw/hw_dynamic_path_draw.hpp"
 #include "src/render/hw/hw_draw.hpp"
 #include "src/render/hw/hw_draw_pass.hpp"
@@ -105,6 +108,12 @@ void HWLayer::Draw(GPURenderPass* render_pass, GPUCommandBuffer* cmd) {
 HWLayerState* HWLayer::GetState() { return &state_; }
 
 void HWLayer::AddDraw(HWDraw* draw) {
+  if (draw->SupportsAnalyticClip()) {
+    draw->SetAnalyticClips(state_.CurrentAnalyticClips());
+  } else {
+    MaterializeAnalyticClips();
+  }
+
   FlushPendingClip();
 
   draw->SetColorFormat(GetColorFormat());
@@ -168,6 +177,9 @@ bool HWLayer::TryMerge(HWDraw* draw) {
     auto cadidate = *it;
     bool merged = cadidate->MergeIfPossible(draw);
     if (merged) {
+      if (frame_stats_) {
+        frame_stats_->Increment(FrameCounter::kMergedDraws);
+      }
       return true;
     }
 
@@ -207,6 +219,84 @@ void HWLayer::AddRectClip(const skity::Rect& local_rect, const Matrix& matrix) {
   state_.SaveClipBounds(transformed_rect);
 }
 
+bool HWLayer::AddAnalyticRRectClip(const RRect& local_rrect,
+                                   const Matrix& matrix, uint32_t sample_count,
+                                   bool use_gpu_tessellation) {
+  const HWAnalyticClipSet* current = state_.CurrentAnalyticClips();
+  const uint32_t count = current ? current->count : 0;
+  if (count >= kMaxAnalyticClipCount) {
+    return false;
+  }
+
+  const Matrix physical_matrix = GetLayerPhysicalMatrix(matrix);
+  Rect rect;
+  physical_matrix.MapRect(&rect, local_rrect.GetRect());
+  if (rect.IsEmpty()) {
+    return false;
+  }
+
+  const float scale_x = physical_matrix.GetScaleX();
+  const float scale_y = physical_matrix.GetScaleY();
+  std::array<Vec2, 4> radii;
+  for (size_t i = 0; i < radii.size(); i++) {
+    const Vec2 radius = local_rrect.Radii(static_cast<RRect::Corner>(i));
+    radii[i] = Vec2{radius.x * std::abs(scale_x), radius.y * std::abs(scale_y)};
+  }
+  // Negative scales and bottom left render targets mirror the corners.
+  bool flip_y = scale_y < 0.f;
+  if (rt_origin_ == LayerRTOrigin::kBottomLeft) {
+    rect = Rect::MakeLTRB(rect.Left(), height_ - rect.Bottom(), rect.Right(),
+                          height_ - rect.Top());
+    flip_y = !flip_y;
+  }
+  if (scale_x < 0.f) {
+    std::swap(radii[RRect::kUpperLeft], radii[RRect::kUpperRight]);
+    std::swap(radii[RRect::kLowerLeft], radii[RRect::kLowerRight]);
+  }
+  if (flip_y) {
+    std::swap(radii[RRect::kUpperLeft], radii[RRect::kLowerLeft]);
+    std::swap(radii[RRect::kUpperRight], radii[RRect::kLowerRight]);
+  }
+
+  auto clips = arena_allocator_->Make<HWAnalyticClipSet>();
+  if (current) {
+    *clips = *current;
+  }
+  auto& clip = clips->clips[count];
+  clip.rect = rect;
+  clip.radii = radii;
+  clip.local_rrect = local_rrect;
+  clip.transform = matrix;
+  clip.sample_count = sample_count;
+  clip.use_gpu_tessellation = use_gpu_tessellation;
+  clips->count = count + 1;
+
+  state_.SaveAnalyticClips(clips);
+  AddRectClip(local_rrect.GetRect(), matrix);
+  return true;
+}
+
+void HWLayer::MaterializeAnalyticClips() {
+  const HWAnalyticClipSet* clips = state_.CurrentAnalyticClips();
+  if (clips == nullptr) {
+    return;
+  }
+
+  for (uint32_t i = state_.GetMaterializedAnalyticClipCount();
+       i < clips->count; i++) {
+    const auto& clip = clips->clips[i];
+    Path path;
+    path.AddRRect(clip.local_rrect);
+    path.SetConvexityType(Path::ConvexityType::kConvex);
+    HWDraw* clip_draw = arena_allocator_->Make<HWDynamicPathClip>(
+        clip.transform, std::move(path), Canvas::ClipOp::kIntersect, bounds_,
+        clip.use_gpu_tessellation);
+    clip_draw->SetSampleCount(clip.sample_count);
+    AddClip(clip_draw);
+  }
+  state_.SetMaterializedAnalyticClipCount(clips->count);
+}
+
 void HWLayer::Restore() { state_.Restore(); }
 
 void HWLayer::RestoreToCount(int32_t count) { state_.RestoreToCount(count); }
@@ -240,6 +330,7 @@ HWDrawState HWLayer::OnPrepare(HWDrawContext* context) {
   sub_context.total_clip_depth = state_.GetDrawDepth() + 1;
   sub_context.arena_allocator = context->arena_allocator;
   sub_context.scale = scale_;
+  sub_context.frame_stats = context->frame_stats;
 
   for (auto pass : draw_passes_) {
     CollectClipReplayDraws(pass);
@@ -303,6 +394,7 @@ void HWLayer::OnGenerateCommand(HWDrawContext* context, HWDrawState state) {
   sub_context.total_clip_depth = state_.GetDrawDepth() + 1;
   sub_context.arena_allocator = context->arena_allocator;
   sub_context.scale = scale_;
+  sub_context.frame_stats = context->frame_stats;
 
   for (auto pass : draw_passes_) {
     const HWDraw* emulated_load_draw =
@@ -361,33 +453,49 @@ Rect HWLayer::CalculateLayerSpaceBounds(const Rect& local_rect,
 
 std::shared_ptr<Shader> HWLayer::CreateDrawLayerShader(
     GPUContext* gpu_context, std::shared_ptr<GPUTexture> gpu_texture,
-    const Rect& bounds) const {
+    const Rect& bounds, Vec2 content_size) const {
   (void)gpu_context;
   auto texture = std::make_shared<InternalTexture>(
       gpu_texture, AlphaType::kPremul_AlphaType);
 
   auto image = Image::MakeHWImage(texture);
-  return CreateDrawLayerShader(image, bounds);
+  return CreateDrawLayerShader(image, bounds, content_size);
 }
 
 std::shared_ptr<Shader> HWLayer::CreateDrawLayerShader(
-    std::shared_ptr<Image> image, const Rect& bounds) const {
+    std::shared_ptr<Image> image, const Rect& bounds,
+    Vec2 content_size) const {
+  // Pooled textures can be larger than the layer, with the content starting
+  // at the texture origin.
+  if (content_size.x <= 0.f || content_size.y <= 0.f) {
+    content_size = Vec2{image->Width(), image->Height()};
+  }
+
   Matrix local_matrix;
   if (rt_origin_ == LayerRTOrigin::kBottomLeft) {
     local_matrix =
         Matrix::Translate(bounds.Left(), bounds.Height() + bounds.Top()) *
-        Matrix::Scale(bounds.Width() / image->Width(),
-                      -(bounds.Height() / image->Height()));
+        Matrix::Scale(bounds.Width() / content_size.x,
+                      -(bounds.Height() / content_size.y));
   } else {
     local_matrix = Matrix::Translate(bounds.Left(), bounds.Top()) *
-                   Matrix::Scale(bounds.Width() / image->Width(),
-                                 bounds.Height() / image->Height());
+                   Matrix::Scale(bounds.Width() / content_size.x,
+                                 bounds.Height() / content_size.y);
   }
 
   return Shader::MakeShader(image, SamplingOptions{}, TileMode::kDecal,
                             TileMode::kDecal, local_matrix);
 }
 
+bool HWLayer::HasEmulatedLoad() const {
+  for (auto pass : draw_passes_) {
+    if (pass->emulated_load_info) {
+      return true;
+    }
+  }
+  return false;
+}
+
 EmulatedLoadInfo HWLayer::CreateEmulatedLoadInfo() {
   // prepare layer back draw
   const auto& bounds = GetBounds();
@@ -9,6 +9,7 @@
 #include <optional>
 #include <skity/geometry/rect.hpp>
 #include <skity/graphic/paint.hpp>
+#include <skity/render/frame_stats.hpp>
 #include <vector>
 
 #include "skity/graphic/image.hpp"
@@ -58,6 +59,16 @@ class HWLayer : public HWDraw {
 
   void AddRectClip(const Rect& local_rect, const Matrix& matrix);
 
+  /**
+   * Adds an intersect rrect clip evaluated analytically by the draws that
+   * support it. `matrix` must only scale and translate.
+   *
+   * @return false if the clip stack is full and the caller has to add a
+   *         stencil clip instead
+   */
+  bool AddAnalyticRRectClip(const RRect& local_rrect, const Matrix& matrix,
+                            uint32_t sample_count, bool use_gpu_tessellation);
+
   void Restore();
 
   void RestoreToCount(int32_t count);
@@ -85,6 +96,8 @@ class HWLayer : public HWDraw {
     enable_merging_draw_call_ = enable;
   }
 
+  void SetFrameStats(FrameStats* frame_stats) { frame_stats_ = frame_stats; }
+
   void SetArenaAllocator(ArenaAllocator* arena_allocator) {
     arena_allocator_ = arena_allocator;
     auto pass = arena_allocator_->Make<HWDrawPass>();
@@ -95,6 +108,8 @@ class HWLayer : public HWDraw {
 
   void SetRTOrigin(LayerRTOrigin origin) { rt_origin_ = origin; }
 
+  LayerRTOrigin GetRTOrigin() const { return rt_origin_; }
+
   virtual bool SupportsTextureCopyDstRead() const { return false; }
 
  protected:
@@ -135,12 +150,19 @@ class HWLayer : public HWDraw {
         0, 1};
   }
 
+  /**
+   * @param content_size  size of the texture region drawn to `bounds`, the
+   *                      whole texture if it is empty
+   */
   std::shared_ptr<Shader> CreateDrawLayerShader(
       GPUContext* gpu_context, std::shared_ptr<GPUTexture> texture,
-      const Rect& bounds) const;
+      const Rect& bounds, Vec2 content_size = {}) const;
 
   std::shared_ptr<Shader> CreateDrawLayerShader(std::shared_ptr<Image> image,
-                                                const Rect& bounds) const;
+                                                const Rect& bounds,
+                                                Vec2 content_size = {}) const;
+
+  bool HasEmulatedLoad() const;
 
   /**
    * Generates a draw call that emulates load action for an MSAA target by
@@ -151,6 +173,8 @@ class HWLayer : public HWDraw {
  private:
   void FlushPendingClip();
 
+  void MaterializeAnalyticClips();
+
   bool TryMerge(HWDraw* draw);
 
   void CollectClipReplayDraws(HWDrawPass* pass);
@@ -179,6 +203,7 @@ class HWLayer : public HWDraw {
   Matrix bounds_to_physical_matrix_ = {};
   bool enable_merging_draw_call_ = {};
   ArenaAllocator* arena_allocator_ = nullptr;
+  FrameStats* frame_stats_ = nullptr;
   Vec2 scale_ = {1.f, 1.f};
   LayerRTOrigin rt_origin_ = LayerRTOrigin::kTopLeft;
 };
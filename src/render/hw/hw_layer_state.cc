@@ -38,6 +38,11 @@ void HWLayerState::SaveClipBounds(const Rect &bounds, bool reset) {
   }
 }
 
+void HWLayerState::SaveAnalyticClips(
+    const HWAnalyticClipSet *analytic_clips) {
+  clip_stack_.back().analytic_clips = analytic_clips;
+}
+
 const Rect &HWLayerState::CurrentClipBounds() const {
   return clip_stack_.back().clip_bounds;
 }
@@ -64,9 +69,12 @@ void HWLayerState::FlushClipDepth() {
 }
 
 void HWLayerState::PushClipStack() {
-  auto bounds = clip_stack_.back().clip_bounds;
-  clip_stack_.emplace_back();
-  clip_stack_.back().clip_bounds = bounds;
+  const auto &top = clip_stack_.back();
+  ClipStackValue value;
+  value.clip_bounds = top.clip_bounds;
+  value.analytic_clips = top.analytic_clips;
+  value.materialized_analytic_clips = top.materialized_analytic_clips;
+  clip_stack_.emplace_back(value);
 }
 
 void HWLayerState::PopClipStack() {
@@ -25,6 +25,10 @@ class HWLayerState {
     // clip bounds in physical pixel size in this layer
     // only applied with intersect clip
     Rect clip_bounds = {};
+    // analytic clips evaluated by draws, including the ones of outer levels
+    const HWAnalyticClipSet* analytic_clips = nullptr;
+    // number of analytic clips already turned into clip draws
+    uint32_t materialized_analytic_clips = 0;
   };
 
   explicit HWLayerState(int32_t depth);
@@ -41,6 +45,20 @@ class HWLayerState {
 
   const Rect& CurrentClipBounds() const;
 
+  void SaveAnalyticClips(const HWAnalyticClipSet* analytic_clips);
+
+  const HWAnalyticClipSet* CurrentAnalyticClips() const {
+    return clip_stack_.back().analytic_clips;
+  }
+
+  uint32_t GetMaterializedAnalyticClipCount() const {
+    return clip_stack_.back().materialized_analytic_clips;
+  }
+
+  void SetMaterializedAnalyticClipCount(uint32_t count) {
+    clip_stack_.back().materialized_analytic_clips = count;
+  }
+
   HWDraw* LastClipDraw() const;
 
   uint32_t GetRecordedClipCount() const { return clip_history_.size(); }
@@ -79,6 +79,11 @@ std::string CustomKeyToGradientName(uint32_t custom) {
       break;
   }
 
+  if (max_color_shift == kGradientLUTColorCountShift) {
+    ss << "LUT";
+    return ss.str();
+  }
+
   ss << max_color_count;
   if (offset_fast) {
     ss << "OffsetFast";
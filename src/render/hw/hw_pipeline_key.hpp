@@ -145,10 +145,13 @@ struct HWPipelineKey {
   uint64_t base_key;
   std::optional<std::vector<uint32_t>> compose_keys;
   uint32_t programmable_blending = 0;
+  // Number of analytic clips evaluated by the fragment shader.
+  uint32_t analytic_clip = 0;
 
   bool operator==(const HWPipelineKey& other) const {
     return base_key == other.base_key && compose_keys == other.compose_keys &&
-           programmable_blending == other.programmable_blending;
+           programmable_blending == other.programmable_blending &&
+           analytic_clip == other.analytic_clip;
   }
 
   bool operator!=(const HWPipelineKey& other) const {
@@ -173,6 +176,7 @@ struct HWPipelineKey {
         key.base_key = GetFragmentBaseKey();
         key.compose_keys = compose_keys;
         key.programmable_blending = programmable_blending;
+        key.analytic_clip = analytic_clip;
         break;
     }
     // Add stage to base key to make sure vertex and fragment key are
@@ -192,6 +196,7 @@ struct HWPipelineKeyHash {
       }
     }
     res += std::hash<uint32_t>()(key.programmable_blending);
+    res += std::hash<uint32_t>()(key.analytic_clip);
     return res;
   }
 };
@@ -201,6 +206,8 @@ constexpr static uint32_t kGradientTypeShift = 0;
 constexpr static uint32_t kMaxColorCountShift = 3;
 constexpr static uint32_t kOffsetFastShift = 6;
 constexpr static uint32_t kColorFastShift = 7;
+// Max color count value of gradients which sample a color table texture.
+constexpr static uint32_t kGradientLUTColorCountShift = 7;
 
 constexpr static uint32_t kGradientTypeLinear = 1;
 constexpr static uint32_t kGradientTypeRadial = 2;
@@ -4,6 +4,9 @@
 
 #include "src/render/hw/hw_pipeline_lib.hpp"
 
+#include <chrono>
+#include <skity/render/frame_stats.hpp>
+
 #include "src/gpu/gpu_device.hpp"
 #include "src/gpu/gpu_shader_function.hpp"
 #include "src/gpu/gpu_shader_module.hpp"
@@ -131,8 +134,9 @@ bool HWPipeline::DepthStencilStateMatch(GPURenderPipeline* pipeline,
                             request_ds.stencil_state.back);
 }
 
-GPURenderPipeline* HWPipelineLib::GetPipeline(
-    const HWPipelineKey& key, const HWPipelineDescriptor& desc) {
+GPURenderPipeline* HWPipelineLib::GetPipeline(const HWPipelineKey& key,
+                                              const HWPipelineDescriptor& desc,
+                                              FrameStats* frame_stats) {
 #ifdef SKITY_ENABLE_TRACING
   uint64_t vs_key = (static_cast<uint64_t>(GPUShaderStage::kVertex) << 32) |
                     key.GetVertexBaseKey();
@@ -146,6 +150,9 @@ GPURenderPipeline* HWPipelineLib::GetPipeline(
   auto it = pipelines_.find(key);
 
   if (it != pipelines_.end()) {
+    if (frame_stats) {
+      frame_stats->Increment(FrameCounter::kPipelineCacheHits);
+    }
     return it->second->GetPipeline(desc);
   }
 
@@ -155,8 +162,18 @@ GPURenderPipeline* HWPipelineLib::GetPipeline(
     return nullptr;
   }
 
+  auto compile_start = std::chrono::steady_clock::now();
   auto pipeline = CreatePipeline(key, desc);
 
+  if (frame_stats) {
+    auto compile_time = std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now() - compile_start);
+    frame_stats->Increment(pipeline ? FrameCounter::kPipelineCompiles
+                                    : FrameCounter::kPipelineCompileFailures);
+    frame_stats->Record(FrameHistogram::kPipelineCompileMicros,
+                        static_cast<uint64_t>(compile_time.count()));
+  }
+
   if (!pipeline) {
     LOGE("CreatePipeline failed, vs: {} fs: {}",
          VertexKeyToShaderName(key.GetVertexBaseKey()),
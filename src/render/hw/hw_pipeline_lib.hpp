@@ -20,6 +20,7 @@
 
 namespace skity {
 
+class FrameStats;
 class GPUDevice;
 class HWShaderGenerator;
 
@@ -86,8 +87,14 @@ class HWPipelineLib final {
 
   ~HWPipelineLib() = default;
 
+  /**
+   * Returns the pipeline for `key` and `desc`, compiling it on first use.
+   * Cache hits, compiles and compile failures are counted into `frame_stats`
+   * if it is not null.
+   */
   GPURenderPipeline* GetPipeline(const HWPipelineKey& key,
-                                 const HWPipelineDescriptor& desc);
+                                 const HWPipelineDescriptor& desc,
+                                 FrameStats* frame_stats = nullptr);
 
   void ResetCompileFailedPipelines() { compile_failed_pipelines_.clear(); }
 
@@ -0,0 +1,89 @@
+// Copyright 2021 The Lynx Authors. All rights reserved.
+// Licensed under the Apache License Version 2.0 that can be found in the
+// LICENSE file in the root directory of this source tree.
+
+#include "src/render/hw/hw_render_target_cache.hpp"
+
+#include <algorithm>
+#include <limits>
+
+namespace skity {
+
+namespace {
+
+bool IsSameExceptSize(const GPUTextureDescriptor& lhs,
+                      const GPUTextureDescriptor& rhs) {
+  return lhs.mip_level_count == rhs.mip_level_count &&
+         lhs.sample_count == rhs.sample_count && lhs.format == rhs.format &&
+         lhs.usage == rhs.usage && lhs.storage_mode == rhs.storage_mode;
+}
+
+}  // namespace
+
+std::shared_ptr<HWRenderTargetCache::Resource>
+HWRenderTargetCache::ObtainResource(const GPUTextureDescriptor& desc,
+                                    HWTextureFit fit, Pool* pool) {
+  if (fit == HWTextureFit::kExact) {
+    return ObtainResource(desc, pool);
+  }
+
+  GPUTextureDescriptor bucket_desc = desc;
+  bucket_desc.width = RoundUpSize(desc.width);
+  if (fit == HWTextureFit::kApprox) {
+    bucket_desc.height = RoundUpSize(desc.height);
+  }
+
+  if (!IsCacheDisabled()) {
+    const uint64_t max_area = static_cast<uint64_t>(bucket_desc.width) *
+                              bucket_desc.height * kMaxBestFitAreaRatio;
+
+    // Candidates are sorted by width and height, starting at the smallest
+    // texture which is wide enough.
+    GPUTextureDescriptor lower_desc = desc;
+    lower_desc.height = 0;
+
+    const auto& purgeable_map = GetPurgeableMap();
+    auto best = purgeable_map.end();
+    uint64_t best_area = std::numeric_limits<uint64_t>::max();
+    for (auto it = purgeable_map.lower_bound(lower_desc);
+         it != purgeable_map.end() && IsSameExceptSize(it->first, desc); ++it) {
+      const GPUTextureDescriptor& key = it->first;
+      if (static_cast<uint64_t>(key.width) * desc.height > max_area) {
+        break;
+      }
+
+      if (key.height < desc.height ||
+          (fit == HWTextureFit::kApproxWidth && key.height != desc.height)) {
+        continue;
+      }
+
+      const uint64_t area = static_cast<uint64_t>(key.width) * key.height;
+      if (area <= max_area && area < best_area) {
+        best = it;
+        best_area = area;
+      }
+    }
+
+    if (best != purgeable_map.end()) {
+      return ReuseResource(best, pool);
+    }
+  }
+
+  return AllocateResource(bucket_desc, pool);
+}
+
+uint32_t HWRenderTargetCache::RoundUpSize(uint32_t size) const {
+  if (size_granularity_ <= 1) {
+    return size;
+  }
+
+  uint64_t rounded =
+      (static_cast<uint64_t>(size) + size_granularity_ - 1) /
+      size_granularity_ * size_granularity_;
+  if (max_texture_size_ > 0) {
+    rounded = std::min<uint64_t>(rounded, std::max(size, max_texture_size_));
+  }
+  return static_cast<uint32_t>(rounded);
+}
+
+}  // namespace skity
@@ -5,6 +5,7 @@
 #ifndef SRC_RENDER_HW_HW_RENDER_TARGET_CACHE_HPP
 #define SRC_RENDER_HW_HW_RENDER_TARGET_CACHE_HPP
 
+#include <cstdint>
 #include <memory>
 
 #include "src/gpu/gpu_device.hpp"
@@ -13,17 +14,11 @@
 
 namespace skity {
 
+// Orders descriptors by everything but the size first, so all textures which
+// only differ in size are adjacent and sorted by width and height.
 struct HWTextureCompare {
   bool operator()(const GPUTextureDescriptor& lhs,
                   const GPUTextureDescriptor& rhs) const {
-    if (lhs.width != rhs.width) {
-      return lhs.width < rhs.width;
-    }
-
-    if (lhs.height != rhs.height) {
-      return lhs.height < rhs.height;
-    }
-
     if (lhs.mip_level_count != rhs.mip_level_count) {
       return lhs.mip_level_count < rhs.mip_level_count;
     }
@@ -43,10 +38,28 @@ struct HWTextureCompare {
     if (lhs.storage_mode != rhs.storage_mode) {
       return lhs.storage_mode < rhs.storage_mode;
     }
-    return false;
+
+    if (lhs.width != rhs.width) {
+      return lhs.width < rhs.width;
+    }
+
+    return lhs.height < rhs.height;
   }
 };
 
+/**
+ * How a render target obtained from the HWRenderTargetCache may differ from
+ * the requested size.
+ */
+enum class HWTextureFit {
+  // Exactly the requested size.
+  kExact,
+  // At least the requested width, exactly the requested height.
+  kApproxWidth,
+  // At least the requested width and height.
+  kApprox,
+};
+
 class HWRenderTarget
     : public HWResource<GPUTextureDescriptor, std::shared_ptr<GPUTexture>> {
  public:
@@ -79,21 +92,66 @@ class HWRenderTargetAllocator
   GPUDevice* device_;
 };
 
+/**
+ * Render target cache with size bucketed allocation.
+ *
+ * Approximate fit requests are rounded up to the size granularity before
+ * allocation, and reuse the smallest purgeable texture which is large enough,
+ * so layers whose bounds change slightly between frames do not allocate new
+ * textures. Resources obtained through a Pool return to the cache when the
+ * pool is destroyed and can be aliased by later layers of the same frame.
+ */
 class HWRenderTargetCache
     : public HWResourceCache<GPUTextureDescriptor, std::shared_ptr<GPUTexture>,
                              HWTextureCompare> {
  public:
+  using Resource =
+      HWResource<GPUTextureDescriptor, std::shared_ptr<GPUTexture>>;
+
+  // Approximate fit rounds sizes up to multiples of this value.
+  static constexpr uint32_t kDefaultSizeGranularity = 32;
+
+  // Largest area of a reused texture relative to the rounded request.
+  static constexpr uint32_t kMaxBestFitAreaRatio = 2;
+
   HWRenderTargetCache(std::unique_ptr<HWResourceAllocator<
                           GPUTextureDescriptor, std::shared_ptr<GPUTexture>>>
                           allocator,
-                      size_t max_bytes = kDefaultMaxBytes)
+                      size_t max_bytes = kDefaultMaxBytes,
+                      uint32_t max_texture_size = 0)
       : HWResourceCache<GPUTextureDescriptor, std::shared_ptr<GPUTexture>,
-                        HWTextureCompare>(std::move(allocator), max_bytes) {}
+                        HWTextureCompare>(std::move(allocator), max_bytes),
+        max_texture_size_(max_texture_size) {}
 
   static std::unique_ptr<HWRenderTargetCache> Create(GPUDevice* device) {
     auto allocator = std::make_unique<HWRenderTargetAllocator>(device);
-    return std::make_unique<HWRenderTargetCache>(std::move(allocator));
+    return std::make_unique<HWRenderTargetCache>(
+        std::move(allocator), kDefaultMaxBytes, device->GetMaxTextureSize());
+  }
+
+  using HWResourceCache<GPUTextureDescriptor, std::shared_ptr<GPUTexture>,
+                        HWTextureCompare>::ObtainResource;
+
+  std::shared_ptr<Resource> ObtainResource(const GPUTextureDescriptor& desc,
+                                           HWTextureFit fit,
+                                           Pool* pool = nullptr);
+
+  /**
+   * Sets the granularity approximate fit sizes are rounded up to. A value of
+   * 0 or 1 disables rounding.
+   */
+  void SetSizeGranularity(uint32_t granularity) {
+    size_granularity_ = granularity;
   }
+
+  uint32_t GetSizeGranularity() const { return size_granularity_; }
+
+ private:
+  uint32_t RoundUpSize(uint32_t size) const;
+
+  // 0 if unlimited
+  uint32_t max_texture_size_;
+  uint32_t size_granularity_ = kDefaultSizeGranularity;
 };
 
 }  // namespace skity
@@ -9,6 +9,7 @@
 #include <list>
 #include <map>
 #include <memory>
+#include <vector>
 
 namespace skity {
 
@@ -60,29 +61,11 @@ class HWResourceCache {
     if (!disable_cache_) {
       auto range = purgeable_map_.equal_range(key);
       if (range.first != range.second) {
-        auto list_it = range.first->second;
-        auto resource = *list_it;
-        purgeable_list_.erase(list_it);
-        purgeable_map_.erase(range.first);
-        purgeable_bytes_ -= resource->GetBytes();
-        if (pool) {
-          pool->PutResource(resource);
-        }
-        return resource;
+        return ReuseResource(range.first, pool);
       }
     }
 
-    std::shared_ptr<HWResource<K, V>> resource =
-        allocator_->AllocateResource(key);
-
-    if (pool) {
-      pool->PutResource(resource);
-    }
-
-    if (!disable_cache_) {
-      total_resource_bytes_ += resource->GetBytes();
-    }
-    return resource;
+    return AllocateResource(key, pool);
   }
 
   void StoreResource(std::shared_ptr<HWResource<K, V>> resource) {
@@ -109,6 +92,7 @@ class HWResourceCache {
       purgeable_list_.pop_back();
       total_resource_bytes_ -= resource->GetBytes();
       purgeable_bytes_ -= resource->GetBytes();
+      purged_bytes_ += resource->GetBytes();
     }
   }
 
@@ -123,15 +107,65 @@ class HWResourceCache {
   size_t GetPurgableBytes() const { return purgeable_bytes_; }
   size_t GetMaxbytes() const { return max_bytes_; }
 
+  /**
+   * Accumulated bytes of resources created by the allocator, handed out again
+   * from the purgeable resources and released by purging.
+   */
+  size_t GetAllocatedBytes() const { return allocated_bytes_; }
+  size_t GetReusedBytes() const { return reused_bytes_; }
+  size_t GetPurgedBytes() const { return purged_bytes_; }
+
+ protected:
+  using PurgeableList = std::list<std::shared_ptr<HWResource<K, V>>>;
+  using PurgeableMap =
+      std::multimap<K, typename PurgeableList::iterator, Compare>;
+
+  bool IsCacheDisabled() const { return disable_cache_; }
+
+  const PurgeableMap& GetPurgeableMap() const { return purgeable_map_; }
+
+  std::shared_ptr<HWResource<K, V>> ReuseResource(
+      typename PurgeableMap::const_iterator it, Pool* pool) {
+    auto list_it = it->second;
+    auto resource = *list_it;
+    purgeable_list_.erase(list_it);
+    purgeable_map_.erase(it);
+    purgeable_bytes_ -= resource->GetBytes();
+    reused_bytes_ += resource->GetBytes();
+    if (pool) {
+      pool->PutResource(resource);
+    }
+    return resource;
+  }
+
+  std::shared_ptr<HWResource<K, V>> AllocateResource(const K& key,
+                                                     Pool* pool) {
+    std::shared_ptr<HWResource<K, V>> resource =
+        allocator_->AllocateResource(key);
+
+    if (pool) {
+      pool->PutResource(resource);
+    }
+
+    allocated_bytes_ += resource->GetBytes();
+    if (!disable_cache_) {
+      total_resource_bytes_ += resource->GetBytes();
+    }
+    return resource;
+  }
+
  private:
   size_t total_resource_bytes_ = 0;
   size_t purgeable_bytes_ = 0;
+  size_t allocated_bytes_ = 0;
+  size_t reused_bytes_ = 0;
+  size_t purged_bytes_ = 0;
   std::unique_ptr<HWResourceAllocator<K, V>> allocator_;
   size_t max_bytes_;
   bool disable_cache_ = false;
 
-  std::list<std::shared_ptr<HWResource<K, V>>> purgeable_list_;
-  std::multimap<K, decltype(purgeable_list_.begin()), Compare> purgeable_map_;
+  PurgeableList purgeable_list_;
+  PurgeableMap purgeable_map_;
 };
 
 }  // namespace skity
@@ -69,6 +69,11 @@ class HWStageBuffer final {
 
   void Flush(GPUCommandBuffer* command_buffer);
 
+  // Bytes written since the last Flush, which the next Flush uploads.
+  uint32_t GetStagedBytes() const { return stage_pos_; }
+
+  uint32_t GetStagedIndexBytes() const { return stage_index_pos_; }
+
   GPUBuffer* GetGPUBuffer() const { return gpu_buffer_.get(); }
 
   const std::shared_ptr<GPUBuffer>& GetGPUBufferOwner() const {
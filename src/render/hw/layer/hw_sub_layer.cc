@@ -24,8 +24,15 @@ HWDrawState HWSubLayer::OnPrepare(HWDrawContext* context) {
     paint.SetBlendMode(GetBlendPlan().blend_mode);
     paint.SetAlphaF(alpha_);
     paint.SetStyle(Paint::kFill_Style);
-    paint.SetShader(CreateDrawLayerShader(context->gpuContext,
-                                          layer_back_draw_texture_, bounds));
+    // A filter writes to its own texture, otherwise only the layer size part
+    // of the pooled texture is drawn.
+    Vec2 content_size = {};
+    if (layer_back_draw_texture_ == color_texture_) {
+      content_size = Vec2{static_cast<float>(texture_size_.x),
+                          static_cast<float>(texture_size_.y)};
+    }
+    paint.SetShader(CreateDrawLayerShader(
+        context->gpuContext, layer_back_draw_texture_, bounds, content_size));
 
     layer_back_draw_ = context->arena_allocator->Make<HWDynamicPathDraw>(
         GetTransform(), std::move(path), std::move(paint), false, false);
@@ -80,8 +87,18 @@ void HWSubLayer::InitTexture(GPUContextImpl* gpu_context,
     return;
   }
 
+  // Bottom left render targets map fragment rows through the layer height,
+  // and emulated loads sample the whole resolve texture, so those keep the
+  // exact size in the affected dimensions.
+  HWTextureFit fit = HWTextureFit::kApprox;
+  if (HasEmulatedLoad()) {
+    fit = HWTextureFit::kExact;
+  } else if (GetRTOrigin() == LayerRTOrigin::kBottomLeft) {
+    fit = HWTextureFit::kApproxWidth;
+  }
+
   auto render_target = gpu_context->GetRenderTargetCache()->ObtainResource(
-      GetColorTextureDesc(), pool);
+      GetColorTextureDesc(), fit, pool);
   color_texture_ = render_target->GetValue();
   layer_back_draw_texture_ = color_texture_;
 }
@@ -9,7 +9,6 @@
 #include <cstring>
 #include <skity/effect/mask_filter.hpp>
 #include <skity/effect/path_effect.hpp>
-#include <skity/geometry/stroke.hpp>
 #include <skity/graphic/bitmap.hpp>
 #include <skity/text/font.hpp>
 #include <skity/text/text_blob.hpp>
@@ -18,6 +17,7 @@
 #include "src/effect/image_filter_base.hpp"
 #include "src/effect/mask_filter_priv.hpp"
 #include "src/effect/pixmap_shader.hpp"
+#include "src/geometry/stroke_cache.hpp"
 #include "src/render/paint_order.hpp"
 #include "src/render/sw/sw_raster.hpp"
 #include "src/render/sw/sw_span_brush.hpp"
@@ -53,80 +53,88 @@ static std::vector<Span> find_span_y(std::vector<Span> const& spans,
   return ret;
 }
 
-static std::vector<Span> spans_subtraction(std::vector<Span> const& subtrahend,
-                                           std::vector<Span> const& minuend) {
-  std::vector<Span> ret;
+// Appends what is left of `span` after removing `ms`, the spans on the same
+// row sorted by x, to `ret`.
+static void subtract_span(Span const& span, Span const* ms, size_t ms_count,
+                          std::vector<Span>* ret) {
+  // no spans in this line means minus zero
+  if (ms_count == 0) {
+    ret->emplace_back(span);
+    return;
+  }
 
-  for (Span const& span : subtrahend) {
-    auto ms = find_span_y(minuend, span.y);
+  int32_t curr_x = span.x;
+  int32_t curr_len = span.len;
 
-    // no spans in this line means minus zero
-    if (ms.empty()) {
-      ret.emplace_back(span);
+  for (size_t i = 0; i < ms_count; i++) {
+    Span const& m = ms[i];
+    if (m.x + m.len < curr_x || m.x > curr_x + curr_len) {
       continue;
     }
 
-    std::sort(ms.begin(), ms.end(),
-              [](Span const& a, Span const& b) { return a.x < b.x; });
+    if (m.x < curr_x) {
+      if (m.x + m.len > curr_x + curr_len) {
+        // complete subtracted
+        curr_len = 0;
+        break;
+      }
 
-    int32_t curr_x = span.x;
-    int32_t curr_len = span.len;
+      int32_t last = curr_x + curr_len;
 
-    for (Span const& m : ms) {
-      if (m.x + m.len < curr_x || m.x > curr_x + curr_len) {
+      int32_t len = m.x + m.len - curr_x;
+
+      if (len == 0) {
         continue;
       }
 
-      if (m.x < curr_x) {
-        if (m.x + m.len > curr_x + curr_len) {
-          // complete subtracted
-          curr_len = 0;
-          break;
-        }
-
-        int32_t last = curr_x + curr_len;
+      ret->emplace_back(Span{curr_x, span.y, len, span.cover});
 
-        int32_t len = m.x + m.len - curr_x;
+      curr_x += len;
 
-        if (len == 0) {
-          continue;
-        }
+      curr_len = last - curr_x;
 
-        ret.emplace_back(Span{curr_x, span.y, len, span.cover});
+    } else {  // m.x > curr_x && m.x < curr_x + curr_len
+      if (m.x + m.len < curr_x + curr_len) {
+        int32_t last = curr_x + curr_len;
+        int32_t x = curr_x;
+        int32_t len = m.x - curr_x;
 
-        curr_x += len;
+        ret->emplace_back(Span{x, span.y, len, span.cover});
 
+        curr_x = m.x + m.len;
         curr_len = last - curr_x;
+      } else {
+        int32_t x = curr_x;
 
-      } else {  // m.x > curr_x && m.x < curr_x + curr_len
-        if (m.x + m.len < curr_x + curr_len) {
-          int32_t last = curr_x + curr_len;
-          int32_t x = curr_x;
-          int32_t len = m.x - curr_x;
+        int32_t len = m.x - curr_x;
 
-          ret.emplace_back(Span{x, span.y, len, span.cover});
+        ret->emplace_back(Span{x, span.y, len, span.cover});
 
-          curr_x = m.x + m.len;
-          curr_len = last - curr_x;
-        } else {
-          int32_t x = curr_x;
+        curr_len = 0;
+      }
+    }
 
-          int32_t len = m.x - curr_x;
+    if (curr_len <= 0) {
+      break;
+    }
+  }
 
-          ret.emplace_back(Span{x, span.y, len, span.cover});
+  if (curr_len > 0) {
+    ret->emplace_back(Span{curr_x, span.y, curr_len, span.cover});
+  }
+}
 
-          curr_len = 0;
-        }
-      }
+static std::vector<Span> spans_subtraction(std::vector<Span> const& subtrahend,
+                                           std::vector<Span> const& minuend) {
+  std::vector<Span> ret;
 
-      if (curr_len <= 0) {
-        break;
-      }
-    }
+  for (Span const& span : subtrahend) {
+    auto ms = find_span_y(minuend, span.y);
 
-    if (curr_len > 0) {
-      ret.emplace_back(Span{curr_x, span.y, curr_len, span.cover});
-    }
+    std::sort(ms.begin(), ms.end(),
+              [](Span const& a, Span const& b) { return a.x < b.x; });
+
+    subtract_span(span, ms.data(), ms.size(), &ret);
   }
 
   return ret;
@@ -155,21 +163,77 @@ std::unique_ptr<Canvas> Canvas::MakeSoftwareCanvas(Bitmap* bitmap) {
   return std::make_unique<SWCanvas>(bitmap);
 }
 
-std::vector<Span> SWCanvas::State::PerformClip(const std::vector<Span>& spans) {
+void SWCanvas::State::SetClipSpans(std::vector<Span> spans) {
+  clip_spans_ = std::move(spans);
+  clip_rows_.clear();
+  clip_row_offsets_.clear();
+  clip_row_top_ = 0;
+
+  if (clip_spans_.empty()) {
+    return;
+  }
+
+  auto [top, bottom] = std::minmax_element(
+      clip_spans_.begin(), clip_spans_.end(),
+      [](Span const& a, Span const& b) { return a.y < b.y; });
+  clip_row_top_ = top->y;
+  size_t row_count = static_cast<size_t>(bottom->y - top->y) + 1;
+
+  // counting sort by row, then sort every row by x
+  clip_row_offsets_.assign(row_count + 1, 0);
+  for (Span const& span : clip_spans_) {
+    clip_row_offsets_[span.y - clip_row_top_ + 1]++;
+  }
+  for (size_t i = 1; i <= row_count; i++) {
+    clip_row_offsets_[i] += clip_row_offsets_[i - 1];
+  }
+
+  clip_rows_.resize(clip_spans_.size());
+  std::vector<uint32_t> cursor(clip_row_offsets_.begin(),
+                               clip_row_offsets_.end() - 1);
+  for (Span const& span : clip_spans_) {
+    clip_rows_[cursor[span.y - clip_row_top_]++] = span;
+  }
+
+  for (size_t i = 0; i < row_count; i++) {
+    std::stable_sort(clip_rows_.begin() + clip_row_offsets_[i],
+                     clip_rows_.begin() + clip_row_offsets_[i + 1],
+                     [](Span const& a, Span const& b) { return a.x < b.x; });
+  }
+}
+
+const Span* SWCanvas::State::ClipRow(int32_t y, size_t* count) const {
+  *count = 0;
+  if (clip_row_offsets_.empty() || y < clip_row_top_) {
+    return nullptr;
+  }
+
+  size_t row = static_cast<size_t>(y - clip_row_top_);
+  if (row + 1 >= clip_row_offsets_.size()) {
+    return nullptr;
+  }
+
+  *count = clip_row_offsets_[row + 1] - clip_row_offsets_[row];
+  return clip_rows_.data() + clip_row_offsets_[row];
+}
+
+void SWCanvas::State::ClipSpan(Span const& span,
+                               std::vector<Span>* out) const {
   if (this->op == Canvas::ClipOp::kDifference) {
-    return spans_subtraction(spans, clip_spans_);
+    size_t count = 0;
+    const Span* row = ClipRow(span.y, &count);
+    subtract_span(span, row, count, out);
+  } else {
+    FindSpan(span, out);
   }
+}
 
+std::vector<Span> SWCanvas::State::PerformClip(
+    const std::vector<Span>& spans) const {
   std::vector<Span> ret;
 
   for (Span const& span : spans) {
-    auto sub_spans = FindSpan(span);
-
-    if (sub_spans.empty()) {
-      continue;
-    }
-
-    ret.insert(ret.end(), sub_spans.begin(), sub_spans.end());
+    ClipSpan(span, &ret);
   }
 
   return ret;
@@ -185,7 +249,7 @@ std::vector<Span> SWCanvas::State::RecursiveClip(std::vector<Span> const& spans,
     }
   } else {
     if (this->op == Canvas::ClipOp::kDifference) {
-      return spans_subtraction(spans, clip_spans_);
+      return PerformClip(spans);
     } else {
       return spans_subtraction(clip_spans_, spans);
     }
@@ -216,13 +280,13 @@ std::vector<Span> SWCanvas::State::PerformMerge(
   return ret;
 }
 
-std::vector<Span> SWCanvas::State::FindSpan(Span const& span) {
-  std::vector<Span> ret;
+void SWCanvas::State::FindSpan(Span const& span,
+                               std::vector<Span>* out) const {
+  size_t count = 0;
+  const Span* row = ClipRow(span.y, &count);
 
-  for (Span clip : clip_spans_) {
-    if (clip.y != span.y) {
-      continue;
-    }
+  for (size_t i = 0; i < count; i++) {
+    Span const& clip = row[i];
 
     if (clip.x < span.x) {
       if (clip.x + clip.len < span.x) {
@@ -237,7 +301,7 @@ std::vector<Span> SWCanvas::State::FindSpan(Span const& span) {
       sub_span.len = last - span.x;
       sub_span.cover = std::min(clip.cover, span.cover);
 
-      ret.emplace_back(sub_span);
+      out->emplace_back(sub_span);
     } else if (clip.x == span.x) {
       Span sub_span{};
       sub_span.x = span.x;
@@ -245,10 +309,11 @@ std::vector<Span> SWCanvas::State::FindSpan(Span const& span) {
       sub_span.len = std::min(span.len, clip.len);
       sub_span.cover = std::min(clip.cover, span.cover);
 
-      ret.emplace_back(sub_span);
+      out->emplace_back(sub_span);
     } else if (clip.x > span.x) {
       if (span.x + span.len < clip.x) {
-        continue;
+        // the row is sorted by x, nothing further right can overlap
+        break;
       }
 
       Span sub_span{};
@@ -257,11 +322,9 @@ std::vector<Span> SWCanvas::State::FindSpan(Span const& span) {
       sub_span.len = std::min(span.x + span.len - clip.x + 1, clip.len);
       sub_span.cover = std::min(clip.cover, span.cover);
 
-      ret.emplace_back(sub_span);
+      out->emplace_back(sub_span);
     }
   }
-
-  return ret;
 }
 
 void SWCanvas::LayerState::Init(SWCanvas* parent_canvas, Vec2 offset) {
@@ -320,38 +383,70 @@ void SWCanvas::OnClipPath(const Path& path, ClipOp op) {
     return;
   }
 
-  SWRaster raster;
+  SWRaster raster(&raster_arena_);
   raster.RastePath(path, CurrentTransform(), GetScanClipBounds());
 
   if (state_stack_.back().HasClip()) {
     auto spans = state_stack_.back().RecursiveClip(raster.CurrentSpans(), op);
-    state_stack_.back().clip_spans_ = spans;
+    state_stack_.back().SetClipSpans(std::move(spans));
     if (state_stack_.back().op != op) {
       state_stack_.back().op = Canvas::ClipOp::kIntersect;
     }
   } else {
-    state_stack_.back().clip_spans_ = raster.CurrentSpans();
+    state_stack_.back().SetClipSpans(raster.CurrentSpans());
     state_stack_.back().op = op;
   }
 }
 
-void SWCanvas::DoBrush(const SWRaster& raster, const Paint& paint,
-                       bool stroke) {
-  SKITY_TRACE_EVENT(SWCanvas_DoBrush);
+class SWCanvas::BrushSpanDelegate : public SpanBuilderDelegate {
+ public:
+  BrushSpanDelegate(SWCanvas* canvas, const Paint& paint, bool stroke)
+      : canvas_(canvas), paint_(paint), stroke_(stroke) {
+    if (canvas_->state_stack_.back().HasClip()) {
+      clip_ = &canvas_->state_stack_.back();
+    }
+  }
 
-  std::unique_ptr<SWSpanBrush> brush;
-  if (state_stack_.back().HasClip()) {
-    auto clip_spans = state_stack_.back().PerformClip(raster.CurrentSpans());
-    if (clip_spans.empty()) {
+  void OnBeginSpans(const Rect& bounds) override {
+    brush_ = canvas_->GenerateBrush(no_spans_, paint_, stroke_, bounds);
+    brush_->BeginBrush();
+  }
+
+  void OnBuildSpan(int x, int y, int width, const uint8_t alpha) override {
+    Span span{x, y, width, alpha};
+    if (clip_ == nullptr) {
+      brush_->BrushSpan(span);
       return;
     }
-    brush = GenerateBrush(clip_spans, paint, stroke, raster.GetBounds());
-    brush->Brush();
-  } else {
-    brush =
-        GenerateBrush(raster.CurrentSpans(), paint, stroke, raster.GetBounds());
-    brush->Brush();
+
+    clipped_spans_.clear();
+    clip_->ClipSpan(span, &clipped_spans_);
+    for (Span const& clipped : clipped_spans_) {
+      brush_->BrushSpan(clipped);
+    }
   }
+
+  void OnEndSpans() override { brush_->EndBrush(); }
+
+ private:
+  SWCanvas* canvas_;
+  const Paint& paint_;
+  bool stroke_;
+  const State* clip_ = nullptr;
+  // the brush is fed through BrushSpan and never reads its span list
+  std::vector<Span> no_spans_ = {};
+  std::vector<Span> clipped_spans_ = {};
+  std::unique_ptr<SWSpanBrush> brush_ = {};
+};
+
+void SWCanvas::BrushPath(const Path& path, const Matrix& transform,
+                         const Rect& clip_bounds, const Paint& paint,
+                         bool stroke) {
+  SKITY_TRACE_EVENT(SWCanvas_BrushPath);
+
+  BrushSpanDelegate delegate(this, paint, stroke);
+  SWRaster raster(&raster_arena_);
+  raster.RastePath(path, transform, clip_bounds, &delegate);
 }
 
 void SWCanvas::OnDrawPath(const Path& path, const Paint& paint) {
@@ -372,38 +467,27 @@ void SWCanvas::OnDrawPath(const Path& path, const Paint& paint) {
   bool need_stroke = paint.GetStyle() != Paint::kFill_Style;
 
   auto draw_fill = [&]() {
-    SWRaster raster;
-
     Path temp;
     if (paint.GetPathEffect() &&
         paint.GetPathEffect()->FilterPath(&temp, path, false, paint)) {
-      raster.RastePath(temp, CurrentTransform(), GetScanClipBounds());
+      BrushPath(temp, CurrentTransform(), GetScanClipBounds(), paint, false);
     } else {
-      raster.RastePath(path, CurrentTransform(), GetScanClipBounds());
+      BrushPath(path, CurrentTransform(), GetScanClipBounds(), paint, false);
     }
-
-    DoBrush(raster, paint, false);
   };
 
   auto draw_stroke = [&]() {
-    Stroke stroke(paint);
-
     Path temp;
-    Path quad;
-    Path outline;
+    const Path* src = &path;
     if (paint.GetPathEffect() &&
         paint.GetPathEffect()->FilterPath(&temp, path, true, paint)) {
-      stroke.QuadPath(temp, &quad);
-      stroke.StrokePath(quad, &outline);
-    } else {
-      stroke.QuadPath(path, &quad);
-      stroke.StrokePath(quad, &outline);
+      src = &temp;
     }
 
-    SWRaster raster;
-    raster.RastePath(outline, CurrentTransform(), GetScanClipBounds());
+    auto outline = StrokeCache::GetInstance().FindOrCreate(
+        *src, paint, GetMutableFrameStats());
 
-    DoBrush(raster, paint, true);
+    BrushPath(*outline, CurrentTransform(), GetScanClipBounds(), paint, true);
   };
 
   DrawFillStrokeInPaintOrder(paint.GetStyle(), need_fill, need_stroke,
@@ -423,19 +507,7 @@ void SWCanvas::OnDrawPaint(const Paint& paint) {
   Path path;
   path.AddRect(bounds);
 
-  SWRaster raster;
-  raster.RastePath(path, Matrix{});
-
-  std::unique_ptr<SWSpanBrush> brush;
-  // no clip
-  if (state_stack_.empty() || !state_stack_.back().HasClip()) {
-    brush = GenerateBrush(raster.CurrentSpans(), paint, false, bounds);
-    brush->Brush();
-  } else {
-    auto spans = state_stack_.back().PerformClip(raster.CurrentSpans());
-    brush = GenerateBrush(spans, paint, false, bounds);
-    brush->Brush();
-  }
+  BrushPath(path, Matrix{}, SWRaster::kCullRect, paint, false);
 }
 
 void SWCanvas::OnSaveLayer(const Rect& bounds, const Paint& paint) {
@@ -607,11 +679,8 @@ void SWCanvas::FillGlyphs(uint32_t count, const GlyphID* glyphs,
                       skity::Rect::MakeXYWH(x, y, w, h), SamplingOptions{},
                       nullptr);
     } else {
-      SWRaster raster;
-
-      raster.RastePath(path, CurrentTransform() * transform);
-
-      DoBrush(raster, paint, false);
+      BrushPath(path, CurrentTransform() * transform, SWRaster::kCullRect,
+                paint, false);
     }
   }
 }
@@ -624,17 +693,11 @@ void SWCanvas::StrokeGlyphs(uint32_t count, const GlyphID* glyphs,
     auto& path = glyphs_data[k]->GetPath();
     auto transform = Matrix::Translate(position_x[k], position_y[k]);
 
-    Stroke stroke(paint);
-    Path quad;
-    Path outline;
-    stroke.QuadPath(path, &quad);
-    stroke.StrokePath(quad, &outline);
-
-    SWRaster raster;
-
-    raster.RastePath(outline, CurrentTransform() * transform);
+    auto outline = StrokeCache::GetInstance().FindOrCreate(
+        path, paint, GetMutableFrameStats());
 
-    DoBrush(raster, paint, true);
+    BrushPath(*outline, CurrentTransform() * transform, SWRaster::kCullRect,
+              paint, true);
   }
 }
 
@@ -10,6 +10,7 @@
 
 #include "src/render/canvas_state.hpp"
 #include "src/render/sw/sw_subpixel.hpp"
+#include "src/utils/arena_allocator.hpp"
 
 #ifndef SKITY_CPU
 #error "NOT Enable CPU Backend"
@@ -35,16 +36,33 @@ class SWCanvas : public Canvas {
 
     bool HasClip() const { return !clip_spans_.empty(); }
 
-    std::vector<Span> PerformClip(std::vector<Span> const& spans);
+    void SetClipSpans(std::vector<Span> spans);
+
+    /**
+     * Appends the parts of `span` which survive the clip to `out`.
+     */
+    void ClipSpan(Span const& span, std::vector<Span>* out) const;
+
+    std::vector<Span> PerformClip(std::vector<Span> const& spans) const;
 
     std::vector<Span> RecursiveClip(std::vector<Span> const& spans, ClipOp op);
 
    private:
-    std::vector<Span> FindSpan(Span const& span);
+    void FindSpan(Span const& span, std::vector<Span>* out) const;
 
     std::vector<Span> PerformMerge(std::vector<Span> const& spans);
+
+    const Span* ClipRow(int32_t y, size_t* count) const;
+
+    // clip_spans_ grouped by row and sorted by x inside each row, so clipping
+    // a span only visits the clip spans on its own row.
+    std::vector<Span> clip_rows_ = {};
+    std::vector<uint32_t> clip_row_offsets_ = {};
+    int32_t clip_row_top_ = 0;
   };
 
+  class BrushSpanDelegate;
+
   struct LayerState {
     Rect rel_bounds = {};
     Rect log_bounds = {};
@@ -117,7 +135,12 @@ class SWCanvas : public Canvas {
 
   State* CurrentState() { return &state_stack_.back(); }
 
-  void DoBrush(const SWRaster& raster, const Paint& paint, bool stroke);
+  /**
+   * Rasterizes `path` and streams every finished scanline through the clip
+   * into the brush, without collecting the spans of the whole path.
+   */
+  void BrushPath(const Path& path, const Matrix& transform,
+                 const Rect& clip_bounds, const Paint& paint, bool stroke);
 
   void DrawGlyphsInternal(uint32_t count, const GlyphID* glyphs,
                           const float* position_x, const float* position_y,
@@ -189,6 +212,11 @@ class SWCanvas : public Canvas {
   SWCanvas* parent_canvas_ = nullptr;
   Vec2 global_offset_ = Vec2{0.f, 0.f};
   bool drawing_layer_ = false;
+  // Edge storage for every path rasterized by this canvas. The arena is reset
+  // after each path and its blocks are kept in the cache for the next one.
+  std::shared_ptr<BlockCacheAllocator> raster_block_cache_ =
+      std::make_shared<BlockCacheAllocator>();
+  ArenaAllocator raster_arena_{raster_block_cache_};
 };
 
 }  // namespace skity
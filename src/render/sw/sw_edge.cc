@@ -320,18 +320,20 @@ int SWEdgeBuilder::BuildEdges(const Path& path, const Rect& scan_bounds) {
 }
 
 void SWEdgeBuilder::AddLine(const Point pts[], const Rect& scan_bounds) {
-  auto edge = std::make_unique<SWEdge>();
+  // the arena hands out trivial types uninitialized
+  auto edge = arena_->Make<SWEdge>();
+  *edge = {};
   if (edge->SetLine(pts[0], pts[1]) &&
       !edge->CanBeIgnored(scan_bounds, edge->upper_y, edge->lower_y)) {
-    edges_.push_back(std::move(edge));
+    edges_.push_back(edge);
   }
 }
 
 void SWEdgeBuilder::AddQuad(const Point pts[], const Rect& scan_bounds) {
-  auto edge = std::make_unique<SWQuadEdge>();
+  auto edge = arena_->Make<SWQuadEdge>();
   if (edge->SetQuad(pts) &&
       !edge->CanBeIgnored(scan_bounds, edge->q_first_y, edge->q_last_y)) {
-    edges_.push_back(std::move(edge));
+    edges_.push_back(edge);
   }
 }
 
@@ -12,6 +12,7 @@
 #include <vector>
 
 #include "src/render/sw/sw_subpixel.hpp"
+#include "src/utils/arena_allocator.hpp"
 
 namespace skity {
 
@@ -80,16 +81,28 @@ struct SWQuadEdge : public SWEdge {
   void KeepContinuous();
 };
 
+/**
+ * Builds the edge list of a path. Edges are bump allocated from `arena`, which
+ * is reset when the builder goes away, so the caller can keep one arena around
+ * and reuse its blocks for every path.
+ */
 class SWEdgeBuilder {
  public:
+  explicit SWEdgeBuilder(ArenaAllocator* arena) : arena_(arena) {}
+  ~SWEdgeBuilder() { arena_->Reset(); }
+
+  SWEdgeBuilder(const SWEdgeBuilder&) = delete;
+  SWEdgeBuilder& operator=(const SWEdgeBuilder&) = delete;
+
   int BuildEdges(const Path& path, const Rect& scan_bounds);
-  std::vector<std::unique_ptr<SWEdge>>& GetEdges() { return edges_; }
+  std::vector<SWEdge*>& GetEdges() { return edges_; }
 
  private:
   void AddLine(const Point pts[], const Rect& scan_bounds);
   void AddQuad(const Point pts[], const Rect& scan_bounds);
 
-  std::vector<std::unique_ptr<SWEdge>> edges_;
+  ArenaAllocator* arena_;
+  std::vector<SWEdge*> edges_;
 };
 
 }  // namespace skity
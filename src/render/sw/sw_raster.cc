@@ -9,6 +9,7 @@
 #include <cassert>
 #include <cmath>
 #include <cstddef>
+#include <memory>
 #include <skity/geometry/stroke.hpp>
 
 #include "src/logging.hpp"
@@ -30,6 +31,7 @@ void RealSpanBuilder::BuildSpan(int x, int y, int width, const uint8_t alpha) {
 
   if (delegate_) {
     delegate_->OnBuildSpan(x, y, width, alpha);
+    return;
   }
 
   Span span{
@@ -676,38 +678,36 @@ void WalkEdges(SWEdge* prev_head, SWEdge* next_tail,
   }
 }
 
-static void SortEdges(std::vector<std::unique_ptr<SWEdge>>& edges) {
-  std::sort(
-      edges.begin(), edges.end(),
-      [](const std::unique_ptr<SWEdge>& a, const std::unique_ptr<SWEdge>& b) {
-        int valuea = a.get()->upper_y;
-        int valueb = b.get()->upper_y;
+static void SortEdges(std::vector<SWEdge*>& edges) {
+  std::sort(edges.begin(), edges.end(), [](const SWEdge* a, const SWEdge* b) {
+    int valuea = a->upper_y;
+    int valueb = b->upper_y;
 
-        if (valuea == valueb) {
-          valuea = a.get()->x;
-          valueb = b.get()->x;
-        }
+    if (valuea == valueb) {
+      valuea = a->x;
+      valueb = b->x;
+    }
 
-        if (valuea == valueb) {
-          valuea = a.get()->dx;
-          valueb = b.get()->dx;
-        }
+    if (valuea == valueb) {
+      valuea = a->dx;
+      valueb = b->dx;
+    }
 
-        return valuea < valueb;
-      });
+    return valuea < valueb;
+  });
   size_t count = edges.size();
 
   for (size_t i = 1; i < count; i++) {
-    edges[i - 1]->next = edges[i].get();
-    edges[i]->prev = edges[i - 1].get();
+    edges[i - 1]->next = edges[i];
+    edges[i]->prev = edges[i - 1];
   }
 }
 
-static void ProcessEdges(std::vector<std::unique_ptr<SWEdge>>& edges,
-                         SWEdge& head, SWEdge& tail) {
+static void ProcessEdges(std::vector<SWEdge*>& edges, SWEdge& head,
+                         SWEdge& tail) {
   SortEdges(edges);
-  SWEdge* first = edges[0].get();
-  SWEdge* last = edges.back().get();
+  SWEdge* first = edges[0];
+  SWEdge* last = edges.back();
 
   head.prev = nullptr;
   head.next = first;
@@ -753,7 +753,14 @@ void SWRaster::RastePath(Path const& path, Matrix const& transform,
     return;
   }
 
-  SWEdgeBuilder builder;
+  std::unique_ptr<ArenaAllocator> local_arena;
+  ArenaAllocator* arena = arena_;
+  if (arena == nullptr) {
+    local_arena = std::make_unique<ArenaAllocator>();
+    arena = local_arena.get();
+  }
+
+  SWEdgeBuilder builder(arena);
   int count = builder.BuildEdges(transformed_path, scan_bounds);
   auto& edges = builder.GetEdges();
   if (count == 0) {
@@ -779,10 +786,18 @@ void SWRaster::RastePath(Path const& path, Matrix const& transform,
   left_bound = static_cast<uint32_t>(scan_bounds.Left()) << 16;
   right_bound = static_cast<uint32_t>(scan_bounds.Right()) << 16;
 
+  if (span_builder_delegate) {
+    span_builder_delegate->OnBeginSpans(bounds_);
+  }
+
   WalkEdges(&head, &tail, path.GetFillType(), &span_builder, start_y, stop_y,
             left_bound, right_bound);
   span_builder.Flush();
   spans_ = span_builder.TakeSpans();
+
+  if (span_builder_delegate) {
+    span_builder_delegate->OnEndSpans();
+  }
 }
 
 }  // namespace skity
@@ -21,7 +21,18 @@ class SpanBuilderDelegate {
  public:
   virtual ~SpanBuilderDelegate() = default;
 
+  /**
+   * Called once the device bounds of the path are known, before the first
+   * span. Not called when no edge of the path is inside the clip bounds.
+   */
+  virtual void OnBeginSpans(const Rect&) {}
+
   virtual void OnBuildSpan(int x, int y, int width, const uint8_t alpha) = 0;
+
+  /**
+   * Called after the last span, only if OnBeginSpans was called.
+   */
+  virtual void OnEndSpans() {}
 };
 
 class RealSpanBuilder {
@@ -82,7 +93,19 @@ void WalkEdges(SWEdge* prev_head, SWEdge* next_tail,
 class SWRaster {
  public:
   constexpr static Rect kCullRect = Rect::MakeLTRB(-1E9F, -1E9F, 1E9F, 1E9F);
+
+  /**
+   * Edges are allocated from `arena` when one is given, otherwise from an
+   * arena owned by each RastePath call.
+   */
+  explicit SWRaster(ArenaAllocator* arena = nullptr) : arena_(arena) {}
+
   void SetEvenOdd(bool even_odd) { even_odd_ = even_odd; }
+
+  /**
+   * Spans are streamed to `span_builder_delegate` as each scanline is
+   * finished when one is given, and collected into CurrentSpans() otherwise.
+   */
   void RastePath(Path const& path, Matrix const& transform,
                  const Rect& clip_bounds = kCullRect,
                  SpanBuilderDelegate* span_builder_delegate = nullptr);
@@ -92,6 +115,7 @@ class SWRaster {
   Rect GetBounds() const { return bounds_; }
 
  private:
+  ArenaAllocator* arena_;
   bool even_odd_;
   std::vector<Span> spans_;
   Rect bounds_;
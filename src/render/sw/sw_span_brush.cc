@@ -9,6 +9,7 @@
 
 #include "src/geometry/geometry.hpp"
 #include "src/graphic/color_priv.hpp"
+#include "src/graphic/mipmap_cache.hpp"
 #include "src/tracing.hpp"
 
 #ifdef SKITY_ARM_NEON
@@ -66,43 +67,45 @@ float32x4_t RemapFloatTileNeon(float32x4_t t, TileMode tile_mode) {
 void SWSpanBrush::Brush() {
   SKITY_TRACE_EVENT(SWSpanBrush_Brush);
 
+  BeginBrush();
+  for (size_t i = 0; i < spans_size_; i++) {
+    BrushSpan(p_spans_[i]);
+  }
+  EndBrush();
+}
+
+void SWSpanBrush::BrushSpan(Span const& span) {
   auto i_width = static_cast<int32_t>(bitmap_->Width());
   auto i_height = static_cast<int32_t>(bitmap_->Height());
 
-  OnPreBrush();
-  for (size_t i = 0; i < spans_size_; i++) {
-    Span const& span = p_spans_[i];
-
-    auto x = span.x;
-    auto y = span.y;
-    auto len = span.len;
+  auto x = span.x;
+  auto y = span.y;
+  auto len = span.len;
 
-    if (y < 0 || y >= i_height) {
-      continue;
-    }
+  if (y < 0 || y >= i_height) {
+    return;
+  }
 
-    if (x >= i_width || x + len < 0) {
-      continue;
-    }
+  if (x >= i_width || x + len < 0) {
+    return;
+  }
 
-    if (x < 0) {
-      len += x;
-      x = 0;
-    }
+  if (x < 0) {
+    len += x;
+    x = 0;
+  }
 
-    if (x + len >= i_width) {
-      len = i_width - x;
-    }
+  if (x + len >= i_width) {
+    len = i_width - x;
+  }
 
-    if (len <= 0) {
-      continue;
-    }
+  if (len <= 0) {
+    return;
+  }
 
-    auto u_alpha = static_cast<uint8_t>(span.cover & global_alpha_);
+  auto u_alpha = static_cast<uint8_t>(span.cover & global_alpha_);
 
-    BrushH(x, y, len, u_alpha);
-  }
-  OnPostBrush();
+  BrushH(x, y, len, u_alpha);
 }
 
 void SWSpanBrush::BrushH(int32_t x, int32_t y, int32_t length, int32_t alpha) {
@@ -113,30 +116,36 @@ void SWSpanBrush::BrushH(int32_t x, int32_t y, int32_t length, int32_t alpha) {
       color = AlphaMulQ(color, alpha);
     }
 
-    if (color_filter_) {
-      color = color_filter_->FilterColor(color);
+    if (!filter_program_.IsEmpty()) {
+      color = filter_program_.Run(color);
     }
     render_target_.BlendPixelH(x, y, color, length, blend_);
   } else {
     std::vector<uint32_t> pm_colors(static_cast<size_t>(length));
 
-    for (int32_t l = 0; l < length; l++) {
-      PMColor color = CalculateColor(x + l, y);
-      if (alpha != 255) {
-        color = AlphaMulQ(color, alpha);
-      }
+    CalculateColors(x, y, length, pm_colors.data());
 
-      if (color_filter_) {
-        color = color_filter_->FilterColor(color);
+    if (alpha != 255) {
+      for (int32_t l = 0; l < length; l++) {
+        pm_colors[l] = AlphaMulQ(pm_colors[l], alpha);
       }
+    }
 
-      pm_colors[l] = color;
+    if (!filter_program_.IsEmpty()) {
+      filter_program_.Run(pm_colors.data(), length);
     }
 
     render_target_.BlendPixelH(x, y, pm_colors.data(), length, blend_);
   }
 }
 
+void SWSpanBrush::CalculateColors(int32_t x, int32_t y, int32_t length,
+                                  PMColor colors[]) {
+  for (int32_t l = 0; l < length; l++) {
+    colors[l] = CalculateColor(x + l, y);
+  }
+}
+
 SolidColorBrush::SolidColorBrush(std::vector<Span> const& spans, Bitmap* bitmap,
                                  ColorFilter* color_filter, BlendMode blend,
                                  Color4f color)
@@ -225,7 +234,8 @@ GradientColorBrush::GradientColorBrush(
     BlendMode blend, Shader::GradientInfo info, Shader::GradientType type)
     : SWSpanBrush(spans, bitmap, color_filter, blend, 1.f),
       info_(std::move(info)),
-      type_(type) {}
+      type_(type),
+      lut_(GradientLUTCache::GetInstance().FindOrCreate(info_)) {}
 
 namespace {
 
@@ -236,66 +246,27 @@ Vec2 inline MapPoint(const Vec2& src, const Matrix& m) {
 
 }  // namespace
 
-Color4f GradientColorBrush::LerpColor(float current) {
-  if (FloatNearlyZero(current)) {
-    current = 0.0f;
-  } else if (FloatNearlyZero(current - 1.0f)) {
-    current = 1.0f;
+PMColor GradientColorBrush::SampleColor(float t) const {
+  if (FloatNearlyZero(t)) {
+    t = 0.0f;
+  } else if (FloatNearlyZero(t - 1.0f)) {
+    t = 1.0f;
   }
 
-  if ((info_.tile_mode == TileMode::kDecal &&
-       (current < 0.0 || current >= 1.0))) {
-    return Colors::kTransparent;
+  if ((info_.tile_mode == TileMode::kDecal && (t < 0.0 || t >= 1.0))) {
+    return 0;
   }
 
-  current = RemapFloatTile(current, info_.tile_mode);
-
-  int32_t color_count = info_.colors.size();
-  int32_t stop_count = info_.color_offsets.size();
-
-  int32_t start_index = 0;
-  int32_t end_index = 1;
-
-  float step = 1.f / (color_count - 1);
+  t = RemapFloatTile(t, info_.tile_mode);
 
-  if (stop_count > 0 && current <= info_.color_offsets[0]) {
-    return info_.colors[0];
+  // Also catches NaN, which the old stop search resolved to the last color.
+  if (!(t < 1.f)) {
+    t = 1.f;
+  } else if (t < 0.f) {
+    t = 0.f;
   }
 
-  int32_t i = 0;
-  float start = 0.f;
-  float end = 0.f;
-
-  for (i = 0; i < color_count - 1; i++) {
-    if (stop_count > 0) {
-      start = info_.color_offsets[i];
-      end = info_.color_offsets[i + 1];
-    } else {
-      start = step * i;
-      end = step * (i + 1);
-    }
-
-    if (current >= start && current <= end) {
-      start_index = i;
-      end_index = i + 1;
-      break;
-    }
-  }
-
-  if (i == color_count - 1 && color_count > 0) {
-    return info_.colors[color_count - 1];
-  }
-
-  float total = end - start;
-  float value = current - start;
-
-  float mix_value = 0.5f;
-  if (total > 0) {
-    mix_value = value / total;
-  }
-
-  return info_.colors[start_index] * (1 - mix_value) +
-         info_.colors[end_index] * mix_value;
+  return lut_->Lookup(t);
 }
 
 class LinearGradientColorBrush : public GradientColorBrush {
@@ -313,10 +284,20 @@ class LinearGradientColorBrush : public GradientColorBrush {
     SKITY_TRACE_EVENT(LinearGradientColorBrush_CalculateColor);
 
     Vec2 src{x + 0.5f, y + 0.5f};
-    Color4f c = LerpColor(MapPoint(src, points_to_unit_).x);
-    Color color = Color4fToColor(c);
-    color = ColorToPMColor(color);
-    return color;
+    return SampleColor(MapPoint(src, points_to_unit_).x);
+  }
+
+  void CalculateColors(int32_t x, int32_t y, int32_t length,
+                       PMColor colors[]) override {
+    SKITY_TRACE_EVENT(LinearGradientColorBrush_CalculateColors);
+
+    // t is affine in x, so one step of the matrix per pixel along the row.
+    Vec2 src{x + 0.5f, y + 0.5f};
+    float t = MapPoint(src, points_to_unit_).x;
+    float dt = points_to_unit_.GetScaleX();
+    for (int32_t l = 0; l < length; l++) {
+      colors[l] = SampleColor(t + dt * l);
+    }
   }
 
  private:
@@ -338,22 +319,32 @@ class SweepGradientColorBrush : public GradientColorBrush {
     SKITY_TRACE_EVENT(SweepGradientColorBrush_CalculateColor);
 
     Vec2 src{x + 0.5f, y + 0.5f};
-    auto mapped = MapPoint(src, points_to_unit_);
+    return SampleColor(SweepT(MapPoint(src, points_to_unit_)));
+  }
+
+  void CalculateColors(int32_t x, int32_t y, int32_t length,
+                       PMColor colors[]) override {
+    SKITY_TRACE_EVENT(SweepGradientColorBrush_CalculateColors);
+
+    Vec2 src{x + 0.5f, y + 0.5f};
+    Vec2 mapped = MapPoint(src, points_to_unit_);
+    Vec2 step{points_to_unit_.GetScaleX(), points_to_unit_.GetSkewY()};
+    for (int32_t l = 0; l < length; l++) {
+      colors[l] = SampleColor(SweepT(mapped + step * l));
+    }
+  }
 
+ private:
+  float SweepT(const Vec2& mapped) const {
     float angle = std::atan2(-mapped.y, -mapped.x);
 
     auto bias = info_.radius[0];
     auto scale = info_.radius[1];
 
     constexpr static float k1Over2Pi = 0.1591549430918;
-    float t = (angle * k1Over2Pi + 0.5 + bias) * scale;
-    Color4f c = LerpColor(t);
-    Color color = Color4fToColor(c);
-    color = ColorToPMColor(color);
-    return color;
+    return (angle * k1Over2Pi + 0.5 + bias) * scale;
   }
 
- private:
   Matrix points_to_unit_ = {};
 };
 
@@ -372,10 +363,19 @@ class RadialGradientColorBrush : public GradientColorBrush {
     SKITY_TRACE_EVENT(RadialGradientColorBrush_CalculateColor);
 
     Vec2 src{x + 0.5f, y + 0.5f};
-    Color4f c = LerpColor(MapPoint(src, points_to_unit_).Length());
-    Color color = Color4fToColor(c);
-    color = ColorToPMColor(color);
-    return color;
+    return SampleColor(MapPoint(src, points_to_unit_).Length());
+  }
+
+  void CalculateColors(int32_t x, int32_t y, int32_t length,
+                       PMColor colors[]) override {
+    SKITY_TRACE_EVENT(RadialGradientColorBrush_CalculateColors);
+
+    Vec2 src{x + 0.5f, y + 0.5f};
+    Vec2 mapped = MapPoint(src, points_to_unit_);
+    Vec2 step{points_to_unit_.GetScaleX(), points_to_unit_.GetSkewY()};
+    for (int32_t l = 0; l < length; l++) {
+      colors[l] = SampleColor((mapped + step * l).Length());
+    }
   }
 
  private:
@@ -398,10 +398,7 @@ class ConicalGradientColorBrush : public GradientColorBrush {
   Color CalculateColor(int32_t x, int32_t y) override {
     SKITY_TRACE_EVENT(ConicalGradientColorBrush_CalculateColor);
 
-    Color4f c = CalculateConical(x, y);
-    Color color = Color4fToColor(c);
-    color = ColorToPMColor(color);
-    return color;
+    return CalculateConical(x, y);
   }
 
   void OnPreBrush() override {
@@ -446,9 +443,9 @@ class ConicalGradientColorBrush : public GradientColorBrush {
   void OnPostBrush() override {}
 
  private:
-  Color4f CalculateConical(int32_t x, int32_t y) {
+  PMColor CalculateConical(int32_t x, int32_t y) {
     if (r0_ < 0 || r1_ < 0) {
-      return Colors::kTransparent;
+      return 0;
     }
 
     float t = 0;
@@ -457,7 +454,7 @@ class ConicalGradientColorBrush : public GradientColorBrush {
     if (radial_) {
       // degenerate case 1: codes from shader
       if (strip_) {
-        return Colors::kTransparent;
+        return 0;
       }
       Vec2 pt = (p - FromPoint(c0_)) * scale_;
       t = pt.Length() * scale_sign_ - bias_;
@@ -469,7 +466,7 @@ class ConicalGradientColorBrush : public GradientColorBrush {
       p = MapPoint(p, c0c1_transform_);
       t = r_2 - p.y * p.y;
       if (t < 0.0) {
-        return Colors::kTransparent;
+        return 0;
       }
       t = p.x + sqrt(t);
     } else {
@@ -494,7 +491,7 @@ class ConicalGradientColorBrush : public GradientColorBrush {
       }
 
       if (xt < 0) {
-        return Colors::kTransparent;
+        return 0;
       }
 
       t = f_ + (1.f - f_) * xt;
@@ -503,7 +500,7 @@ class ConicalGradientColorBrush : public GradientColorBrush {
       }
     }
 
-    return LerpColor(t);
+    return SampleColor(t);
   }
 
  private:
@@ -559,18 +556,87 @@ PixmapBrush::PixmapBrush(std::vector<Span> const& spans, Bitmap* bitmap,
                          const SamplingOptions& sampling, TileMode x_tile_mode,
                          TileMode y_tile_mode)
     : SWSpanBrush(spans, bitmap, color_filter, blend, global_alpha),
-      texture_(new Bitmap(std::move(pixmap))),
+      mip_levels_(SelectMipLevels(std::move(pixmap), points_to_unit, sampling)),
+      texture_(new Bitmap(mip_levels_.level)),
       points_to_unit_(points_to_unit),
       filter_mode_(sampling.UseCubic() ? FilterMode::kLinear : sampling.filter),
       x_tile_mode_(x_tile_mode),
       y_tile_mode_(y_tile_mode),
-      bitmap_sampler_(*texture_.get(), sampling, x_tile_mode, y_tile_mode) {}
+      bitmap_sampler_(*texture_.get(), sampling, x_tile_mode, y_tile_mode) {
+  if (mip_levels_.next_level) {
+    next_texture_ = std::make_unique<Bitmap>(mip_levels_.next_level);
+    next_sampler_ = std::make_unique<BitmapSampler>(
+        *next_texture_, sampling, x_tile_mode, y_tile_mode);
+  }
+}
+
+PixmapBrush::MipLevels PixmapBrush::SelectMipLevels(
+    std::shared_ptr<Pixmap> pixmap, const Matrix& points_to_unit,
+    const SamplingOptions& sampling) {
+  MipLevels levels;
+  levels.level = std::move(pixmap);
+
+  // Cubic sampling is done with bilinear filtering on the base level.
+  if (sampling.mipmap == MipmapMode::kNone || sampling.UseCubic()) {
+    return levels;
+  }
+
+  float lod = ComputeMipmapLevel(points_to_unit, levels.level->Width(),
+                                 levels.level->Height());
+  if (sampling.mipmap == MipmapMode::kNearest) {
+    lod = std::floor(lod + 0.5f);
+  }
+
+  if (lod <= 0.f) {
+    return levels;
+  }
+
+  auto mipmap = MipmapCache::GetInstance().FindOrCreate(*levels.level);
+  if (!mipmap) {
+    return levels;
+  }
+
+  const uint32_t max_level = mipmap->GetLevelCount() - 1;
+  const uint32_t level = std::min(static_cast<uint32_t>(lod), max_level);
+  const float weight = lod - static_cast<float>(level);
+
+  if (level > 0) {
+    levels.level = mipmap->GetLevel(level);
+  }
+
+  if (level < max_level && weight > 0.f) {
+    levels.next_level = mipmap->GetLevel(level + 1);
+    levels.next_level_weight = weight;
+  }
+
+  return levels;
+}
+
+namespace {
+
+Color LerpColor(Color c0, Color c1, float weight) {
+  const uint32_t w1 = static_cast<uint32_t>(weight * 256.f + 0.5f);
+  const uint32_t w0 = 256 - w1;
+
+  Color result = 0;
+  for (uint32_t shift = 0; shift < 32; shift += 8) {
+    uint32_t v = ((c0 >> shift) & 0xFF) * w0 + ((c1 >> shift) & 0xFF) * w1;
+    result |= ((v + 128) >> 8) << shift;
+  }
+  return result;
+}
+
+}  // namespace
 
 Color PixmapBrush::CalculateColor(int32_t x, int32_t y) {
   SKITY_TRACE_EVENT(PixmapBrush_CalculateColor);
 
   auto uv = MapPoint(Vec2{x + 0.5f, y + 0.5f}, points_to_unit_);
   Color color = bitmap_sampler_.GetColor(uv);
+  if (next_sampler_) {
+    color = LerpColor(color, next_sampler_->GetColor(uv),
+                      mip_levels_.next_level_weight);
+  }
   if (texture_->GetAlphaType() == kUnpremul_AlphaType) {
     color = ColorToPMColor(color);
   }
@@ -660,7 +726,7 @@ void PixmapBrush::BrushH(int32_t x, int32_t y, int32_t length, int32_t alpha) {
   SKITY_TRACE_EVENT(PixmapBrush_BrushH);
 
 #ifdef SKITY_ARM_NEON
-  if (filter_mode_ == FilterMode::kLinear) {
+  if (filter_mode_ == FilterMode::kLinear || next_sampler_) {
     // TODO(zhangzhijian): Accelerate it via neon
     SWSpanBrush::BrushH(x, y, length, alpha);
     return;
@@ -6,6 +6,7 @@
 #define SRC_RENDER_SW_SW_SPAN_BRUSH_HPP
 
 #include <array>
+#include <memory>
 #include <skity/effect/shader.hpp>
 #include <skity/geometry/matrix.hpp>
 #include <skity/graphic/color.hpp>
@@ -13,6 +14,8 @@
 #include <skity/graphic/tile_mode.hpp>
 #include <vector>
 
+#include "src/effect/color_filter_program.hpp"
+#include "src/effect/gradient_lut.hpp"
 #include "src/graphic/bitmap_sampler.hpp"
 #include "src/render/sw/sw_render_target.hpp"
 #include "src/render/sw/sw_subpixel.hpp"
@@ -30,7 +33,7 @@ class SWSpanBrush {
       : p_spans_(spans.data()),
         spans_size_(spans.size()),
         bitmap_(bitmap),
-        color_filter_(color_filter),
+        filter_program_(color_filter),
         blend_(blend),
         global_alpha_(static_cast<uint8_t>(255 * global_alpha)),
         render_target_(bitmap_) {}
@@ -39,10 +42,28 @@ class SWSpanBrush {
 
   void Brush();
 
+  /**
+   * Streaming form of Brush() for spans which are produced one at a time:
+   * BeginBrush, then BrushSpan for every span, then EndBrush.
+   */
+  void BeginBrush() { OnPreBrush(); }
+
+  void BrushSpan(Span const& span);
+
+  void EndBrush() { OnPostBrush(); }
+
  protected:
   // premultiplied color
   virtual Color CalculateColor(int32_t x, int32_t y) = 0;
 
+  /**
+   * Premultiplied colors of `length` pixels starting at (x, y). Brushes which
+   * can step their shading along a row override this instead of paying for
+   * CalculateColor on every pixel.
+   */
+  virtual void CalculateColors(int32_t x, int32_t y, int32_t length,
+                               PMColor colors[]);
+
   virtual bool PureColor() const { return false; }
 
   const Span* GetSpans() const { return p_spans_; }
@@ -64,7 +85,8 @@ class SWSpanBrush {
   const Span* p_spans_;
   size_t spans_size_;
   Bitmap* bitmap_;
-  ColorFilter* color_filter_;
+  // The paint color filter compiled once per brush and run over whole spans.
+  ColorFilterProgram filter_program_;
   BlendMode blend_;
   uint8_t global_alpha_;
   SWRenderTarget render_target_;
@@ -102,10 +124,14 @@ class GradientColorBrush : public SWSpanBrush {
  protected:
   Color CalculateColor(int32_t x, int32_t y) override;
 
-  Color4f LerpColor(float current);
+  /**
+   * Tiles `t` and looks it up in the shared color table of the gradient.
+   */
+  PMColor SampleColor(float t) const;
 
   Shader::GradientInfo info_ = {};
   Shader::GradientType type_ = {};
+  std::shared_ptr<const GradientLUT> lut_ = {};
 };
 
 class PixmapBrush : public SWSpanBrush {
@@ -124,12 +150,30 @@ class PixmapBrush : public SWSpanBrush {
   void BrushH(int32_t x, int32_t y, int32_t length, int32_t alpha) override;
 
  private:
+  struct MipLevels {
+    std::shared_ptr<Pixmap> level;
+    // Only set for MipmapMode::kLinear between two levels.
+    std::shared_ptr<Pixmap> next_level;
+    float next_level_weight = 0.f;
+  };
+
+  /**
+   * Picks the pixmap to sample from the mip pyramid of `pixmap` for the scale
+   * of `points_to_unit`, honoring the mipmap mode of `sampling`.
+   */
+  static MipLevels SelectMipLevels(std::shared_ptr<Pixmap> pixmap,
+                                   const Matrix& points_to_unit,
+                                   const SamplingOptions& sampling);
+
+  MipLevels mip_levels_;
   std::unique_ptr<Bitmap> texture_;
   Matrix points_to_unit_ = {};
   FilterMode filter_mode_ = FilterMode::kNearest;
   TileMode x_tile_mode_ = TileMode::kClamp;
   TileMode y_tile_mode_ = TileMode::kClamp;
   BitmapSampler bitmap_sampler_;
+  std::unique_ptr<Bitmap> next_texture_;
+  std::unique_ptr<BitmapSampler> next_sampler_;
 };
 
 }  // namespace skity
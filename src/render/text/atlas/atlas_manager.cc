@@ -58,6 +58,19 @@ void AtlasManager::ClearExtraRes() {
   }
 }
 
+AtlasStats AtlasManager::GetStats() const {
+  AtlasStats stats;
+  for (size_t i = 0; i < 2; i++) {
+    if (atlas_[i]) {
+      const auto& atlas_stats = atlas_[i]->GetStats();
+      stats.glyph_hits += atlas_stats.glyph_hits;
+      stats.glyph_misses += atlas_stats.glyph_misses;
+      stats.upload_bytes += atlas_stats.upload_bytes;
+    }
+  }
+  return stats;
+}
+
 /// Atlas
 Atlas::Atlas(AtlasFormat format, GPUDevice* gpu_device,
              bool enable_larger_atlas)
@@ -122,11 +135,13 @@ GlyphRegion Atlas::GetGlyphRegion(const Font& font,
       if (region.loc != INVALID_LOC) {
         region.index_in_group = index;
         region.scale = sdf_scale;
+        stats_.glyph_hits++;
         return region;
       }
     }
   }
 
+  stats_.glyph_misses++;
   GlyphRegion gen_region = GenerateGlyphRegion(font, key, paint, load_sdf);
   gen_region.scale = sdf_scale;
   return gen_region;
@@ -300,6 +315,9 @@ void Atlas::UploadAtlas(uint32_t group_index) {
             atlas_config_.max_bitmap_size, dirty_rect->w - dirty_rect->y,
             mem_data + atlas_config_.max_bitmap_size * dirty_rect->y *
                            bytes_per_pixel_);
+        uint64_t dirty_rows = dirty_rect->w - dirty_rect->y;
+        stats_.upload_bytes +=
+            dirty_rows * atlas_config_.max_bitmap_size * bytes_per_pixel_;
         atlas_bitmap_[index]->SetAllClean();
       }
     }
@@ -22,6 +22,14 @@ namespace skity {
 
 class GPUContextImpl;
 
+// Running totals of glyph atlas work. The atlas is shared by every surface of
+// a context, so a canvas takes the difference across its own text draws.
+struct AtlasStats {
+  uint64_t glyph_hits = 0;
+  uint64_t glyph_misses = 0;
+  uint64_t upload_bytes = 0;
+};
+
 class Atlas {
  public:
   Atlas(AtlasFormat format, GPUDevice* gpu_device, bool enable_larger_atlas);
@@ -53,6 +61,8 @@ class Atlas {
 
   void ClearExtraRes();
 
+  const AtlasStats& GetStats() const { return stats_; }
+
  private:
   // add one glyph to memory atlas
   GlyphRegion GenerateGlyphRegion(const Font& font, GlyphKey const& key,
@@ -70,6 +80,7 @@ class Atlas {
   uint32_t current_bitmap_index_ = 0;
   std::vector<std::unique_ptr<AtlasTextureArray>> atlas_texture_array_;
   uint32_t least_used_index_ = 0;
+  AtlasStats stats_ = {};
 };
 
 class AtlasManager {
@@ -80,6 +91,9 @@ class AtlasManager {
 
   void ClearExtraRes();
 
+  // Sum of the stats of all atlases created so far.
+  AtlasStats GetStats() const;
+
  private:
   std::unique_ptr<Atlas> atlas_[2]{nullptr, nullptr};
   GPUDevice* gpu_device_;
@@ -0,0 +1,35 @@
+// Copyright 2021 The Lynx Authors. All rights reserved.
+// Licensed under the Apache License Version 2.0 that can be found in the
+// LICENSE file in the root directory of this source tree.
+
+#include "src/text/char_to_glyph_table.hpp"
+
+namespace skity {
+
+CharToGlyphTable::CharToGlyphTable() : pages_(1, Page{}) {}
+
+void CharToGlyphTable::Set(Unichar code_point, GlyphID glyph) {
+  if (code_point > kMaxCodePoint) {
+    return;
+  }
+
+  uint16_t& index = page_index_[code_point >> kPageShift];
+  if (index == 0) {
+    if (glyph == 0) {
+      return;
+    }
+    index = static_cast<uint16_t>(pages_.size());
+    pages_.emplace_back(Page{});
+  }
+
+  pages_[index][code_point & (kPageSize - 1)] = glyph;
+}
+
+void CharToGlyphTable::Lookup(const Unichar chars[], int count,
+                              GlyphID glyphs[]) const {
+  for (int i = 0; i < count; ++i) {
+    glyphs[i] = Lookup(chars[i]);
+  }
+}
+
+}  // namespace skity
@@ -0,0 +1,67 @@
+// Copyright 2021 The Lynx Authors. All rights reserved.
+// Licensed under the Apache License Version 2.0 that can be found in the
+// LICENSE file in the root directory of this source tree.
+
+#ifndef SRC_TEXT_CHAR_TO_GLYPH_TABLE_HPP
+#define SRC_TEXT_CHAR_TO_GLYPH_TABLE_HPP
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <skity/text/glyph.hpp>
+#include <vector>
+
+namespace skity {
+
+/**
+ * Dense two level map from Unicode code point to glyph id, filled from the
+ * cmap of a typeface.
+ *
+ * The code space is split into pages of 256 code points, pages without any
+ * glyph share one empty page. A lookup is two loads and no branch besides the
+ * range check. The table is filled once before it is published and read
+ * without locks afterwards.
+ */
+class CharToGlyphTable {
+ public:
+  static constexpr Unichar kMaxCodePoint = 0x10FFFF;
+
+  CharToGlyphTable();
+  ~CharToGlyphTable() = default;
+
+  CharToGlyphTable(const CharToGlyphTable&) = delete;
+  CharToGlyphTable& operator=(const CharToGlyphTable&) = delete;
+
+  /**
+   * Maps `code_point` to `glyph`. Only called while the table is being
+   * filled, code points above kMaxCodePoint are ignored.
+   */
+  void Set(Unichar code_point, GlyphID glyph);
+
+  GlyphID Lookup(Unichar code_point) const {
+    if (code_point > kMaxCodePoint) {
+      return 0;
+    }
+    return pages_[page_index_[code_point >> kPageShift]]
+                 [code_point & (kPageSize - 1)];
+  }
+
+  void Lookup(const Unichar chars[], int count, GlyphID glyphs[]) const;
+
+  size_t GetPageCount() const { return pages_.size() - 1; }
+
+ private:
+  static constexpr uint32_t kPageShift = 8;
+  static constexpr uint32_t kPageSize = 1u << kPageShift;
+  static constexpr uint32_t kPageCount = (kMaxCodePoint >> kPageShift) + 1;
+
+  using Page = std::array<GlyphID, kPageSize>;
+
+  // Page 0 is the shared empty page.
+  std::array<uint16_t, kPageCount> page_index_ = {};
+  std::vector<Page> pages_;
+};
+
+}  // namespace skity
+
+#endif  // SRC_TEXT_CHAR_TO_GLYPH_TABLE_HPP
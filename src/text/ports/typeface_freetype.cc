@@ -173,8 +173,35 @@ size_t TypefaceFreeType::OnGetTableData(FontTableTag tag, size_t offset,
   return size;
 }
 
+const CharToGlyphTable* TypefaceFreeType::GetCharToGlyphTable() const {
+  c2g_table_once_([this] {
+    AutoFTAccess fta(this);
+    FT_Face face = fta.Face();
+    if (!face || !face->charmap ||
+        face->charmap->encoding != FT_ENCODING_UNICODE) {
+      return;
+    }
+
+    auto table = std::make_unique<CharToGlyphTable>();
+    FT_UInt glyph_index = 0;
+    FT_ULong code_point = FT_Get_First_Char(face, &glyph_index);
+    while (glyph_index != 0) {
+      table->Set(static_cast<Unichar>(code_point),
+                 static_cast<GlyphID>(glyph_index));
+      code_point = FT_Get_Next_Char(face, code_point, &glyph_index);
+    }
+    c2g_table_ = std::move(table);
+  });
+  return c2g_table_.get();
+}
+
 void TypefaceFreeType::OnCharsToGlyphs(const uint32_t* chars, int count,
                                        GlyphID glyphs[]) const {
+  if (const CharToGlyphTable* table = GetCharToGlyphTable()) {
+    table->Lookup(chars, count, glyphs);
+    return;
+  }
+
   int i = 0;
   {
     std::lock_guard<std::mutex> ama(C2GCacheMutex_);
@@ -99,10 +99,17 @@ class TypefaceFreeType : public Typeface {
   void OnGetFontDescriptor(FontDescriptor& desc) const override;
 
  private:
+  // Returns null when the face has no unicode cmap.
+  const CharToGlyphTable* GetCharToGlyphTable() const;
+
   mutable std::once_flag flag_;
   mutable std::unique_ptr<FreetypeFaceHolder> freetype_face_holder_;
   mutable std::mutex C2GCacheMutex_;
   mutable std::unordered_map<Unichar, GlyphID> C2GCache_;
+  // Built once from a unicode cmap and read without locks afterwards. Faces
+  // without one keep using C2GCache_.
+  mutable Once c2g_table_once_;
+  mutable std::unique_ptr<CharToGlyphTable> c2g_table_;
   mutable Once contain_color_table_once_;
   mutable bool contain_color_table_;
 };
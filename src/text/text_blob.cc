@@ -2,6 +2,7 @@
 // Licensed under the Apache License Version 2.0 that can be found in the
 // LICENSE file in the root directory of this source tree.
 
+#include <atomic>
 #include <cmath>
 #include <cstring>
 #include <skity/text/font.hpp>
@@ -128,6 +129,12 @@ class SimpleDelegate : public TypefaceDelegate {
   std::vector<std::shared_ptr<Typeface>> typefaces_;
 };
 
+TypefaceDelegate::TypefaceDelegate() {
+  // 0 is left for "no delegate yet" in TextBlobBuilder.
+  static std::atomic<uint32_t> next_id{1};
+  id_ = next_id.fetch_add(1, std::memory_order_relaxed);
+}
+
 std::unique_ptr<TypefaceDelegate>
 TypefaceDelegate::CreateSimpleFallbackDelegate(
     const std::vector<std::shared_ptr<Typeface>> &typefaces) {
@@ -215,43 +222,46 @@ std::vector<TextRun> TextBlobBuilder::GenerateTextRuns(
   float font_size = paint.GetTextSize();
   std::vector<TextRun> runs = {};
 
+  // Delegates are compared by ID rather than address, a delegate created
+  // where a destroyed one lived must not inherit its answers.
+  if (delegate->GetID() != fallback_delegate_id_ ||
+      fallback_base_.lock() != typeface) {
+    ClearFallbackCache();
+    fallback_delegate_id_ = delegate->GetID();
+    fallback_base_ = typeface;
+  }
+
+  std::vector<GlyphID> glyph_ids(code_points.size(), 0);
+  typeface->UnicharsToGlyphs(code_points.data(),
+                             static_cast<int>(code_points.size()),
+                             glyph_ids.data());
+
   auto prev_char_typeface = typeface;
   const auto default_typeface = typeface;
   std::vector<GlyphID> infos = {};
-  for (auto cp : code_points) {
-    auto glyph_id = default_typeface->UnicharToGlyph(cp);
-    if (glyph_id != 0) {
-      if (prev_char_typeface != default_typeface) {
-        // need to create a new TextRun
-        Font font{prev_char_typeface, font_size};
-        runs.emplace_back(TextRun(font, infos));
-        // begin new TextRun
-        infos.clear();
+  for (size_t i = 0; i < code_points.size(); i++) {
+    auto glyph_id = glyph_ids[i];
+    auto char_typeface = default_typeface;
+    if (glyph_id == 0) {
+      // fallback to base typeface
+      auto const &fallback = FindFallback(code_points[i], paint, delegate);
+      if (!fallback.typeface || fallback.glyph_id == 0) {
+        // failed fallback
+        continue;
       }
-      infos.emplace_back(glyph_id);
-      prev_char_typeface = default_typeface;
-      continue;
+      glyph_id = fallback.glyph_id;
+      char_typeface = fallback.typeface;
     }
 
-    // fallback to base typeface
-    auto fallback_typeface = delegate->Fallback(cp, paint);
-    if (!fallback_typeface) {
-      // failed fallback
-      continue;
-    }
-    glyph_id = fallback_typeface->UnicharToGlyph(cp);
-    if (glyph_id != 0) {
-      if (prev_char_typeface != fallback_typeface) {
-        // need to create a new TextRun
-        Font font{prev_char_typeface, font_size};
-        runs.emplace_back(TextRun(font, infos));
-        // begin new TextRun
-        infos.clear();
-      }
-      infos.emplace_back(glyph_id);
-      prev_char_typeface = fallback_typeface;
-      continue;
+    if (prev_char_typeface != char_typeface) {
+      // need to create a new TextRun
+      Font font{prev_char_typeface, font_size};
+      runs.emplace_back(TextRun(font, infos));
+      // begin new TextRun
+      infos.clear();
     }
+    infos.emplace_back(glyph_id);
+    prev_char_typeface = char_typeface;
   }
   if (!infos.empty()) {
     Font font{prev_char_typeface, font_size};
@@ -261,16 +271,41 @@ std::vector<TextRun> TextBlobBuilder::GenerateTextRuns(
   return runs;
 }
 
+uint64_t TextBlobBuilder::FallbackKey(Unichar code_point, Paint const &paint) {
+  return static_cast<uint64_t>(paint.GetStyle()) << 32 | code_point;
+}
+
+TextBlobBuilder::FallbackEntry const &TextBlobBuilder::FindFallback(
+    Unichar code_point, Paint const &paint, TypefaceDelegate *delegate) {
+  // The delegate sees the paint, so the answer is remembered per paint style
+  // as well. The paint typeface is covered by clearing the cache on change.
+  uint64_t key = FallbackKey(code_point, paint);
+  auto it = fallback_cache_.find(key);
+  if (it != fallback_cache_.end()) {
+    return it->second;
+  }
+
+  // misses are remembered as well, so a code point no typeface covers only
+  // asks the delegate once
+  FallbackEntry entry = {};
+  entry.typeface = delegate->Fallback(code_point, paint);
+  if (entry.typeface) {
+    entry.glyph_id = entry.typeface->UnicharToGlyph(code_point);
+  }
+
+  return fallback_cache_.emplace(key, std::move(entry)).first->second;
+}
+
+void TextBlobBuilder::ClearFallbackCache() { fallback_cache_.clear(); }
+
 TextRun TextBlobBuilder::GenerateTextRun(
     std::vector<Unichar> const &code_points, std::shared_ptr<Typeface> typeface,
     float font_size, bool) {
-  std::vector<GlyphID> infos = {};
-
-  for (Unichar cp : code_points) {
-    // TODO(tangruiwen) maybe check if need glyph path
-    auto glyph_id = typeface->UnicharToGlyph(cp);
-    infos.emplace_back(glyph_id);
-  }
+  // TODO(tangruiwen) maybe check if need glyph path
+  std::vector<GlyphID> infos(code_points.size(), 0);
+  typeface->UnicharsToGlyphs(code_points.data(),
+                             static_cast<int>(code_points.size()),
+                             infos.data());
 
   Font f{typeface, font_size};
   return TextRun{f, infos};
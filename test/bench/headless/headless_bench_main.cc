@@ -0,0 +1,49 @@
+// Copyright 2021 The Lynx Authors. All rights reserved.
+// Licensed under the Apache License Version 2.0 that can be found in the
+// LICENSE file in the root directory of this source tree.
+
+#include <benchmark/benchmark.h>
+
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "test/bench/headless/headless_benchmarks.hpp"
+
+// Besides the usual --benchmark_* flags this accepts --skp_dir=<dir> to pick
+// the SKP files to replay. Write machine readable results with
+// --benchmark_out=<file> --benchmark_out_format=json and compare two runs
+// with tools/bench_compare.py.
+int main(int argc, char** argv) {
+  static const char kSkpDirFlag[] = "--skp_dir=";
+
+#ifdef RESOURCES_DIR
+  std::string skp_dir = RESOURCES_DIR "/skp";
+#else
+  std::string skp_dir;
+#endif
+
+  std::vector<char*> args;
+  for (int i = 0; i < argc; i++) {
+    if (std::strncmp(argv[i], kSkpDirFlag, sizeof(kSkpDirFlag) - 1) == 0) {
+      skp_dir = argv[i] + sizeof(kSkpDirFlag) - 1;
+    } else {
+      args.emplace_back(argv[i]);
+    }
+  }
+  int args_count = static_cast<int>(args.size());
+
+  benchmark::Initialize(&args_count, args.data());
+  if (benchmark::ReportUnrecognizedArguments(args_count, args.data())) {
+    return 1;
+  }
+
+  skity::RegisterSceneBenchmarks();
+  if (!skp_dir.empty()) {
+    skity::RegisterSKPBenchmarks(skp_dir);
+  }
+
+  benchmark::RunSpecifiedBenchmarks();
+  benchmark::Shutdown();
+  return 0;
+}
@@ -0,0 +1,250 @@
+// Copyright 2021 The Lynx Authors. All rights reserved.
+// Licensed under the Apache License Version 2.0 that can be found in the
+// LICENSE file in the root directory of this source tree.
+
+#include "test/bench/headless/headless_benchmarks.hpp"
+
+#include <benchmark/benchmark.h>
+
+#include <algorithm>
+#include <cmath>
+#include <filesystem>
+#include <functional>
+#include <memory>
+#include <skity/skity.hpp>
+#include <string>
+#include <vector>
+
+#include "test/bench/headless/null_gpu_context.hpp"
+#include "test/bench/headless/scenes.hpp"
+
+#ifdef SKITY_HEADLESS_BENCH_SKP
+#include <skity/io/picture.hpp>
+#include <skity/io/stream.hpp>
+#endif
+
+namespace skity {
+
+namespace {
+
+constexpr uint32_t kSceneWidth = 512;
+constexpr uint32_t kSceneHeight = 512;
+
+using DrawFunc = std::function<bool(Canvas*, uint32_t, uint32_t)>;
+
+// Reports the per frame average of every counter that moved, so the JSON
+// output carries the work behind each timing next to it.
+void ReportFrameStats(benchmark::State& state, const FrameStats& total) {
+  for (size_t i = 0; i < FrameStats::kCounterCount; i++) {
+    auto counter = static_cast<FrameCounter>(i);
+    uint64_t value = total.GetCounter(counter);
+    if (value == 0) {
+      continue;
+    }
+    state.counters[FrameStats::GetCounterName(counter)] = benchmark::Counter(
+        static_cast<double>(value), benchmark::Counter::kAvgIterations);
+  }
+
+  const auto& compile =
+      total.GetHistogram(FrameHistogram::kPipelineCompileMicros);
+  if (compile.count > 0) {
+    state.counters["pipeline_compile_micros_p50"] =
+        static_cast<double>(compile.ApproximatePercentile(50.f));
+  }
+}
+
+void RunSW(benchmark::State& state, const DrawFunc& draw, uint32_t width,
+           uint32_t height) {
+  Bitmap bitmap(width, height, AlphaType::kPremul_AlphaType,
+                ColorType::kRGBA);
+  auto canvas = Canvas::MakeSoftwareCanvas(&bitmap);
+
+  FrameStats total;
+  for (auto _ : state) {
+    canvas->ResetFrameStats();
+    canvas->Clear(Color_WHITE);
+    if (!draw(canvas.get(), width, height)) {
+      state.SkipWithError("scene is not supported in this build");
+      return;
+    }
+    canvas->Flush();
+    total.Merge(canvas->GetFrameStats());
+  }
+
+  ReportFrameStats(state, total);
+}
+
+bool DrawFrame(GPUSurface* surface, const DrawFunc& draw, uint32_t width,
+               uint32_t height) {
+  auto* canvas = surface->LockCanvas();
+  bool drawn = draw(canvas, width, height);
+  canvas->Flush();
+  surface->Flush();
+  return drawn;
+}
+
+void RunHW(benchmark::State& state, const DrawFunc& draw, uint32_t width,
+           uint32_t height) {
+  auto context = NullGPUContext::Make();
+  if (context == nullptr) {
+    state.SkipWithError("failed to create null GPU context");
+    return;
+  }
+
+  GPUSurfaceDescriptor desc{};
+  desc.width = width;
+  desc.height = height;
+  desc.sample_count = 4;
+  auto surface = context->CreateSurface(&desc);
+
+  // Warm the pipeline cache and the glyph atlas so only steady state frames
+  // are timed.
+  if (!DrawFrame(surface.get(), draw, width, height)) {
+    state.SkipWithError("scene is not supported in this build");
+    return;
+  }
+
+  FrameStats total;
+  for (auto _ : state) {
+    DrawFrame(surface.get(), draw, width, height);
+    total.Merge(surface->GetLastFrameStats());
+  }
+
+  ReportFrameStats(state, total);
+}
+
+void RunHWCold(benchmark::State& state, const DrawFunc& draw, uint32_t width,
+               uint32_t height) {
+  FrameStats total;
+  for (auto _ : state) {
+    state.PauseTiming();
+    auto context = NullGPUContext::Make();
+    if (context == nullptr) {
+      state.SkipWithError("failed to create null GPU context");
+      return;
+    }
+    GPUSurfaceDescriptor desc{};
+    desc.width = width;
+    desc.height = height;
+    desc.sample_count = 4;
+    auto surface = context->CreateSurface(&desc);
+    state.ResumeTiming();
+
+    if (!DrawFrame(surface.get(), draw, width, height)) {
+      state.SkipWithError("scene is not supported in this build");
+      return;
+    }
+    total.Merge(surface->GetLastFrameStats());
+
+    state.PauseTiming();
+    surface.reset();
+    context.reset();
+    state.ResumeTiming();
+  }
+
+  ReportFrameStats(state, total);
+}
+
+#ifdef SKITY_HEADLESS_BENCH_SKP
+
+std::shared_ptr<DisplayList> LoadSKP(const std::string& path, Rect* bounds) {
+  auto stream = ReadStream::CreateFromFile(path.c_str());
+  if (stream == nullptr) {
+    return nullptr;
+  }
+
+  auto picture = Picture::MakeFromStream(*stream);
+  if (picture == nullptr) {
+    return nullptr;
+  }
+
+  // Replay a recorded display list rather than the picture so parsing stays
+  // out of the timed region.
+  *bounds = picture->GetCullRect();
+  PictureRecorder recorder;
+  recorder.BeginRecording(*bounds);
+  picture->PlayBack(recorder.GetRecordingCanvas());
+  return recorder.FinishRecording();
+}
+
+#endif  // SKITY_HEADLESS_BENCH_SKP
+
+}  // namespace
+
+void RegisterSceneBenchmarks() {
+  for (const auto& scene : GetHeadlessScenes()) {
+    DrawFunc draw = scene.draw;
+    std::string name = scene.name;
+
+    benchmark::RegisterBenchmark(("SW/" + name).c_str(),
+                                 [draw](benchmark::State& state) {
+                                   RunSW(state, draw, kSceneWidth,
+                                         kSceneHeight);
+                                 })
+        ->Unit(benchmark::kMicrosecond);
+
+    benchmark::RegisterBenchmark(("HW/" + name).c_str(),
+                                 [draw](benchmark::State& state) {
+                                   RunHW(state, draw, kSceneWidth,
+                                         kSceneHeight);
+                                 })
+        ->Unit(benchmark::kMicrosecond);
+
+    benchmark::RegisterBenchmark(("HWCold/" + name).c_str(),
+                                 [draw](benchmark::State& state) {
+                                   RunHWCold(state, draw, kSceneWidth,
+                                             kSceneHeight);
+                                 })
+        ->Unit(benchmark::kMillisecond);
+  }
+}
+
+size_t RegisterSKPBenchmarks(const std::string& skp_dir) {
+#ifdef SKITY_HEADLESS_BENCH_SKP
+  std::error_code ec;
+  std::vector<std::filesystem::path> files;
+  for (const auto& entry : std::filesystem::directory_iterator(skp_dir, ec)) {
+    if (entry.is_regular_file() && entry.path().extension() == ".skp") {
+      files.emplace_back(entry.path());
+    }
+  }
+  // Directory order is unspecified, sort so names line up across runs.
+  std::sort(files.begin(), files.end());
+
+  size_t count = 0;
+  for (const auto& file : files) {
+    Rect bounds;
+    auto display_list = LoadSKP(file.string(), &bounds);
+    if (display_list == nullptr || bounds.IsEmpty()) {
+      continue;
+    }
+
+    auto width = static_cast<uint32_t>(std::ceil(bounds.Right()));
+    auto height = static_cast<uint32_t>(std::ceil(bounds.Bottom()));
+    DrawFunc draw = [display_list](Canvas* canvas, uint32_t, uint32_t) {
+      display_list->Draw(canvas);
+      return true;
+    };
+    std::string name = file.stem().string();
+
+    benchmark::RegisterBenchmark(("SW/skp/" + name).c_str(),
+                                 [=](benchmark::State& state) {
+                                   RunSW(state, draw, width, height);
+                                 })
+        ->Unit(benchmark::kMillisecond);
+
+    benchmark::RegisterBenchmark(("HW/skp/" + name).c_str(),
+                                 [=](benchmark::State& state) {
+                                   RunHW(state, draw, width, height);
+                                 })
+        ->Unit(benchmark::kMillisecond);
+    count++;
+  }
+  return count;
+#else
+  (void)skp_dir;
+  return 0;
+#endif
+}
+
+}  // namespace skity
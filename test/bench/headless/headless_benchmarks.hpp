@@ -0,0 +1,31 @@
+// Copyright 2021 The Lynx Authors. All rights reserved.
+// Licensed under the Apache License Version 2.0 that can be found in the
+// LICENSE file in the root directory of this source tree.
+
+#ifndef TEST_BENCH_HEADLESS_HEADLESS_BENCHMARKS_HPP
+#define TEST_BENCH_HEADLESS_HEADLESS_BENCHMARKS_HPP
+
+#include <string>
+
+namespace skity {
+
+/**
+ * Registers one benchmark per synthetic scene and renderer:
+ *
+ *   SW/<scene>        software rasterization into a Bitmap.
+ *   HW/<scene>        a warm frame on the null GPU context, pipelines cached.
+ *   HWCold/<scene>    the first frame on a fresh null GPU context, including
+ *                     shader generation and WGX translation.
+ */
+void RegisterSceneBenchmarks();
+
+/**
+ * Registers SW/<file> and HW/<file> replay benchmarks for every .skp file in
+ * `skp_dir`. Does nothing if the IO module is not built in. Returns the
+ * number of files registered.
+ */
+size_t RegisterSKPBenchmarks(const std::string& skp_dir);
+
+}  // namespace skity
+
+#endif  // TEST_BENCH_HEADLESS_HEADLESS_BENCHMARKS_HPP
@@ -0,0 +1,257 @@
+// Copyright 2021 The Lynx Authors. All rights reserved.
+// Licensed under the Apache License Version 2.0 that can be found in the
+// LICENSE file in the root directory of this source tree.
+
+#include "test/bench/headless/null_gpu_context.hpp"
+
+#include <utility>
+#include <wgsl_cross.h>
+
+#include "src/gpu/gpu_blit_pass.hpp"
+#include "src/gpu/gpu_buffer.hpp"
+#include "src/gpu/gpu_command_buffer.hpp"
+#include "src/gpu/gpu_device.hpp"
+#include "src/gpu/gpu_render_pipeline.hpp"
+#include "src/gpu/gpu_sampler.hpp"
+#include "src/gpu/gpu_shader_function.hpp"
+#include "src/gpu/gpu_shader_module.hpp"
+#include "src/gpu/gpu_surface_impl.hpp"
+#include "src/gpu/gpu_texture.hpp"
+#include "src/render/hw/layer/hw_root_layer.hpp"
+
+namespace skity {
+
+namespace {
+
+class NullShaderFunction : public GPUShaderFunction {
+ public:
+  explicit NullShaderFunction(GPULabel label)
+      : GPUShaderFunction(std::move(label)) {}
+
+  bool IsValid() const override { return true; }
+};
+
+class NullRenderPipeline : public GPURenderPipeline {
+ public:
+  explicit NullRenderPipeline(const GPURenderPipelineDescriptor& desc)
+      : GPURenderPipeline(desc) {}
+};
+
+class NullSampler : public GPUSampler {
+ public:
+  explicit NullSampler(const GPUSamplerDescriptor& desc) : GPUSampler(desc) {}
+};
+
+class NullTexture : public GPUTexture {
+ public:
+  explicit NullTexture(const GPUTextureDescriptor& desc) : GPUTexture(desc) {}
+
+  size_t GetBytes() const override {
+    return desc_.width * desc_.height *
+           GetTextureFormatBytesPerPixel(desc_.format);
+  }
+
+  void UploadData(uint32_t, uint32_t, uint32_t, uint32_t, void*) override {}
+};
+
+class NullBlitPass : public GPUBlitPass {
+ public:
+  void UploadTextureData(std::shared_ptr<GPUTexture>, uint32_t, uint32_t,
+                         uint32_t, uint32_t, void*) override {}
+
+  void UploadBufferData(GPUBuffer*, void*, size_t) override {}
+
+  void GenerateMipmaps(const std::shared_ptr<GPUTexture>&) override {}
+
+  void End() override {}
+};
+
+class NullRenderPass : public GPURenderPass {
+ public:
+  explicit NullRenderPass(const GPURenderPassDescriptor& desc)
+      : GPURenderPass(desc) {}
+
+  void EncodeCommands(std::optional<GPUViewport> = std::nullopt,
+                      std::optional<GPUScissorRect> = std::nullopt) override {}
+};
+
+class NullCommandBuffer : public GPUCommandBuffer {
+ public:
+  std::shared_ptr<GPURenderPass> BeginRenderPass(
+      const GPURenderPassDescriptor& desc) override {
+    return std::make_shared<NullRenderPass>(desc);
+  }
+
+  std::shared_ptr<GPUBlitPass> BeginBlitPass() override {
+    return std::make_shared<NullBlitPass>();
+  }
+
+  bool Submit(const GPUSubmitInfo* = nullptr) override { return true; }
+};
+
+class NullGPUDevice : public GPUDevice {
+ public:
+  NullGPUDevice() { InitCaps(std::make_unique<GPUCaps>()); }
+
+  std::unique_ptr<GPUBuffer> CreateBuffer(
+      const GPUBufferDescriptor& desc) override {
+    return std::make_unique<GPUBuffer>(desc);
+  }
+
+  std::shared_ptr<GPUShaderFunction> CreateShaderFunction(
+      const GPUShaderFunctionDescriptor& desc) override {
+    auto function = std::make_shared<NullShaderFunction>(desc.label);
+    if (desc.source_type != GPUShaderSourceType::kWGX ||
+        desc.shader_source == nullptr) {
+      return function;
+    }
+
+    // Translate the same way the GL backend does, so shader translation is
+    // part of what is measured.
+    auto source = static_cast<GPUShaderSourceWGX*>(desc.shader_source);
+    wgx::GlslOptions options{};
+    options.standard = wgx::GlslOptions::Standard::kES;
+    options.major_version = 3;
+    options.minor_version = 0;
+
+    auto result = source->module->GetProgram()->WriteToGlsl(
+        source->entry_point, options, source->context);
+    if (!result.success) {
+      return {};
+    }
+
+    function->SetBindGroups(result.bind_groups);
+    function->SetWGXContext(result.context);
+    source->context = result.context;
+    return function;
+  }
+
+  std::unique_ptr<GPURenderPipeline> CreateRenderPipeline(
+      const GPURenderPipelineDescriptor& desc) override {
+    return std::make_unique<NullRenderPipeline>(desc);
+  }
+
+  std::unique_ptr<GPURenderPipeline> ClonePipeline(
+      GPURenderPipeline*, const GPURenderPipelineDescriptor& desc) override {
+    return std::make_unique<NullRenderPipeline>(desc);
+  }
+
+  std::shared_ptr<GPUCommandBuffer> CreateCommandBuffer() override {
+    return std::make_shared<NullCommandBuffer>();
+  }
+
+  std::shared_ptr<GPUSampler> CreateSampler(
+      const GPUSamplerDescriptor& desc) override {
+    return std::make_shared<NullSampler>(desc);
+  }
+
+  std::shared_ptr<GPUTexture> CreateTexture(
+      const GPUTextureDescriptor& desc) override {
+    return std::make_shared<NullTexture>(desc);
+  }
+
+  bool CanUseMSAA() override { return true; }
+
+  uint32_t GetBufferAlignment() override { return 256; }
+
+  uint32_t GetMaxTextureSize() override { return 4096; }
+};
+
+class NullRootLayer : public HWRootLayer {
+ public:
+  NullRootLayer(uint32_t width, uint32_t height, const Rect& bounds,
+                GPUTextureFormat format)
+      : HWRootLayer(width, height, bounds, format) {}
+
+ private:
+  std::shared_ptr<GPURenderPass> OnBeginRenderPass(GPUCommandBuffer* cmd,
+                                                   bool force_load) override {
+    GPUTextureDescriptor texture_desc{};
+    texture_desc.width = GetWidth();
+    texture_desc.height = GetHeight();
+    texture_desc.format = GetColorFormat();
+
+    auto texture = std::make_shared<NullTexture>(texture_desc);
+
+    GPURenderPassDescriptor desc{};
+    desc.color_attachment.texture = texture;
+    desc.stencil_attachment.texture = texture;
+    desc.depth_attachment.texture = texture;
+    desc.color_attachment.load_op = (force_load || !NeedClearSurface())
+                                        ? GPULoadOp::kLoad
+                                        : GPULoadOp::kClear;
+    desc.stencil_attachment.load_op = GPULoadOp::kClear;
+    desc.depth_attachment.load_op = GPULoadOp::kClear;
+    desc.label = "NullRootLayer";
+    return cmd->BeginRenderPass(desc);
+  }
+
+  void OnPostDraw(GPURenderPass*, GPUCommandBuffer*) override {}
+};
+
+class NullGPUSurface : public GPUSurfaceImpl {
+ public:
+  NullGPUSurface(const GPUSurfaceDescriptor& desc, GPUContextImpl* ctx)
+      : GPUSurfaceImpl(desc, ctx) {}
+
+  GPUTextureFormat GetGPUFormat() const override {
+    return GPUTextureFormat::kRGBA8Unorm;
+  }
+
+  std::shared_ptr<Pixmap> ReadPixels(const Rect&) override { return nullptr; }
+
+ protected:
+  HWRootLayer* OnBeginNextFrame(bool clear) override {
+    auto* root_layer = GetArenaAllocator()->Make<NullRootLayer>(
+        GetWidth(), GetHeight(), Rect::MakeWH(GetWidth(), GetHeight()),
+        GetGPUFormat());
+    root_layer->SetClearSurface(clear);
+    root_layer->SetSampleCount(GetSampleCount());
+    root_layer->SetArenaAllocator(GetArenaAllocator());
+    return root_layer;
+  }
+
+  void OnFlush() override {}
+};
+
+}  // namespace
+
+std::unique_ptr<NullGPUContext> NullGPUContext::Make() {
+  auto context = std::make_unique<NullGPUContext>();
+  if (!context->Init()) {
+    return nullptr;
+  }
+  return context;
+}
+
+std::unique_ptr<GPUSurface> NullGPUContext::CreateSurface(
+    GPUSurfaceDescriptor* desc) {
+  return std::make_unique<NullGPUSurface>(*desc, this);
+}
+
+std::unique_ptr<GPUDevice> NullGPUContext::CreateGPUDevice() {
+  return std::make_unique<NullGPUDevice>();
+}
+
+std::shared_ptr<GPUTexture> NullGPUContext::OnWrapTexture(
+    GPUBackendTextureInfo*, ReleaseCallback, ReleaseUserData) {
+  return nullptr;
+}
+
+std::unique_ptr<GPURenderTarget> NullGPUContext::OnCreateRenderTarget(
+    const GPURenderTargetDescriptor& desc, std::shared_ptr<Texture> texture) {
+  GPUSurfaceDescriptor surface_desc{};
+  surface_desc.width = desc.width;
+  surface_desc.height = desc.height;
+  surface_desc.sample_count = desc.sample_count;
+  surface_desc.render_options = desc.render_options;
+  return std::make_unique<GPURenderTarget>(
+      std::make_unique<NullGPUSurface>(surface_desc, this), std::move(texture));
+}
+
+std::shared_ptr<Data> NullGPUContext::OnReadPixels(
+    const std::shared_ptr<GPUTexture>&) const {
+  return nullptr;
+}
+
+}  // namespace skity
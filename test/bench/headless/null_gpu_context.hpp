@@ -0,0 +1,51 @@
+// Copyright 2021 The Lynx Authors. All rights reserved.
+// Licensed under the Apache License Version 2.0 that can be found in the
+// LICENSE file in the root directory of this source tree.
+
+#ifndef TEST_BENCH_HEADLESS_NULL_GPU_CONTEXT_HPP
+#define TEST_BENCH_HEADLESS_NULL_GPU_CONTEXT_HPP
+
+#include <memory>
+#include <skity/gpu/gpu_surface.hpp>
+
+#include "src/gpu/gpu_context_impl.hpp"
+
+namespace skity {
+
+/**
+ * A GPU context backed by a device that never touches a GPU. Buffers,
+ * textures and command buffers are empty shells, but shader functions are
+ * still translated from WGX to GLSL and pipelines still get their bind
+ * groups. This leaves the CPU half of the HW renderer intact: tessellation,
+ * draw merging, uniform packing, stage buffer writes and shader translation.
+ */
+class NullGPUContext : public GPUContextImpl {
+ public:
+  /**
+   * Returns an initialized context, or nullptr if initialization failed.
+   */
+  static std::unique_ptr<NullGPUContext> Make();
+
+  NullGPUContext() : GPUContextImpl(GPUBackendType::kNone) {}
+
+  std::unique_ptr<GPUSurface> CreateSurface(
+      GPUSurfaceDescriptor* desc) override;
+
+ protected:
+  std::unique_ptr<GPUDevice> CreateGPUDevice() override;
+
+  std::shared_ptr<GPUTexture> OnWrapTexture(GPUBackendTextureInfo* info,
+                                            ReleaseCallback callback,
+                                            ReleaseUserData user_data) override;
+
+  std::unique_ptr<GPURenderTarget> OnCreateRenderTarget(
+      const GPURenderTargetDescriptor& desc,
+      std::shared_ptr<Texture> texture) override;
+
+  std::shared_ptr<Data> OnReadPixels(
+      const std::shared_ptr<GPUTexture>& texture) const override;
+};
+
+}  // namespace skity
+
+#endif  // TEST_BENCH_HEADLESS_NULL_GPU_CONTEXT_HPP
@@ -0,0 +1,188 @@
+// Copyright 2021 The Lynx Authors. All rights reserved.
+// Licensed under the Apache License Version 2.0 that can be found in the
+// LICENSE file in the root directory of this source tree.
+
+#include "test/bench/headless/scenes.hpp"
+
+#include <array>
+#include <random>
+#include <skity/skity.hpp>
+
+namespace skity {
+
+namespace {
+
+// Every scene draws from a fixed seed so a frame is the same on every run.
+constexpr uint32_t kSeed = 2021;
+
+Color RandomColor(std::mt19937& rng) {
+  std::uniform_int_distribution<uint32_t> channel(0, 255);
+  return ColorSetARGB(0xFF, channel(rng), channel(rng), channel(rng));
+}
+
+bool DrawTextWall(Canvas* canvas, uint32_t width, uint32_t height) {
+  auto typeface = Typeface::GetDefaultTypeface();
+  if (typeface == nullptr || !typeface->ContainGlyph('a')) {
+    return false;
+  }
+
+  Paint paint;
+  paint.SetTypeface(typeface);
+  paint.SetTextSize(14.f);
+  paint.SetColor(Color_BLACK);
+
+  const char* lines[] = {
+      "The quick brown fox jumps over the lazy dog 0123456789",
+      "Sphinx of black quartz, judge my vow. !?&%$#@",
+      "Pack my box with five dozen liquor jugs; ()[]{}<>",
+  };
+
+  uint32_t row = 0;
+  for (float y = 16.f; y < height; y += 18.f, row++) {
+    canvas->DrawSimpleText2(lines[row % 3], 4.f, y, paint);
+  }
+
+  return true;
+}
+
+bool DrawRRects(Canvas* canvas, uint32_t width, uint32_t height) {
+  std::mt19937 rng(kSeed);
+  std::uniform_real_distribution<float> radius(2.f, 12.f);
+
+  Paint fill;
+  Paint stroke;
+  stroke.SetStyle(Paint::kStroke_Style);
+  stroke.SetStrokeWidth(2.f);
+
+  for (float y = 0.f; y + 24.f <= height; y += 28.f) {
+    for (float x = 0.f; x + 40.f <= width; x += 44.f) {
+      auto rrect = RRect::MakeRectXY(Rect::MakeXYWH(x, y, 40.f, 24.f),
+                                     radius(rng), radius(rng));
+      fill.SetColor(RandomColor(rng));
+      canvas->DrawRRect(rrect, fill);
+      stroke.SetColor(RandomColor(rng));
+      canvas->DrawRRect(rrect, stroke);
+    }
+  }
+
+  return true;
+}
+
+bool DrawGradients(Canvas* canvas, uint32_t width, uint32_t height) {
+  std::array<Vec4, 3> colors = {
+      Vec4{1.f, 0.f, 0.f, 1.f},
+      Vec4{0.f, 1.f, 0.f, 1.f},
+      Vec4{0.f, 0.f, 1.f, 1.f},
+  };
+  std::array<float, 3> stops = {0.f, 0.4f, 1.f};
+
+  Paint paint;
+  uint32_t index = 0;
+  for (float y = 0.f; y + 64.f <= height; y += 64.f) {
+    for (float x = 0.f; x + 64.f <= width; x += 64.f, index++) {
+      auto rect = Rect::MakeXYWH(x, y, 60.f, 60.f);
+      if (index % 2 == 0) {
+        std::array<Point, 2> pts = {
+            Point{x, y, 0.f, 1.f},
+            Point{x + 60.f, y + 60.f, 0.f, 1.f},
+        };
+        paint.SetShader(Shader::MakeLinear(pts.data(), colors.data(),
+                                           stops.data(), 3));
+        canvas->DrawRect(rect, paint);
+      } else {
+        paint.SetShader(Shader::MakeRadial(
+            Point{x + 30.f, y + 30.f, 0.f, 1.f}, 30.f, colors.data(),
+            stops.data(), 3));
+        canvas->DrawCircle(x + 30.f, y + 30.f, 28.f, paint);
+      }
+    }
+  }
+
+  return true;
+}
+
+bool DrawBlurs(Canvas* canvas, uint32_t width, uint32_t height) {
+  std::mt19937 rng(kSeed);
+
+  Paint paint;
+  paint.SetMaskFilter(MaskFilter::MakeBlur(BlurStyle::kNormal, 6.f));
+
+  for (float y = 16.f; y + 64.f <= height; y += 96.f) {
+    for (float x = 16.f; x + 64.f <= width; x += 96.f) {
+      paint.SetColor(RandomColor(rng));
+      canvas->DrawRoundRect(Rect::MakeXYWH(x, y, 64.f, 48.f), 8.f, 8.f, paint);
+    }
+  }
+
+  return true;
+}
+
+bool DrawClips(Canvas* canvas, uint32_t width, uint32_t height) {
+  std::mt19937 rng(kSeed);
+
+  Paint paint;
+  for (float y = 0.f; y + 80.f <= height; y += 80.f) {
+    for (float x = 0.f; x + 80.f <= width; x += 80.f) {
+      canvas->Save();
+      canvas->ClipRRect(
+          RRect::MakeRectXY(Rect::MakeXYWH(x + 4.f, y + 4.f, 72.f, 72.f), 16.f,
+                            16.f));
+
+      Path star;
+      star.MoveTo(x + 40.f, y);
+      star.LineTo(x + 64.f, y + 80.f);
+      star.LineTo(x, y + 28.f);
+      star.LineTo(x + 80.f, y + 28.f);
+      star.LineTo(x + 16.f, y + 80.f);
+      star.Close();
+      canvas->ClipPath(star);
+
+      paint.SetColor(RandomColor(rng));
+      canvas->DrawPaint(paint);
+      canvas->Restore();
+    }
+  }
+
+  return true;
+}
+
+bool DrawPaths(Canvas* canvas, uint32_t width, uint32_t height) {
+  std::mt19937 rng(kSeed);
+  std::uniform_real_distribution<float> coord_x(0.f, width);
+  std::uniform_real_distribution<float> coord_y(0.f, height);
+
+  Paint fill;
+  fill.SetAntiAlias(true);
+  Paint stroke = fill;
+  stroke.SetStyle(Paint::kStroke_Style);
+  stroke.SetStrokeWidth(3.f);
+  stroke.SetStrokeJoin(Paint::kRound_Join);
+
+  for (int32_t i = 0; i < 64; i++) {
+    Path path;
+    path.MoveTo(coord_x(rng), coord_y(rng));
+    for (int32_t j = 0; j < 3; j++) {
+      path.CubicTo(coord_x(rng), coord_y(rng), coord_x(rng), coord_y(rng),
+                   coord_x(rng), coord_y(rng));
+    }
+
+    auto& paint = i % 2 == 0 ? fill : stroke;
+    paint.SetColor(RandomColor(rng));
+    canvas->DrawPath(path, paint);
+  }
+
+  return true;
+}
+
+}  // namespace
+
+const std::vector<Scene>& GetHeadlessScenes() {
+  static const std::vector<Scene> scenes = {
+      {"text_wall", DrawTextWall}, {"rrects", DrawRRects},
+      {"gradients", DrawGradients}, {"blurs", DrawBlurs},
+      {"clips", DrawClips},         {"paths", DrawPaths},
+  };
+  return scenes;
+}
+
+}  // namespace skity
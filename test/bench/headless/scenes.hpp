@@ -0,0 +1,33 @@
+// Copyright 2021 The Lynx Authors. All rights reserved.
+// Licensed under the Apache License Version 2.0 that can be found in the
+// LICENSE file in the root directory of this source tree.
+
+#ifndef TEST_BENCH_HEADLESS_SCENES_HPP
+#define TEST_BENCH_HEADLESS_SCENES_HPP
+
+#include <cstdint>
+#include <skity/render/canvas.hpp>
+#include <vector>
+
+namespace skity {
+
+/**
+ * Draws one frame of a synthetic scene. Returns false if the scene can not
+ * run in this build, for example text without a usable default typeface.
+ */
+using SceneFunc = bool (*)(Canvas* canvas, uint32_t width, uint32_t height);
+
+struct Scene {
+  const char* name;
+  SceneFunc draw;
+};
+
+/**
+ * All synthetic scenes, in a stable order so benchmark names stay comparable
+ * between runs.
+ */
+const std::vector<Scene>& GetHeadlessScenes();
+
+}  // namespace skity
+
+#endif  // TEST_BENCH_HEADLESS_SCENES_HPP
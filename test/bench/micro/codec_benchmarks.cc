@@ -0,0 +1,76 @@
+// Copyright 2021 The Lynx Authors. All rights reserved.
+// Licensed under the Apache License Version 2.0 that can be found in the
+// LICENSE file in the root directory of this source tree.
+
+#include <benchmark/benchmark.h>
+
+#include <cstdint>
+#include <cstring>
+#include <random>
+#include <skity/graphic/color.hpp>
+#include <vector>
+
+#include "module/codec/src/codec/codec_priv.hpp"
+
+namespace {
+
+constexpr int kRowWidth = 1024;
+
+// Translucent pixels in premul form, so no kernel takes its opaque fast path.
+std::vector<uint8_t> MakeRow() {
+  std::mt19937 rng(42);
+  std::uniform_int_distribution<uint32_t> dist;
+  std::vector<uint32_t> pixels(kRowWidth);
+  for (auto& pixel : pixels) {
+    pixel = skity::ColorToPMColor(dist(rng) & 0xFEFFFFFF);
+  }
+  std::vector<uint8_t> row(kRowWidth * 4);
+  std::memcpy(row.data(), pixels.data(), row.size());
+  return row;
+}
+
+void RunTransform(benchmark::State& state,
+                  skity::codec_priv::TransformLineFunc transform) {
+  auto src = MakeRow();
+  std::vector<uint8_t> dst(src.size());
+  for (auto _ : state) {
+    transform(dst.data(), src.data(), kRowWidth, 4);
+    benchmark::DoNotOptimize(dst.data());
+    benchmark::ClobberMemory();
+  }
+  state.SetItemsProcessed(state.iterations() * kRowWidth);
+}
+
+}  // namespace
+
+static void BM_CodecLinePremul(benchmark::State& state) {
+  RunTransform(state, skity::codec_priv::CodecTransformLinePremul);
+}
+BENCHMARK(BM_CodecLinePremul);
+
+static void BM_CodecLineUnpremul(benchmark::State& state) {
+  RunTransform(state, skity::codec_priv::CodecTransformLineUnpremul);
+}
+BENCHMARK(BM_CodecLineUnpremul);
+
+static void BM_CodecLineSwizzleRB(benchmark::State& state) {
+  RunTransform(state, skity::codec_priv::CodecTransformLineSwizzelRB);
+}
+BENCHMARK(BM_CodecLineSwizzleRB);
+
+static void BM_CodecLineUnpremulSwizzleRB(benchmark::State& state) {
+  RunTransform(state, skity::codec_priv::CodecTransformLineUnpremulSwizzelRB);
+}
+BENCHMARK(BM_CodecLineUnpremulSwizzleRB);
+
+// Per pixel calls into the color helpers, the kernels before vectorization.
+static void BM_CodecLineUnpremulScalar(benchmark::State& state) {
+  RunTransform(state, [](uint8_t* dst, uint8_t* src, int width, int) {
+    auto dst32 = reinterpret_cast<uint32_t*>(dst);
+    auto src32 = reinterpret_cast<uint32_t*>(src);
+    for (int x = 0; x < width; x++) {
+      dst32[x] = skity::PMColorToColor(src32[x]);
+    }
+  });
+}
+BENCHMARK(BM_CodecLineUnpremulScalar);
@@ -0,0 +1,77 @@
+// Copyright 2021 The Lynx Authors. All rights reserved.
+// Licensed under the Apache License Version 2.0 that can be found in the
+// LICENSE file in the root directory of this source tree.
+
+#include <benchmark/benchmark.h>
+
+#include <cmath>
+#include <random>
+#include <skity/skity.hpp>
+#include <vector>
+
+// Random polygons of 5 to 12 vertices, `count` of them spread over a square
+// world. A small world gives one heavily overlapping blob, a large one many
+// small islands like a map tile.
+static std::vector<skity::Path> MakePolygonSoup(int32_t count,
+                                                float world_size) {
+  std::mt19937 rng(42);
+  std::uniform_real_distribution<float> center(0.f, world_size);
+  std::uniform_real_distribution<float> radius(5.f, 20.f);
+  std::uniform_real_distribution<float> jitter(0.6f, 1.f);
+  std::uniform_int_distribution<int32_t> vertices(5, 12);
+
+  std::vector<skity::Path> paths(count);
+  for (auto& path : paths) {
+    float cx = center(rng);
+    float cy = center(rng);
+    float r = radius(rng);
+    int32_t n = vertices(rng);
+    for (int32_t i = 0; i < n; i++) {
+      float angle = 2.f * 3.14159265f * i / n;
+      float x = cx + std::cos(angle) * r * jitter(rng);
+      float y = cy + std::sin(angle) * r * jitter(rng);
+      if (i == 0) {
+        path.MoveTo(x, y);
+      } else {
+        path.LineTo(x, y);
+      }
+    }
+    path.Close();
+  }
+
+  return paths;
+}
+
+static void BM_PathOpUnionFold(benchmark::State& state) {
+  auto paths = MakePolygonSoup(state.range(0), state.range(1));
+
+  for (auto _ : state) {
+    skity::Path result = paths[0];
+    for (size_t i = 1; i < paths.size(); i++) {
+      skity::PathOp::Execute(result, paths[i], skity::PathOp::Op::kUnion,
+                             &result);
+    }
+    benchmark::DoNotOptimize(result);
+  }
+}
+BENCHMARK(BM_PathOpUnionFold)
+    ->Args({500, 400})
+    ->Args({500, 4000})
+    ->Unit(benchmark::kMillisecond);
+
+static void BM_PathOpUnionBatch(benchmark::State& state) {
+  auto paths = MakePolygonSoup(state.range(0), state.range(1));
+
+  for (auto _ : state) {
+    skity::Path result;
+    skity::PathOp::Union(paths, &result);
+    benchmark::DoNotOptimize(result);
+  }
+}
+BENCHMARK(BM_PathOpUnionBatch)
+    ->Args({500, 400})
+    ->Args({500, 4000})
+    ->Args({5000, 1500})
+    ->Args({5000, 15000})
+    ->Unit(benchmark::kMillisecond)
+    ->UseRealTime();
@@ -0,0 +1,93 @@
+// Copyright 2021 The Lynx Authors. All rights reserved.
+// Licensed under the Apache License Version 2.0 that can be found in the
+// LICENSE file in the root directory of this source tree.
+
+#include <benchmark/benchmark.h>
+
+#include <random>
+#include <skity/geometry/stroke.hpp>
+#include <skity/skity.hpp>
+#include <vector>
+
+#include "src/geometry/stroke_cache.hpp"
+
+// Closed outlines made of short quads, roughly what a glyph outline looks
+// like after the font backend hands it over.
+static std::vector<skity::Path> MakeGlyphLikePaths(int32_t count) {
+  std::mt19937 rng(7);
+  std::uniform_real_distribution<float> jitter(-4.f, 4.f);
+
+  std::vector<skity::Path> paths(count);
+  for (auto& path : paths) {
+    path.MoveTo(0, 0);
+    for (int32_t i = 1; i <= 12; i++) {
+      float x = 10.f * (i % 4) + jitter(rng);
+      float y = 12.f * (i / 4) + jitter(rng);
+      path.QuadTo(x + jitter(rng), y + jitter(rng), x, y);
+    }
+    path.Close();
+  }
+
+  return paths;
+}
+
+// Open cubic strokes like the ones in a line icon set.
+static std::vector<skity::Path> MakeIconLikePaths(int32_t count) {
+  std::mt19937 rng(11);
+  std::uniform_real_distribution<float> coord(0.f, 24.f);
+
+  std::vector<skity::Path> paths(count);
+  for (auto& path : paths) {
+    path.MoveTo(coord(rng), coord(rng));
+    for (int32_t i = 0; i < 4; i++) {
+      path.CubicTo(coord(rng), coord(rng), coord(rng), coord(rng), coord(rng),
+                   coord(rng));
+    }
+  }
+
+  return paths;
+}
+
+static std::vector<skity::Path> MakePaths(int64_t kind) {
+  return kind == 0 ? MakeGlyphLikePaths(64) : MakeIconLikePaths(64);
+}
+
+static skity::Paint MakeStrokePaint() {
+  skity::Paint paint;
+  paint.SetStyle(skity::Paint::kStroke_Style);
+  paint.SetStrokeWidth(2.f);
+  paint.SetStrokeJoin(skity::Paint::kRound_Join);
+  paint.SetStrokeCap(skity::Paint::kRound_Cap);
+  return paint;
+}
+
+static void BM_StrokePath(benchmark::State& state) {
+  auto paths = MakePaths(state.range(0));
+  auto paint = MakeStrokePaint();
+
+  for (auto _ : state) {
+    for (const auto& path : paths) {
+      skity::Stroke stroke(paint);
+      skity::Path quad;
+      skity::Path outline;
+      stroke.QuadPath(path, &quad);
+      stroke.StrokePath(quad, &outline);
+      benchmark::DoNotOptimize(outline);
+    }
+  }
+}
+BENCHMARK(BM_StrokePath)->Arg(0)->Arg(1);
+
+static void BM_StrokePathCached(benchmark::State& state) {
+  auto paths = MakePaths(state.range(0));
+  auto paint = MakeStrokePaint();
+  skity::StrokeCache cache;
+
+  for (auto _ : state) {
+    for (const auto& path : paths) {
+      auto outline = cache.FindOrCreate(path, paint);
+      benchmark::DoNotOptimize(outline);
+    }
+  }
+}
+BENCHMARK(BM_StrokePathCached)->Arg(0)->Arg(1);
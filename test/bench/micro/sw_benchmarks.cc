@@ -131,6 +131,39 @@ static void BM_SWDrawBigImageLinear(benchmark::State& state) {
 }
 BENCHMARK(BM_SWDrawBigImageLinear)->Unit(benchmark::kMicrosecond);
 
+static void DrawBigImageDownscaled(benchmark::State& state,
+                                   skity::MipmapMode mipmap) {
+  skity::Bitmap bitmap1(2000, 1600, skity::AlphaType::kPremul_AlphaType);
+  auto canvas1 = skity::Canvas::MakeSoftwareCanvas(&bitmap1);
+
+  skity::Paint paint;
+  paint.SetColor(skity::Color_WHITE);
+  canvas1->DrawPaint(paint);
+  canvas1->Scale(2.f, 2.f);
+  skity::example::basic::draw_canvas(canvas1.get());
+
+  skity::Bitmap bitmap2(1000, 800, skity::AlphaType::kPremul_AlphaType);
+  auto canvas2 = skity::Canvas::MakeSoftwareCanvas(&bitmap2);
+  std::shared_ptr<skity::Image> image =
+      skity::Image::MakeImage(bitmap1.GetPixmap());
+
+  skity::SamplingOptions options{skity::FilterMode::kLinear, mipmap};
+
+  for (auto _ : state) {
+    canvas2->DrawImage(image, skity::Rect::MakeWH(250, 200), options);
+  }
+}
+
+static void BM_SWDrawBigImageDownscaled(benchmark::State& state) {
+  DrawBigImageDownscaled(state, skity::MipmapMode::kNone);
+}
+BENCHMARK(BM_SWDrawBigImageDownscaled)->Unit(benchmark::kMicrosecond);
+
+static void BM_SWDrawBigImageDownscaledMipmap(benchmark::State& state) {
+  DrawBigImageDownscaled(state, skity::MipmapMode::kLinear);
+}
+BENCHMARK(BM_SWDrawBigImageDownscaledMipmap)->Unit(benchmark::kMicrosecond);
+
 static void BM_SWDrawBigImageWithBlur(benchmark::State& state) {
   skity::Bitmap bitmap1(1000, 800, skity::AlphaType::kPremul_AlphaType);
   auto canvas1 = skity::Canvas::MakeSoftwareCanvas(&bitmap1);
@@ -66,3 +66,68 @@ TEST(SKP_Golden, Tiger) {
   EXPECT_TRUE(skity::testing::CompareGoldenTexture(dl.get(), 1000, 1000,
                                                    context.ToPathList()));
 }
+
+TEST(SKP_Golden, TigerFromFileMapping) {
+  auto stream = skity::ReadStream::CreateFromFileMapping(kTigerSKP);
+  ASSERT_NE(stream, nullptr) << "Failed to map SKP file: " << kTigerSKP;
+
+  auto picture = skity::Picture::MakeFromStream(*stream);
+  ASSERT_NE(picture, nullptr) << "Failed to parse SKP file: " << kTigerSKP;
+
+  // The op data now points into the mapping, which has to outlive the stream.
+  stream.reset();
+
+  skity::PictureRecorder recorder;
+  recorder.BeginRecording(skity::Rect::MakeWH(1000.f, 1000.f));
+  auto canvas = recorder.GetRecordingCanvas();
+  canvas->Translate(-130, 20);
+  picture->PlayBack(canvas);
+
+  PathListContext context("tiger.png");
+  auto dl = recorder.FinishRecording();
+  EXPECT_TRUE(skity::testing::CompareGoldenTexture(dl.get(), 1000, 1000,
+                                                   context.ToPathList()));
+}
+
+namespace {
+
+size_t SerializedSize(skity::Picture* source, int repeat,
+                      const std::filesystem::path& path) {
+  skity::PictureRecorder recorder;
+  recorder.BeginRecording(skity::Rect::MakeWH(1000.f, 1000.f));
+  auto canvas = recorder.GetRecordingCanvas();
+  for (int i = 0; i < repeat; i++) {
+    source->PlayBack(canvas);
+  }
+  auto dl = recorder.FinishRecording();
+
+  auto picture = skity::Picture::MakeFromDisplayList(dl.get());
+  {
+    auto stream = skity::WriteStream::CreateFileStream(path.string());
+    picture->Serialize(*stream, nullptr);
+  }
+  return std::filesystem::file_size(path);
+}
+
+}  // namespace
+
+TEST(SKP_Golden, SerializeDeduplicatesResources) {
+  auto stream = skity::ReadStream::CreateFromFile(kTigerSKP);
+  ASSERT_NE(stream, nullptr) << "Failed to open SKP file: " << kTigerSKP;
+
+  auto picture = skity::Picture::MakeFromStream(*stream);
+  ASSERT_NE(picture, nullptr) << "Failed to parse SKP file: " << kTigerSKP;
+
+  auto dir = std::filesystem::temp_directory_path();
+  auto once = SerializedSize(picture.get(), 1, dir / "skity_tiger_once.skp");
+  auto twice_path = dir / "skity_tiger_twice.skp";
+  auto twice = SerializedSize(picture.get(), 2, twice_path);
+
+  // Drawing the same content again only adds draw ops, paints and paths are
+  // shared with the first pass.
+  EXPECT_LT(twice, once + once / 2);
+
+  auto twice_stream = skity::ReadStream::CreateFromFile(twice_path.string());
+  ASSERT_NE(twice_stream, nullptr);
+  EXPECT_NE(skity::Picture::MakeFromStream(*twice_stream), nullptr);
+}
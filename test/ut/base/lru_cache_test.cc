@@ -0,0 +1,133 @@
+// Copyright 2021 The Lynx Authors. All rights reserved.
+// Licensed under the Apache License Version 2.0 that can be found in the
+// LICENSE file in the root directory of this source tree.
+
+#include "src/base/lru_cache.hpp"
+
+#include <gtest/gtest.h>
+
+#include <functional>
+#include <memory>
+
+namespace skity {
+namespace {
+
+using Cache = SizedLRUCache<int, std::shared_ptr<size_t>>;
+
+size_t ValueSize(const std::shared_ptr<size_t>& value) { return *value; }
+
+std::shared_ptr<size_t> MakeValue(size_t size) {
+  return std::make_shared<size_t>(size);
+}
+
+TEST(SizedLRUCacheTest, EvictsLeastRecentlyUsed) {
+  Cache cache(10, ValueSize);
+  cache.Insert(1, MakeValue(4));
+  cache.Insert(2, MakeValue(4));
+  EXPECT_EQ(cache.GetTotalSize(), 8u);
+
+  // Touching 1 makes 2 the oldest entry.
+  EXPECT_TRUE(cache.Find(1));
+  cache.Insert(3, MakeValue(4));
+
+  EXPECT_TRUE(cache.Find(1));
+  EXPECT_FALSE(cache.Find(2));
+  EXPECT_TRUE(cache.Find(3));
+  EXPECT_EQ(cache.GetTotalSize(), 8u);
+  EXPECT_EQ(cache.GetEntryCount(), 2u);
+}
+
+TEST(SizedLRUCacheTest, KeepsMostRecentOverBudget) {
+  Cache cache(10, ValueSize);
+  cache.Insert(1, MakeValue(4));
+  cache.Insert(2, MakeValue(32));
+
+  EXPECT_FALSE(cache.Find(1));
+  EXPECT_TRUE(cache.Find(2));
+  EXPECT_EQ(cache.GetTotalSize(), 32u);
+
+  cache.SetMaxSize(0);
+  EXPECT_EQ(cache.GetEntryCount(), 1u);
+}
+
+TEST(SizedLRUCacheTest, FindOrCreate) {
+  Cache cache(10, ValueSize);
+  int created = 0;
+  auto create = [&]() {
+    created++;
+    return MakeValue(1);
+  };
+
+  bool hit = true;
+  auto first = cache.FindOrCreate(1, create, &hit);
+  EXPECT_FALSE(hit);
+  auto second = cache.FindOrCreate(1, create, &hit);
+  EXPECT_TRUE(hit);
+  EXPECT_EQ(first, second);
+  EXPECT_EQ(created, 1);
+
+  // Empty values are handed back but never cached.
+  auto empty = cache.FindOrCreate(2, [] { return std::shared_ptr<size_t>(); });
+  EXPECT_FALSE(empty);
+  EXPECT_EQ(cache.GetEntryCount(), 1u);
+}
+
+TEST(SizedLRUCacheTest, InsertKeepsExistingValue) {
+  Cache cache(10, ValueSize);
+  auto first = cache.Insert(1, MakeValue(1));
+  auto second = cache.Insert(1, MakeValue(2));
+
+  EXPECT_EQ(first, second);
+  EXPECT_EQ(cache.GetTotalSize(), 1u);
+}
+
+TEST(SizedLRUCacheTest, RemoveAndClear) {
+  Cache cache(10, ValueSize);
+  cache.Insert(1, MakeValue(2));
+  cache.Insert(2, MakeValue(3));
+
+  cache.Remove(1);
+  cache.Remove(5);
+  EXPECT_FALSE(cache.Find(1));
+  EXPECT_EQ(cache.GetTotalSize(), 3u);
+
+  cache.Clear();
+  EXPECT_EQ(cache.GetEntryCount(), 0u);
+  EXPECT_EQ(cache.GetTotalSize(), 0u);
+}
+
+// A value whose destructor calls back into the cache, like a resource that
+// unregisters itself.
+struct Reentrant {
+  std::function<void()> on_destroy;
+  ~Reentrant() { on_destroy(); }
+};
+
+TEST(SizedLRUCacheTest, ReleasesValuesOutsideTheLock) {
+  SizedLRUCache<int, std::shared_ptr<Reentrant>> cache(
+      1, [](const std::shared_ptr<Reentrant>&) { return size_t{1}; });
+
+  int destroyed = 0;
+  auto make = [&]() {
+    auto value = std::make_shared<Reentrant>();
+    value->on_destroy = [&]() {
+      cache.GetEntryCount();
+      destroyed++;
+    };
+    return value;
+  };
+
+  cache.Insert(1, make());
+  cache.Insert(2, make());
+  EXPECT_EQ(destroyed, 1);
+
+  cache.Remove(2);
+  EXPECT_EQ(destroyed, 2);
+
+  cache.Insert(3, make());
+  cache.Clear();
+  EXPECT_EQ(destroyed, 3);
+}
+
+}  // namespace
+}  // namespace skity
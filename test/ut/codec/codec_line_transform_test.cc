@@ -0,0 +1,114 @@
+// Copyright 2021 The Lynx Authors. All rights reserved.
+// Licensed under the Apache License Version 2.0 that can be found in the
+// LICENSE file in the root directory of this source tree.
+
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <cstring>
+#include <random>
+#include <skity/graphic/color.hpp>
+#include <vector>
+
+#include "module/codec/src/codec/codec_priv.hpp"
+
+using skity::codec_priv::TransformLineFunc;
+
+namespace {
+
+uint32_t SwizzleRB(uint32_t c) {
+  return (c & 0xFF00FF00) | ((c & 0xFF) << 16) | ((c >> 16) & 0xFF);
+}
+
+// Runs the transform on every width up to a few vector blocks, from an
+// unaligned source, out of place and in place, and checks each pixel against
+// the scalar reference.
+template <typename Reference>
+void ExpectTransform(TransformLineFunc transform, Reference reference) {
+  std::mt19937 rng(7);
+  std::uniform_int_distribution<uint32_t> dist;
+
+  for (int width = 0; width <= 37; width++) {
+    std::vector<uint32_t> pixels(width);
+    for (auto& pixel : pixels) {
+      pixel = dist(rng);
+      // Plenty of opaque and transparent pixels for the fast paths.
+      switch (pixel % 4) {
+        case 0:
+          pixel |= 0xFF000000;
+          break;
+        case 1:
+          pixel &= 0x00FFFFFF;
+          break;
+      }
+    }
+    if (width == 16) {
+      std::fill(pixels.begin(), pixels.end(), 0xFF336699);
+    }
+
+    std::vector<uint8_t> src(width * 4 + 1);
+    std::memcpy(src.data() + 1, pixels.data(), width * 4);
+    std::vector<uint8_t> dst(width * 4 + 1);
+    transform(dst.data() + 1, src.data() + 1, width, 4);
+
+    std::vector<uint8_t> in_place = src;
+    transform(in_place.data() + 1, in_place.data() + 1, width, 4);
+
+    for (int x = 0; x < width; x++) {
+      uint32_t out;
+      std::memcpy(&out, dst.data() + 1 + x * 4, 4);
+      ASSERT_EQ(out, reference(pixels[x]))
+          << "width " << width << " pixel " << x << " " << std::hex
+          << pixels[x];
+
+      std::memcpy(&out, in_place.data() + 1 + x * 4, 4);
+      ASSERT_EQ(out, reference(pixels[x]));
+    }
+  }
+}
+
+}  // namespace
+
+TEST(CodecLineTransform, Premul) {
+  ExpectTransform(skity::codec_priv::CodecTransformLinePremul,
+                  [](uint32_t c) { return skity::ColorToPMColor(c); });
+}
+
+TEST(CodecLineTransform, Unpremul) {
+  ExpectTransform(skity::codec_priv::CodecTransformLineUnpremul,
+                  [](uint32_t c) { return skity::PMColorToColor(c); });
+}
+
+TEST(CodecLineTransform, SwizzleRB) {
+  ExpectTransform(skity::codec_priv::CodecTransformLineSwizzelRB, SwizzleRB);
+}
+
+TEST(CodecLineTransform, ChooseLineTransformFunc) {
+  using skity::AlphaType;
+  using skity::ColorType;
+  using skity::codec_priv::ChooseLineTransformFunc;
+
+  ExpectTransform(
+      ChooseLineTransformFunc(ColorType::kRGBA, AlphaType::kUnpremul_AlphaType),
+      [](uint32_t c) { return c; });
+  ExpectTransform(
+      ChooseLineTransformFunc(ColorType::kRGBA, AlphaType::kPremul_AlphaType),
+      [](uint32_t c) { return skity::PMColorToColor(c); });
+  ExpectTransform(
+      ChooseLineTransformFunc(ColorType::kBGRA, AlphaType::kUnpremul_AlphaType),
+      SwizzleRB);
+  ExpectTransform(
+      ChooseLineTransformFunc(ColorType::kBGRA, AlphaType::kPremul_AlphaType),
+      [](uint32_t c) { return SwizzleRB(skity::PMColorToColor(c)); });
+}
+
+TEST(CodecLineTransform, IgnoresOtherPixelSizes) {
+  uint8_t src[6] = {1, 2, 3, 4, 5, 6};
+  uint8_t dst[6] = {};
+  skity::codec_priv::CodecTransformLinePremul(dst, src, 2, 3);
+  skity::codec_priv::CodecTransformLineUnpremul(dst, src, 2, 3);
+  skity::codec_priv::CodecTransformLineSwizzelRB(dst, src, 2, 3);
+  for (uint8_t value : dst) {
+    EXPECT_EQ(value, 0);
+  }
+}
@@ -7,13 +7,16 @@
 #include <algorithm>
 #include <cstdint>
 #include <cstdlib>
+#include <cstring>
 #include <memory>
 #include <skity/codec/codec.hpp>
 #include <skity/graphic/color.hpp>
 #include <skity/io/data.hpp>
 #include <skity/io/pixmap.hpp>
+#include <vector>
 
 #include "module/codec/src/codec/codec_priv.hpp"
+#include "module/codec/src/codec/png_codec.hpp"
 
 namespace {
 
@@ -64,6 +67,26 @@ std::shared_ptr<skity::Pixmap> MakeStripedPixmap(uint32_t width,
   return pixmap;
 }
 
+// Fills a pixmap with a semi-transparent pattern which differs in every pixel.
+std::shared_ptr<skity::Pixmap> MakePatternPixmap(uint32_t width,
+                                                 uint32_t height) {
+  auto pixmap = std::make_shared<skity::Pixmap>(
+      width, height, skity::AlphaType::kUnpremul_AlphaType,
+      skity::ColorType::kRGBA);
+
+  for (uint32_t y = 0; y < height; y++) {
+    uint8_t* row = pixmap->WritableAddr8(0, y);
+    for (uint32_t x = 0; x < width; x++) {
+      row[x * 4 + 0] = static_cast<uint8_t>(x * 7 + y);
+      row[x * 4 + 1] = static_cast<uint8_t>(y * 5 + x / 3);
+      row[x * 4 + 2] = static_cast<uint8_t>((x ^ y) * 3);
+      row[x * 4 + 3] = static_cast<uint8_t>(128 + (x + y) % 128);
+    }
+  }
+
+  return pixmap;
+}
+
 void ExpectPixelNear(const skity::Pixmap& pixmap, uint32_t x, uint32_t y,
                      uint8_t r, uint8_t g, uint8_t b, uint8_t a,
                      int tolerance) {
@@ -685,3 +708,295 @@ TEST(CodecScaleTest, WebPDecodeScaledSingleFrameAnimation) {
   const uint8_t* center = pixmap->Addr8(52, 62);
   EXPECT_NE(center[3], 0);
 }
+
+namespace {
+
+// Decodes the whole image and the subset, and expects the subset to match the
+// same region of the whole image.
+void ExpectSubsetDecode(const std::shared_ptr<skity::Data>& data,
+                        const skity::CodecRect& subset) {
+  auto codec = skity::Codec::MakeFromData(data);
+  ASSERT_TRUE(codec != nullptr);
+  codec->SetData(data);
+
+  auto full = codec->Decode();
+  ASSERT_TRUE(full != nullptr);
+
+  DecodeOptions options{};
+  options.subset = subset;
+  auto pixmap = codec->Decode(options);
+
+  ASSERT_TRUE(pixmap != nullptr);
+  ASSERT_EQ(pixmap->Width(), static_cast<uint32_t>(subset.Width()));
+  ASSERT_EQ(pixmap->Height(), static_cast<uint32_t>(subset.Height()));
+  EXPECT_EQ(pixmap->GetAlphaType(), full->GetAlphaType());
+  for (int32_t y = 0; y < subset.Height(); y++) {
+    EXPECT_EQ(std::memcmp(pixmap->Addr8(0, y),
+                          full->Addr8(subset.X(), subset.Y() + y),
+                          pixmap->Width() * 4),
+              0)
+        << "row " << y;
+  }
+}
+
+}  // namespace
+
+TEST(CodecScaleTest, ResolveSubset) {
+  skity::CodecRect subset;
+
+  DecodeOptions whole{};
+  EXPECT_TRUE(skity::codec_priv::ResolveSubset(100, 50, whole, &subset));
+  EXPECT_EQ(subset, skity::CodecRect(0, 0, 100, 50));
+
+  DecodeOptions clipped{};
+  clipped.subset = skity::CodecRect(-10, 20, 40, 80);
+  EXPECT_TRUE(skity::codec_priv::ResolveSubset(100, 50, clipped, &subset));
+  EXPECT_EQ(subset, skity::CodecRect(0, 20, 40, 50));
+
+  DecodeOptions outside{};
+  outside.subset = skity::CodecRect(100, 0, 120, 10);
+  EXPECT_FALSE(skity::codec_priv::ResolveSubset(100, 50, outside, &subset));
+}
+
+TEST(CodecScaleTest, DecodeSubset) {
+  // Every codec returns exactly the pixels of the full decode, including the
+  // JPEG iMCU aligned cropping and the PNG row reader.
+  ExpectSubsetDecode(skity::Data::MakeFromFileName(SKITY_TEST_JPEG_FILE),
+                     skity::CodecRect(33, 17, 101, 90));
+  ExpectSubsetDecode(skity::Data::MakeFromFileName(SKITY_TEST_PNG_FILE),
+                     skity::CodecRect(10, 7, 40, 30));
+  ExpectSubsetDecode(skity::Data::MakeFromFileName(SKITY_TEST_SF_GIF_FILE),
+                     skity::CodecRect(5, 5, 30, 20));
+  ExpectSubsetDecode(skity::Data::MakeFromFileName(SKITY_TEST_SF_WEBP_FILE),
+                     skity::CodecRect(17, 9, 100, 64));
+}
+
+TEST(CodecScaleTest, DecodeSubsetScaled) {
+  auto jpeg_data = skity::Data::MakeFromFileName(SKITY_TEST_JPEG_FILE);
+  auto codec = skity::Codec::MakeFromData(jpeg_data);
+  ASSERT_TRUE(codec != nullptr);
+  codec->SetData(jpeg_data);
+
+  // The target size applies to the 80x60 subset, not to the 133x100 image.
+  DecodeOptions options{};
+  options.subset = skity::CodecRect(20, 20, 100, 80);
+  options.target_width = 40;
+  auto pixmap = codec->Decode(options);
+  ASSERT_TRUE(pixmap != nullptr);
+  EXPECT_EQ(pixmap->Width(), 40u);
+  EXPECT_EQ(pixmap->Height(), 30u);
+
+  // Off the n/8 grid, the remainder is resampled.
+  options.target_width = 30;
+  pixmap = codec->Decode(options);
+  ASSERT_TRUE(pixmap != nullptr);
+  EXPECT_EQ(pixmap->Width(), 30u);
+  EXPECT_EQ(pixmap->Height(), 23u);
+
+  options.subset = skity::CodecRect(200, 0, 300, 10);
+  EXPECT_TRUE(codec->Decode(options) == nullptr);
+}
+
+TEST(CodecScaleTest, RowResampler) {
+  auto src = MakePatternPixmap(300, 200);
+  auto expected = ResamplePixmap(src, 70, 40);
+  ASSERT_TRUE(expected != nullptr);
+
+  skity::codec_priv::RowResampler resampler(300, 200, 70, 40);
+  ASSERT_TRUE(resampler.IsValid());
+  for (int32_t y = 0; y < 200; y++) {
+    EXPECT_TRUE(resampler.Finish() == nullptr);
+    resampler.PushRow(src->Addr8(0, y));
+  }
+
+  auto pixmap = resampler.Finish();
+  ASSERT_TRUE(pixmap != nullptr);
+  for (int32_t y = 0; y < 40; y++) {
+    EXPECT_EQ(std::memcmp(pixmap->Addr8(0, y), expected->Addr8(0, y), 70 * 4),
+              0)
+        << "row " << y;
+  }
+}
+
+TEST(CodecScaleTest, PNGDecodeScaledStreaming) {
+  constexpr uint32_t kWidth = 1024;
+  constexpr uint32_t kHeight = 768;
+  auto src = MakePatternPixmap(kWidth, kHeight);
+
+  auto png_data = skity::Codec::MakePngCodec()->Encode(src.get());
+  ASSERT_TRUE(png_data != nullptr);
+
+  skity::PNGCodec codec;
+  codec.SetData(png_data);
+  auto full = codec.Decode(DecodeOptions{});
+  ASSERT_TRUE(full != nullptr);
+  auto expected = ResamplePixmap(full, 64, 48);
+  ASSERT_TRUE(expected != nullptr);
+
+  DecodeOptions options{};
+  options.target_width = 64;
+  auto pixmap = codec.Decode(options);
+  ASSERT_TRUE(pixmap != nullptr);
+  ASSERT_EQ(pixmap->Width(), 64u);
+  ASSERT_EQ(pixmap->Height(), 48u);
+  for (int32_t y = 0; y < 48; y++) {
+    EXPECT_EQ(std::memcmp(pixmap->Addr8(0, y), expected->Addr8(0, y), 64 * 4),
+              0)
+        << "row " << y;
+  }
+
+  // A few source rows, the inflate state and the output sized accumulators,
+  // instead of the 3 MB intrinsic image.
+  const size_t row_bytes = kWidth * 4;
+  EXPECT_GT(codec.GetLastDecodeWorkingBytes(), 0u);
+  EXPECT_LT(codec.GetLastDecodeWorkingBytes(), 8 * row_bytes + 64 * 1024);
+}
+
+namespace {
+
+void ExpectSamePixels(const std::shared_ptr<skity::Pixmap>& actual,
+                      const std::shared_ptr<skity::Pixmap>& expected) {
+  ASSERT_TRUE(actual != nullptr);
+  ASSERT_TRUE(expected != nullptr);
+  ASSERT_EQ(actual->Width(), expected->Width());
+  ASSERT_EQ(actual->Height(), expected->Height());
+  for (uint32_t y = 0; y < expected->Height(); y++) {
+    EXPECT_EQ(std::memcmp(actual->Addr8(0, y), expected->Addr8(0, y),
+                          expected->Width() * 4),
+              0)
+        << "row " << y;
+  }
+}
+
+std::shared_ptr<skity::MultiFrameDecoder> MakeMultiFrameDecoder(
+    const char* file) {
+  auto data = skity::Data::MakeFromFileName(file);
+  if (data == nullptr) {
+    return nullptr;
+  }
+
+  auto codec = skity::Codec::MakeFromData(data);
+  if (codec == nullptr) {
+    return nullptr;
+  }
+  codec->SetData(data);
+  return codec->DecodeMultiFrame();
+}
+
+}  // namespace
+
+TEST(CodecScaleTest, MultiFrameDecodeScaled) {
+  // alphabetAnim.gif is a 13-frame 100x100 animation whose frames depend on
+  // the previous ones. The scaled frames must match the full composited
+  // frames resampled afterwards.
+  auto full_decoder = MakeMultiFrameDecoder(SKITY_TEST_MF_GIF_FILE);
+  auto decoder = MakeMultiFrameDecoder(SKITY_TEST_MF_GIF_FILE);
+  ASSERT_TRUE(full_decoder != nullptr);
+  ASSERT_TRUE(decoder != nullptr);
+  ASSERT_EQ(decoder->GetFrameCount(), 13);
+
+  DecodeOptions options{};
+  options.target_width = 40;
+
+  std::shared_ptr<skity::Pixmap> output;
+  std::shared_ptr<skity::Pixmap> full;
+  for (int32_t i = 0; i < decoder->GetFrameCount(); i++) {
+    full = full_decoder->DecodeFrame(full_decoder->GetFrameInfo(i),
+                                     DecodeOptions{}, full);
+    ASSERT_TRUE(full != nullptr);
+    ASSERT_EQ(full->Width(), 100u);
+
+    // The output of the previous frame is written again.
+    auto* prev_output = output.get();
+    output = decoder->DecodeFrame(decoder->GetFrameInfo(i), options, output);
+    ASSERT_TRUE(output != nullptr);
+    EXPECT_EQ(output->Width(), 40u);
+    EXPECT_EQ(output->Height(), 40u);
+    if (prev_output != nullptr) {
+      EXPECT_EQ(output.get(), prev_output);
+    }
+
+    ExpectSamePixels(output, ResamplePixmap(full, 40, 40));
+  }
+
+  // Same white background as DecodeFrame() over the previous frames.
+  full = full_decoder->DecodeFrame(full_decoder->GetFrameInfo(10),
+                                   DecodeOptions{}, nullptr);
+  ASSERT_TRUE(full != nullptr);
+  EXPECT_EQ(*reinterpret_cast<const uint32_t*>(full->Addr()),
+            skity::Color_WHITE);
+
+  // Seeking back replays the required frames.
+  auto fresh_decoder = MakeMultiFrameDecoder(SKITY_TEST_MF_GIF_FILE);
+  ASSERT_TRUE(fresh_decoder != nullptr);
+  ExpectSamePixels(
+      decoder->DecodeFrame(decoder->GetFrameInfo(3), options, nullptr),
+      fresh_decoder->DecodeFrame(fresh_decoder->GetFrameInfo(3), options,
+                                 nullptr));
+
+  // Subsets are cut from the composited frame.
+  DecodeOptions subset{};
+  subset.subset = skity::CodecRect{10, 20, 60, 50};
+  auto cropped =
+      decoder->DecodeFrame(decoder->GetFrameInfo(10), subset, nullptr);
+  ASSERT_TRUE(cropped != nullptr);
+  EXPECT_EQ(cropped->Width(), 50u);
+  EXPECT_EQ(cropped->Height(), 30u);
+  for (uint32_t y = 0; y < 30; y++) {
+    EXPECT_EQ(
+        std::memcmp(cropped->Addr8(0, y), full->Addr8(10, 20 + y), 50 * 4), 0);
+  }
+}
+
+TEST(CodecScaleTest, MultiFrameCache) {
+  auto decoder = MakeMultiFrameDecoder(SKITY_TEST_MF_GIF_FILE);
+  ASSERT_TRUE(decoder != nullptr);
+  const int32_t count = decoder->GetFrameCount();
+  const size_t frame_bytes = 40 * 40 * 4;
+
+  DecodeOptions options{};
+  options.target_width = 40;
+
+  skity::MultiFrameCacheOptions cache_options;
+  cache_options.max_bytes = count * frame_bytes;
+  std::vector<std::shared_ptr<skity::Pixmap>> frames;
+  {
+    skity::MultiFrameCache cache(decoder, options, cache_options);
+    for (int32_t i = 0; i < count; i++) {
+      frames.push_back(cache.GetFrame(i));
+      ASSERT_TRUE(frames.back() != nullptr);
+    }
+    EXPECT_EQ(cache.GetHitCount(), 0u);
+    EXPECT_EQ(cache.GetCachedBytes(), count * frame_bytes);
+
+    // The second loop is served from memory.
+    for (int32_t i = 0; i < count; i++) {
+      EXPECT_EQ(cache.GetFrame(i).get(), frames[i].get());
+    }
+    EXPECT_EQ(cache.GetHitCount(), static_cast<uint64_t>(count));
+    EXPECT_TRUE(cache.GetFrame(count) == nullptr);
+  }
+
+  // Over budget, the least recently used frames are dropped.
+  cache_options.max_bytes = 2 * frame_bytes;
+  {
+    skity::MultiFrameCache cache(MakeMultiFrameDecoder(SKITY_TEST_MF_GIF_FILE),
+                                 options, cache_options);
+    for (int32_t i = 0; i < count; i++) {
+      ExpectSamePixels(cache.GetFrame(i), frames[i]);
+    }
+    EXPECT_EQ(cache.GetCachedBytes(), 2 * frame_bytes);
+    EXPECT_EQ(cache.GetHitCount(), 0u);
+  }
+
+  // Frames decoded ahead on the worker are the same as decoded in order.
+  cache_options.look_ahead = true;
+  {
+    skity::MultiFrameCache cache(MakeMultiFrameDecoder(SKITY_TEST_MF_GIF_FILE),
+                                 options, cache_options);
+    for (int32_t i = 0; i < count; i++) {
+      ExpectSamePixels(cache.GetFrame(i), frames[i]);
+    }
+    EXPECT_LE(cache.GetCachedBytes(), 2 * frame_bytes);
+  }
+}
@@ -4,6 +4,8 @@
 
 #include <gtest/gtest.h>
 
+#include <algorithm>
+#include <cstring>
 #include <skity/codec/codec.hpp>
 #include <skity/graphic/bitmap.hpp>
 #include <skity/graphic/color.hpp>
@@ -126,3 +128,34 @@ TEST(JPEGCodecTest, EncodeBGRA) {
 
   EXPECT_EQ(*decode_addr, skity::ColorSetARGB(255, 0, 0, 128));
 }
+
+TEST(JPEGCodecTest, IncrementalDecode) {
+  auto jpeg_data = skity::Data::MakeFromFileName(SKITY_TEST_JPEG_FILE);
+  auto codec = skity::Codec::MakeJPEGCodec();
+  codec->SetData(jpeg_data);
+  auto expected = codec->Decode();
+  ASSERT_TRUE(expected != nullptr);
+
+  auto decoder = codec->MakeIncrementalDecoder();
+  ASSERT_TRUE(decoder != nullptr);
+
+  auto result = skity::IncrementalDecoder::Result::kNeedMoreData;
+  for (size_t offset = 0; offset < jpeg_data->Size(); offset += 101) {
+    result = decoder->Append(jpeg_data->Bytes() + offset,
+                             std::min<size_t>(101, jpeg_data->Size() - offset));
+    ASSERT_NE(result, skity::IncrementalDecoder::Result::kError);
+  }
+  EXPECT_EQ(result, skity::IncrementalDecoder::Result::kComplete);
+  EXPECT_EQ(decoder->Finish(), skity::IncrementalDecoder::Result::kComplete);
+
+  auto pixmap = decoder->GetPixmap();
+  ASSERT_TRUE(pixmap != nullptr);
+  EXPECT_EQ(decoder->GetDecodedRows(), 100);
+  EXPECT_EQ(pixmap->Width(), expected->Width());
+  EXPECT_EQ(pixmap->Height(), expected->Height());
+  for (uint32_t y = 0; y < pixmap->Height(); y++) {
+    EXPECT_EQ(std::memcmp(pixmap->Addr8(0, y), expected->Addr8(0, y),
+                          pixmap->Width() * 4),
+              0);
+  }
+}
@@ -4,6 +4,8 @@
 
 #include <gtest/gtest.h>
 
+#include <algorithm>
+#include <cstring>
 #include <skity/codec/codec.hpp>
 #include <skity/graphic/bitmap.hpp>
 #include <skity/io/data.hpp>
@@ -184,3 +186,135 @@ TEST(PNGCodecTest, EncodeBGRA) {
   auto decode_color = reinterpret_cast<const uint32_t*>(decode_pixmap->Addr());
   EXPECT_EQ(*decode_color, skity::ColorSetARGB(128, 0, 0, 255));
 }
+
+TEST(PNGCodecTest, EncodeWithOptions) {
+  skity::Pixmap pixmap(97, 131, skity::AlphaType::kUnpremul_AlphaType);
+
+  auto pixels = reinterpret_cast<uint8_t*>(pixmap.WritableAddr());
+  for (uint32_t y = 0; y < pixmap.Height(); y++) {
+    for (uint32_t x = 0; x < pixmap.Width(); x++) {
+      auto pixel = pixels + pixmap.RowBytes() * y + x * 4;
+      pixel[0] = static_cast<uint8_t>(x * 3);
+      pixel[1] = static_cast<uint8_t>(y * 5);
+      pixel[2] = static_cast<uint8_t>(x * y);
+      pixel[3] = (x + y) % 7 == 0 ? 128 : 255;
+    }
+  }
+
+  const skity::EncodeFilter filters[] = {
+      skity::EncodeFilter::kDefault, skity::EncodeFilter::kNone,
+      skity::EncodeFilter::kSub,     skity::EncodeFilter::kUp,
+      skity::EncodeFilter::kAverage, skity::EncodeFilter::kPaeth,
+      skity::EncodeFilter::kAdaptive};
+
+  auto codec = skity::Codec::MakePngCodec();
+
+  for (int32_t thread_count : {1, 4}) {
+    for (auto filter : filters) {
+      skity::EncodeOptions options;
+      options.compression_level = 9;
+      options.filter = filter;
+      options.thread_count = thread_count;
+
+      auto data = codec->Encode(&pixmap, options);
+      ASSERT_TRUE(data != nullptr);
+
+      codec->SetData(data);
+      auto decode_pixmap = codec->Decode();
+
+      ASSERT_TRUE(decode_pixmap != nullptr);
+      ASSERT_EQ(decode_pixmap->Width(), pixmap.Width());
+      ASSERT_EQ(decode_pixmap->Height(), pixmap.Height());
+      EXPECT_EQ(std::memcmp(decode_pixmap->Addr(), pixmap.Addr(),
+                            pixmap.RowBytes() * pixmap.Height()),
+                0)
+          << "thread_count " << thread_count << " filter "
+          << static_cast<int>(filter);
+    }
+  }
+}
+
+// Noise does not compress, so every band writes more than the bytes it read
+// and the deflate output has to be drained completely at the end.
+TEST(PNGCodecTest, EncodeIncompressible) {
+  skity::Pixmap pixmap(256, 193, skity::AlphaType::kUnpremul_AlphaType);
+
+  auto pixels = reinterpret_cast<uint8_t*>(pixmap.WritableAddr());
+  uint32_t state = 0x12345678;
+  for (size_t i = 0; i < pixmap.RowBytes() * pixmap.Height(); i++) {
+    state = state * 1664525u + 1013904223u;
+    pixels[i] = static_cast<uint8_t>(state >> 24);
+  }
+
+  auto codec = skity::Codec::MakePngCodec();
+
+  for (int32_t level : {0, 1, 9}) {
+    for (int32_t thread_count : {1, 3}) {
+      skity::EncodeOptions options;
+      options.compression_level = level;
+      options.filter = skity::EncodeFilter::kNone;
+      options.thread_count = thread_count;
+
+      auto data = codec->Encode(&pixmap, options);
+      ASSERT_TRUE(data != nullptr);
+
+      codec->SetData(data);
+      auto decode_pixmap = codec->Decode();
+
+      ASSERT_TRUE(decode_pixmap != nullptr);
+      EXPECT_EQ(std::memcmp(decode_pixmap->Addr(), pixmap.Addr(),
+                            pixmap.RowBytes() * pixmap.Height()),
+                0)
+          << "level " << level << " thread_count " << thread_count;
+    }
+  }
+}
+
+TEST(PNGCodecTest, IncrementalDecode) {
+  auto data = skity::Data::MakeFromFileName(SKITY_TEST_PNG_FILE);
+  auto codec = skity::Codec::MakeFromData(data);
+  ASSERT_TRUE(codec != nullptr);
+  codec->SetData(data);
+  auto expected = codec->Decode();
+  ASSERT_TRUE(expected != nullptr);
+
+  auto decoder = codec->MakeIncrementalDecoder();
+  ASSERT_TRUE(decoder != nullptr);
+
+  auto result = skity::IncrementalDecoder::Result::kNeedMoreData;
+  int32_t decoded_rows = 0;
+  for (size_t offset = 0; offset < data->Size(); offset += 97) {
+    result = decoder->Append(data->Bytes() + offset,
+                             std::min<size_t>(97, data->Size() - offset));
+    ASSERT_NE(result, skity::IncrementalDecoder::Result::kError);
+    EXPECT_GE(decoder->GetDecodedRows(), decoded_rows);
+    decoded_rows = decoder->GetDecodedRows();
+  }
+  EXPECT_EQ(result, skity::IncrementalDecoder::Result::kComplete);
+  EXPECT_EQ(decoder->Finish(), skity::IncrementalDecoder::Result::kComplete);
+
+  auto pixmap = decoder->GetPixmap();
+  ASSERT_TRUE(pixmap != nullptr);
+  EXPECT_EQ(decoder->GetDecodedRows(), static_cast<int32_t>(pixmap->Height()));
+  EXPECT_GE(decoder->GetCompletedPasses(), 1);
+  EXPECT_EQ(pixmap->Width(), expected->Width());
+  EXPECT_EQ(pixmap->Height(), expected->Height());
+  EXPECT_EQ(pixmap->GetAlphaType(), expected->GetAlphaType());
+  for (uint32_t y = 0; y < pixmap->Height(); y++) {
+    EXPECT_EQ(std::memcmp(pixmap->Addr8(0, y), expected->Addr8(0, y),
+                          pixmap->Width() * 4),
+              0);
+  }
+}
+
+TEST(PNGCodecTest, IncrementalDecodeTruncated) {
+  auto data = skity::Data::MakeFromFileName(SKITY_TEST_PNG_FILE);
+  auto decoder = skity::Codec::MakePngCodec()->MakeIncrementalDecoder();
+
+  EXPECT_EQ(decoder->Append(data->Bytes(), data->Size() / 2),
+            skity::IncrementalDecoder::Result::kNeedMoreData);
+  EXPECT_TRUE(decoder->GetPixmap() != nullptr);
+  EXPECT_LT(decoder->GetDecodedRows(),
+            static_cast<int32_t>(decoder->GetPixmap()->Height()));
+  EXPECT_EQ(decoder->Finish(), skity::IncrementalDecoder::Result::kError);
+}
@@ -4,11 +4,13 @@
 
 #include <gtest/gtest.h>
 
+#include <cstring>
 #include <skity/codec/codec.hpp>
 #include <skity/graphic/bitmap.hpp>
 #include <skity/graphic/color.hpp>
 #include <skity/io/data.hpp>
 #include <skity/io/pixmap.hpp>
+#include <vector>
 
 TEST(WebPCodecTest, Create) {
   auto data = skity::Data::MakeFromFileName(SKITY_TEST_WEBP_FILE);
@@ -108,3 +110,39 @@ TEST(WebPCodecTest, DecodeAllFrames) {
     EXPECT_EQ(pixmap->GetAlphaType(), skity::AlphaType::kUnpremul_AlphaType);
   }
 }
+
+TEST(WebPCodecTest, DecodeFramesOutOfOrder) {
+  auto data = skity::Data::MakeFromFileName(SKITY_TEST_WEBP_FILE);
+
+  // Reference frames, decoded in order by a codec of their own so they do
+  // not share any animator state with the decoder under test.
+  auto reference_codec = skity::Codec::MakeFromData(data);
+  ASSERT_TRUE(reference_codec != nullptr);
+  reference_codec->SetData(data);
+  auto reference = reference_codec->DecodeMultiFrame();
+  ASSERT_TRUE(reference != nullptr);
+  ASSERT_EQ(reference->GetFrameCount(), 7);
+
+  std::vector<std::shared_ptr<skity::Pixmap>> expected;
+  for (int32_t i = 0; i < reference->GetFrameCount(); ++i) {
+    auto pixmap = reference->DecodeFrame(reference->GetFrameInfo(i), nullptr);
+    ASSERT_TRUE(pixmap != nullptr);
+    expected.emplace_back(std::move(pixmap));
+  }
+
+  auto codec = skity::Codec::MakeFromData(data);
+  ASSERT_TRUE(codec != nullptr);
+  codec->SetData(data);
+
+  // One decoder plays forward, repeats a frame, rewinds and skips ahead.
+  auto decoder = codec->DecodeMultiFrame();
+  ASSERT_TRUE(decoder != nullptr);
+  for (int32_t i : {0, 1, 2, 2, 6, 3, 0, 5, 4}) {
+    auto pixmap = decoder->DecodeFrame(decoder->GetFrameInfo(i), nullptr);
+    ASSERT_TRUE(pixmap != nullptr);
+    EXPECT_EQ(std::memcmp(pixmap->Addr(), expected[i]->Addr(),
+                          pixmap->RowBytes() * pixmap->Height()),
+              0)
+        << "frame " << i;
+  }
+}
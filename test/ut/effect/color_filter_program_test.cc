@@ -0,0 +1,103 @@
+// Copyright 2021 The Lynx Authors. All rights reserved.
+// Licensed under the Apache License Version 2.0 that can be found in the
+// LICENSE file in the root directory of this source tree.
+
+#include "src/effect/color_filter_program.hpp"
+
+#include <gtest/gtest.h>
+
+#include <skity/effect/color_filter.hpp>
+
+#include "src/graphic/color_priv.hpp"
+
+namespace skity {
+namespace {
+
+// r <- g, g <- b, b <- r, applying it three times is the identity.
+constexpr float kRotateMatrix[20] = {
+    0.f, 1.f, 0.f, 0.f, 0.f,  //
+    0.f, 0.f, 1.f, 0.f, 0.f,  //
+    1.f, 0.f, 0.f, 0.f, 0.f,  //
+    0.f, 0.f, 0.f, 1.f, 0.f,  //
+};
+
+constexpr float kHalfRedMatrix[20] = {
+    0.5f, 0.f, 0.f, 0.f, 0.f,  //
+    0.f,  1.f, 0.f, 0.f, 0.f,  //
+    0.f,  0.f, 1.f, 0.f, 0.f,  //
+    0.f,  0.f, 0.f, 1.f, 0.f,  //
+};
+
+TEST(ColorFilterProgramTest, FoldsConsecutiveMatrices) {
+  auto rotate = ColorFilters::Matrix(kRotateMatrix);
+
+  ColorFilterProgram twice(ColorFilters::Compose(rotate, rotate).get());
+  ASSERT_EQ(twice.GetOps().size(), 1u);
+  EXPECT_EQ(twice.GetOps()[0].type, ColorFilterProgram::OpType::kMatrix);
+
+  ColorFilterProgram identity(
+      ColorFilters::Compose(rotate, ColorFilters::Compose(rotate, rotate))
+          .get());
+  EXPECT_TRUE(identity.IsEmpty());
+}
+
+TEST(ColorFilterProgramTest, KeepsMatricesApartAroundOtherSteps) {
+  auto filter = ColorFilters::Compose(
+      ColorFilters::Matrix(kHalfRedMatrix),
+      ColorFilters::Compose(ColorFilters::LinearToSRGBGamma(),
+                            ColorFilters::Matrix(kRotateMatrix)));
+
+  ColorFilterProgram program(filter.get());
+  ASSERT_EQ(program.GetOps().size(), 3u);
+  EXPECT_EQ(program.GetOps()[0].type, ColorFilterProgram::OpType::kMatrix);
+  EXPECT_EQ(program.GetOps()[1].type,
+            ColorFilterProgram::OpType::kLinearToSRGBGamma);
+  EXPECT_EQ(program.GetOps()[2].type, ColorFilterProgram::OpType::kMatrix);
+}
+
+TEST(ColorFilterProgramTest, SrcBlendDropsEarlierSteps) {
+  auto filter = ColorFilters::Compose(
+      ColorFilters::Blend(Color_RED, BlendMode::kSrc),
+      ColorFilters::Compose(ColorFilters::SRGBToLinearGamma(),
+                            ColorFilters::Matrix(kRotateMatrix)));
+
+  ColorFilterProgram program(filter.get());
+  ASSERT_EQ(program.GetOps().size(), 1u);
+  EXPECT_EQ(program.GetOps()[0].type, ColorFilterProgram::OpType::kBlend);
+  EXPECT_EQ(program.GetOps()[0].mode, BlendMode::kSrc);
+}
+
+#ifdef SKITY_CPU
+
+TEST(ColorFilterProgramTest, RunMatchesFilterColor) {
+  auto filter = ColorFilters::Compose(
+      ColorFilters::Blend(ColorSetARGB(128, 0, 0, 255), BlendMode::kSrcOver),
+      ColorFilters::Compose(ColorFilters::LinearToSRGBGamma(),
+                            ColorFilters::Matrix(kHalfRedMatrix)));
+
+  ColorFilterProgram program(filter.get());
+  ASSERT_EQ(program.GetOps().size(), 3u);
+
+  PMColor colors[] = {
+      ColorToPMColor(ColorSetARGB(255, 200, 100, 50)),
+      ColorToPMColor(ColorSetARGB(255, 0, 0, 0)),
+      ColorToPMColor(ColorSetARGB(255, 255, 255, 255)),
+      ColorToPMColor(ColorSetARGB(255, 17, 99, 230)),
+  };
+
+  PMColor expected[4];
+  for (int32_t i = 0; i < 4; i++) {
+    expected[i] = filter->FilterColor(colors[i]);
+  }
+
+  program.Run(colors, 4);
+
+  for (int32_t i = 0; i < 4; i++) {
+    EXPECT_EQ(colors[i], expected[i]) << "at " << i;
+  }
+}
+
+#endif
+
+}  // namespace
+}  // namespace skity
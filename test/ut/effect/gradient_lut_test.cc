@@ -0,0 +1,102 @@
+// Copyright 2021 The Lynx Authors. All rights reserved.
+// Licensed under the Apache License Version 2.0 that can be found in the
+// LICENSE file in the root directory of this source tree.
+
+#include "src/effect/gradient_lut.hpp"
+
+#include <gtest/gtest.h>
+
+#include <skity/effect/shader.hpp>
+
+namespace skity {
+namespace {
+
+Shader::GradientInfo MakeInfo(std::vector<Vec4> colors,
+                              std::vector<float> offsets = {},
+                              int32_t flags = 0) {
+  Shader::GradientInfo info = {};
+  info.color_count = static_cast<int32_t>(colors.size());
+  info.colors = std::move(colors);
+  info.color_offsets = std::move(offsets);
+  info.tile_mode = TileMode::kClamp;
+  info.gradientFlags = flags;
+  return info;
+}
+
+TEST(GradientLUTTest, EndpointsMatchStopColors) {
+  auto info = MakeInfo({Colors::kRed, Colors::kBlue});
+  GradientLUT lut(info, GradientLUT::SizeFor(info));
+
+  EXPECT_EQ(lut.Size(), GradientLUT::kSmallSize);
+  EXPECT_EQ(lut.Lookup(0.f), 0xFFFF0000u);
+  EXPECT_EQ(lut.Lookup(1.f), 0xFF0000FFu);
+
+  PMColor mid = lut.Lookup(0.5f);
+  EXPECT_EQ(mid >> 24, 0xFFu);
+  EXPECT_NEAR(static_cast<int>((mid >> 16) & 0xFF), 127, 1);
+  EXPECT_NEAR(static_cast<int>(mid & 0xFF), 127, 1);
+}
+
+TEST(GradientLUTTest, TableIsPremultiplied) {
+  Vec4 transparent_red{1.f, 0.f, 0.f, 0.f};
+  Vec4 opaque_red{1.f, 0.f, 0.f, 1.f};
+
+  // Unpremul interpolation keeps the color red while alpha ramps up.
+  GradientLUT lut(MakeInfo({transparent_red, opaque_red}), 256);
+  PMColor mid = lut.Lookup(0.5f);
+  EXPECT_NEAR(static_cast<int>(mid >> 24), 127, 1);
+  EXPECT_EQ((mid >> 16) & 0xFF, mid >> 24);
+
+  EXPECT_EQ(lut.Lookup(0.f), 0u);
+}
+
+TEST(GradientLUTTest, HardStopsUseLargeTable) {
+  auto info = MakeInfo({Colors::kRed, Colors::kRed, Colors::kBlue,
+                        Colors::kBlue},
+                       {0.f, 0.5f, 0.5f, 1.f});
+  ASSERT_EQ(GradientLUT::SizeFor(info), GradientLUT::kLargeSize);
+
+  GradientLUT lut(info, GradientLUT::SizeFor(info));
+  EXPECT_EQ(lut.Lookup(0.49f), 0xFFFF0000u);
+  EXPECT_EQ(lut.Lookup(0.51f), 0xFF0000FFu);
+}
+
+TEST(GradientLUTTest, CacheSharesTablesByColorsAndStops) {
+  auto& cache = GradientLUTCache::GetInstance();
+  cache.Clear();
+
+  auto info = MakeInfo({Colors::kRed, Colors::kBlue});
+  auto lut = cache.FindOrCreate(info);
+
+  // Geometry and tiling are not part of the key.
+  auto moved = info;
+  moved.point[0] = Point{10.f, 10.f, 0.f, 1.f};
+  moved.tile_mode = TileMode::kMirror;
+  EXPECT_EQ(cache.FindOrCreate(moved), lut);
+  EXPECT_EQ(cache.GetEntryCount(), 1u);
+
+  auto premul = info;
+  premul.gradientFlags = 1;
+  EXPECT_NE(cache.FindOrCreate(premul), lut);
+  EXPECT_EQ(cache.GetEntryCount(), 2u);
+
+  for (size_t i = 0; i < GradientLUTCache::kMaxEntryCount; i++) {
+    float g = static_cast<float>(i) / GradientLUTCache::kMaxEntryCount;
+    cache.FindOrCreate(MakeInfo({Colors::kRed, Vec4{0.f, g, 0.f, 1.f}}));
+  }
+  EXPECT_EQ(cache.GetEntryCount(), GradientLUTCache::kMaxEntryCount);
+
+  cache.Clear();
+  EXPECT_EQ(cache.GetEntryCount(), 0u);
+}
+
+TEST(GradientLUTTest, TablesHaveDistinctIDs) {
+  auto info = MakeInfo({Colors::kRed, Colors::kBlue});
+  GradientLUT first(info, GradientLUT::SizeFor(info));
+  GradientLUT second(info, GradientLUT::SizeFor(info));
+
+  EXPECT_NE(first.GetID(), second.GetID());
+}
+
+}  // namespace
+}  // namespace skity
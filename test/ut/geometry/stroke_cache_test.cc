@@ -0,0 +1,106 @@
+// Copyright 2021 The Lynx Authors. All rights reserved.
+// Licensed under the Apache License Version 2.0 that can be found in the
+// LICENSE file in the root directory of this source tree.
+
+#include "src/geometry/stroke_cache.hpp"
+
+#include <gtest/gtest.h>
+
+#include <skity/geometry/stroke.hpp>
+
+namespace skity {
+namespace {
+
+Path MakeWave(float offset) {
+  Path path;
+  path.MoveTo(offset, 0);
+  path.QuadTo(offset + 20, 40, offset + 40, 0);
+  path.CubicTo(offset + 50, -20, offset + 70, 20, offset + 80, 0);
+  return path;
+}
+
+Paint MakeStrokePaint(float width) {
+  Paint paint;
+  paint.SetStyle(Paint::kStroke_Style);
+  paint.SetStrokeWidth(width);
+  return paint;
+}
+
+TEST(StrokeCacheTest, MatchesStroke) {
+  StrokeCache cache;
+  Path path = MakeWave(0);
+  Paint paint = MakeStrokePaint(6);
+
+  Stroke stroke(paint);
+  Path quad;
+  Path expected;
+  stroke.QuadPath(path, &quad);
+  stroke.StrokePath(quad, &expected);
+
+  auto outline = cache.FindOrCreate(path, paint);
+  ASSERT_NE(outline, nullptr);
+  EXPECT_EQ(outline->CountVerbs(), expected.CountVerbs());
+  EXPECT_EQ(outline->CountPoints(), expected.CountPoints());
+  EXPECT_EQ(outline->GetBounds(), expected.GetBounds());
+}
+
+TEST(StrokeCacheTest, HitsOnEqualGeometry) {
+  StrokeCache cache;
+  Paint paint = MakeStrokePaint(6);
+
+  // Two separately built paths with the same geometry share one outline.
+  auto first = cache.FindOrCreate(MakeWave(0), paint);
+  auto second = cache.FindOrCreate(MakeWave(0), paint);
+  EXPECT_EQ(first, second);
+
+  auto moved = cache.FindOrCreate(MakeWave(1), paint);
+  EXPECT_NE(first, moved);
+}
+
+TEST(StrokeCacheTest, MissesOnStrokeSettings) {
+  StrokeCache cache;
+  Path path = MakeWave(0);
+  Paint paint = MakeStrokePaint(6);
+  auto base = cache.FindOrCreate(path, paint);
+
+  Paint wider = paint;
+  wider.SetStrokeWidth(8);
+  EXPECT_NE(cache.FindOrCreate(path, wider), base);
+
+  Paint round_cap = paint;
+  round_cap.SetStrokeCap(Paint::kRound_Cap);
+  EXPECT_NE(cache.FindOrCreate(path, round_cap), base);
+
+  Paint round_join = paint;
+  round_join.SetStrokeJoin(Paint::kRound_Join);
+  EXPECT_NE(cache.FindOrCreate(path, round_join), base);
+
+  // The fill color has nothing to do with the outline.
+  Paint red = paint;
+  red.SetColor(Color_RED);
+  EXPECT_EQ(cache.FindOrCreate(path, red), base);
+}
+
+TEST(StrokeCacheTest, PurgesOverBudget) {
+  StrokeCache cache;
+  Paint paint = MakeStrokePaint(6);
+
+  auto first = cache.FindOrCreate(MakeWave(0), paint);
+  size_t one_entry = cache.GetCachedBytes();
+  ASSERT_GT(one_entry, 0u);
+
+  cache.SetMaxBytes(one_entry);
+  auto second = cache.FindOrCreate(MakeWave(100), paint);
+  EXPECT_LE(cache.GetCachedBytes(), one_entry + one_entry / 2);
+
+  // The first outline was evicted and is stroked again, the caller's copy
+  // stays valid.
+  EXPECT_NE(cache.FindOrCreate(MakeWave(0), paint), first);
+  EXPECT_GT(first->CountPoints(), 0u);
+
+  cache.Clear();
+  EXPECT_EQ(cache.GetCachedBytes(), 0u);
+}
+
+}  // namespace
+}  // namespace skity
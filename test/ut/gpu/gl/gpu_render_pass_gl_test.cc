@@ -0,0 +1,252 @@
+// Copyright 2021 The Lynx Authors. All rights reserved.
+// Licensed under the Apache License Version 2.0 that can be found in the
+// LICENSE file in the root directory of this source tree.
+
+#include "src/gpu/gl/gpu_render_pass_gl.hpp"
+
+#include <gtest/gtest.h>
+
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "src/gpu/gl/gl_interface.hpp"
+#include "src/gpu/gl/gpu_buffer_gl.hpp"
+#include "src/gpu/gl/gpu_render_pipeline_gl.hpp"
+#include "src/gpu/gl/gpu_texture_gl.hpp"
+
+namespace {
+
+std::map<std::string, int> g_calls;
+GLuint g_next_id = 1;
+GLint g_vertex_array = 0;
+
+#define COUNT_CALL(name) g_calls[#name]++
+
+GLADapiproc NullLoader(const char*) { return nullptr; }
+
+// Replaces the global interface with stubs which only count the calls, so the
+// pass can be encoded without a GL context.
+void InstallCountingInterface() {
+  skity::GLInterface::InitGlobalInterface(reinterpret_cast<void*>(NullLoader));
+  auto gl = skity::GLInterface::GlobalInterface();
+
+  gl->fGetError = []() -> GLenum { return GL_NO_ERROR; };
+  gl->fGenBuffers = [](GLsizei, GLuint* ids) { ids[0] = g_next_id++; };
+  gl->fDeleteBuffers = [](GLsizei, const GLuint*) {};
+  gl->fGenVertexArrays = [](GLsizei, GLuint* ids) {
+    COUNT_CALL(GenVertexArrays);
+    ids[0] = g_next_id++;
+  };
+  gl->fDeleteVertexArrays = [](GLsizei, const GLuint*) {
+    COUNT_CALL(DeleteVertexArrays);
+  };
+  gl->fBindVertexArray = [](GLuint vao) {
+    COUNT_CALL(BindVertexArray);
+    g_vertex_array = vao;
+  };
+  gl->fGetIntegerv = [](GLenum pname, GLint* value) {
+    if (pname == GL_VERTEX_ARRAY_BINDING) {
+      *value = g_vertex_array;
+    }
+  };
+  gl->fGetUniformBlockIndex = [](GLuint, const GLchar*) -> GLuint {
+    return 0;
+  };
+  gl->fGetUniformLocation = [](GLuint, const GLchar*) -> GLint { return 0; };
+
+  gl->fBindFramebuffer = [](GLenum, GLuint) {};
+  gl->fViewport = [](GLint, GLint, GLsizei, GLsizei) {};
+  gl->fScissor = [](GLint, GLint, GLsizei, GLsizei) {};
+  gl->fEnable = [](GLenum) {};
+  gl->fDisable = [](GLenum) {};
+  gl->fStencilFunc = [](GLenum, GLint, GLuint) {};
+  gl->fStencilOp = [](GLenum, GLenum, GLenum) {};
+  gl->fStencilMask = [](GLuint) {};
+  gl->fColorMask = [](GLboolean, GLboolean, GLboolean, GLboolean) {};
+  gl->fBlendFunc = [](GLenum, GLenum) {};
+  gl->fBlendEquation = [](GLenum) {};
+  gl->fDepthMask = [](GLboolean) { COUNT_CALL(DepthMask); };
+  gl->fDepthFunc = [](GLenum) { COUNT_CALL(DepthFunc); };
+
+  gl->fUseProgram = [](GLuint) { COUNT_CALL(UseProgram); };
+  gl->fBindBuffer = [](GLenum target, GLuint) {
+    if (target == GL_ELEMENT_ARRAY_BUFFER) {
+      COUNT_CALL(BindElementBuffer);
+    } else {
+      COUNT_CALL(BindBuffer);
+    }
+  };
+  gl->fEnableVertexAttribArray = [](GLuint) {
+    COUNT_CALL(EnableVertexAttribArray);
+  };
+  gl->fVertexAttribPointer = [](GLuint, GLint, GLenum, GLboolean, GLsizei,
+                                const void*) {
+    COUNT_CALL(VertexAttribPointer);
+  };
+  gl->fVertexAttribIPointer = [](GLuint, GLint, GLenum, GLsizei, const void*) {
+    COUNT_CALL(VertexAttribPointer);
+  };
+  gl->fVertexAttribDivisor = [](GLuint, GLuint) {
+    COUNT_CALL(VertexAttribDivisor);
+  };
+  gl->fUniformBlockBinding = [](GLuint, GLuint, GLuint) {
+    COUNT_CALL(UniformBlockBinding);
+  };
+  gl->fBindBufferRange = [](GLenum, GLuint, GLuint, GLintptr, GLsizeiptr) {
+    COUNT_CALL(BindBufferRange);
+  };
+  gl->fActiveTexture = [](GLenum) { COUNT_CALL(ActiveTexture); };
+  gl->fBindTexture = [](GLenum, GLuint) { COUNT_CALL(BindTexture); };
+  gl->fUniform1i = [](GLint, GLint) { COUNT_CALL(Uniform1i); };
+  gl->fBindSampler = [](GLuint, GLuint) { COUNT_CALL(BindSampler); };
+  gl->fDrawElements = [](GLenum, GLsizei, GLenum, const void*) {
+    COUNT_CALL(DrawElements);
+  };
+  gl->fDrawElementsInstanced = [](GLenum, GLsizei, GLenum, const void*,
+                                  GLsizei) { COUNT_CALL(DrawElements); };
+  gl->fDeleteProgram = [](GLuint) {};
+  gl->fDeleteTextures = [](GLsizei, const GLuint*) {};
+
+  g_calls.clear();
+  g_vertex_array = 0;
+}
+
+class FakeShaderFunction : public skity::GPUShaderFunction {
+ public:
+  FakeShaderFunction() : skity::GPUShaderFunction(skity::GPULabel{}) {}
+
+  bool IsValid() const override { return true; }
+};
+
+class GPURenderPassGLTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    InstallCountingInterface();
+
+    layouts_.push_back(skity::GPUVertexBufferLayout{
+        8,
+        skity::GPUVertexStepMode::kVertex,
+        {{skity::GPUVertexFormat::kFloat32x2, 0, 0}},
+    });
+
+    skity::GPURenderPipelineDescriptor pipeline_desc;
+    pipeline_desc.vertex_function = std::make_shared<FakeShaderFunction>();
+    pipeline_desc.fragment_function = std::make_shared<FakeShaderFunction>();
+    pipeline_desc.buffers = &layouts_;
+    pipeline_ = std::make_unique<skity::GPURenderPipelineGL>(
+        std::make_shared<skity::GLProgram>(1, false), pipeline_desc);
+
+    skity::GPUBufferDescriptor buffer_desc;
+    vertex_buffer_ = std::make_unique<skity::GPUBufferGL>(buffer_desc);
+    buffer_desc.usage = skity::GPUBufferUsage::kIndexBuffer;
+    index_buffer_ = std::make_unique<skity::GPUBufferGL>(buffer_desc);
+
+    skity::GPUTextureDescriptor texture_desc;
+    texture_desc.width = 64;
+    texture_desc.height = 64;
+    texture_ = std::make_shared<skity::GPUTextureGL>(texture_desc);
+    pass_desc_.color_attachment.texture = texture_;
+  }
+
+  skity::Command MakeCommand(uint32_t vertex_offset) {
+    skity::Command command;
+    command.pipeline = pipeline_.get();
+    command.index_buffer = {index_buffer_.get(), 0, 24};
+    command.vertex_buffer = {vertex_buffer_.get(), vertex_offset, 64};
+    command.index_count = 6;
+    command.scissor_rect = {0, 0, 64, 64};
+
+    skity::UniformBinding uniform{};
+    uniform.index = 0;
+    uniform.name = "CommonSlot";
+    uniform.buffer = {vertex_buffer_.get(), 256, 64};
+    command.uniform_bindings.push_back(uniform);
+
+    skity::TextureBinding texture{};
+    texture.index = 0;
+    texture.name = "uTexture";
+    texture.texture = texture_;
+    command.texture_bindings.push_back(texture);
+    return command;
+  }
+
+  std::vector<skity::GPUVertexBufferLayout> layouts_;
+  std::unique_ptr<skity::GPURenderPipelineGL> pipeline_;
+  std::unique_ptr<skity::GPUBufferGL> vertex_buffer_;
+  std::unique_ptr<skity::GPUBufferGL> index_buffer_;
+  std::shared_ptr<skity::GPUTextureGL> texture_;
+  skity::GPURenderPassDescriptor pass_desc_;
+};
+
+}  // namespace
+
+TEST_F(GPURenderPassGLTest, RedundantStateIsElided) {
+  auto first = MakeCommand(0);
+  auto second = MakeCommand(0);
+
+  skity::GPURenderPassGL pass(pass_desc_, 0);
+  pass.AddCommand(&first);
+  pass.AddCommand(&second);
+  pass.EncodeCommands(std::nullopt, std::nullopt);
+
+  EXPECT_EQ(g_calls["DrawElements"], 2);
+  EXPECT_EQ(g_calls["UseProgram"], 1);
+  EXPECT_EQ(g_calls["EnableVertexAttribArray"], 1);
+  EXPECT_EQ(g_calls["VertexAttribPointer"], 1);
+  EXPECT_EQ(g_calls["VertexAttribDivisor"], 1);
+  EXPECT_EQ(g_calls["BindElementBuffer"], 1);
+  EXPECT_EQ(g_calls["UniformBlockBinding"], 1);
+  EXPECT_EQ(g_calls["BindBufferRange"], 1);
+  EXPECT_EQ(g_calls["Uniform1i"], 1);
+  // One for the draws and one to reset the unit at the end of the pass.
+  EXPECT_EQ(g_calls["BindTexture"], 2);
+  // Only set once at the begin of the pass.
+  EXPECT_EQ(g_calls["DepthMask"], 1);
+  EXPECT_EQ(g_calls["DepthFunc"], 1);
+}
+
+TEST_F(GPURenderPassGLTest, VertexOffsetOnlyUpdatesPointers) {
+  auto first = MakeCommand(0);
+  auto second = MakeCommand(128);
+
+  skity::GPURenderPassGL pass(pass_desc_, 0);
+  pass.AddCommand(&first);
+  pass.AddCommand(&second);
+  pass.EncodeCommands(std::nullopt, std::nullopt);
+
+  EXPECT_EQ(g_calls["VertexAttribPointer"], 2);
+  EXPECT_EQ(g_calls["EnableVertexAttribArray"], 1);
+  EXPECT_EQ(g_calls["VertexAttribDivisor"], 1);
+}
+
+TEST_F(GPURenderPassGLTest, VertexArrayIsCachedAcrossPasses) {
+  g_vertex_array = 42;
+  auto command = MakeCommand(0);
+
+  {
+    skity::GPURenderPassGL pass(pass_desc_, 0);
+    pass.AddCommand(&command);
+    pass.EncodeCommands(std::nullopt, std::nullopt);
+  }
+  EXPECT_EQ(g_vertex_array, 42);
+
+  {
+    skity::GPURenderPassGL pass(pass_desc_, 0);
+    pass.AddCommand(&command);
+    pass.EncodeCommands(std::nullopt, std::nullopt);
+  }
+  EXPECT_EQ(g_vertex_array, 42);
+
+  EXPECT_EQ(g_calls["GenVertexArrays"], 1);
+  EXPECT_EQ(g_calls["EnableVertexAttribArray"], 1);
+  EXPECT_EQ(g_calls["VertexAttribPointer"], 1);
+  EXPECT_EQ(g_calls["BindElementBuffer"], 1);
+  // The program state is kept in the program object as well.
+  EXPECT_EQ(g_calls["UniformBlockBinding"], 1);
+  EXPECT_EQ(g_calls["Uniform1i"], 1);
+
+  vertex_buffer_.reset();
+  EXPECT_EQ(g_calls["DeleteVertexArrays"], 1);
+}
@@ -6,9 +6,12 @@
 #include <vulkan/vulkan.h>
 
 #include <algorithm>
+#include <cstdio>
+#include <cstring>
 #include <functional>
 #include <memory>
 #include <skity/gpu/gpu_context_vk.hpp>
+#include <skity/io/data.hpp>
 #include <string>
 #include <vector>
 
@@ -1937,6 +1940,253 @@ TEST(VulkanProcLoaderTest, LegacyRenderPassCacheReusesCompatibleRenderPass) {
   EXPECT_NE(first, third);
 }
 
+void AppendPipelineCacheData(const void* data, size_t size, void* userdata) {
+  auto* saved = static_cast<std::vector<uint8_t>*>(userdata);
+  const auto* bytes = static_cast<const uint8_t*>(data);
+  saved->assign(bytes, bytes + size);
+}
+
+bool CreateSimpleRenderPipeline(skity::GPUContext* context) {
+  auto* context_impl = static_cast<skity::GPUContextImpl*>(
+      static_cast<skity::GPUContextVK*>(context));
+  auto* device = context_impl->GetGPUDevice();
+  auto vertex_function = CreateWGXShaderFunction(
+      device, kSimpleVertexWGSL, "vk_pipeline_cache_vs", "vs_main",
+      skity::GPUShaderStage::kVertex);
+  auto fragment_function = CreateWGXShaderFunction(
+      device, kSimpleFragmentWGSL, "vk_pipeline_cache_fs", "fs_main",
+      skity::GPUShaderStage::kFragment);
+  if (vertex_function == nullptr || fragment_function == nullptr) {
+    return false;
+  }
+
+  skity::GPURenderPipelineDescriptor pipeline_desc = {};
+  pipeline_desc.vertex_function = vertex_function;
+  pipeline_desc.fragment_function = fragment_function;
+  pipeline_desc.target.format = skity::GPUTextureFormat::kRGBA8Unorm;
+  pipeline_desc.sample_count = 1;
+  pipeline_desc.label = skity::GPULabel("vk_pipeline_cache_pipeline");
+  auto pipeline = device->CreateRenderPipeline(pipeline_desc);
+  return pipeline != nullptr && pipeline->IsValid();
+}
+
+TEST(VulkanProcLoaderTest, PipelineCacheIsHandedToCallback) {
+  if (SkipVulkanTestsOnThreadSanitizer()) {
+    GTEST_SKIP() << "Vulkan tests are unstable under ThreadSanitizer with "
+                    "SwiftShader in this environment";
+  }
+  std::vector<uint8_t> saved;
+  skity::GPUContextInfoVK info = {};
+  info.get_instance_proc_addr = vkGetInstanceProcAddr;
+  info.pipeline_cache_callback = AppendPipelineCacheData;
+  info.pipeline_cache_userdata = &saved;
+
+  auto context = skity::CreateGPUContextVK(&info);
+  ASSERT_NE(context, nullptr);
+  ASSERT_TRUE(CreateSimpleRenderPipeline(context.get()));
+  context.reset();
+
+  VkPipelineCacheHeaderVersionOne header = {};
+  ASSERT_GE(saved.size(), sizeof(header));
+  std::memcpy(&header, saved.data(), sizeof(header));
+  EXPECT_EQ(header.headerVersion, VK_PIPELINE_CACHE_HEADER_VERSION_ONE);
+
+  // The saved cache seeds the next context, which saves it again.
+  std::vector<uint8_t> resaved;
+  info.pipeline_cache_data = saved.data();
+  info.pipeline_cache_data_size = saved.size();
+  info.pipeline_cache_userdata = &resaved;
+  context = skity::CreateGPUContextVK(&info);
+  ASSERT_NE(context, nullptr);
+  ASSERT_TRUE(CreateSimpleRenderPipeline(context.get()));
+  context.reset();
+  EXPECT_GE(resaved.size(), sizeof(header));
+}
+
+TEST(VulkanProcLoaderTest, PipelineCacheIsPersistedToPath) {
+  if (SkipVulkanTestsOnThreadSanitizer()) {
+    GTEST_SKIP() << "Vulkan tests are unstable under ThreadSanitizer with "
+                    "SwiftShader in this environment";
+  }
+  const std::string path =
+      ::testing::TempDir() + "skity_vk_pipeline_cache_test.bin";
+  std::remove(path.c_str());
+
+  skity::GPUContextInfoVK info = {};
+  info.get_instance_proc_addr = vkGetInstanceProcAddr;
+  info.pipeline_cache_path = path.c_str();
+
+  auto context = skity::CreateGPUContextVK(&info);
+  ASSERT_NE(context, nullptr);
+  ASSERT_TRUE(CreateSimpleRenderPipeline(context.get()));
+  context.reset();
+
+  auto data = skity::Data::MakeFromFileName(path.c_str());
+  ASSERT_NE(data, nullptr);
+  EXPECT_GE(data->Size(), sizeof(VkPipelineCacheHeaderVersionOne));
+
+  context = skity::CreateGPUContextVK(&info);
+  EXPECT_NE(context, nullptr);
+  context.reset();
+  std::remove(path.c_str());
+}
+
+TEST(VulkanProcLoaderTest, IgnoresForeignPipelineCacheData) {
+  if (SkipVulkanTestsOnThreadSanitizer()) {
+    GTEST_SKIP() << "Vulkan tests are unstable under ThreadSanitizer with "
+                    "SwiftShader in this environment";
+  }
+  std::vector<uint8_t> foreign(256, 0xAB);
+  skity::GPUContextInfoVK info = {};
+  info.get_instance_proc_addr = vkGetInstanceProcAddr;
+  info.pipeline_cache_data = foreign.data();
+  info.pipeline_cache_data_size = foreign.size();
+
+  auto context = skity::CreateGPUContextVK(&info);
+  ASSERT_NE(context, nullptr);
+  EXPECT_TRUE(CreateSimpleRenderPipeline(context.get()));
+}
+
+TEST_F(VulkanSharedContextTest, DescriptorPoolIsReusedAfterRecycle) {
+  ASSERT_NE(GetState(), nullptr);
+  const auto& cache = GetState()->GetDescriptorPoolCache();
+  const size_t pool_count = cache.GetPoolCount();
+
+  skity::VulkanContextState::DescriptorPoolRequirements requirements = {};
+  requirements.max_sets = 4;
+  requirements.uniform_buffer_count = 4;
+  const VkDescriptorPool first =
+      GetState()->AcquireDescriptorPool(requirements);
+  ASSERT_NE(first, VK_NULL_HANDLE);
+  GetState()->RecycleDescriptorPool(first);
+
+  // Requirements which still fit reuse the recycled pool, a much larger pass
+  // needs a new one.
+  requirements.sampled_image_count = 2;
+  const VkDescriptorPool second =
+      GetState()->AcquireDescriptorPool(requirements);
+  EXPECT_EQ(first, second);
+
+  requirements.max_sets = 1000;
+  const VkDescriptorPool third =
+      GetState()->AcquireDescriptorPool(requirements);
+  ASSERT_NE(third, VK_NULL_HANDLE);
+  EXPECT_NE(third, second);
+
+  GetState()->RecycleDescriptorPool(second);
+  GetState()->RecycleDescriptorPool(third);
+  EXPECT_LE(cache.GetPoolCount(), pool_count + 2);
+  EXPECT_EQ(cache.GetFreePoolCount(), cache.GetPoolCount());
+}
+
+TEST_F(VulkanSharedContextTest, RenderPassRecyclesDescriptorPool) {
+  ASSERT_NE(GetContext(), nullptr);
+  auto* device = GetDevice();
+  ASSERT_NE(device, nullptr);
+
+  auto vertex_function = CreateWGXShaderFunction(
+      device, kSimpleVertexWGSL, "vk_descriptor_reuse_vs", "vs_main",
+      skity::GPUShaderStage::kVertex);
+  auto fragment_function = CreateWGXShaderFunction(
+      device, kUniformFragmentWGSL, "vk_descriptor_reuse_fs",
+      "fs_uniform_main", skity::GPUShaderStage::kFragment);
+  ASSERT_NE(vertex_function, nullptr);
+  ASSERT_NE(fragment_function, nullptr);
+
+  skity::GPURenderPipelineDescriptor pipeline_desc = {};
+  pipeline_desc.vertex_function = vertex_function;
+  pipeline_desc.fragment_function = fragment_function;
+  pipeline_desc.target.format = skity::GPUTextureFormat::kRGBA8Unorm;
+  pipeline_desc.sample_count = 1;
+  pipeline_desc.label = skity::GPULabel("vk_descriptor_reuse_pipeline");
+  auto pipeline = device->CreateRenderPipeline(pipeline_desc);
+  ASSERT_NE(pipeline, nullptr);
+
+  skity::GPUBufferDescriptor buffer_desc = {};
+  buffer_desc.usage = skity::GPUBufferUsage::kVertexBuffer;
+  auto vertex_buffer = device->CreateBuffer(buffer_desc);
+  buffer_desc.usage = skity::GPUBufferUsage::kIndexBuffer;
+  auto index_buffer = device->CreateBuffer(buffer_desc);
+  buffer_desc.usage = skity::GPUBufferUsage::kUniformBuffer;
+  auto uniform_buffer = device->CreateBuffer(buffer_desc);
+
+  skity::GPUTextureDescriptor texture_desc = {};
+  texture_desc.width = 16;
+  texture_desc.height = 16;
+  texture_desc.mip_level_count = 1;
+  texture_desc.sample_count = 1;
+  texture_desc.format = skity::GPUTextureFormat::kRGBA8Unorm;
+  texture_desc.usage = static_cast<skity::GPUTextureUsageMask>(
+      skity::GPUTextureUsage::kRenderAttachment);
+  texture_desc.storage_mode = skity::GPUTextureStorageMode::kPrivate;
+  auto texture = device->CreateTexture(texture_desc);
+  ASSERT_NE(texture, nullptr);
+
+  float vertex_data[4] = {0.f, 0.f, 0.f, 1.f};
+  uint32_t index_data[3] = {0u, 0u, 0u};
+  float uniform_data[4] = {0.25f, 0.5f, 0.75f, 1.f};
+
+  size_t pool_count = 0;
+  for (int frame = 0; frame < 3; ++frame) {
+    auto command_buffer = device->CreateCommandBuffer();
+    ASSERT_NE(command_buffer, nullptr);
+
+    auto blit_pass = command_buffer->BeginBlitPass();
+    blit_pass->UploadBufferData(vertex_buffer.get(), vertex_data,
+                                sizeof(vertex_data));
+    blit_pass->UploadBufferData(index_buffer.get(), index_data,
+                                sizeof(index_data));
+    blit_pass->UploadBufferData(uniform_buffer.get(), uniform_data,
+                                sizeof(uniform_data));
+    blit_pass->End();
+
+    skity::GPURenderPassDescriptor render_pass_desc = {};
+    render_pass_desc.color_attachment.texture = texture;
+    render_pass_desc.color_attachment.load_op = skity::GPULoadOp::kClear;
+    render_pass_desc.color_attachment.store_op = skity::GPUStoreOp::kStore;
+    auto render_pass = command_buffer->BeginRenderPass(render_pass_desc);
+    ASSERT_NE(render_pass, nullptr);
+
+    // Both draws bind the same uniform and share one descriptor set.
+    skity::Command commands[2] = {};
+    for (auto& command : commands) {
+      command.pipeline = pipeline.get();
+      command.vertex_buffer = {vertex_buffer.get(), 0,
+                               static_cast<uint32_t>(sizeof(vertex_data))};
+      command.index_buffer = {index_buffer.get(), 0,
+                              static_cast<uint32_t>(sizeof(index_data))};
+      command.index_count = 3;
+      command.scissor_rect = {0, 0, texture_desc.width, texture_desc.height};
+
+      skity::UniformBinding uniform_binding = {};
+      uniform_binding.stages = static_cast<skity::GPUShaderStageMask>(
+          skity::GPUShaderStage::kFragment);
+      uniform_binding.group = 0;
+      uniform_binding.binding = 0;
+      uniform_binding.name = "fs_uniforms";
+      uniform_binding.buffer = {uniform_buffer.get(), 0,
+                                static_cast<uint32_t>(sizeof(uniform_data))};
+      command.uniform_bindings.push_back(uniform_binding);
+      render_pass->AddCommand(&command);
+    }
+    render_pass->EncodeCommands();
+
+    EXPECT_TRUE(command_buffer->Submit());
+    GetState()->CollectPendingSubmissions(true);
+
+    // The pool comes back once the frame has completed, so later frames do
+    // not create new ones.
+    const auto& cache = GetState()->GetDescriptorPoolCache();
+    EXPECT_EQ(cache.GetFreePoolCount(), cache.GetPoolCount());
+    if (frame == 0) {
+      pool_count = cache.GetPoolCount();
+      EXPECT_GT(pool_count, 0u);
+    } else {
+      EXPECT_EQ(cache.GetPoolCount(), pool_count);
+    }
+  }
+}
+
 TEST(GPUNativeWindowVKTest, CreateRejectsNullInfo) {
   auto context = skity::CreateGPUNativeWindowVK(
       static_cast<skity::GPUContext*>(nullptr), nullptr);
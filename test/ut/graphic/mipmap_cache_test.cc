@@ -0,0 +1,116 @@
+// Copyright 2021 The Lynx Authors. All rights reserved.
+// Licensed under the Apache License Version 2.0 that can be found in the
+// LICENSE file in the root directory of this source tree.
+
+#include "src/graphic/mipmap_cache.hpp"
+
+#include <gtest/gtest.h>
+
+#include <cstring>
+#include <skity/io/pixmap.hpp>
+
+namespace skity {
+namespace {
+
+std::shared_ptr<Pixmap> MakeFilledPixmap(uint32_t width, uint32_t height,
+                                         uint32_t even, uint32_t odd) {
+  auto pixmap = std::make_shared<Pixmap>(width, height,
+                                         AlphaType::kPremul_AlphaType);
+  for (uint32_t y = 0; y < height; y++) {
+    for (uint32_t x = 0; x < width; x++) {
+      uint32_t pixel = (x + y) % 2 == 0 ? even : odd;
+      std::memcpy(pixmap->WritableAddr8(x, y), &pixel, sizeof(pixel));
+    }
+  }
+  return pixmap;
+}
+
+uint32_t ReadPixel(const Pixmap& pixmap, uint32_t x, uint32_t y) {
+  uint32_t pixel;
+  std::memcpy(&pixel, pixmap.Addr8(x, y), sizeof(pixel));
+  return pixel;
+}
+
+TEST(MipmapTest, BuildsHalfSizedLevelsDownTo1x1) {
+  auto pixmap = MakeFilledPixmap(16, 5, 0xFF000000, 0xFF000000);
+  auto mipmap = Mipmap::Build(*pixmap);
+  ASSERT_NE(mipmap, nullptr);
+
+  // 16x5, 8x2, 4x1, 2x1, 1x1
+  ASSERT_EQ(mipmap->GetLevelCount(), 5u);
+  EXPECT_EQ(mipmap->GetLevel(1)->Width(), 8u);
+  EXPECT_EQ(mipmap->GetLevel(1)->Height(), 2u);
+  EXPECT_EQ(mipmap->GetLevel(2)->Height(), 1u);
+  EXPECT_EQ(mipmap->GetLevel(4)->Width(), 1u);
+  EXPECT_EQ(mipmap->GetLevel(1)->GetAlphaType(), AlphaType::kPremul_AlphaType);
+}
+
+TEST(MipmapTest, BoxFilterAveragesChannels) {
+  auto pixmap = MakeFilledPixmap(4, 4, 0xFF0000FF, 0x0100FF00);
+  auto mipmap = Mipmap::Build(*pixmap);
+  ASSERT_NE(mipmap, nullptr);
+
+  // Two of each pixel per 2x2 block, rounded to nearest.
+  EXPECT_EQ(ReadPixel(*mipmap->GetLevel(1), 1, 1), 0x80008080u);
+  EXPECT_EQ(ReadPixel(*mipmap->GetLevel(2), 0, 0), 0x80008080u);
+}
+
+TEST(MipmapTest, SkipsUnsupportedPixmaps) {
+  Pixmap single(1, 1);
+  EXPECT_EQ(Mipmap::Build(single), nullptr);
+
+  Pixmap alpha_only(8, 8, AlphaType::kPremul_AlphaType, ColorType::kA8);
+  EXPECT_EQ(Mipmap::Build(alpha_only), nullptr);
+}
+
+TEST(MipmapTest, LevelFollowsMinification) {
+  EXPECT_EQ(ComputeMipmapLevel(Matrix::Scale(1.f / 100, 1.f / 100), 100, 100),
+            0.f);
+  EXPECT_EQ(ComputeMipmapLevel(Matrix::Scale(1.f / 400, 1.f / 400), 100, 100),
+            0.f);
+  EXPECT_FLOAT_EQ(
+      ComputeMipmapLevel(Matrix::Scale(1.f / 25, 1.f / 100), 100, 100), 2.f);
+}
+
+TEST(MipmapCacheTest, CachesByPixmapGeneration) {
+  auto& cache = MipmapCache::GetInstance();
+  cache.Clear();
+
+  auto pixmap = MakeFilledPixmap(64, 64, 0xFFFFFFFF, 0xFF000000);
+  auto mipmap = cache.FindOrCreate(*pixmap);
+  ASSERT_NE(mipmap, nullptr);
+  EXPECT_EQ(cache.FindOrCreate(*pixmap), mipmap);
+  EXPECT_EQ(cache.GetCachedBytes(), mipmap->GetByteSize());
+
+  pixmap->NotifyPixelsChanged();
+  EXPECT_NE(cache.FindOrCreate(*pixmap), mipmap);
+
+  cache.SetMaxBytes(mipmap->GetByteSize());
+  EXPECT_EQ(cache.GetCachedBytes(), mipmap->GetByteSize());
+
+  cache.SetMaxBytes(MipmapCache::kDefaultMaxBytes);
+  cache.Clear();
+  EXPECT_EQ(cache.GetCachedBytes(), 0u);
+}
+
+TEST(MipmapCacheTest, DropsPyramidWhenPixelsChange) {
+  auto& cache = MipmapCache::GetInstance();
+  cache.Clear();
+
+  auto pixmap = MakeFilledPixmap(64, 64, 0xFFFFFFFF, 0xFF000000);
+  ASSERT_NE(cache.FindOrCreate(*pixmap), nullptr);
+  EXPECT_NE(cache.GetCachedBytes(), 0u);
+
+  pixmap->NotifyPixelsChanged();
+  EXPECT_EQ(cache.GetCachedBytes(), 0u);
+
+  // The listener is registered again for the new generation.
+  ASSERT_NE(cache.FindOrCreate(*pixmap), nullptr);
+  EXPECT_NE(cache.GetCachedBytes(), 0u);
+
+  pixmap.reset();
+  EXPECT_EQ(cache.GetCachedBytes(), 0u);
+}
+
+}  // namespace
+}  // namespace skity
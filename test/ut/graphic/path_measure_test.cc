@@ -3,11 +3,13 @@
 // LICENSE file in the root directory of this source tree.
 
 #include <array>
+#include <cmath>
 #include <skity/graphic/path.hpp>
 #include <skity/graphic/path_measure.hpp>
 
 #include "gtest/gtest.h"
 #include "src/geometry/math.hpp"
+#include "src/graphic/contour_measure_cache.hpp"
 
 static void test_small_segment1() {
   skity::Path path;
@@ -189,3 +191,99 @@ TEST(PathMeasure, getLength) {
   test_small_segment1();
   test_small_segment2();
 }
+
+TEST(PathMeasure, BatchedPosTanMatchesSingle) {
+  skity::Path path;
+  path.MoveTo(0, 0);
+  path.CubicTo(10, 40, 60, -20, 100, 30);
+  path.QuadTo(120, 80, 60, 90);
+
+  skity::PathMeasure meas{path, false};
+  float length = meas.GetLength();
+
+  std::array<float, 9> distances = {
+      -1.f,         0.f,          length * 0.1f, length * 0.25f, length * 0.5f,
+      length * 0.2f, length * 0.9f, length,        length + 1.f,
+  };
+  std::array<skity::Point, 9> positions = {};
+  std::array<skity::Vector, 9> tangents = {};
+
+  EXPECT_TRUE(meas.GetPosTan(distances.data(), distances.size(),
+                             positions.data(), tangents.data()));
+
+  for (size_t i = 0; i < distances.size(); i++) {
+    skity::Point position;
+    skity::Vector tangent;
+    EXPECT_TRUE(meas.GetPosTan(distances[i], &position, &tangent));
+    EXPECT_EQ(positions[i].x, position.x) << "at " << i;
+    EXPECT_EQ(positions[i].y, position.y) << "at " << i;
+    EXPECT_EQ(tangents[i].x, tangent.x) << "at " << i;
+    EXPECT_EQ(tangents[i].y, tangent.y) << "at " << i;
+  }
+
+  float nan_distance = std::nanf("");
+  EXPECT_FALSE(meas.GetPosTan(&nan_distance, 1, positions.data(), nullptr));
+}
+
+TEST(PathMeasure, SharesMeasurementOfEqualPaths) {
+  skity::Path path;
+  path.MoveTo(0, 0);
+  path.LineTo(30, 40);
+  path.LineTo(30, 80);
+
+  skity::Path copy;
+  copy.MoveTo(0, 0);
+  copy.LineTo(30, 40);
+  copy.LineTo(30, 80);
+
+  auto& cache = skity::ContourMeasureCache::GetInstance();
+  cache.Clear();
+
+  auto measurement = cache.FindOrCreate(path, false, 1.f);
+  ASSERT_EQ(measurement->GetContourCount(), 1u);
+  EXPECT_FLOAT_EQ(measurement->GetContour(0)->length(), 90.f);
+
+  EXPECT_EQ(cache.FindOrCreate(copy, false, 1.f), measurement);
+  EXPECT_NE(cache.FindOrCreate(copy, true, 1.f), measurement);
+  EXPECT_NE(cache.FindOrCreate(copy, false, 2.f), measurement);
+  EXPECT_EQ(cache.GetEntryCount(), 3u);
+
+  copy.LineTo(0, 80);
+  EXPECT_NE(cache.FindOrCreate(copy, false, 1.f), measurement);
+
+  cache.Clear();
+  EXPECT_EQ(cache.GetEntryCount(), 0u);
+  EXPECT_EQ(cache.GetCachedBytes(), 0u);
+}
+
+TEST(PathMeasure, MeasurementCacheIsBoundedByBytes) {
+  auto& cache = skity::ContourMeasureCache::GetInstance();
+  cache.Clear();
+
+  skity::Path path;
+  path.AddCircle(50, 50, 40);
+  auto measurement = cache.FindOrCreate(path, false, 1.f);
+  ASSERT_EQ(measurement->GetContourCount(), 1u);
+
+  // Charged for the key geometry and every flattened segment and point.
+  size_t bytes = cache.GetCachedBytes();
+  EXPECT_EQ(bytes, skity::PathGeometryKey::From(path).GetByteSize() +
+                       measurement->GetByteSize());
+  EXPECT_GT(measurement->GetByteSize(),
+            measurement->GetContour(0)->byteSize());
+
+  cache.FindOrCreate(path, false, 8.f);
+  EXPECT_EQ(cache.GetEntryCount(), 2u);
+  EXPECT_GT(cache.GetCachedBytes(), bytes);
+
+  // Shrinking the budget evicts the least recently used measurement.
+  cache.FindOrCreate(path, false, 1.f);
+  cache.SetMaxBytes(bytes);
+  EXPECT_EQ(cache.GetEntryCount(), 1u);
+  EXPECT_EQ(cache.GetCachedBytes(), bytes);
+  EXPECT_EQ(cache.FindOrCreate(path, false, 1.f), measurement);
+
+  cache.SetMaxBytes(skity::ContourMeasureCache::kDefaultMaxBytes);
+  cache.Clear();
+  EXPECT_EQ(cache.GetCachedBytes(), 0u);
+}
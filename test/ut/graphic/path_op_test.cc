@@ -0,0 +1,176 @@
+// Copyright 2021 The Lynx Authors. All rights reserved.
+// Licensed under the Apache License Version 2.0 that can be found in the
+// LICENSE file in the root directory of this source tree.
+
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include <skity/geometry/scalar.hpp>
+#include <skity/graphic/path.hpp>
+#include <skity/graphic/path_op.hpp>
+#include <thread>
+#include <vector>
+
+#include "src/graphic/pathop/path_op_engine.hpp"
+
+namespace skity {
+namespace {
+
+Path MakeSquare(float left, float top, float size, bool clockwise = true) {
+  Path path;
+  path.MoveTo(left, top);
+  if (clockwise) {
+    path.LineTo(left + size, top);
+    path.LineTo(left + size, top + size);
+    path.LineTo(left, top + size);
+  } else {
+    path.LineTo(left, top + size);
+    path.LineTo(left + size, top + size);
+    path.LineTo(left + size, top);
+  }
+  path.Close();
+  return path;
+}
+
+Path MakeOctagon(float cx, float cy, float radius) {
+  Path path;
+  for (int32_t i = 0; i < 8; i++) {
+    float angle = i * FloatPI / 4.f;
+    float x = cx + radius * std::cos(angle);
+    float y = cy + radius * std::sin(angle);
+    if (i == 0) {
+      path.MoveTo(x, y);
+    } else {
+      path.LineTo(x, y);
+    }
+  }
+  path.Close();
+  return path;
+}
+
+int32_t CountContours(const Path& path) {
+  int32_t count = 0;
+  Path::Iter iter(path, false);
+  Point pts[4];
+  for (auto verb = iter.Next(pts); verb != Path::Verb::kDone;
+       verb = iter.Next(pts)) {
+    if (verb == Path::Verb::kMove) {
+      count++;
+    }
+  }
+  return count;
+}
+
+TEST(PathOpUnion, MergesOverlappingPaths) {
+  std::vector<Path> paths = {
+      MakeSquare(0, 0, 10),
+      MakeSquare(5, 5, 10),
+      MakeSquare(10, 10, 10),
+  };
+
+  Path result;
+  ASSERT_TRUE(PathOp::Union(paths, &result));
+
+  EXPECT_EQ(CountContours(result), 1);
+  EXPECT_EQ(result.GetBounds(), Rect::MakeLTRB(0, 0, 20, 20));
+
+  Path folded;
+  ASSERT_TRUE(PathOp::Execute(paths[0], paths[1], PathOp::Op::kUnion, &folded));
+  ASSERT_TRUE(PathOp::Execute(folded, paths[2], PathOp::Op::kUnion, &folded));
+  EXPECT_EQ(CountContours(folded), CountContours(result));
+  EXPECT_EQ(folded.GetBounds(), result.GetBounds());
+}
+
+TEST(PathOpUnion, KeepsDisjointPathsApart) {
+  std::vector<Path> paths;
+  for (int32_t i = 0; i < 100; i++) {
+    paths.emplace_back(MakeSquare(i * 20.f, (i % 7) * 20.f, 10));
+  }
+
+  Path result;
+  ASSERT_TRUE(PathOp::Union(paths, &result));
+
+  EXPECT_EQ(CountContours(result), 100);
+  EXPECT_EQ(result.GetBounds(), Rect::MakeLTRB(0, 0, 99 * 20 + 10, 130));
+}
+
+TEST(PathOpUnion, OppositeDirectionsDoNotCancel) {
+  std::vector<Path> paths = {
+      MakeSquare(0, 0, 10, true),
+      MakeSquare(0, 0, 10, false),
+  };
+
+  Path result;
+  ASSERT_TRUE(PathOp::Union(paths, &result));
+
+  EXPECT_EQ(CountContours(result), 1);
+  EXPECT_EQ(result.GetBounds(), Rect::MakeLTRB(0, 0, 10, 10));
+}
+
+TEST(PathOpUnion, ManyOverlappingPaths) {
+  // A long chain of overlapping squares spans many chunks of one group.
+  std::vector<Path> paths;
+  for (int32_t i = 0; i < 500; i++) {
+    paths.emplace_back(MakeSquare(i * 5.f, 0, 10));
+  }
+
+  Path result;
+  ASSERT_TRUE(PathOp::Union(paths, &result));
+
+  EXPECT_EQ(CountContours(result), 1);
+  EXPECT_EQ(result.GetBounds(), Rect::MakeLTRB(0, 0, 499 * 5 + 10, 10));
+}
+
+TEST(PathOpUnion, LargeInputsMatchFoldedExecute) {
+  // A 40 x 25 grid of octagons close enough that neighbours overlap and no
+  // holes are left between them, 8000 points in one group of 32 chunks.
+  std::vector<Path> paths;
+  size_t point_count = 0;
+  for (int32_t i = 0; i < 1000; i++) {
+    paths.emplace_back(MakeOctagon((i % 40) * 8.f, (i / 40) * 8.f, 7.f));
+    point_count += paths.back().CountPoints();
+  }
+  ASSERT_GT(point_count, 2 * PathOpEngine::kMinPointsPerUnionThread);
+  if (std::thread::hardware_concurrency() > 1) {
+    EXPECT_GT(PathOpEngine::GetUnionThreadCount(paths.size(), point_count),
+              1u);
+  }
+
+  Path result;
+  ASSERT_TRUE(PathOp::Union(paths, &result));
+
+  Path folded = paths[0];
+  for (size_t i = 1; i < paths.size(); i++) {
+    ASSERT_TRUE(
+        PathOp::Execute(folded, paths[i], PathOp::Op::kUnion, &folded));
+  }
+
+  EXPECT_EQ(CountContours(result), 1);
+  EXPECT_EQ(CountContours(folded), CountContours(result));
+  EXPECT_EQ(folded.GetBounds(), result.GetBounds());
+}
+
+TEST(PathOpUnion, SmallInputsStayOnCallingThread) {
+  const size_t min_points = PathOpEngine::kMinPointsPerUnionThread;
+
+  // A handful of squares is not worth starting a thread for.
+  EXPECT_EQ(PathOpEngine::GetUnionThreadCount(3, 12), 1u);
+  EXPECT_EQ(PathOpEngine::GetUnionThreadCount(2, min_points * 2 - 1), 1u);
+  EXPECT_EQ(PathOpEngine::GetUnionThreadCount(0, 0), 1u);
+  // One task can not be split, however large it is.
+  EXPECT_EQ(PathOpEngine::GetUnionThreadCount(1, min_points * 64), 1u);
+
+  size_t threads = PathOpEngine::GetUnionThreadCount(64, min_points * 64);
+  EXPECT_GE(threads, 1u);
+  EXPECT_LE(threads, 8u);
+}
+
+TEST(PathOpUnion, RejectsEmptyInput) {
+  Path result;
+  EXPECT_FALSE(PathOp::Union({}, &result));
+  EXPECT_FALSE(PathOp::Union({Path{}}, &result));
+  EXPECT_FALSE(PathOp::Union({MakeSquare(0, 0, 10)}, nullptr));
+}
+
+}  // namespace
+}  // namespace skity
@@ -0,0 +1,130 @@
+// Copyright 2021 The Lynx Authors. All rights reserved.
+// Licensed under the Apache License Version 2.0 that can be found in the
+// LICENSE file in the root directory of this source tree.
+
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <skity/io/data.hpp>
+#include <skity/io/picture.hpp>
+#include <skity/io/stream.hpp>
+#include <skity/recorder/picture_recorder.hpp>
+#include <skity/render/canvas.hpp>
+#include <string>
+#include <vector>
+
+using namespace skity;
+
+namespace {
+
+class MemoryWriteStream : public WriteStream {
+ public:
+  bool Write(void const* buffer, size_t size) override {
+    auto bytes = static_cast<const uint8_t*>(buffer);
+    bytes_.insert(bytes_.end(), bytes, bytes + size);
+    return true;
+  }
+
+  bool Flush() override { return true; }
+
+  size_t BytesWritten() const override { return bytes_.size(); }
+
+  std::shared_ptr<Data> CopyData() const {
+    return Data::MakeWithCopy(bytes_.data(), bytes_.size());
+  }
+
+ private:
+  std::vector<uint8_t> bytes_ = {};
+};
+
+// Only save, clip and restore, so nothing is flattened into the buffer
+// section and it is written with a size of 0.
+std::unique_ptr<Picture> MakePictureWithoutFlattenables() {
+  PictureRecorder recorder;
+  recorder.BeginRecording(Rect::MakeWH(100, 100));
+
+  auto canvas = recorder.GetRecordingCanvas();
+  canvas->Save();
+  canvas->ClipRect(Rect::MakeLTRB(10, 10, 50, 50));
+  canvas->Restore();
+
+  auto display_list = recorder.FinishRecording();
+  return Picture::MakeFromDisplayList(display_list.get());
+}
+
+}  // namespace
+
+TEST(PictureTest, ReadDataOfZeroBytesIsEmpty) {
+  uint8_t bytes[] = {1, 2, 3};
+  auto stream =
+      ReadStream::CreateFromData(Data::MakeWithCopy(bytes, sizeof(bytes)));
+  ASSERT_NE(stream, nullptr);
+
+  auto empty = stream->ReadData(0);
+  ASSERT_NE(empty, nullptr);
+  EXPECT_EQ(empty->Size(), 0u);
+
+  EXPECT_NE(stream->ReadData(3), nullptr);
+  EXPECT_NE(stream->ReadData(0), nullptr);
+  EXPECT_EQ(stream->ReadData(1), nullptr);
+}
+
+TEST(PictureTest, RoundTripWithoutFlattenablesFromMemory) {
+  auto picture = MakePictureWithoutFlattenables();
+  ASSERT_NE(picture, nullptr);
+
+  MemoryWriteStream write_stream;
+  picture->Serialize(write_stream, nullptr);
+  ASSERT_GT(write_stream.BytesWritten(), 0u);
+
+  auto read_stream = ReadStream::CreateFromData(write_stream.CopyData());
+  ASSERT_NE(read_stream, nullptr);
+
+  auto loaded = Picture::MakeFromStream(*read_stream);
+  ASSERT_NE(loaded, nullptr);
+  EXPECT_EQ(loaded->GetCullRect(), picture->GetCullRect());
+}
+
+TEST(PictureTest, RoundTripWithoutFlattenablesFromFile) {
+  auto picture = MakePictureWithoutFlattenables();
+  ASSERT_NE(picture, nullptr);
+
+  auto path = std::filesystem::temp_directory_path() /
+              "skity_picture_without_flattenables.skp";
+  {
+    auto write_stream = WriteStream::CreateFileStream(path.string());
+    ASSERT_NE(write_stream, nullptr);
+    picture->Serialize(*write_stream, nullptr);
+    write_stream->Flush();
+  }
+
+  // The file stream reads through the copying ReadStream::ReadData.
+  auto read_stream = ReadStream::CreateFromFile(path.string());
+  ASSERT_NE(read_stream, nullptr);
+  auto loaded = Picture::MakeFromStream(*read_stream);
+  read_stream.reset();
+
+  std::error_code ec;
+  std::filesystem::remove(path, ec);
+
+  ASSERT_NE(loaded, nullptr);
+  EXPECT_EQ(loaded->GetCullRect(), picture->GetCullRect());
+}
+
+TEST(PictureTest, FactorySetIndicesStayStable) {
+  FactorySet factory_set;
+  EXPECT_EQ(factory_set.AddFactory("SkColorShader"), 1);
+  EXPECT_EQ(factory_set.AddFactory("SkImageShader"), 2);
+  EXPECT_EQ(factory_set.AddFactory("SkColorShader"), 1);
+  EXPECT_EQ(factory_set.GetFactoryCount(), 2u);
+
+  // GetFactoryName is 0 based while AddFactory returns 1 based indices.
+  EXPECT_EQ(factory_set.GetFactoryName(1), "SkImageShader");
+  EXPECT_EQ(factory_set.GetFactoryName(2), "");
+
+  TypefaceSet typeface_set;
+  EXPECT_EQ(typeface_set.GetTypefaceCount(), 0u);
+  EXPECT_EQ(typeface_set.GetTypeface(0), nullptr);
+}
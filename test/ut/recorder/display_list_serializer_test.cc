@@ -0,0 +1,287 @@
+// Copyright 2021 The Lynx Authors. All rights reserved.
+// Licensed under the Apache License Version 2.0 that can be found in the
+// LICENSE file in the root directory of this source tree.
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cstring>
+#include <skity/effect/shader.hpp>
+#include <skity/recorder/picture_recorder.hpp>
+#include <skity/skity.hpp>
+#include <utility>
+#include <vector>
+
+using testing::_;
+
+namespace {
+
+class MockCanvas : public skity::Canvas {
+ public:
+  MOCK_METHOD(void, OnClipPath,
+              (skity::Path const& path, skity::Canvas::ClipOp op), (override));
+  MOCK_METHOD(void, OnSave, (), (override));
+  MOCK_METHOD(void, OnRestore, (), (override));
+  MOCK_METHOD(void, OnRestoreToCount, (int saveCount), (override));
+  MOCK_METHOD(void, OnTranslate, (float dx, float dy), (override));
+  MOCK_METHOD(void, OnDrawRect,
+              (skity::Rect const& rect, skity::Paint const& paint), (override));
+  MOCK_METHOD(void, OnDrawPath,
+              (skity::Path const& path, skity::Paint const& paint), (override));
+  MOCK_METHOD(void, OnSaveLayer,
+              (const skity::Rect& bounds, const skity::Paint& paint),
+              (override));
+  MOCK_METHOD(void, OnDrawBlob,
+              (const skity::TextBlob* blob, float x, float y,
+               skity::Paint const& paint),
+              (override));
+  MOCK_METHOD(void, OnDrawImageRect,
+              (std::shared_ptr<skity::Image> image, const skity::Rect& src,
+               const skity::Rect& dst, const skity::SamplingOptions& sampling,
+               skity::Paint const* paint),
+              (override));
+  MOCK_METHOD(void, OnDrawGlyphs,
+              (uint32_t count, const skity::GlyphID glyphs[],
+               const float position_x[], const float position_y[],
+               const skity::Font& font, const skity::Paint& paint),
+              (override));
+  MOCK_METHOD(void, OnDrawPaint, (skity::Paint const& paint), (override));
+  MOCK_METHOD(void, OnFlush, (), (override));
+  MOCK_METHOD(uint32_t, OnGetWidth, (), (const, override));
+  MOCK_METHOD(uint32_t, OnGetHeight, (), (const, override));
+};
+
+skity::Path MakeTrianglePath() {
+  skity::Path path;
+  path.MoveTo(30, 30);
+  path.LineTo(60, 60);
+  path.ConicTo(45, 70, 30, 60, 0.5f);
+  path.Close();
+  path.SetFillType(skity::Path::PathFillType::kEvenOdd);
+  return path;
+}
+
+std::shared_ptr<skity::Image> MakeCheckerImage() {
+  auto pixmap = std::make_shared<skity::Pixmap>(4, 4);
+  auto pixels = static_cast<uint32_t*>(pixmap->WritableAddr());
+  for (uint32_t i = 0; i < 16; i++) {
+    pixels[i] = (i % 2) ? 0xFF0000FF : 0xFFFFFFFF;
+  }
+  return skity::Image::MakeImage(pixmap);
+}
+
+std::unique_ptr<skity::DisplayList> RecordScene(bool build_rtree) {
+  skity::PictureRecorder recorder;
+  skity::DisplayListBuildOptions options;
+  options.build_rtree = build_rtree;
+  recorder.BeginRecording(skity::Rect::MakeLTRB(0, 0, 200, 200), options);
+  auto canvas = recorder.GetRecordingCanvas();
+
+  skity::Paint red;
+  red.SetColor(skity::Color_RED);
+
+  canvas->Save();
+  canvas->Translate(10, 5);
+  canvas->ClipPath(MakeTrianglePath());
+  canvas->DrawRect(skity::Rect::MakeLTRB(10, 10, 40, 40), red);
+  canvas->Restore();
+
+  skity::Point pts[2] = {{0, 0, 0, 1}, {100, 0, 0, 1}};
+  skity::Vec4 colors[2] = {{1, 0, 0, 1}, {0, 0, 1, 1}};
+  skity::Paint gradient;
+  gradient.SetShader(skity::Shader::MakeLinear(pts, colors, nullptr, 2));
+  canvas->SaveLayer(skity::Rect::MakeLTRB(0, 0, 100, 100), skity::Paint{});
+  canvas->DrawPath(MakeTrianglePath(), gradient);
+  // Same paint and path again, shared in the serialized tables.
+  canvas->DrawPath(MakeTrianglePath(), gradient);
+  canvas->Restore();
+
+  canvas->DrawImage(MakeCheckerImage(),
+                    skity::Rect::MakeLTRB(120, 120, 160, 160));
+
+  skity::GlyphID glyphs[3] = {1, 2, 3};
+  float pos_x[3] = {150, 160, 170};
+  float pos_y[3] = {20, 20, 20};
+  canvas->DrawGlyphs(3, glyphs, pos_x, pos_y, skity::Font{}, red);
+
+  return recorder.FinishRecording();
+}
+
+}  // namespace
+
+TEST(DisplayListSerializer, RoundTrip) {
+  auto display_list = RecordScene(false);
+  auto data = display_list->Serialize();
+  ASSERT_NE(data, nullptr);
+
+  auto loaded = skity::DisplayList::MakeFromData(data);
+  ASSERT_NE(loaded, nullptr);
+  EXPECT_EQ(loaded->OpCount(), display_list->OpCount());
+  EXPECT_EQ(loaded->GetBounds(), display_list->GetBounds());
+  EXPECT_EQ(loaded->HasSaveLayer(), display_list->HasSaveLayer());
+  EXPECT_EQ(loaded->HasShader(), display_list->HasShader());
+
+  testing::StrictMock<MockCanvas> mock_canvas;
+  testing::InSequence sequence;
+  EXPECT_CALL(mock_canvas, OnSave()).Times(1);
+  EXPECT_CALL(mock_canvas, OnTranslate(10, 5)).Times(1);
+  EXPECT_CALL(mock_canvas, OnClipPath(MakeTrianglePath(), _)).Times(1);
+  EXPECT_CALL(mock_canvas, OnDrawRect(skity::Rect::MakeLTRB(10, 10, 40, 40),
+                                      _))
+      .WillOnce([](const skity::Rect&, const skity::Paint& paint) {
+        EXPECT_EQ(paint.GetColor(), skity::Color_RED);
+      });
+  EXPECT_CALL(mock_canvas, OnRestore()).Times(1);
+  EXPECT_CALL(mock_canvas, OnSaveLayer(skity::Rect::MakeLTRB(0, 0, 100, 100),
+                                       _))
+      .Times(1);
+  EXPECT_CALL(mock_canvas, OnDrawPath(MakeTrianglePath(), _))
+      .Times(2)
+      .WillRepeatedly([](const skity::Path&, const skity::Paint& paint) {
+        skity::Shader::GradientInfo info;
+        ASSERT_NE(paint.GetShader(), nullptr);
+        EXPECT_EQ(paint.GetShader()->AsGradient(&info),
+                  skity::Shader::kLinear);
+        EXPECT_EQ(info.color_count, 2);
+        EXPECT_EQ(info.point[1].x, 100);
+      });
+  EXPECT_CALL(mock_canvas, OnRestore()).Times(1);
+  EXPECT_CALL(mock_canvas, OnDrawImageRect(_, _, _, _, _))
+      .WillOnce([](std::shared_ptr<skity::Image> image, const skity::Rect&,
+                   const skity::Rect& dst, const skity::SamplingOptions&,
+                   const skity::Paint*) {
+        EXPECT_EQ(dst, skity::Rect::MakeLTRB(120, 120, 160, 160));
+        ASSERT_NE(image->GetPixmap(), nullptr);
+        const auto& pixmap = *image->GetPixmap();
+        EXPECT_EQ(pixmap->Width(), 4u);
+        EXPECT_EQ(pixmap->Height(), 4u);
+        auto pixels = static_cast<const uint32_t*>(pixmap->Addr());
+        EXPECT_EQ(pixels[0], 0xFFFFFFFF);
+        EXPECT_EQ(pixels[1], 0xFF0000FF);
+      });
+  EXPECT_CALL(mock_canvas, OnDrawGlyphs(3, _, _, _, _, _))
+      .WillOnce([](uint32_t, const skity::GlyphID glyphs[],
+                   const float position_x[], const float position_y[],
+                   const skity::Font&, const skity::Paint&) {
+        EXPECT_EQ(glyphs[2], 3);
+        EXPECT_EQ(position_x[1], 160);
+        EXPECT_EQ(position_y[0], 20);
+      });
+  loaded->Draw(&mock_canvas);
+}
+
+TEST(DisplayListSerializer, RoundTripKeepsRTree) {
+  auto display_list = RecordScene(true);
+  auto loaded = skity::DisplayList::MakeFromData(display_list->Serialize());
+  ASSERT_NE(loaded, nullptr);
+
+  const auto query = skity::Rect::MakeLTRB(110, 110, 170, 170);
+  auto expected = display_list->Search(query);
+  auto actual = loaded->Search(query);
+  ASSERT_EQ(actual.size(), expected.size());
+  ASSERT_FALSE(actual.empty());
+  for (size_t i = 0; i < actual.size(); i++) {
+    EXPECT_EQ(actual[i].GetValue(), expected[i].GetValue());
+  }
+}
+
+TEST(DisplayListSerializer, EmptyDisplayList) {
+  skity::PictureRecorder recorder;
+  recorder.BeginRecording(skity::Rect::MakeLTRB(0, 0, 100, 100));
+  auto display_list = recorder.FinishRecording();
+
+  auto loaded = skity::DisplayList::MakeFromData(display_list->Serialize());
+  ASSERT_NE(loaded, nullptr);
+  EXPECT_TRUE(loaded->Empty());
+}
+
+TEST(DisplayListSerializer, RejectsMalformedData) {
+  auto data = RecordScene(true)->Serialize();
+  ASSERT_NE(data, nullptr);
+
+  EXPECT_EQ(skity::DisplayList::MakeFromData(nullptr), nullptr);
+  EXPECT_EQ(skity::DisplayList::MakeFromData(skity::Data::MakeEmpty()),
+            nullptr);
+
+  for (size_t size : {size_t{16}, data->Size() / 2, data->Size() - 1}) {
+    auto truncated = skity::Data::MakeWithCopy(data->RawData(), size);
+    EXPECT_EQ(skity::DisplayList::MakeFromData(truncated), nullptr) << size;
+  }
+
+  std::vector<uint8_t> bytes(data->Bytes(), data->Bytes() + data->Size());
+  bytes[0] ^= 0xFF;
+  EXPECT_EQ(skity::DisplayList::MakeFromData(
+                skity::Data::MakeWithCopy(bytes.data(), bytes.size())),
+            nullptr);
+}
+
+TEST(DisplayListSerializer, RejectsMalformedImages) {
+  skity::PictureRecorder recorder;
+  recorder.BeginRecording(skity::Rect::MakeLTRB(0, 0, 100, 100));
+  recorder.GetRecordingCanvas()->DrawImage(MakeCheckerImage(),
+                                           skity::Rect::MakeLTRB(0, 0, 4, 4));
+  auto data = recorder.FinishRecording()->Serialize();
+  ASSERT_NE(data, nullptr);
+  ASSERT_NE(skity::DisplayList::MakeFromData(data), nullptr);
+
+  // The image record is width, height, alpha type, color type and row bytes.
+  const uint32_t record[6] = {4,
+                              4,
+                              skity::kUnpremul_AlphaType,
+                              static_cast<uint32_t>(skity::ColorType::kRGBA),
+                              16,
+                              0};
+  std::vector<uint8_t> bytes(data->Bytes(), data->Bytes() + data->Size());
+  auto it = std::search(bytes.begin(), bytes.end(),
+                        reinterpret_cast<const uint8_t*>(record),
+                        reinterpret_cast<const uint8_t*>(record) +
+                            sizeof(record));
+  ASSERT_NE(it, bytes.end());
+  size_t offset = static_cast<size_t>(it - bytes.begin());
+
+  // Image count, unknown alpha type, unknown color type and row bytes smaller
+  // than the width in pixels.
+  const std::pair<size_t, uint32_t> patches[] = {
+      {offset - 8, 0xFFFFFFFF},
+      {offset + 8, 99},
+      {offset + 12, 99},
+      {offset + 16, 15},
+  };
+  for (const auto& patch : patches) {
+    std::vector<uint8_t> tampered = bytes;
+    std::memcpy(tampered.data() + patch.first, &patch.second, sizeof(uint32_t));
+    EXPECT_EQ(skity::DisplayList::MakeFromData(skity::Data::MakeWithCopy(
+                  tampered.data(), tampered.size())),
+              nullptr)
+        << patch.first - offset;
+  }
+}
+
+TEST(DisplayListSerializer, RoundTripNestedDisplayList) {
+  std::shared_ptr<skity::DisplayList> child = RecordScene(false);
+
+  skity::PictureRecorder recorder;
+  recorder.BeginRecording(skity::Rect::MakeLTRB(0, 0, 400, 400));
+  auto canvas = recorder.GetRecordingCanvas();
+  canvas->DrawDisplayList(child);
+  canvas->Translate(200, 0);
+  canvas->DrawDisplayList(child);
+  auto display_list = recorder.FinishRecording();
+
+  auto data = display_list->Serialize();
+  ASSERT_NE(data, nullptr);
+  // The shared child is stored once.
+  EXPECT_LT(data->Size(), child->Serialize()->Size() * 2);
+
+  auto loaded = skity::DisplayList::MakeFromData(data);
+  ASSERT_NE(loaded, nullptr);
+  EXPECT_EQ(loaded->GetBounds(), display_list->GetBounds());
+  EXPECT_TRUE(loaded->HasSaveLayer());
+
+  MockCanvas mock_canvas;
+  EXPECT_CALL(mock_canvas, OnDrawPath(MakeTrianglePath(), _)).Times(4);
+  EXPECT_CALL(mock_canvas, OnDrawImageRect(_, _, _, _, _)).Times(2);
+  EXPECT_CALL(mock_canvas, OnDrawGlyphs(3, _, _, _, _, _)).Times(2);
+  loaded->Draw(&mock_canvas);
+}
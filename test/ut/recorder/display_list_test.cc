@@ -11,6 +11,7 @@
 #include <skity/effect/shader.hpp>
 #include <skity/recorder/picture_recorder.hpp>
 #include <skity/skity.hpp>
+#include <thread>
 
 using testing::_;
 
@@ -935,3 +936,90 @@ TEST(DisplayList, CheckPropertiesWithDrawPaint) {
   auto display_list = recorder.FinishRecording();
   EXPECT_TRUE(display_list->HasShader());
 }
+
+std::shared_ptr<skity::DisplayList> RecordChildDisplayList(
+    const skity::Rect& rect, const skity::Paint& paint) {
+  skity::PictureRecorder recorder;
+  recorder.BeginRecording();
+  auto canvas = recorder.GetRecordingCanvas();
+  canvas->Translate(1, 1);
+  canvas->DrawRect(rect, paint);
+  return recorder.FinishRecording();
+}
+
+TEST(DisplayList, DrawDisplayList) {
+  skity::Paint paint;
+  skity::Point pts[] = {skity::Point(0.f, 0.f, 0.f, 1.f),
+                        skity::Point(10.f, 10.f, 0.f, 1.f)};
+  skity::Vec4 colors[] = {skity::Vec4(1.f, 0.f, 0.f, 1.f),
+                          skity::Vec4(0.f, 0.f, 1.f, 1.f)};
+  paint.SetShader(skity::Shader::MakeLinear(pts, colors, nullptr, 2));
+  auto child =
+      RecordChildDisplayList(skity::Rect::MakeLTRB(10, 10, 20, 20), paint);
+  EXPECT_EQ(child->GetBounds(), skity::Rect::MakeLTRB(11, 11, 21, 21));
+
+  skity::PictureRecorder recorder;
+  recorder.BeginRecording(skity::Rect::MakeLTRB(0, 0, 100, 100));
+  auto canvas = recorder.GetRecordingCanvas();
+  canvas->Translate(50, 0);
+  canvas->DrawDisplayList(child);
+  canvas->DrawDisplayList(nullptr);
+  auto display_list = recorder.FinishRecording();
+
+  EXPECT_EQ(display_list->GetBounds(), skity::Rect::MakeLTRB(61, 11, 71, 21));
+  EXPECT_TRUE(display_list->HasShader());
+  EXPECT_EQ(display_list->OpCount(), 2u);
+
+  testing::StrictMock<MockCanvas> mock_canvas;
+  testing::InSequence sequence;
+  EXPECT_CALL(mock_canvas, OnTranslate(50, 0)).Times(1);
+  EXPECT_CALL(mock_canvas, OnSave()).Times(1);
+  EXPECT_CALL(mock_canvas, OnTranslate(1, 1)).Times(1);
+  EXPECT_CALL(mock_canvas, OnDrawRect(skity::Rect::MakeLTRB(10, 10, 20, 20), _))
+      .Times(1);
+  EXPECT_CALL(mock_canvas, OnRestore()).Times(1);
+  display_list->Draw(&mock_canvas);
+}
+
+TEST(DisplayList, DrawDisplayListRecordedOnThreads) {
+  constexpr int kChildCount = 4;
+  std::vector<std::shared_ptr<skity::DisplayList>> children(kChildCount);
+  std::vector<std::thread> threads;
+  for (int i = 0; i < kChildCount; i++) {
+    threads.emplace_back([i, &children] {
+      children[i] = RecordChildDisplayList(
+          skity::Rect::MakeXYWH(i * 20.f, 0, 10, 10), skity::Paint{});
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+
+  skity::PictureRecorder recorder;
+  skity::DisplayListBuildOptions options;
+  options.build_rtree = true;
+  recorder.BeginRecording(skity::Rect::MakeLTRB(0, 0, 100, 100), options);
+  auto canvas = recorder.GetRecordingCanvas();
+  std::vector<int32_t> child_offsets;
+  for (const auto& child : children) {
+    canvas->DrawDisplayList(child);
+    child_offsets.push_back(canvas->GetLastOpOffset().GetValue());
+  }
+  auto display_list = recorder.FinishRecording();
+
+  EXPECT_EQ(display_list->GetBounds(), skity::Rect::MakeLTRB(1, 1, 71, 11));
+  EXPECT_THAT(SearchDisplayListOffsets(display_list.get(),
+                                       skity::Rect::MakeLTRB(0, 0, 100, 100)),
+              testing::ElementsAreArray(child_offsets));
+  EXPECT_THAT(SearchDisplayListOffsets(display_list.get(),
+                                       skity::Rect::MakeXYWH(42, 2, 2, 2)),
+              testing::ElementsAre(child_offsets[2]));
+
+  MockCanvas mock_canvas;
+  EXPECT_CALL(mock_canvas, OnSave()).Times(1);
+  EXPECT_CALL(mock_canvas, OnTranslate(1, 1)).Times(1);
+  EXPECT_CALL(mock_canvas, OnDrawRect(skity::Rect::MakeXYWH(40, 0, 10, 10), _))
+      .Times(1);
+  EXPECT_CALL(mock_canvas, OnRestore()).Times(1);
+  display_list->Draw(&mock_canvas, skity::Rect::MakeXYWH(42, 2, 2, 2));
+}
@@ -0,0 +1,359 @@
+// Copyright 2021 The Lynx Authors. All rights reserved.
+// Licensed under the Apache License Version 2.0 that can be found in the
+// LICENSE file in the root directory of this source tree.
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <cstdlib>
+#include <functional>
+#include <skity/recorder/picture_recorder.hpp>
+#include <skity/recorder/raster_cache.hpp>
+#include <skity/skity.hpp>
+#include <vector>
+
+using testing::_;
+
+namespace {
+
+class MockCanvas : public skity::Canvas {
+ public:
+  MOCK_METHOD(void, OnClipPath,
+              (skity::Path const& path, skity::Canvas::ClipOp op), (override));
+  MOCK_METHOD(void, OnSave, (), (override));
+  MOCK_METHOD(void, OnRestore, (), (override));
+  MOCK_METHOD(void, OnRestoreToCount, (int saveCount), (override));
+  MOCK_METHOD(void, OnDrawRect,
+              (skity::Rect const& rect, skity::Paint const& paint), (override));
+  MOCK_METHOD(void, OnDrawPath,
+              (skity::Path const& path, skity::Paint const& paint), (override));
+  MOCK_METHOD(void, OnSaveLayer,
+              (const skity::Rect& bounds, const skity::Paint& paint),
+              (override));
+  MOCK_METHOD(void, OnDrawBlob,
+              (const skity::TextBlob* blob, float x, float y,
+               skity::Paint const& paint),
+              (override));
+  MOCK_METHOD(void, OnDrawImageRect,
+              (std::shared_ptr<skity::Image> image, const skity::Rect& src,
+               const skity::Rect& dst, const skity::SamplingOptions& sampling,
+               skity::Paint const* paint),
+              (override));
+  MOCK_METHOD(void, OnDrawGlyphs,
+              (uint32_t count, const skity::GlyphID glyphs[],
+               const float position_x[], const float position_y[],
+               const skity::Font& font, const skity::Paint& paint),
+              (override));
+  MOCK_METHOD(void, OnDrawPaint, (skity::Paint const& paint), (override));
+  MOCK_METHOD(void, OnFlush, (), (override));
+  MOCK_METHOD(uint32_t, OnGetWidth, (), (const, override));
+  MOCK_METHOD(uint32_t, OnGetHeight, (), (const, override));
+};
+
+skity::Path MakeCirclePath(float cx, float cy, float r) {
+  skity::Path path;
+  path.AddCircle(cx, cy, r);
+  return path;
+}
+
+// Four paths score 16, which meets the default admission complexity.
+std::unique_ptr<skity::DisplayList> RecordPaths(uint32_t count) {
+  skity::PictureRecorder recorder;
+  recorder.BeginRecording(skity::Rect::MakeLTRB(0, 0, 100, 100));
+  auto canvas = recorder.GetRecordingCanvas();
+  skity::Paint paint;
+  paint.SetColor(skity::Color_BLUE);
+  for (uint32_t i = 0; i < count; i++) {
+    canvas->DrawPath(MakeCirclePath(10.f + i * 10.f, 50, 8), paint);
+  }
+  return recorder.FinishRecording();
+}
+
+std::unique_ptr<skity::DisplayList> Record(
+    const std::function<void(skity::Canvas*)>& draw) {
+  skity::PictureRecorder recorder;
+  recorder.BeginRecording(skity::Rect::MakeLTRB(0, 0, 100, 100));
+  draw(recorder.GetRecordingCanvas());
+  return recorder.FinishRecording();
+}
+
+void DrawCircles(skity::Canvas* canvas, skity::BlendMode mode) {
+  skity::Paint paint;
+  paint.SetColor(skity::ColorSetARGB(0xC0, 0xFF, 0x00, 0x00));
+  paint.SetBlendMode(mode);
+  for (uint32_t i = 0; i < 4; i++) {
+    canvas->DrawPath(MakeCirclePath(30.f + i * 12.f, 50, 16), paint);
+  }
+}
+
+// Plays `display_list` over a backdrop of two colors on a software canvas.
+std::unique_ptr<skity::Bitmap> Render(const skity::DisplayList& display_list,
+                                      skity::RasterCache* cache) {
+  auto bitmap = std::make_unique<skity::Bitmap>(
+      120, 100, skity::AlphaType::kPremul_AlphaType);
+  auto canvas = skity::Canvas::MakeSoftwareCanvas(bitmap.get());
+  canvas->Clear(skity::Color_TRANSPARENT);
+  skity::Paint backdrop;
+  backdrop.SetColor(skity::Color_GREEN);
+  canvas->DrawRect(skity::Rect::MakeLTRB(0, 0, 60, 100), backdrop);
+  backdrop.SetColor(skity::ColorSetARGB(0x80, 0x00, 0x00, 0xFF));
+  canvas->DrawRect(skity::Rect::MakeLTRB(60, 0, 120, 100), backdrop);
+  canvas->Translate(10, 0);
+  if (cache != nullptr) {
+    display_list.Draw(canvas.get(), cache);
+  } else {
+    display_list.Draw(canvas.get());
+  }
+  canvas->Flush();
+  return bitmap;
+}
+
+// Draws through a warmed up cache and expects the pixels of plain playback,
+// up to rounding.
+void ExpectCachedPixelsMatch(const skity::DisplayList& display_list,
+                             skity::RasterCache* cache) {
+  auto expected = Render(display_list, nullptr);
+  Render(display_list, cache);
+  auto actual = Render(display_list, cache);
+
+  const size_t size = expected->GetPixmap()->RowBytes() * 100;
+  const uint8_t* expected_pixels = expected->GetPixelAddr();
+  const uint8_t* actual_pixels = actual->GetPixelAddr();
+  size_t mismatches = 0;
+  for (size_t i = 0; i < size; i++) {
+    mismatches += std::abs(expected_pixels[i] - actual_pixels[i]) > 2;
+  }
+  EXPECT_EQ(mismatches, 0u);
+}
+
+skity::RasterCacheOptions EagerOptions() {
+  skity::RasterCacheOptions options;
+  options.access_threshold = 1;
+  return options;
+}
+
+}  // namespace
+
+TEST(RasterCache, SnapshotAfterAccessThreshold) {
+  auto display_list = RecordPaths(4);
+  skity::RasterCache cache;
+
+  MockCanvas canvas;
+  // Replayed until the third draw takes the snapshot.
+  EXPECT_CALL(canvas, OnDrawPath(_, _)).Times(8);
+  EXPECT_CALL(canvas, OnDrawImageRect(_, _, _, _, _))
+      .Times(2)
+      .WillRepeatedly([](std::shared_ptr<skity::Image> image,
+                         const skity::Rect&, const skity::Rect& dst,
+                         const skity::SamplingOptions&, const skity::Paint*) {
+        ASSERT_NE(image, nullptr);
+        EXPECT_EQ(image->Width(), static_cast<uint32_t>(dst.Width()));
+        EXPECT_EQ(image->Height(), static_cast<uint32_t>(dst.Height()));
+      });
+
+  for (int i = 0; i < 4; i++) {
+    display_list->Draw(&canvas, &cache);
+  }
+  EXPECT_EQ(cache.GetSnapshotCount(), 1u);
+  EXPECT_EQ(cache.GetHitCount(), 1u);
+  EXPECT_GT(cache.GetCachedBytes(), 0u);
+}
+
+TEST(RasterCache, TranslationReusesSnapshot) {
+  auto display_list = RecordPaths(4);
+  skity::RasterCache cache;
+
+  MockCanvas canvas;
+  EXPECT_CALL(canvas, OnDrawPath(_, _)).Times(8);
+  std::vector<skity::Rect> dsts;
+  EXPECT_CALL(canvas, OnDrawImageRect(_, _, _, _, _))
+      .WillRepeatedly([&dsts](std::shared_ptr<skity::Image>,
+                              const skity::Rect&, const skity::Rect& dst,
+                              const skity::SamplingOptions&,
+                              const skity::Paint*) { dsts.push_back(dst); });
+
+  for (int i = 0; i < 3; i++) {
+    display_list->Draw(&canvas, &cache);
+  }
+  canvas.Save();
+  canvas.Translate(20, 30);
+  display_list->Draw(&canvas, &cache);
+  canvas.Restore();
+
+  EXPECT_EQ(cache.GetSnapshotCount(), 1u);
+  EXPECT_EQ(cache.GetHitCount(), 1u);
+  ASSERT_EQ(dsts.size(), 2u);
+  EXPECT_EQ(dsts[1].Left(), dsts[0].Left() + 20);
+  EXPECT_EQ(dsts[1].Top(), dsts[0].Top() + 30);
+}
+
+TEST(RasterCache, ScaleChangeMisses) {
+  auto display_list = RecordPaths(4);
+  skity::RasterCache cache;
+
+  MockCanvas canvas;
+  EXPECT_CALL(canvas, OnDrawImageRect(_, _, _, _, _)).Times(1);
+  EXPECT_CALL(canvas, OnDrawPath(_, _)).Times(12);
+  for (int i = 0; i < 3; i++) {
+    display_list->Draw(&canvas, &cache);
+  }
+  canvas.Save();
+  canvas.Scale(2, 2);
+  display_list->Draw(&canvas, &cache);
+  canvas.Restore();
+  EXPECT_EQ(cache.GetHitCount(), 0u);
+}
+
+TEST(RasterCache, CheapContentIsReplayed) {
+  auto display_list = RecordPaths(1);
+  skity::RasterCache cache;
+
+  MockCanvas canvas;
+  EXPECT_CALL(canvas, OnDrawImageRect(_, _, _, _, _)).Times(0);
+  EXPECT_CALL(canvas, OnDrawPath(_, _)).Times(5);
+  for (int i = 0; i < 5; i++) {
+    display_list->Draw(&canvas, &cache);
+  }
+  EXPECT_EQ(cache.GetSnapshotCount(), 0u);
+}
+
+TEST(RasterCache, EndFrameDropsUnusedEntries) {
+  auto display_list = RecordPaths(4);
+  skity::RasterCacheOptions options;
+  options.access_threshold = 1;
+  options.max_unused_frames = 2;
+  skity::RasterCache cache(nullptr, options);
+
+  MockCanvas canvas;
+  EXPECT_CALL(canvas, OnDrawImageRect(_, _, _, _, _)).Times(1);
+  display_list->Draw(&canvas, &cache);
+  EXPECT_EQ(cache.GetSnapshotCount(), 1u);
+
+  cache.EndFrame();
+  EXPECT_EQ(cache.GetSnapshotCount(), 1u);
+  cache.EndFrame();
+  cache.EndFrame();
+  EXPECT_EQ(cache.GetSnapshotCount(), 0u);
+  EXPECT_EQ(cache.GetCachedBytes(), 0u);
+}
+
+TEST(RasterCache, RespectsByteBudget) {
+  auto first = RecordPaths(4);
+  auto second = RecordPaths(4);
+  MockCanvas canvas;
+  EXPECT_CALL(canvas, OnDrawImageRect(_, _, _, _, _)).Times(3);
+
+  skity::RasterCacheOptions options;
+  options.access_threshold = 1;
+  skity::RasterCache probe(nullptr, options);
+  first->Draw(&canvas, &probe);
+  // Room for a single snapshot of either list.
+  options.max_bytes = probe.GetCachedBytes() + 1;
+  skity::RasterCache cache(nullptr, options);
+
+  first->Draw(&canvas, &cache);
+  second->Draw(&canvas, &cache);
+  EXPECT_EQ(cache.GetSnapshotCount(), 1u);
+  EXPECT_LE(cache.GetCachedBytes(), options.max_bytes);
+}
+
+TEST(RasterCache, CachesSaveLayerScope) {
+  skity::PictureRecorder recorder;
+  recorder.BeginRecording(skity::Rect::MakeLTRB(0, 0, 200, 200));
+  auto recording_canvas = recorder.GetRecordingCanvas();
+  skity::Paint paint;
+  paint.SetColor(skity::Color_RED);
+  // The rects stretch the whole list beyond the largest snapshot, while the
+  // layer scope on its own fits.
+  recording_canvas->DrawRect(skity::Rect::MakeLTRB(150, 150, 160, 160), paint);
+  recording_canvas->SaveLayer(skity::Rect::MakeLTRB(0, 0, 100, 100),
+                              skity::Paint{});
+  for (int i = 0; i < 4; i++) {
+    recording_canvas->DrawPath(MakeCirclePath(10.f + i * 10.f, 50, 8), paint);
+  }
+  recording_canvas->Restore();
+  recording_canvas->DrawRect(skity::Rect::MakeLTRB(170, 170, 180, 180), paint);
+  auto display_list = recorder.FinishRecording();
+
+  skity::RasterCacheOptions options;
+  options.access_threshold = 1;
+  options.max_dimension = 150;
+  skity::RasterCache cache(nullptr, options);
+
+  MockCanvas canvas;
+  EXPECT_CALL(canvas, OnDrawRect(_, _)).Times(2);
+  EXPECT_CALL(canvas, OnSaveLayer(_, _)).Times(0);
+  EXPECT_CALL(canvas, OnDrawPath(_, _)).Times(0);
+  EXPECT_CALL(canvas, OnDrawImageRect(_, _, _, _, _))
+      .WillOnce([](std::shared_ptr<skity::Image>, const skity::Rect&,
+                   const skity::Rect& dst, const skity::SamplingOptions&,
+                   const skity::Paint*) {
+        EXPECT_EQ(dst, skity::Rect::MakeLTRB(0, 0, 100, 100));
+      });
+  display_list->Draw(&canvas, &cache);
+  EXPECT_EQ(cache.GetSnapshotCount(), 1u);
+}
+
+TEST(RasterCache, LayerPaintMatchesPlayback) {
+  std::vector<skity::Paint> layer_paints(4);
+  layer_paints[0].SetBlendMode(skity::BlendMode::kMultiply);
+  layer_paints[1].SetBlendMode(skity::BlendMode::kDstIn);
+  layer_paints[2].SetAlpha(0x80);
+  layer_paints[3].SetColorFilter(skity::ColorFilters::Blend(
+      skity::Color_BLUE, skity::BlendMode::kSrcIn));
+
+  for (const auto& layer_paint : layer_paints) {
+    auto display_list = Record([&](skity::Canvas* canvas) {
+      canvas->SaveLayer(skity::Rect::MakeLTRB(0, 0, 100, 100), layer_paint);
+      DrawCircles(canvas, skity::BlendMode::kSrcOver);
+      canvas->Restore();
+    });
+
+    skity::RasterCache cache(nullptr, EagerOptions());
+    ExpectCachedPixelsMatch(*display_list, &cache);
+    EXPECT_GT(cache.GetHitCount(), 0u);
+  }
+}
+
+TEST(RasterCache, LayerImageFilterMatchesPlayback) {
+  auto display_list = Record([](skity::Canvas* canvas) {
+    skity::Paint layer_paint;
+    layer_paint.SetImageFilter(skity::ImageFilters::Blur(6.f, 6.f));
+    // The blur spreads the circles outside of the layer bounds.
+    canvas->SaveLayer(skity::Rect::MakeLTRB(14, 34, 82, 66), layer_paint);
+    DrawCircles(canvas, skity::BlendMode::kSrcOver);
+    canvas->Restore();
+  });
+
+  skity::RasterCache cache(nullptr, EagerOptions());
+  ExpectCachedPixelsMatch(*display_list, &cache);
+  EXPECT_GT(cache.GetHitCount(), 0u);
+}
+
+TEST(RasterCache, BackdropBlendModesMatchPlayback) {
+  for (auto mode : {skity::BlendMode::kClear, skity::BlendMode::kSrc,
+                    skity::BlendMode::kDstOut, skity::BlendMode::kSrcIn,
+                    skity::BlendMode::kScreen}) {
+    auto display_list =
+        Record([&](skity::Canvas* canvas) { DrawCircles(canvas, mode); });
+
+    skity::RasterCache cache(nullptr, EagerOptions());
+    ExpectCachedPixelsMatch(*display_list, &cache);
+    EXPECT_EQ(cache.GetSnapshotCount(), 0u);
+  }
+}
+
+TEST(RasterCache, BlendModesInsideLayerAreCached) {
+  // A src-over layer starts transparent, so blending inside it does not read
+  // the canvas below.
+  auto display_list = Record([](skity::Canvas* canvas) {
+    canvas->SaveLayer(skity::Rect::MakeLTRB(0, 0, 100, 100), skity::Paint{});
+    DrawCircles(canvas, skity::BlendMode::kSrcOver);
+    DrawCircles(canvas, skity::BlendMode::kDstOut);
+    canvas->Restore();
+  });
+
+  skity::RasterCache cache(nullptr, EagerOptions());
+  ExpectCachedPixelsMatch(*display_list, &cache);
+  EXPECT_GT(cache.GetHitCount(), 0u);
+}
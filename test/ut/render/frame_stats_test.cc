@@ -0,0 +1,114 @@
+// Copyright 2021 The Lynx Authors. All rights reserved.
+// Licensed under the Apache License Version 2.0 that can be found in the
+// LICENSE file in the root directory of this source tree.
+
+#include <gtest/gtest.h>
+
+#include <set>
+#include <skity/graphic/bitmap.hpp>
+#include <skity/graphic/paint.hpp>
+#include <skity/render/canvas.hpp>
+#include <skity/render/frame_stats.hpp>
+#include <string>
+
+#include "src/geometry/stroke_cache.hpp"
+
+namespace skity {
+namespace {
+
+TEST(FrameStatsTest, HistogramBuckets) {
+  EXPECT_EQ(FrameHistogramData::BucketIndex(0), 0u);
+  EXPECT_EQ(FrameHistogramData::BucketIndex(1), 1u);
+  EXPECT_EQ(FrameHistogramData::BucketIndex(2), 2u);
+  EXPECT_EQ(FrameHistogramData::BucketIndex(3), 2u);
+  EXPECT_EQ(FrameHistogramData::BucketIndex(1024), 11u);
+  EXPECT_EQ(FrameHistogramData::BucketIndex(UINT64_MAX),
+            FrameHistogramData::kBucketCount - 1);
+}
+
+TEST(FrameStatsTest, HistogramSummary) {
+  FrameHistogramData histogram;
+  EXPECT_EQ(histogram.ApproximatePercentile(50.f), 0u);
+
+  for (uint64_t value = 1; value <= 100; value++) {
+    histogram.Record(value);
+  }
+
+  EXPECT_EQ(histogram.count, 100u);
+  EXPECT_EQ(histogram.sum, 5050u);
+  EXPECT_EQ(histogram.min, 1u);
+  EXPECT_EQ(histogram.max, 100u);
+  // The median falls in the [32, 64) bucket, the tail is clamped to the max.
+  EXPECT_EQ(histogram.ApproximatePercentile(50.f), 63u);
+  EXPECT_EQ(histogram.ApproximatePercentile(100.f), 100u);
+}
+
+TEST(FrameStatsTest, MergeAndReset) {
+  FrameStats a;
+  a.Increment(FrameCounter::kDrawCalls, 3);
+  a.Record(FrameHistogram::kGlyphsPerDraw, 10);
+
+  FrameStats b;
+  b.Increment(FrameCounter::kDrawCalls);
+  b.Increment(FrameCounter::kMergedDraws, 2);
+  b.Record(FrameHistogram::kGlyphsPerDraw, 4);
+
+  a.Merge(b);
+  EXPECT_EQ(a.GetCounter(FrameCounter::kDrawCalls), 4u);
+  EXPECT_EQ(a.GetCounter(FrameCounter::kMergedDraws), 2u);
+  EXPECT_EQ(a.GetHistogram(FrameHistogram::kGlyphsPerDraw).count, 2u);
+  EXPECT_EQ(a.GetHistogram(FrameHistogram::kGlyphsPerDraw).min, 4u);
+  EXPECT_EQ(a.GetHistogram(FrameHistogram::kGlyphsPerDraw).max, 10u);
+
+  a.Reset();
+  EXPECT_EQ(a.GetCounter(FrameCounter::kDrawCalls), 0u);
+  EXPECT_EQ(a.GetHistogram(FrameHistogram::kGlyphsPerDraw).count, 0u);
+}
+
+TEST(FrameStatsTest, NamesAreUnique) {
+  std::set<std::string> names;
+  for (size_t i = 0; i < FrameStats::kCounterCount; i++) {
+    names.insert(FrameStats::GetCounterName(static_cast<FrameCounter>(i)));
+  }
+  for (size_t i = 0; i < FrameStats::kHistogramCount; i++) {
+    names.insert(FrameStats::GetHistogramName(static_cast<FrameHistogram>(i)));
+  }
+
+  EXPECT_EQ(names.size(),
+            FrameStats::kCounterCount + FrameStats::kHistogramCount);
+  EXPECT_EQ(names.count("unknown"), 0u);
+}
+
+TEST(FrameStatsTest, SoftwareCanvasCountsDraws) {
+  Bitmap bitmap(32, 32, AlphaType::kPremul_AlphaType, ColorType::kRGBA);
+  auto canvas = Canvas::MakeSoftwareCanvas(&bitmap);
+  ASSERT_TRUE(canvas);
+
+  StrokeCache::GetInstance().Clear();
+
+  Paint paint;
+  paint.SetStyle(Paint::kStroke_Style);
+  paint.SetStrokeWidth(3.f);
+
+  Path path;
+  path.MoveTo(2, 2);
+  path.QuadTo(16, 30, 30, 2);
+
+  // A circle goes through DrawOval, and a stroked path through the stroke
+  // cache, each is still one draw call.
+  canvas->DrawCircle(16, 16, 8, Paint{});
+  canvas->DrawPath(path, paint);
+  canvas->DrawPath(path, paint);
+
+  const auto& stats = canvas->GetFrameStats();
+  EXPECT_EQ(stats.GetCounter(FrameCounter::kDrawCalls), 3u);
+  EXPECT_EQ(stats.GetCounter(FrameCounter::kStrokeCacheMisses), 1u);
+  EXPECT_EQ(stats.GetCounter(FrameCounter::kStrokeCacheHits), 1u);
+  EXPECT_EQ(stats.GetCounter(FrameCounter::kPipelineCompiles), 0u);
+
+  canvas->ResetFrameStats();
+  EXPECT_EQ(canvas->GetFrameStats().GetCounter(FrameCounter::kDrawCalls), 0u);
+}
+
+}  // namespace
+}  // namespace skity
@@ -15,6 +15,7 @@
 #include <string>
 #include <vector>
 
+#include "src/effect/color_filter_program.hpp"
 #include "src/effect/pixmap_shader.hpp"
 #include "src/render/hw/draw/fragment/wgsl_gradient_fragment.hpp"
 #include "src/render/hw/draw/fragment/wgsl_solid_color.hpp"
@@ -2068,6 +2069,59 @@ TEST(ShaderWriter, PathAAWithLinearGradient) {
   ASSERT_TRUE(CompareShader(fs, GetLinearGradientAAFS()));
 }
 
+TEST(ShaderWriter, PathWithManyStopLinearGradientSamplesLUT) {
+  auto path = MakePath();
+  skity::Paint paint;
+  std::vector<skity::Vec4> colors;
+  for (int i = 0; i < 100; i++) {
+    colors.emplace_back(i / 99.f, 0.f, 1.f - i / 99.f, 1.f);
+  }
+  std::vector<skity::Point> pts = {
+      skity::Point{0.f, 0.f, 0.f, 1.f},
+      skity::Point{256.f, 0.f, 0.f, 1.f},
+  };
+  paint.SetShader(skity::Shader::MakeLinear(pts.data(), colors.data(), nullptr,
+                                            static_cast<int>(colors.size())));
+
+  skity::WGSLPathGeometry geometry{path, paint, false};
+  skity::Shader::GradientInfo gradient_info;
+  auto gradient_type = paint.GetShader()->AsGradient(&gradient_info);
+  skity::WGSLGradientFragment fragment{gradient_info, gradient_type,
+                                       paint.GetAlphaF(), skity::Matrix{}};
+  skity::HWWGSLShaderWriter shader_writer{&geometry, &fragment};
+  std::string fs = shader_writer.GenFSSourceWGSL();
+  EXPECT_EQ(shader_writer.GetFSShaderName(), "FS_GradientLinearLUT");
+  EXPECT_EQ(fragment.NextBindingIndex(), 4u);
+  EXPECT_EQ(fs.find("colors:"), std::string::npos);
+
+  auto program = wgx::Program::Parse(fs);
+  ASSERT_NE(program, nullptr);
+  ASSERT_FALSE(program->GetDiagnosis().has_value());
+
+  wgx::GlslOptions gles_options;
+  gles_options.standard = wgx::GlslOptions::Standard::kES;
+  gles_options.major_version = 3;
+  auto result = program->WriteToGlsl("fs_main", gles_options);
+  ASSERT_TRUE(result.success);
+
+  const wgx::BindGroup* group = nullptr;
+  for (const auto& bind_group : result.bind_groups) {
+    if (bind_group.group == 1) {
+      group = &bind_group;
+    }
+  }
+  ASSERT_NE(group, nullptr);
+  ASSERT_NE(group->GetEntry(0), nullptr);
+  EXPECT_EQ(group->GetEntry(0)->type_definition->name, "GradientInfo");
+  ASSERT_NE(group->GetEntry(2), nullptr);
+  EXPECT_EQ(group->GetEntry(2)->type, wgx::BindingType::kSampler);
+  ASSERT_NE(group->GetEntry(3), nullptr);
+  EXPECT_EQ(group->GetEntry(3)->type, wgx::BindingType::kTexture);
+
+  wgx::MslOptions msl_options;
+  EXPECT_TRUE(program->WriteToMsl("fs_main", msl_options).success);
+}
+
 TEST(ShaderWriter, PathWithTexture) {
   auto path = MakePath();
   skity::Paint paint;
@@ -2162,6 +2216,110 @@ TEST(ShaderWriter, PathAAWithSolidColorAndColorFilter) {
   ASSERT_TRUE(CompareShader(fs, GetSolidColorAAWithCFFS()));
 }
 
+TEST(ShaderWriter, PathWithSolidColorAndColorFilterProgram) {
+  auto path = MakePath();
+  skity::Paint paint;
+  paint.SetColor(0xff00ff00);
+  skity::Color4f color = paint.GetColor4f();
+  skity::WGSLPathGeometry geometry{path, paint, false};
+  skity::WGSLSolidColor fragment{color};
+  float color_matrix[20] = {0.5f, 0, 0, 0, 0,  //
+                            0,    1, 0, 0, 0,  //
+                            0,    0, 1, 0, 0,  //
+                            0,    0, 0, 1, 0};
+  auto filter = skity::ColorFilters::Compose(
+      skity::ColorFilters::Blend(0x80ff0000, skity::BlendMode::kSrcOver),
+      skity::ColorFilters::Compose(skity::ColorFilters::LinearToSRGBGamma(),
+                                   skity::ColorFilters::Matrix(color_matrix)));
+  skity::ColorFilterProgram program(filter.get());
+  ASSERT_EQ(program.GetOps().size(), 3u);
+  fragment.SetFilter(skity::WGXFilterFragment::Make(filter.get()));
+  skity::HWWGSLShaderWriter shader_writer{&geometry, &fragment};
+  std::string fs = shader_writer.GenFSSourceWGSL();
+
+  auto wgx_program = wgx::Program::Parse(fs);
+  ASSERT_NE(wgx_program, nullptr);
+  ASSERT_FALSE(wgx_program->GetDiagnosis().has_value());
+
+  wgx::GlslOptions gles_options;
+  gles_options.standard = wgx::GlslOptions::Standard::kES;
+  gles_options.major_version = 3;
+  auto result = wgx_program->WriteToGlsl("fs_main", gles_options);
+  ASSERT_TRUE(result.success);
+
+  wgx::StructDefinition* info = nullptr;
+  for (const auto& bind_group : result.bind_groups) {
+    for (const auto& entry : bind_group.entries) {
+      if (bind_group.group == 1 && entry.type_definition &&
+          entry.type_definition->name == "ColorFilterProgramInfo") {
+        info = static_cast<wgx::StructDefinition*>(entry.type_definition.get());
+      }
+    }
+  }
+  ASSERT_NE(info, nullptr);
+
+  // The members SetupBindGroup looks up, one set per step with uniforms.
+  size_t member_count = 0;
+  for (size_t i = 0; i < program.GetOps().size(); i++) {
+    const std::string index = std::to_string(i);
+    switch (program.GetOps()[i].type) {
+      case skity::ColorFilterProgram::OpType::kMatrix:
+        EXPECT_NE(info->GetMember("matrix_mul_" + index), nullptr);
+        EXPECT_NE(info->GetMember("matrix_add_" + index), nullptr);
+        member_count += 2;
+        break;
+      case skity::ColorFilterProgram::OpType::kBlend:
+        EXPECT_NE(info->GetMember("blend_color_" + index), nullptr);
+        member_count += 1;
+        break;
+      default:
+        break;
+    }
+  }
+  EXPECT_EQ(info->members.size(), member_count);
+  EXPECT_EQ(member_count, 3u);
+
+  wgx::MslOptions msl_options;
+  EXPECT_TRUE(wgx_program->WriteToMsl("fs_main", msl_options).success);
+}
+
+TEST(ShaderWriter, PathWithSolidColorAndGammaFilter) {
+  auto path = MakePath();
+  skity::Paint paint;
+  paint.SetColor(0x8000ff00);
+  skity::Color4f color = paint.GetColor4f();
+  skity::WGSLPathGeometry geometry{path, paint, false};
+  skity::WGSLSolidColor fragment{color};
+  auto filter = skity::ColorFilters::LinearToSRGBGamma();
+  auto filter_fragment = skity::WGXFilterFragment::Make(filter.get());
+  ASSERT_NE(filter_fragment, nullptr);
+
+  // Like the program and the software path, gamma runs on unpremultiplied
+  // colors.
+  std::string filter_source = filter_fragment->GenSourceWGSL();
+  auto unpremul = filter_source.find("input_color.rgb / input_color.a");
+  auto gamma = filter_source.find("0.0031308");
+  auto premul = filter_source.find("input_color.rgb * input_color.a");
+  ASSERT_NE(unpremul, std::string::npos);
+  ASSERT_NE(gamma, std::string::npos);
+  ASSERT_NE(premul, std::string::npos);
+  EXPECT_LT(unpremul, gamma);
+  EXPECT_LT(gamma, premul);
+
+  fragment.SetFilter(std::move(filter_fragment));
+  skity::HWWGSLShaderWriter shader_writer{&geometry, &fragment};
+  std::string fs = shader_writer.GenFSSourceWGSL();
+
+  auto wgx_program = wgx::Program::Parse(fs);
+  ASSERT_NE(wgx_program, nullptr);
+  ASSERT_FALSE(wgx_program->GetDiagnosis().has_value());
+
+  wgx::GlslOptions gles_options;
+  gles_options.standard = wgx::GlslOptions::Standard::kES;
+  gles_options.major_version = 3;
+  EXPECT_TRUE(wgx_program->WriteToGlsl("fs_main", gles_options).success);
+}
+
 TEST(ShaderWriter, PathWithSolidColorAndProgrammableBlending) {
   auto path = MakePath();
   skity::Paint paint;
@@ -2231,6 +2389,50 @@ TEST(ShaderWriter, PathWithSolidColorAndTextureCopyProgrammableBlending) {
   ASSERT_NE(fs.find("color = blending(color, dst_color);"), std::string::npos);
 }
 
+TEST(ShaderWriter, PathWithSolidColorAndAnalyticClip) {
+  auto path = MakePath();
+  skity::Paint paint;
+  paint.SetColor(0xff00ff00);
+  skity::Color4f color = paint.GetColor4f();
+  skity::WGSLPathGeometry geometry{path, paint, false};
+  skity::WGSLSolidColor fragment{color};
+  skity::HWAnalyticClipSet clips;
+  clips.count = 2;
+  fragment.SetAnalyticClip(skity::WGXAnalyticClip::Make(&clips));
+  skity::HWWGSLShaderWriter shader_writer{&geometry, &fragment};
+  std::string vs = shader_writer.GenVSSourceWGSL();
+  std::string fs = shader_writer.GenFSSourceWGSL();
+  ASSERT_TRUE(CompareShader(vs, GetPathGeometryVS()));
+  ASSERT_EQ(shader_writer.GetFSShaderName(), "FS_SolidColor_AnalyticClip2");
+  ASSERT_EQ(shader_writer.GetFSKey(),
+            skity::MakeFunctionBaseKey(skity::HWFragmentKeyType::kSolid));
+  EXPECT_EQ(shader_writer.GetPipelineKey().analytic_clip, 2u);
+  skity::WGSLSolidColor plain_fragment{color};
+  EXPECT_NE(shader_writer.GetPipelineKey(),
+            skity::HWWGSLShaderWriter(&geometry, &plain_fragment)
+                .GetPipelineKey());
+  EXPECT_NE(fs.find("@builtin(position) frag_pos: vec4<f32>"),
+            std::string::npos);
+  EXPECT_NE(fs.find("@group(3) @binding(0) var<uniform> uAnalyticClip"),
+            std::string::npos);
+  EXPECT_NE(fs.find("uAnalyticClip.rects[1]"), std::string::npos);
+  EXPECT_NE(
+      fs.find("color = color * analytic_clip_coverage(input.frag_pos.xy);"),
+      std::string::npos);
+
+  auto program = wgx::Program::Parse(fs);
+  ASSERT_NE(program, nullptr);
+  ASSERT_FALSE(program->GetDiagnosis().has_value());
+
+  wgx::GlslOptions gles_options;
+  gles_options.standard = wgx::GlslOptions::Standard::kES;
+  gles_options.major_version = 3;
+  EXPECT_TRUE(program->WriteToGlsl("fs_main", gles_options).success);
+
+  wgx::MslOptions msl_options;
+  EXPECT_TRUE(program->WriteToMsl("fs_main", msl_options).success);
+}
+
 TEST(ShaderWriter, RRectWithSolidColor) {
   auto rrect =
       skity::RRect::MakeRectXY(skity::Rect::MakeLTRB(0, 0, 100, 100), 10, 10);
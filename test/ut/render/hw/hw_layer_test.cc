@@ -0,0 +1,85 @@
+// Copyright 2021 The Lynx Authors. All rights reserved.
+// Licensed under the Apache License Version 2.0 that can be found in the
+// LICENSE file in the root directory of this source tree.
+
+#include "src/render/hw/hw_layer.hpp"
+
+#include <gtest/gtest.h>
+
+#include <memory>
+
+#include "src/render/hw/draw/hw_dynamic_rrect_draw.hpp"
+#include "src/utils/arena_allocator.hpp"
+
+namespace {
+
+using skity::BlendMode;
+using skity::DstReadStrategy;
+using skity::HWBlendPlan;
+using skity::Matrix;
+using skity::Paint;
+using skity::Rect;
+using skity::RRect;
+
+class TestLayer : public skity::HWLayer {
+ public:
+  TestLayer() : HWLayer(Matrix{}, 0, Rect::MakeWH(100, 100), 100, 100) {}
+
+ protected:
+  std::shared_ptr<skity::GPURenderPass> OnBeginRenderPass(
+      skity::GPUCommandBuffer*, bool) override {
+    return nullptr;
+  }
+
+  void OnPostDraw(skity::GPURenderPass*, skity::GPUCommandBuffer*) override {}
+};
+
+skity::HWDraw* AddRRectDrawUnderRRectClip(skity::ArenaAllocator* arena,
+                                          const HWBlendPlan& blend_plan) {
+  auto layer = arena->Make<TestLayer>();
+  layer->SetArenaAllocator(arena);
+
+  RRect clip = RRect::MakeRectXY(Rect::MakeLTRB(10, 10, 90, 90), 20, 20);
+  EXPECT_TRUE(layer->AddAnalyticRRectClip(clip, Matrix{}, 1, false));
+
+  Paint paint;
+  paint.SetBlendMode(blend_plan.blend_mode);
+  RRect rrect = RRect::MakeRectXY(Rect::MakeLTRB(0, 0, 100, 100), 4, 4);
+  auto draw =
+      arena->Make<skity::HWDynamicRRectDraw>(Matrix{}, rrect, std::move(paint));
+  draw->SetBlendPlan(blend_plan);
+  layer->AddDraw(draw);
+  return draw;
+}
+
+}  // namespace
+
+TEST(HWLayer, SrcOverDrawEvaluatesRRectClipAnalytically) {
+  skity::ArenaAllocator arena;
+  auto draw = AddRRectDrawUnderRRectClip(&arena, {BlendMode::kSrcOver});
+
+  EXPECT_NE(draw->GetAnalyticClips(), nullptr);
+  EXPECT_EQ(draw->GetClipDraw(), nullptr);
+}
+
+TEST(HWLayer, OverwritingDrawMaterializesRRectClip) {
+  constexpr BlendMode kModes[] = {BlendMode::kSrc, BlendMode::kClear,
+                                  BlendMode::kSrcIn, BlendMode::kDstIn,
+                                  BlendMode::kModulate};
+  for (auto mode : kModes) {
+    skity::ArenaAllocator arena;
+    auto draw = AddRRectDrawUnderRRectClip(&arena, {mode});
+
+    EXPECT_EQ(draw->GetAnalyticClips(), nullptr);
+    EXPECT_NE(draw->GetClipDraw(), nullptr);
+  }
+}
+
+TEST(HWLayer, DstReadingDrawMaterializesRRectClip) {
+  skity::ArenaAllocator arena;
+  auto draw = AddRRectDrawUnderRRectClip(
+      &arena, {BlendMode::kSrcOver, DstReadStrategy::kFramebufferFetch});
+
+  EXPECT_EQ(draw->GetAnalyticClips(), nullptr);
+  EXPECT_NE(draw->GetClipDraw(), nullptr);
+}
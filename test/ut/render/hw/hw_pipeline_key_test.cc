@@ -430,6 +430,43 @@ TEST(HWPipelineKey, GradientLinear4OffsetFastColorFast) {
   EXPECT_EQ(steps[0]->GetFragmentName(), "FS_GradientLinear4OffsetFast");
 }
 
+TEST(HWPipelineKey, GradientLinearLUT) {
+  Path path;
+  path.MoveTo(10, 10);
+  path.LineTo(100, 100);
+  path.LineTo(200, 10);
+  path.Close();
+
+  Point pts[2]{
+      {10.f, 10.f, 0.f, 1.f},
+      {100.f, 100.f, 0.f, 1.f},
+  };
+  // More colors than the shader arrays take.
+  std::vector<Vec4> colors;
+  for (int i = 0; i < 100; i++) {
+    colors.emplace_back(i / 99.f, 0.f, 1.f - i / 99.f, 1.f);
+  }
+  auto linear_gradient = Shader::MakeLinear(pts, colors.data(), nullptr,
+                                            static_cast<int>(colors.size()));
+  Paint paint;
+  paint.SetShader(linear_gradient);
+
+  ArenaAllocator arena_allocator;
+  HWDrawContext draw_context;
+  draw_context.arena_allocator = &arena_allocator;
+  bool is_stroke = false;
+  bool use_gpu_tessellation = true;
+  skity::HWDynamicPathDraw dynamic_path_draw(Matrix{}, path, paint, is_stroke,
+                                             use_gpu_tessellation);
+  dynamic_path_draw.Prepare(&draw_context);
+  const ArrayList<HWDrawStep*, 2>& steps = dynamic_path_draw.GetSteps();
+  EXPECT_EQ(steps.size(), 1);
+  EXPECT_EQ(steps[0]->GetFragmentKey(),
+            MakeFunctionBaseKey(
+                MakeMainKey(HWFragmentKeyType::kGradient, 0b00111001)));
+  EXPECT_EQ(steps[0]->GetFragmentName(), "FS_GradientLinearLUT");
+}
+
 TEST(HWPipelineKey, GradientRadial16) {
   Path path;
   path.MoveTo(10, 10);
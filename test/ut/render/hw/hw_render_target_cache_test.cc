@@ -0,0 +1,225 @@
+// Copyright 2021 The Lynx Authors. All rights reserved.
+// Licensed under the Apache License Version 2.0 that can be found in the
+// LICENSE file in the root directory of this source tree.
+
+#include "src/render/hw/hw_render_target_cache.hpp"
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <memory>
+
+using testing::_;
+
+namespace {
+
+class MockRenderTarget
+    : public skity::HWResource<skity::GPUTextureDescriptor,
+                               std::shared_ptr<skity::GPUTexture>> {
+ public:
+  explicit MockRenderTarget(const skity::GPUTextureDescriptor& desc)
+      : desc_(desc) {}
+
+  const skity::GPUTextureDescriptor& GetKey() const override { return desc_; }
+
+  std::shared_ptr<skity::GPUTexture> GetValue() const override {
+    return nullptr;
+  }
+
+  size_t GetBytes() const override { return desc_.width * desc_.height * 4; }
+
+ private:
+  skity::GPUTextureDescriptor desc_;
+};
+
+class MockAllocator
+    : public skity::HWResourceAllocator<skity::GPUTextureDescriptor,
+                                        std::shared_ptr<skity::GPUTexture>> {
+ public:
+  MockAllocator() {
+    ON_CALL(*this, AllocateResource(_))
+        .WillByDefault([](const skity::GPUTextureDescriptor& desc) {
+          return std::make_shared<MockRenderTarget>(desc);
+        });
+  }
+
+  MOCK_METHOD(std::shared_ptr<skity::HWRenderTargetCache::Resource>,
+              AllocateResource, (const skity::GPUTextureDescriptor& key),
+              (override));
+};
+
+skity::GPUTextureDescriptor MakeDesc(uint32_t width, uint32_t height) {
+  skity::GPUTextureDescriptor desc;
+  desc.width = width;
+  desc.height = height;
+  desc.format = skity::GPUTextureFormat::kRGBA8Unorm;
+  desc.storage_mode = skity::GPUTextureStorageMode::kPrivate;
+  desc.usage = static_cast<skity::GPUTextureUsageMask>(
+                   skity::GPUTextureUsage::kTextureBinding) |
+               static_cast<skity::GPUTextureUsageMask>(
+                   skity::GPUTextureUsage::kRenderAttachment);
+  return desc;
+}
+
+struct TestCache {
+  explicit TestCache(uint32_t max_texture_size = 0) {
+    auto mock = std::make_unique<testing::NiceMock<MockAllocator>>();
+    allocator = mock.get();
+    cache = std::make_unique<skity::HWRenderTargetCache>(
+        std::move(mock), 64 * 1024 * 1024, max_texture_size);
+  }
+
+  testing::NiceMock<MockAllocator>* allocator;
+  std::unique_ptr<skity::HWRenderTargetCache> cache;
+};
+
+}  // namespace
+
+TEST(HWRenderTargetCache, ApproxFitRoundsUpToGranularity) {
+  TestCache test;
+  EXPECT_CALL(*test.allocator, AllocateResource(_))
+      .WillOnce([](const skity::GPUTextureDescriptor& desc) {
+        EXPECT_EQ(desc.width, 128u);
+        EXPECT_EQ(desc.height, 64u);
+        return std::make_shared<MockRenderTarget>(desc);
+      });
+
+  auto resource = test.cache->ObtainResource(MakeDesc(100, 33),
+                                             skity::HWTextureFit::kApprox);
+  EXPECT_EQ(resource->GetKey().width, 128u);
+  EXPECT_EQ(resource->GetKey().height, 64u);
+  EXPECT_EQ(test.cache->GetAllocatedBytes(), 128u * 64u * 4u);
+}
+
+TEST(HWRenderTargetCache, RoundingIsClampedToMaxTextureSize) {
+  TestCache test(1000);
+  auto resource = test.cache->ObtainResource(MakeDesc(999, 1000),
+                                             skity::HWTextureFit::kApprox);
+  EXPECT_EQ(resource->GetKey().width, 1000u);
+  EXPECT_EQ(resource->GetKey().height, 1000u);
+}
+
+TEST(HWRenderTargetCache, ApproxWidthKeepsHeight) {
+  TestCache test;
+  auto resource = test.cache->ObtainResource(MakeDesc(100, 33),
+                                             skity::HWTextureFit::kApproxWidth);
+  EXPECT_EQ(resource->GetKey().width, 128u);
+  EXPECT_EQ(resource->GetKey().height, 33u);
+
+  // A taller texture can not be used without the exact height.
+  test.cache->StoreResource(resource);
+  EXPECT_CALL(*test.allocator, AllocateResource(_)).Times(1);
+  test.cache->ObtainResource(MakeDesc(100, 32),
+                             skity::HWTextureFit::kApproxWidth);
+}
+
+TEST(HWRenderTargetCache, GrowingLayerReusesTexture) {
+  TestCache test;
+  EXPECT_CALL(*test.allocator, AllocateResource(_)).Times(1);
+
+  std::shared_ptr<skity::HWRenderTargetCache::Resource> last;
+  for (uint32_t size = 100; size < 110; size++) {
+    skity::HWRenderTargetCache::Pool pool(test.cache.get());
+    auto resource = test.cache->ObtainResource(
+        MakeDesc(size, size), skity::HWTextureFit::kApprox, &pool);
+    if (last) {
+      EXPECT_EQ(resource.get(), last.get());
+    }
+    last = resource;
+  }
+  EXPECT_EQ(test.cache->GetReusedBytes(), 9u * 128u * 128u * 4u);
+}
+
+TEST(HWRenderTargetCache, BestFitPicksSmallestTexture) {
+  TestCache test;
+  auto large = test.cache->ObtainResource(MakeDesc(200, 200),
+                                          skity::HWTextureFit::kApprox);
+  auto small = test.cache->ObtainResource(MakeDesc(130, 130),
+                                          skity::HWTextureFit::kApprox);
+  auto narrow = test.cache->ObtainResource(MakeDesc(64, 300),
+                                           skity::HWTextureFit::kApprox);
+  test.cache->StoreResource(large);
+  test.cache->StoreResource(narrow);
+  test.cache->StoreResource(small);
+
+  EXPECT_CALL(*test.allocator, AllocateResource(_)).Times(0);
+  auto resource = test.cache->ObtainResource(MakeDesc(120, 120),
+                                             skity::HWTextureFit::kApprox);
+  EXPECT_EQ(resource.get(), small.get());
+}
+
+TEST(HWRenderTargetCache, BestFitRejectsWastefulTexture) {
+  TestCache test;
+  auto large = test.cache->ObtainResource(MakeDesc(512, 512),
+                                          skity::HWTextureFit::kApprox);
+  test.cache->StoreResource(large);
+
+  EXPECT_CALL(*test.allocator, AllocateResource(_)).Times(1);
+  auto resource = test.cache->ObtainResource(MakeDesc(64, 64),
+                                             skity::HWTextureFit::kApprox);
+  EXPECT_NE(resource.get(), large.get());
+}
+
+TEST(HWRenderTargetCache, BestFitRequiresSameFormat) {
+  TestCache test;
+  auto resource = test.cache->ObtainResource(MakeDesc(100, 100),
+                                             skity::HWTextureFit::kApprox);
+  test.cache->StoreResource(resource);
+
+  auto desc = MakeDesc(100, 100);
+  desc.format = skity::GPUTextureFormat::kBGRA8Unorm;
+  EXPECT_CALL(*test.allocator, AllocateResource(_)).Times(1);
+  auto other = test.cache->ObtainResource(desc, skity::HWTextureFit::kApprox);
+  EXPECT_NE(other.get(), resource.get());
+}
+
+TEST(HWRenderTargetCache, ExactFitIgnoresLargerTexture) {
+  TestCache test;
+  auto resource = test.cache->ObtainResource(MakeDesc(100, 100),
+                                             skity::HWTextureFit::kApprox);
+  test.cache->StoreResource(resource);
+
+  EXPECT_CALL(*test.allocator, AllocateResource(_)).Times(1);
+  auto exact = test.cache->ObtainResource(MakeDesc(100, 100),
+                                          skity::HWTextureFit::kExact);
+  EXPECT_EQ(exact->GetKey().width, 100u);
+}
+
+TEST(HWRenderTargetCache, PoolAliasesTexturesWithDisjointLifetimes) {
+  TestCache test;
+  EXPECT_CALL(*test.allocator, AllocateResource(_)).Times(1);
+
+  skity::HWRenderTargetCache::Pool frame_pool(test.cache.get());
+  std::shared_ptr<skity::HWRenderTargetCache::Resource> first;
+  {
+    // Released as soon as the scope which consumed it ends.
+    skity::HWRenderTargetCache::Pool layer_pool(test.cache.get());
+    first = test.cache->ObtainResource(
+        MakeDesc(90, 90), skity::HWTextureFit::kApprox, &layer_pool);
+  }
+  auto second = test.cache->ObtainResource(
+      MakeDesc(70, 80), skity::HWTextureFit::kApprox, &frame_pool);
+  EXPECT_EQ(first.get(), second.get());
+}
+
+TEST(HWRenderTargetCache, Counters) {
+  TestCache test;
+  test.cache->SetMaxBytes(128 * 128 * 4);
+
+  auto first = test.cache->ObtainResource(MakeDesc(100, 100),
+                                          skity::HWTextureFit::kApprox);
+  auto second = test.cache->ObtainResource(MakeDesc(100, 100),
+                                           skity::HWTextureFit::kApprox);
+  EXPECT_EQ(test.cache->GetAllocatedBytes(), 2u * 128u * 128u * 4u);
+  EXPECT_EQ(test.cache->GetReusedBytes(), 0u);
+
+  test.cache->StoreResource(first);
+  test.cache->StoreResource(second);
+  test.cache->PurgeAsNeeded();
+  EXPECT_EQ(test.cache->GetPurgedBytes(), 128u * 128u * 4u);
+
+  test.cache->ObtainResource(MakeDesc(110, 110),
+                             skity::HWTextureFit::kApprox);
+  EXPECT_EQ(test.cache->GetReusedBytes(), 128u * 128u * 4u);
+  EXPECT_EQ(test.cache->GetAllocatedBytes(), 2u * 128u * 128u * 4u);
+}
@@ -84,3 +84,42 @@ TEST(SWCanvas, StrokeThenFillDrawsFillAfterStroke) {
   EXPECT_EQ(bitmap.GetPixel(12, 20), skity::Color_WHITE);
   EXPECT_EQ(bitmap.GetPixel(7, 20), skity::Color_RED);
 }
+
+TEST(SWCanvas, ClipPathIntersectLimitsDraw) {
+  skity::Bitmap bitmap(32, 32, skity::AlphaType::kPremul_AlphaType,
+                       skity::ColorType::kRGBA);
+  auto canvas = skity::Canvas::MakeSoftwareCanvas(&bitmap);
+  ASSERT_TRUE(canvas);
+
+  skity::Paint paint;
+  paint.SetColor(skity::Color_RED);
+
+  skity::Path clip;
+  clip.AddRect(skity::Rect::MakeXYWH(8.f, 8.f, 16.f, 16.f));
+  canvas->ClipPath(clip);
+  canvas->DrawRect(skity::Rect::MakeWH(32.f, 32.f), paint);
+
+  EXPECT_EQ(bitmap.GetPixel(16, 16), skity::Color_RED);
+  EXPECT_EQ(bitmap.GetPixel(9, 22), skity::Color_RED);
+  EXPECT_EQ(bitmap.GetPixel(2, 2), skity::Color_TRANSPARENT);
+  EXPECT_EQ(bitmap.GetPixel(16, 28), skity::Color_TRANSPARENT);
+}
+
+TEST(SWCanvas, ClipPathDifferenceExcludesClip) {
+  skity::Bitmap bitmap(32, 32, skity::AlphaType::kPremul_AlphaType,
+                       skity::ColorType::kRGBA);
+  auto canvas = skity::Canvas::MakeSoftwareCanvas(&bitmap);
+  ASSERT_TRUE(canvas);
+
+  skity::Paint paint;
+  paint.SetColor(skity::Color_RED);
+
+  skity::Path clip;
+  clip.AddRect(skity::Rect::MakeXYWH(8.f, 8.f, 16.f, 16.f));
+  canvas->ClipPath(clip, skity::Canvas::ClipOp::kDifference);
+  canvas->DrawRect(skity::Rect::MakeWH(32.f, 32.f), paint);
+
+  EXPECT_EQ(bitmap.GetPixel(16, 16), skity::Color_TRANSPARENT);
+  EXPECT_EQ(bitmap.GetPixel(2, 2), skity::Color_RED);
+  EXPECT_EQ(bitmap.GetPixel(16, 28), skity::Color_RED);
+}
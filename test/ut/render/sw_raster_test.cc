@@ -0,0 +1,97 @@
+// Copyright 2021 The Lynx Authors. All rights reserved.
+// Licensed under the Apache License Version 2.0 that can be found in the
+// LICENSE file in the root directory of this source tree.
+
+#include "src/render/sw/sw_raster.hpp"
+
+#include <gtest/gtest.h>
+
+#include <vector>
+
+#include "src/utils/arena_allocator.hpp"
+
+namespace {
+
+class CollectSpans : public skity::SpanBuilderDelegate {
+ public:
+  void OnBeginSpans(const skity::Rect&) override { begin_count++; }
+
+  void OnBuildSpan(int x, int y, int width, const uint8_t alpha) override {
+    spans.push_back(skity::Span{x, y, width, alpha});
+  }
+
+  void OnEndSpans() override { end_count++; }
+
+  std::vector<skity::Span> spans;
+  int begin_count = 0;
+  int end_count = 0;
+};
+
+skity::Path MakeStar() {
+  skity::Path path;
+  path.MoveTo(100, 10);
+  path.LineTo(40, 180);
+  path.LineTo(190, 60);
+  path.LineTo(10, 60);
+  path.LineTo(160, 180);
+  path.Close();
+  path.AddCircle(100, 100, 50);
+  return path;
+}
+
+}  // namespace
+
+TEST(SWRaster, StreamedSpansMatchCollectedSpans) {
+  skity::Path path = MakeStar();
+
+  skity::SWRaster collected;
+  collected.RastePath(path, skity::Matrix{});
+
+  skity::ArenaAllocator arena;
+  CollectSpans delegate;
+  skity::SWRaster streamed(&arena);
+  streamed.RastePath(path, skity::Matrix{}, skity::SWRaster::kCullRect,
+                     &delegate);
+
+  EXPECT_TRUE(streamed.CurrentSpans().empty());
+  EXPECT_EQ(delegate.begin_count, 1);
+  EXPECT_EQ(delegate.end_count, 1);
+
+  auto const& expected = collected.CurrentSpans();
+  ASSERT_FALSE(expected.empty());
+  ASSERT_EQ(delegate.spans.size(), expected.size());
+  for (size_t i = 0; i < expected.size(); i++) {
+    EXPECT_EQ(delegate.spans[i].x, expected[i].x);
+    EXPECT_EQ(delegate.spans[i].y, expected[i].y);
+    EXPECT_EQ(delegate.spans[i].len, expected[i].len);
+    EXPECT_EQ(delegate.spans[i].cover, expected[i].cover);
+  }
+}
+
+TEST(SWRaster, EdgeArenaIsResetAfterEachPath) {
+  auto block_cache = std::make_shared<skity::BlockCacheAllocator>();
+  skity::ArenaAllocator arena(block_cache);
+
+  skity::SWRaster raster(&arena);
+  raster.RastePath(MakeStar(), skity::Matrix{});
+
+  EXPECT_TRUE(arena.GetArena().GetBlocks().empty());
+  EXPECT_FALSE(block_cache->GetBlocks().empty());
+
+  // the next path takes its edges from the cached blocks
+  size_t cached = block_cache->GetBlocks().size();
+  skity::SWRaster next(&arena);
+  next.RastePath(MakeStar(), skity::Matrix{});
+  EXPECT_EQ(block_cache->GetBlocks().size(), cached);
+}
+
+TEST(SWRaster, DelegateIsNotNotifiedForEmptyPath) {
+  CollectSpans delegate;
+  skity::SWRaster raster;
+  raster.RastePath(skity::Path{}, skity::Matrix{}, skity::SWRaster::kCullRect,
+                   &delegate);
+
+  EXPECT_EQ(delegate.begin_count, 0);
+  EXPECT_EQ(delegate.end_count, 0);
+  EXPECT_TRUE(delegate.spans.empty());
+}
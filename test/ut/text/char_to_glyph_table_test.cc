@@ -0,0 +1,71 @@
+// Copyright 2021 The Lynx Authors. All rights reserved.
+// Licensed under the Apache License Version 2.0 that can be found in the
+// LICENSE file in the root directory of this source tree.
+
+#include "src/text/char_to_glyph_table.hpp"
+
+#include <gtest/gtest.h>
+
+#include <vector>
+
+using namespace skity;
+
+TEST(CharToGlyphTableTest, EmptyTableMapsEverythingToZero) {
+  CharToGlyphTable table;
+
+  EXPECT_EQ(table.Lookup('a'), 0);
+  EXPECT_EQ(table.Lookup(0x1F600), 0);
+  EXPECT_EQ(table.Lookup(CharToGlyphTable::kMaxCodePoint), 0);
+  EXPECT_EQ(table.GetPageCount(), 0u);
+}
+
+TEST(CharToGlyphTableTest, LookupReturnsMappedGlyphs) {
+  CharToGlyphTable table;
+  table.Set('a', 10);
+  table.Set('b', 11);
+  table.Set(0x4E2D, 500);
+  table.Set(0x1F600, 900);
+
+  EXPECT_EQ(table.Lookup('a'), 10);
+  EXPECT_EQ(table.Lookup('b'), 11);
+  EXPECT_EQ(table.Lookup('c'), 0);
+  EXPECT_EQ(table.Lookup(0x4E2D), 500);
+  EXPECT_EQ(table.Lookup(0x4E2E), 0);
+  EXPECT_EQ(table.Lookup(0x1F600), 900);
+  EXPECT_EQ(table.GetPageCount(), 3u);
+}
+
+TEST(CharToGlyphTableTest, OutOfRangeCodePointsAreIgnored) {
+  CharToGlyphTable table;
+  table.Set(CharToGlyphTable::kMaxCodePoint + 1, 7);
+  table.Set(0xFFFFFFFF, 7);
+
+  EXPECT_EQ(table.Lookup(CharToGlyphTable::kMaxCodePoint + 1), 0);
+  EXPECT_EQ(table.Lookup(0xFFFFFFFF), 0);
+  EXPECT_EQ(table.GetPageCount(), 0u);
+}
+
+TEST(CharToGlyphTableTest, ZeroGlyphDoesNotAllocatePage) {
+  CharToGlyphTable table;
+  table.Set(0x3000, 0);
+
+  EXPECT_EQ(table.GetPageCount(), 0u);
+}
+
+TEST(CharToGlyphTableTest, BulkLookupMatchesSingleLookup) {
+  CharToGlyphTable table;
+  for (Unichar c = 0x20; c < 0x7F; c++) {
+    table.Set(c, static_cast<GlyphID>(c - 0x1F));
+  }
+
+  std::vector<Unichar> chars = {'H', 'i', 0x4E2D, '!', 0x110000};
+  std::vector<GlyphID> glyphs(chars.size(), 0xFFFF);
+  table.Lookup(chars.data(), static_cast<int>(chars.size()), glyphs.data());
+
+  for (size_t i = 0; i < chars.size(); i++) {
+    EXPECT_EQ(glyphs[i], table.Lookup(chars[i]));
+  }
+  EXPECT_EQ(glyphs[0], 'H' - 0x1F);
+  EXPECT_EQ(glyphs[2], 0);
+  EXPECT_EQ(glyphs[4], 0);
+}
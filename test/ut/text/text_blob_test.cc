@@ -56,6 +56,67 @@ class MockTypeface : public Typeface {
   void OnGetFontDescriptor(FontDescriptor&) const override {}
 };
 
+// Maps the code points in [first, last] to consecutive glyphs starting at 1.
+class RangeTypeface : public MockTypeface {
+ public:
+  RangeTypeface(Unichar first, Unichar last) : first_(first), last_(last) {}
+
+ protected:
+  void OnCharsToGlyphs(const uint32_t* chars, int count,
+                       GlyphID* glyphs) const override {
+    for (int i = 0; i < count; i++) {
+      glyphs[i] = chars[i] >= first_ && chars[i] <= last_
+                      ? static_cast<GlyphID>(chars[i] - first_ + 1)
+                      : 0;
+    }
+  }
+
+ private:
+  Unichar first_;
+  Unichar last_;
+};
+
+class CountingDelegate : public TypefaceDelegate {
+ public:
+  explicit CountingDelegate(std::shared_ptr<Typeface> fallback)
+      : fallback_(std::move(fallback)) {}
+
+  std::shared_ptr<Typeface> Fallback(Unichar, Paint const&) override {
+    fallback_count++;
+    return fallback_;
+  }
+
+  std::vector<std::vector<Unichar>> BreakTextRun(const char*) override {
+    return {};
+  }
+
+  int fallback_count = 0;
+
+ private:
+  std::shared_ptr<Typeface> fallback_;
+};
+
+// Picks the fallback by paint style, as a delegate with separate stroke and
+// fill fonts would.
+class StyleDelegate : public TypefaceDelegate {
+ public:
+  StyleDelegate(std::shared_ptr<Typeface> fill,
+                std::shared_ptr<Typeface> stroke)
+      : fill_(std::move(fill)), stroke_(std::move(stroke)) {}
+
+  std::shared_ptr<Typeface> Fallback(Unichar, Paint const& paint) override {
+    return paint.GetStyle() == Paint::kFill_Style ? fill_ : stroke_;
+  }
+
+  std::vector<std::vector<Unichar>> BreakTextRun(const char*) override {
+    return {};
+  }
+
+ private:
+  std::shared_ptr<Typeface> fill_;
+  std::shared_ptr<Typeface> stroke_;
+};
+
 }  // namespace
 
 class TextBlobTest : public ::testing::Test {
@@ -334,3 +395,101 @@ TEST_F(TextBlobTest, BuildTextBlobWithRealTypefaceEndToEnd) {
   Rect rect = blob->GetBoundsRect();
   EXPECT_FALSE(rect.IsEmpty());
 }
+
+TEST_F(TextBlobTest, BuildTextBlobSplitsRunsAtFallbackTypeface) {
+  auto latin = std::make_shared<RangeTypeface>('a', 'z');
+  auto digits = std::make_shared<RangeTypeface>('0', '9');
+  CountingDelegate delegate(digits);
+
+  TextBlobBuilder builder;
+  Paint paint;
+  paint.SetTypeface(latin);
+
+  auto blob = builder.BuildTextBlob("ab12c", paint, &delegate);
+
+  ASSERT_NE(blob, nullptr);
+  auto const& runs = blob->GetTextRun();
+  ASSERT_EQ(runs.size(), 3u);
+  EXPECT_EQ(runs[0].LockTypeface(), latin);
+  EXPECT_EQ(runs[0].GetGlyphInfo(), (std::vector<GlyphID>{1, 2}));
+  EXPECT_EQ(runs[1].LockTypeface(), digits);
+  EXPECT_EQ(runs[1].GetGlyphInfo(), (std::vector<GlyphID>{2, 3}));
+  EXPECT_EQ(runs[2].LockTypeface(), latin);
+  EXPECT_EQ(runs[2].GetGlyphInfo(), (std::vector<GlyphID>{3}));
+}
+
+TEST_F(TextBlobTest, BuildTextBlobAsksDelegateOncePerCodePoint) {
+  auto latin = std::make_shared<RangeTypeface>('a', 'z');
+  auto digits = std::make_shared<RangeTypeface>('0', '9');
+  CountingDelegate delegate(digits);
+
+  TextBlobBuilder builder;
+  Paint paint;
+  paint.SetTypeface(latin);
+
+  // '#' is covered by no typeface, the miss is remembered too.
+  builder.BuildTextBlob("a1b1#1#", paint, &delegate);
+  EXPECT_EQ(delegate.fallback_count, 2);
+
+  builder.BuildTextBlob("11##", paint, &delegate);
+  EXPECT_EQ(delegate.fallback_count, 2);
+
+  builder.ClearFallbackCache();
+  builder.BuildTextBlob("1", paint, &delegate);
+  EXPECT_EQ(delegate.fallback_count, 3);
+}
+
+TEST_F(TextBlobTest, FallbackCacheIsResetWhenTypefaceOrDelegateChanges) {
+  auto latin = std::make_shared<RangeTypeface>('a', 'z');
+  auto digits = std::make_shared<RangeTypeface>('0', '9');
+  CountingDelegate delegate(digits);
+  CountingDelegate other_delegate(latin);
+
+  TextBlobBuilder builder;
+  Paint paint;
+  paint.SetTypeface(latin);
+  builder.BuildTextBlob("1", paint, &delegate);
+  EXPECT_EQ(delegate.fallback_count, 1);
+
+  builder.BuildTextBlob("1", paint, &other_delegate);
+  EXPECT_EQ(other_delegate.fallback_count, 1);
+
+  paint.SetTypeface(std::make_shared<RangeTypeface>('A', 'Z'));
+  auto blob = builder.BuildTextBlob("1", paint, &delegate);
+  EXPECT_EQ(delegate.fallback_count, 2);
+  ASSERT_NE(blob, nullptr);
+  ASSERT_FALSE(blob->GetTextRun().empty());
+  EXPECT_EQ(blob->GetTextRun().back().LockTypeface(), digits);
+}
+
+TEST_F(TextBlobTest, FallbackCacheSeparatesPaintStyles) {
+  auto latin = std::make_shared<RangeTypeface>('a', 'z');
+  auto fill_digits = std::make_shared<RangeTypeface>('0', '9');
+  auto stroke_digits = std::make_shared<RangeTypeface>('0', '9');
+  StyleDelegate delegate(fill_digits, stroke_digits);
+
+  TextBlobBuilder builder;
+  Paint fill_paint;
+  fill_paint.SetTypeface(latin);
+  Paint stroke_paint = fill_paint;
+  stroke_paint.SetStyle(Paint::kStroke_Style);
+
+  auto fill_blob = builder.BuildTextBlob("1", fill_paint, &delegate);
+  auto stroke_blob = builder.BuildTextBlob("1", stroke_paint, &delegate);
+
+  ASSERT_NE(fill_blob, nullptr);
+  ASSERT_NE(stroke_blob, nullptr);
+  ASSERT_EQ(fill_blob->GetTextRun().size(), 1u);
+  ASSERT_EQ(stroke_blob->GetTextRun().size(), 1u);
+  EXPECT_EQ(fill_blob->GetTextRun()[0].LockTypeface(), fill_digits);
+  EXPECT_EQ(stroke_blob->GetTextRun()[0].LockTypeface(), stroke_digits);
+}
+
+TEST_F(TextBlobTest, TypefaceDelegatesHaveDistinctIDs) {
+  auto digits = std::make_shared<RangeTypeface>('0', '9');
+  CountingDelegate delegate(digits);
+  CountingDelegate other_delegate(digits);
+
+  EXPECT_NE(delegate.GetID(), 0u);
+  EXPECT_NE(delegate.GetID(), other_delegate.GetID());
+}
@@ -0,0 +1,135 @@
+#!/usr/bin/env python3
+# Copyright 2021 The Lynx Authors. All rights reserved.
+# Licensed under the Apache License Version 2.0 that can be found in the
+# LICENSE file in the root directory of this source tree.
+"""
+Compares two Google Benchmark JSON reports and fails on regressions.
+
+Produce the reports with any skity benchmark binary, for example:
+
+  skity_headless_bench --benchmark_repetitions=5 \
+      --benchmark_out=current.json --benchmark_out_format=json
+
+then run:
+
+  tools/bench_compare.py baseline.json current.json --threshold 0.05
+
+When a report has repetitions the median aggregate is compared, otherwise the
+single run. Benchmarks present in only one report are listed but never fail
+the comparison. Exits with 1 if any benchmark got slower by more than the
+threshold, 0 otherwise, 2 if a report can not be read.
+"""
+
+import argparse
+import json
+import re
+import sys
+from typing import Dict, Optional
+
+EXIT_SUCCESS = 0
+EXIT_REGRESSION = 1
+EXIT_USAGE_ERROR = 2
+
+# Normalize every timing to nanoseconds before comparing.
+TIME_UNIT_SCALE = {
+    'ns': 1.0,
+    'us': 1e3,
+    'ms': 1e6,
+    's': 1e9,
+}
+
+
+def load_times(path: str, metric: str,
+               name_filter: Optional[re.Pattern]) -> Dict[str, float]:
+    with open(path) as f:
+        report = json.load(f)
+
+    singles = {}
+    medians = {}
+    for bench in report.get('benchmarks', []):
+        if bench.get('error_occurred') or bench.get('skipped'):
+            continue
+
+        name = bench.get('run_name', bench['name'])
+        if name_filter and not name_filter.search(name):
+            continue
+
+        scale = TIME_UNIT_SCALE.get(bench.get('time_unit', 'ns'), 1.0)
+        value = float(bench[metric]) * scale
+
+        run_type = bench.get('run_type', 'iteration')
+        if run_type == 'aggregate':
+            if bench.get('aggregate_name') == 'median':
+                medians[name] = value
+        elif name not in singles:
+            singles[name] = value
+
+    singles.update(medians)
+    return singles
+
+
+def format_time(nanos: float) -> str:
+    for unit in ('s', 'ms', 'us'):
+        if nanos >= TIME_UNIT_SCALE[unit]:
+            return '%.3f %s' % (nanos / TIME_UNIT_SCALE[unit], unit)
+    return '%.1f ns' % nanos
+
+
+def main() -> int:
+    parser = argparse.ArgumentParser(
+        description='Compare two Google Benchmark JSON reports.')
+    parser.add_argument('baseline', help='JSON report of the baseline run')
+    parser.add_argument('current', help='JSON report of the run to check')
+    parser.add_argument('--threshold', type=float, default=0.05,
+                        help='relative slowdown that counts as a regression, '
+                             'default 0.05 (5%%)')
+    parser.add_argument('--metric', choices=['real_time', 'cpu_time'],
+                        default='cpu_time', help='timing to compare')
+    parser.add_argument('--filter', default=None,
+                        help='only compare benchmarks matching this regex')
+    args = parser.parse_args()
+
+    name_filter = re.compile(args.filter) if args.filter else None
+    try:
+        baseline = load_times(args.baseline, args.metric, name_filter)
+        current = load_times(args.current, args.metric, name_filter)
+    except (OSError, ValueError, KeyError) as e:
+        print('error: failed to read report: %s' % e, file=sys.stderr)
+        return EXIT_USAGE_ERROR
+
+    names = sorted(set(baseline) | set(current))
+    if not names:
+        print('error: no benchmarks to compare', file=sys.stderr)
+        return EXIT_USAGE_ERROR
+
+    width = max(len(name) for name in names)
+    print('%-*s %14s %14s %9s' % (width, 'Benchmark', 'Baseline', 'Current',
+                                  'Change'))
+
+    regressions = []
+    for name in names:
+        if name not in baseline or name not in current:
+            side = 'current' if name in current else 'baseline'
+            print('%-*s %s only' % (width, name, side))
+            continue
+
+        old, new = baseline[name], current[name]
+        change = (new - old) / old if old > 0 else 0.0
+        mark = ''
+        if change > args.threshold:
+            mark = '  REGRESSION'
+            regressions.append(name)
+        print('%-*s %14s %14s %+8.1f%%%s' % (width, name, format_time(old),
+                                             format_time(new), change * 100,
+                                             mark))
+
+    if regressions:
+        print('\n%d benchmark(s) regressed by more than %.1f%%' %
+              (len(regressions), args.threshold * 100))
+        return EXIT_REGRESSION
+
+    return EXIT_SUCCESS
+
+
+if __name__ == '__main__':
+    sys.exit(main())